@@ -31,6 +31,7 @@
 #include "autotype/PickcharsDialog.h"
 #include "core/Resources.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 #include "gui/MainWindow.h"
 #include "gui/MessageBox.h"
 #include "gui/osutils/OSUtils.h"
@@ -261,6 +262,7 @@ void AutoType::executeAutoTypeActions(const Entry* entry,
                                       WId window,
                                       AutoTypeExecutor::Mode mode)
 {
+    TRACE_SCOPE("AutoType::executeAutoTypeActions");
     QString error;
     auto actions = parseSequence(sequence, entry, error);
 
@@ -448,21 +450,20 @@ void AutoType::performGlobalAutoType(const QList<QSharedPointer<Database>>& dbLi
     bool hideExpired = config()->get(Config::AutoTypeHideExpiredEntry).toBool();
 
     for (const auto& db : dbList) {
-        const QList<Entry*> dbEntries = db->rootGroup()->entriesRecursive();
-        for (auto entry : dbEntries) {
+        db->rootGroup()->forEachEntryRecursive([&](Entry* entry) {
             auto group = entry->group();
             if (!group || !group->resolveAutoTypeEnabled() || !entry->autoTypeEnabled()) {
-                continue;
+                return;
             }
 
             if (hideExpired && entry->isExpired()) {
-                continue;
+                return;
             }
             auto sequences = entry->autoTypeSequences(m_windowTitleForGlobal).toSet();
             for (const auto& sequence : sequences) {
                 matchList << AutoTypeMatch(entry, sequence);
             }
-        }
+        });
     }
 
     // Show the selection dialog if we always ask, have multiple matches, or no matches
@@ -540,6 +541,9 @@ void AutoType::resetAutoTypeState()
 /**
  * Parse an autotype sequence into a list of AutoTypeActions.
  * If error is provided then syntax checking will be performed.
+ * When syntaxOnly is set, values that are only needed for typing (TOTP
+ * codes, converted and replaced text) are not generated and the returned
+ * actions must not be executed.
  */
 QList<QSharedPointer<AutoTypeAction>>
 AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QString& error, bool syntaxOnly)
@@ -573,7 +577,7 @@ AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QStrin
     // Group 3 = inner placeholder (allows nested placeholders)
     // Group 4 = repeat (opt)
     // Group 5 = character
-    QRegularExpression regex("([+%^#]*)(?:({((?>[^{}]+?|(?2))+?)(?:\\s+(\\d+))?})|(.))");
+    static const QRegularExpression regex("([+%^#]*)(?:({((?>[^{}]+?|(?2))+?)(?:\\s+(\\d+))?})|(.))");
     auto results = regex.globalMatch(sequence);
     while (results.hasNext()) {
         auto match = results.next();
@@ -644,6 +648,9 @@ AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QStrin
             actions << QSharedPointer<AutoTypeClearField>::create();
         } else if (placeholder == "totp") {
             // Entry totp (requires special handling)
+            if (syntaxOnly) {
+                continue;
+            }
             QString totp = entry->totp();
             for (const auto& ch : totp) {
                 actions << QSharedPointer<AutoTypeKey>::create(ch);
@@ -691,8 +698,9 @@ AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QStrin
                 auto sep = placeholder[0];
                 auto parts = placeholder.split(sep);
                 if (parts.size() >= 4) {
-                    auto resolved = entry->resolveMultiplePlaceholders(parts[1]);
                     auto type = parts[2].toLower();
+                    // Only the conversion type is checked when syntax checking
+                    auto resolved = syntaxOnly ? QString() : entry->resolveMultiplePlaceholders(parts[1]);
 
                     if (type == "base64") {
                         resolved = resolved.toUtf8().toBase64();
@@ -729,12 +737,7 @@ AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QStrin
                 auto sep = placeholder[0];
                 auto parts = placeholder.split(sep);
                 if (parts.size() >= 5) {
-                    auto resolvedText = entry->resolveMultiplePlaceholders(parts[1]);
                     auto resolvedSearch = entry->resolveMultiplePlaceholders(parts[2]);
-                    auto resolvedReplace = entry->resolveMultiplePlaceholders(parts[3]);
-                    // Replace $<num> with \\<num> to support Qt substitutions
-                    resolvedReplace.replace(QRegularExpression(R"(\$(\d+))"), R"(\\1)");
-
                     auto searchRegex = QRegularExpression(resolvedSearch);
                     if (!searchRegex.isValid()) {
                         error = tr("Invalid regular expression syntax %1\n%2")
@@ -742,6 +745,17 @@ AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QStrin
                         return {};
                     }
 
+                    // Only the search expression is checked when syntax checking
+                    if (syntaxOnly) {
+                        continue;
+                    }
+
+                    auto resolvedText = entry->resolveMultiplePlaceholders(parts[1]);
+                    auto resolvedReplace = entry->resolveMultiplePlaceholders(parts[3]);
+                    // Replace $<num> with \\<num> to support Qt substitutions
+                    static const QRegularExpression substitutionRegex(R"(\$(\d+))");
+                    resolvedReplace.replace(substitutionRegex, R"(\\1)");
+
                     auto resolved = resolvedText.replace(searchRegex, resolvedReplace);
                     for (const QChar& ch : resolved) {
                         actions << QSharedPointer<AutoTypeKey>::create(ch);
@@ -20,10 +20,10 @@
 
 #include <QFont>
 
+#include "core/Database.h"
 #include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Group.h"
-#include "core/Metadata.h"
 #include "gui/DatabaseIcons.h"
 #include "gui/Icons.h"
 
@@ -65,35 +65,106 @@ QModelIndex AutoTypeMatchModel::closestIndexFromMatch(const AutoTypeMatch& match
 
 void AutoTypeMatchModel::setMatchList(const QList<AutoTypeMatch>& matches)
 {
+    QSet<Database*> databases;
+    for (const AutoTypeMatch& match : matches) {
+        databases.insert(match.first->group()->database());
+    }
+
+    const bool databasesChanged = databases != connectedDatabases();
+    if (!databasesChanged && updateMatchList(matches)) {
+        return;
+    }
+
     beginResetModel();
 
-    severConnections();
+    if (databasesChanged) {
+        severConnections();
+        for (Database* db : asConst(databases)) {
+            Q_ASSERT(db);
+            makeConnections(db);
+        }
+    }
 
-    m_allGroups.clear();
     m_matches = matches;
 
-    QSet<Database*> databases;
+    endResetModel();
+}
 
-    for (AutoTypeMatch& match : m_matches) {
-        databases.insert(match.first->group()->database());
+/**
+ * Remove and insert rows to turn the current matches into the given ones.
+ * This keeps the selection and scroll position of views intact.
+ *
+ * @return false if the matches kept from the current list are reordered,
+ *         the model has to be reset in that case
+ */
+bool AutoTypeMatchModel::updateMatchList(const QList<AutoTypeMatch>& matches)
+{
+    using MatchKey = QPair<const Entry*, QString>;
+    const auto keys = [](const QList<AutoTypeMatch>& list) {
+        QSet<MatchKey> result;
+        for (const AutoTypeMatch& match : list) {
+            result.insert({match.first.data(), match.second});
+        }
+        return result;
+    };
+    const auto contains = [](const QSet<MatchKey>& set, const AutoTypeMatch& match) {
+        return set.contains({match.first.data(), match.second});
+    };
+
+    const auto oldMatches = keys(m_matches);
+    const auto newMatches = keys(matches);
+    if (oldMatches.size() != m_matches.size() || newMatches.size() != matches.size()) {
+        return false;
     }
 
-    for (Database* db : asConst(databases)) {
-        Q_ASSERT(db);
-        for (const Group* group : db->rootGroup()->groupsRecursive(true)) {
-            m_allGroups.append(group);
+    QList<AutoTypeMatch> keptOld;
+    for (const AutoTypeMatch& match : asConst(m_matches)) {
+        if (contains(newMatches, match)) {
+            keptOld.append(match);
         }
+    }
+    QList<AutoTypeMatch> keptNew;
+    for (const AutoTypeMatch& match : matches) {
+        if (contains(oldMatches, match)) {
+            keptNew.append(match);
+        }
+    }
+    if (keptOld != keptNew) {
+        return false;
+    }
 
-        if (db->metadata()->recycleBin()) {
-            m_allGroups.removeOne(db->metadata()->recycleBin());
+    for (int row = m_matches.size() - 1; row >= 0; --row) {
+        if (contains(newMatches, m_matches.at(row))) {
+            continue;
         }
+        int first = row;
+        while (first > 0 && !contains(newMatches, m_matches.at(first - 1))) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, row);
+        m_matches.erase(m_matches.begin() + first, m_matches.begin() + row + 1);
+        endRemoveRows();
+        row = first;
     }
 
-    for (const Group* group : asConst(m_allGroups)) {
-        makeConnections(group);
+    for (int row = 0; row < matches.size(); ++row) {
+        if (contains(oldMatches, matches.at(row))) {
+            continue;
+        }
+        int last = row;
+        while (last + 1 < matches.size() && !contains(oldMatches, matches.at(last + 1))) {
+            ++last;
+        }
+        beginInsertRows(QModelIndex(), row, last);
+        for (int i = row; i <= last; ++i) {
+            m_matches.insert(i, matches.at(i));
+        }
+        endInsertRows();
+        row = last;
     }
 
-    endResetModel();
+    Q_ASSERT(m_matches == matches);
+    return true;
 }
 
 int AutoTypeMatchModel::rowCount(const QModelIndex& parent) const
@@ -198,16 +269,31 @@ void AutoTypeMatchModel::entryRemoved()
 {
 }
 
+QSet<Database*> AutoTypeMatchModel::connectedDatabases() const
+{
+    QSet<Database*> databases;
+    for (const auto& db : m_databases) {
+        if (db) {
+            databases.insert(db);
+        }
+    }
+    return databases;
+}
+
 void AutoTypeMatchModel::severConnections()
 {
-    for (const Group* group : asConst(m_allGroups)) {
-        disconnect(group, nullptr, this, nullptr);
+    for (const auto& db : asConst(m_databases)) {
+        if (db) {
+            disconnect(db, nullptr, this, nullptr);
+        }
     }
+    m_databases.clear();
 }
 
-void AutoTypeMatchModel::makeConnections(const Group* group)
+void AutoTypeMatchModel::makeConnections(Database* db)
 {
-    connect(group, SIGNAL(entryAboutToRemove(Entry*)), SLOT(entryAboutToRemove(Entry*)));
-    connect(group, SIGNAL(entryRemoved(Entry*)), SLOT(entryRemoved()));
-    connect(group, SIGNAL(entryDataChanged(Entry*)), SLOT(entryDataChanged(Entry*)));
+    connect(db, SIGNAL(entryAboutToRemove(Entry*)), SLOT(entryAboutToRemove(Entry*)));
+    connect(db, SIGNAL(entryRemoved(Entry*)), SLOT(entryRemoved()));
+    connect(db, SIGNAL(entryDataChanged(Entry*)), SLOT(entryDataChanged(Entry*)));
+    m_databases.append(db);
 }
@@ -20,11 +20,13 @@
 #define KEEPASSX_AUTOTYPEMATCHMODEL_H
 
 #include <QAbstractTableModel>
+#include <QPointer>
+#include <QSet>
 
 #include "autotype/AutoTypeMatch.h"
 
+class Database;
 class Entry;
-class Group;
 
 class AutoTypeMatchModel : public QAbstractTableModel
 {
@@ -57,11 +59,13 @@ private slots:
     void entryDataChanged(Entry* entry);
 
 private:
+    bool updateMatchList(const QList<AutoTypeMatch>& matches);
+    QSet<Database*> connectedDatabases() const;
     void severConnections();
-    void makeConnections(const Group* group);
+    void makeConnections(Database* db);
 
     QList<AutoTypeMatch> m_matches;
-    QList<const Group*> m_allGroups;
+    QList<QPointer<Database>> m_databases;
 };
 
 #endif // KEEPASSX_AUTOTYPEMATCHMODEL_H
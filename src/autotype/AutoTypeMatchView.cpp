@@ -79,10 +79,27 @@ void AutoTypeMatchView::keyPressEvent(QKeyEvent* event)
     }
 }
 
-void AutoTypeMatchView::setMatchList(const QList<AutoTypeMatch>& matches)
+/**
+ * @param matches matches to display
+ * @param keepOrder show the matches in the given order instead of sorting them,
+ *                  until the user sorts by a column again
+ */
+void AutoTypeMatchView::setMatchList(const QList<AutoTypeMatch>& matches, bool keepOrder)
 {
+    // Rows are updated in place when possible, avoid invalidating the proxy model needlessly
     m_model->setMatchList(matches);
-    m_sortModel->setFilterWildcard({});
+    if (!m_sortModel->filterRegExp().isEmpty()) {
+        m_sortModel->setFilterWildcard({});
+    }
+
+    if (keepOrder) {
+        if (m_sortModel->sortColumn() >= 0) {
+            horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+            m_sortModel->sort(-1);
+        }
+    } else if (horizontalHeader()->sortIndicatorSection() < 0) {
+        sortByColumn(0, Qt::AscendingOrder);
+    }
 
     horizontalHeader()->resizeSections(QHeaderView::ResizeToContents);
 
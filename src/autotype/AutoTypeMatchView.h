@@ -35,7 +35,7 @@ public:
     explicit AutoTypeMatchView(QWidget* parent = nullptr);
     AutoTypeMatch currentMatch();
     AutoTypeMatch matchFromIndex(const QModelIndex& index);
-    void setMatchList(const QList<AutoTypeMatch>& matches);
+    void setMatchList(const QList<AutoTypeMatch>& matches, bool keepOrder = false);
     void selectFirstMatch();
     bool selectMatch(const AutoTypeMatch& match);
     void filterList(const QString& filter);
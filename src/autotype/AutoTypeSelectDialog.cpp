@@ -98,9 +98,21 @@ void AutoTypeSelectDialog::setMatches(const QList<AutoTypeMatch>& matches,
                                       const QList<QSharedPointer<Database>>& dbs,
                                       const AutoTypeMatch& lastMatch)
 {
+    for (const auto& db : asConst(m_dbs)) {
+        db->disconnect(this);
+    }
+
     m_matches = matches;
     m_dbs = dbs;
     m_lastMatch = lastMatch;
+    m_searchResults.clear();
+
+    // Cached search results hold entry pointers, forget them on any change
+    for (const auto& db : asConst(m_dbs)) {
+        connect(db.data(), &Database::modified, this, &AutoTypeSelectDialog::clearSearchResults);
+        connect(db.data(), &Database::entryAboutToRemove, this, &AutoTypeSelectDialog::clearSearchResults);
+        connect(db.data(), &Database::groupAboutToRemove, this, &AutoTypeSelectDialog::clearSearchResults);
+    }
     bool noMatches = m_matches.isEmpty();
 
     // disable changing search scope if we have no direct matches
@@ -122,6 +134,11 @@ void AutoTypeSelectDialog::setSearchString(const QString& search)
     m_ui->searchCheckBox->setChecked(true);
 }
 
+void AutoTypeSelectDialog::clearSearchResults()
+{
+    m_searchResults.clear();
+}
+
 void AutoTypeSelectDialog::setDelayedSearch(bool state)
 {
     m_searchTimer.setInterval(state ? 150 : 0);
@@ -142,35 +159,52 @@ void AutoTypeSelectDialog::performSearch()
         m_ui->view->setMatchList(m_matches);
         m_ui->view->filterList(m_ui->search->text());
     } else {
+        static const int MaxRankedMatches = 100;
+
         auto searchText = m_ui->search->text();
-        // If no search text, find all entries
-        if (searchText.isEmpty()) {
+        // If no search text, find all entries, otherwise show the best matches first
+        const bool ranked = !searchText.isEmpty();
+        if (!ranked) {
             searchText.append("*");
         }
 
+        // Going back to an earlier search, e.g. with backspace, reuses its results
+        if (auto cached = m_searchResults.object(searchText)) {
+            m_ui->view->setMatchList(*cached, ranked);
+            selectSearchMatch();
+            return;
+        }
+
+        // Best matches of all databases, searched concurrently
         EntrySearcher searcher;
+        const auto found = searcher.searchRanked(searchText, m_dbs, ranked ? MaxRankedMatches : 0);
+
         QList<AutoTypeMatch> matches;
-        for (const auto& db : m_dbs) {
-            auto found = searcher.search(searchText, db->rootGroup());
-            for (auto* entry : found) {
-                QSet<QString> sequences;
-                auto defSequence = entry->effectiveAutoTypeSequence();
-                if (!defSequence.isEmpty()) {
-                    matches.append({entry, defSequence});
-                    sequences << defSequence;
-                }
-                for (const auto& assoc : entry->autoTypeAssociations()->getAll()) {
-                    if (!sequences.contains(assoc.sequence) && !assoc.sequence.isEmpty()) {
-                        matches.append({entry, assoc.sequence});
-                        sequences << assoc.sequence;
-                    }
+        for (const auto& result : asConst(found)) {
+            auto* entry = result.entry;
+            QSet<QString> sequences;
+            auto defSequence = entry->effectiveAutoTypeSequence();
+            if (!defSequence.isEmpty()) {
+                matches.append({entry, defSequence});
+                sequences << defSequence;
+            }
+            for (const auto& assoc : entry->autoTypeAssociations()->getAll()) {
+                if (!sequences.contains(assoc.sequence) && !assoc.sequence.isEmpty()) {
+                    matches.append({entry, assoc.sequence});
+                    sequences << assoc.sequence;
                 }
             }
         }
 
-        m_ui->view->setMatchList(matches);
+        m_ui->view->setMatchList(matches, ranked);
+        m_searchResults.insert(searchText, new QList<AutoTypeMatch>(matches));
     }
 
+    selectSearchMatch();
+}
+
+void AutoTypeSelectDialog::selectSearchMatch()
+{
     bool selected = false;
     if (m_lastMatch.first) {
         selected = m_ui->view->selectMatch(m_lastMatch);
@@ -20,6 +20,7 @@
 #define KEEPASSX_AUTOTYPESELECTDIALOG_H
 
 #include "autotype/AutoTypeMatch.h"
+#include <QCache>
 #include <QDialog>
 #include <QTimer>
 
@@ -55,17 +56,21 @@ protected:
 private slots:
     void submitAutoTypeMatch(AutoTypeMatch match);
     void performSearch();
+    void clearSearchResults();
     void activateCurrentMatch();
     void updateActionMenu(const AutoTypeMatch& match);
 
 private:
     void buildActionMenu();
     void setDelayedSearch(bool state);
+    void selectSearchMatch();
 
     QScopedPointer<Ui::AutoTypeSelectDialog> m_ui;
 
     QList<QSharedPointer<Database>> m_dbs;
     QList<AutoTypeMatch> m_matches;
+    // Results of recent searches by search text
+    QCache<QString, QList<AutoTypeMatch>> m_searchResults{32};
     AutoTypeMatch m_lastMatch;
     QTimer m_searchTimer;
     QPointer<QMenu> m_actionMenu;
@@ -60,6 +60,15 @@ AutoTypePlatformX11::AutoTypePlatformX11()
                      << "xfce4-panel"; // Xfce 4
 
     m_xkb = nullptr;
+    m_keymapStale = true;
+
+    // Get notified about keyboard mapping changes so the keymap is only rebuilt when needed
+    int xkbOpcode, xkbError, xkbMajor = XkbMajorVersion, xkbMinor = XkbMinorVersion;
+    m_xkbEventBase = -1;
+    if (XkbQueryExtension(m_dpy, &xkbOpcode, &m_xkbEventBase, &xkbError, &xkbMajor, &xkbMinor)) {
+        const unsigned int mask = XkbNewKeyboardNotifyMask | XkbMapNotifyMask;
+        XkbSelectEvents(m_dpy, XkbUseCoreKbd, mask, mask);
+    }
 
     m_loaded = true;
 }
@@ -292,13 +301,35 @@ bool AutoTypePlatformX11::isTopLevelWindow(Window window)
     return result;
 }
 
+/*
+ * Read the events queued on our connection and note whether the keyboard
+ * mapping changed since the keymap was built. The events are discarded
+ * afterwards, e.g. to skip the notifications caused by our own remapping.
+ */
+void AutoTypePlatformX11::processKeymapEvents(bool discard)
+{
+    while (XPending(m_dpy) > 0) {
+        XEvent event;
+        XNextEvent(m_dpy, &event);
+        if (!discard && (event.type == MappingNotify || (m_xkbEventBase >= 0 && event.type == m_xkbEventBase))) {
+            m_keymapStale = true;
+        }
+    }
+}
+
 /*
  * Update the keyboard and modifier mapping.
  * We need the KeyboardMapping for AddKeysym.
  * Modifier mapping is required for clearing the modifiers.
+ * The mapping is cached until the server reports that it changed.
  */
 void AutoTypePlatformX11::updateKeymap()
 {
+    processKeymapEvents();
+    if (m_xkb && !m_keymapStale) {
+        return;
+    }
+
     if (m_xkb) {
         XkbFreeKeyboard(m_xkb, XkbAllComponentsMask, True);
     }
@@ -307,6 +338,8 @@ void AutoTypePlatformX11::updateKeymap()
     /* workaround X11 bug https://gitlab.freedesktop.org/xorg/xserver/-/issues/1155 */
     XkbSetMap(m_dpy, XkbAllClientInfoMask, m_xkb);
     XSync(m_dpy, False);
+    processKeymapEvents(true);
+    m_keymapStale = false;
 
     /* Build updated keymap */
     m_keymap.clear();
@@ -366,20 +399,12 @@ void AutoTypePlatformX11::updateKeymap()
 // --------------------------------------------------------------------------
 
 /*
- * Send event to the focused window.
- * If input focus is specified explicitly, select the window
- * before send event to the window.
+ * Queue a key event for the focused window.
+ * The caller flushes the queued events with a single XSync.
  */
 void AutoTypePlatformX11::SendKeyEvent(unsigned keycode, bool press)
 {
-    XSync(m_dpy, False);
-    int (*oldHandler)(Display*, XErrorEvent*) = XSetErrorHandler(MyErrorHandler);
-
     XTestFakeKeyEvent(m_dpy, keycode, press, 0);
-    XFlush(m_dpy);
-    XSync(m_dpy, False);
-
-    XSetErrorHandler(oldHandler);
 }
 
 /*
@@ -460,6 +485,9 @@ bool AutoTypePlatformX11::RemapKeycode(KeySym keysym)
         return false;
     }
 
+    // Keep changes by others, the notifications of our own change are dropped below
+    processKeymapEvents();
+
     if (keysym != NoSymbol) {
         int type = XkbOneLevelIndex;
         if (XkbChangeTypesOfKey(m_xkb, m_remapKeycode, 1, XkbGroup1Mask, &type, NULL) != Success) {
@@ -472,8 +500,8 @@ bool AutoTypePlatformX11::RemapKeycode(KeySym keysym)
     }
 
     XkbSetMap(m_dpy, XkbAllClientInfoMask, m_xkb);
-    XFlush(m_dpy);
     XSync(m_dpy, False);
+    processKeymapEvents(true);
     return true;
 }
 
@@ -506,7 +534,6 @@ AutoTypeAction::Result AutoTypePlatformX11::sendKey(KeySym keysym, unsigned int
     int root_x, root_y, x, y;
     unsigned int original_mask;
 
-    XSync(m_dpy, False);
     XQueryPointer(m_dpy, m_rootWindow, &root, &child, &root_x, &root_y, &x, &y, &original_mask);
 
     /* fail permanently if Caps Lock is on */
@@ -536,6 +563,9 @@ AutoTypeAction::Result AutoTypePlatformX11::sendKey(KeySym keysym, unsigned int
         XFlush(m_dpy);
     }
 
+    /* queue all events and wait for the server once, errors are trapped until then */
+    int (*oldHandler)(Display*, XErrorEvent*) = XSetErrorHandler(MyErrorHandler);
+
     /* hold modifiers */
     SendModifiers(press_mask, true);
 
@@ -548,6 +578,9 @@ AutoTypeAction::Result AutoTypePlatformX11::sendKey(KeySym keysym, unsigned int
     /* release modifiers */
     SendModifiers(press_mask, false);
 
+    XSync(m_dpy, False);
+    XSetErrorHandler(oldHandler);
+
     /* reset layout group if necessary */
     if (group_active != group) {
         XkbLockGroup(m_dpy, XkbUseCoreKbd, group_active);
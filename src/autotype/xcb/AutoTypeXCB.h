@@ -58,6 +58,7 @@ private:
     bool isTopLevelWindow(Window window);
 
     XkbDescPtr getKeyboard();
+    void processKeymapEvents(bool discard = false);
     bool RemapKeycode(KeySym keysym);
     void SendKeyEvent(unsigned keycode, bool press);
     void SendModifiers(unsigned int mask, bool press);
@@ -86,6 +87,8 @@ private:
     } KeyDesc;
 
     XkbDescPtr m_xkb;
+    int m_xkbEventBase;
+    bool m_keymapStale;
     QList<KeyDesc> m_keymap;
     KeyCode m_modifier_keycode[N_MOD_INDICES];
     KeyCode m_remapKeycode;
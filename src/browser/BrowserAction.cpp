@@ -17,6 +17,7 @@
 
 #include "BrowserAction.h"
 #include "BrowserMessageBuilder.h"
+#include "BrowserRequestTrace.h"
 #ifdef WITH_XC_BROWSER_PASSKEYS
 #include "BrowserPasskeys.h"
 #include "PasskeyUtils.h"
@@ -24,6 +25,7 @@
 #include "BrowserSettings.h"
 #include "core/Global.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 
 #include <QJsonDocument>
 #include <QLocalSocket>
@@ -80,6 +82,7 @@ QJsonObject BrowserAction::processClientMessage(QLocalSocket* socket, const QJso
 
 QJsonObject BrowserAction::handleAction(QLocalSocket* socket, const QJsonObject& json)
 {
+    TRACE_SCOPE("BrowserAction::handleAction");
     QString action = json.value("action").toString();
 
     if (action.compare(BROWSER_REQUEST_CHANGE_PUBLIC_KEYS) == 0) {
@@ -409,12 +412,26 @@ QJsonObject BrowserAction::handleGetDatabaseEntries(const QJsonObject& json, con
         return getErrorReply(action, ERROR_KEEPASS_ACCESS_TO_ALL_ENTRIES_DENIED);
     }
 
-    const QJsonArray entries = browserService()->getDatabaseEntries();
+    // Optional paging: "limit" entries per response continuing at "cursor", and a projection of "fields"
+    QStringList fields;
+    for (const auto& field : browserRequest.getArray("fields")) {
+        fields << field.toString();
+    }
+    const int limit = browserRequest.decrypted.value("limit").toInt();
+    auto cursor = browserRequest.getString("cursor");
+
+    const QJsonArray entries = browserService()->getDatabaseEntries(fields, limit, &cursor);
+    if (cursor.isNull()) {
+        return getErrorReply(action, ERROR_KEEPASS_NO_VALID_UUID_PROVIDED);
+    }
     if (entries.isEmpty()) {
         return getErrorReply(action, ERROR_KEEPASS_NO_GROUPS_FOUND);
     }
 
-    const Parameters params{{"entries", entries}};
+    Parameters params{{"entries", entries}};
+    if (!cursor.isEmpty()) {
+        params.insert("cursor", cursor);
+    }
 
     return buildResponse(action, browserRequest.incrementedNonce, params);
 }
@@ -589,6 +606,7 @@ QJsonObject BrowserAction::handlePasskeysRegister(const QJsonObject& json, const
 
 QJsonObject BrowserAction::decryptMessage(const QString& message, const QString& nonce)
 {
+    BrowserRequestTrace::Span span("decrypt");
     return browserMessageBuilder()->decryptMessage(message, nonce, m_clientPublicKey, m_secretKey);
 }
 
@@ -599,6 +617,7 @@ QJsonObject BrowserAction::getErrorReply(const QString& action, const int errorC
 
 QJsonObject BrowserAction::buildResponse(const QString& action, const QString& nonce, const Parameters& params)
 {
+    BrowserRequestTrace::Span span("encrypt");
     return browserMessageBuilder()->buildResponse(action, nonce, params, m_clientPublicKey, m_secretKey);
 }
 
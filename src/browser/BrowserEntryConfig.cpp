@@ -21,12 +21,43 @@
 #include "core/Entry.h"
 #include "core/Tools.h"
 
+#include <QCache>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMutex>
 #include <QVariant>
 
 static const char KEEPASSXCBROWSER_NAME[] = "KeePassXC-Browser Settings";
 
+namespace
+{
+    struct ParsedConfig
+    {
+        QSet<QString> allowedHosts;
+        QSet<QString> deniedHosts;
+        QString realm;
+    };
+
+    // Settings are parsed once for every distinct JSON text, so a changed
+    // setting is simply looked up under its new text
+    struct ParsedConfigCache
+    {
+        QMutex mutex;
+        QCache<QString, ParsedConfig> configs{4096};
+    };
+    Q_GLOBAL_STATIC(ParsedConfigCache, s_parsedConfigs)
+
+    QSet<QString> hostsFromJson(const QJsonValue& value)
+    {
+        QSet<QString> hosts;
+        for (const auto& host : value.toArray()) {
+            hosts.insert(host.toVariant().toString());
+        }
+        return hosts;
+    }
+} // namespace
+
 BrowserEntryConfig::BrowserEntryConfig(QObject* parent)
     : QObject(parent)
 {
@@ -91,15 +122,26 @@ bool BrowserEntryConfig::load(const Entry* entry)
         return false;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(s.toUtf8());
-    if (doc.isNull()) {
-        return false;
+    QMutexLocker locker(&s_parsedConfigs->mutex);
+    const auto* parsed = s_parsedConfigs->configs.object(s);
+    if (!parsed) {
+        QJsonDocument doc = QJsonDocument::fromJson(s.toUtf8());
+        if (doc.isNull()) {
+            return false;
+        }
+
+        const auto object = doc.object();
+        auto* config = new ParsedConfig();
+        config->allowedHosts = hostsFromJson(object.value("Allow"));
+        config->deniedHosts = hostsFromJson(object.value("Deny"));
+        config->realm = object.value("Realm").toString();
+        s_parsedConfigs->configs.insert(s, config);
+        parsed = config;
     }
 
-    QVariantMap map = doc.object().toVariantMap();
-    for (QVariantMap::const_iterator iter = map.cbegin(); iter != map.cend(); ++iter) {
-        setProperty(iter.key().toLatin1(), iter.value());
-    }
+    m_allowedHosts = parsed->allowedHosts;
+    m_deniedHosts = parsed->deniedHosts;
+    m_realm = parsed->realm;
     return true;
 }
 
@@ -39,6 +39,11 @@ BrowserMessageBuilder* BrowserMessageBuilder::instance()
     return s_browserMessageBuilder;
 }
 
+BrowserMessageBuilder::~BrowserMessageBuilder()
+{
+    clearSharedKeys();
+}
+
 QPair<QString, QString> BrowserMessageBuilder::getKeyPair()
 {
     unsigned char pk[crypto_box_PUBLICKEYBYTES];
@@ -200,26 +205,22 @@ QString BrowserMessageBuilder::encrypt(const QString& plaintext,
                                        const QString& publicKey,
                                        const QString& secretKey)
 {
-    const QByteArray ma = plaintext.toUtf8();
-    const QByteArray na = base64Decode(nonce);
-    const QByteArray ca = base64Decode(publicKey);
-    const QByteArray sa = base64Decode(secretKey);
+    const QByteArray m = plaintext.toUtf8();
+    const QByteArray n = base64Decode(nonce);
+    const QByteArray key = sharedKey(publicKey, secretKey);
 
-    std::vector<unsigned char> m(ma.cbegin(), ma.cend());
-    std::vector<unsigned char> n(na.cbegin(), na.cend());
-    std::vector<unsigned char> ck(ca.cbegin(), ca.cend());
-    std::vector<unsigned char> sk(sa.cbegin(), sa.cend());
-
-    std::vector<unsigned char> e;
-    e.resize(BrowserShared::NATIVEMSG_MAX_LENGTH);
-
-    if (m.empty() || n.empty() || ck.empty() || sk.empty()) {
+    if (m.isEmpty() || n.size() != static_cast<int>(crypto_box_NONCEBYTES) || key.isEmpty()) {
         return {};
     }
 
-    if (crypto_box_easy(e.data(), m.data(), m.size(), n.data(), ck.data(), sk.data()) == 0) {
-        QByteArray res = getQByteArray(e.data(), (crypto_box_MACBYTES + ma.length()));
-        return res.toBase64();
+    QByteArray e(static_cast<int>(crypto_box_MACBYTES) + m.size(), Qt::Uninitialized);
+    if (crypto_box_easy_afternm(reinterpret_cast<uchar*>(e.data()),
+                                reinterpret_cast<const uchar*>(m.constData()),
+                                m.size(),
+                                reinterpret_cast<const uchar*>(n.constData()),
+                                reinterpret_cast<const uchar*>(key.constData()))
+        == 0) {
+        return e.toBase64();
     }
 
     return {};
@@ -230,28 +231,85 @@ QByteArray BrowserMessageBuilder::decrypt(const QString& encrypted,
                                           const QString& publicKey,
                                           const QString& secretKey)
 {
-    const QByteArray ma = base64Decode(encrypted);
-    const QByteArray na = base64Decode(nonce);
-    const QByteArray ca = base64Decode(publicKey);
-    const QByteArray sa = base64Decode(secretKey);
+    const QByteArray m = base64Decode(encrypted);
+    const QByteArray n = base64Decode(nonce);
+    const QByteArray key = sharedKey(publicKey, secretKey);
+
+    if (m.size() <= static_cast<int>(crypto_box_MACBYTES) || n.size() != static_cast<int>(crypto_box_NONCEBYTES)
+        || key.isEmpty()) {
+        return {};
+    }
+
+    QByteArray d(m.size() - static_cast<int>(crypto_box_MACBYTES), Qt::Uninitialized);
+    if (crypto_box_open_easy_afternm(reinterpret_cast<uchar*>(d.data()),
+                                     reinterpret_cast<const uchar*>(m.constData()),
+                                     m.size(),
+                                     reinterpret_cast<const uchar*>(n.constData()),
+                                     reinterpret_cast<const uchar*>(key.constData()))
+        == 0) {
+        // Messages end at the first NUL character
+        const int end = d.indexOf('\0');
+        if (end >= 0) {
+            d.truncate(end);
+        }
+        return d;
+    }
+
+    return {};
+}
 
-    std::vector<unsigned char> m(ma.cbegin(), ma.cend());
-    std::vector<unsigned char> n(na.cbegin(), na.cend());
-    std::vector<unsigned char> ck(ca.cbegin(), ca.cend());
-    std::vector<unsigned char> sk(sa.cbegin(), sa.cend());
+/**
+ * Shared key of a client public key and our secret key, computed once per session
+ * instead of for every message.
+ */
+QByteArray BrowserMessageBuilder::sharedKey(const QString& publicKey, const QString& secretKey)
+{
+    static const int MaxSharedKeys = 32;
+
+    // Look the key up by a digest so the secret key itself is not kept around
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(publicKey.toUtf8());
+    hash.addData("\n", 1);
+    hash.addData(secretKey.toUtf8());
+    const QByteArray id = hash.result();
+
+    QMutexLocker locker(&m_sharedKeysMutex);
+    auto it = m_sharedKeys.constFind(id);
+    if (it != m_sharedKeys.cend()) {
+        return it.value();
+    }
 
-    std::vector<unsigned char> d;
-    d.resize(BrowserShared::NATIVEMSG_MAX_LENGTH);
+    const QByteArray pk = base64Decode(publicKey);
+    QByteArray sk = base64Decode(secretKey);
+    if (pk.size() != static_cast<int>(crypto_box_PUBLICKEYBYTES)
+        || sk.size() != static_cast<int>(crypto_box_SECRETKEYBYTES)) {
+        sodium_memzero(sk.data(), sk.size());
+        return {};
+    }
 
-    if (m.empty() || n.empty() || ck.empty() || sk.empty()) {
+    QByteArray key(static_cast<int>(crypto_box_BEFORENMBYTES), Qt::Uninitialized);
+    const int result = crypto_box_beforenm(reinterpret_cast<uchar*>(key.data()),
+                                           reinterpret_cast<const uchar*>(pk.constData()),
+                                           reinterpret_cast<const uchar*>(sk.constData()));
+    sodium_memzero(sk.data(), sk.size());
+    if (result != 0) {
         return {};
     }
 
-    if (crypto_box_open_easy(d.data(), m.data(), ma.length(), n.data(), ck.data(), sk.data()) == 0) {
-        return getQByteArray(d.data(), std::char_traits<char>::length(reinterpret_cast<const char*>(d.data())));
+    // Old sessions are not tracked, start over once there are too many
+    if (m_sharedKeys.size() >= MaxSharedKeys) {
+        clearSharedKeys();
     }
+    m_sharedKeys.insert(id, key);
+    return key;
+}
 
-    return {};
+void BrowserMessageBuilder::clearSharedKeys()
+{
+    for (auto& key : m_sharedKeys) {
+        sodium_memzero(key.data(), key.size());
+    }
+    m_sharedKeys.clear();
 }
 
 QString BrowserMessageBuilder::getBase64FromKey(const uchar* array, const uint len)
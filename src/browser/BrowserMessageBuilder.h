@@ -18,6 +18,8 @@
 #ifndef KEEPASSXC_BROWSERMESSAGEBUILDER_H
 #define KEEPASSXC_BROWSERMESSAGEBUILDER_H
 
+#include <QHash>
+#include <QMutex>
 #include <QPair>
 #include <QString>
 #include <QVariant>
@@ -70,6 +72,7 @@ class BrowserMessageBuilder
 {
 public:
     explicit BrowserMessageBuilder() = default;
+    ~BrowserMessageBuilder();
     static BrowserMessageBuilder* instance();
 
     QPair<QString, QString> getKeyPair();
@@ -108,6 +111,13 @@ public:
     QString getSha256HashAsBase64(const QString& str) const;
 
 private:
+    QByteArray sharedKey(const QString& publicKey, const QString& secretKey);
+    void clearSharedKeys();
+
+    // Precomputed crypto_box keys of the active client sessions by a digest of public and secret key
+    QMutex m_sharedKeysMutex;
+    QHash<QByteArray, QByteArray> m_sharedKeys;
+
     Q_DISABLE_COPY(BrowserMessageBuilder);
 
     friend class TestBrowser;
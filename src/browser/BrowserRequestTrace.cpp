@@ -0,0 +1,107 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrowserRequestTrace.h"
+#include "BrowserSettings.h"
+
+#include <QDebug>
+#include <QStringList>
+
+namespace
+{
+    const int MaxHistory = 64;
+
+    BrowserRequestTrace* currentTrace = nullptr;
+    QList<BrowserRequestTrace::Record> traceHistory;
+} // namespace
+
+QString BrowserRequestTrace::Record::toString() const
+{
+    QStringList parts;
+    for (const auto& span : spans) {
+        parts << QString("%1 %2us").arg(span.first).arg(span.second);
+    }
+    return QString("%1: %2 (total %3us)").arg(action, parts.join(", ")).arg(totalUsec);
+}
+
+BrowserRequestTrace::Span::Span(const char* name)
+    : m_name(name)
+    , m_trace(currentTrace)
+{
+    if (m_trace && m_trace->m_enabled) {
+        m_timer.start();
+    }
+}
+
+BrowserRequestTrace::Span::~Span()
+{
+    end();
+}
+
+void BrowserRequestTrace::Span::end()
+{
+    if (!m_timer.isValid()) {
+        return;
+    }
+    m_trace->m_record.spans.append({QString::fromLatin1(m_name), m_timer.nsecsElapsed() / 1000});
+    m_timer.invalidate();
+}
+
+BrowserRequestTrace::BrowserRequestTrace(const QString& action)
+    : m_previous(currentTrace)
+    , m_enabled(isEnabled())
+{
+    currentTrace = this;
+    if (m_enabled) {
+        m_record.action = action;
+        m_timer.start();
+    }
+}
+
+BrowserRequestTrace::~BrowserRequestTrace()
+{
+    currentTrace = m_previous;
+    if (!m_enabled) {
+        return;
+    }
+
+    m_record.totalUsec = m_timer.nsecsElapsed() / 1000;
+    qDebug().noquote() << "Browser request" << m_record.toString();
+
+    traceHistory.append(m_record);
+    while (traceHistory.size() > MaxHistory) {
+        traceHistory.removeFirst();
+    }
+}
+
+bool BrowserRequestTrace::isEnabled()
+{
+    return browserSettings()->traceRequests();
+}
+
+/**
+ * Most recently finished traces, oldest first.
+ */
+QList<BrowserRequestTrace::Record> BrowserRequestTrace::history()
+{
+    return traceHistory;
+}
+
+void BrowserRequestTrace::clearHistory()
+{
+    traceHistory.clear();
+}
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BROWSERREQUESTTRACE_H
+#define KEEPASSXC_BROWSERREQUESTTRACE_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/**
+ * Timing of the stages of a browser request, enabled by the hidden
+ * Browser/TraceRequests setting.
+ *
+ * A trace is created for each request and collects the spans opened while it
+ * is the current trace. Requests started while a dialog of another request is
+ * open get their own trace. Finished traces are written to the debug log and
+ * kept in a short history.
+ */
+class BrowserRequestTrace
+{
+public:
+    struct Record
+    {
+        QString action;
+        qint64 totalUsec = 0;
+        // Stage name and duration in order of completion
+        QList<QPair<QString, qint64>> spans;
+
+        QString toString() const;
+    };
+
+    class Span
+    {
+    public:
+        explicit Span(const char* name);
+        ~Span();
+        void end();
+
+    private:
+        const char* m_name;
+        BrowserRequestTrace* m_trace;
+        QElapsedTimer m_timer;
+
+        Q_DISABLE_COPY(Span)
+    };
+
+    explicit BrowserRequestTrace(const QString& action);
+    ~BrowserRequestTrace();
+
+    static bool isEnabled();
+    static QList<Record> history();
+    static void clearHistory();
+
+private:
+    BrowserRequestTrace* m_previous;
+    bool m_enabled;
+    Record m_record;
+    QElapsedTimer m_timer;
+
+    Q_DISABLE_COPY(BrowserRequestTrace)
+};
+
+#endif // KEEPASSXC_BROWSERREQUESTTRACE_H
@@ -23,7 +23,9 @@
 #include "BrowserEntrySaveDialog.h"
 #include "BrowserHost.h"
 #include "BrowserMessageBuilder.h"
+#include "BrowserRequestTrace.h"
 #include "BrowserSettings.h"
+#include "core/Clock.h"
 #include "core/Tools.h"
 #include "core/UrlTools.h"
 #include "gui/MainWindow.h"
@@ -227,8 +229,23 @@ QJsonObject BrowserService::getDatabaseGroups()
     return result;
 }
 
-QJsonArray BrowserService::getDatabaseEntries()
+/**
+ * List the entries of the current database, optionally one page at a time.
+ *
+ * @param fields entry fields to include out of title, uuid and url, all of them if none is given
+ * @param limit maximum number of entries to return, no limit if zero or less
+ * @param cursor position to continue from, empty to start at the first entry. Receives
+ *               the position of the next page, or an empty string after the last one.
+ *               Set to a null string if the given position is invalid.
+ */
+QJsonArray BrowserService::getDatabaseEntries(const QStringList& fields, int limit, QString* cursor)
 {
+    QString start;
+    if (cursor) {
+        start = *cursor;
+        *cursor = "";
+    }
+
     auto db = getDatabase();
     if (!db) {
         return {};
@@ -239,19 +256,65 @@ QJsonArray BrowserService::getDatabaseEntries()
         return {};
     }
 
-    QJsonArray entries;
-    for (const auto& group : rootGroup->groupsRecursive(true)) {
+    QList<const Entry*> allEntries;
+    rootGroup->forEachGroupRecursive([&](const Group* group) {
         if (group == db->metadata()->recycleBin()) {
-            continue;
+            return;
         }
 
         for (const auto& entry : group->entries()) {
-            QJsonObject jentry;
+            allEntries.append(entry);
+        }
+    });
+
+    // Cursors hold the position and uuid of the next entry so pages stay
+    // consistent if entries were added or removed in between
+    int offset = 0;
+    if (!start.isEmpty()) {
+        const auto parts = start.split(':');
+        bool ok = parts.size() == 2;
+        offset = ok ? parts.first().toInt(&ok) : 0;
+        const auto uuid = Tools::hexToUuid(parts.last());
+        if (!ok || offset < 0 || uuid.isNull()) {
+            if (cursor) {
+                *cursor = QString();
+            }
+            return {};
+        }
+        if (offset >= allEntries.size() || allEntries.at(offset)->uuid() != uuid) {
+            auto it = std::find_if(allEntries.cbegin(), allEntries.cend(), [&uuid](const Entry* entry) {
+                return entry->uuid() == uuid;
+            });
+            if (it != allEntries.cend()) {
+                offset = static_cast<int>(it - allEntries.cbegin());
+            }
+        }
+    }
+
+    const bool allFields = !fields.contains("title") && !fields.contains("uuid") && !fields.contains("url");
+    const bool withTitle = allFields || fields.contains("title");
+    const bool withUuid = allFields || fields.contains("uuid");
+    const bool withUrl = allFields || fields.contains("url");
+
+    const int end = limit > 0 ? qMin(offset + limit, allEntries.size()) : allEntries.size();
+    QJsonArray entries;
+    for (int i = offset; i < end; ++i) {
+        const auto entry = allEntries.at(i);
+        QJsonObject jentry;
+        if (withTitle) {
             jentry["title"] = entry->resolveMultiplePlaceholders(entry->title());
+        }
+        if (withUuid) {
             jentry["uuid"] = entry->resolveMultiplePlaceholders(entry->uuidToHex());
+        }
+        if (withUrl) {
             jentry["url"] = entry->resolveMultiplePlaceholders(entry->url());
-            entries.push_back(jentry);
         }
+        entries.push_back(jentry);
+    }
+
+    if (cursor && end < allEntries.size()) {
+        *cursor = QString("%1:%2").arg(end).arg(allEntries.at(end)->uuidToHex());
     }
     return entries;
 }
@@ -358,6 +421,22 @@ BrowserService::findEntries(const EntryParameters& entryParameters, const String
         *entriesFound = false;
     }
 
+    static const qint64 MissedLookupLifetime = 10 * 1000;
+    static const int MaxMissedLookups = 256;
+
+    BrowserRequestTrace::Span lookupSpan("lookup");
+
+    // Pages without credentials are asked for repeatedly, by frames and as they change
+    const auto cacheKey = lookupCacheKey(entryParameters, keyList);
+    const auto now = Clock::currentMilliSecondsSinceEpoch();
+    auto missed = m_missedLookups.constFind(cacheKey);
+    if (missed != m_missedLookups.cend()) {
+        if (now - missed.value() < MissedLookupLifetime) {
+            return {};
+        }
+        m_missedLookups.erase(missed);
+    }
+
     const bool alwaysAllowAccess = browserSettings()->alwaysAllowAccess();
     const bool ignoreHttpAuth = browserSettings()->httpAuthPermission();
     const QString siteHost = QUrl(entryParameters.siteUrl).host();
@@ -408,15 +487,23 @@ BrowserService::findEntries(const EntryParameters& entryParameters, const String
     }
 
     if (entriesToConfirm.isEmpty() && allowedEntries.isEmpty()) {
+        if (m_missedLookups.size() >= MaxMissedLookups) {
+            m_missedLookups.clear();
+        }
+        m_missedLookups.insert(cacheKey, now);
         return {};
     }
 
+    lookupSpan.end();
+
     // Confirm entries
+    BrowserRequestTrace::Span confirmSpan("confirm");
     auto selectedEntriesToConfirm =
         confirmEntries(entriesToConfirm, entryParameters, siteHost, formHost, entryParameters.httpAuth);
     if (!selectedEntriesToConfirm.isEmpty()) {
         allowedEntries.append(selectedEntriesToConfirm);
     }
+    confirmSpan.end();
 
     // Ensure that database is not locked when the popup was visible
     if (!isDatabaseOpened()) {
@@ -424,7 +511,9 @@ BrowserService::findEntries(const EntryParameters& entryParameters, const String
     }
 
     // Sort results
+    BrowserRequestTrace::Span sortSpan("sort");
     allowedEntries = sortEntries(allowedEntries, entryParameters.siteUrl, entryParameters.formUrl);
+    sortSpan.end();
 
     // Fill the list
     QJsonArray entries;
@@ -439,6 +528,53 @@ BrowserService::findEntries(const EntryParameters& entryParameters, const String
     return entries;
 }
 
+/**
+ * Identify a credential lookup by everything its result depends on: the site,
+ * the searched databases and their revision, the connection keys and the
+ * browser settings. Any change to a database gives its lookups a new key.
+ */
+QString BrowserService::lookupCacheKey(const EntryParameters& entryParameters, const StringPairList& keyList)
+{
+    // Only scheme, host and port of web sites are matched, see handleURL()
+    auto normalizedUrl = [](const QString& url) {
+        const QUrl qUrl(url);
+        if (qUrl.scheme() == "http" || qUrl.scheme() == "https") {
+            return qUrl.adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment)
+                .toString();
+        }
+        return url;
+    };
+
+    QStringList parts{normalizedUrl(entryParameters.siteUrl),
+                      normalizedUrl(entryParameters.formUrl),
+                      entryParameters.realm,
+                      QString::number(entryParameters.httpAuth),
+                      QString::number(browserSettings()->searchInAllDatabases()),
+                      QString::number(browserSettings()->matchUrlScheme()),
+                      QString::number(browserSettings()->alwaysAllowAccess()),
+                      QString::number(browserSettings()->httpAuthPermission())};
+    for (const auto& key : keyList) {
+        parts << key.first << key.second;
+    }
+
+    auto addDatabase = [&parts](const QSharedPointer<Database>& db) {
+        if (db) {
+            parts << QString::number(reinterpret_cast<quintptr>(db.data()), 16)
+                  << QString::number(db->contentRevision());
+        }
+    };
+
+    addDatabase(getDatabase());
+    if (getMainWindow()) {
+        for (auto dbWidget : getMainWindow()->getOpenDatabases()) {
+            parts << QString::number(dbWidget->isLocked());
+            addDatabase(dbWidget->database());
+        }
+    }
+
+    return parts.join('\n');
+}
+
 QList<Entry*> BrowserService::confirmEntries(QList<Entry*>& entriesToConfirm,
                                              const EntryParameters& entryParameters,
                                              const QString& siteHost,
@@ -963,22 +1099,44 @@ QList<Entry*> BrowserService::searchEntries(const QSharedPointer<Database>& db,
         return entries;
     }
 
-    for (const auto& group : rootGroup->groupsRecursive(true)) {
+    // Look up the entries sharing the domain of the site or the relying party, special URLs need a full scan
+    QHash<const Group*, QSet<const Entry*>> candidates;
+    const bool useIndex = passkey || (!siteUrl.startsWith("keepassxc://") && !siteUrl.startsWith("file://"));
+    if (useIndex) {
+        const auto indexed = passkey ? db->passkeyIndex().entriesForRelyingParty(siteUrl)
+                                     : db->urlIndex().candidates(QUrl(siteUrl).host());
+        if (indexed.isEmpty()) {
+            return entries;
+        }
+        for (const auto* entry : indexed) {
+            candidates[entry->group()].insert(entry);
+        }
+    }
+
+    rootGroup->forEachGroupRecursive([&](Group* group) {
+        if (useIndex && !candidates.contains(group)) {
+            return;
+        }
+
         if (group->isRecycled()
             || group->resolveCustomDataTriState(BrowserService::OPTION_HIDE_ENTRY) == Group::Enable) {
-            continue;
+            return;
         }
 
         // If a key restriction is specified and not contained in the keys list then skip this group.
         auto restrictKey = group->resolveCustomDataString(BrowserService::OPTION_RESTRICT_KEY);
         if (!restrictKey.isEmpty() && !keys.contains(restrictKey)) {
-            continue;
+            return;
         }
 
         const auto omitWwwSubdomain =
             group->resolveCustomDataTriState(BrowserService::OPTION_OMIT_WWW) == Group::Enable;
 
+        const auto groupCandidates = candidates.value(group);
         for (auto* entry : group->entries()) {
+            if (useIndex && !groupCandidates.contains(entry)) {
+                continue;
+            }
             if (entry->isRecycled()
                 || (entry->customData()->contains(BrowserService::OPTION_HIDE_ENTRY)
                     && entry->customData()->value(BrowserService::OPTION_HIDE_ENTRY) == TRUE_STR)) {
@@ -1001,7 +1159,7 @@ QList<Entry*> BrowserService::searchEntries(const QSharedPointer<Database>& db,
                 entries.append(entry);
             }
         }
-    }
+    });
 
     return entries;
 }
@@ -1323,8 +1481,7 @@ bool BrowserService::shouldIncludeEntry(Entry* entry,
         return url.endsWith("by-path/" + entry->path());
     }
 
-    const auto allEntryUrls = entry->getAllUrls();
-    for (const auto& entryUrl : allEntryUrls) {
+    for (const auto& entryUrl : entry->parsedUrls()) {
         if (handleURL(entryUrl, url, submitUrl, omitWwwSubdomain)) {
             return true;
         }
@@ -1398,6 +1555,17 @@ bool BrowserService::isPasskeyCredentialExcluded(const QJsonArray& excludeCreden
         allIds << cred["id"].toString();
     }
 
+    // Usually none of the excluded credentials is stored, which needs no search
+    const auto openDatabases = getOpenDatabases();
+    const auto isStored = std::any_of(openDatabases.begin(), openDatabases.end(), [&](const auto& db) {
+        return std::any_of(allIds.begin(), allIds.end(), [&](const auto& id) {
+            return !db->passkeyIndex().entriesForCredential(id).isEmpty();
+        });
+    });
+    if (!isStored) {
+        return false;
+    }
+
     const auto passkeyEntries = getPasskeyEntries(rpId, keyList);
     return std::any_of(passkeyEntries.begin(), passkeyEntries.end(), [&](const auto& entry) {
         return allIds.contains(passkeyUtils()->getCredentialIdFromEntry(entry));
@@ -1415,61 +1583,66 @@ bool BrowserService::handleURL(const QString& entryUrl,
                                const QString& formUrl,
                                const bool omitWwwSubdomain)
 {
-    if (entryUrl.isEmpty()) {
+    return handleURL(Entry::parseUrl(entryUrl), siteUrl, formUrl, omitWwwSubdomain);
+}
+
+bool BrowserService::handleURL(const Entry::ParsedUrl& entryUrl,
+                               const QString& siteUrl,
+                               const QString& formUrl,
+                               const bool omitWwwSubdomain)
+{
+    if (entryUrl.url.isEmpty()) {
         return false;
     }
 
-    QUrl entryQUrl;
-    if (entryUrl.contains("://")) {
-        entryQUrl = entryUrl;
-    } else {
-        entryQUrl = QUrl::fromUserInput(entryUrl);
-
-        if (browserSettings()->matchUrlScheme()) {
-            entryQUrl.setScheme("https");
-        }
+    auto entryScheme = entryUrl.scheme;
+    if (!entryUrl.hasScheme && browserSettings()->matchUrlScheme()) {
+        entryScheme = "https";
     }
 
     // Remove WWW subdomain from matching if group setting is enabled
-    if (omitWwwSubdomain && entryQUrl.host().startsWith("www.")) {
-        entryQUrl.setHost(entryQUrl.host().remove("www."));
+    auto entryHost = entryUrl.host;
+    if (omitWwwSubdomain && entryHost.startsWith("www.")) {
+        entryHost.remove("www.");
     }
 
     // Make a direct compare if a local file is used
     if (siteUrl.startsWith("file://")) {
-        return entryUrl == formUrl;
+        return entryUrl.url == formUrl;
     }
 
     // URL host validation fails
-    if (entryQUrl.host().isEmpty()) {
+    if (entryHost.isEmpty()) {
         return false;
     }
 
     // Match port, if used
     QUrl siteQUrl(siteUrl);
-    if (entryQUrl.port() > 0 && entryQUrl.port() != siteQUrl.port()) {
+    if (entryUrl.port > 0 && entryUrl.port != siteQUrl.port()) {
         return false;
     }
 
     // Match scheme
-    if (browserSettings()->matchUrlScheme() && !entryQUrl.scheme().isEmpty()
-        && entryQUrl.scheme().compare(siteQUrl.scheme()) != 0) {
+    if (browserSettings()->matchUrlScheme() && !entryScheme.isEmpty()
+        && entryScheme.compare(siteQUrl.scheme()) != 0) {
         return false;
     }
 
     // Check for illegal characters
-    QRegularExpression re("[<>\\^`{|}]");
-    if (re.match(entryUrl).hasMatch()) {
+    static const QRegularExpression re("[<>\\^`{|}]");
+    if (re.match(entryUrl.url).hasMatch()) {
         return false;
     }
 
     // Match the base domain
-    if (urlTools()->getBaseDomainFromUrl(siteQUrl.host()) != urlTools()->getBaseDomainFromUrl(entryQUrl.host())) {
+    const auto entryBaseDomain =
+        entryHost == entryUrl.host ? entryUrl.baseDomain() : urlTools()->getBaseDomainFromUrl(entryHost);
+    if (urlTools()->getBaseDomainFromUrl(siteQUrl.host()) != entryBaseDomain) {
         return false;
     }
 
     // Match the subdomains with the limited wildcard
-    if (siteQUrl.host().endsWith(entryQUrl.host())) {
+    if (siteQUrl.host().endsWith(entryHost)) {
         return true;
     }
 
@@ -1639,12 +1812,36 @@ void BrowserService::processClientMessage(QLocalSocket* socket, const QJsonObjec
         return;
     }
 
+    // Requests run on the GUI thread and dialogs process events while they are open,
+    // so keep the requests of each client in order while other clients are served
+    if (m_pendingClientMessages.contains(clientID)) {
+        m_pendingClientMessages[clientID].append({socket, message});
+        return;
+    }
+    m_pendingClientMessages.insert(clientID, {});
+
     // Create a new client action if we haven't seen this id yet
     if (!m_browserClients.contains(clientID)) {
         m_browserClients.insert(clientID, QSharedPointer<BrowserAction>::create());
     }
 
-    auto& action = m_browserClients.value(clientID);
-    auto response = action->processClientMessage(socket, message);
-    m_browserHost->sendClientMessage(socket, response);
+    auto action = m_browserClients.value(clientID);
+    PendingClientMessage pending{socket, message};
+    while (true) {
+        // The proxy may have disconnected while the message was queued
+        if (pending.socket) {
+            BrowserRequestTrace trace(pending.message.value("action").toString());
+            auto response = action->processClientMessage(pending.socket, pending.message);
+
+            BrowserRequestTrace::Span sendSpan("send");
+            m_browserHost->sendClientMessage(pending.socket, response);
+        }
+
+        auto& queue = m_pendingClientMessages[clientID];
+        if (queue.isEmpty()) {
+            break;
+        }
+        pending = queue.takeFirst();
+    }
+    m_pendingClientMessages.remove(clientID);
 }
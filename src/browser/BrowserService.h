@@ -79,7 +79,7 @@ public:
     void lockDatabase();
 
     QJsonObject getDatabaseGroups();
-    QJsonArray getDatabaseEntries();
+    QJsonArray getDatabaseEntries(const QStringList& fields = {}, int limit = 0, QString* cursor = nullptr);
     QJsonObject createNewGroup(const QString& groupName);
     QString getCurrentTotp(const QString& uuid);
     void showPasswordGenerator(const KeyPairMessage& keyPairMessage);
@@ -166,6 +166,7 @@ private:
     QList<Entry*>
     searchEntries(const QString& siteUrl, const QString& formUrl, const StringPairList& keyList, bool passkey = false);
     QList<Entry*> sortEntries(QList<Entry*>& entries, const QString& siteUrl, const QString& formUrl);
+    QString lookupCacheKey(const EntryParameters& entryParameters, const StringPairList& keyList);
     QList<Entry*> confirmEntries(QList<Entry*>& entriesToConfirm,
                                  const EntryParameters& entryParameters,
                                  const QString& siteHost,
@@ -196,6 +197,10 @@ private:
                    const QString& siteUrl,
                    const QString& formUrl,
                    const bool omitWwwSubdomain = false);
+    bool handleURL(const Entry::ParsedUrl& entryUrl,
+                   const QString& siteUrl,
+                   const QString& formUrl,
+                   const bool omitWwwSubdomain = false);
     QString getDatabaseRootUuid();
     QString getDatabaseRecycleBinUuid();
     void hideWindow() const;
@@ -205,6 +210,16 @@ private:
     QPointer<BrowserHost> m_browserHost;
     QHash<QString, QSharedPointer<BrowserAction>> m_browserClients;
 
+    struct PendingClientMessage
+    {
+        QPointer<QLocalSocket> socket;
+        QJsonObject message;
+    };
+    // Messages of clients with a request still in progress, e.g. waiting for a dialog
+    QHash<QString, QList<PendingClientMessage>> m_pendingClientMessages;
+    // Recent lookups without any matching entry and when they were made, see lookupCacheKey()
+    QHash<QString, qint64> m_missedLookups;
+
     bool m_dialogActive;
     bool m_bringToFrontRequested;
     WindowState m_prevWindowState;
@@ -155,6 +155,16 @@ void BrowserSettings::setAllowLocalhostWithPasskeys(bool enabled)
     config()->set(Config::Browser_AllowLocalhostWithPasskeys, enabled);
 }
 
+bool BrowserSettings::traceRequests()
+{
+    return config()->get(Config::Browser_TraceRequests).toBool();
+}
+
+void BrowserSettings::setTraceRequests(bool enabled)
+{
+    config()->set(Config::Browser_TraceRequests, enabled);
+}
+
 bool BrowserSettings::useCustomProxy()
 {
     return config()->get(Config::Browser_UseCustomProxy).toBool();
@@ -53,6 +53,8 @@ public:
     void setNoMigrationPrompt(bool prompt);
     bool allowLocalhostWithPasskeys();
     void setAllowLocalhostWithPasskeys(bool enabled);
+    bool traceRequests();
+    void setTraceRequests(bool enabled);
 
     bool useCustomProxy();
     void setUseCustomProxy(bool enabled);
@@ -97,6 +97,7 @@ BrowserSettingsWidget::BrowserSettingsWidget(QWidget* parent)
 #ifndef QT_DEBUG
     m_ui->customExtensionId->setVisible(false);
     m_ui->customExtensionLabel->setVisible(false);
+    m_ui->traceRequests->setVisible(false);
 #endif
 }
 
@@ -124,6 +125,7 @@ void BrowserSettingsWidget::loadSettings()
     m_ui->searchInAllDatabases->setChecked(settings->searchInAllDatabases());
     m_ui->supportKphFields->setChecked(settings->supportKphFields());
     m_ui->allowLocalhostWithPasskeys->setChecked(settings->allowLocalhostWithPasskeys());
+    m_ui->traceRequests->setChecked(settings->traceRequests());
     m_ui->noMigrationPrompt->setChecked(settings->noMigrationPrompt());
     m_ui->useCustomProxy->setChecked(settings->useCustomProxy());
     m_ui->customProxyLocation->setText(settings->replaceHomePath(settings->customProxyLocation()));
@@ -255,6 +257,7 @@ void BrowserSettingsWidget::saveSettings()
     settings->setSearchInAllDatabases(m_ui->searchInAllDatabases->isChecked());
     settings->setSupportKphFields(m_ui->supportKphFields->isChecked());
     settings->setAllowLocalhostWithPasskeys(m_ui->allowLocalhostWithPasskeys->isChecked());
+    settings->setTraceRequests(m_ui->traceRequests->isChecked());
     settings->setNoMigrationPrompt(m_ui->noMigrationPrompt->isChecked());
 
 #ifdef QT_DEBUG
@@ -0,0 +1,358 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Agent.h"
+
+#include "Utils.h"
+
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include <QTimer>
+
+#define CLI_DEFAULT_AGENT_TIMEOUT 600
+
+const QCommandLineOption Agent::IdleTimeoutOption =
+    QCommandLineOption(QStringList() << "t"
+                                     << "timeout",
+                       QObject::tr("Stop the agent after the given number of seconds without requests "
+                                   "(default is %1 seconds, set to 0 for unlimited).")
+                           .arg(CLI_DEFAULT_AGENT_TIMEOUT),
+                       QObject::tr("seconds"),
+                       QString::number(CLI_DEFAULT_AGENT_TIMEOUT));
+
+const QCommandLineOption Agent::StopOption =
+    QCommandLineOption(QStringList() << "stop", QObject::tr("Stop the agent running for the database."));
+
+namespace
+{
+    const int SocketTimeout = 5000;
+    const QString RunRequest = QStringLiteral("run");
+    const QString StopRequest = QStringLiteral("stop");
+
+    // The command was run by the agent, or the client has to unlock the database itself
+    enum ReplyStatus : qint32
+    {
+        Done = 0,
+        Declined = 1
+    };
+
+    QString canonicalPath(const QString& path)
+    {
+        QFileInfo info(path);
+        auto canonical = info.canonicalFilePath();
+        return canonical.isEmpty() ? info.absoluteFilePath() : canonical;
+    }
+
+    bool writeMessage(QLocalSocket* socket, const QByteArray& message)
+    {
+        QDataStream stream(socket);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << message;
+        while (socket->bytesToWrite() > 0) {
+            if (!socket->waitForBytesWritten(SocketTimeout)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool readMessage(QLocalSocket* socket, QByteArray& message)
+    {
+        QDataStream stream(socket);
+        stream.setVersion(QDataStream::Qt_5_0);
+        while (true) {
+            stream.startTransaction();
+            stream >> message;
+            if (stream.commitTransaction()) {
+                return true;
+            }
+            if (!socket->waitForReadyRead(SocketTimeout)) {
+                return false;
+            }
+        }
+    }
+
+    bool sendRequest(QLocalSocket* socket, const QString& type, const QStringList& arguments, QByteArray& reply)
+    {
+        QByteArray request;
+        QDataStream stream(&request, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << type << arguments;
+        return writeMessage(socket, request) && readMessage(socket, reply);
+    }
+
+    bool sendReply(QLocalSocket* socket,
+                   ReplyStatus status,
+                   int exitCode = EXIT_FAILURE,
+                   const QByteArray& out = {},
+                   const QByteArray& err = {})
+    {
+        QByteArray reply;
+        QDataStream stream(&reply, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << static_cast<qint32>(status) << static_cast<qint32>(exitCode) << out << err;
+        return writeMessage(socket, reply);
+    }
+} // namespace
+
+Agent::Agent()
+{
+    name = QString("agent");
+    description = QObject::tr("Keep a database unlocked for other commands.");
+    options.append(Agent::IdleTimeoutOption);
+    options.append(Agent::StopOption);
+}
+
+int Agent::execute(const QStringList& arguments)
+{
+    auto& err = Utils::STDERR;
+
+    auto parser = getCommandLineParser(arguments);
+    if (parser.isNull()) {
+        return EXIT_FAILURE;
+    }
+    const auto databasePath = parser->positionalArguments().at(0);
+
+    QLocalSocket socket;
+    socket.connectToServer(socketName(databasePath));
+    const bool running = socket.waitForConnected(SocketTimeout);
+
+    if (parser->isSet(Agent::StopOption)) {
+        QByteArray reply;
+        if (!running || !sendRequest(&socket, StopRequest, {}, reply)) {
+            err << QObject::tr("No agent is running for %1.").arg(databasePath) << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (running) {
+        err << QObject::tr("An agent is already running for %1.").arg(databasePath) << endl;
+        return EXIT_FAILURE;
+    }
+    socket.abort();
+
+    return DatabaseCommand::execute(arguments);
+}
+
+int Agent::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
+{
+    auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDERR;
+    auto& err = Utils::STDERR;
+
+    bool ok;
+    const int timeout = parser->value(Agent::IdleTimeoutOption).toInt(&ok);
+    if (!ok || timeout < 0) {
+        err << QObject::tr("Invalid timeout value %1.").arg(parser->value(Agent::IdleTimeoutOption)) << endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto name = socketName(database->filePath());
+    QLocalServer server;
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    // Left behind by an agent that did not stop cleanly, a running one was ruled out before unlocking
+    QLocalServer::removeServer(name);
+    if (!server.listen(name)) {
+        err << QObject::tr("Cannot start the agent: %1").arg(server.errorString()) << endl;
+        return EXIT_FAILURE;
+    }
+
+    QFileInfo fileInfo(database->filePath());
+    m_fileModified = fileInfo.lastModified();
+    m_fileSize = fileInfo.size();
+
+    QEventLoop loop;
+    QTimer idleTimer;
+    idleTimer.setSingleShot(true);
+    idleTimer.setInterval(timeout * 1000);
+    QObject::connect(&idleTimer, &QTimer::timeout, &loop, &QEventLoop::quit);
+    QObject::connect(&server, &QLocalServer::newConnection, &loop, [&]() {
+        while (auto* socket = server.nextPendingConnection()) {
+            const bool keepRunning = handleConnection(socket, database);
+            socket->disconnectFromServer();
+            socket->deleteLater();
+            if (!keepRunning) {
+                loop.quit();
+                return;
+            }
+        }
+        if (timeout > 0) {
+            idleTimer.start();
+        }
+    });
+    if (timeout > 0) {
+        idleTimer.start();
+    }
+
+    out << QObject::tr("Agent running for %1.").arg(database->filePath()) << endl;
+    loop.exec();
+
+    server.close();
+    database->releaseData();
+    out << QObject::tr("Agent stopped.") << endl;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Run a forwarded command against the unlocked database and reply with its output.
+ *
+ * @return false if the agent should stop
+ */
+bool Agent::handleConnection(QLocalSocket* socket, QSharedPointer<Database> db)
+{
+    QByteArray request;
+    if (!readMessage(socket, request)) {
+        return true;
+    }
+
+    QDataStream stream(request);
+    stream.setVersion(QDataStream::Qt_5_0);
+    QString type;
+    QStringList arguments;
+    stream >> type >> arguments;
+    if (stream.status() != QDataStream::Ok) {
+        sendReply(socket, Declined);
+        return true;
+    }
+
+    if (type == StopRequest) {
+        sendReply(socket, Done, EXIT_SUCCESS);
+        return false;
+    }
+
+    // Another process saved the database, the unlocked copy is outdated
+    QFileInfo fileInfo(db->filePath());
+    if (fileInfo.lastModified() != m_fileModified || fileInfo.size() != m_fileSize) {
+        sendReply(socket, Declined);
+        return false;
+    }
+
+    if (type != RunRequest || arguments.isEmpty() || !isForwardable(arguments.first())) {
+        sendReply(socket, Declined);
+        return true;
+    }
+    auto command = Commands::getCommand(arguments.first()).dynamicCast<DatabaseCommand>();
+    if (!command) {
+        sendReply(socket, Declined);
+        return true;
+    }
+
+    // Capture the output of the command, forwarded commands never read input
+    QByteArray outData;
+    QByteArray errData;
+    QBuffer outBuffer(&outData);
+    QBuffer errBuffer(&errData);
+    QBuffer inBuffer;
+    outBuffer.open(QIODevice::WriteOnly);
+    errBuffer.open(QIODevice::WriteOnly);
+    inBuffer.open(QIODevice::ReadOnly);
+    auto* stdoutDevice = Utils::STDOUT.device();
+    auto* stderrDevice = Utils::STDERR.device();
+    auto* stdinDevice = Utils::STDIN.device();
+    Utils::STDOUT.setDevice(&outBuffer);
+    Utils::STDERR.setDevice(&errBuffer);
+    Utils::STDIN.setDevice(&inBuffer);
+
+    int exitCode = EXIT_FAILURE;
+    auto parser = command->getCommandLineParser(arguments);
+    if (parser) {
+        exitCode = command->executeWithDatabase(db, parser);
+    }
+
+    Utils::STDOUT.flush();
+    Utils::STDERR.flush();
+    Utils::STDOUT.setDevice(stdoutDevice);
+    Utils::STDERR.setDevice(stderrDevice);
+    Utils::STDIN.setDevice(stdinDevice);
+
+    sendReply(socket, Done, exitCode, outData, errData);
+    return true;
+}
+
+/**
+ * Commands that only read the database and never prompt, so an agent can run them.
+ */
+bool Agent::isForwardable(const QString& commandName)
+{
+    static const QStringList forwardable{"db-info", "export", "ls", "search", "show"};
+    return forwardable.contains(commandName);
+}
+
+/**
+ * Run a command through the agent of the database, if one is running.
+ *
+ * @param databasePath path of the database as given on the command line
+ * @param arguments complete arguments of the command, starting with its name
+ * @param exitCode exit code of the command run by the agent
+ * @return true if the agent ran the command and its output was written
+ */
+bool Agent::forward(const QString& databasePath, const QStringList& arguments, int& exitCode)
+{
+    QLocalSocket socket;
+    socket.connectToServer(socketName(databasePath));
+    if (!socket.waitForConnected(SocketTimeout)) {
+        return false;
+    }
+
+    QByteArray reply;
+    if (!sendRequest(&socket, RunRequest, arguments, reply)) {
+        return false;
+    }
+
+    QDataStream stream(reply);
+    stream.setVersion(QDataStream::Qt_5_0);
+    qint32 status;
+    qint32 code;
+    QByteArray outData;
+    QByteArray errData;
+    stream >> status >> code >> outData >> errData;
+    if (stream.status() != QDataStream::Ok || status != Done) {
+        return false;
+    }
+
+    Utils::STDOUT.flush();
+    Utils::STDOUT.device()->write(outData);
+    Utils::STDERR.flush();
+    Utils::STDERR.device()->write(errData);
+    exitCode = code;
+    return true;
+}
+
+/**
+ * Name of the agent socket of a database, the same for every path of the file.
+ */
+QString Agent::socketName(const QString& databasePath)
+{
+    const auto hash = QCryptographicHash::hash(canonicalPath(databasePath).toUtf8(), QCryptographicHash::Sha256);
+    const auto name = QString("keepassxc-cli-agent-%1").arg(QString::fromLatin1(hash.toHex().left(16)));
+#ifdef Q_OS_UNIX
+    // Other users can create sockets in the shared temporary directory, the runtime directory is private
+    const auto runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (!runtimeDir.isEmpty()) {
+        return QDir(runtimeDir).filePath(name);
+    }
+#endif
+    return name;
+}
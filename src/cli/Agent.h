@@ -0,0 +1,54 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_AGENT_H
+#define KEEPASSXC_AGENT_H
+
+#include "DatabaseCommand.h"
+
+#include <QDateTime>
+
+class QLocalSocket;
+
+/**
+ * Keeps a database unlocked in the background and answers read-only
+ * commands of other keepassxc-cli invocations for the same database
+ * through a local socket only accessible by the current user.
+ */
+class Agent : public DatabaseCommand
+{
+public:
+    Agent();
+
+    int execute(const QStringList& arguments) override;
+    int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
+
+    static bool isForwardable(const QString& commandName);
+    static bool forward(const QString& databasePath, const QStringList& arguments, int& exitCode);
+    static QString socketName(const QString& databasePath);
+
+    static const QCommandLineOption IdleTimeoutOption;
+    static const QCommandLineOption StopOption;
+
+private:
+    bool handleConnection(QLocalSocket* socket, QSharedPointer<Database> db);
+
+    QDateTime m_fileModified;
+    qint64 m_fileSize = 0;
+};
+
+#endif // KEEPASSXC_AGENT_H
@@ -18,30 +18,49 @@
 #include "Analyze.h"
 
 #include "Utils.h"
+#include "core/DatabaseStats.h"
 #include "core/Group.h"
 #include "core/HibpOffline.h"
 
 #include <QCommandLineParser>
 #include <QFile>
+#include <QSaveFile>
 
 const QCommandLineOption Analyze::HIBPDatabaseOption = QCommandLineOption(
     {"H", "hibp"},
     QObject::tr("Check if any passwords have been publicly leaked. FILENAME must be the path of a file listing "
                 "SHA-1 hashes of leaked passwords in HIBP format, as available from "
-                "https://haveibeenpwned.com/Passwords."),
+                "https://haveibeenpwned.com/Passwords, or a binary index written with --write-hibp-index."),
     QObject::tr("FILENAME"));
 
+const QCommandLineOption Analyze::WriteHibpIndexOption =
+    QCommandLineOption("write-hibp-index",
+                       QObject::tr("Convert the HIBP file ordered by hash to a binary index at FILENAME, "
+                                   "which is smaller and faster to check, and analyze against it."),
+                       QObject::tr("FILENAME"));
+
+const QCommandLineOption Analyze::IncludeHistoryOption =
+    QCommandLineOption("include-history", QObject::tr("Also check the passwords of history entries."));
+
 const QCommandLineOption Analyze::OkonOption =
     QCommandLineOption("okon",
                        QObject::tr("Path to okon-cli to search a formatted HIBP file"),
                        QObject::tr("okon-cli"));
 
+const QCommandLineOption Analyze::StatsOption =
+    QCommandLineOption("stats",
+                       QObject::tr("Show statistics of the passwords, such as their lengths, ages and reuse. "
+                                   "The HIBP file is optional with this option."));
+
 Analyze::Analyze()
 {
     name = QString("analyze");
     description = QObject::tr("Analyze passwords for weaknesses and problems.");
     options.append(Analyze::HIBPDatabaseOption);
+    options.append(Analyze::WriteHibpIndexOption);
+    options.append(Analyze::IncludeHistoryOption);
     options.append(Analyze::OkonOption);
+    options.append(Analyze::StatsOption);
 }
 
 int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
@@ -51,8 +70,16 @@ int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPoint
 
     QList<QPair<const Entry*, int>> findings;
     QString error;
+    const bool includeHistory = parser->isSet(Analyze::IncludeHistoryOption);
 
     auto hibpDatabase = parser->value(Analyze::HIBPDatabaseOption);
+    if (parser->isSet(Analyze::StatsOption)) {
+        printStats(database);
+        if (hibpDatabase.isEmpty()) {
+            return EXIT_SUCCESS;
+        }
+    }
+
     if (!QFile::exists(hibpDatabase) || hibpDatabase.isEmpty()) {
         err << QObject::tr("Cannot find HIBP file: %1").arg(hibpDatabase);
         return EXIT_FAILURE;
@@ -62,11 +89,35 @@ int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPoint
     if (!okon.isEmpty()) {
         out << QObject::tr("Evaluating database entries using okon…") << endl;
 
-        if (!HibpOffline::okonReport(database, okon, hibpDatabase, findings, &error)) {
+        if (!HibpOffline::okonReport(database, okon, hibpDatabase, findings, &error, includeHistory)) {
             err << error << endl;
             return EXIT_FAILURE;
         }
     } else {
+        auto hibpIndex = parser->value(Analyze::WriteHibpIndexOption);
+        if (!hibpIndex.isEmpty()) {
+            QFile hibpFile(hibpDatabase);
+            QSaveFile indexFile(hibpIndex);
+            if (!hibpFile.open(QFile::ReadOnly)) {
+                err << QObject::tr("Failed to open HIBP file %1: %2").arg(hibpDatabase).arg(hibpFile.errorString())
+                    << endl;
+                return EXIT_FAILURE;
+            }
+            if (!indexFile.open(QIODevice::WriteOnly)) {
+                err << QObject::tr("Failed to open HIBP index file %1: %2").arg(hibpIndex).arg(indexFile.errorString())
+                    << endl;
+                return EXIT_FAILURE;
+            }
+
+            out << QObject::tr("Writing HIBP index file, this will take a while…") << endl;
+
+            if (!HibpOffline::writeIndex(hibpFile, indexFile, &error) || !indexFile.commit()) {
+                err << (error.isEmpty() ? indexFile.errorString() : error) << endl;
+                return EXIT_FAILURE;
+            }
+            hibpDatabase = hibpIndex;
+        }
+
         QFile hibpFile(hibpDatabase);
         if (!hibpFile.open(QFile::ReadOnly)) {
             err << QObject::tr("Failed to open HIBP file %1: %2").arg(hibpDatabase).arg(hibpFile.errorString()) << endl;
@@ -75,14 +126,25 @@ int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPoint
 
         out << QObject::tr("Evaluating database entries against HIBP file, this will take a while…") << endl;
 
-        if (!HibpOffline::report(database, hibpFile, findings, &error)) {
+        if (!HibpOffline::reportFile(database, hibpFile, findings, &error, includeHistory)) {
             err << error << endl;
             return EXIT_FAILURE;
         }
     }
 
+    // History items are reported under the path of their entry
+    QHash<const Entry*, const Entry*> historyOwners;
+    if (includeHistory) {
+        database->rootGroup()->forEachEntryRecursive([&](const Entry* entry) {
+            for (const auto* historyItem : entry->historyItems()) {
+                historyOwners.insert(historyItem, entry);
+            }
+        });
+    }
+
     for (const auto& finding : findings) {
-        const auto entry = finding.first;
+        const auto historyOwner = historyOwners.value(finding.first);
+        const auto entry = historyOwner ? historyOwner : finding.first;
         auto count = finding.second;
 
         QString path = entry->title();
@@ -90,7 +152,14 @@ int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPoint
             path.prepend("/").prepend(g->name());
         }
 
-        if (count > 0) {
+        if (historyOwner && count > 0) {
+            out << QObject::tr("Previous password for '%1' has been leaked %2 time(s)!", "", count)
+                       .arg(path)
+                       .arg(count)
+                << endl;
+        } else if (historyOwner) {
+            out << QObject::tr("Previous password for '%1' has been leaked!").arg(path) << endl;
+        } else if (count > 0) {
             out << QObject::tr("Password for '%1' has been leaked %2 time(s)!", "", count).arg(path).arg(count) << endl;
         } else {
             out << QObject::tr("Password for '%1' has been leaked!").arg(path) << endl;
@@ -99,3 +168,24 @@ int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPoint
 
     return EXIT_SUCCESS;
 }
+
+void Analyze::printStats(QSharedPointer<Database> database)
+{
+    auto& out = Utils::STDOUT;
+
+    DatabaseStats stats(database);
+    out << QObject::tr("Number of entries") << ": " << QString::number(stats.entryCount) << endl;
+    out << QObject::tr("Number of expired entries") << ": " << QString::number(stats.expiredEntries) << endl;
+    out << QObject::tr("Unique passwords") << ": " << QString::number(stats.uniquePasswords) << endl;
+    out << QObject::tr("Non-unique passwords") << ": " << QString::number(stats.reusedPasswords) << endl;
+    out << QObject::tr("Maximum password reuse") << ": " << QString::number(stats.maxPwdReuse()) << endl;
+    out << QObject::tr("Reused passwords") << ": " << DatabaseStats::formatReuseClusters(stats.reuseClusters) << endl;
+    out << QObject::tr("Number of short passwords") << ": " << QString::number(stats.shortPasswords) << endl;
+    out << QObject::tr("Number of weak passwords") << ": " << QString::number(stats.weakPasswords) << endl;
+    out << QObject::tr("Average password length") << ": " << QObject::tr("%1 characters").arg(stats.averagePwdLength())
+        << endl;
+    out << QObject::tr("Password lengths") << ": "
+        << DatabaseStats::formatHistogram(stats.passwordLengthHistogram, DatabaseStats::PasswordLengthBounds) << endl;
+    out << QObject::tr("Days since passwords were modified") << ": "
+        << DatabaseStats::formatHistogram(stats.passwordAgeHistogram, DatabaseStats::PasswordAgeBounds) << endl;
+}
@@ -27,7 +27,13 @@ public:
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
 
     static const QCommandLineOption HIBPDatabaseOption;
+    static const QCommandLineOption WriteHibpIndexOption;
+    static const QCommandLineOption IncludeHistoryOption;
     static const QCommandLineOption OkonOption;
+    static const QCommandLineOption StatsOption;
+
+private:
+    void printStats(QSharedPointer<Database> database);
 };
 
 #endif // KEEPASSXC_HIBP_H
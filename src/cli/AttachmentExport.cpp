@@ -78,7 +78,11 @@ int AttachmentExport::executeWithDatabase(QSharedPointer<Database> database, QSh
         err << QObject::tr("Could not open output file %1.").arg(exportFileName) << endl;
         return EXIT_FAILURE;
     }
-    exportFile.write(attachments->value(attachmentName));
+    QString errorMessage;
+    if (!attachments->exportToDevice(attachmentName, &exportFile, &errorMessage)) {
+        err << QObject::tr("Could not write output file %1: %2").arg(exportFileName, errorMessage) << endl;
+        return EXIT_FAILURE;
+    }
 
     out << QObject::tr("Successfully exported attachment %1 of entry %2 to %3.")
                .arg(attachmentName, entryPath, exportFileName)
@@ -71,11 +71,16 @@ int AttachmentImport::executeWithDatabase(QSharedPointer<Database> database, QSh
     }
 
     entry->beginUpdate();
-    attachments->set(attachmentName, importFile.readAll());
+    QString importError;
+    const bool importOk = attachments->importFromDevice(attachmentName, &importFile, &importError);
     entry->endUpdate();
+    if (!importOk) {
+        err << QObject::tr("Could not read attachment file %1: %2").arg(importFileName, importError) << endl;
+        return EXIT_FAILURE;
+    }
 
     QString errorMessage;
-    if (!database->save(Database::Atomic, {}, &errorMessage)) {
+    if (!saveDatabase(database, &errorMessage)) {
         err << QObject::tr("Writing the database failed %1.").arg(errorMessage) << endl;
         return EXIT_FAILURE;
     }
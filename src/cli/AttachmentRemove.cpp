@@ -58,7 +58,7 @@ int AttachmentRemove::executeWithDatabase(QSharedPointer<Database> database, QSh
     entry->endUpdate();
 
     QString errorMessage;
-    if (!database->save(Database::Atomic, {}, &errorMessage)) {
+    if (!saveDatabase(database, &errorMessage)) {
         err << QObject::tr("Writing the database failed %1.").arg(errorMessage) << endl;
         return EXIT_FAILURE;
     }
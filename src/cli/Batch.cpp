@@ -0,0 +1,105 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Batch.h"
+
+#include "TextStream.h"
+#include "Utils.h"
+
+#include <QCommandLineParser>
+#include <QFile>
+
+Batch::Batch()
+{
+    name = QString("batch");
+    description = QObject::tr("Run a list of commands on a database, saving it once at the end.");
+    optionalArguments.append({QString("commands"),
+                              QObject::tr("File with one command per line, read from standard input if omitted."),
+                              QString("[commands]")});
+}
+
+int Batch::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
+{
+    auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    const QStringList args = parser->positionalArguments();
+    QFile commandsFile;
+    TextStream fileStream;
+    QTextStream* in = &Utils::STDIN;
+    if (args.size() > 1) {
+        commandsFile.setFileName(args.at(1));
+        if (!commandsFile.open(QIODevice::ReadOnly)) {
+            err << QObject::tr("Cannot open commands file %1: %2").arg(args.at(1), commandsFile.errorString())
+                << endl;
+            return EXIT_FAILURE;
+        }
+        fileStream.setDevice(&commandsFile);
+        in = &fileStream;
+    }
+
+    // These commands switch, close or create databases instead of working on this one
+    static const QStringList excludedCommands{"agent", "batch", "close", "db-create", "import", "open"};
+
+    int lineNumber = 0;
+    while (true) {
+        const auto line = in->readLine();
+        if (line.isNull()) {
+            break;
+        }
+        ++lineNumber;
+
+        const auto commandArgs = Utils::splitCommandString(line);
+        if (commandArgs.isEmpty() || commandArgs.first().startsWith('#')) {
+            continue;
+        }
+
+        auto command = Commands::getCommand(commandArgs.first());
+        if (!command || excludedCommands.contains(command->name)) {
+            err << QObject::tr("Invalid command %1 on line %2.").arg(commandArgs.first()).arg(lineNumber) << endl;
+            return EXIT_FAILURE;
+        }
+
+        // Run the command like in interactive mode, then save all changes at once
+        auto databaseCommand = command.dynamicCast<DatabaseCommand>();
+        command->currentDatabase = database;
+        if (databaseCommand) {
+            databaseCommand->deferSave = true;
+        }
+        const int result = command->execute(commandArgs);
+        command->currentDatabase.reset();
+        if (databaseCommand) {
+            databaseCommand->deferSave = false;
+        }
+
+        if (result != EXIT_SUCCESS) {
+            err << QObject::tr("Command on line %1 failed, the database was not changed.").arg(lineNumber) << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (database->isModified()) {
+        QString errorMessage;
+        if (!saveDatabase(database, &errorMessage)) {
+            err << QObject::tr("Writing the database failed: %1").arg(errorMessage) << endl;
+            return EXIT_FAILURE;
+        }
+        out << QObject::tr("Successfully saved the database.") << endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -17,15 +17,18 @@
 
 #include "Add.h"
 #include "AddGroup.h"
+#include "Agent.h"
 #include "Analyze.h"
 #include "AttachmentExport.h"
 #include "AttachmentImport.h"
 #include "AttachmentRemove.h"
+#include "Batch.h"
 #include "Clip.h"
 #include "Close.h"
 #include "DatabaseCreate.h"
 #include "DatabaseEdit.h"
 #include "DatabaseInfo.h"
+#include "DatabaseOptimize.h"
 #include "Diceware.h"
 #include "Edit.h"
 #include "Estimate.h"
@@ -74,6 +77,19 @@ const QCommandLineOption Command::YubiKeyOption =
                        QObject::tr("Yubikey slot and optional serial used to access the database (e.g., 1:7370001)."),
                        QObject::tr("slot[:serial]"));
 
+const QCommandLineOption Command::FormatOption =
+    QCommandLineOption(QStringList() << "format",
+                       QObject::tr("Output format, either text or ndjson for one JSON object per entry. "
+                                   "Defaults to text."),
+                       QObject::tr("format"),
+                       "text");
+
+const QCommandLineOption Command::FieldsOption =
+    QCommandLineOption(QStringList() << "fields",
+                       QObject::tr("Comma separated fields of each entry in ndjson output, "
+                                   "e.g. path,title,username,url."),
+                       QObject::tr("fields"));
+
 namespace
 {
 
@@ -174,6 +190,7 @@ namespace Commands
         s_commands.insert(QStringLiteral("db-create"), QSharedPointer<Command>(new DatabaseCreate()));
         s_commands.insert(QStringLiteral("db-edit"), QSharedPointer<Command>(new DatabaseEdit()));
         s_commands.insert(QStringLiteral("db-info"), QSharedPointer<Command>(new DatabaseInfo()));
+        s_commands.insert(QStringLiteral("db-optimize"), QSharedPointer<Command>(new DatabaseOptimize()));
         s_commands.insert(QStringLiteral("diceware"), QSharedPointer<Command>(new Diceware()));
         s_commands.insert(QStringLiteral("edit"), QSharedPointer<Command>(new Edit()));
         s_commands.insert(QStringLiteral("estimate"), QSharedPointer<Command>(new Estimate()));
@@ -193,6 +210,8 @@ namespace Commands
             s_commands.insert(QStringLiteral("exit"), QSharedPointer<Command>(new Exit("exit")));
             s_commands.insert(QStringLiteral("quit"), QSharedPointer<Command>(new Exit("quit")));
         } else {
+            s_commands.insert(QStringLiteral("agent"), QSharedPointer<Command>(new Agent()));
+            s_commands.insert(QStringLiteral("batch"), QSharedPointer<Command>(new Batch()));
             s_commands.insert(QStringLiteral("export"), QSharedPointer<Command>(new Export()));
             s_commands.insert(QStringLiteral("import"), QSharedPointer<Command>(new Import()));
         }
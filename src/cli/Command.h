@@ -45,6 +45,8 @@ public:
     QList<CommandLineArgument> positionalArguments;
     QList<CommandLineArgument> optionalArguments;
     QList<QCommandLineOption> options;
+    // Lean commands never touch a database and start without the crypto self-tests
+    bool lean = false;
 
     QString getDescriptionLine();
     QSharedPointer<QCommandLineParser> getCommandLineParser(const QStringList& arguments);
@@ -55,6 +57,8 @@ public:
     static const QCommandLineOption KeyFileOption;
     static const QCommandLineOption NoPasswordOption;
     static const QCommandLineOption YubiKeyOption;
+    static const QCommandLineOption FormatOption;
+    static const QCommandLineOption FieldsOption;
 };
 
 namespace Commands
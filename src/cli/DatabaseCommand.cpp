@@ -17,6 +17,7 @@
 
 #include "DatabaseCommand.h"
 
+#include "Agent.h"
 #include "Utils.h"
 #include "config-keepassx.h"
 
@@ -47,6 +48,12 @@ int DatabaseCommand::execute(const QStringList& arguments)
     QStringList args = parser->positionalArguments();
     auto db = currentDatabase;
     if (!db) {
+        // Read-only commands are answered by the agent of the database without unlocking it again
+        int exitCode;
+        if (Agent::isForwardable(name) && Agent::forward(args.at(0), amendedArgs, exitCode)) {
+            return exitCode;
+        }
+
         // It would be nice to update currentDatabase here, but the CLI tests frequently
         // re-use Command objects to exercise non-interactive behavior. Updating the current
         // database confuses these tests. Because of this, we leave it up to the interactive
@@ -68,3 +75,14 @@ int DatabaseCommand::execute(const QStringList& arguments)
 
     return executeWithDatabase(db, parser);
 }
+
+/**
+ * Save the changes of a command to the database file, unless saving was deferred.
+ */
+bool DatabaseCommand::saveDatabase(QSharedPointer<Database> database, QString* error)
+{
+    if (deferSave) {
+        return true;
+    }
+    return database->save(Database::Atomic, {}, error);
+}
@@ -26,6 +26,12 @@ public:
     DatabaseCommand();
     int execute(const QStringList& arguments) override;
     virtual int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) = 0;
+
+    // Leave saving the changes to the caller, e.g. at the end of a batch
+    bool deferSave = false;
+
+protected:
+    bool saveDatabase(QSharedPointer<Database> database, QString* error);
 };
 
 #endif // KEEPASSXC_DATABASECOMMAND_H
@@ -126,9 +126,16 @@ QSharedPointer<Database> DatabaseCreate::initializeDatabaseFromOptions(const QSh
         Q_ASSERT(kdf);
 
         out << QObject::tr("Benchmarking key derivation function for %1ms delay.").arg(decryptionTimeValue) << endl;
-        int rounds = kdf->benchmark(decryptionTime);
-        out << QObject::tr("Setting %1 rounds for key derivation function.").arg(QString::number(rounds)) << endl;
-        kdf->setRounds(rounds);
+        auto benchmark = kdf->benchmarkDetailed(decryptionTime);
+        out << QObject::tr("Setting %1 rounds for key derivation function.").arg(QString::number(benchmark.rounds))
+            << endl;
+        out << QObject::tr("Measured over %n sample(s), deviation %1%.", "", benchmark.samples)
+                   .arg(benchmark.deviation * 100, 0, 'f', 1)
+            << endl;
+        if (!benchmark.implementation.isEmpty()) {
+            out << QObject::tr("Key derivation implementation: %1.").arg(benchmark.implementation) << endl;
+        }
+        kdf->setRounds(benchmark.rounds);
 
         bool ok = db->changeKdf(kdf);
 
@@ -18,6 +18,7 @@
 #include "DatabaseInfo.h"
 
 #include "Utils.h"
+#include "core/DatabaseDiagnostics.h"
 #include "core/DatabaseStats.h"
 #include "core/Global.h"
 #include "core/Group.h"
@@ -25,13 +26,21 @@
 
 #include <QCommandLineParser>
 
+const QCommandLineOption DatabaseInfo::TimingsOption =
+    QCommandLineOption("timings", QObject::tr("Show how long the stages of opening and saving the database took."));
+
+const QCommandLineOption DatabaseInfo::StatsOption =
+    QCommandLineOption("stats", QObject::tr("Show the memory used by the database and its performance counters."));
+
 DatabaseInfo::DatabaseInfo()
 {
     name = QString("db-info");
     description = QObject::tr("Show a database's information.");
+    options.append(DatabaseInfo::TimingsOption);
+    options.append(DatabaseInfo::StatsOption);
 }
 
-int DatabaseInfo::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser>)
+int DatabaseInfo::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
     auto& out = Utils::STDOUT;
 
@@ -69,5 +78,26 @@ int DatabaseInfo::executeWithDatabase(QSharedPointer<Database> database, QShared
     out << QObject::tr("Average password length") << ": " << QObject::tr("%1 characters").arg(stats.averagePwdLength())
         << endl;
 
+    if (parser->isSet(DatabaseInfo::TimingsOption)) {
+        const auto printTimings = [&out](const QString& title, const StageTimings& timings) {
+            if (timings.isEmpty()) {
+                return;
+            }
+            out << title << ": " << QObject::tr("%1 ms").arg(timings.totalNsecs() / 1e6, 0, 'f', 2) << endl;
+            for (const auto& stage : timings.stages()) {
+                out << "  " << stage.first << ": " << QObject::tr("%1 ms").arg(stage.second / 1e6, 0, 'f', 2) << endl;
+            }
+        };
+        printTimings(QObject::tr("Open timings"), database->loadTimings());
+        printTimings(QObject::tr("Save timings"), database->saveTimings());
+    }
+
+    if (parser->isSet(DatabaseInfo::StatsOption)) {
+        const DatabaseDiagnostics diagnostics(database);
+        for (const auto& row : diagnostics.rows()) {
+            out << row.first << ": " << row.second << endl;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
@@ -26,6 +26,9 @@ public:
     DatabaseInfo();
 
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
+
+    static const QCommandLineOption TimingsOption;
+    static const QCommandLineOption StatsOption;
 };
 
 #endif // KEEPASSXC_DATABASEINFO_H
@@ -0,0 +1,105 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseOptimize.h"
+
+#include "Utils.h"
+#include "core/DatabaseOptimizer.h"
+#include "core/Tools.h"
+
+#include <QCommandLineParser>
+#include <QFileInfo>
+
+const QCommandLineOption DatabaseOptimize::DeletedObjectsDaysOption =
+    QCommandLineOption(QStringList() << "deleted-objects-days",
+                       QObject::tr("Keep records of deleted objects for this many days, -1 keeps all. "
+                                   "Defaults to the maintenance period of the database."),
+                       QObject::tr("days"));
+
+const QCommandLineOption DatabaseOptimize::DryRunOption =
+    QCommandLineOption(QStringList() << "dry-run", QObject::tr("Only print the changes, don't save the database."));
+
+DatabaseOptimize::DatabaseOptimize()
+{
+    name = QString("db-optimize");
+    description = QObject::tr("Remove unused data that slows down opening and saving a database.");
+    options.append(DatabaseOptimize::DeletedObjectsDaysOption);
+    options.append(DatabaseOptimize::DryRunOption);
+}
+
+int DatabaseOptimize::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
+{
+    auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    DatabaseOptimizer optimizer(database.data());
+    if (parser->isSet(DatabaseOptimize::DeletedObjectsDaysOption)) {
+        const QString value = parser->value(DatabaseOptimize::DeletedObjectsDaysOption);
+        bool ok;
+        const int days = value.toInt(&ok);
+        if (!ok || days < -1) {
+            err << QObject::tr("Invalid number of days %1.").arg(value) << endl;
+            return EXIT_FAILURE;
+        }
+        optimizer.setDeletedObjectsMaxAge(days);
+    }
+
+    // The key derivation takes the same time before and after
+    const auto openNsecs = [](const StageTimings& timings) { return timings.totalNsecs() - timings.nsecs("kdf"); };
+    const QString filePath = database->filePath();
+    const qint64 sizeBefore = QFileInfo(filePath).size();
+    const qint64 openBefore = openNsecs(database->loadTimings());
+
+    const DatabaseOptimizer::Result result = optimizer.optimize();
+    for (const QString& change : result.changes()) {
+        out << change << endl;
+    }
+
+    if (!result.isModified()) {
+        out << QObject::tr("Database is already optimized.") << endl;
+        return EXIT_SUCCESS;
+    }
+    if (parser->isSet(DatabaseOptimize::DryRunOption)) {
+        return EXIT_SUCCESS;
+    }
+
+    QString errorMessage;
+    if (!saveDatabase(database, &errorMessage)) {
+        err << QObject::tr("Unable to save database to file : %1").arg(errorMessage) << endl;
+        return EXIT_FAILURE;
+    }
+
+    const qint64 sizeAfter = QFileInfo(filePath).size();
+    out << QObject::tr("File size: %1 -> %2 (%3 saved)")
+               .arg(Tools::humanReadableFileSize(sizeBefore),
+                    Tools::humanReadableFileSize(sizeAfter),
+                    Tools::humanReadableFileSize(qMax<qint64>(0, sizeBefore - sizeAfter)))
+        << endl;
+
+    // Open the file again to measure the improvement, the key does not need to be derived again
+    auto reopened = QSharedPointer<Database>::create();
+    reopened->reuseTransformedKey(database.data());
+    if (reopened->open(filePath, database->key(), &errorMessage)) {
+        const qint64 openAfter = openNsecs(reopened->loadTimings());
+        out << QObject::tr("Open time without key derivation: %1 ms -> %2 ms")
+                   .arg(openBefore / 1e6, 0, 'f', 2)
+                   .arg(openAfter / 1e6, 0, 'f', 2)
+            << endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -17,6 +17,7 @@
 
 #include "Diceware.h"
 
+#include "Generate.h"
 #include "Utils.h"
 #include "core/PassphraseGenerator.h"
 
@@ -37,9 +38,11 @@ const QCommandLineOption Diceware::WordListOption =
 Diceware::Diceware()
 {
     name = QString("diceware");
+    lean = true;
     description = QObject::tr("Generate a new random diceware passphrase.");
     options.append(Diceware::WordCountOption);
     options.append(Diceware::WordListOption);
+    options.append(Generate::CountOption);
 }
 
 int Diceware::execute(const QStringList& arguments)
@@ -76,8 +79,16 @@ int Diceware::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
-    QString password = dicewareGenerator.generatePassphrase();
-    out << password << endl;
+    const int count = Generate::parseCount(parser);
+    if (count <= 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (count == 1) {
+        out << dicewareGenerator.generatePassphrase() << endl;
+    } else {
+        out << dicewareGenerator.generatePassphrases(count).join("\n") << endl;
+    }
 
     return EXIT_SUCCESS;
 }
@@ -31,6 +31,7 @@ const QCommandLineOption Estimate::AdvancedOption =
 Estimate::Estimate()
 {
     name = QString("estimate");
+    lean = true;
     optionalArguments.append(
         {QString("password"), QObject::tr("Password for which to estimate the entropy."), QString("[password]")});
     options.append(Estimate::AdvancedOption);
@@ -64,9 +64,16 @@ const QCommandLineOption Generate::ExcludeSimilarCharsOption =
 
 const QCommandLineOption Generate::IncludeEveryGroupOption =
     QCommandLineOption(QStringList() << "every-group", QObject::tr("Include characters from every selected group"));
+
+const QCommandLineOption Generate::CountOption =
+    QCommandLineOption(QStringList() << "count",
+                       QObject::tr("Number of values to generate, one per line"),
+                       QObject::tr("count", "CLI parameter"));
+
 Generate::Generate()
 {
     name = QString("generate");
+    lean = true;
     description = QObject::tr("Generate a new random password.");
     options.append(Generate::PasswordLengthOption);
     options.append(Generate::LowerCaseOption);
@@ -78,6 +85,7 @@ Generate::Generate()
     options.append(Generate::ExcludeSimilarCharsOption);
     options.append(Generate::IncludeEveryGroupOption);
     options.append(Generate::CustomCharacterSetOption);
+    options.append(Generate::CountOption);
 }
 
 /**
@@ -145,6 +153,25 @@ QSharedPointer<PasswordGenerator> Generate::createGenerator(QSharedPointer<QComm
     return passwordGenerator;
 }
 
+/**
+ * Parses the number of values to generate from the command line options
+ * of the parser object.
+ *
+ * @return the count, or 0 if it is invalid
+ */
+int Generate::parseCount(QSharedPointer<QCommandLineParser> parser)
+{
+    QString count = parser->value(Generate::CountOption);
+    if (count.isEmpty()) {
+        return 1;
+    }
+    if (count.toInt() <= 0) {
+        Utils::STDERR << QObject::tr("Invalid count %1").arg(count) << endl;
+        return 0;
+    }
+    return count.toInt();
+}
+
 int Generate::execute(const QStringList& arguments)
 {
     QSharedPointer<QCommandLineParser> parser = getCommandLineParser(arguments);
@@ -157,9 +184,17 @@ int Generate::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
+    const int count = Generate::parseCount(parser);
+    if (count <= 0) {
+        return EXIT_FAILURE;
+    }
+
     auto& out = Utils::STDOUT;
-    QString password = passwordGenerator->generatePassword();
-    out << password << endl;
+    if (count == 1) {
+        out << passwordGenerator->generatePassword() << endl;
+    } else {
+        out << passwordGenerator->generatePasswords(count).join("\n") << endl;
+    }
 
     return EXIT_SUCCESS;
 }
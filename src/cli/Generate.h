@@ -29,6 +29,7 @@ public:
     int execute(const QStringList& arguments) override;
 
     static QSharedPointer<PasswordGenerator> createGenerator(QSharedPointer<QCommandLineParser> parser);
+    static int parseCount(QSharedPointer<QCommandLineParser> parser);
 
     static const QCommandLineOption PasswordLengthOption;
     static const QCommandLineOption LowerCaseOption;
@@ -40,6 +41,7 @@ public:
     static const QCommandLineOption ExcludeSimilarCharsOption;
     static const QCommandLineOption IncludeEveryGroupOption;
     static const QCommandLineOption CustomCharacterSetOption;
+    static const QCommandLineOption CountOption;
 };
 
 #endif // KEEPASSXC_GENERATE_H
@@ -37,6 +37,8 @@ List::List()
     description = QObject::tr("List database entries.");
     options.append(List::RecursiveOption);
     options.append(List::FlattenOption);
+    options.append(Command::FormatOption);
+    options.append(Command::FieldsOption);
     optionalArguments.append(
         {QString("group"), QObject::tr("Path of the group to list. Default is /"), QString("[group]")});
 }
@@ -49,18 +51,36 @@ int List::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<
     const QStringList args = parser->positionalArguments();
     bool recursive = parser->isSet(List::RecursiveOption);
     bool flatten = parser->isSet(List::FlattenOption);
+    bool json = false;
+    if (!Utils::parseJsonFormat(parser->value(Command::FormatOption), json)) {
+        err << QObject::tr("Invalid output format %1.").arg(parser->value(Command::FormatOption)) << endl;
+        return EXIT_FAILURE;
+    }
 
     // No group provided, defaulting to root group.
-    if (args.size() == 1) {
-        out << database->rootGroup()->print(recursive, flatten) << flush;
-        return EXIT_SUCCESS;
+    Group* group = database->rootGroup();
+    if (args.size() > 1) {
+        const QString& groupPath = args.at(1);
+        group = database->rootGroup()->findGroupByPath(groupPath);
+        if (!group) {
+            err << QObject::tr("Cannot find group %1.").arg(groupPath) << endl;
+            return EXIT_FAILURE;
+        }
     }
 
-    const QString& groupPath = args.at(1);
-    Group* group = database->rootGroup()->findGroupByPath(groupPath);
-    if (!group) {
-        err << QObject::tr("Cannot find group %1.").arg(groupPath) << endl;
-        return EXIT_FAILURE;
+    if (json) {
+        // Written as the entries are visited, without building the whole listing first
+        const auto fields = Utils::parseFieldNames(parser->value(Command::FieldsOption));
+        auto writeEntry = [&](const Entry* entry) { Utils::writeJsonLine(out, Utils::entryToJson(entry, fields)); };
+        if (recursive) {
+            group->forEachEntryRecursive(writeEntry);
+        } else {
+            for (const Entry* entry : group->entries()) {
+                writeEntry(entry);
+            }
+        }
+        out << flush;
+        return EXIT_SUCCESS;
     }
 
     out << group->print(recursive, flatten) << flush;
@@ -40,6 +40,10 @@ const QCommandLineOption Merge::DryRunOption =
     QCommandLineOption(QStringList() << "dry-run",
                        QObject::tr("Only print the changes detected by the merge operation."));
 
+const QCommandLineOption Merge::IncrementalOption =
+    QCommandLineOption(QStringList() << "incremental",
+                       QObject::tr("Only merge entries changed since the last incremental merge from database2."));
+
 const QCommandLineOption Merge::YubiKeyFromOption(QStringList() << "yubikey-from",
                                                   QObject::tr("Yubikey slot for the second database."),
                                                   QObject::tr("slot"));
@@ -51,6 +55,7 @@ Merge::Merge()
     options.append(Merge::KeyFileFromOption);
     options.append(Merge::NoPasswordFromOption);
     options.append(Merge::DryRunOption);
+    options.append(Merge::IncrementalOption);
 #ifdef WITH_XC_YUBIKEY
     options.append(Merge::YubiKeyFromOption);
 #endif
@@ -87,6 +92,8 @@ int Merge::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer
     }
 
     Merger merger(db2.data(), database.data());
+    merger.setIncremental(parser->isSet(Merge::IncrementalOption));
+    merger.setParallel(true);
     QStringList changeList = merger.merge();
 
     for (auto& mergeChange : changeList) {
@@ -95,7 +102,7 @@ int Merge::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer
 
     if (!changeList.isEmpty() && !parser->isSet(Merge::DryRunOption)) {
         QString errorMessage;
-        if (!database->save(Database::Atomic, {}, &errorMessage)) {
+        if (!saveDatabase(database, &errorMessage)) {
             err << QObject::tr("Unable to save database to file : %1").arg(errorMessage) << endl;
             return EXIT_FAILURE;
         }
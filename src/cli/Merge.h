@@ -32,6 +32,7 @@ public:
     static const QCommandLineOption NoPasswordFromOption;
     static const QCommandLineOption YubiKeyFromOption;
     static const QCommandLineOption DryRunOption;
+    static const QCommandLineOption IncrementalOption;
 };
 
 #endif // KEEPASSXC_MERGE_H
@@ -23,10 +23,19 @@
 #include "core/EntrySearcher.h"
 #include "core/Group.h"
 
+const QCommandLineOption Search::LimitOption =
+    QCommandLineOption(QStringList() << "l"
+                                     << "limit",
+                       QObject::tr("Only show the given number of best matching entries, best match first."),
+                       "count");
+
 Search::Search()
 {
     name = QString("search");
     description = QObject::tr("Find entries quickly.");
+    options.append(Search::LimitOption);
+    options.append(Command::FormatOption);
+    options.append(Command::FieldsOption);
     positionalArguments.append({QString("term"), QObject::tr("Search term."), QString("")});
 }
 
@@ -36,14 +45,41 @@ int Search::executeWithDatabase(QSharedPointer<Database> database, QSharedPointe
     auto& err = Utils::STDERR;
 
     const QStringList args = parser->positionalArguments();
+    bool json = false;
+    if (!Utils::parseJsonFormat(parser->value(Command::FormatOption), json)) {
+        err << QObject::tr("Invalid output format %1.").arg(parser->value(Command::FormatOption)) << endl;
+        return EXIT_FAILURE;
+    }
 
     EntrySearcher searcher;
-    auto results = searcher.search(args.at(1), database->rootGroup(), true);
+    QList<Entry*> results;
+    if (parser->isSet(Search::LimitOption)) {
+        bool ok;
+        const int limit = parser->value(Search::LimitOption).toInt(&ok);
+        if (!ok || limit <= 0) {
+            err << QObject::tr("Invalid limit value %1.").arg(parser->value(Search::LimitOption)) << endl;
+            return EXIT_FAILURE;
+        }
+        for (const auto& result : searcher.searchRanked(args.at(1), database->rootGroup(), limit, true)) {
+            results.append(result.entry);
+        }
+    } else {
+        results = searcher.search(args.at(1), database->rootGroup(), true);
+    }
     if (results.isEmpty()) {
         err << "No results for that search term." << endl;
         return EXIT_FAILURE;
     }
 
+    if (json) {
+        const auto fields = Utils::parseFieldNames(parser->value(Command::FieldsOption));
+        for (const Entry* result : asConst(results)) {
+            Utils::writeJsonLine(out, Utils::entryToJson(result, fields));
+        }
+        out << flush;
+        return EXIT_SUCCESS;
+    }
+
     for (const Entry* result : asConst(results)) {
         out << result->path().prepend('/') << endl;
     }
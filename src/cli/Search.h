@@ -26,6 +26,8 @@ public:
     Search();
 
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
+
+    static const QCommandLineOption LimitOption;
 };
 
 #endif // KEEPASSXC_SEARCH_H
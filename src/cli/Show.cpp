@@ -56,6 +56,8 @@ Show::Show()
     options.append(Show::ProtectedAttributesOption);
     options.append(Show::AllAttributesOption);
     options.append(Show::AttachmentsOption);
+    options.append(Command::FormatOption);
+    options.append(Command::FieldsOption);
     positionalArguments.append({QString("entry"), QObject::tr("Name of the entry to show."), QString("")});
 }
 
@@ -82,6 +84,41 @@ int Show::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<
         return EXIT_FAILURE;
     }
 
+    bool json = false;
+    if (!Utils::parseJsonFormat(parser->value(Command::FormatOption), json)) {
+        err << QObject::tr("Invalid output format %1.").arg(parser->value(Command::FormatOption)) << endl;
+        return EXIT_FAILURE;
+    }
+    if (json) {
+        // Attributes given with -a are shown like the fields of --fields
+        auto fields = Utils::parseFieldNames(parser->value(Command::FieldsOption)) + attributes;
+        if (showAllAttributes) {
+            fields << "path"
+                   << "uuid"
+                   << "tags";
+            // Protected attributes are left out like in the summary
+            for (const QString& attributeName : entry->attributes()->keys()) {
+                if (showProtectedAttributes || !entry->attributes()->isProtected(attributeName)) {
+                    fields << attributeName;
+                }
+            }
+        }
+        if (showTotp) {
+            fields << "totp";
+        }
+        auto object = Utils::entryToJson(entry, fields, showProtectedAttributes);
+        if (parser->isSet(Show::AttachmentsOption)) {
+            QJsonObject attachments;
+            for (const QString& attachmentName : entry->attachments()->keys()) {
+                attachments.insert(attachmentName, entry->attachments()->value(attachmentName).size());
+            }
+            object.insert("attachments", attachments);
+        }
+        Utils::writeJsonLine(out, object);
+        out << flush;
+        return EXIT_SUCCESS;
+    }
+
     bool attributesWereSpecified = true;
     if (showAllAttributes) {
         attributesWereSpecified = false;
@@ -33,6 +33,8 @@
 #endif
 
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QProcess>
 
 namespace Utils
@@ -389,6 +391,75 @@ namespace Utils
         return "";
     }
 
+    bool parseJsonFormat(const QString& format, bool& json)
+    {
+        if (format.compare("text", Qt::CaseInsensitive) == 0) {
+            json = false;
+            return true;
+        }
+        if (format.compare("ndjson", Qt::CaseInsensitive) == 0) {
+            json = true;
+            return true;
+        }
+        return false;
+    }
+
+    QStringList parseFieldNames(const QString& fields)
+    {
+        QStringList names;
+        for (const auto& field : fields.split(',')) {
+            const auto name = field.trimmed();
+            if (!name.isEmpty()) {
+                names << name;
+            }
+        }
+        return names;
+    }
+
+    QJsonObject entryToJson(const Entry* entry, const QStringList& fields, bool showProtected)
+    {
+        static const QStringList SummaryFields{"path", "uuid", "title", "username", "url", "notes", "tags"};
+
+        auto names = fields;
+        if (names.isEmpty()) {
+            names = SummaryFields;
+            if (showProtected) {
+                names << "password";
+            }
+        }
+
+        QJsonObject object;
+        for (const auto& name : asConst(names)) {
+            const auto field = name.toLower();
+            if (field == "path") {
+                object.insert(name, entry->path().prepend('/'));
+            } else if (field == "uuid") {
+                object.insert(name, entry->uuidToHex());
+            } else if (field == "tags") {
+                object.insert(name, QJsonArray::fromStringList(entry->tagList()));
+            } else if (field == "totp") {
+                object.insert(name, entry->hasTotp() ? QJsonValue(entry->totp()) : QJsonValue());
+            } else {
+                const auto attributes = findAttributes(*entry->attributes(), name);
+                if (attributes.size() != 1) {
+                    object.insert(name, QJsonValue());
+                    continue;
+                }
+                // Protected attributes of the summary need --show-protected, requested fields are always shown
+                if (fields.isEmpty() && !showProtected && entry->attributes()->isProtected(attributes.first())) {
+                    continue;
+                }
+                object.insert(name, entry->resolveMultiplePlaceholders(entry->attributes()->value(attributes.first())));
+            }
+        }
+        return object;
+    }
+
+    void writeJsonLine(QTextStream& out, const QJsonObject& object)
+    {
+        out << QJsonDocument(object).toJson(QJsonDocument::Compact) << '\n';
+    }
+
     QStringList findAttributes(const EntryAttributes& attributes, const QString& name)
     {
         QStringList result;
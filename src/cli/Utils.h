@@ -18,6 +18,7 @@
 #ifndef KEEPASSXC_UTILS_H
 #define KEEPASSXC_UTILS_H
 
+#include <QJsonObject>
 #include <QTextStream>
 
 class CompositeKey;
@@ -64,6 +65,21 @@ namespace Utils
      * Get the value of a top-level Entry field using its name.
      */
     QString getTopLevelField(const Entry* entry, const QString& fieldName);
+
+    /**
+     * Parse the value of the --format option, "text" or "ndjson".
+     */
+    bool parseJsonFormat(const QString& format, bool& json);
+    /**
+     * Split the value of the --fields option into field names.
+     */
+    QStringList parseFieldNames(const QString& fields);
+    /**
+     * Build the JSON object of an entry with the given fields, or the summary
+     * fields if none are given. Unknown fields are null, like ambiguous attributes.
+     */
+    QJsonObject entryToJson(const Entry* entry, const QStringList& fields, bool showProtected = false);
+    void writeJsonLine(QTextStream& out, const QJsonObject& object);
 }; // namespace Utils
 
 #endif // KEEPASSXC_UTILS_H
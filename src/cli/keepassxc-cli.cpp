@@ -174,11 +174,6 @@ int enterInteractiveMode(const QStringList& arguments)
 
 int main(int argc, char** argv)
 {
-    if (!Crypto::init()) {
-        qWarning("Fatal error while testing the cryptographic functions:\n%s", qPrintable(Crypto::errorString()));
-        return EXIT_FAILURE;
-    }
-
     QCoreApplication app(argc, argv);
     QCoreApplication::setApplicationVersion(KEEPASSXC_VERSION);
 
@@ -213,6 +208,14 @@ int main(int argc, char** argv)
     // recognized by this parser.
     parser.parse(arguments);
 
+    // Lean commands like generate skip the crypto self-tests to start quickly
+    const auto firstCommand =
+        parser.positionalArguments().isEmpty() ? nullptr : Commands::getCommand(parser.positionalArguments().first());
+    if (!Crypto::init(!firstCommand || !firstCommand->lean)) {
+        qWarning("Fatal error while testing the cryptographic functions:\n%s", qPrintable(Crypto::errorString()));
+        return EXIT_FAILURE;
+    }
+
     if (parser.positionalArguments().empty()) {
         if (parser.isSet("version")) {
             // Switch to parser.showVersion() when available (QT 5.4).
@@ -15,6 +15,8 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "config-keepassx.h"
+
 #include <QtGlobal>
 #include <botan/mem_ops.h>
 #include <cstdlib>
@@ -28,6 +30,16 @@
 #include <cstdlib>
 #endif
 
+/*
+ * Key material (PasswordKey, FileKey, ChallengeResponseKey and the cached
+ * transformed key) lives in Botan::secure_vector, which is backed by Botan's
+ * locked pool and scrubbed on release regardless of this setting. The global
+ * operator delete replacement below is a second line of defence for
+ * everything else allocated with new and can be switched off with
+ * WITH_XC_SECURE_DELETE=OFF when allocation throughput matters more.
+ */
+#ifdef WITH_XC_SECURE_DELETE
+
 #if defined(NDEBUG) && !defined(__cpp_sized_deallocation)
 #warning "KeePassXC is being compiled without sized deallocation support. Deletes may be slow."
 #endif
@@ -78,6 +90,8 @@ void operator delete[](void* ptr) noexcept
     ::operator delete(ptr);
 }
 
+#endif // WITH_XC_SECURE_DELETE
+
 // clang-format versions less than 10.0 refuse to put a space before "noexcept"
 // clang-format off
 /**
@@ -18,15 +18,128 @@
 #ifndef KEEPASSXC_ASYNCTASK_HPP
 #define KEEPASSXC_ASYNCTASK_HPP
 
+#include <QCoreApplication>
+#include <QFutureInterface>
 #include <QFutureWatcher>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThread>
+#include <QThreadPool>
 #include <QtConcurrent>
 
+#include <type_traits>
+
 /**
  * Asynchronously run computations outside the GUI thread.
+ *
+ * All tasks share the global thread pool with QtConcurrent. Tasks that are
+ * waiting for a thread are started in order of their priority, so an unlock
+ * does not queue up behind checksums and other maintenance work.
  */
 namespace AsyncTask
 {
 
+    enum class Priority
+    {
+        // Maintenance nobody is waiting for, e.g. file checksums and indexing
+        Background = 0,
+        // Results that are shown once they are ready, e.g. reports
+        Visible = 1,
+        // The user is blocked until the task is done, e.g. unlocking a database
+        Interactive = 2
+    };
+
+    /**
+     * Shared flag to cancel tasks that have not started yet and to drop the
+     * callbacks of running ones. Long running tasks can also check it
+     * themselves to stop early. Copies refer to the same flag.
+     */
+    class CancelToken
+    {
+    public:
+        CancelToken()
+            : m_canceled(new QAtomicInt(0))
+        {
+        }
+
+        void cancel() const
+        {
+            m_canceled->storeRelease(1);
+        }
+
+        bool isCanceled() const
+        {
+            return m_canceled->loadAcquire() != 0;
+        }
+
+    private:
+        QSharedPointer<QAtomicInt> m_canceled;
+    };
+
+    namespace detail
+    {
+        template <typename T, typename FunctionObject>
+        class PriorityTask : public QFutureInterface<T>, public QRunnable
+        {
+        public:
+            PriorityTask(FunctionObject task, CancelToken token)
+                : m_task(std::move(task))
+                , m_token(std::move(token))
+            {
+            }
+
+            QFuture<T> start(Priority priority)
+            {
+                this->setRunnable(this);
+                this->reportStarted();
+                QFuture<T> future = this->future();
+                QThreadPool::globalInstance()->start(this, static_cast<int>(priority));
+                return future;
+            }
+
+            void run() override
+            {
+                if (this->isCanceled() || m_token.isCanceled()) {
+                    this->reportCanceled();
+                } else {
+                    runTask(std::is_void<T>());
+                }
+                this->reportFinished();
+            }
+
+        private:
+            void runTask(std::true_type)
+            {
+                m_task();
+            }
+
+            void runTask(std::false_type)
+            {
+                this->reportResult(m_task());
+            }
+
+            FunctionObject m_task;
+            CancelToken m_token;
+        };
+    } // namespace detail
+
+    /**
+     * Run a given task on the shared thread pool.
+     *
+     * @param task std::function object to run
+     * @param priority order in which waiting tasks are started
+     * @param token skips the task if it is canceled before it started
+     * @return future for the task result, canceled if the task was skipped
+     */
+    template <typename FunctionObject>
+    QFuture<std::decay_t<decltype(std::declval<FunctionObject>()())>>
+    run(FunctionObject task, Priority priority = Priority::Visible, CancelToken token = {})
+    {
+        using Result = std::decay_t<decltype(task())>;
+        auto runnable = new detail::PriorityTask<Result, FunctionObject>(std::move(task), std::move(token));
+        return runnable->start(priority);
+    }
+
     /**
      * Wait for the given future without blocking the event loop.
      *
@@ -43,15 +156,40 @@ namespace AsyncTask
         return future.result();
     }
 
+    /**
+     * Wait for all results of the given future, e.g. from QtConcurrent::mapped(),
+     * without blocking the event loop.
+     *
+     * @param future future to wait for
+     * @return async task results in order
+     */
+    template <typename T> QList<T> waitForResults(QFuture<T> future)
+    {
+        QEventLoop loop;
+        QFutureWatcher<T> watcher;
+        QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+        watcher.setFuture(future);
+        loop.exec();
+        return future.results();
+    }
+
     /**
      * Run a given task and wait for it to finish without blocking the event loop.
+     * Off the GUI thread there is no event loop to keep alive, the task is run directly.
      *
      * @param task std::function object to run
+     * @param priority order in which waiting tasks are started
      * @return async task result
      */
-    template <typename FunctionObject> decltype(auto) runAndWaitForFuture(FunctionObject task)
+    template <typename FunctionObject>
+    decltype(auto) runAndWaitForFuture(FunctionObject task, Priority priority = Priority::Interactive)
     {
-        return waitForFuture(QtConcurrent::run(task));
+        auto* app = QCoreApplication::instance();
+        if (app && QThread::currentThread() != app->thread()) {
+            // Waiting on the thread pool from one of its threads could exhaust it
+            return task();
+        }
+        return waitForFuture(run(std::move(task), priority));
     }
 
     /**
@@ -62,14 +200,24 @@ namespace AsyncTask
      * @param task std::function object to run
      * @param context QObject responsible for calling this function
      * @param callback std::function object to run after the task completes
+     * @param priority order in which waiting tasks are started
+     * @param token once canceled, the task is skipped if it has not started and
+     *              the callback is not processed
      */
     template <typename FunctionObject, typename FunctionObject2>
-    void runThenCallback(FunctionObject task, QObject* context, FunctionObject2 callback)
+    void runThenCallback(FunctionObject task,
+                         QObject* context,
+                         FunctionObject2 callback,
+                         Priority priority = Priority::Visible,
+                         CancelToken token = {})
     {
-        auto future = QtConcurrent::run(task);
+        auto future = run(std::move(task), priority, token);
         auto watcher = new QFutureWatcher<decltype(future.result())>(context);
         QObject::connect(watcher, &QFutureWatcherBase::finished, context, [=]() {
             watcher->deleteLater();
+            if (future.isCanceled() || token.isCanceled()) {
+                return;
+            }
             callback(future.result());
         });
         watcher->setFuture(future);
@@ -0,0 +1,241 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AttachmentTextIndex.h"
+
+#include "core/AsyncTask.h"
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/MemoryUsage.h"
+#include "crypto/Random.h"
+
+#include <QTextCodec>
+
+#include <limits>
+
+AttachmentTextIndex::AttachmentTextIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+    , m_seed(Random::instance()->randomUInt(std::numeric_limits<quint32>::max()))
+{
+}
+
+/**
+ * Start or stop indexing. Enabling indexes the attachments of all entries
+ * in the background, disabling drops the index.
+ */
+void AttachmentTextIndex::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+    m_enabled = enabled;
+
+    clear();
+    if (m_enabled && m_db->rootGroup()) {
+        for (const auto entry : m_db->rootGroup()->entriesRecursive()) {
+            updateEntry(entry);
+        }
+    }
+}
+
+bool AttachmentTextIndex::isEnabled() const
+{
+    return m_enabled;
+}
+
+/**
+ * @return true while attachments are being decoded in the background
+ */
+bool AttachmentTextIndex::isIndexing() const
+{
+    return m_indexing || !m_pending.isEmpty();
+}
+
+void AttachmentTextIndex::clear()
+{
+    m_entryHashes.clear();
+    m_references.clear();
+    m_trigrams.clear();
+    m_pending.clear();
+}
+
+void AttachmentTextIndex::updateEntry(const Entry* entry)
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    const auto attachments = entry->attachments();
+    QSet<QByteArray> hashes;
+    for (const auto& key : attachments->keys()) {
+        const auto hash = attachments->hash(key);
+        if (!hashes.contains(hash)) {
+            hashes.insert(hash);
+            if (!m_entryHashes.value(entry).contains(hash)) {
+                addHash(hash, attachments->value(key));
+            }
+        }
+    }
+    for (const auto& hash : m_entryHashes.value(entry)) {
+        if (!hashes.contains(hash)) {
+            removeHash(hash);
+        }
+    }
+
+    if (hashes.isEmpty()) {
+        m_entryHashes.remove(entry);
+    } else {
+        m_entryHashes.insert(entry, hashes);
+    }
+    startIndexing();
+}
+
+void AttachmentTextIndex::removeEntry(const Entry* entry)
+{
+    for (const auto& hash : m_entryHashes.take(entry)) {
+        removeHash(hash);
+    }
+}
+
+/**
+ * @param hash SHA-256 of the attachment, see EntryAttachments::hash()
+ * @return true once the attachment is decoded and indexed
+ */
+bool AttachmentTextIndex::isIndexed(const QByteArray& hash) const
+{
+    return m_trigrams.contains(hash);
+}
+
+/**
+ * Check whether the text of an attachment may contain every given literal
+ * fragment. Fragments shorter than three characters do not restrict the result.
+ *
+ * @param hash SHA-256 of the attachment, see EntryAttachments::hash()
+ * @param fragments literal text that must occur in a matching attachment
+ * @return false only if the attachment is indexed and lacks a fragment
+ */
+bool AttachmentTextIndex::mayContain(const QByteArray& hash, const QStringList& fragments) const
+{
+    auto it = m_trigrams.constFind(hash);
+    if (it == m_trigrams.cend()) {
+        return true;
+    }
+
+    QSet<uint> trigrams;
+    for (const auto& fragment : fragments) {
+        addTrigrams(fragment, m_seed, trigrams);
+    }
+    return it.value().contains(trigrams);
+}
+
+qint64 AttachmentTextIndex::memoryUsage() const
+{
+    qint64 size = MemoryUsage::heapSize(m_entryHashes) + MemoryUsage::heapSize(m_references)
+                  + MemoryUsage::heapSize(m_trigrams);
+    // The pending data is shared with the attachments
+    size += m_pending.capacity() * qint64(sizeof(void*))
+            + m_pending.size() * (MemoryUsage::NodeOverhead + qint64(2 * sizeof(QByteArray)));
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        size += MemoryUsage::heapSize(it.key());
+    }
+    return size;
+}
+
+/**
+ * Decode an attachment as UTF-8 text. Safe to call from any thread.
+ *
+ * @return the text, or an empty string for binary or oversized attachments
+ */
+QString AttachmentTextIndex::extractText(const QByteArray& data)
+{
+    if (data.isEmpty() || data.size() > MaxTextSize || data.contains('\0')) {
+        return {};
+    }
+
+    QTextCodec::ConverterState state;
+    const QString text = QTextCodec::codecForName("UTF-8")->toUnicode(data.constData(), data.size(), &state);
+    if (state.invalidChars > 0) {
+        return {};
+    }
+    return text;
+}
+
+void AttachmentTextIndex::addHash(const QByteArray& hash, const QByteArray& data)
+{
+    if (++m_references[hash] == 1) {
+        m_pending.insert(hash, data);
+    }
+}
+
+void AttachmentTextIndex::removeHash(const QByteArray& hash)
+{
+    auto it = m_references.find(hash);
+    if (it == m_references.end() || --it.value() > 0) {
+        return;
+    }
+    m_references.erase(it);
+    m_trigrams.remove(hash);
+    m_pending.remove(hash);
+}
+
+void AttachmentTextIndex::startIndexing()
+{
+    if (m_indexing || m_pending.isEmpty()) {
+        return;
+    }
+    m_indexing = true;
+
+    QHash<QByteArray, QByteArray> batch;
+    batch.swap(m_pending);
+    AsyncTask::runThenCallback(
+        [batch, seed = m_seed] {
+            // The decoded text is dropped right away, only its trigrams are kept
+            QHash<QByteArray, QSet<uint>> trigrams;
+            for (auto it = batch.cbegin(); it != batch.cend(); ++it) {
+                addTrigrams(extractText(it.value()), seed, trigrams[it.key()]);
+            }
+            return trigrams;
+        },
+        this,
+        [this](const QHash<QByteArray, QSet<uint>>& trigrams) {
+            m_indexing = false;
+            // Skip attachments that were removed or disabled in the meantime
+            for (auto it = trigrams.cbegin(); it != trigrams.cend(); ++it) {
+                if (m_references.contains(it.key())) {
+                    m_trigrams.insert(it.key(), it.value());
+                }
+            }
+            emit indexUpdated();
+            startIndexing();
+        },
+        AsyncTask::Priority::Background);
+}
+
+void AttachmentTextIndex::addTrigrams(const QString& text, uint seed, QSet<uint>& trigrams)
+{
+    if (text.size() < 3) {
+        return;
+    }
+
+    const QString folded = text.toCaseFolded();
+    for (int i = 0; i + 2 < folded.size(); ++i) {
+        const quint64 trigram = quint64(folded.at(i).unicode()) << 32 | quint64(folded.at(i + 1).unicode()) << 16
+                                | folded.at(i + 2).unicode();
+        trigrams.insert(qHash(trigram, seed));
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ATTACHMENTTEXTINDEX_H
+#define KEEPASSXC_ATTACHMENTTEXTINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+class Database;
+class Entry;
+
+/**
+ * Trigrams of the text contents of the attachments of all entries, keyed by
+ * the SHA-256 of the attachment so that identical files are only decoded once.
+ *
+ * The index keeps no decoded text, only seeded hashes of the case folded
+ * trigrams. It rules out attachments that can't contain a search term, the
+ * remaining ones are decoded with extractText() on demand.
+ *
+ * Indexing is opt-in. While enabled, new attachments are decoded on the
+ * global thread pool and added once done.
+ */
+class AttachmentTextIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AttachmentTextIndex(Database* db);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    bool isIndexing() const;
+    void clear();
+    void updateEntry(const Entry* entry);
+    void removeEntry(const Entry* entry);
+    bool isIndexed(const QByteArray& hash) const;
+    bool mayContain(const QByteArray& hash, const QStringList& fragments) const;
+    qint64 memoryUsage() const;
+
+    static QString extractText(const QByteArray& data);
+
+    // Larger attachments are not searched
+    static constexpr int MaxTextSize = 1024 * 1024;
+
+signals:
+    void indexUpdated();
+
+private:
+    void addHash(const QByteArray& hash, const QByteArray& data);
+    void removeHash(const QByteArray& hash);
+    void startIndexing();
+    static void addTrigrams(const QString& text, uint seed, QSet<uint>& trigrams);
+
+    Database* const m_db;
+    const uint m_seed;
+    bool m_enabled = false;
+    bool m_indexing = false;
+    QHash<const Entry*, QSet<QByteArray>> m_entryHashes;
+    // Number of attachments with the same contents
+    QHash<QByteArray, int> m_references;
+    QHash<QByteArray, QSet<uint>> m_trigrams;
+    // Attachments waiting to be decoded
+    QHash<QByteArray, QByteArray> m_pending;
+};
+
+#endif // KEEPASSXC_ATTACHMENTTEXTINDEX_H
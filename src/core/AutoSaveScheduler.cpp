@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2024 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AutoSaveScheduler.h"
+
+#include "core/Clock.h"
+
+AutoSaveScheduler::AutoSaveScheduler(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &AutoSaveScheduler::checkDeadline);
+}
+
+void AutoSaveScheduler::setQuietPeriod(int msec)
+{
+    m_quietPeriod = qMax(0, msec);
+}
+
+void AutoSaveScheduler::setMaxDelay(int msec)
+{
+    m_maxDelay = qMax(0, msec);
+}
+
+bool AutoSaveScheduler::isPending() const
+{
+    return m_pending;
+}
+
+/**
+ * Note a change to be saved. Every change restarts the quiet period,
+ * the maximum delay counts from the first change since the last save.
+ */
+void AutoSaveScheduler::schedule()
+{
+    const qint64 now = Clock::currentMilliSecondsSinceEpoch();
+    m_lastChange = now;
+    if (!m_pending) {
+        m_pending = true;
+        m_firstChange = now;
+    }
+    m_timer.start(static_cast<int>(qBound<qint64>(0, deadline() - now, qMax(m_maxDelay, m_quietPeriod))));
+}
+
+/**
+ * Request the pending save right away, e.g. before the database is locked.
+ */
+void AutoSaveScheduler::flush()
+{
+    if (!isPending()) {
+        return;
+    }
+
+    cancel();
+    emit saveRequested();
+}
+
+void AutoSaveScheduler::cancel()
+{
+    m_pending = false;
+    m_timer.stop();
+}
+
+/**
+ * Request the save if its deadline passed, otherwise wait for the rest of it.
+ */
+void AutoSaveScheduler::checkDeadline()
+{
+    if (!m_pending) {
+        return;
+    }
+
+    const qint64 remaining = deadline() - Clock::currentMilliSecondsSinceEpoch();
+    if (remaining > 0) {
+        // The clock may have been turned back, never wait longer than the maximum delay
+        m_timer.start(static_cast<int>(qMin<qint64>(remaining, qMax(m_maxDelay, m_quietPeriod))));
+        return;
+    }
+    flush();
+}
+
+qint64 AutoSaveScheduler::deadline() const
+{
+    return qMin(m_lastChange + m_quietPeriod, m_firstChange + qMax(m_maxDelay, m_quietPeriod));
+}
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2024 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_AUTOSAVESCHEDULER_H
+#define KEEPASSXC_AUTOSAVESCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+
+/**
+ * Coalesces bursts of changes into a single save.
+ *
+ * A save is requested once no change was scheduled for the quiet period,
+ * but no later than the maximum delay after the first pending change.
+ * Both are measured with Clock, the timer only wakes the scheduler up.
+ */
+class AutoSaveScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AutoSaveScheduler(QObject* parent = nullptr);
+
+    void setQuietPeriod(int msec);
+    void setMaxDelay(int msec);
+    bool isPending() const;
+
+public slots:
+    void schedule();
+    void flush();
+    void cancel();
+
+signals:
+    void saveRequested();
+
+private slots:
+    void checkDeadline();
+
+private:
+    qint64 deadline() const;
+
+    QTimer m_timer;
+    int m_quietPeriod = 0;
+    int m_maxDelay = 0;
+    qint64 m_firstChange = 0;
+    qint64 m_lastChange = 0;
+    bool m_pending = false;
+
+    friend class TestAutoSaveScheduler;
+};
+
+#endif // KEEPASSXC_AUTOSAVESCHEDULER_H
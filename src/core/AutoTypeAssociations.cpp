@@ -17,6 +17,74 @@
 
 #include "AutoTypeAssociations.h"
 
+#include <QCache>
+#include <QMutex>
+#include <QRegularExpression>
+
+namespace
+{
+    // Window association pattern in a form that is quick to match
+    struct WindowPattern
+    {
+        bool isRegex = false;
+        QRegularExpression regex;
+        // Literal parts of a wildcard pattern between the '*' characters
+        QStringList segments;
+    };
+
+    struct WindowPatternCache
+    {
+        QMutex mutex;
+        QCache<QString, WindowPattern> patterns{1024};
+    };
+    Q_GLOBAL_STATIC(WindowPatternCache, s_windowPatterns)
+
+    WindowPattern compileWindowPattern(const QString& pattern)
+    {
+        WindowPattern compiled;
+        if (pattern.startsWith("//") && pattern.endsWith("//") && pattern.size() >= 4) {
+            compiled.isRegex = true;
+            compiled.regex = QRegularExpression(pattern.mid(2, pattern.size() - 4),
+                                                QRegularExpression::CaseInsensitiveOption);
+            compiled.regex.optimize();
+        } else {
+            compiled.segments = pattern.split('*');
+        }
+        return compiled;
+    }
+
+    // Match a wildcard pattern against the whole title without a regular expression
+    bool matchesSegments(const QStringList& segments, const QString& title)
+    {
+        if (segments.size() == 1) {
+            return title.compare(segments.first(), Qt::CaseInsensitive) == 0;
+        }
+
+        const QString& prefix = segments.first();
+        const QString& suffix = segments.last();
+        if (title.size() < prefix.size() + suffix.size() || !title.startsWith(prefix, Qt::CaseInsensitive)
+            || !title.endsWith(suffix, Qt::CaseInsensitive)) {
+            return false;
+        }
+
+        // Matching each inner part at its first occurrence is enough for '*' wildcards
+        int pos = prefix.size();
+        const int end = title.size() - suffix.size();
+        for (int i = 1; i < segments.size() - 1; ++i) {
+            const QString& segment = segments.at(i);
+            if (segment.isEmpty()) {
+                continue;
+            }
+            pos = title.indexOf(segment, pos, Qt::CaseInsensitive);
+            if (pos < 0 || pos + segment.size() > end) {
+                return false;
+            }
+            pos += segment.size();
+        }
+        return true;
+    }
+} // namespace
+
 bool AutoTypeAssociations::Association::operator==(const AutoTypeAssociations::Association& other) const
 {
     return window == other.window && sequence == other.sequence;
@@ -27,6 +95,37 @@ bool AutoTypeAssociations::Association::operator!=(const AutoTypeAssociations::A
     return window != other.window || sequence != other.sequence;
 }
 
+/**
+ * Check if a window title matches the window pattern of an association.
+ *
+ * Patterns enclosed in // are case insensitive regular expressions that may
+ * match any part of the title. All other patterns must match the whole title
+ * case insensitively, where * matches any text. Patterns are compiled once and
+ * shared by all entries, so matching every entry of a database stays cheap.
+ *
+ * @param pattern window pattern with placeholders already resolved
+ * @param windowTitle title of the window to match
+ * @return true if the pattern matches the window title
+ */
+bool AutoTypeAssociations::windowMatches(const QString& pattern, const QString& windowTitle)
+{
+    WindowPattern compiled;
+    {
+        QMutexLocker locker(&s_windowPatterns->mutex);
+        if (const auto* cached = s_windowPatterns->patterns.object(pattern)) {
+            compiled = *cached;
+        } else {
+            compiled = compileWindowPattern(pattern);
+            s_windowPatterns->patterns.insert(pattern, new WindowPattern(compiled));
+        }
+    }
+
+    if (compiled.isRegex) {
+        return compiled.regex.match(windowTitle).hasMatch();
+    }
+    return matchesSegments(compiled.segments, windowTitle);
+}
+
 AutoTypeAssociations::AutoTypeAssociations(QObject* parent)
     : ModifiableObject(parent)
 {
@@ -49,6 +49,8 @@ public:
     bool operator==(const AutoTypeAssociations& other) const;
     bool operator!=(const AutoTypeAssociations& other) const;
 
+    static bool windowMatches(const QString& pattern, const QString& windowTitle);
+
 private:
     QList<AutoTypeAssociations::Association> m_associations;
 
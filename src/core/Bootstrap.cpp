@@ -19,6 +19,9 @@
 #include "config-keepassx.h"
 #include "core/Translator.h"
 
+#include <QDebug>
+#include <QElapsedTimer>
+
 #ifdef Q_OS_WIN
 #include <aclapi.h> // for createWindowsDACL()
 #include <windows.h> // for Sleep(), SetDllDirectoryA(), SetSearchPathMode(), ...
@@ -75,6 +78,20 @@ namespace Bootstrap
         Translator::installTranslators(uiLanguage);
     }
 
+    /**
+     * Log the time elapsed since the first call to profile application startup.
+     *
+     * @param phase name of the startup phase that just completed
+     */
+    void logStartupPhase(const char* phase)
+    {
+        static QElapsedTimer timer;
+        if (!timer.isValid()) {
+            timer.start();
+        }
+        qDebug("Startup: %s after %lld ms", phase, timer.elapsed());
+    }
+
     // LCOV_EXCL_START
     void disableCoreDumps()
     {
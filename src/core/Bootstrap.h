@@ -26,6 +26,7 @@ namespace Bootstrap
     void disableCoreDumps();
     bool createWindowsDACL();
     void setupSearchPaths();
+    void logStartupPhase(const char* phase);
 }; // namespace Bootstrap
 
 #endif // KEEPASSXC_BOOTSTRAP_H
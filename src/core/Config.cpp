@@ -17,6 +17,7 @@
  */
 
 #include "Config.h"
+#include "Database.h"
 #include "Global.h"
 
 #include <QCoreApplication>
@@ -27,10 +28,14 @@
 #include <QSize>
 #include <QStandardPaths>
 #include <QTemporaryFile>
+#include <QTimer>
 
 #define CONFIG_VERSION 2
 #define QS QStringLiteral
 
+// Changes made within this time are written to the settings together
+static const int WriteDelayMs = 2000;
+
 enum ConfigType
 {
     Local,
@@ -60,11 +65,19 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
     {Config::AutoReloadOnChange,{QS("AutoReloadOnChange"), Roaming, true}},
     {Config::AutoSaveOnExit,{QS("AutoSaveOnExit"), Roaming, true}},
     {Config::AutoSaveNonDataChanges,{QS("AutoSaveNonDataChanges"), Roaming, true}},
+    {Config::AutoSaveQuietPeriod,{QS("AutoSaveQuietPeriod"), Roaming, 500}},
+    {Config::AutoSaveMaxDelay,{QS("AutoSaveMaxDelay"), Roaming, 5000}},
     {Config::BackupBeforeSave,{QS("BackupBeforeSave"), Roaming, false}},
     {Config::BackupFilePathPattern,{QS("BackupFilePathPattern"), Roaming, QString("{DB_FILENAME}.old.kdbx")}},
+    {Config::BackupGenerations,{QS("BackupGenerations"), Roaming, 1}},
     {Config::UseAtomicSaves,{QS("UseAtomicSaves"), Roaming, true}},
     {Config::UseDirectWriteSaves,{QS("UseDirectWriteSaves"), Local, false}},
+    {Config::CacheNetworkDatabases,{QS("CacheNetworkDatabases"), Local, false}},
+    {Config::LazyHistoryLoading,{QS("LazyHistoryLoading"), Roaming, false}},
+    {Config::CompressionLevel,{QS("CompressionLevel"), Roaming, Database::DefaultCompressionLevel}},
+    {Config::AutoSaveCompressionLevel,{QS("AutoSaveCompressionLevel"), Roaming, Database::DefaultCompressionLevel}},
     {Config::SearchLimitGroup,{QS("SearchLimitGroup"), Roaming, false}},
+    {Config::SearchAttachmentContents,{QS("SearchAttachmentContents"), Roaming, false}},
     {Config::MinimizeOnOpenUrl,{QS("MinimizeOnOpenUrl"), Roaming, false}},
     {Config::HideWindowOnCopy,{QS("HideWindowOnCopy"), Roaming, false}},
     {Config::MinimizeOnCopy,{QS("MinimizeOnCopy"), Roaming, true}},
@@ -145,6 +158,7 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
     {Config::Security_EnableCopyOnDoubleClick,{QS("Security/EnableCopyOnDoubleClick"), Roaming, false}},
     {Config::Security_QuickUnlock, {QS("Security/QuickUnlock"), Local, true}},
     {Config::Security_DatabasePasswordMinimumQuality, {QS("Security/DatabasePasswordMinimumQuality"), Local, 0}},
+    {Config::Security_StorePasswordHealth, {QS("Security/StorePasswordHealth"), Roaming, false}},
 
     // Browser
     {Config::Browser_Enabled, {QS("Browser/Enabled"), Roaming, false}},
@@ -168,6 +182,7 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
     {Config::Browser_CustomBrowserType, {QS("Browser/CustomBrowserType"), Local, -1}},
     {Config::Browser_CustomBrowserLocation, {QS("Browser/CustomBrowserLocation"), Local, {}}},
     {Config::Browser_AllowLocalhostWithPasskeys, {QS("Browser/Browser_AllowLocalhostWithPasskeys"), Roaming, false}},
+    {Config::Browser_TraceRequests, {QS("Browser/TraceRequests"), Local, false}},
 #ifdef QT_DEBUG
     {Config::Browser_CustomExtensionId, {QS("Browser/CustomExtensionId"), Local, {}}},
 #endif
@@ -225,14 +240,46 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
 
 QPointer<Config> Config::m_instance(nullptr);
 
+/**
+ * Get the value of a setting.
+ *
+ * Values are kept in a snapshot indexed by key once read, so frequent
+ * reads such as those made for every painted cell of the entry view
+ * don't have to look up the setting by its name in QSettings.
+ */
 QVariant Config::get(ConfigKey key)
 {
-    auto cfg = configStrings[key];
-    auto defaultValue = configStrings[key].defaultValue;
+    quint64 generation;
+    {
+        QReadLocker locker(&m_snapshotLock);
+        if (m_snapshotValid.testBit(key)) {
+            return m_snapshot.at(key);
+        }
+        generation = m_snapshotGeneration;
+    }
+
+    const auto cfg = configStrings.value(key);
+    QVariant value;
+    {
+        QReadLocker locker(&m_snapshotLock);
+        auto pending = m_pending.constFind(key);
+        if (pending != m_pending.constEnd()) {
+            return pending->isValid() ? pending.value() : cfg.defaultValue;
+        }
+    }
     if (m_localSettings && cfg.type == Local) {
-        return m_localSettings->value(cfg.name, defaultValue);
+        value = m_localSettings->value(cfg.name, cfg.defaultValue);
+    } else {
+        value = m_settings->value(cfg.name, cfg.defaultValue);
     }
-    return m_settings->value(cfg.name, defaultValue);
+
+    QWriteLocker locker(&m_snapshotLock);
+    // Don't store a value that was changed while reading it
+    if (generation == m_snapshotGeneration) {
+        m_snapshot[key] = value;
+        m_snapshotValid.setBit(key);
+    }
+    return value;
 }
 
 QVariant Config::getDefault(Config::ConfigKey key)
@@ -250,17 +297,28 @@ QString Config::getFileName()
     return m_settings->fileName();
 }
 
+/**
+ * Change the value of a setting.
+ *
+ * The value can be read back at once, but it is only written to the
+ * settings files after a short delay, together with all other changes made
+ * in the meantime. Call sync() to write it immediately.
+ */
 void Config::set(ConfigKey key, const QVariant& value)
 {
     if (get(key) == value) {
         return;
     }
 
-    auto cfg = configStrings[key];
-    if (cfg.type == Local && m_localSettings) {
-        m_localSettings->setValue(cfg.name, value);
-    } else {
-        m_settings->setValue(cfg.name, value);
+    {
+        QWriteLocker locker(&m_snapshotLock);
+        m_pending.insert(key, value);
+        m_snapshot[key] = value;
+        m_snapshotValid.setBit(key);
+        ++m_snapshotGeneration;
+    }
+    if (!m_writeTimer->isActive()) {
+        m_writeTimer->start();
     }
 
     emit changed(key);
@@ -268,16 +326,48 @@ void Config::set(ConfigKey key, const QVariant& value)
 
 void Config::remove(ConfigKey key)
 {
-    auto cfg = configStrings[key];
-    if (cfg.type == Local && m_localSettings) {
-        m_localSettings->remove(cfg.name);
-    } else {
-        m_settings->remove(cfg.name);
+    {
+        QWriteLocker locker(&m_snapshotLock);
+        m_pending.insert(key, QVariant());
+        m_snapshot[key] = configStrings[key].defaultValue;
+        m_snapshotValid.setBit(key);
+        ++m_snapshotGeneration;
+    }
+    if (!m_writeTimer->isActive()) {
+        m_writeTimer->start();
     }
 
     emit changed(key);
 }
 
+/**
+ * Write the pending changes to the settings. Values that the settings
+ * already hold are left alone, so reverting a change does not rewrite the
+ * settings files.
+ */
+void Config::writePending()
+{
+    m_writeTimer->stop();
+
+    QHash<int, QVariant> pending;
+    {
+        QWriteLocker locker(&m_snapshotLock);
+        pending.swap(m_pending);
+    }
+
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) {
+        const auto cfg = configStrings.value(static_cast<ConfigKey>(it.key()));
+        auto settings = cfg.type == Local && m_localSettings ? m_localSettings.data() : m_settings.data();
+        if (!it->isValid()) {
+            if (settings->contains(cfg.name)) {
+                settings->remove(cfg.name);
+            }
+        } else if (!settings->contains(cfg.name) || settings->value(cfg.name) != it.value()) {
+            settings->setValue(cfg.name, it.value());
+        }
+    }
+}
+
 /**
  * Sync configuration with persistent storage.
  *
@@ -287,6 +377,7 @@ void Config::remove(ConfigKey key)
  */
 void Config::sync()
 {
+    writePending();
     m_settings->sync();
     if (m_localSettings) {
         m_localSettings->sync();
@@ -295,10 +386,27 @@ void Config::sync()
 
 void Config::resetToDefaults()
 {
+    {
+        QWriteLocker locker(&m_snapshotLock);
+        m_pending.clear();
+    }
     m_settings->clear();
     if (m_localSettings) {
         m_localSettings->clear();
     }
+    invalidateSnapshot();
+}
+
+/**
+ * Discard the snapshot of the settings after they have been written.
+ * Writes are rare, so the whole snapshot is simply read again.
+ */
+void Config::invalidateSnapshot()
+{
+    QWriteLocker locker(&m_snapshotLock);
+    m_snapshot.fill(QVariant(), Deleted + 1);
+    m_snapshotValid.fill(false, Deleted + 1);
+    ++m_snapshotGeneration;
 }
 
 /**
@@ -460,7 +568,11 @@ Config::Config(QObject* parent)
     init(configFiles.first, configFiles.second);
 }
 
-Config::~Config() = default;
+Config::~Config()
+{
+    // Also covers command line tools, which never emit aboutToQuit()
+    sync();
+}
 
 void Config::init(const QString& configFileName, const QString& localConfigFileName)
 {
@@ -496,12 +608,20 @@ void Config::init(const QString& configFileName, const QString& localConfigFileN
     }
 #endif
 
+    m_writeTimer = new QTimer(this);
+    m_writeTimer->setSingleShot(true);
+    m_writeTimer->setInterval(WriteDelayMs);
+    connect(m_writeTimer, &QTimer::timeout, this, &Config::sync);
+
     m_settings.reset(new QSettings(configFileName, QSettings::IniFormat));
     if (!localConfigFileName.isEmpty() && configFileName != localConfigFileName) {
         m_localSettings.reset(new QSettings(localConfigFileName, QSettings::IniFormat));
     }
 
+    invalidateSnapshot();
     migrate();
+    // Migration also rewrites settings by their name
+    invalidateSnapshot();
     connect(qApp, &QCoreApplication::aboutToQuit, this, &Config::sync);
 }
 
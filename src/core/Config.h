@@ -19,11 +19,14 @@
 #ifndef KEEPASSX_CONFIG_H
 #define KEEPASSX_CONFIG_H
 
+#include <QBitArray>
 #include <QPointer>
+#include <QReadWriteLock>
 #include <QVariant>
 #include <QVector>
 
 class QSettings;
+class QTimer;
 
 class Config : public QObject
 {
@@ -43,11 +46,19 @@ public:
         AutoReloadOnChange,
         AutoSaveOnExit,
         AutoSaveNonDataChanges,
+        AutoSaveQuietPeriod,
+        AutoSaveMaxDelay,
         BackupBeforeSave,
         BackupFilePathPattern,
+        BackupGenerations,
         UseAtomicSaves,
         UseDirectWriteSaves,
+        CacheNetworkDatabases,
+        LazyHistoryLoading,
+        CompressionLevel,
+        AutoSaveCompressionLevel,
         SearchLimitGroup,
+        SearchAttachmentContents,
         MinimizeOnOpenUrl,
         HideWindowOnCopy,
         MinimizeOnCopy,
@@ -126,6 +137,7 @@ public:
         Security_EnableCopyOnDoubleClick,
         Security_QuickUnlock,
         Security_DatabasePasswordMinimumQuality,
+        Security_StorePasswordHealth,
 
         Browser_Enabled,
         Browser_ShowNotification,
@@ -148,6 +160,7 @@ public:
         Browser_CustomBrowserType,
         Browser_CustomBrowserLocation,
         Browser_AllowLocalhostWithPasskeys,
+        Browser_TraceRequests,
 #ifdef QT_DEBUG
         Browser_CustomExtensionId,
 #endif
@@ -231,6 +244,8 @@ private:
     explicit Config(QObject* parent);
     void init(const QString& configFileName, const QString& localConfigFileName);
     void migrate();
+    void invalidateSnapshot();
+    void writePending();
     static QPair<QString, QString> defaultConfigFiles();
 
     static QPointer<Config> m_instance;
@@ -238,6 +253,17 @@ private:
     QScopedPointer<QSettings> m_settings;
     QScopedPointer<QSettings> m_localSettings;
     QHash<QString, QVariant> m_defaults;
+
+    // Values read from the settings, indexed by ConfigKey, see get()
+    QReadWriteLock m_snapshotLock;
+    QVector<QVariant> m_snapshot;
+    QBitArray m_snapshotValid;
+    quint64 m_snapshotGeneration = 0;
+
+    // Changes not yet written to the settings, an invalid value removes the
+    // setting. Guarded by m_snapshotLock.
+    QHash<int, QVariant> m_pending;
+    QTimer* m_writeTimer = nullptr;
 };
 
 inline Config* config()
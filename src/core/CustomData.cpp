@@ -20,6 +20,8 @@
 #include "core/Clock.h"
 #include "core/Global.h"
 
+#include <algorithm>
+
 const QString CustomData::LastModified = QStringLiteral("_LAST_MODIFIED");
 const QString CustomData::Created = QStringLiteral("_CREATED");
 const QString CustomData::BrowserKeyPrefix = QStringLiteral("KPXC_BROWSER_");
@@ -34,40 +36,49 @@ CustomData::CustomData(QObject* parent)
 {
 }
 
+/**
+ * @return the keys in ascending order
+ */
 QList<QString> CustomData::keys() const
 {
-    return m_data.keys();
+    QList<QString> keys;
+    keys.reserve(m_data.size());
+    for (const auto& pair : m_data) {
+        keys.append(pair.first);
+    }
+    return keys;
 }
 
 bool CustomData::hasKey(const QString& key) const
 {
-    return m_data.contains(key);
+    return indexOf(key) >= 0;
 }
 
 QString CustomData::value(const QString& key) const
 {
-    return m_data.value(key).value;
+    const int index = indexOf(key);
+    return index >= 0 ? m_data.at(index).second.value : QString();
 }
 
 const CustomData::CustomDataItem& CustomData::item(const QString& key) const
 {
-    auto item = m_data.find(key);
-    Q_ASSERT(item != m_data.end());
-    if (item == m_data.end()) {
+    const int index = indexOf(key);
+    Q_ASSERT(index >= 0);
+    if (index < 0) {
         return NULL_ITEM;
     }
-    return item.value();
+    return m_data.at(index).second;
 }
 
 bool CustomData::contains(const QString& key) const
 {
-    return m_data.contains(key);
+    return indexOf(key) >= 0;
 }
 
 bool CustomData::containsValue(const QString& value) const
 {
-    for (auto i = m_data.constBegin(); i != m_data.constEnd(); ++i) {
-        if (i.value().value == value) {
+    for (const auto& pair : m_data) {
+        if (pair.second.value == value) {
             return true;
         }
     }
@@ -76,8 +87,9 @@ bool CustomData::containsValue(const QString& value) const
 
 void CustomData::set(const QString& key, CustomDataItem item)
 {
-    bool addAttribute = !m_data.contains(key);
-    bool changeValue = !addAttribute && (m_data.value(key).value != item.value);
+    const int index = indexOf(key);
+    bool addAttribute = index < 0;
+    bool changeValue = !addAttribute && (m_data.at(index).second.value != item.value);
 
     if (addAttribute) {
         emit aboutToBeAdded(key);
@@ -87,7 +99,7 @@ void CustomData::set(const QString& key, CustomDataItem item)
         item.lastModified = Clock::currentDateTimeUtc();
     }
     if (addAttribute || changeValue) {
-        m_data.insert(key, item);
+        insert(key, item);
         updateLastModified();
         emitModified();
     }
@@ -106,8 +118,8 @@ void CustomData::remove(const QString& key)
 {
     emit aboutToBeRemoved(key);
 
-    if (m_data.contains(key)) {
-        m_data.remove(key);
+    if (contains(key)) {
+        take(key);
         updateLastModified();
         emitModified();
     }
@@ -117,20 +129,20 @@ void CustomData::remove(const QString& key)
 
 void CustomData::rename(const QString& oldKey, const QString& newKey)
 {
-    const bool containsOldKey = m_data.contains(oldKey);
-    const bool containsNewKey = m_data.contains(newKey);
+    const bool containsOldKey = contains(oldKey);
+    const bool containsNewKey = contains(newKey);
     Q_ASSERT(containsOldKey && !containsNewKey);
     if (!containsOldKey || containsNewKey) {
         return;
     }
 
-    CustomDataItem data = m_data.value(oldKey);
+    CustomDataItem data = item(oldKey);
 
     emit aboutToRename(oldKey, newKey);
 
-    m_data.remove(oldKey);
+    take(oldKey);
     data.lastModified = Clock::currentDateTimeUtc();
-    m_data.insert(newKey, data);
+    insert(newKey, data);
 
     updateLastModified();
     emitModified();
@@ -154,15 +166,17 @@ void CustomData::copyDataFrom(const CustomData* other)
 
 QDateTime CustomData::lastModified() const
 {
-    if (m_data.contains(LastModified)) {
-        return Clock::parse(m_data.value(LastModified).value);
+    const int index = indexOf(LastModified);
+    if (index >= 0) {
+        return Clock::parse(m_data.at(index).second.value);
     }
 
     // Try to find the latest modification time in items as a fallback
     QDateTime modified;
-    for (auto i = m_data.constBegin(); i != m_data.constEnd(); ++i) {
-        if (i->lastModified.isValid() && (!modified.isValid() || i->lastModified > modified)) {
-            modified = i->lastModified;
+    for (const auto& pair : m_data) {
+        const QDateTime& itemModified = pair.second.lastModified;
+        if (itemModified.isValid() && (!modified.isValid() || itemModified > modified)) {
+            modified = itemModified;
         }
     }
     return modified;
@@ -170,20 +184,21 @@ QDateTime CustomData::lastModified() const
 
 QDateTime CustomData::lastModified(const QString& key) const
 {
-    return m_data.value(key).lastModified;
+    const int index = indexOf(key);
+    return index >= 0 ? m_data.at(index).second.lastModified : QDateTime();
 }
 
 void CustomData::updateLastModified(QDateTime lastModified)
 {
-    if (m_data.isEmpty() || (m_data.size() == 1 && m_data.contains(LastModified))) {
-        m_data.remove(LastModified);
+    if (m_data.isEmpty() || (m_data.size() == 1 && contains(LastModified))) {
+        take(LastModified);
         return;
     }
 
     if (!lastModified.isValid()) {
         lastModified = Clock::currentDateTimeUtc();
     }
-    m_data.insert(LastModified, {lastModified.toString(), QDateTime()});
+    insert(LastModified, {lastModified.toString(), QDateTime()});
 }
 
 bool CustomData::isProtected(const QString& key) const
@@ -225,15 +240,54 @@ int CustomData::dataSize() const
 {
     int size = 0;
 
-    QHashIterator<QString, CustomDataItem> i(m_data);
-    while (i.hasNext()) {
-        i.next();
-
+    for (const auto& pair : m_data) {
         // In theory, we should be adding the datetime string size as well, but it makes
         // length calculations rather unpredictable. We also don't know if this instance
         // is entry/group-level CustomData or global CustomData (the only CustomData that
         // actually retains the datetime in the KDBX file).
-        size += i.key().toUtf8().size() + i.value().value.toUtf8().size();
+        size += pair.first.toUtf8().size() + pair.second.value.toUtf8().size();
     }
     return size;
 }
+
+/**
+ * @return position of the first key that is not less than the given one
+ */
+int CustomData::lowerBound(const QString& key) const
+{
+    const auto it = std::lower_bound(
+        m_data.constBegin(), m_data.constEnd(), key, [](const QPair<QString, CustomDataItem>& pair, const QString& k) {
+            return pair.first < k;
+        });
+    return static_cast<int>(it - m_data.constBegin());
+}
+
+int CustomData::indexOf(const QString& key) const
+{
+    const int index = lowerBound(key);
+    if (index < m_data.size() && m_data.at(index).first == key) {
+        return index;
+    }
+    return -1;
+}
+
+/**
+ * Add a pair or replace the item of an existing key, keeping the keys sorted.
+ */
+void CustomData::insert(const QString& key, const CustomDataItem& item)
+{
+    const int index = lowerBound(key);
+    if (index < m_data.size() && m_data.at(index).first == key) {
+        m_data[index].second = item;
+    } else {
+        m_data.insert(index, qMakePair(key, item));
+    }
+}
+
+void CustomData::take(const QString& key)
+{
+    const int index = indexOf(key);
+    if (index >= 0) {
+        m_data.remove(index);
+    }
+}
@@ -19,11 +19,20 @@
 #define KEEPASSXC_CUSTOMDATA_H
 
 #include <QDateTime>
-#include <QHash>
 #include <QObject>
+#include <QPair>
+#include <QVector>
 
 #include "core/ModifiableObject.h"
 
+/**
+ * Key-value pairs attached to the database, a group or an entry.
+ *
+ * Most items have no or only a few pairs, so they are kept in a vector
+ * sorted by key instead of a hash. The vector is implicitly shared: an
+ * empty instance does not allocate, and copies made for history items and
+ * clones share the pairs until one of them changes.
+ */
 class CustomData : public ModifiableObject
 {
     Q_OBJECT
@@ -86,7 +95,12 @@ private slots:
     void updateLastModified(QDateTime lastModified = {});
 
 private:
-    QHash<QString, CustomDataItem> m_data;
+    int lowerBound(const QString& key) const;
+    int indexOf(const QString& key) const;
+    void insert(const QString& key, const CustomDataItem& item);
+    void take(const QString& key);
+
+    QVector<QPair<QString, CustomDataItem>> m_data;
 };
 
 #endif // KEEPASSXC_CUSTOMDATA_H
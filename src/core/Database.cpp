@@ -19,33 +19,158 @@
 #include "Database.h"
 
 #include "core/AsyncTask.h"
+#include "core/AttachmentTextIndex.h"
 #include "core/FileWatcher.h"
 #include "core/Group.h"
+#include "core/MemoryUsage.h"
+#include "core/NetworkFile.h"
+#include "core/PasswordHealth.h"
+#include "core/Trace.h"
 #include "crypto/Random.h"
 #include "format/KdbxXmlReader.h"
+#include "format/KdbxXmlWriter.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 
+#include <QBuffer>
 #include <QFileInfo>
 #include <QJsonObject>
 #include <QRegularExpression>
 #include <QSaveFile>
+#include <QScopedValueRollback>
 #include <QTemporaryFile>
+#include <QThread>
 #include <QTimer>
 
 #ifdef Q_OS_WIN
 #include <Windows.h>
 #endif
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+#ifdef Q_OS_MACOS
+#include <sys/clonefile.h>
+#endif
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+struct Database::BackgroundSave
+{
+    QSharedPointer<Database> snapshot;
+    QSharedPointer<const CompositeKey> key;
+    QSharedPointer<Kdf> kdf;
+    quint64 revision = 0;
+    QString filePath;
+    bool isNewFile = false;
+    bool isHidden = false;
+    QFuture<bool> future;
+    QString error;
+};
 
 QHash<QUuid, QPointer<Database>> Database::s_uuidMap;
+// Databases are also created on worker threads, e.g. to read KeeShare containers
+QMutex Database::s_uuidMapMutex;
+
+namespace
+{
+    // Same name as KeeAgentSettings uses, the SSH agent is not part of the core library
+    const QString KeeAgentSettingsAttachment = QStringLiteral("KeeAgent.settings");
+
+    /**
+     * Copy a file by sharing its data blocks, which takes constant time on
+     * file systems with copy-on-write support (Btrfs, XFS, APFS).
+     */
+    bool cloneFile(const QString& filePath, const QString& destinationFilePath)
+    {
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+        int source = ::open(QFile::encodeName(filePath).constData(), O_RDONLY | O_CLOEXEC);
+        if (source < 0) {
+            return false;
+        }
+        int destination =
+            ::open(QFile::encodeName(destinationFilePath).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (destination < 0) {
+            ::close(source);
+            return false;
+        }
+        bool ok = ::ioctl(destination, FICLONE, source) == 0;
+        ::close(destination);
+        ::close(source);
+        if (!ok) {
+            QFile::remove(destinationFilePath);
+        }
+        return ok;
+#elif defined(Q_OS_MACOS)
+        const QByteArray sourcePath = QFile::encodeName(filePath);
+        const QByteArray destinationPath = QFile::encodeName(destinationFilePath);
+        return ::clonefile(sourcePath.constData(), destinationPath.constData(), 0) == 0;
+#else
+        Q_UNUSED(filePath)
+        Q_UNUSED(destinationFilePath)
+        return false;
+#endif
+    }
+
+    bool linkFile(const QString& filePath, const QString& destinationFilePath)
+    {
+#ifdef Q_OS_UNIX
+        return ::link(QFile::encodeName(filePath).constData(), QFile::encodeName(destinationFilePath).constData()) == 0;
+#else
+        Q_UNUSED(filePath)
+        Q_UNUSED(destinationFilePath)
+        return false;
+#endif
+    }
+
+    /**
+     * Path of an older backup generation, e.g. Passwords.old.2.kdbx for Passwords.old.kdbx.
+     */
+    QString backupGenerationPath(const QString& filePath, int generation)
+    {
+        const QString suffix = QFileInfo(filePath).suffix();
+        if (suffix.isEmpty()) {
+            return QString("%1.%2").arg(filePath).arg(generation);
+        }
+        return QString("%1.%2.%3").arg(filePath.left(filePath.size() - suffix.size() - 1)).arg(generation).arg(suffix);
+    }
+
+    // Path of a group as used by Group::findGroupByPath(), e.g. "/" for the root group
+    QString groupPathOf(const Group* group)
+    {
+        QString path;
+        for (; group && group->parentGroup(); group = group->parentGroup()) {
+            path.prepend(group->name() + "/");
+        }
+        return path.prepend("/");
+    }
+
+    bool isBelow(const Group* group, const Group* base)
+    {
+        for (; group; group = group->parentGroup()) {
+            if (group == base) {
+                return true;
+            }
+        }
+        return false;
+    }
+} // namespace
 
 Database::Database()
     : m_metadata(new Metadata(this))
     , m_data()
     , m_rootGroup(nullptr)
     , m_fileWatcher(new FileWatcher(this))
+    , m_attachmentTextIndex(new AttachmentTextIndex(this))
     , m_uuid(QUuid::createUuid())
 {
+    m_xmlEntryCache = QSharedPointer<KdbxXmlEntryCache>::create();
+    m_xmlEntryCacheTimer.setSingleShot(true);
+    m_xmlEntryCacheTimer.setInterval(XmlEntryCacheIdleTimeout);
+    connect(&m_xmlEntryCacheTimer, &QTimer::timeout, this, &Database::dropXmlEntryCache);
+
     // setup modified timer
     m_modifiedTimer.setSingleShot(true);
     connect(this, &Database::emitModifiedChanged, this, [this](bool value) {
@@ -57,16 +182,29 @@ Database::Database()
 
     // other signals
     connect(m_metadata, &Metadata::modified, this, &Database::markAsModified);
-    connect(this, &Database::databaseOpened, this, [this]() {
-        updateCommonUsernames();
+    connect(this, &Database::modified, this, [this] {
         updateTagList();
+        updateCommonUsernames();
     });
-    connect(this, &Database::modified, this, [this] { updateTagList(); });
     connect(this, &Database::databaseSaved, this, [this]() { updateCommonUsernames(); });
+    // Group names and the hierarchy are part of every entry as far as searching is concerned
+    connect(this, &Database::groupDataChanged, this, [this] {
+        resetEntryChanges();
+        m_pathIndexStale = true;
+        // Renames also arrive through Group::copyDataFrom(), e.g. from the group editor
+        ++m_groupHierarchyRevision;
+    });
+    connect(this, &Database::groupMoved, this, [this] {
+        resetEntryChanges();
+        m_pathIndexStale = true;
+    });
     connect(m_fileWatcher, &FileWatcher::fileChanged, this, &Database::databaseFileChanged);
 
     // static uuid map
-    s_uuidMap.insert(m_uuid, this);
+    {
+        QMutexLocker uuidMapLocker(&s_uuidMapMutex);
+        s_uuidMap.insert(m_uuid, this);
+    }
 
     // block modified signal and set root group
     setEmitModified(false);
@@ -127,8 +265,8 @@ bool Database::open(QSharedPointer<const CompositeKey> key, QString* error)
  */
 bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey> key, QString* error)
 {
-    QFile dbFile(filePath);
-    if (!dbFile.exists()) {
+    TRACE_SCOPE("Database::open");
+    if (!QFile::exists(filePath)) {
         if (error) {
             *error = tr("File %1 does not exist.").arg(filePath);
         }
@@ -142,7 +280,18 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
     // }
     //
     // if (!dbFile.isOpen() && !dbFile.open(QIODevice::ReadOnly)) {
-    if (!dbFile.open(QIODevice::ReadOnly)) {
+    QFile localFile(filePath);
+    QBuffer networkFile;
+    QIODevice* dbFile = &localFile;
+    if (NetworkFile::isOnNetworkFileSystem(filePath)) {
+        // Read in one request instead of many small buffered reads
+        QByteArray data;
+        if (NetworkFile::read(filePath, data)) {
+            networkFile.setData(data);
+            dbFile = &networkFile;
+        }
+    }
+    if (!dbFile->open(QIODevice::ReadOnly)) {
         if (error) {
             *error = tr("Unable to open file %1.").arg(filePath);
         }
@@ -152,7 +301,10 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
     setEmitModified(false);
 
     KeePass2Reader reader;
-    if (!reader.readDatabase(&dbFile, std::move(key), this)) {
+    const bool ok = reader.readDatabase(dbFile, std::move(key), this);
+    reuseTransformedKey(nullptr);
+    m_loadTimings = reader.timings();
+    if (!ok) {
         if (error) {
             *error = tr("Error while reading the database: %1").arg(reader.errorString());
         }
@@ -160,7 +312,9 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
     }
 
     setFilePath(filePath);
-    dbFile.close();
+    dbFile->close();
+    PasswordHealthCache::instance()->load(this);
+    qDebug("Opened %s (%s)", qPrintable(filePath), qPrintable(m_loadTimings.toString()));
 
     markAsClean();
 
@@ -171,6 +325,198 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
     return true;
 }
 
+/**
+ * Update the database in place to the content of other, a newer copy of the
+ * same database such as its reloaded file. Only the groups and entries that
+ * differ are changed, so views of the database and its indexes are kept.
+ * Afterwards the database is modified if other is.
+ *
+ * @param other copy of this database opened with the same key
+ * @return false if other is not a copy of this database, nothing is changed then
+ */
+bool Database::reloadFrom(const Database* other)
+{
+    if (!other || !m_rootGroup || !other->m_rootGroup || !other->m_data.kdf || other->m_data.key != m_data.key
+        || other->m_rootGroup->uuid() != m_rootGroup->uuid()) {
+        return false;
+    }
+
+    {
+        BatchUpdate batch(this);
+
+        // Everything is copied with the times of other
+        m_rootGroup->forEachGroupRecursive([](Group* group) { group->setUpdateTimeinfo(false); });
+        m_rootGroup->forEachEntryRecursive([](Entry* entry) { entry->setUpdateTimeinfo(false); });
+        m_metadata->setUpdateDatetime(false);
+
+        // Icons are added first, so that they exist once they are used
+        const auto otherIcons = other->m_metadata->customIconsOrder();
+        for (const QUuid& uuid : otherIcons) {
+            const auto& icon = other->m_metadata->customIcon(uuid);
+            if (m_metadata->hasCustomIcon(uuid) && !(m_metadata->customIcon(uuid) == icon)) {
+                m_metadata->removeCustomIcon(uuid);
+            }
+            if (!m_metadata->hasCustomIcon(uuid)) {
+                m_metadata->addCustomIcon(uuid, icon);
+            }
+        }
+
+        // Parents are visited before their children, so they are already in place
+        QSet<QUuid> groupUuids;
+        other->m_rootGroup->forEachGroupRecursive([&](const Group* otherGroup) {
+            groupUuids.insert(otherGroup->uuid());
+            Group* group = m_rootGroup->findGroupByUuid(otherGroup->uuid());
+            const Group* otherParent = otherGroup->parentGroup();
+            if (otherParent) {
+                Group* parent = m_rootGroup->findGroupByUuid(otherParent->uuid());
+                Q_ASSERT(parent);
+                if (!group) {
+                    group = new Group();
+                    group->setUpdateTimeinfo(false);
+                    group->setUuid(otherGroup->uuid());
+                }
+                const int maxIndex = parent->children().size() - (group->parentGroup() == parent ? 1 : 0);
+                group->setParent(parent, qMin(otherParent->children().indexOf(otherGroup), maxIndex), false);
+            }
+            group->copyDataFrom(otherGroup);
+        });
+
+        QSet<QUuid> entryUuids;
+        other->m_rootGroup->forEachGroupRecursive([&](const Group* otherGroup) {
+            Group* group = m_rootGroup->findGroupByUuid(otherGroup->uuid());
+            for (const Entry* otherEntry : otherGroup->entries()) {
+                entryUuids.insert(otherEntry->uuid());
+                Entry* entry = m_rootGroup->findEntryByUuid(otherEntry->uuid());
+                if (!entry) {
+                    entry = otherEntry->clone(Entry::CloneIncludeHistory);
+                    entry->setUpdateTimeinfo(false);
+                    entry->setGroup(group);
+                    continue;
+                }
+
+                if (entry->group() != group) {
+                    entry->setGroup(group, false);
+                }
+                if (entry->fingerprint() != otherEntry->fingerprint()) {
+                    entry->copyDataFrom(otherEntry);
+                    entry->setUpdateTimeinfo(false);
+
+                    const auto& otherHistory = otherEntry->historyItems();
+                    const auto history = entry->historyItems();
+                    bool sameHistory = history.size() == otherHistory.size();
+                    for (int i = 0; sameHistory && i < history.size(); ++i) {
+                        sameHistory = history[i]->equals(otherHistory[i]);
+                    }
+                    if (!sameHistory) {
+                        entry->removeHistoryItems(history);
+                        for (const Entry* historyItem : otherHistory) {
+                            entry->addHistoryItem(historyItem->clone(Entry::CloneNoFlags));
+                        }
+                    }
+                }
+                entry->setPreviousParentGroupUuid(otherEntry->previousParentGroupUuid());
+                entry->setTimeInfo(otherEntry->timeInfo());
+            }
+        });
+
+        QList<Entry*> removedEntries;
+        m_rootGroup->forEachEntryRecursive([&](Entry* entry) {
+            if (!entryUuids.contains(entry->uuid())) {
+                removedEntries.append(entry);
+            }
+        });
+        qDeleteAll(removedEntries);
+
+        // Deleting the topmost removed groups takes their children along
+        QList<Group*> removedGroups;
+        m_rootGroup->forEachGroupRecursive(
+            [&](Group* group) {
+                if (!groupUuids.contains(group->uuid()) && groupUuids.contains(group->parentGroup()->uuid())) {
+                    removedGroups.append(group);
+                }
+            },
+            false);
+        qDeleteAll(removedGroups);
+
+        // Only the entries that are out of order are moved to the end of their group
+        other->m_rootGroup->forEachGroupRecursive([&](const Group* otherGroup) {
+            Group* group = m_rootGroup->findGroupByUuid(otherGroup->uuid());
+            const auto& otherEntries = otherGroup->entries();
+            const auto entries = group->entries();
+            int first = 0;
+            while (first < otherEntries.size() && first < entries.size()
+                   && entries[first]->uuid() == otherEntries[first]->uuid()) {
+                ++first;
+            }
+            for (int i = first; i < otherEntries.size(); ++i) {
+                Entry* entry = m_rootGroup->findEntryByUuid(otherEntries[i]->uuid());
+                group->removeEntry(entry);
+                group->addEntry(entry);
+            }
+
+            const Entry* otherTopEntry = otherGroup->lastTopVisibleEntry();
+            group->setLastTopVisibleEntry(otherTopEntry ? m_rootGroup->findEntryByUuid(otherTopEntry->uuid())
+                                                        : nullptr);
+        });
+
+        copyMetadataFrom(other);
+        for (const QUuid& uuid : m_metadata->customIconsOrder()) {
+            if (!other->m_metadata->hasCustomIcon(uuid)) {
+                m_metadata->removeCustomIcon(uuid);
+            }
+        }
+
+        m_data.formatVersion = other->m_data.formatVersion;
+        m_data.cipher = other->m_data.cipher;
+        m_data.compressionAlgorithm = other->m_data.compressionAlgorithm;
+        m_data.compressionLevel = other->m_data.compressionLevel;
+        m_data.kdf = other->m_data.kdf->clone();
+        m_data.transformedDatabaseKey->setRawKey(other->m_data.transformedDatabaseKey->rawKey());
+        m_data.publicCustomData = other->m_data.publicCustomData;
+        setDeletedObjects(other->m_deletedObjects);
+
+        m_metadata->setUpdateDatetime(true);
+        m_rootGroup->forEachGroupRecursive([](Group* group) { group->setUpdateTimeinfo(true); });
+        m_rootGroup->forEachEntryRecursive([](Entry* entry) { entry->setUpdateTimeinfo(true); });
+    }
+
+    if (other->isModified()) {
+        markAsModified();
+    } else {
+        markAsClean();
+    }
+    return true;
+}
+
+/**
+ * Copy the metadata of other except for its custom icons. Groups referenced by
+ * the metadata are looked up by uuid, so the group tree must be in place already.
+ */
+void Database::copyMetadataFrom(const Database* other)
+{
+    auto findGroup = [this](const Group* otherGroup) {
+        return otherGroup ? m_rootGroup->findGroupByUuid(otherGroup->uuid()) : nullptr;
+    };
+    m_metadata->copyAttributesFrom(other->m_metadata);
+    m_metadata->customData()->copyDataFrom(other->m_metadata->customData());
+    m_metadata->setRecycleBin(findGroup(other->m_metadata->recycleBin()));
+    m_metadata->setEntryTemplatesGroup(findGroup(other->m_metadata->entryTemplatesGroup()));
+    m_metadata->setLastSelectedGroup(findGroup(other->m_metadata->lastSelectedGroup()));
+    m_metadata->setLastTopVisibleGroup(findGroup(other->m_metadata->lastTopVisibleGroup()));
+    if (other->m_metadata->recycleBinChanged().isValid()) {
+        m_metadata->setRecycleBinChanged(other->m_metadata->recycleBinChanged());
+    }
+    if (other->m_metadata->entryTemplatesGroupChanged().isValid()) {
+        m_metadata->setEntryTemplatesGroupChanged(other->m_metadata->entryTemplatesGroupChanged());
+    }
+    if (other->m_metadata->databaseKeyChanged().isValid()) {
+        m_metadata->setDatabaseKeyChanged(other->m_metadata->databaseKeyChanged());
+    }
+    if (other->m_metadata->settingsChanged().isValid()) {
+        m_metadata->setSettingsChanged(other->m_metadata->settingsChanged());
+    }
+}
+
 /**
  * KDBX format version.
  */
@@ -194,6 +540,9 @@ bool Database::hasMinorVersionMismatch() const
 
 bool Database::isSaving()
 {
+    if (m_backgroundSave || m_supersedingBackgroundSave) {
+        return true;
+    }
     bool locked = m_saveMutex.tryLock();
     if (locked) {
         m_saveMutex.unlock();
@@ -201,6 +550,30 @@ bool Database::isSaving()
     return !locked;
 }
 
+/**
+ * @return durations of the stages of the last time the database was opened
+ */
+const StageTimings& Database::loadTimings() const
+{
+    return m_loadTimings;
+}
+
+/**
+ * @return durations of the stages of the last time the database was saved
+ */
+const StageTimings& Database::saveTimings() const
+{
+    return m_saveTimings;
+}
+
+/**
+ * Performance counters of the database, like search latencies and cache hit rates.
+ */
+DatabaseCounters& Database::counters() const
+{
+    return m_counters;
+}
+
 /**
  * Save the database to the current file path. It is an error to call this function
  * if no file path has been defined.
@@ -244,33 +617,18 @@ bool Database::save(SaveAction action, const QString& backupFilePath, QString* e
  */
 bool Database::saveAs(const QString& filePath, SaveAction action, const QString& backupFilePath, QString* error)
 {
-    // Disallow overlapping save operations
-    if (isSaving()) {
-        if (error) {
-            *error = tr("Database save is already in progress.");
-        }
-        return false;
+    // A running background save is superseded by this one. Saves started while it
+    // reports its outcome would overlap this one and are refused.
+    if (m_backgroundSave) {
+        QScopedValueRollback<bool> superseding(m_supersedingBackgroundSave, true);
+        AsyncTask::waitForFuture(m_backgroundSave->future);
+        finishBackgroundSave();
     }
 
-    // Never save an uninitialized database
-    if (!isInitialized()) {
-        if (error) {
-            *error = tr("Could not save, database has not been initialized!");
-        }
+    if (!canSave(filePath, error)) {
         return false;
     }
 
-    if (filePath == m_data.filePath) {
-        // Fail-safe check to make sure we don't overwrite underlying file changes
-        // that have not yet triggered a file reload/merge operation.
-        if (!m_fileWatcher->hasSameFileChecksum()) {
-            if (error) {
-                *error = tr("Database file has unmerged changes.");
-            }
-            return false;
-        }
-    }
-
     // Clear read-only flag
     m_fileWatcher->stop();
 
@@ -290,7 +648,9 @@ bool Database::saveAs(const QString& filePath, SaveAction action, const QString&
 #endif
 
     bool ok = AsyncTask::runAndWaitForFuture([&] { return performSave(realFilePath, action, backupFilePath, error); });
+    m_xmlEntryCacheTimer.start();
     if (ok) {
+        qDebug("Saved %s (%s)", qPrintable(realFilePath), qPrintable(m_saveTimings.toString()));
         setFilePath(filePath);
         markAsClean();
         if (isNewFile) {
@@ -312,10 +672,271 @@ bool Database::saveAs(const QString& filePath, SaveAction action, const QString&
     return ok;
 }
 
+/**
+ * Save the database to the current file path without waiting for the file to be written.
+ *
+ * The file is written from a copy of the database on a worker thread, so the database
+ * can be changed meanwhile. Such changes are not part of the file and the database
+ * stays modified. The outcome is reported by backgroundSaveFinished().
+ *
+ * @param action how the file is written
+ * @param backupFilePath Absolute path to the location where the backup should be stored. Passing an empty string
+ * disables backup.
+ * @param error error message in case the save could not be started
+ * @return true if the save was started
+ */
+bool Database::saveInBackground(SaveAction action, const QString& backupFilePath, QString* error)
+{
+    if (m_data.filePath.isEmpty()) {
+        if (error) {
+            *error = tr("Could not save, database does not point to a valid file.");
+        }
+        return false;
+    }
+
+    if (!canSave(m_data.filePath, error)) {
+        return false;
+    }
+
+    // Clear read-only flag
+    m_fileWatcher->stop();
+
+    auto save = QSharedPointer<BackgroundSave>::create();
+    auto snapshot = createSnapshot();
+    // Add random data to prevent side-channel data deduplication attacks
+    int length = Random::instance()->randomUIntRange(64, 512);
+    snapshot->metadata()->customData()->set("KPXC_RANDOM_SLUG", Random::instance()->randomArray(length).toHex());
+    // The worker owns the snapshot while writing it, so the history items it loads are kept
+    snapshot->moveToThread(nullptr);
+    save->snapshot.reset(snapshot, [](Database* db) {
+        db->moveToThread(QThread::currentThread());
+        delete db;
+    });
+    save->key = m_data.key;
+    save->kdf = m_data.kdf;
+    save->revision = m_contentRevision;
+
+    QFileInfo fileInfo(m_data.filePath);
+    save->filePath = fileInfo.exists() ? fileInfo.canonicalFilePath() : fileInfo.absoluteFilePath();
+    save->isNewFile = !QFile::exists(save->filePath);
+#ifdef Q_OS_WIN
+    save->isHidden = fileInfo.isHidden();
+#endif
+
+    save->future = AsyncTask::run(
+        [save, action, backupFilePath] {
+            save->snapshot->moveToThread(QThread::currentThread());
+            const bool ok = save->snapshot->performSave(save->filePath, action, backupFilePath, &save->error);
+            save->snapshot->moveToThread(nullptr);
+            return ok;
+        },
+        AsyncTask::Priority::Background);
+    m_backgroundSave = save;
+
+    auto watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher] {
+        watcher->deleteLater();
+        finishBackgroundSave();
+    });
+    watcher->setFuture(save->future);
+
+    return true;
+}
+
+bool Database::canSave(const QString& filePath, QString* error)
+{
+    // Disallow overlapping save operations
+    if (isSaving()) {
+        if (error) {
+            *error = tr("Database save is already in progress.");
+        }
+        return false;
+    }
+
+    // Never save an uninitialized database
+    if (!isInitialized()) {
+        if (error) {
+            *error = tr("Could not save, database has not been initialized!");
+        }
+        return false;
+    }
+
+    if (filePath == m_data.filePath) {
+        // Fail-safe check to make sure we don't overwrite underlying file changes
+        // that have not yet triggered a file reload/merge operation.
+        if (!m_fileWatcher->hasSameFileChecksum()) {
+            if (error) {
+                *error = tr("Database file has unmerged changes.");
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Copy of the groups, entries, metadata and deleted objects of this database. Attribute
+ * values and attachments are implicitly shared with this database until either side
+ * changes them.
+ */
+Database* Database::cloneContent() const
+{
+    auto snapshot = new Database();
+    snapshot->setEmitModified(false);
+
+    delete snapshot->setRootGroup(m_rootGroup->clone(Entry::CloneIncludeHistory, Group::CloneIncludeEntries));
+    m_rootGroup->forEachGroupRecursive([snapshot](const Group* group) {
+        if (const Entry* topEntry = group->lastTopVisibleEntry()) {
+            snapshot->m_rootGroup->findGroupByUuid(group->uuid())
+                ->setLastTopVisibleEntry(snapshot->m_rootGroup->findEntryByUuid(topEntry->uuid()));
+        }
+    });
+
+    const auto icons = m_metadata->customIconsOrder();
+    for (const QUuid& uuid : icons) {
+        snapshot->m_metadata->addCustomIcon(uuid, m_metadata->customIcon(uuid));
+    }
+    snapshot->copyMetadataFrom(this);
+    snapshot->m_deletedObjects = m_deletedObjects;
+    snapshot->m_deletedObjectCounts = m_deletedObjectCounts;
+
+    return snapshot;
+}
+
+/**
+ * Copy of the database to be written by a background save.
+ */
+Database* Database::createSnapshot() const
+{
+    auto snapshot = cloneContent();
+
+    snapshot->m_data.formatVersion = m_data.formatVersion;
+    snapshot->m_data.cipher = m_data.cipher;
+    snapshot->m_data.compressionAlgorithm = m_data.compressionAlgorithm;
+    snapshot->m_data.compressionLevel = m_data.compressionLevel;
+    snapshot->m_backupGenerations = m_backupGenerations;
+    // Only one save runs at a time, so the snapshot can update the cache of this database
+    snapshot->m_xmlEntryCache = m_xmlEntryCache;
+    snapshot->m_data.masterSeed->setRawKey(m_data.masterSeed->rawKey());
+    snapshot->m_data.transformedDatabaseKey->setRawKey(m_data.transformedDatabaseKey->rawKey());
+    snapshot->m_data.challengeResponseKey->setRawKey(m_data.challengeResponseKey->rawKey());
+    snapshot->m_data.key = m_data.key;
+    snapshot->m_data.kdf = m_data.kdf->clone();
+    snapshot->m_data.publicCustomData = m_data.publicCustomData;
+
+    return snapshot;
+}
+
+/**
+ * Immutable copy of the database that other threads can read while this one
+ * keeps changing. It shares attribute values and attachments with this
+ * database, and all callers share the same copy until the content of the
+ * database changes.
+ *
+ * The objects of the copy belong to no thread, which turns off the caches that
+ * are only kept on their owning thread. Everything else that is built lazily
+ * is built before the copy is returned, so readers never write to it. Serialized
+ * history items stay serialized, readers see them through Entry::historyCount().
+ */
+QSharedPointer<const Database> Database::readSnapshot() const
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    auto snapshot = m_readSnapshot.toStrongRef();
+    if (snapshot && m_readSnapshotRevision == m_contentRevision) {
+        return snapshot;
+    }
+
+    Database* copy = cloneContent();
+    copy->m_data.filePath = m_data.filePath;
+    copy->prepareForReaders();
+    copy->moveToThread(nullptr);
+
+    // The last reader may release the copy on any thread
+    snapshot.reset(copy, [](const Database* db) {
+        auto database = const_cast<Database*>(db);
+        database->moveToThread(QThread::currentThread());
+        delete database;
+    });
+    m_readSnapshot = snapshot;
+    m_readSnapshotRevision = m_contentRevision;
+    return snapshot;
+}
+
+/**
+ * Build the indexes and entry caches that are otherwise built on first use.
+ */
+void Database::prepareForReaders()
+{
+    searchIndex();
+    urlIndex();
+    passkeyIndex();
+    passwordIndex();
+    sshKeyEntries();
+    ensurePathIndex();
+
+    m_rootGroup->forEachEntryRecursive([](const Entry* entry) {
+        entry->caseFoldedFields();
+        for (const auto& url : entry->parsedUrls()) {
+            url.baseDomain();
+        }
+        entry->attributes()->attributesSize();
+    });
+}
+
+void Database::finishBackgroundSave()
+{
+    // Also called for a save that was superseded by a newer one
+    if (!m_backgroundSave || !m_backgroundSave->future.isFinished()) {
+        return;
+    }
+
+    auto save = m_backgroundSave;
+    m_backgroundSave.reset();
+
+    const bool ok = save->future.result();
+    m_xmlEntryCacheTimer.start();
+    m_saveTimings = save->snapshot->m_saveTimings;
+    m_counters.setEntryCacheLookups(save->snapshot->m_counters.entryCacheLookups());
+    if (ok) {
+        qDebug("Saved %s in the background (%s)", qPrintable(save->filePath), qPrintable(m_saveTimings.toString()));
+        // Keep the header the file was written with, unless the key was changed meanwhile
+        const Database* snapshot = save->snapshot.data();
+        if (m_data.key == save->key && m_data.kdf == save->kdf) {
+            m_data.formatVersion = snapshot->m_data.formatVersion;
+            m_data.kdf = snapshot->m_data.kdf;
+            m_data.transformedDatabaseKey->setRawKey(snapshot->m_data.transformedDatabaseKey->rawKey());
+            m_data.challengeResponseKey->setRawKey(snapshot->m_data.challengeResponseKey->rawKey());
+        }
+
+        if (save->isNewFile) {
+            QFile::setPermissions(save->filePath, QFile::ReadUser | QFile::WriteUser);
+        }
+
+#ifdef Q_OS_WIN
+        if (save->isHidden) {
+            SetFileAttributes(save->filePath.toStdString().c_str(), FILE_ATTRIBUTE_HIDDEN);
+        }
+#endif
+
+        // Changes made while saving are still to be saved
+        if (m_contentRevision == save->revision) {
+            markAsClean();
+        }
+        m_fileWatcher->start(save->filePath, 30, 1);
+    }
+
+    emit backgroundSaveFinished(ok, save->error);
+}
+
 bool Database::performSave(const QString& filePath, SaveAction action, const QString& backupFilePath, QString* error)
 {
+    TRACE_SCOPE("Database::save");
+    m_saveTimings.start();
     if (!backupFilePath.isNull()) {
-        backupDatabase(filePath, backupFilePath);
+        backupDatabase(filePath, backupFilePath, action);
+        m_saveTimings.lap("backup");
     }
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
@@ -323,12 +944,32 @@ bool Database::performSave(const QString& filePath, SaveAction action, const QSt
     auto createTime = info.exists() ? info.birthTime() : QDateTime::currentDateTime();
 #endif
 
+    // Writes to network shares are staged in memory and uploaded in one block
+    const bool onNetworkFileSystem = NetworkFile::isOnNetworkFileSystem(filePath);
+    QBuffer stagedFile;
+    auto writeTo = [&](QIODevice* device) {
+        if (!onNetworkFileSystem) {
+            return writeDatabase(device, error);
+        }
+        stagedFile.open(QIODevice::WriteOnly);
+        if (!writeDatabase(&stagedFile, error)) {
+            return false;
+        }
+        if (device->write(stagedFile.data()) != stagedFile.size()) {
+            if (error) {
+                *error = device->errorString();
+            }
+            return false;
+        }
+        return true;
+    };
+
     switch (action) {
     case Atomic: {
         QSaveFile saveFile(filePath);
         if (saveFile.open(QIODevice::WriteOnly)) {
             // write the database to the file
-            if (!writeDatabase(&saveFile, error)) {
+            if (!writeTo(&saveFile)) {
                 return false;
             }
 
@@ -339,6 +980,10 @@ bool Database::performSave(const QString& filePath, SaveAction action, const QSt
 
             if (saveFile.commit()) {
                 // successfully saved database file
+                if (onNetworkFileSystem) {
+                    NetworkFile::updateCache(filePath, stagedFile.data());
+                }
+                m_saveTimings.lap("commit");
                 return true;
             }
         }
@@ -372,6 +1017,7 @@ bool Database::performSave(const QString& filePath, SaveAction action, const QSt
                 // Retain original creation time
                 tempFile.setFileTime(createTime, QFile::FileBirthTime);
 #endif
+                m_saveTimings.lap("commit");
                 return true;
             } else if (backupFilePath.isEmpty() || !restoreDatabase(filePath, backupFilePath)) {
                 // Failed to copy new database in place, and
@@ -393,10 +1039,14 @@ bool Database::performSave(const QString& filePath, SaveAction action, const QSt
         // Open the original database file for direct-write
         QFile dbFile(filePath);
         if (dbFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            if (!writeDatabase(&dbFile, error)) {
+            if (!writeTo(&dbFile)) {
                 return false;
             }
             dbFile.close();
+            if (onNetworkFileSystem) {
+                NetworkFile::updateCache(filePath, stagedFile.data());
+            }
+            m_saveTimings.lap("commit");
             return true;
         }
         if (error) {
@@ -421,6 +1071,7 @@ bool Database::writeDatabase(QIODevice* device, QString* error)
     setEmitModified(false);
     writer.writeDatabase(device, this);
     setEmitModified(true);
+    m_saveTimings.append(writer.timings());
 
     if (writer.hasError()) {
         if (error) {
@@ -442,10 +1093,10 @@ bool Database::writeDatabase(QIODevice* device, QString* error)
     return true;
 }
 
-bool Database::extract(QByteArray& xmlOutput, QString* error)
+bool Database::extract(QIODevice* device, QString* error)
 {
     KeePass2Writer writer;
-    writer.extractDatabase(this, xmlOutput);
+    writer.extractDatabase(this, device);
     if (writer.hasError()) {
         if (error) {
             *error = writer.errorString();
@@ -456,13 +1107,49 @@ bool Database::extract(QByteArray& xmlOutput, QString* error)
     return true;
 }
 
-bool Database::import(const QString& xmlExportPath, QString* error)
+bool Database::extract(QByteArray& xmlOutput, QString* error)
+{
+    KeePass2Writer writer;
+    writer.extractDatabase(this, xmlOutput);
+    if (writer.hasError()) {
+        if (error) {
+            *error = writer.errorString();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Import a KeePass 2 XML export into this database.
+ *
+ * All imported groups and entries are added in one batch update.
+ *
+ * @param xmlExportPath XML export file
+ * @param error error message in case of failure
+ * @param progress called with the number of bytes read so far
+ * @return true on success
+ */
+bool Database::import(const QString& xmlExportPath,
+                      QString* error,
+                      const std::function<void(qint64 done, qint64 total)>& progress)
 {
-    KdbxXmlReader reader(KeePass2::FILE_VERSION_4);
     QFile file(xmlExportPath);
-    file.open(QIODevice::ReadOnly);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
 
-    reader.readDatabase(&file, this);
+    KdbxXmlReader reader(KeePass2::FILE_VERSION_4);
+    reader.setProgressCallback(progress);
+
+    {
+        BatchUpdate batchUpdate(this);
+        reader.readDatabase(&file, this);
+    }
 
     if (reader.hasError()) {
         if (error) {
@@ -475,16 +1162,25 @@ bool Database::import(const QString& xmlExportPath, QString* error)
 }
 
 /**
- * Release all stored group, entry, and meta data of this database.
+ * Release all stored group, entry, and meta data of this database,
+ * e.g. when it is locked.
  *
  * Call this method to ensure all data is cleared even if valid
  * pointers to this Database object are still being held.
- *
  * A previously reparented root group will not be freed.
+ *
+ * The group tree is detached from the database and all observers at once
+ * rather than unindexed entry by entry while it is deleted.
+ *
+ * @param inBackground delete the detached tree on a worker thread
  */
-
-void Database::releaseData()
+void Database::releaseData(bool inBackground)
 {
+    // A background save only writes its own snapshot, its result no longer applies
+    m_backgroundSave.reset();
+    dropXmlEntryCache();
+    m_counters.clear();
+
     // Prevent data release while saving
     Q_ASSERT(!isSaving());
     QMutexLocker locker(&m_saveMutex);
@@ -496,19 +1192,47 @@ void Database::releaseData()
     setEmitModified(false);
     m_modified = false;
 
-    s_uuidMap.remove(m_uuid);
+    {
+        QMutexLocker uuidMapLocker(&s_uuidMapMutex);
+        s_uuidMap.remove(m_uuid);
+    }
     m_uuid = QUuid();
 
     m_data.clear();
     m_metadata->clear();
 
+    Group* oldGroup = m_rootGroup;
+    if (oldGroup) {
+        oldGroup->detachRecursive();
+    }
+    m_entryIndex.clear();
+    m_groupIndex.clear();
+    m_referenceIndex.clear();
+    m_entryReferences.clear();
+    m_entryStatistics.clear();
+    m_tagCounts.clear();
+    m_usernameCounts.clear();
+
     // Reset and delete the root group
-    auto oldGroup = setRootGroup(new Group());
-    delete oldGroup;
+    setRootGroup(new Group());
+    if (oldGroup && inBackground) {
+        // Nothing refers to the tree anymore, free it off this thread
+        oldGroup->QObject::setParent(nullptr);
+        oldGroup->moveToThread(nullptr);
+        AsyncTask::run(
+            [oldGroup] {
+                oldGroup->moveToThread(QThread::currentThread());
+                delete oldGroup;
+            },
+            AsyncTask::Priority::Background);
+    } else {
+        delete oldGroup;
+    }
 
     m_fileWatcher->stop();
 
     m_deletedObjects.clear();
+    m_deletedObjectCounts.clear();
     m_commonUsernames.clear();
     m_tagList.clear();
 }
@@ -521,7 +1245,7 @@ void Database::releaseData()
  * @param destinationFilePath Path to the backup destination file
  * @return true on success
  */
-bool Database::backupDatabase(const QString& filePath, const QString& destinationFilePath)
+bool Database::backupDatabase(const QString& filePath, const QString& destinationFilePath, SaveAction action)
 {
     // Ensure that the path to write to actually exists
     auto parentDirectory = QFileInfo(destinationFilePath).absoluteDir();
@@ -530,8 +1254,28 @@ bool Database::backupDatabase(const QString& filePath, const QString& destinatio
             return false;
         }
     }
+
+    // Keep older backups by shifting them one generation back
+    if (m_backupGenerations > 1 && QFile::exists(destinationFilePath)) {
+        QFile::remove(backupGenerationPath(destinationFilePath, m_backupGenerations - 1));
+        for (int generation = m_backupGenerations - 2; generation > 0; --generation) {
+            QFile::rename(backupGenerationPath(destinationFilePath, generation),
+                          backupGenerationPath(destinationFilePath, generation + 1));
+        }
+        QFile::rename(destinationFilePath, backupGenerationPath(destinationFilePath, 1));
+    }
+
     auto perms = QFile::permissions(filePath);
     QFile::remove(destinationFilePath);
+    if (cloneFile(filePath, destinationFilePath)) {
+        QFile::setPermissions(destinationFilePath, perms);
+        return true;
+    }
+    // Atomic and temp file saves replace the file instead of writing to it,
+    // a hard link then keeps the old content without copying it
+    if (action != DirectWrite && linkFile(filePath, destinationFilePath)) {
+        return true;
+    }
     bool res = QFile::copy(filePath, destinationFilePath);
     QFile::setPermissions(destinationFilePath, perms);
     return res;
@@ -594,7 +1338,23 @@ Group* Database::setRootGroup(Group* group)
 
     auto oldRoot = m_rootGroup;
     m_rootGroup = group;
+    // The entries of the new root are added as they get attached
+    m_attachmentTextIndex->clear();
     m_rootGroup->setParent(this);
+    m_statisticsStale = true;
+    m_searchIndexStale = true;
+    m_searchIndex.clear();
+    m_urlIndexStale = true;
+    m_urlIndex.clear();
+    m_passkeyIndexStale = true;
+    m_passkeyIndex.clear();
+    m_passwordIndexStale = true;
+    m_passwordIndex.clear();
+    m_sshKeyEntriesStale = true;
+    m_pathIndexStale = true;
+    m_sshKeyEntries.clear();
+    ++m_contentRevision;
+    resetEntryChanges();
 
     // Initialize the root group if not done already
     if (m_rootGroup->uuid().isNull()) {
@@ -663,22 +1423,12 @@ const QList<DeletedObject>& Database::deletedObjects() const
 
 bool Database::containsDeletedObject(const QUuid& uuid) const
 {
-    for (const DeletedObject& currentObject : m_deletedObjects) {
-        if (currentObject.uuid == uuid) {
-            return true;
-        }
-    }
-    return false;
+    return m_deletedObjectCounts.contains(uuid);
 }
 
 bool Database::containsDeletedObject(const DeletedObject& object) const
 {
-    for (const DeletedObject& currentObject : m_deletedObjects) {
-        if (currentObject.uuid == object.uuid) {
-            return true;
-        }
-    }
-    return false;
+    return m_deletedObjectCounts.contains(object.uuid);
 }
 
 void Database::setDeletedObjects(const QList<DeletedObject>& delObjs)
@@ -687,12 +1437,71 @@ void Database::setDeletedObjects(const QList<DeletedObject>& delObjs)
         return;
     }
     m_deletedObjects = delObjs;
+
+    m_deletedObjectCounts.clear();
+    m_deletedObjectCounts.reserve(m_deletedObjects.size());
+    for (const auto& object : asConst(m_deletedObjects)) {
+        ++m_deletedObjectCounts[object.uuid];
+    }
+}
+
+/**
+ * Forget all but the first @p count deleted objects, e.g. to remove an item
+ * without a trace right after deleting it.
+ */
+void Database::truncateDeletedObjects(int count)
+{
+    if (count < m_deletedObjects.size()) {
+        for (auto it = m_deletedObjects.cbegin() + count; it != m_deletedObjects.cend(); ++it) {
+            forgetDeletedObject(it->uuid);
+        }
+        m_deletedObjects.erase(m_deletedObjects.begin() + count, m_deletedObjects.end());
+    }
+}
+
+/**
+ * Forget the deleted objects that were deleted before the given time.
+ *
+ * Other copies of the database that still contain such an object will
+ * bring it back when merged, so only compact tombstones that are older
+ * than any copy that may still be merged.
+ *
+ * @param deletedBefore deletion time in UTC
+ * @return number of forgotten deleted objects
+ */
+int Database::compactDeletedObjects(const QDateTime& deletedBefore)
+{
+    QList<DeletedObject> kept;
+    kept.reserve(m_deletedObjects.size());
+    for (const auto& object : asConst(m_deletedObjects)) {
+        if (object.deletionTime < deletedBefore) {
+            forgetDeletedObject(object.uuid);
+        } else {
+            kept.append(object);
+        }
+    }
+
+    const int removed = m_deletedObjects.size() - kept.size();
+    if (removed > 0) {
+        m_deletedObjects = kept;
+        markAsModified();
+    }
+    return removed;
+}
+
+void Database::forgetDeletedObject(const QUuid& uuid)
+{
+    auto it = m_deletedObjectCounts.find(uuid);
+    if (it != m_deletedObjectCounts.end() && --it.value() <= 0) {
+        m_deletedObjectCounts.erase(it);
+    }
 }
 
 void Database::addDeletedObject(const DeletedObject& delObj)
 {
     Q_ASSERT(delObj.deletionTime.timeSpec() == Qt::UTC);
     m_deletedObjects.append(delObj);
+    ++m_deletedObjectCounts[delObj.uuid];
 }
 
 void Database::addDeletedObject(const QUuid& uuid)
@@ -716,32 +1525,556 @@ const QStringList& Database::tagList() const
 
 void Database::updateCommonUsernames(int topN)
 {
+    ensureStatistics();
+    if (!m_commonUsernamesDirty && topN == m_commonUsernamesTopN) {
+        return;
+    }
+    m_commonUsernamesDirty = false;
+    m_commonUsernamesTopN = topN;
+
+    // Sort username/frequency pairs by frequency and name
+    QList<QPair<QString, int>> sortedUsernames;
+    sortedUsernames.reserve(m_usernameCounts.size());
+    for (auto it = m_usernameCounts.cbegin(); it != m_usernameCounts.cend(); ++it) {
+        sortedUsernames.append({it.key(), it.value()});
+    }
+
+    auto comparator = [](const QPair<QString, int>& arg1, const QPair<QString, int>& arg2) {
+        if (arg1.second == arg2.second) {
+            return arg1.first < arg2.first;
+        }
+        return arg1.second > arg2.second;
+    };
+
+    // Take first topN usernames if set
+    int actualUsernames = topN < 0 ? sortedUsernames.size() : std::min(topN, sortedUsernames.size());
+    std::partial_sort(
+        sortedUsernames.begin(), sortedUsernames.begin() + actualUsernames, sortedUsernames.end(), comparator);
+
     m_commonUsernames.clear();
-    m_commonUsernames.append(rootGroup()->usernamesRecursive(topN));
+    for (int i = 0; i < actualUsernames; ++i) {
+        m_commonUsernames.append(sortedUsernames[i].first);
+    }
 }
 
 void Database::updateTagList()
 {
-    m_tagList.clear();
-    if (!m_rootGroup) {
-        emit tagListUpdated();
+    ensureStatistics();
+    if (!m_tagListDirty) {
+        return;
+    }
+    m_tagListDirty = false;
+
+    m_tagList = m_tagCounts.keys();
+    m_tagList.sort();
+    emit tagListUpdated();
+}
+
+/**
+ * Update the tag and username counts contributed by an entry.
+ * Called whenever an entry is added to the tree or its tags, username or location change.
+ */
+void Database::updateEntryStatistics(Entry* entry)
+{
+    updateEntryPasswordIndex(entry);
+
+    // A full rebuild is pending, no need to track single entries
+    if (m_statisticsStale) {
+        return;
+    }
+
+    removeEntryStatistics(entry);
+
+    // Only count entries of the current tree, an old root group may still linger around
+    const Group* group = entry->group();
+    while (group && group->parentGroup()) {
+        group = group->parentGroup();
+    }
+    if (!group || group != m_rootGroup) {
+        return;
+    }
+
+    EntryStatistics stats;
+    if (!entry->isRecycled()) {
+        stats.tags = entry->tagList();
+    }
+    const QString username = entry->username();
+    if (!username.isEmpty() && !entry->isAttributeReference(EntryAttributes::UserNameKey)) {
+        stats.username = username;
+    }
+
+    if (stats.tags.isEmpty() && stats.username.isEmpty()) {
+        return;
+    }
+
+    for (const auto& tag : asConst(stats.tags)) {
+        if (++m_tagCounts[tag] == 1) {
+            m_tagListDirty = true;
+        }
+    }
+    if (!stats.username.isEmpty()) {
+        ++m_usernameCounts[stats.username];
+        m_commonUsernamesDirty = true;
+    }
+
+    m_entryStatistics.insert(entry, stats);
+}
+
+void Database::removeEntryStatistics(const Entry* entry)
+{
+    auto it = m_entryStatistics.find(entry);
+    if (it == m_entryStatistics.end()) {
         return;
     }
 
-    // Search groups recursively looking for tags
-    // Use a set to prevent adding duplicates
-    QSet<QString> tagSet;
-    for (auto entry : m_rootGroup->entriesRecursive()) {
-        if (!entry->isRecycled()) {
-            for (auto tag : entry->tagList()) {
-                tagSet.insert(tag);
+    for (const auto& tag : asConst(it->tags)) {
+        auto count = m_tagCounts.find(tag);
+        if (count != m_tagCounts.end() && --count.value() <= 0) {
+            m_tagCounts.erase(count);
+            m_tagListDirty = true;
+        }
+    }
+    if (!it->username.isEmpty()) {
+        auto count = m_usernameCounts.find(it->username);
+        if (count != m_usernameCounts.end() && --count.value() <= 0) {
+            m_usernameCounts.erase(count);
+        }
+        m_commonUsernamesDirty = true;
+    }
+
+    m_entryStatistics.erase(it);
+}
+
+/**
+ * Rebuild the tag and username counts from scratch if the root group
+ * or the recycle bin changed since they were last computed.
+ */
+void Database::ensureStatistics()
+{
+    if (!m_statisticsStale && m_metadata->recycleBin() == m_statisticsRecycleBin) {
+        return;
+    }
+
+    m_entryStatistics.clear();
+    m_tagCounts.clear();
+    m_usernameCounts.clear();
+    m_statisticsRecycleBin = m_metadata->recycleBin();
+    m_statisticsStale = false;
+    m_tagListDirty = true;
+    m_commonUsernamesDirty = true;
+
+    if (m_rootGroup) {
+        m_rootGroup->forEachEntryRecursive([this](Entry* entry) { updateEntryStatistics(entry); });
+    }
+}
+
+/**
+ * Search index over all entries below the root group. It is built on first
+ * use and kept up to date as entries are added, changed or removed.
+ */
+const EntrySearchIndex& Database::searchIndex() const
+{
+    if (m_searchIndexStale) {
+        m_searchIndexStale = false;
+        m_searchIndex.clear();
+        if (m_rootGroup) {
+            m_rootGroup->forEachEntryRecursive([this](const Entry* entry) { m_searchIndex.addEntry(entry); });
+        }
+    }
+    return m_searchIndex;
+}
+
+/**
+ * Domain index over the URLs of all entries below the root group. It is built
+ * on first use and kept up to date as entries are added, changed or removed.
+ */
+const EntryUrlIndex& Database::urlIndex() const
+{
+    if (m_urlIndexStale) {
+        m_urlIndexStale = false;
+        m_urlIndex.clear();
+        if (m_rootGroup) {
+            m_rootGroup->forEachEntryRecursive([this](const Entry* entry) { m_urlIndex.addEntry(entry); });
+        }
+    }
+    return m_urlIndex;
+}
+
+/**
+ * Index of the passkey entries below the root group by relying party and
+ * credential ID. It is built on first use and kept up to date like urlIndex().
+ */
+const EntryPasskeyIndex& Database::passkeyIndex() const
+{
+    if (m_passkeyIndexStale) {
+        m_passkeyIndexStale = false;
+        m_passkeyIndex.clear();
+        if (m_rootGroup) {
+            m_rootGroup->forEachEntryRecursive([this](const Entry* entry) { m_passkeyIndex.addEntry(entry); });
+        }
+    }
+    return m_passkeyIndex;
+}
+
+/**
+ * Index of the passwords of the entries outside the recycle bin. It is built
+ * on first use and kept up to date like urlIndex(), and rebuilt when another
+ * group becomes the recycle bin.
+ */
+const EntryPasswordIndex& Database::passwordIndex() const
+{
+    if (m_passwordIndexStale || m_passwordIndexRecycleBin != m_metadata->recycleBin()) {
+        m_passwordIndexStale = false;
+        m_passwordIndexRecycleBin = m_metadata->recycleBin();
+        m_passwordIndex.clear();
+        if (m_rootGroup) {
+            m_rootGroup->forEachEntryRecursive([this](const Entry* entry) { m_passwordIndex.addEntry(entry); });
+        }
+    }
+    return m_passwordIndex;
+}
+
+/**
+ * Entries below the root group with a KeeAgent.settings attachment, i.e. the
+ * ones that may hold an SSH key for the agent. Built on first use and kept up
+ * to date like urlIndex().
+ */
+const QSet<const Entry*>& Database::sshKeyEntries() const
+{
+    if (m_sshKeyEntriesStale) {
+        m_sshKeyEntriesStale = false;
+        m_sshKeyEntries.clear();
+        if (m_rootGroup) {
+            m_rootGroup->forEachEntryRecursive([this](const Entry* entry) {
+                if (entry->attachments()->hasKey(KeeAgentSettingsAttachment)) {
+                    m_sshKeyEntries.insert(entry);
+                }
+            });
+        }
+    }
+    return m_sshKeyEntries;
+}
+
+void Database::ensurePathIndex() const
+{
+    if (!m_pathIndexStale) {
+        return;
+    }
+    m_pathIndexStale = false;
+    m_entryPathIndex.clear();
+    m_entryTitleIndex.clear();
+    m_groupPathIndex.clear();
+    if (m_rootGroup) {
+        addToPathIndex(m_rootGroup, QStringLiteral("/"));
+    }
+}
+
+void Database::addToPathIndex(Group* group, const QString& path) const
+{
+    m_groupPathIndex[path].append(group);
+    for (Entry* entry : group->entries()) {
+        m_entryPathIndex[path + entry->title()].append(entry);
+        m_entryTitleIndex[entry->title()].append(entry);
+    }
+    for (Group* child : group->children()) {
+        addToPathIndex(child, path + child->name() + "/");
+    }
+}
+
+/**
+ * Path lookup of Group::findEntryByPath() through the path index.
+ *
+ * @param entryPath normalized path relative to base, or a title without slashes
+ * @param base group of this database to search below
+ * @return the first match in depth first order
+ */
+Entry* Database::findEntryByPath(const QString& entryPath, const Group* base) const
+{
+    ensurePathIndex();
+
+    const bool isPath = entryPath.startsWith("/");
+    const auto& index = isPath ? m_entryPathIndex : m_entryTitleIndex;
+    const auto it = index.constFind(isPath ? groupPathOf(base) + entryPath.mid(1) : entryPath);
+    if (it != index.constEnd()) {
+        // Groups with the same name as a parent of base can contain matches too
+        for (Entry* entry : it.value()) {
+            if (isBelow(entry->group(), base)) {
+                return entry;
             }
         }
     }
+    return nullptr;
+}
 
-    m_tagList = tagSet.toList();
-    m_tagList.sort();
-    emit tagListUpdated();
+/**
+ * Path lookup of Group::findGroupByPath() through the path index.
+ *
+ * @param groupPath normalized path relative to base, starting and ending with a slash
+ * @param base group of this database to search below
+ * @return the first match in depth first order
+ */
+Group* Database::findGroupByPath(const QString& groupPath, const Group* base) const
+{
+    ensurePathIndex();
+
+    const auto it = m_groupPathIndex.constFind(groupPathOf(base) + groupPath.mid(1));
+    if (it != m_groupPathIndex.constEnd()) {
+        for (Group* group : it.value()) {
+            if (isBelow(group, base)) {
+                return group;
+            }
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Serialized entries of the last save, reused by the next one for unchanged entries.
+ */
+KdbxXmlEntryCache* Database::xmlEntryCache() const
+{
+    return m_xmlEntryCache.data();
+}
+
+/**
+ * Replace the cache of serialized entries by an empty one. The plain text
+ * fragments are overwritten once a running background save is done with them.
+ */
+void Database::dropXmlEntryCache()
+{
+    // A synchronous save writes to the cache on a worker thread meanwhile
+    if (m_saveMutex.tryLock()) {
+        m_xmlEntryCache = QSharedPointer<KdbxXmlEntryCache>::create();
+        m_saveMutex.unlock();
+    }
+    m_xmlEntryCacheTimer.stop();
+}
+
+AttachmentTextIndex* Database::attachmentTextIndex()
+{
+    return m_attachmentTextIndex;
+}
+
+const AttachmentTextIndex* Database::attachmentTextIndex() const
+{
+    return m_attachmentTextIndex;
+}
+
+/**
+ * Revision of the database content, it changes whenever entries or groups
+ * are added, removed or modified. Allows to tell whether results computed
+ * from the database earlier are still valid.
+ */
+quint64 Database::contentRevision() const
+{
+    return m_contentRevision;
+}
+
+/**
+ * Revision of the custom data of all groups, it changes whenever the custom
+ * data of a group changes or a group is moved to a different parent.
+ */
+quint64 Database::groupCustomDataRevision() const
+{
+    return m_groupCustomDataRevision;
+}
+
+/**
+ * Position in the log of changed entries, to be passed to
+ * changedEntriesSince() later on.
+ */
+quint64 Database::entryChangeCursor() const
+{
+    return m_entryChangesBase + m_entryChanges.size();
+}
+
+/**
+ * Collect the entries that were added, removed or modified after the cursor
+ * was taken. Removed entries may no longer exist and must not be dereferenced.
+ *
+ * @param cursor value of entryChangeCursor() at the time to compare against
+ * @param entries receives the changed entries
+ * @return false if the changes are unknown and all entries have to be checked again
+ */
+bool Database::changedEntriesSince(quint64 cursor, QSet<const Entry*>& entries) const
+{
+    if (cursor < m_entryChangesBase || cursor > entryChangeCursor()) {
+        return false;
+    }
+    for (int i = static_cast<int>(cursor - m_entryChangesBase); i < m_entryChanges.size(); ++i) {
+        entries.insert(m_entryChanges[i]);
+    }
+    return true;
+}
+
+/**
+ * Estimate the heap memory held by the lookup indexes of the database.
+ * Indexes that were not built yet take no memory.
+ */
+qint64 Database::indexMemoryUsage() const
+{
+    qint64 size = MemoryUsage::heapSize(m_entryIndex) + MemoryUsage::heapSize(m_groupIndex)
+                  + MemoryUsage::heapSize(m_referenceIndex) + MemoryUsage::heapSize(m_entryReferences)
+                  + MemoryUsage::heapSize(m_deletedObjectCounts);
+    size += m_searchIndex.memoryUsage() + m_urlIndex.memoryUsage() + m_passkeyIndex.memoryUsage()
+            + m_passwordIndex.memoryUsage();
+    size += MemoryUsage::heapSize(m_sshKeyEntries) + MemoryUsage::heapSize(m_entryPathIndex)
+            + MemoryUsage::heapSize(m_entryTitleIndex) + MemoryUsage::heapSize(m_groupPathIndex);
+    return size;
+}
+
+/**
+ * Estimate the heap memory held by the caches of the database: the entry
+ * cache of the last save, the attachment text index, the tag and username
+ * statistics and the log of entry changes.
+ */
+qint64 Database::cacheMemoryUsage() const
+{
+    qint64 size = 0;
+    if (m_xmlEntryCache) {
+        const auto& fragments = m_xmlEntryCache->fragments;
+        size += fragments.capacity() * qint64(sizeof(void*))
+                + fragments.size()
+                      * (MemoryUsage::NodeOverhead + qint64(sizeof(QUuid) + sizeof(KdbxXmlEntryCache::Fragment)));
+        for (const auto& fragment : fragments) {
+            size += MemoryUsage::heapSize(fragment.key) + MemoryUsage::heapSize(fragment.pieces);
+        }
+    }
+    if (m_attachmentTextIndex) {
+        size += m_attachmentTextIndex->memoryUsage();
+    }
+
+    size += m_entryStatistics.capacity() * qint64(sizeof(void*))
+            + m_entryStatistics.size() * (MemoryUsage::NodeOverhead + qint64(sizeof(void*) + sizeof(EntryStatistics)));
+    for (const auto& statistics : m_entryStatistics) {
+        size += MemoryUsage::heapSize(statistics.tags) + MemoryUsage::heapSize(statistics.username);
+    }
+    size += MemoryUsage::heapSize(m_tagCounts) + MemoryUsage::heapSize(m_usernameCounts)
+            + MemoryUsage::heapSize(m_tagList) + MemoryUsage::heapSize(m_commonUsernames)
+            + MemoryUsage::heapSize(m_entryChanges);
+    return size;
+}
+
+void Database::recordEntryChange(const Entry* entry)
+{
+    static const int MaxEntryChanges = 4096;
+
+    // Setters emit one change each, only keep the first of a series
+    if (!m_entryChanges.isEmpty() && m_entryChanges.last() == entry) {
+        return;
+    }
+    if (m_entryChanges.size() >= MaxEntryChanges) {
+        resetEntryChanges();
+    }
+    m_entryChanges.append(entry);
+}
+
+/**
+ * Forget the logged entry changes, any cursor taken before is no longer valid.
+ */
+void Database::resetEntryChanges()
+{
+    m_entryChangesBase += m_entryChanges.size() + 1;
+    m_entryChanges.clear();
+}
+
+void Database::updateEntrySearchIndex(Entry* entry)
+{
+    ++m_contentRevision;
+    // The title may have changed
+    m_pathIndexStale = true;
+
+    // Not built yet, the first search will pick the entry up
+    if (m_searchIndexStale) {
+        return;
+    }
+
+    const Group* group = entry->group();
+    while (group && group->parentGroup()) {
+        group = group->parentGroup();
+    }
+    if (!group || group != m_rootGroup) {
+        m_searchIndex.removeEntry(entry);
+        return;
+    }
+
+    m_searchIndex.addEntry(entry);
+}
+
+void Database::updateEntryUrlIndex(Entry* entry)
+{
+    // Not built yet, the first lookup will pick the entry up
+    if (m_urlIndexStale) {
+        return;
+    }
+
+    const Group* group = entry->group();
+    while (group && group->parentGroup()) {
+        group = group->parentGroup();
+    }
+    if (!group || group != m_rootGroup) {
+        m_urlIndex.removeEntry(entry);
+        return;
+    }
+
+    m_urlIndex.addEntry(entry);
+}
+
+void Database::updateEntryPasswordIndex(Entry* entry)
+{
+    // Not built yet, the first lookup will pick the entry up
+    if (m_passwordIndexStale) {
+        return;
+    }
+
+    const Group* group = entry->group();
+    while (group && group->parentGroup()) {
+        group = group->parentGroup();
+    }
+    if (!group || group != m_rootGroup) {
+        m_passwordIndex.removeEntry(entry);
+        return;
+    }
+
+    m_passwordIndex.addEntry(entry);
+}
+
+void Database::updateEntryPasskeyIndex(Entry* entry)
+{
+    // Not built yet, the first lookup will pick the entry up
+    if (m_passkeyIndexStale) {
+        return;
+    }
+
+    const Group* group = entry->group();
+    while (group && group->parentGroup()) {
+        group = group->parentGroup();
+    }
+    if (!group || group != m_rootGroup) {
+        m_passkeyIndex.removeEntry(entry);
+        return;
+    }
+
+    m_passkeyIndex.addEntry(entry);
+}
+
+void Database::updateEntrySshKeyIndex(Entry* entry)
+{
+    // Not built yet, the first lookup will pick the entry up
+    if (m_sshKeyEntriesStale) {
+        return;
+    }
+
+    const Group* group = entry->group();
+    while (group && group->parentGroup()) {
+        group = group->parentGroup();
+    }
+    if (!group || group != m_rootGroup || !entry->attachments()->hasKey(KeeAgentSettingsAttachment)) {
+        m_sshKeyEntries.remove(entry);
+        return;
+    }
+
+    m_sshKeyEntries.insert(entry);
 }
 
 void Database::removeTag(const QString& tag)
@@ -750,9 +2083,8 @@ void Database::removeTag(const QString& tag)
         return;
     }
 
-    for (auto entry : m_rootGroup->entriesRecursive()) {
-        entry->removeTag(tag);
-    }
+    BatchUpdate batch(this);
+    m_rootGroup->forEachEntryRecursive([&](Entry* entry) { entry->removeTag(tag); });
 }
 
 const QUuid& Database::cipher() const
@@ -770,6 +2102,35 @@ QByteArray Database::transformedDatabaseKey() const
     return m_data.transformedDatabaseKey->rawKey();
 }
 
+/**
+ * Reuse the transformed key of other if this database is opened with the same
+ * key and KDF parameters, e.g. when its file is reloaded. The key derivation
+ * is then skipped. Only the next open() can reuse the key.
+ *
+ * @param other database to take the transformed key from, nullptr to reuse none
+ */
+void Database::reuseTransformedKey(const Database* other)
+{
+    m_reusableKey.reset();
+    m_reusableKdf.reset();
+    m_reusableTransformedKey.setRawKey({});
+    if (!other || !other->m_data.key || !other->m_data.kdf) {
+        return;
+    }
+
+    m_reusableKey = other->m_data.key;
+    m_reusableKdf = other->m_data.kdf->clone();
+    m_reusableTransformedKey.setRawKey(other->m_data.transformedDatabaseKey->rawKey());
+}
+
+bool Database::canReuseTransformedKey(const QSharedPointer<const CompositeKey>& key) const
+{
+    // The KDF parameters include the seed
+    return m_reusableKey && m_reusableKey == key && m_reusableKdf && m_data.kdf
+           && !m_reusableTransformedKey.rawKey().isEmpty() && m_reusableKdf->uuid() == m_data.kdf->uuid()
+           && m_reusableKdf->writeParameters() == m_data.kdf->writeParameters();
+}
+
 QByteArray Database::challengeResponseKey() const
 {
     return m_data.challengeResponseKey->rawKey();
@@ -807,6 +2168,50 @@ void Database::setCompressionAlgorithm(Database::CompressionAlgorithm algo)
     m_data.compressionAlgorithm = algo;
 }
 
+int Database::compressionLevel() const
+{
+    return m_data.compressionLevel;
+}
+
+/**
+ * Set the zlib level (0-9) used when compressing the database on save.
+ * Lower levels save faster at the cost of a slightly larger file.
+ * This is not stored in the database file.
+ */
+void Database::setCompressionLevel(int level)
+{
+    m_data.compressionLevel = qBound(0, level, 9);
+}
+
+/**
+ * Number of backups kept when saving with a backup file path, older ones
+ * get the generation appended to their name.
+ */
+int Database::backupGenerations() const
+{
+    return m_backupGenerations;
+}
+
+void Database::setBackupGenerations(int generations)
+{
+    m_backupGenerations = qMax(1, generations);
+}
+
+bool Database::lazyHistoryLoading() const
+{
+    return m_lazyHistoryLoading;
+}
+
+/**
+ * Keep the history items of the entries serialized when opening the database,
+ * they are loaded when they are first accessed. This is not stored in the
+ * database file.
+ */
+void Database::setLazyHistoryLoading(bool lazy)
+{
+    m_lazyHistoryLoading = lazy;
+}
+
 /**
  * Set and transform a new encryption key.
  *
@@ -843,6 +2248,8 @@ bool Database::setKey(const QSharedPointer<const CompositeKey>& key,
 
     if (!transformKey) {
         transformedDatabaseKey = QByteArray(oldTransformedDatabaseKey.rawKey());
+    } else if (canReuseTransformedKey(key)) {
+        transformedDatabaseKey = QByteArray(m_reusableTransformedKey.rawKey());
     } else if (!key->transform(*m_data.kdf, transformedDatabaseKey, &m_keyError)) {
         return false;
     }
@@ -895,6 +2302,81 @@ void Database::createRecycleBin()
     m_metadata->setRecycleBin(recycleBin);
 }
 
+void Database::indexEntry(Entry* entry)
+{
+    if (!entry->uuid().isNull()) {
+        m_entryIndex.insert(entry->uuid(), entry);
+    }
+    updateEntryReferences(entry);
+    updateEntryStatistics(entry);
+    updateEntrySearchIndex(entry);
+    updateEntryUrlIndex(entry);
+    updateEntryPasskeyIndex(entry);
+    updateEntrySshKeyIndex(entry);
+    m_attachmentTextIndex->updateEntry(entry);
+    recordEntryChange(entry);
+    invalidatePlaceholderCaches();
+}
+
+void Database::unindexEntry(Entry* entry)
+{
+    m_pathIndexStale = true;
+    m_entryIndex.remove(entry->uuid(), entry);
+    removeEntryReferences(entry);
+    removeEntryStatistics(entry);
+    m_searchIndex.removeEntry(entry);
+    m_urlIndex.removeEntry(entry);
+    m_passkeyIndex.removeEntry(entry);
+    m_passwordIndex.removeEntry(entry);
+    m_sshKeyEntries.remove(entry);
+    m_attachmentTextIndex->removeEntry(entry);
+    recordEntryChange(entry);
+    invalidatePlaceholderCaches();
+}
+
+void Database::indexGroup(Group* group)
+{
+    m_pathIndexStale = true;
+    if (!group->uuid().isNull()) {
+        m_groupIndex.insert(group->uuid(), group);
+    }
+}
+
+void Database::unindexGroup(Group* group)
+{
+    m_pathIndexStale = true;
+    m_groupIndex.remove(group->uuid(), group);
+}
+
+void Database::updateEntryReferences(Entry* entry)
+{
+    removeEntryReferences(entry);
+
+    const QSet<QUuid> references = entry->attributes()->referencedUuids();
+    if (references.isEmpty()) {
+        return;
+    }
+
+    for (const QUuid& uuid : references) {
+        m_referenceIndex.insert(uuid, entry);
+    }
+    m_entryReferences.insert(entry, references);
+}
+
+void Database::removeEntryReferences(Entry* entry)
+{
+    const QSet<QUuid> references = m_entryReferences.take(entry);
+    for (const QUuid& uuid : references) {
+        m_referenceIndex.remove(uuid, entry);
+    }
+}
+
+void Database::invalidatePlaceholderCaches()
+{
+    ++m_placeholderRevision;
+    ++m_contentRevision;
+}
+
 void Database::recycleEntry(Entry* entry)
 {
     if (m_metadata->recycleBinEnabled()) {
@@ -922,6 +2404,7 @@ void Database::recycleGroup(Group* group)
 void Database::emptyRecycleBin()
 {
     if (m_metadata->recycleBinEnabled() && m_metadata->recycleBin()) {
+        BatchUpdate batch(this);
         // destroying direct entries of the recycle bin
         QList<Entry*> subEntries = m_metadata->recycleBin()->entries();
         for (Entry* entry : subEntries) {
@@ -945,9 +2428,62 @@ bool Database::hasNonDataChanges() const
     return m_hasNonDataChange;
 }
 
+/**
+ * Start a batch update. Until the matching endBatchUpdate() the modified()
+ * signal is held back and views may skip per item updates in favor of one
+ * refresh when batchUpdateFinished() is emitted. Batches can be nested.
+ */
+void Database::beginBatchUpdate()
+{
+    if (m_batchDepth++ == 0) {
+        emit batchUpdateStarted();
+    }
+}
+
+void Database::endBatchUpdate()
+{
+    Q_ASSERT(m_batchDepth > 0);
+    if (m_batchDepth <= 0 || --m_batchDepth > 0) {
+        return;
+    }
+
+    emit batchUpdateFinished();
+
+    if (m_batchModified) {
+        m_batchModified = false;
+        markAsModified();
+    }
+}
+
+bool Database::isBatchUpdating() const
+{
+    return m_batchDepth > 0;
+}
+
+Database::BatchUpdate::BatchUpdate(Database* db)
+    : m_db(db)
+{
+    if (m_db) {
+        m_db->beginBatchUpdate();
+    }
+}
+
+Database::BatchUpdate::~BatchUpdate()
+{
+    if (m_db) {
+        m_db->endBatchUpdate();
+    }
+}
+
 void Database::markAsModified()
 {
     m_modified = true;
+    ++m_contentRevision;
+    if (m_batchDepth > 0) {
+        // Coalesced into a single signal at the end of the batch
+        m_batchModified = true;
+        return;
+    }
     if (modifiedSignalEnabled() && !m_modifiedTimer.isActive()) {
         // Small time delay prevents numerous consecutive saves due to repeated signals
         startModifiedTimer();
@@ -967,6 +2503,8 @@ void Database::markAsClean()
 
 void Database::markNonDataChange()
 {
+    // Entries may have been reordered
+    m_pathIndexStale = true;
     m_hasNonDataChange = true;
     emit databaseNonDataChanged();
 }
@@ -977,6 +2515,7 @@ void Database::markNonDataChange()
  */
 Database* Database::databaseByUuid(const QUuid& uuid)
 {
+    QMutexLocker locker(&s_uuidMapMutex);
     return s_uuidMap.value(uuid, nullptr);
 }
 
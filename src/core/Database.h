@@ -21,21 +21,33 @@
 
 #include <QDateTime>
 #include <QHash>
+#include <QMultiHash>
 #include <QMutex>
 #include <QPointer>
 #include <QTimer>
+#include <QVector>
+
+#include <functional>
 
 #include "config-keepassx.h"
+#include "core/EntrySearchIndex.h"
+#include "core/EntryPasskeyIndex.h"
+#include "core/EntryPasswordIndex.h"
+#include "core/EntryUrlIndex.h"
+#include "core/DatabaseCounters.h"
 #include "core/ModifiableObject.h"
+#include "core/StageTimings.h"
 #include "crypto/kdf/AesKdf.h"
 #include "format/KeePass2.h"
 #include "keys/CompositeKey.h"
 #include "keys/PasswordKey.h"
 
+class AttachmentTextIndex;
 class Entry;
 enum class EntryReferenceType;
 class FileWatcher;
 class Group;
+struct KdbxXmlEntryCache;
 class Metadata;
 class QIODevice;
 
@@ -62,6 +74,7 @@ public:
         CompressionGZip = 1
     };
     static const quint32 CompressionAlgorithmMax = CompressionGZip;
+    static const int DefaultCompressionLevel = 6;
 
     enum SaveAction
     {
@@ -70,13 +83,27 @@ public:
         DirectWrite, // Directly write to the destination file (dangerous)
     };
 
+    /**
+     * Groups the changes made during its lifetime into one batch update of the database.
+     */
+    class BatchUpdate
+    {
+    public:
+        explicit BatchUpdate(Database* db);
+        ~BatchUpdate();
+
+    private:
+        Q_DISABLE_COPY(BatchUpdate)
+        QPointer<Database> m_db;
+    };
+
     Database();
     explicit Database(const QString& filePath);
     ~Database() override;
 
 private:
     bool writeDatabase(QIODevice* device, QString* error = nullptr);
-    bool backupDatabase(const QString& filePath, const QString& destinationFilePath);
+    bool backupDatabase(const QString& filePath, const QString& destinationFilePath, SaveAction action);
     bool restoreDatabase(const QString& filePath, const QString& fromBackupFilePath);
     bool performSave(const QString& filePath, SaveAction flags, const QString& backupFilePath, QString* error);
 
@@ -88,19 +115,29 @@ public:
                 SaveAction action = Atomic,
                 const QString& backupFilePath = QString(),
                 QString* error = nullptr);
+    bool saveInBackground(SaveAction action = Atomic,
+                          const QString& backupFilePath = QString(),
+                          QString* error = nullptr);
     bool extract(QByteArray&, QString* error = nullptr);
-    bool import(const QString& xmlExportPath, QString* error = nullptr);
+    bool extract(QIODevice* device, QString* error = nullptr);
+    bool import(const QString& xmlExportPath,
+                QString* error = nullptr,
+                const std::function<void(qint64 done, qint64 total)>& progress = {});
+    bool reloadFrom(const Database* other);
 
     quint32 formatVersion() const;
     void setFormatVersion(quint32 version);
     bool hasMinorVersionMismatch() const;
 
-    void releaseData();
+    void releaseData(bool inBackground = false);
 
     bool isInitialized() const;
     bool isModified() const;
     bool hasNonDataChanges() const;
     bool isSaving();
+    const StageTimings& loadTimings() const;
+    const StageTimings& saveTimings() const;
+    DatabaseCounters& counters() const;
 
     QUuid publicUuid();
     QUuid uuid() const;
@@ -127,10 +164,31 @@ public:
     bool containsDeletedObject(const QUuid& uuid) const;
     bool containsDeletedObject(const DeletedObject& uuid) const;
     void setDeletedObjects(const QList<DeletedObject>& delObjs);
+    void truncateDeletedObjects(int count);
+    int compactDeletedObjects(const QDateTime& deletedBefore);
 
     const QStringList& commonUsernames() const;
     const QStringList& tagList() const;
     void removeTag(const QString& tag);
+    const EntrySearchIndex& searchIndex() const;
+    const EntryUrlIndex& urlIndex() const;
+    const EntryPasskeyIndex& passkeyIndex() const;
+    const EntryPasswordIndex& passwordIndex() const;
+    const QSet<const Entry*>& sshKeyEntries() const;
+    KdbxXmlEntryCache* xmlEntryCache() const;
+    AttachmentTextIndex* attachmentTextIndex();
+    const AttachmentTextIndex* attachmentTextIndex() const;
+    quint64 contentRevision() const;
+    QSharedPointer<const Database> readSnapshot() const;
+    quint64 groupCustomDataRevision() const;
+    quint64 entryChangeCursor() const;
+    bool changedEntriesSince(quint64 cursor, QSet<const Entry*>& entries) const;
+    qint64 indexMemoryUsage() const;
+    qint64 cacheMemoryUsage() const;
+
+    void beginBatchUpdate();
+    void endBatchUpdate();
+    bool isBatchUpdating() const;
 
     QSharedPointer<const CompositeKey> key() const;
     bool setKey(const QSharedPointer<const CompositeKey>& key,
@@ -144,11 +202,18 @@ public:
     void setCipher(const QUuid& cipher);
     Database::CompressionAlgorithm compressionAlgorithm() const;
     void setCompressionAlgorithm(Database::CompressionAlgorithm algo);
+    int compressionLevel() const;
+    void setCompressionLevel(int level);
+    int backupGenerations() const;
+    void setBackupGenerations(int generations);
+    bool lazyHistoryLoading() const;
+    void setLazyHistoryLoading(bool lazy);
 
     QSharedPointer<Kdf> kdf() const;
     void setKdf(QSharedPointer<Kdf> kdf);
     bool changeKdf(const QSharedPointer<Kdf>& kdf);
     QByteArray transformedDatabaseKey() const;
+    void reuseTransformedKey(const Database* other);
 
     static Database* databaseByUuid(const QUuid& uuid);
 
@@ -168,12 +233,20 @@ signals:
     void groupRemoved();
     void groupAboutToMove(Group* group, Group* toGroup, int index);
     void groupMoved();
+    void entryAboutToAdd(Entry* entry);
+    void entryAdded(Entry* entry);
+    void entryAboutToRemove(Entry* entry);
+    void entryRemoved(Entry* entry);
+    void entryDataChanged(Entry* entry);
     void databaseOpened();
     void databaseSaved();
+    void backgroundSaveFinished(bool ok, const QString& error);
     void databaseDiscarded();
     void databaseFileChanged();
     void databaseNonDataChanged();
     void tagListUpdated();
+    void batchUpdateStarted();
+    void batchUpdateFinished();
 
 private:
     struct DatabaseData
@@ -182,6 +255,7 @@ private:
         QString filePath;
         QUuid cipher = KeePass2::CIPHER_AES256;
         CompressionAlgorithm compressionAlgorithm = CompressionGZip;
+        int compressionLevel = DefaultCompressionLevel;
 
         QScopedPointer<PasswordKey> masterSeed;
         QScopedPointer<PasswordKey> transformedDatabaseKey;
@@ -217,25 +291,145 @@ private:
 
     void createRecycleBin();
 
+    void indexEntry(Entry* entry);
+    void unindexEntry(Entry* entry);
+    void indexGroup(Group* group);
+    void unindexGroup(Group* group);
+    void updateEntryReferences(Entry* entry);
+    void removeEntryReferences(Entry* entry);
+    void invalidatePlaceholderCaches();
+    void updateEntryStatistics(Entry* entry);
+    void removeEntryStatistics(const Entry* entry);
+    void ensureStatistics();
+    void updateEntrySearchIndex(Entry* entry);
+    void updateEntryUrlIndex(Entry* entry);
+    void updateEntryPasswordIndex(Entry* entry);
+    void updateEntryPasskeyIndex(Entry* entry);
+    void updateEntrySshKeyIndex(Entry* entry);
+    void recordEntryChange(const Entry* entry);
+    void resetEntryChanges();
+    void ensurePathIndex() const;
+    void addToPathIndex(Group* group, const QString& path) const;
+    Entry* findEntryByPath(const QString& entryPath, const Group* base) const;
+    Group* findGroupByPath(const QString& groupPath, const Group* base) const;
+
     void startModifiedTimer();
     void stopModifiedTimer();
+    void dropXmlEntryCache();
+
+    // Time after the last save until the cache of serialized entries is dropped
+    static constexpr int XmlEntryCacheIdleTimeout = 5 * 60 * 1000;
+
+    bool canReuseTransformedKey(const QSharedPointer<const CompositeKey>& key) const;
+    void copyMetadataFrom(const Database* other);
+
+    struct BackgroundSave;
+    bool canSave(const QString& filePath, QString* error);
+    void forgetDeletedObject(const QUuid& uuid);
+    Database* cloneContent() const;
+    Database* createSnapshot() const;
+    void prepareForReaders();
+    void finishBackgroundSave();
 
     QPointer<Metadata> const m_metadata;
     DatabaseData m_data;
     QPointer<Group> m_rootGroup;
     QList<DeletedObject> m_deletedObjects;
+    // Number of deleted objects per UUID, for lookups without scanning the list
+    QHash<QUuid, int> m_deletedObjectCounts;
     QTimer m_modifiedTimer;
     QMutex m_saveMutex;
+    QSharedPointer<BackgroundSave> m_backgroundSave;
+    bool m_supersedingBackgroundSave = false;
+    QSharedPointer<KdbxXmlEntryCache> m_xmlEntryCache;
+    // Drops the cache when no save needed it for a while
+    QTimer m_xmlEntryCacheTimer;
     QPointer<FileWatcher> m_fileWatcher;
+    QPointer<AttachmentTextIndex> const m_attachmentTextIndex;
+    int m_backupGenerations = 1;
+    bool m_lazyHistoryLoading = false;
+    StageTimings m_loadTimings;
+    StageTimings m_saveTimings;
+    mutable DatabaseCounters m_counters;
     bool m_modified = false;
     bool m_hasNonDataChange = false;
+    int m_batchDepth = 0;
+    bool m_batchModified = false;
     QString m_keyError;
 
+    // Transformed key of another database that setKey() may reuse, see reuseTransformedKey()
+    QSharedPointer<const CompositeKey> m_reusableKey;
+    QSharedPointer<Kdf> m_reusableKdf;
+    PasswordKey m_reusableTransformedKey;
+
+    struct EntryStatistics
+    {
+        QStringList tags;
+        QString username;
+    };
+
     QStringList m_commonUsernames;
     QStringList m_tagList;
+    // Reference counted tags and usernames of all entries below the root group,
+    // used to rebuild the lists above without walking the tree
+    QHash<const Entry*, EntryStatistics> m_entryStatistics;
+    QHash<QString, int> m_tagCounts;
+    QHash<QString, int> m_usernameCounts;
+    const Group* m_statisticsRecycleBin = nullptr;
+    int m_commonUsernamesTopN = 0;
+    bool m_statisticsStale = true;
+    bool m_tagListDirty = true;
+    bool m_commonUsernamesDirty = true;
+
+    // Lookup tables of all entries and groups attached to this database, maintained by Group
+    QMultiHash<QUuid, Entry*> m_entryIndex;
+    QMultiHash<QUuid, Group*> m_groupIndex;
+    // Reverse {REF:<Field>@I:<Uuid>} graph: referenced uuid -> referencing entries
+    QMultiHash<QUuid, Entry*> m_referenceIndex;
+    QHash<Entry*, QSet<QUuid>> m_entryReferences;
+    // Bumped whenever an entry changes in a way that may alter resolved {REF:} placeholders
+    quint64 m_placeholderRevision = 0;
+    // Bumped whenever custom data or the parent of a group changes, see Group::resolveCustomDataValue()
+    quint64 m_groupCustomDataRevision = 0;
+    // Bumped whenever a group is renamed or moved, see Group::hierarchy()
+    quint64 m_groupHierarchyRevision = 0;
+    // Trigram index of all entries below the root group, built on the first search
+    mutable EntrySearchIndex m_searchIndex;
+    mutable bool m_searchIndexStale = true;
+    // Domain index of all entries below the root group, built on the first lookup
+    mutable EntryUrlIndex m_urlIndex;
+    mutable bool m_urlIndexStale = true;
+    // Relying party and credential index of all passkey entries, built on the first lookup
+    mutable EntryPasskeyIndex m_passkeyIndex;
+    mutable bool m_passkeyIndexStale = true;
+    // Passwords of all entries outside the recycle bin, built on the first lookup
+    mutable EntryPasswordIndex m_passwordIndex;
+    mutable bool m_passwordIndexStale = true;
+    mutable const Group* m_passwordIndexRecycleBin = nullptr;
+    // Entries carrying KeeAgent settings, built on the first lookup
+    mutable QSet<const Entry*> m_sshKeyEntries;
+    mutable bool m_sshKeyEntriesStale = true;
+    // Entries and groups by their path from the root group and entries by title, in the order
+    // of a depth first search. Built on the first path lookup, dropped on any structural change.
+    mutable QHash<QString, QVector<Entry*>> m_entryPathIndex;
+    mutable QHash<QString, QVector<Entry*>> m_entryTitleIndex;
+    mutable QHash<QString, QVector<Group*>> m_groupPathIndex;
+    mutable bool m_pathIndexStale = true;
+    // Bumped on every change that may alter search results
+    quint64 m_contentRevision = 0;
+    // Shared by the readers of the current revision, see readSnapshot()
+    mutable QWeakPointer<const Database> m_readSnapshot;
+    mutable quint64 m_readSnapshotRevision = 0;
+    // Entries added, removed or modified since m_entryChangesBase, in order of change
+    QVector<const Entry*> m_entryChanges;
+    quint64 m_entryChangesBase = 0;
 
     QUuid m_uuid;
     static QHash<QUuid, QPointer<Database>> s_uuidMap;
+    static QMutex s_uuidMapMutex;
+
+    friend class Entry;
+    friend class Group;
 };
 
 #endif // KEEPASSX_DATABASE_H
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseCounters.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cmath>
+
+quint64 DatabaseCounters::CacheLookups::total() const
+{
+    return hits + misses;
+}
+
+double DatabaseCounters::CacheLookups::hitRate() const
+{
+    return total() > 0 ? double(hits) / total() : 0.0;
+}
+
+void DatabaseCounters::recordSearch(qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_recentSearches.size() < MaxRecentSearches) {
+        m_recentSearches.append(nsecs);
+    } else {
+        m_recentSearches[m_nextSearch] = nsecs;
+    }
+    m_nextSearch = (m_nextSearch + 1) % MaxRecentSearches;
+    ++m_searchCount;
+}
+
+void DatabaseCounters::recordSearchCacheLookup(bool hit)
+{
+    QMutexLocker locker(&m_mutex);
+    if (hit) {
+        ++m_searchCache.hits;
+    } else {
+        ++m_searchCache.misses;
+    }
+}
+
+void DatabaseCounters::setEntryCacheLookups(const CacheLookups& lookups)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entryCache = lookups;
+}
+
+void DatabaseCounters::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_recentSearches.clear();
+    m_nextSearch = 0;
+    m_searchCount = 0;
+    m_searchCache = {};
+    m_entryCache = {};
+}
+
+quint64 DatabaseCounters::searchCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_searchCount;
+}
+
+/**
+ * Durations of up to the last MaxRecentSearches searches in nanoseconds, in no particular order.
+ */
+QVector<qint64> DatabaseCounters::recentSearches() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_recentSearches;
+}
+
+DatabaseCounters::CacheLookups DatabaseCounters::searchCacheLookups() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_searchCache;
+}
+
+DatabaseCounters::CacheLookups DatabaseCounters::entryCacheLookups() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entryCache;
+}
+
+/**
+ * Nearest-rank percentile of values.
+ *
+ * @param percent percentile between 0 and 100
+ * @return the percentile, or -1 if there are no values
+ */
+qint64 DatabaseCounters::percentile(QVector<qint64> values, double percent)
+{
+    if (values.isEmpty()) {
+        return -1;
+    }
+    const int rank = qBound(1, int(std::ceil(percent / 100.0 * values.size())), values.size());
+    std::nth_element(values.begin(), values.begin() + rank - 1, values.end());
+    return values[rank - 1];
+}
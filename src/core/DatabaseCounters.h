@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASECOUNTERS_H
+#define KEEPASSXC_DATABASECOUNTERS_H
+
+#include <QMutex>
+#include <QVector>
+
+/**
+ * Performance counters of a database, updated while it is used.
+ *
+ * The durations of the most recent searches are kept to compute latency
+ * percentiles from. All functions can be called from any thread.
+ */
+class DatabaseCounters
+{
+public:
+    struct CacheLookups
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+
+        quint64 total() const;
+        double hitRate() const;
+    };
+
+    void recordSearch(qint64 nsecs);
+    void recordSearchCacheLookup(bool hit);
+    void setEntryCacheLookups(const CacheLookups& lookups);
+    void clear();
+
+    quint64 searchCount() const;
+    QVector<qint64> recentSearches() const;
+    CacheLookups searchCacheLookups() const;
+    CacheLookups entryCacheLookups() const;
+
+    static qint64 percentile(QVector<qint64> values, double percent);
+
+    static constexpr int MaxRecentSearches = 256;
+
+private:
+    mutable QMutex m_mutex;
+    // Ring buffer of search durations in nanoseconds
+    QVector<qint64> m_recentSearches;
+    int m_nextSearch = 0;
+    quint64 m_searchCount = 0;
+    CacheLookups m_searchCache;
+    // Entries of the last save that were copied from the entry cache
+    CacheLookups m_entryCache;
+};
+
+#endif // KEEPASSXC_DATABASECOUNTERS_H
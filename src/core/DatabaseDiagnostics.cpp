@@ -0,0 +1,126 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseDiagnostics.h"
+
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+#include "core/Tools.h"
+
+#include <QSet>
+
+DatabaseDiagnostics::DatabaseDiagnostics(const QSharedPointer<const Database>& db)
+{
+    // Data shared between entries and their history items is counted once
+    QSet<const void*> seen;
+    db->rootGroup()->forEachEntryRecursive([&](const Entry* entry) {
+        ++entryCount;
+        attributeBytes += entry->attributes()->memoryUsage(seen);
+        attachmentBytes += entry->attachments()->memoryUsage(seen);
+
+        historyCount += entry->historyCount();
+        if (const auto serialized = entry->serializedHistory()) {
+            serializedHistoryCount += serialized->count();
+            historyBytes += serialized->memoryUsage();
+            return;
+        }
+        for (const auto item : entry->historyItems()) {
+            historyBytes += item->attributes()->memoryUsage(seen);
+            attachmentBytes += item->attachments()->memoryUsage(seen);
+        }
+    });
+
+    const auto metadata = db->metadata();
+    for (const auto& uuid : metadata->customIconsOrder()) {
+        const auto& icon = metadata->customIcon(uuid);
+        iconBytes += icon.data.capacity() + icon.name.capacity() * qint64(sizeof(QChar));
+    }
+
+    indexBytes = db->indexMemoryUsage();
+    cacheBytes = db->cacheMemoryUsage();
+
+    const auto& counters = db->counters();
+    searchCount = counters.searchCount();
+    const auto searches = counters.recentSearches();
+    searchP50 = DatabaseCounters::percentile(searches, 50);
+    searchP90 = DatabaseCounters::percentile(searches, 90);
+    searchP99 = DatabaseCounters::percentile(searches, 99);
+    searchCache = counters.searchCacheLookups();
+    entryCache = counters.entryCacheLookups();
+
+    loadTimings = db->loadTimings();
+    saveTimings = db->saveTimings();
+}
+
+qint64 DatabaseDiagnostics::totalBytes() const
+{
+    return attributeBytes + attachmentBytes + historyBytes + iconBytes + indexBytes + cacheBytes;
+}
+
+/**
+ * The diagnostics as pairs of a name and a value, for display.
+ */
+QList<DatabaseDiagnostics::Row> DatabaseDiagnostics::rows() const
+{
+    const auto size = [](qint64 bytes) { return Tools::humanReadableFileSize(bytes); };
+    const auto timings = [](const StageTimings& stageTimings) {
+        if (stageTimings.isEmpty()) {
+            return tr("n/a");
+        }
+        return tr("%1 (%2)").arg(formatDuration(stageTimings.totalNsecs()), stageTimings.toString());
+    };
+
+    QList<Row> rows;
+    rows << Row(tr("Memory used"), size(totalBytes()));
+    rows << Row(tr("Memory used by attributes"), size(attributeBytes));
+    rows << Row(tr("Memory used by attachments"), size(attachmentBytes));
+    rows << Row(tr("Memory used by history"),
+                tr("%1 (%2 items, %3 not loaded)")
+                    .arg(size(historyBytes))
+                    .arg(historyCount)
+                    .arg(serializedHistoryCount));
+    rows << Row(tr("Memory used by icons"), size(iconBytes));
+    rows << Row(tr("Memory used by indexes"), size(indexBytes));
+    rows << Row(tr("Memory used by caches"), size(cacheBytes));
+    if (searchCount > 0) {
+        rows << Row(tr("Searches"), QString::number(searchCount));
+        rows << Row(tr("Search latency"),
+                    tr("p50 %1, p90 %2, p99 %3")
+                        .arg(formatDuration(searchP50), formatDuration(searchP90), formatDuration(searchP99)));
+    } else {
+        rows << Row(tr("Searches"), tr("none"));
+    }
+    rows << Row(tr("Saved search cache hit rate"), formatHitRate(searchCache));
+    rows << Row(tr("Entry cache hit rate of the last save"), formatHitRate(entryCache));
+    rows << Row(tr("Last unlock"), timings(loadTimings));
+    rows << Row(tr("Last save"), timings(saveTimings));
+    return rows;
+}
+
+QString DatabaseDiagnostics::formatDuration(qint64 nsecs)
+{
+    return tr("%1 ms").arg(nsecs / 1e6, 0, 'f', 2);
+}
+
+QString DatabaseDiagnostics::formatHitRate(const DatabaseCounters::CacheLookups& lookups)
+{
+    if (lookups.total() == 0) {
+        return tr("n/a");
+    }
+    return tr("%1% (%2 of %3)").arg(lookups.hitRate() * 100, 0, 'f', 1).arg(lookups.hits).arg(lookups.total());
+}
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASEDIAGNOSTICS_H
+#define KEEPASSXC_DATABASEDIAGNOSTICS_H
+
+#include "core/DatabaseCounters.h"
+#include "core/StageTimings.h"
+
+#include <QCoreApplication>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+
+class Database;
+
+/**
+ * Resource usage and performance counters of an open database.
+ *
+ * Memory sizes are estimates of the heap memory held by the database,
+ * implicitly shared data like attachments of history items is counted once.
+ * Must be created on the thread the database lives in.
+ */
+class DatabaseDiagnostics
+{
+    Q_DECLARE_TR_FUNCTIONS(DatabaseDiagnostics)
+
+public:
+    using Row = QPair<QString, QString>;
+
+    int entryCount = 0; // Number of entries, including the recycle bin
+    int historyCount = 0; // Number of history items, loaded or not
+    int serializedHistoryCount = 0; // Number of history items not loaded yet
+    qint64 attributeBytes = 0; // Attributes of the entries
+    qint64 attachmentBytes = 0; // Attachments of the entries and their loaded history items
+    qint64 historyBytes = 0; // Attributes of the loaded history items and serialized history items
+    qint64 iconBytes = 0; // Custom icons
+    qint64 indexBytes = 0; // Lookup and search indexes
+    qint64 cacheBytes = 0; // Save, statistics and attachment text caches
+
+    quint64 searchCount = 0; // Searches since the database was opened
+    qint64 searchP50 = -1; // Search latency percentiles of the recent searches in nanoseconds, -1 if none
+    qint64 searchP90 = -1;
+    qint64 searchP99 = -1;
+    DatabaseCounters::CacheLookups searchCache; // Saved searches brought up to date instead of searched again
+    DatabaseCounters::CacheLookups entryCache; // Entries of the last save copied from the entry cache
+
+    StageTimings loadTimings;
+    StageTimings saveTimings;
+
+    explicit DatabaseDiagnostics(const QSharedPointer<const Database>& db);
+
+    qint64 totalBytes() const;
+    QList<Row> rows() const;
+
+    static QString formatDuration(qint64 nsecs);
+    static QString formatHitRate(const DatabaseCounters::CacheLookups& lookups);
+};
+
+#endif // KEEPASSXC_DATABASEDIAGNOSTICS_H
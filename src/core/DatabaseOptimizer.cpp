@@ -0,0 +1,213 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseOptimizer.h"
+
+#include "core/Clock.h"
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+#include "core/Tools.h"
+
+bool DatabaseOptimizer::Result::isModified() const
+{
+    return removedHistoryItems > 0 || purgedIcons > 0 || removedDeletedObjects > 0;
+}
+
+/**
+ * Description of what was done, one line for each kind of change.
+ */
+QStringList DatabaseOptimizer::Result::changes() const
+{
+    QStringList changes;
+    if (removedHistoryItems > 0) {
+        changes << tr("Removed %n history item(s) beyond the history limits.", "", removedHistoryItems);
+    }
+    if (purgedIcons > 0) {
+        changes << tr("Purged %n unused custom icon(s).", "", purgedIcons);
+    }
+    if (sharedAttachments > 0) {
+        changes << tr("Deduplicated %n attachment(s) in memory, freeing %1.", "", sharedAttachments)
+                       .arg(Tools::humanReadableFileSize(sharedAttachmentBytes));
+    }
+    if (removedDeletedObjects > 0) {
+        changes << tr("Removed %n deleted object record(s).", "", removedDeletedObjects);
+    }
+    return changes;
+}
+
+DatabaseOptimizer::DatabaseOptimizer(Database* db)
+    : m_db(db)
+    , m_deletedObjectsMaxAge(db->metadata()->maintenanceHistoryDays())
+{
+}
+
+/**
+ * Set how many days records of deleted objects are kept. Defaults to the
+ * maintenance period of the database.
+ *
+ * Other copies of the database that still contain an object whose record
+ * was removed bring it back when they are merged, so the age should exceed
+ * the time between synchronizations of all copies.
+ *
+ * @param days age in days, -1 to keep all records
+ */
+void DatabaseOptimizer::setDeletedObjectsMaxAge(int days)
+{
+    m_deletedObjectsMaxAge = days;
+}
+
+DatabaseOptimizer::Result DatabaseOptimizer::optimize()
+{
+    Result result;
+    result.removedHistoryItems = applyHistoryLimits();
+    result.purgedIcons = purgeUnusedIcons();
+    result.sharedAttachments = shareAttachments(&result.sharedAttachmentBytes);
+    result.removedDeletedObjects = compactDeletedObjects();
+    return result;
+}
+
+/**
+ * Apply the maximum number of history items and history size of the
+ * database to all entries.
+ *
+ * @return number of removed history items
+ */
+int DatabaseOptimizer::applyHistoryLimits()
+{
+    const int maxItems = m_db->metadata()->historyMaxItems();
+    const bool limitSize = m_db->metadata()->historyMaxSize() > -1;
+
+    int removed = 0;
+    m_db->rootGroup()->forEachEntryRecursive([&](Entry* entry) {
+        // Checking the size requires the history items, their count does not
+        const int count = entry->historyCount();
+        if (count == 0 || (!limitSize && (maxItems < 0 || count <= maxItems))) {
+            return;
+        }
+        entry->truncateHistory();
+        removed += count - entry->historyCount();
+    });
+    return removed;
+}
+
+/**
+ * Remove the custom icons that no entry or group uses. Icons only used by
+ * history items are removed as well, the history items get the default icon.
+ *
+ * @return number of removed icons
+ */
+int DatabaseOptimizer::purgeUnusedIcons()
+{
+    Metadata* metadata = m_db->metadata();
+    if (metadata->customIconsOrder().isEmpty()) {
+        return 0;
+    }
+
+    QList<Entry*> historyEntries;
+    QSet<QUuid> historicIcons;
+    QSet<QUuid> iconsInUse;
+
+    const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(true);
+    for (Entry* entry : allEntries) {
+        if (!entry->group()) {
+            historyEntries << entry;
+            historicIcons << entry->iconUuid();
+        } else {
+            iconsInUse << entry->iconUuid();
+        }
+    }
+
+    const QList<Group*> allGroups = m_db->rootGroup()->groupsRecursive(true);
+    for (Group* group : allGroups) {
+        iconsInUse.insert(group->iconUuid());
+    }
+
+    int purged = 0;
+    const QList<QUuid> customIcons = metadata->customIconsOrder();
+    for (const QUuid& iconUuid : customIcons) {
+        if (iconsInUse.contains(iconUuid)) {
+            continue;
+        }
+
+        if (historicIcons.contains(iconUuid)) {
+            for (Entry* historicEntry : asConst(historyEntries)) {
+                if (historicEntry->iconUuid() != iconUuid) {
+                    continue;
+                }
+                historicEntry->setUpdateTimeinfo(false);
+                historicEntry->setIcon(0);
+                historicEntry->setUpdateTimeinfo(true);
+            }
+        }
+
+        ++purged;
+        metadata->removeCustomIcon(iconUuid);
+    }
+    return purged;
+}
+
+/**
+ * Let attachments with the same content share a single copy in memory.
+ * Files hold each distinct attachment once already, so this only reduces
+ * the memory used, mostly by history items whose attachments were read as
+ * separate copies.
+ *
+ * @param sharedBytes receives the size of the copies no longer held
+ * @return number of attachments that now share the data of another one
+ */
+int DatabaseOptimizer::shareAttachments(qint64* sharedBytes)
+{
+    QHash<QByteArray, QByteArray> attachments;
+    int shared = 0;
+    qint64 bytes = 0;
+
+    m_db->rootGroup()->forEachEntryRecursive(
+        [&](Entry* entry) {
+            EntryAttachments* entryAttachments = entry->attachments();
+            const QList<QString> keys = entryAttachments->keys();
+            for (const QString& key : keys) {
+                const QByteArray hash = entryAttachments->hash(key);
+                auto it = attachments.constFind(hash);
+                if (it == attachments.constEnd()) {
+                    attachments.insert(hash, entryAttachments->value(key));
+                } else if (entryAttachments->shareData(key, it.value())) {
+                    ++shared;
+                    bytes += it.value().size();
+                }
+            }
+        },
+        true);
+
+    if (sharedBytes) {
+        *sharedBytes = bytes;
+    }
+    return shared;
+}
+
+/**
+ * Remove the records of objects deleted longer ago than the maximum age.
+ *
+ * @return number of removed records
+ */
+int DatabaseOptimizer::compactDeletedObjects()
+{
+    if (m_deletedObjectsMaxAge < 0) {
+        return 0;
+    }
+    return m_db->compactDeletedObjects(Clock::currentDateTimeUtc().addDays(-m_deletedObjectsMaxAge));
+}
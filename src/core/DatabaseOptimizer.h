@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASEOPTIMIZER_H
+#define KEEPASSXC_DATABASEOPTIMIZER_H
+
+#include <QCoreApplication>
+#include <QStringList>
+
+class Database;
+
+/**
+ * Removes what a long-lived database collects over time and slows down
+ * opening and saving it: history items beyond the configured limits,
+ * custom icons nobody uses, copies of the same attachment held in memory
+ * several times and old deleted object records.
+ *
+ * History limits are otherwise only applied when an entry is edited.
+ */
+class DatabaseOptimizer
+{
+    Q_DECLARE_TR_FUNCTIONS(DatabaseOptimizer)
+
+public:
+    struct Result
+    {
+        int removedHistoryItems = 0;
+        int purgedIcons = 0;
+        int sharedAttachments = 0; // Attachments that now share the data of an equal one
+        qint64 sharedAttachmentBytes = 0; // Memory no longer held by copies of attachments
+        int removedDeletedObjects = 0;
+
+        bool isModified() const;
+        QStringList changes() const;
+    };
+
+    explicit DatabaseOptimizer(Database* db);
+
+    void setDeletedObjectsMaxAge(int days);
+    Result optimize();
+
+    int applyHistoryLimits();
+    int purgeUnusedIcons();
+    int shareAttachments(qint64* sharedBytes = nullptr);
+    int compactDeletedObjects();
+
+private:
+    Database* const m_db;
+    int m_deletedObjectsMaxAge;
+};
+
+#endif // KEEPASSXC_DATABASEOPTIMIZER_H
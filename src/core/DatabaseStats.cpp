@@ -16,12 +16,19 @@
  */
 #include "DatabaseStats.h"
 
+#include "core/Clock.h"
+
+#include <algorithm>
+
+const QVector<int> DatabaseStats::PasswordLengthBounds = {8, 12, 16, 20, 32};
+const QVector<int> DatabaseStats::PasswordAgeBounds = {30, 90, 180, 365, 730};
+
 // Ctor does all the work
 DatabaseStats::DatabaseStats(QSharedPointer<Database> db)
     : modified(QFileInfo(db->filePath()).lastModified())
     , m_db(db)
 {
-    gatherStats(db->rootGroup()->groupsRecursive(true));
+    gatherStats();
 }
 
 // Get average password length
@@ -35,11 +42,7 @@ int DatabaseStats::averagePwdLength() const
 // share the same password)
 int DatabaseStats::maxPwdReuse() const
 {
-    int ret = 0;
-    for (const auto& count : m_passwords) {
-        ret = std::max(ret, count);
-    }
-    return ret;
+    return m_db->passwordIndex().maxReuse();
 }
 
 // A warning sign is displayed if one of the
@@ -64,56 +67,119 @@ bool DatabaseStats::isAvgPwdTooShort() const
     return averagePwdLength() < 10;
 }
 
-void DatabaseStats::gatherStats(const QList<Group*>& groups)
+// Password counts come from the password index of the database,
+// which is kept up to date as entries change
+void DatabaseStats::gatherStats()
 {
-    auto checker = HealthChecker(m_db);
-
-    for (const auto* group : groups) {
+    m_db->rootGroup()->forEachGroupRecursive([this](const Group* group) {
         // Don't count anything in the recycle bin
-        if (group->isRecycled()) {
-            continue;
+        if (!group->isRecycled()) {
+            ++groupCount;
         }
+    });
+
+    const auto& index = m_db->passwordIndex();
+    uniquePasswords = index.distinctPasswords();
+    reusedPasswords = index.passwordCount() - uniquePasswords;
+    shortPasswords = index.shortPasswords();
+    totalPasswordLength = index.totalPasswordLength();
+
+    reuseClusters = index.reuseClusters();
+
+    const Columns columns = extractColumns();
+    entryCount = columns.entryFlags.size();
+    for (const quint8 flags : columns.entryFlags) {
+        expiredEntries += (flags & Expired) ? 1 : 0;
+        excludedEntries += (flags & Excluded) ? 1 : 0;
+        weakPasswords += (flags & WeakPassword) ? 1 : 0;
+    }
+    passwordLengthHistogram = histogram(columns.passwordLengths, PasswordLengthBounds);
+    passwordAgeHistogram = histogram(columns.passwordAges, PasswordAgeBounds);
+}
 
-        ++groupCount;
+DatabaseStats::Columns DatabaseStats::extractColumns() const
+{
+    Columns columns;
+    const auto entries = m_db->passwordIndex().entries();
+    columns.entryFlags.reserve(entries.size());
+    columns.passwordLengths.reserve(entries.size());
+    columns.passwordAges.reserve(entries.size());
 
-        for (const auto* entry : group->entries()) {
-            // Don't count anything in the recycle bin
-            if (entry->isRecycled()) {
-                continue;
-            }
+    auto checker = HealthChecker(m_db);
+    const QDateTime now = Clock::currentDateTimeUtc();
 
-            ++entryCount;
+    for (const auto* entry : entries) {
+        quint8 flags = 0;
+        if (entry->isExpired()) {
+            flags |= Expired;
+        }
 
-            if (entry->isExpired()) {
-                ++expiredEntries;
+        const auto pwd = entry->password();
+        if (!pwd.isEmpty()) {
+            flags |= HasPassword;
+            // Speed up Zxcvbn process by excluding very long passwords and most passphrases
+            if (pwd.size() < PasswordHealth::Length::Long && checker.quality(entry) <= PasswordHealth::Quality::Weak) {
+                flags |= WeakPassword;
             }
-
-            // Get password statistics
-            const auto pwd = entry->password();
-            if (!pwd.isEmpty()) {
-                if (!m_passwords.contains(pwd)) {
-                    ++uniquePasswords;
-                } else {
-                    ++reusedPasswords;
-                }
-
-                if (pwd.size() < PasswordHealth::Length::Short) {
-                    ++shortPasswords;
-                }
-
-                // Speed up Zxcvbn process by excluding very long passwords and most passphrases
-                if (pwd.size() < PasswordHealth::Length::Long
-                    && checker.evaluate(entry)->quality() <= PasswordHealth::Quality::Weak) {
-                    ++weakPasswords;
-                }
-
-                if (entry->excludeFromReports()) {
-                    ++excludedEntries;
-                }
-
-                totalPasswordLength += pwd.size();
-                m_passwords[pwd]++;
+            if (entry->excludeFromReports()) {
+                flags |= Excluded;
             }
+            columns.passwordLengths.append(pwd.size());
+            columns.passwordAges.append(static_cast<int>(entry->timeInfo().lastModificationTime().daysTo(now)));
         }
+
+        columns.entryFlags.append(flags);
+    }
+
+    return columns;
+}
+
+/**
+ * Count the values falling into each bucket. Bucket i holds the values
+ * up to bounds[i] and above the previous bound, the last bucket holds
+ * the values above all bounds.
+ */
+QVector<int> DatabaseStats::histogram(const QVector<int>& values, const QVector<int>& bounds)
+{
+    QVector<int> counts(bounds.size() + 1, 0);
+    for (const int value : values) {
+        ++counts[std::lower_bound(bounds.cbegin(), bounds.cend(), value) - bounds.cbegin()];
+    }
+    return counts;
+}
+
+/**
+ * @return the histogram as "<= 8: 1, 9-12: 4, ..., > 32: 0"
+ */
+QString DatabaseStats::formatHistogram(const QVector<int>& counts, const QVector<int>& bounds)
+{
+    Q_ASSERT(counts.size() == bounds.size() + 1);
+
+    QStringList parts;
+    for (int i = 0; i < counts.size(); ++i) {
+        if (i == 0) {
+            parts << QString("<= %1: %2").arg(bounds.first()).arg(counts[i]);
+        } else if (i == bounds.size()) {
+            parts << QString("> %1: %2").arg(bounds.last()).arg(counts[i]);
+        } else {
+            parts << QString("%1-%2: %3").arg(bounds[i - 1] + 1).arg(bounds[i]).arg(counts[i]);
+        }
+    }
+    return parts.join(", ");
+}
+
+/**
+ * @return the reuse clusters as "shared by 2: 3, shared by 5: 1"
+ */
+QString DatabaseStats::formatReuseClusters(const QMap<int, int>& clusters)
+{
+    if (clusters.isEmpty()) {
+        return QObject::tr("none");
+    }
+
+    QStringList parts;
+    for (auto it = clusters.cbegin(); it != clusters.cend(); ++it) {
+        parts << QObject::tr("shared by %1: %2").arg(it.key()).arg(it.value());
     }
+    return parts.join(", ");
 }
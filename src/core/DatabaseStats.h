@@ -20,6 +20,8 @@
 #include "PasswordHealth.h"
 #include "core/Group.h"
 #include <QFileInfo>
+#include <QMap>
+#include <QVector>
 #include <cmath>
 class DatabaseStats
 {
@@ -35,9 +37,20 @@ public:
     int uniquePasswords = 0; // Number of unique passwords
     int reusedPasswords = 0; // Number of non-unique passwords
     int totalPasswordLength = 0; // Total length of all passwords
+    QVector<int> passwordLengthHistogram; // Passwords by length, see PasswordLengthBounds
+    QVector<int> passwordAgeHistogram; // Passwords by days since their entry was modified, see PasswordAgeBounds
+    QMap<int, int> reuseClusters; // Number of passwords shared by the same number of entries, by that number
+
+    // Upper bounds of all but the last histogram bucket
+    static const QVector<int> PasswordLengthBounds;
+    static const QVector<int> PasswordAgeBounds;
 
     explicit DatabaseStats(QSharedPointer<Database> db);
 
+    static QVector<int> histogram(const QVector<int>& values, const QVector<int>& bounds);
+    static QString formatHistogram(const QVector<int>& counts, const QVector<int>& bounds);
+    static QString formatReuseClusters(const QMap<int, int>& clusters);
+
     int averagePwdLength() const;
 
     int maxPwdReuse() const;
@@ -51,9 +64,25 @@ public:
     bool isAvgPwdTooShort() const;
 
 private:
+    enum EntryFlag : quint8
+    {
+        HasPassword = 1 << 0,
+        Expired = 1 << 1,
+        Excluded = 1 << 2,
+        WeakPassword = 1 << 3
+    };
+
+    // Fields of the entries outside the recycle bin, extracted in a single pass
+    struct Columns
+    {
+        QVector<quint8> entryFlags; // One per entry
+        QVector<int> passwordLengths; // One per entry with a password
+        QVector<int> passwordAges; // One per entry with a password, in days
+    };
+
     QSharedPointer<Database> m_db;
-    QHash<QString, int> m_passwords;
 
-    void gatherStats(const QList<Group*>& groups);
+    Columns extractColumns() const;
+    void gatherStats();
 };
 #endif // KEEPASSXC_DATABASESTATS_H
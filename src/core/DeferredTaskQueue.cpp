@@ -0,0 +1,82 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DeferredTaskQueue.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+DeferredTaskQueue::DeferredTaskQueue(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(0);
+    connect(&m_timer, &QTimer::timeout, this, &DeferredTaskQueue::runNext);
+}
+
+/**
+ * Queue a task behind all tasks of the same or higher priority.
+ *
+ * @param priority order relative to the other queued tasks
+ * @param name name used in the debug timings
+ * @param task work to run
+ */
+void DeferredTaskQueue::schedule(Priority priority, const QString& name, std::function<void()> task)
+{
+    auto it = m_tasks.begin();
+    while (it != m_tasks.end() && it->priority <= priority) {
+        ++it;
+    }
+    m_tasks.insert(it, {priority, name, std::move(task)});
+    m_timer.start();
+}
+
+bool DeferredTaskQueue::isEmpty() const
+{
+    return m_tasks.isEmpty();
+}
+
+/**
+ * Drop all queued tasks, e.g. when the database they belong to is locked.
+ */
+void DeferredTaskQueue::clear()
+{
+    m_tasks.clear();
+    m_timer.stop();
+}
+
+void DeferredTaskQueue::runNext()
+{
+    if (m_tasks.isEmpty()) {
+        return;
+    }
+
+    const Task task = m_tasks.takeFirst();
+    // Tasks scheduled while running are picked up on the next iteration
+    if (!m_tasks.isEmpty()) {
+        m_timer.start();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    task.run();
+    qDebug("Deferred task %s took %lld ms", qPrintable(task.name), timer.elapsed());
+
+    if (m_tasks.isEmpty()) {
+        emit finished();
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DEFERREDTASKQUEUE_H
+#define KEEPASSXC_DEFERREDTASKQUEUE_H
+
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+#include <functional>
+
+/**
+ * Runs work that is not needed for the first paint on the event loop.
+ *
+ * Tasks run one per event loop iteration, higher priority first and in
+ * scheduling order within the same priority, so the UI stays responsive
+ * in between.
+ */
+class DeferredTaskQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority
+    {
+        High,
+        Normal,
+        Low
+    };
+
+    explicit DeferredTaskQueue(QObject* parent = nullptr);
+
+    void schedule(Priority priority, const QString& name, std::function<void()> task);
+    bool isEmpty() const;
+
+public slots:
+    void clear();
+
+signals:
+    void finished();
+
+private slots:
+    void runNext();
+
+private:
+    struct Task
+    {
+        Priority priority;
+        QString name;
+        std::function<void()> run;
+    };
+
+    QList<Task> m_tasks;
+    QTimer m_timer;
+};
+
+#endif // KEEPASSXC_DEFERREDTASKQUEUE_H
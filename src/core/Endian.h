@@ -35,6 +35,17 @@ namespace Endian
         return qFromBigEndian<SizedQInt>(reinterpret_cast<const uchar*>(ba.constData()));
     }
 
+    /**
+     * Convert the bytes at data, the caller checks that enough of them are left.
+     */
+    template <typename SizedQInt> SizedQInt bytesToSizedInt(const char* data, QSysInfo::Endian byteOrder)
+    {
+        if (byteOrder == QSysInfo::LittleEndian) {
+            return qFromLittleEndian<SizedQInt>(reinterpret_cast<const uchar*>(data));
+        }
+        return qFromBigEndian<SizedQInt>(reinterpret_cast<const uchar*>(data));
+    }
+
     template <typename SizedQInt> SizedQInt readSizedInt(QIODevice* device, QSysInfo::Endian byteOrder, bool* ok)
     {
         QByteArray ba = device->read(sizeof(SizedQInt));
@@ -18,6 +18,7 @@
 
 #include "Entry.h"
 
+#include "core/AttachmentTextIndex.h"
 #include "core/Config.h"
 #include "core/Database.h"
 #include "core/Group.h"
@@ -25,13 +26,44 @@
 #include "core/PasswordHealth.h"
 #include "core/Tools.h"
 #include "core/Totp.h"
+#include "core/UrlTools.h"
+#include "crypto/CryptoHash.h"
 
+#include <QDataStream>
 #include <QDir>
 #include <QRegularExpression>
+#include <QThread>
 #include <QUrl>
 
+#include <algorithm>
+
 const int Entry::DefaultIconNumber = 0;
 const int Entry::ResolveMaximumDepth = 10;
+
+namespace
+{
+    // Upper bound of memoized placeholder resolutions kept per entry
+    constexpr int MaxPlaceholderCacheSize = 32;
+
+    // Attribute holding the given field of a referenced entry, empty if there is none
+    QString referenceFieldKey(EntryReferenceType referenceType)
+    {
+        switch (referenceType) {
+        case EntryReferenceType::Title:
+            return EntryAttributes::TitleKey;
+        case EntryReferenceType::UserName:
+            return EntryAttributes::UserNameKey;
+        case EntryReferenceType::Password:
+            return EntryAttributes::PasswordKey;
+        case EntryReferenceType::Url:
+            return EntryAttributes::URLKey;
+        case EntryReferenceType::Notes:
+            return EntryAttributes::NotesKey;
+        default:
+            return {};
+        }
+    }
+} // namespace
 const QString Entry::AutoTypeSequenceUsername = "{USERNAME}{ENTER}";
 const QString Entry::AutoTypeSequencePassword = "{PASSWORD}{ENTER}";
 
@@ -51,12 +83,39 @@ Entry::Entry()
     connect(m_attributes, &EntryAttributes::modified, this, &Entry::updateTotp);
     connect(m_attributes, &EntryAttributes::modified, this, &Entry::modified);
     connect(m_attributes, &EntryAttributes::defaultKeyModified, this, &Entry::emitDataChanged);
+    connect(m_attributes, &EntryAttributes::defaultKeyModified, this, &Entry::updateReferences);
+    connect(m_attributes, &EntryAttributes::reset, this, &Entry::updateReferences);
+    connect(m_attributes, &EntryAttributes::defaultKeyModified, this, &Entry::updateStatistics);
+    connect(m_attributes, &EntryAttributes::reset, this, &Entry::updateStatistics);
+    connect(m_attributes, &EntryAttributes::defaultKeyModified, this, &Entry::updateSearchIndex);
+    connect(m_attributes, &EntryAttributes::reset, this, &Entry::updateSearchIndex);
+    connect(m_attributes, &EntryAttributes::defaultKeyModified, this, &Entry::updateUrlIndex);
+    connect(m_attributes, &EntryAttributes::customKeyModified, this, &Entry::updateUrlIndex);
+    connect(m_attributes, &EntryAttributes::added, this, &Entry::updateUrlIndex);
+    connect(m_attributes, &EntryAttributes::removed, this, &Entry::updateUrlIndex);
+    connect(m_attributes, &EntryAttributes::renamed, this, &Entry::updateUrlIndex);
+    connect(m_attributes, &EntryAttributes::reset, this, &Entry::updateUrlIndex);
+    connect(m_attributes, &EntryAttributes::customKeyModified, this, &Entry::updatePasskeyIndex);
+    connect(m_attributes, &EntryAttributes::added, this, &Entry::updatePasskeyIndex);
+    connect(m_attributes, &EntryAttributes::removed, this, &Entry::updatePasskeyIndex);
+    connect(m_attributes, &EntryAttributes::renamed, this, &Entry::updatePasskeyIndex);
+    connect(m_attributes, &EntryAttributes::reset, this, &Entry::updatePasskeyIndex);
+    connect(m_attributes, &EntryAttributes::defaultKeyModified, this, &Entry::invalidatePlaceholderCache);
+    connect(m_attributes, &EntryAttributes::customKeyModified, this, &Entry::invalidatePlaceholderCache);
+    connect(m_attributes, &EntryAttributes::added, this, &Entry::invalidatePlaceholderCache);
+    connect(m_attributes, &EntryAttributes::removed, this, &Entry::invalidatePlaceholderCache);
+    connect(m_attributes, &EntryAttributes::renamed, this, &Entry::invalidatePlaceholderCache);
+    connect(m_attributes, &EntryAttributes::reset, this, &Entry::invalidatePlaceholderCache);
     connect(m_attachments, &EntryAttachments::modified, this, &Entry::modified);
+    connect(m_attachments, &EntryAttachments::modified, this, &Entry::updateAttachmentTextIndex);
+    connect(m_attachments, &EntryAttachments::modified, this, &Entry::updateSshKeyIndex);
     connect(m_autoTypeAssociations, &AutoTypeAssociations::modified, this, &Entry::modified);
     connect(m_customData, &CustomData::modified, this, &Entry::modified);
 
+    connect(this, &Entry::modified, this, &Entry::invalidateFingerprint);
     connect(this, &Entry::modified, this, &Entry::updateTimeinfo);
     connect(this, &Entry::modified, this, &Entry::updateModifiedSinceBegin);
+    connect(this, &Entry::modified, this, &Entry::recordChange);
 }
 
 Entry::~Entry()
@@ -296,19 +355,6 @@ QList<QString> Entry::autoTypeSequences(const QString& windowTitle) const
     }
 
     // Define helper functions to match window titles
-    auto windowMatches = [&](const QString& pattern) {
-        // Regex searching
-        if (pattern.startsWith("//") && pattern.endsWith("//") && pattern.size() >= 4) {
-            QRegularExpression regExp(pattern.mid(2, pattern.size() - 4), QRegularExpression::CaseInsensitiveOption);
-            return regExp.match(windowTitle).hasMatch();
-        }
-
-        // Wildcard searching
-        const auto regExp = Tools::convertToRegex(
-            pattern, Tools::RegexConvertOpts::EXACT_MATCH | Tools::RegexConvertOpts::WILDCARD_UNLIMITED_MATCH);
-        return regExp.match(windowTitle).hasMatch();
-    };
-
     auto windowMatchesTitle = [&](const QString& entryTitle) {
         return !entryTitle.isEmpty() && windowTitle.contains(entryTitle, Qt::CaseInsensitive);
     };
@@ -331,8 +377,11 @@ QList<QString> Entry::autoTypeSequences(const QString& windowTitle) const
     // Add window association matches
     const auto assocList = autoTypeAssociations()->getAll();
     for (const auto& assoc : assocList) {
-        auto window = resolveMultiplePlaceholders(assoc.window);
-        if (!assoc.window.isEmpty() && windowMatches(window)) {
+        if (assoc.window.isEmpty()) {
+            continue;
+        }
+        const auto window = resolveMultiplePlaceholders(assoc.window);
+        if (AutoTypeAssociations::windowMatches(window, windowTitle)) {
             if (!assoc.sequence.isEmpty()) {
                 sequenceList << assoc.sequence;
             } else {
@@ -397,6 +446,85 @@ QStringList Entry::getAllUrls() const
     return urlList;
 }
 
+/**
+ * Parse an URL the way browser matching interprets entry URLs.
+ */
+Entry::ParsedUrl Entry::parseUrl(const QString& url)
+{
+    ParsedUrl parsed;
+    parsed.url = url;
+    if (url.isEmpty()) {
+        return parsed;
+    }
+
+    parsed.hasScheme = url.contains("://");
+    parsed.qurl = parsed.hasScheme ? QUrl(url) : QUrl::fromUserInput(url);
+    parsed.scheme = parsed.qurl.scheme();
+    parsed.host = parsed.qurl.host();
+    parsed.port = parsed.qurl.port();
+    parsed.path = parsed.qurl.path();
+    return parsed;
+}
+
+/**
+ * Base domain of the host, e.g. example.co.uk for another.example.co.uk.
+ * Without networking support this is the host itself.
+ */
+QString Entry::ParsedUrl::baseDomain() const
+{
+    if (!m_baseDomainValid) {
+#if defined(WITH_XC_NETWORKING) || defined(WITH_XC_BROWSER)
+        m_baseDomain = host.isEmpty() ? QString() : urlTools()->getBaseDomainFromUrl(host);
+#else
+        m_baseDomain = host;
+#endif
+        m_baseDomainValid = true;
+    }
+    return m_baseDomain;
+}
+
+/**
+ * All URLs of the entry as returned by getAllUrls(), parsed once and kept
+ * until the attributes change.
+ */
+const QVector<Entry::ParsedUrl>& Entry::parsedUrls() const
+{
+    // Resolved URLs are only refreshed on the thread owning the entry, see Database::readSnapshot()
+    if (m_parsedUrlsValid && (!m_parsedUrlsResolved || QThread::currentThread() != thread())) {
+        return m_parsedUrls;
+    }
+
+    const QStringList urls = getAllUrls();
+    if (m_parsedUrlsValid && urls.size() == m_parsedUrls.size()) {
+        bool unchanged = true;
+        for (int i = 0; i < urls.size() && unchanged; ++i) {
+            unchanged = urls.at(i) == m_parsedUrls.at(i).url;
+        }
+        if (unchanged) {
+            return m_parsedUrls;
+        }
+    }
+
+    m_parsedUrls.clear();
+    for (const auto& url : urls) {
+        m_parsedUrls.append(parseUrl(url));
+    }
+
+    // Resolved placeholders may change with other entries of the database
+    m_parsedUrlsResolved = url().contains(QLatin1Char('{'));
+    for (const auto& key : m_attributes->keys()) {
+        if (m_parsedUrlsResolved) {
+            break;
+        }
+        if (key.startsWith(EntryAttributes::AdditionalUrlAttribute)
+            || key == QString("%1_RELYING_PARTY").arg(EntryAttributes::PasskeyAttribute)) {
+            m_parsedUrlsResolved = m_attributes->value(key).contains(QLatin1Char('{'));
+        }
+    }
+    m_parsedUrlsValid = true;
+    return m_parsedUrls;
+}
+
 QString Entry::webUrl() const
 {
     QString url = resolveMultiplePlaceholders(m_attributes->value(EntryAttributes::URLKey));
@@ -429,18 +557,22 @@ QString Entry::attribute(const QString& key) const
     return m_attributes->value(key);
 }
 
+/**
+ * Approximate size of the entry data in bytes, used to enforce the history size limit.
+ * The attribute sizes are cached, so this is cheap to call repeatedly.
+ */
 int Entry::size() const
 {
     int size = 0;
-    const QRegularExpression delimiter(",|:|;");
 
     size += this->attributes()->attributesSize();
     size += this->autoTypeAssociations()->associationsSize();
     size += this->attachments()->attachmentsSize();
     size += this->customData()->dataSize();
-    const QStringList tags = this->tags().split(delimiter, QString::SkipEmptyParts);
-    for (const QString& tag : tags) {
-        size += tag.toUtf8().size();
+    // Tag separators do not count towards the size
+    for (const QString& tag : m_data.tags) {
+        size += tag.toUtf8().size() - tag.count(QLatin1Char(':')) - tag.count(QLatin1Char(';'))
+                - tag.count(QLatin1Char(','));
     }
 
     return size;
@@ -453,7 +585,7 @@ bool Entry::isExpired() const
 
 bool Entry::willExpireInDays(int days) const
 {
-    return m_data.timeInfo.expires() && m_data.timeInfo.expiryTime() < Clock::currentDateTime().addDays(days);
+    return m_data.timeInfo.isExpiredAt(Clock::currentDateTime().addDays(days));
 }
 
 bool Entry::isRecycled() const
@@ -551,16 +683,37 @@ bool Entry::hasPasskey() const
     return m_attributes->hasPasskey();
 }
 
+/**
+ * Generate the TOTP code for the current time. The code is generated once
+ * per time step and reused until the step or the settings change, so that
+ * views refreshing every second do not decode the key and compute an HMAC
+ * on every call.
+ */
 QString Entry::totp() const
 {
-    if (hasTotp()) {
-        return Totp::generateTotp(m_data.totpSettings);
+    if (!hasTotp()) {
+        return {};
     }
-    return {};
+
+    const quint64 time = static_cast<quint64>(Clock::currentSecondsSinceEpoch());
+    const quint64 counter = Totp::timeCounter(m_data.totpSettings, time);
+    if (m_totpCode.isNull() || m_totpCodeCounter != counter || m_totpCodeSettings != m_data.totpSettings) {
+        // The code is only kept on the thread owning the entry
+        if (QThread::currentThread() != thread()) {
+            return Totp::generateTotp(m_data.totpSettings, time);
+        }
+        m_totpCode = Totp::generateTotp(m_data.totpSettings, time);
+        m_totpCodeCounter = counter;
+        m_totpCodeSettings = m_data.totpSettings;
+    }
+    return m_totpCode;
 }
 
 void Entry::setTotp(QSharedPointer<Totp::Settings> settings)
 {
+    // The settings object may have been modified in place
+    m_totpCode.clear();
+
     beginUpdate();
     m_attributes->remove(Totp::ATTRIBUTE_OTP);
     m_attributes->remove(Totp::ATTRIBUTE_SEED);
@@ -584,6 +737,8 @@ void Entry::setTotp(QSharedPointer<Totp::Settings> settings)
 
 void Entry::updateTotp()
 {
+    m_totpCode.clear();
+
     if (m_attributes->contains(Totp::ATTRIBUTE_SETTINGS)) {
         m_data.totpSettings = Totp::parseSettings(m_attributes->value(Totp::ATTRIBUTE_SETTINGS),
                                                   m_attributes->value(Totp::ATTRIBUTE_SEED));
@@ -594,6 +749,85 @@ void Entry::updateTotp()
     }
 }
 
+void Entry::updateReferences()
+{
+    Database* db = database();
+    if (db) {
+        db->updateEntryReferences(this);
+    }
+}
+
+void Entry::updateStatistics()
+{
+    Database* db = database();
+    if (db) {
+        db->updateEntryStatistics(this);
+    }
+}
+
+void Entry::updateSearchIndex()
+{
+    m_caseFoldedValid = false;
+    Database* db = database();
+    if (db) {
+        db->updateEntrySearchIndex(this);
+    }
+}
+
+void Entry::updateUrlIndex()
+{
+    Database* db = database();
+    if (db) {
+        db->updateEntryUrlIndex(this);
+    }
+}
+
+void Entry::updatePasskeyIndex()
+{
+    Database* db = database();
+    if (db) {
+        db->updateEntryPasskeyIndex(this);
+    }
+}
+
+void Entry::updateSshKeyIndex()
+{
+    Database* db = database();
+    if (db) {
+        db->updateEntrySshKeyIndex(this);
+    }
+}
+
+void Entry::updateAttachmentTextIndex()
+{
+    Database* db = database();
+    if (db) {
+        db->attachmentTextIndex()->updateEntry(this);
+    }
+}
+
+void Entry::recordChange()
+{
+    Database* db = database();
+    if (db) {
+        db->recordEntryChange(this);
+    }
+}
+
+void Entry::invalidatePlaceholderCache()
+{
+    m_placeholderCache.clear();
+    // Also catches protection changes, which don't emit defaultKeyModified
+    m_caseFoldedValid = false;
+    m_parsedUrlsValid = false;
+
+    // Other entries may reference our attributes
+    Database* db = database();
+    if (db) {
+        db->invalidatePlaceholderCaches();
+    }
+}
+
 QSharedPointer<Totp::Settings> Entry::totpSettings() const
 {
     return m_data.totpSettings;
@@ -618,7 +852,18 @@ QString Entry::path() const
 void Entry::setUuid(const QUuid& uuid)
 {
     Q_ASSERT(!uuid.isNull());
+    if (m_uuid == uuid) {
+        return;
+    }
+
+    Database* db = database();
+    if (db) {
+        db->unindexEntry(this);
+    }
     set(m_uuid, uuid);
+    if (db) {
+        db->indexEntry(this);
+    }
 }
 
 void Entry::setIcon(int iconNumber)
@@ -675,7 +920,10 @@ void Entry::setTags(const QString& tags)
     taglist = tagSet.toList();
     // Sort alphabetically
     taglist.sort();
-    set(m_data.tags, taglist);
+    if (set(m_data.tags, taglist)) {
+        updateStatistics();
+        updateSearchIndex();
+    }
 }
 
 void Entry::addTag(const QString& tag)
@@ -688,6 +936,8 @@ void Entry::addTag(const QString& tag)
         taglist.append(cleanTag);
         taglist.sort();
         set(m_data.tags, taglist);
+        updateStatistics();
+        updateSearchIndex();
     }
 }
 
@@ -699,12 +949,15 @@ void Entry::removeTag(const QString& tag)
     auto taglist = m_data.tags;
     if (taglist.removeAll(tag) > 0) {
         set(m_data.tags, taglist);
+        updateStatistics();
+        updateSearchIndex();
     }
 }
 
 void Entry::setTimeInfo(const TimeInfo& timeInfo)
 {
     m_data.timeInfo = timeInfo;
+    invalidateFingerprint();
 }
 
 void Entry::setAutoTypeEnabled(bool enable)
@@ -784,19 +1037,91 @@ void Entry::setExpiryTime(const QDateTime& dateTime)
 
 QList<Entry*> Entry::historyItems()
 {
+    loadHistory();
     return m_history;
 }
 
 const QList<Entry*>& Entry::historyItems() const
 {
+    loadHistory();
     return m_history;
 }
 
+/**
+ * Number of history items, without loading serialized ones.
+ */
+int Entry::historyCount() const
+{
+    return m_serializedHistory ? m_serializedHistory->count() : m_history.size();
+}
+
+/**
+ * Replace the history items by serialized ones that are loaded when they are first accessed.
+ */
+void Entry::setSerializedHistory(QSharedPointer<const SerializedHistory> history)
+{
+    qDeleteAll(m_history);
+    m_history.clear();
+    m_serializedHistory = std::move(history);
+    invalidateFingerprint();
+}
+
+/**
+ * @return the history if it was not loaded yet, null otherwise
+ */
+QSharedPointer<const Entry::SerializedHistory> Entry::serializedHistory() const
+{
+    return m_serializedHistory;
+}
+
+/**
+ * Load serialized history items. The content of the entry does not change,
+ * so it is neither modified nor does its fingerprint change.
+ *
+ * The items are only loaded on the thread owning the entry, other threads may
+ * read it at the same time, see Database::readSnapshot(). Readers on other
+ * threads see the items loaded so far and historyCount().
+ */
+void Entry::loadHistory() const
+{
+    if (!m_serializedHistory || QThread::currentThread() != thread()) {
+        return;
+    }
+
+    const QSharedPointer<const SerializedHistory> history = m_serializedHistory;
+    m_serializedHistory.reset();
+    const QList<Entry*> items = history->load();
+    for (Entry* item : items) {
+        item->m_uuid = m_uuid;
+        shareDataWithHistoryItem(item);
+        m_history.append(item);
+    }
+}
+
+/**
+ * History items parsed from a file carry their own copies of unchanged values,
+ * share them with the closest snapshot so memory scales with what actually changed.
+ */
+void Entry::shareDataWithHistoryItem(Entry* entry) const
+{
+    const Entry* reference = m_history.isEmpty() ? this : m_history.last();
+    entry->m_attributes->shareDataFrom(reference->m_attributes);
+    entry->m_attachments->shareDataFrom(reference->m_attachments);
+    if (reference != this) {
+        entry->m_attributes->shareDataFrom(m_attributes);
+        entry->m_attachments->shareDataFrom(m_attachments);
+    }
+}
+
 void Entry::addHistoryItem(Entry* entry)
 {
     Q_ASSERT(!entry->parent());
 
+    loadHistory();
+    shareDataWithHistoryItem(entry);
     m_history.append(entry);
+    // The merger changes the history with blocked signals
+    invalidateFingerprint();
     emitModified();
 }
 
@@ -806,6 +1131,7 @@ void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
         return;
     }
 
+    loadHistory();
     for (Entry* entry : historyEntries) {
         Q_ASSERT(!entry->parent());
         Q_ASSERT(entry->uuid().isNull() || entry->uuid() == uuid());
@@ -815,6 +1141,7 @@ void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
         delete entry;
     }
 
+    invalidateFingerprint();
     emitModified();
 }
 
@@ -826,6 +1153,7 @@ void Entry::truncateHistory()
         return;
     }
 
+    loadHistory();
     bool changed = false;
     int histMaxItems = db->metadata()->historyMaxItems();
     if (histMaxItems > -1) {
@@ -866,6 +1194,7 @@ void Entry::truncateHistory()
     }
 
     if (changed) {
+        invalidateFingerprint();
         emitModified();
     }
 }
@@ -893,7 +1222,11 @@ bool Entry::equals(const Entry* other, CompareItemOptions options) const
     if (*m_autoTypeAssociations != *other->m_autoTypeAssociations) {
         return false;
     }
-    if (!options.testFlag(CompareItemIgnoreHistory)) {
+    // Entries sharing their serialized history have the same history items
+    if (!options.testFlag(CompareItemIgnoreHistory)
+        && (!m_serializedHistory || m_serializedHistory != other->m_serializedHistory)) {
+        loadHistory();
+        other->loadHistory();
         if (m_history.count() != other->m_history.count()) {
             return false;
         }
@@ -906,6 +1239,80 @@ bool Entry::equals(const Entry* other, CompareItemOptions options) const
     return true;
 }
 
+QByteArray Entry::fingerprint() const
+{
+    if (!m_fingerprint.isEmpty()) {
+        return m_fingerprint;
+    }
+
+    // Times are stored with second precision, so milliseconds are ignored like in the merge
+    auto time = [](const QDateTime& dateTime) { return Clock::serialized(dateTime).toMSecsSinceEpoch(); };
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << m_uuid << m_data.iconNumber << m_data.customIcon << m_data.foregroundColor << m_data.backgroundColor
+           << m_data.overrideUrl << m_data.tags << m_data.autoTypeEnabled << m_data.autoTypeObfuscation
+           << m_data.defaultAutoTypeSequence << m_data.excludeFromReports;
+
+    const TimeInfo& timeInfo = m_data.timeInfo;
+    stream << time(timeInfo.lastModificationTime()) << time(timeInfo.creationTime())
+           << time(timeInfo.lastAccessTime()) << timeInfo.expires() << time(timeInfo.expiryTime())
+           << timeInfo.usageCount();
+
+    const QList<QString> attributeKeys = m_attributes->keys();
+    stream << attributeKeys.size();
+    for (const QString& key : attributeKeys) {
+        stream << key << m_attributes->value(key) << m_attributes->isProtected(key);
+    }
+
+    // Attachments are represented by their cached content hashes
+    const QList<QString> attachmentKeys = m_attachments->keys();
+    stream << attachmentKeys.size();
+    for (const QString& key : attachmentKeys) {
+        stream << key << m_attachments->hash(key);
+    }
+
+    const auto associations = m_autoTypeAssociations->getAll();
+    stream << associations.size();
+    for (const auto& association : associations) {
+        stream << association.window << association.sequence;
+    }
+
+    QList<QString> customDataKeys = m_customData->keys();
+    std::sort(customDataKeys.begin(), customDataKeys.end());
+    stream << customDataKeys.size();
+    for (const QString& key : asConst(customDataKeys)) {
+        const auto& item = m_customData->item(key);
+        stream << key << item.value << time(item.lastModified);
+    }
+
+    // History items are merged by their modification time
+    if (m_serializedHistory) {
+        const QList<QDateTime> modificationTimes = m_serializedHistory->lastModificationTimes();
+        stream << modificationTimes.size();
+        for (const QDateTime& modificationTime : modificationTimes) {
+            stream << time(modificationTime);
+        }
+    } else {
+        stream << m_history.size();
+        for (const Entry* historyItem : m_history) {
+            stream << time(historyItem->timeInfo().lastModificationTime());
+        }
+    }
+
+    const QByteArray fingerprint = CryptoHash::hash(data, CryptoHash::Sha256);
+    // The fingerprint is only kept on the thread owning the entry
+    if (QThread::currentThread() == thread()) {
+        m_fingerprint = fingerprint;
+    }
+    return fingerprint;
+}
+
+void Entry::invalidateFingerprint()
+{
+    m_fingerprint.clear();
+}
+
 Entry* Entry::clone(CloneFlags flags) const
 {
     auto entry = new Entry();
@@ -933,14 +1340,17 @@ Entry* Entry::clone(CloneFlags flags) const
     }
 
     entry->m_autoTypeAssociations->copyDataFrom(m_autoTypeAssociations);
-    if (flags & CloneIncludeHistory) {
+    if ((flags & CloneIncludeHistory) && m_serializedHistory) {
+        entry->m_serializedHistory = m_serializedHistory;
+    } else if (flags & CloneIncludeHistory) {
+        // The cloned history items already share their values with the original ones,
+        // so they are appended directly instead of through addHistoryItem()
+        entry->m_history.reserve(m_history.size());
         for (Entry* historyItem : m_history) {
             Entry* historyItemClone =
                 historyItem->clone(flags & ~CloneIncludeHistory & ~CloneNewUuid & ~CloneResetTimeInfo);
-            historyItemClone->setUpdateTimeinfo(false);
-            historyItemClone->setUuid(entry->uuid());
-            historyItemClone->setUpdateTimeinfo(true);
-            entry->addHistoryItem(historyItemClone);
+            historyItemClone->m_uuid = entry->m_uuid;
+            entry->m_history.append(historyItemClone);
         }
     }
 
@@ -958,6 +1368,13 @@ Entry* Entry::clone(CloneFlags flags) const
 
     entry->setUpdateTimeinfo(true);
 
+    // An exact copy has the same fingerprint, e.g. in the snapshot of a background save
+    const CloneFlags changingFlags =
+        CloneNewUuid | CloneResetTimeInfo | CloneUserAsRef | ClonePassAsRef | CloneRenameTitle;
+    if (!(flags & changingFlags) && ((flags & CloneIncludeHistory) || historyCount() == 0)) {
+        entry->m_fingerprint = m_fingerprint;
+    }
+
     return entry;
 }
 
@@ -965,11 +1382,14 @@ void Entry::copyDataFrom(const Entry* other)
 {
     setUpdateTimeinfo(false);
     m_data = other->m_data;
+    invalidateFingerprint();
     m_customData->copyDataFrom(other->m_customData);
     m_attributes->copyDataFrom(other->m_attributes);
     m_attachments->copyDataFrom(other->m_attachments);
     m_autoTypeAssociations->copyDataFrom(other->m_autoTypeAssociations);
     setUpdateTimeinfo(true);
+    updateStatistics();
+    updateSearchIndex();
 }
 
 void Entry::beginUpdate()
@@ -1006,7 +1426,7 @@ void Entry::updateModifiedSinceBegin()
     m_modifiedSinceBegin = true;
 }
 
-QString Entry::resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth) const
+QString Entry::resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth, int& flags) const
 {
     static QRegularExpression placeholderRegEx("(\\{[^\\}]+?\\})", QRegularExpression::CaseInsensitiveOption);
 
@@ -1015,59 +1435,75 @@ QString Entry::resolveMultiplePlaceholdersRecursive(const QString& str, int maxD
         return str;
     }
 
+    if (!str.contains(QLatin1Char('{'))) {
+        return str;
+    }
+
     QString result = str;
     auto matches = placeholderRegEx.globalMatch(str);
     while (matches.hasNext()) {
         auto match = matches.next();
         const auto found = match.captured(1);
-        result.replace(found, resolvePlaceholderRecursive(found, maxDepth - 1));
+        result.replace(found, resolvePlaceholderRecursive(found, maxDepth - 1, flags));
     }
 
     if (result != str) {
-        result = resolveMultiplePlaceholdersRecursive(result, maxDepth - 1);
+        result = resolveMultiplePlaceholdersRecursive(result, maxDepth - 1, flags);
     }
 
     return result;
 }
 
-QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDepth) const
+QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDepth, int& flags) const
 {
     if (maxDepth <= 0) {
         qWarning("Maximum depth of replacement has been reached. Entry uuid: %s", uuid().toString().toLatin1().data());
         return placeholder;
     }
 
+    const auto markProtected = [&](const QString& key) {
+        if (m_attributes->isProtected(key)) {
+            flags |= ResolveProtected;
+        }
+    };
+
     const PlaceholderType typeOfPlaceholder = placeholderType(placeholder);
     switch (typeOfPlaceholder) {
     case PlaceholderType::NotPlaceholder:
     case PlaceholderType::Unknown:
-        return resolveMultiplePlaceholdersRecursive(placeholder, maxDepth - 1);
+        return resolveMultiplePlaceholdersRecursive(placeholder, maxDepth - 1, flags);
     case PlaceholderType::Title:
+        markProtected(EntryAttributes::TitleKey);
         if (placeholderType(title()) == PlaceholderType::Title) {
             return title();
         }
-        return resolveMultiplePlaceholdersRecursive(title(), maxDepth - 1);
+        return resolveMultiplePlaceholdersRecursive(title(), maxDepth - 1, flags);
     case PlaceholderType::UserName:
+        markProtected(EntryAttributes::UserNameKey);
         if (placeholderType(username()) == PlaceholderType::UserName) {
             return username();
         }
-        return resolveMultiplePlaceholdersRecursive(username(), maxDepth - 1);
+        return resolveMultiplePlaceholdersRecursive(username(), maxDepth - 1, flags);
     case PlaceholderType::Password:
+        markProtected(EntryAttributes::PasswordKey);
         if (placeholderType(password()) == PlaceholderType::Password) {
             return password();
         }
-        return resolveMultiplePlaceholdersRecursive(password(), maxDepth - 1);
+        return resolveMultiplePlaceholdersRecursive(password(), maxDepth - 1, flags);
     case PlaceholderType::Notes:
+        markProtected(EntryAttributes::NotesKey);
         if (placeholderType(notes()) == PlaceholderType::Notes) {
             return notes();
         }
-        return resolveMultiplePlaceholdersRecursive(notes(), maxDepth - 1);
+        return resolveMultiplePlaceholdersRecursive(notes(), maxDepth - 1, flags);
     case PlaceholderType::Url:
+        markProtected(EntryAttributes::URLKey);
         if (placeholderType(url()) == PlaceholderType::Url) {
             return url();
         }
-        return resolveMultiplePlaceholdersRecursive(url(), maxDepth - 1);
+        return resolveMultiplePlaceholdersRecursive(url(), maxDepth - 1, flags);
     case PlaceholderType::DbDir: {
+        flags |= ResolveVolatile;
         QFileInfo fileInfo(database()->filePath());
         return fileInfo.absoluteDir().absolutePath();
     }
@@ -1081,18 +1517,22 @@ QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDe
     case PlaceholderType::UrlUserInfo:
     case PlaceholderType::UrlUserName:
     case PlaceholderType::UrlPassword: {
-        const QString strUrl = resolveMultiplePlaceholdersRecursive(url(), maxDepth - 1);
+        markProtected(EntryAttributes::URLKey);
+        const QString strUrl = resolveMultiplePlaceholdersRecursive(url(), maxDepth - 1, flags);
         return resolveUrlPlaceholder(strUrl, typeOfPlaceholder);
     }
     case PlaceholderType::Totp:
         // totp can't have placeholder inside
+        flags |= ResolveVolatile;
         return totp();
     case PlaceholderType::CustomAttribute: {
         const QString key = placeholder.mid(3, placeholder.length() - 4); // {S:attr} => mid(3, len - 4)
+        markProtected(key);
         return attributes()->hasKey(key) ? attributes()->value(key) : QString();
     }
     case PlaceholderType::Reference:
-        return resolveReferencePlaceholderRecursive(placeholder, maxDepth);
+        flags |= ResolveUsesDatabase;
+        return resolveReferencePlaceholderRecursive(placeholder, maxDepth, flags);
     case PlaceholderType::DateTimeSimple:
     case PlaceholderType::DateTimeYear:
     case PlaceholderType::DateTimeMonth:
@@ -1107,7 +1547,8 @@ QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDe
     case PlaceholderType::DateTimeUtcHour:
     case PlaceholderType::DateTimeUtcMinute:
     case PlaceholderType::DateTimeUtcSecond:
-        return resolveMultiplePlaceholdersRecursive(resolveDateTimePlaceholder(typeOfPlaceholder), maxDepth - 1);
+        flags |= ResolveVolatile;
+        return resolveMultiplePlaceholdersRecursive(resolveDateTimePlaceholder(typeOfPlaceholder), maxDepth - 1, flags);
     }
 
     return placeholder;
@@ -1171,7 +1612,7 @@ QString Entry::resolveDateTimePlaceholder(Entry::PlaceholderType placeholderType
     return date_formatted;
 }
 
-QString Entry::resolveReferencePlaceholderRecursive(const QString& placeholder, int maxDepth) const
+QString Entry::resolveReferencePlaceholderRecursive(const QString& placeholder, int maxDepth, int& flags) const
 {
     if (maxDepth <= 0) {
         qWarning("Maximum depth of replacement has been reached. Entry uuid: %s", uuid().toString().toLatin1().data());
@@ -1196,12 +1637,16 @@ QString Entry::resolveReferencePlaceholderRecursive(const QString& placeholder,
 
     if (refEntry) {
         const QString wantedField = match.captured(EntryAttributes::WantedFieldGroupName);
-        result = refEntry->referenceFieldValue(Entry::referenceType(wantedField));
+        const EntryReferenceType wantedType = Entry::referenceType(wantedField);
+        result = refEntry->referenceFieldValue(wantedType);
+        if (refEntry->attributes()->isProtected(referenceFieldKey(wantedType))) {
+            flags |= ResolveProtected;
+        }
 
         // Referencing fields of other entries only works with standard fields, not with custom user strings.
         // If you want to reference a custom user string, you need to place a redirection in a standard field
         // of the entry with the custom string, using {S:<Name>}, and reference the standard field.
-        result = refEntry->resolveMultiplePlaceholdersRecursive(result, maxDepth - 1);
+        result = refEntry->resolveMultiplePlaceholdersRecursive(result, maxDepth - 1, flags);
     }
 
     return result;
@@ -1280,6 +1725,7 @@ void Entry::setGroup(Group* group, bool trackPrevious)
     QObject::setParent(group);
 
     m_group = group;
+    m_placeholderCache.clear();
     group->addEntry(this);
 
     if (m_updateTimeinfo) {
@@ -1329,14 +1775,51 @@ Entry* Entry::resolveReference(const QString& str) const
     return m_group->database()->rootGroup()->findEntryBySearchTerm(searchText, searchInType);
 }
 
+/**
+ * Resolve all placeholders contained in str.
+ *
+ * Results that do not depend on the current time are memoized per entry. They are
+ * invalidated when the attributes of this entry change or, for results that
+ * resolved a reference, when any entry of the database changes. Results that
+ * contain a protected value are never memoized, so they are not kept in memory.
+ */
 QString Entry::resolveMultiplePlaceholders(const QString& str) const
 {
-    return resolveMultiplePlaceholdersRecursive(str, ResolveMaximumDepth);
+    if (!str.contains(QLatin1Char('{'))) {
+        return str;
+    }
+
+    // The cache is only used from the thread owning the entry
+    const bool useCache = QThread::currentThread() == thread();
+    const Database* db = database();
+    if (useCache) {
+        auto it = m_placeholderCache.constFind(str);
+        if (it != m_placeholderCache.cend()
+            && (it->database.isNull()
+                || (db && it->database == db->uuid() && it->databaseRevision == db->m_placeholderRevision))) {
+            return it->value;
+        }
+    }
+
+    int flags = ResolveNoFlags;
+    QString result = resolveMultiplePlaceholdersRecursive(str, ResolveMaximumDepth, flags);
+
+    const bool usesDatabase = flags & ResolveUsesDatabase;
+    if (useCache && !(flags & (ResolveVolatile | ResolveProtected)) && (!usesDatabase || db)) {
+        if (m_placeholderCache.size() >= MaxPlaceholderCacheSize) {
+            m_placeholderCache.clear();
+        }
+        m_placeholderCache.insert(
+            str, {result, usesDatabase ? db->uuid() : QUuid(), usesDatabase ? db->m_placeholderRevision : 0});
+    }
+
+    return result;
 }
 
 QString Entry::resolvePlaceholder(const QString& placeholder) const
 {
-    return resolvePlaceholderRecursive(placeholder, ResolveMaximumDepth);
+    int flags = ResolveNoFlags;
+    return resolvePlaceholderRecursive(placeholder, ResolveMaximumDepth, flags);
 }
 
 QString Entry::resolveUrlPlaceholder(const QString& str, Entry::PlaceholderType placeholderType) const
@@ -1464,6 +1947,29 @@ QString Entry::resolveUrl(const QString& url) const
     return {};
 }
 
+const Entry::CaseFoldedFields& Entry::caseFoldedFields() const
+{
+    if (m_caseFoldedValid) {
+        return m_caseFolded;
+    }
+
+    static const QString keys[CaseFoldedFields::FieldCount] = {
+        EntryAttributes::TitleKey, EntryAttributes::UserNameKey, EntryAttributes::URLKey, EntryAttributes::NotesKey};
+    for (int field = 0; field < CaseFoldedFields::FieldCount; ++field) {
+        const QString value = m_attributes->value(keys[field]);
+        // Protected values must not linger in memory as an unprotected copy,
+        // and placeholders are only known after resolving them
+        m_caseFolded.folded[field] = !m_attributes->isProtected(keys[field]) && !value.contains('{');
+        m_caseFolded.values[field] = m_caseFolded.folded[field] ? value.toCaseFolded() : QString();
+    }
+    m_caseFolded.tags.clear();
+    for (const auto& tag : tagList()) {
+        m_caseFolded.tags.append(tag.toCaseFolded());
+    }
+    m_caseFoldedValid = true;
+    return m_caseFolded;
+}
+
 Group* Entry::previousParentGroup()
 {
     if (!database() || !database()->rootGroup()) {
@@ -19,8 +19,10 @@
 #ifndef KEEPASSX_ENTRY_H
 #define KEEPASSX_ENTRY_H
 
+#include <QHash>
 #include <QMap>
 #include <QPointer>
+#include <QUrl>
 #include <QUuid>
 
 #include "core/AutoTypeAssociations.h"
@@ -163,13 +165,38 @@ public:
     void addTag(const QString& tag);
     void removeTag(const QString& tag);
 
+    /**
+     * History items that are kept serialized until they are first accessed.
+     * Shared by the clones of an entry, it must not change once it is set.
+     */
+    class SerializedHistory
+    {
+    public:
+        virtual ~SerializedHistory() = default;
+        // Items sorted from oldest to newest, owned by the caller
+        virtual QList<Entry*> load() const = 0;
+        virtual int count() const = 0;
+        virtual QList<QDateTime> lastModificationTimes() const = 0;
+        // Estimated heap memory held by the serialized items
+        virtual qint64 memoryUsage() const = 0;
+    };
+
     QList<Entry*> historyItems();
     const QList<Entry*>& historyItems() const;
+    int historyCount() const;
+    void setSerializedHistory(QSharedPointer<const SerializedHistory> history);
+    QSharedPointer<const SerializedHistory> serializedHistory() const;
     void addHistoryItem(Entry* entry);
     void removeHistoryItems(const QList<Entry*>& historyEntries);
     void truncateHistory();
 
     bool equals(const Entry* other, CompareItemOptions options = CompareItemDefault) const;
+    /**
+     * Digest of the content compared when merging: the attributes, attachments,
+     * times and the modification times of the history items. Entries with the
+     * same fingerprint merge without changes. Computed on first use and cached.
+     */
+    QByteArray fingerprint() const;
 
     enum CloneFlag
     {
@@ -246,6 +273,50 @@ public:
     PlaceholderType placeholderType(const QString& placeholder) const;
     QString resolveUrl(const QString& url) const;
 
+    /**
+     * Case-folded copies of the fields searched case-insensitively. Fields
+     * that are protected or contain placeholders are not folded, tags always are.
+     */
+    struct CaseFoldedFields
+    {
+        enum Field
+        {
+            Title,
+            Username,
+            Url,
+            Notes,
+            FieldCount
+        };
+
+        QString values[FieldCount];
+        bool folded[FieldCount] = {};
+        QStringList tags;
+    };
+    const CaseFoldedFields& caseFoldedFields() const;
+
+    /**
+     * URL of the entry split into the components used for matching. URLs
+     * without a scheme are parsed as user input.
+     */
+    struct ParsedUrl
+    {
+        QString url;
+        QUrl qurl;
+        bool hasScheme = false;
+        QString scheme;
+        QString host;
+        int port = -1;
+        QString path;
+
+        QString baseDomain() const;
+
+    private:
+        mutable QString m_baseDomain;
+        mutable bool m_baseDomainValid = false;
+    };
+    static ParsedUrl parseUrl(const QString& url);
+    const QVector<ParsedUrl>& parsedUrls() const;
+
     /**
      * Call before and after set*() methods to create a history item
      * if the entry has been changed.
@@ -276,11 +347,37 @@ private slots:
     void updateTimeinfo();
     void updateModifiedSinceBegin();
     void updateTotp();
+    void updateReferences();
+    void updateStatistics();
+    void updateSearchIndex();
+    void updateUrlIndex();
+    void updatePasskeyIndex();
+    void updateSshKeyIndex();
+    void updateAttachmentTextIndex();
+    void recordChange();
+    void invalidatePlaceholderCache();
+    void invalidateFingerprint();
 
 private:
-    QString resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth) const;
-    QString resolvePlaceholderRecursive(const QString& placeholder, int maxDepth) const;
-    QString resolveReferencePlaceholderRecursive(const QString& placeholder, int maxDepth) const;
+    enum ResolveFlag
+    {
+        ResolveNoFlags = 0,
+        ResolveVolatile = 1, // result depends on the current time or file location and must not be cached
+        ResolveUsesDatabase = 2, // result depends on other entries of the database
+        ResolveProtected = 4, // result contains a protected value and must not be cached
+    };
+
+    struct ResolvedPlaceholder
+    {
+        QString value;
+        // Database the result was resolved against, null if it only depends on this entry
+        QUuid database;
+        quint64 databaseRevision;
+    };
+
+    QString resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth, int& flags) const;
+    QString resolvePlaceholderRecursive(const QString& placeholder, int maxDepth, int& flags) const;
+    QString resolveReferencePlaceholderRecursive(const QString& placeholder, int maxDepth, int& flags) const;
     QString referenceFieldValue(EntryReferenceType referenceType) const;
 
     static QString buildReference(const QUuid& uuid, const QString& field);
@@ -288,18 +385,37 @@ private:
 
     template <class T> bool set(T& property, const T& value);
 
+    void loadHistory() const;
+    void shareDataWithHistoryItem(Entry* entry) const;
+
     QUuid m_uuid;
     EntryData m_data;
     QPointer<EntryAttributes> m_attributes;
     QPointer<EntryAttachments> m_attachments;
     QPointer<AutoTypeAssociations> m_autoTypeAssociations;
     QPointer<CustomData> m_customData;
-    QList<Entry*> m_history; // Items sorted from oldest to newest
+    // Items sorted from oldest to newest, loaded from m_serializedHistory on first access
+    mutable QList<Entry*> m_history;
+    mutable QSharedPointer<const SerializedHistory> m_serializedHistory;
 
     QScopedPointer<Entry> m_tmpHistoryItem;
     bool m_modifiedSinceBegin;
     QPointer<Group> m_group;
     bool m_updateTimeinfo;
+
+    mutable QHash<QString, ResolvedPlaceholder> m_placeholderCache;
+    mutable CaseFoldedFields m_caseFolded;
+    mutable bool m_caseFoldedValid = false;
+    // Parsed getAllUrls(), entries using placeholders in an URL compare the resolved URLs on access
+    mutable QVector<ParsedUrl> m_parsedUrls;
+    mutable bool m_parsedUrlsValid = false;
+    mutable bool m_parsedUrlsResolved = false;
+    // Empty until fingerprint() is called after a change
+    mutable QByteArray m_fingerprint;
+    // TOTP code of the last time step it was generated for
+    mutable QString m_totpCode;
+    mutable quint64 m_totpCodeCounter = 0;
+    mutable QWeakPointer<Totp::Settings> m_totpCodeSettings;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Entry::CloneFlags)
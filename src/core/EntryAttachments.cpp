@@ -18,16 +18,82 @@
 #include "EntryAttachments.h"
 
 #include "config-keepassx.h"
+#include "core/AsyncTask.h"
 #include "core/Global.h"
+#include "core/MemoryUsage.h"
+#include "crypto/CryptoHash.h"
 #include "crypto/Random.h"
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDesktopServices>
 #include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QPointer>
 #include <QProcessEnvironment>
 #include <QSet>
 #include <QTemporaryFile>
+#include <QTimer>
 #include <QUrl>
 
+#include <limits>
+
+namespace
+{
+    constexpr qint64 StreamChunkSize = 1024 * 1024;
+    // Leaves room for the QByteArray header
+    constexpr qint64 MaxAttachmentSize = std::numeric_limits<int>::max() - 1024;
+
+    /**
+     * Single watcher for the temporary files of the opened attachments of all entries.
+     * The poll timer catches changes the file system watcher misses, e.g. on network shares.
+     */
+    class OpenedAttachmentsWatcher : public QFileSystemWatcher
+    {
+    public:
+        static OpenedAttachmentsWatcher* instance(bool create = true)
+        {
+            static QPointer<OpenedAttachmentsWatcher> watcher;
+            if (!watcher && create) {
+                watcher = new OpenedAttachmentsWatcher(QCoreApplication::instance());
+            }
+            return watcher;
+        }
+
+        QTimer* pollTimer()
+        {
+            return &m_pollTimer;
+        }
+
+        void watch(const QString& path)
+        {
+            addPath(path);
+            ++m_watchedFiles;
+            m_pollTimer.start();
+        }
+
+        void unwatch(const QString& path)
+        {
+            removePath(path);
+            if (--m_watchedFiles <= 0) {
+                m_watchedFiles = 0;
+                m_pollTimer.stop();
+            }
+        }
+
+    private:
+        explicit OpenedAttachmentsWatcher(QObject* parent)
+            : QFileSystemWatcher(parent)
+        {
+            m_pollTimer.setInterval(5000);
+        }
+
+        QTimer m_pollTimer;
+        int m_watchedFiles = 0;
+    };
+} // namespace
+
 EntryAttachments::EntryAttachments(QObject* parent)
     : ModifiableObject(parent)
 {
@@ -58,6 +124,29 @@ QByteArray EntryAttachments::value(const QString& key) const
     return m_attachments.value(key);
 }
 
+/**
+ * SHA-256 of the attachment stored under key. The result is cached until the
+ * attachment changes and carried over to copies, so writers do not need to
+ * rehash unchanged binaries on every save.
+ */
+QByteArray EntryAttachments::hash(const QString& key) const
+{
+    auto it = m_attachments.constFind(key);
+    if (it == m_attachments.constEnd()) {
+        return {};
+    }
+
+    QMutexLocker locker(&m_hashMutex);
+    auto hashIt = m_hashes.constFind(key);
+    if (hashIt != m_hashes.constEnd()) {
+        return hashIt.value();
+    }
+
+    const QByteArray result = CryptoHash::hash(it.value(), CryptoHash::Sha256);
+    m_hashes.insert(key, result);
+    return result;
+}
+
 void EntryAttachments::set(const QString& key, const QByteArray& value)
 {
     bool shouldEmitModified = false;
@@ -69,6 +158,8 @@ void EntryAttachments::set(const QString& key, const QByteArray& value)
 
     if (addAttachment || m_attachments.value(key) != value) {
         m_attachments.insert(key, value);
+        QMutexLocker locker(&m_hashMutex);
+        m_hashes.remove(key);
         shouldEmitModified = true;
     }
 
@@ -83,6 +174,22 @@ void EntryAttachments::set(const QString& key, const QByteArray& value)
     }
 }
 
+/**
+ * Replace the data of an attachment by an equal copy, so that both share
+ * their memory. The content does not change, so neither does the entry.
+ *
+ * @return true if the data was replaced
+ */
+bool EntryAttachments::shareData(const QString& key, const QByteArray& value)
+{
+    auto it = m_attachments.find(key);
+    if (it == m_attachments.end() || it.value().constData() == value.constData() || it.value() != value) {
+        return false;
+    }
+    it.value() = value;
+    return true;
+}
+
 void EntryAttachments::remove(const QString& key)
 {
     if (!m_attachments.contains(key)) {
@@ -93,6 +200,10 @@ void EntryAttachments::remove(const QString& key)
     emit aboutToBeRemoved(key);
 
     m_attachments.remove(key);
+    {
+        QMutexLocker locker(&m_hashMutex);
+        m_hashes.remove(key);
+    }
 
     if (m_openedAttachments.contains(key)) {
         disconnectAndEraseExternalFile(m_openedAttachments.value(key));
@@ -127,8 +238,14 @@ void EntryAttachments::remove(const QStringList& keys)
 void EntryAttachments::rename(const QString& key, const QString& newKey)
 {
     const QByteArray val = value(key);
+    const QByteArray valHash = hash(key);
     remove(key);
     set(newKey, val);
+
+    if (!valHash.isEmpty()) {
+        QMutexLocker locker(&m_hashMutex);
+        m_hashes.insert(newKey, valHash);
+    }
 }
 
 bool EntryAttachments::isEmpty() const
@@ -145,21 +262,40 @@ void EntryAttachments::clear()
     emit aboutToBeReset();
 
     m_attachments.clear();
+    {
+        QMutexLocker locker(&m_hashMutex);
+        m_hashes.clear();
+    }
+
+    closeOpenedAttachments();
+
+    emit reset();
+    emitModified();
+}
 
+/**
+ * Stop watching and erase the temporary files of all opened attachments.
+ */
+void EntryAttachments::closeOpenedAttachments()
+{
     const auto externalPath = m_openedAttachments.values();
     for (auto& path : externalPath) {
         disconnectAndEraseExternalFile(path);
     }
-
-    emit reset();
-    emitModified();
 }
 
 void EntryAttachments::disconnectAndEraseExternalFile(const QString& path)
 {
     if (m_openedAttachmentsInverse.contains(path)) {
-        m_attachmentFileWatchers.value(path)->stop();
-        m_attachmentFileWatchers.remove(path);
+        m_externalFileStates.remove(path);
+        auto watcher = OpenedAttachmentsWatcher::instance(false);
+        if (watcher) {
+            watcher->unwatch(path);
+            if (m_externalFileStates.isEmpty()) {
+                disconnect(watcher, nullptr, this, nullptr);
+                disconnect(watcher->pollTimer(), nullptr, this, nullptr);
+            }
+        }
 
         m_openedAttachments.remove(m_openedAttachmentsInverse.value(path));
         m_openedAttachmentsInverse.remove(path);
@@ -188,12 +324,42 @@ void EntryAttachments::copyDataFrom(const EntryAttachments* other)
         }
 
         m_attachments = other->m_attachments;
+        {
+            QMutexLocker otherLocker(&other->m_hashMutex);
+            const auto hashes = other->m_hashes;
+            otherLocker.unlock();
+            QMutexLocker locker(&m_hashMutex);
+            m_hashes = hashes;
+        }
 
         emit reset();
         emitModified();
     }
 }
 
+/**
+ * Replace attachments that are equal to the ones of other with other's implicitly shared copies.
+ * The content does not change, so no signals are emitted.
+ */
+void EntryAttachments::shareDataFrom(const EntryAttachments* other)
+{
+    if (m_attachments.isSharedWith(other->m_attachments)) {
+        return;
+    }
+
+    if (m_attachments == other->m_attachments) {
+        m_attachments = other->m_attachments;
+        return;
+    }
+
+    for (auto it = m_attachments.begin(); it != m_attachments.end(); ++it) {
+        auto otherIt = other->m_attachments.constFind(it.key());
+        if (otherIt != other->m_attachments.constEnd() && otherIt.value() == it.value()) {
+            it.value() = otherIt.value();
+        }
+    }
+}
+
 bool EntryAttachments::operator==(const EntryAttachments& other) const
 {
     return m_attachments == other.m_attachments;
@@ -213,10 +379,23 @@ int EntryAttachments::attachmentsSize() const
     return size;
 }
 
+/**
+ * Estimate the heap memory held by the attachments. Attachment data shared
+ * with other entries, like their history items, is counted once.
+ */
+qint64 EntryAttachments::memoryUsage(QSet<const void*>& seen) const
+{
+    const qint64 node = MemoryUsage::NodeOverhead + qint64(sizeof(void*) + sizeof(QString) + sizeof(QByteArray));
+    qint64 size = m_attachments.size() * node;
+    for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
+        size += MemoryUsage::heapSize(it.key()) + MemoryUsage::sharedHeapSize(it.value(), seen);
+    }
+    return size;
+}
+
 bool EntryAttachments::openAttachment(const QString& key, QString* errorMessage)
 {
     if (!m_openedAttachments.contains(key)) {
-        const QByteArray attachmentData = value(key);
         auto ext = key.contains(".") ? "." + key.split(".").last() : "";
 
 #if defined(KEEPASSXC_DIST_SNAP)
@@ -233,22 +412,35 @@ bool EntryAttachments::openAttachment(const QString& key, QString* errorMessage)
         QTemporaryFile tmpFile(tmpFileTemplate);
 
         const bool saveOk = tmpFile.open() && tmpFile.setPermissions(QFile::ReadOwner | QFile::WriteOwner)
-                            && tmpFile.write(attachmentData) == attachmentData.size() && tmpFile.flush();
+                            && exportToDevice(key, &tmpFile) && tmpFile.flush();
 
-        if (!saveOk && errorMessage) {
-            *errorMessage = QString("%1 - %2").arg(key, tmpFile.errorString());
+        if (!saveOk) {
+            if (errorMessage) {
+                *errorMessage = QString("%1 - %2").arg(key, tmpFile.errorString());
+            }
             return false;
         }
 
         tmpFile.close();
         tmpFile.setAutoRemove(false);
-        m_openedAttachments.insert(key, tmpFile.fileName());
-        m_openedAttachmentsInverse.insert(tmpFile.fileName(), key);
-
-        auto watcher = QSharedPointer<FileWatcher>::create();
-        watcher->start(tmpFile.fileName(), 5);
-        connect(watcher.data(), &FileWatcher::fileChanged, this, &EntryAttachments::attachmentFileModified);
-        m_attachmentFileWatchers.insert(tmpFile.fileName(), watcher);
+        const QString path = tmpFile.fileName();
+        m_openedAttachments.insert(key, path);
+        m_openedAttachmentsInverse.insert(path, key);
+
+        const QFileInfo fileInfo(path);
+        ExternalFileState state;
+        state.size = fileInfo.size();
+        state.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+        // The file holds exactly the attachment, so it does not need to be read back
+        state.checksum = hash(key);
+
+        auto watcher = OpenedAttachmentsWatcher::instance();
+        if (m_externalFileStates.isEmpty()) {
+            connect(watcher, &QFileSystemWatcher::fileChanged, this, &EntryAttachments::attachmentFileModified);
+            connect(watcher->pollTimer(), &QTimer::timeout, this, &EntryAttachments::checkOpenedAttachments);
+        }
+        m_externalFileStates.insert(path, state);
+        watcher->watch(path);
     }
 
     const bool openOk = QDesktopServices::openUrl(QUrl::fromLocalFile(m_openedAttachments.value(key)));
@@ -260,10 +452,174 @@ bool EntryAttachments::openAttachment(const QString& key, QString* errorMessage)
     return true;
 }
 
+/**
+ * Read an attachment from a device in chunks and store it under key.
+ * If the size of the device is known, the data is read straight into a buffer
+ * of that size instead of growing and copying it.
+ *
+ * @param key attachment name
+ * @param device device opened for reading
+ * @param errorMessage set to the error of the device on failure
+ * @param progress called after each chunk, cancels the import if it returns false
+ * @return true on success, false on error or if canceled, in which case errorMessage is not set
+ */
+bool EntryAttachments::importFromDevice(const QString& key,
+                                        QIODevice* device,
+                                        QString* errorMessage,
+                                        const ProgressCallback& progress)
+{
+    const qint64 total = device->isSequential() ? -1 : device->size() - device->pos();
+    if (total > MaxAttachmentSize) {
+        if (errorMessage) {
+            *errorMessage = tr("File is too large to be attached");
+        }
+        return false;
+    }
+
+    QByteArray data;
+    if (total >= 0) {
+        // Leave room for the read that detects the end of the device
+        data.reserve(static_cast<int>(total) + 1);
+    }
+
+    qint64 readBytes = 0;
+    qint64 readResult;
+    do {
+        const qint64 chunkSize = total >= 0 ? qBound<qint64>(1, total - readBytes, StreamChunkSize) : StreamChunkSize;
+        if (readBytes + chunkSize > MaxAttachmentSize) {
+            if (errorMessage) {
+                *errorMessage = tr("File is too large to be attached");
+            }
+            return false;
+        }
+
+        data.resize(static_cast<int>(readBytes + chunkSize));
+        readResult = device->read(data.data() + readBytes, chunkSize);
+        if (readResult > 0) {
+            readBytes += readResult;
+        }
+
+        if (progress && !progress(readBytes, total)) {
+            return false;
+        }
+    } while (readResult > 0);
+
+    if (readResult < 0) {
+        if (errorMessage) {
+            *errorMessage = device->errorString();
+        }
+        return false;
+    }
+
+    data.resize(static_cast<int>(readBytes));
+    set(key, data);
+    return true;
+}
+
+/**
+ * Write an attachment to a device in chunks, without copying it.
+ *
+ * @param key attachment name
+ * @param device device opened for writing
+ * @param errorMessage set to the error of the device on failure
+ * @param progress called after each chunk, cancels the export if it returns false
+ * @return true on success, false on error or if canceled, in which case errorMessage is not set
+ */
+bool EntryAttachments::exportToDevice(const QString& key,
+                                      QIODevice* device,
+                                      QString* errorMessage,
+                                      const ProgressCallback& progress) const
+{
+    const QByteArray data = value(key);
+    const qint64 total = data.size();
+
+    qint64 writtenBytes = 0;
+    while (writtenBytes < total) {
+        const qint64 writeResult =
+            device->write(data.constData() + writtenBytes, qMin(StreamChunkSize, total - writtenBytes));
+        if (writeResult <= 0) {
+            if (errorMessage) {
+                *errorMessage = device->errorString();
+            }
+            return false;
+        }
+        writtenBytes += writeResult;
+
+        if (progress && !progress(writtenBytes, total)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void EntryAttachments::attachmentFileModified(const QString& path)
 {
-    auto it = m_openedAttachmentsInverse.find(path);
-    if (it != m_openedAttachmentsInverse.end()) {
-        emit valueModifiedExternally(it.value(), path);
+    if (m_externalFileStates.contains(path)) {
+        checkExternalFile(path);
+    }
+}
+
+void EntryAttachments::checkOpenedAttachments()
+{
+    const auto paths = m_externalFileStates.keys();
+    for (const auto& path : paths) {
+        checkExternalFile(path);
+    }
+}
+
+void EntryAttachments::checkExternalFile(const QString& path)
+{
+    auto it = m_externalFileStates.find(path);
+    if (it == m_externalFileStates.end() || it->checking) {
+        return;
     }
+
+    // Files replaced by renaming another file over them are no longer watched
+    auto watcher = OpenedAttachmentsWatcher::instance();
+    if (!watcher->files().contains(path) && QFile::exists(path)) {
+        watcher->addPath(path);
+    }
+
+    // Only hash the file once its metadata changed
+    const QFileInfo fileInfo(path);
+    if (!fileInfo.exists()) {
+        return;
+    }
+    const qint64 size = fileInfo.size();
+    const qint64 lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    if (size == it->size && lastModified == it->lastModified) {
+        return;
+    }
+
+    it->size = size;
+    it->lastModified = lastModified;
+    it->checking = true;
+
+    AsyncTask::runThenCallback(
+        [path] {
+            QFile file(path);
+            if (!file.open(QFile::ReadOnly)) {
+                return QByteArray();
+            }
+            QCryptographicHash hash(QCryptographicHash::Sha256);
+            hash.addData(&file);
+            return hash.result();
+        },
+        this,
+        [this, path](const QByteArray& checksum) {
+            auto it = m_externalFileStates.find(path);
+            if (it == m_externalFileStates.end()) {
+                return;
+            }
+            it->checking = false;
+
+            // A file that can't be read is considered unchanged
+            if (checksum.isEmpty() || checksum == it->checksum) {
+                return;
+            }
+            it->checksum = checksum;
+            emit valueModifiedExternally(m_openedAttachmentsInverse.value(path), path);
+        },
+        AsyncTask::Priority::Background);
 }
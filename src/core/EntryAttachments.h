@@ -18,14 +18,18 @@
 #ifndef KEEPASSX_ENTRYATTACHMENTS_H
 #define KEEPASSX_ENTRYATTACHMENTS_H
 
-#include "core/FileWatcher.h"
 #include "core/ModifiableObject.h"
 
 #include <QHash>
 #include <QMap>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
 
+#include <functional>
+
+class QIODevice;
 class QStringList;
 
 class EntryAttachments : public ModifiableObject
@@ -33,23 +37,39 @@ class EntryAttachments : public ModifiableObject
     Q_OBJECT
 
 public:
+    // Receives the bytes transferred so far and the total, or -1 if unknown. Return false to cancel.
+    using ProgressCallback = std::function<bool(qint64 done, qint64 total)>;
+
     explicit EntryAttachments(QObject* parent = nullptr);
     ~EntryAttachments() override;
     QList<QString> keys() const;
     bool hasKey(const QString& key) const;
     QSet<QByteArray> values() const;
     QByteArray value(const QString& key) const;
+    QByteArray hash(const QString& key) const;
     void set(const QString& key, const QByteArray& value);
+    bool shareData(const QString& key, const QByteArray& value);
     void remove(const QString& key);
     void remove(const QStringList& keys);
     void rename(const QString& key, const QString& newKey);
     bool isEmpty() const;
     void clear();
+    void closeOpenedAttachments();
     void copyDataFrom(const EntryAttachments* other);
+    void shareDataFrom(const EntryAttachments* other);
     bool operator==(const EntryAttachments& other) const;
     bool operator!=(const EntryAttachments& other) const;
     int attachmentsSize() const;
+    qint64 memoryUsage(QSet<const void*>& seen) const;
     bool openAttachment(const QString& key, QString* errorMessage = nullptr);
+    bool importFromDevice(const QString& key,
+                          QIODevice* device,
+                          QString* errorMessage = nullptr,
+                          const ProgressCallback& progress = {});
+    bool exportToDevice(const QString& key,
+                        QIODevice* device,
+                        QString* errorMessage = nullptr,
+                        const ProgressCallback& progress = {}) const;
 
 signals:
     void keyModified(const QString& key);
@@ -63,14 +83,28 @@ signals:
 
 private slots:
     void attachmentFileModified(const QString& path);
+    void checkOpenedAttachments();
 
 private:
+    // Temporary file of an opened attachment as it was last seen
+    struct ExternalFileState
+    {
+        qint64 size = -1;
+        qint64 lastModified = -1;
+        QByteArray checksum;
+        bool checking = false;
+    };
+
+    void checkExternalFile(const QString& path);
     void disconnectAndEraseExternalFile(const QString& path);
 
     QMap<QString, QByteArray> m_attachments;
+    // Lazily computed SHA-256 of each attachment, shared with copies of this object
+    mutable QHash<QString, QByteArray> m_hashes;
+    mutable QMutex m_hashMutex;
     QHash<QString, QString> m_openedAttachments;
     QHash<QString, QString> m_openedAttachmentsInverse;
-    QHash<QString, QSharedPointer<FileWatcher>> m_attachmentFileWatchers;
+    QHash<QString, ExternalFileState> m_externalFileStates;
 };
 
 #endif // KEEPASSX_ENTRYATTACHMENTS_H
@@ -18,7 +18,9 @@
 
 #include "EntryAttributes.h"
 #include "core/Global.h"
+#include "core/MemoryUsage.h"
 
+#include <QMutex>
 #include <QRegularExpression>
 #include <QUuid>
 
@@ -37,6 +39,49 @@ const QString EntryAttributes::RememberCmdExecAttr = "_EXEC_CMD";
 const QString EntryAttributes::AdditionalUrlAttribute = "KP2A_URL";
 const QString EntryAttributes::PasskeyAttribute = "KPEX_PASSKEY";
 
+namespace
+{
+    const QRegularExpression& referenceRegExp()
+    {
+        static const QRegularExpression regExp(
+            "\\{REF:(?<WantedField>[TUPANI])@(?<SearchIn>[TUPANIO]):(?<SearchText>[^}]+)\\}",
+            QRegularExpression::CaseInsensitiveOption);
+        return regExp;
+    }
+
+    // Upper bound of distinct key names kept in the intern pool
+    constexpr int MaxInternedKeys = 4096;
+
+    /**
+     * Return a shared copy of key from a process wide pool, so that all entries
+     * and history items holding an attribute of the same name share one string
+     * allocation. Identical keys also compare faster as their data pointers match.
+     */
+    QString internKey(const QString& key)
+    {
+        static QMutex mutex;
+        static QSet<QString> pool = [] {
+            QSet<QString> keys;
+            for (const QString& defaultKey : EntryAttributes::DefaultAttributes) {
+                keys.insert(defaultKey);
+            }
+            keys.insert(EntryAttributes::RememberCmdExecAttr);
+            keys.insert(EntryAttributes::AdditionalUrlAttribute);
+            return keys;
+        }();
+
+        QMutexLocker locker(&mutex);
+        auto it = pool.constFind(key);
+        if (it != pool.constEnd()) {
+            return *it;
+        }
+        if (pool.size() < MaxInternedKeys) {
+            pool.insert(key);
+        }
+        return key;
+    }
+} // namespace
+
 EntryAttributes::EntryAttributes(QObject* parent)
     : ModifiableObject(parent)
 {
@@ -79,6 +124,12 @@ QList<QString> EntryAttributes::customKeys() const
 
 QString EntryAttributes::value(const QString& key) const
 {
+    if (!m_encryptedValues.isEmpty()) {
+        auto it = m_encryptedValues.constFind(key);
+        if (it != m_encryptedValues.constEnd()) {
+            return it->decrypt();
+        }
+    }
     return m_attributes.value(key);
 }
 
@@ -86,7 +137,7 @@ QList<QString> EntryAttributes::values(const QList<QString>& keys) const
 {
     QList<QString> values;
     for (const QString& key : keys) {
-        values.append(m_attributes.value(key));
+        values.append(value(key));
     }
     return values;
 }
@@ -98,7 +149,12 @@ bool EntryAttributes::contains(const QString& key) const
 
 bool EntryAttributes::containsValue(const QString& value) const
 {
-    return asConst(m_attributes).values().contains(value);
+    for (auto it = m_attributes.constBegin(); it != m_attributes.constEnd(); ++it) {
+        if (this->value(it.key()) == value) {
+            return true;
+        }
+    }
+    return false;
 }
 
 bool EntryAttributes::isProtected(const QString& key) const
@@ -122,23 +178,30 @@ void EntryAttributes::set(const QString& key, const QString& value, bool protect
     bool shouldEmitModified = false;
 
     bool addAttribute = !m_attributes.contains(key);
-    bool changeValue = !addAttribute && (m_attributes.value(key) != value);
+    bool changeValue = !addAttribute && (this->value(key) != value);
     bool defaultAttribute = isDefaultAttribute(key);
 
     if (addAttribute && !defaultAttribute) {
         emit aboutToBeAdded(key);
     }
 
-    if (addAttribute || changeValue) {
+    if (addAttribute) {
+        m_attributes.insert(internKey(key), value);
+        m_attributesSize = -1;
+        shouldEmitModified = true;
+    } else if (changeValue) {
+        // Keeps the already interned key
         m_attributes.insert(key, value);
+        m_encryptedValues.remove(key);
+        m_attributesSize = -1;
         shouldEmitModified = true;
     }
 
     if (protect) {
         if (!m_protectedAttributes.contains(key)) {
+            m_protectedAttributes.insert(internKey(key));
             shouldEmitModified = true;
         }
-        m_protectedAttributes.insert(key);
     } else if (m_protectedAttributes.remove(key)) {
         shouldEmitModified = true;
     }
@@ -156,6 +219,17 @@ void EntryAttributes::set(const QString& key, const QString& value, bool protect
     }
 }
 
+/**
+ * Set a protected value that is decrypted whenever it is accessed.
+ * Used by the database readers, the value is not compared to the current one.
+ */
+void EntryAttributes::setEncrypted(const QString& key, const ProtectedValue& value)
+{
+    set(key, {}, true);
+    m_encryptedValues.insert(internKey(key), value);
+    m_attributesSize = -1;
+}
+
 void EntryAttributes::remove(const QString& key)
 {
     Q_ASSERT(!isDefaultAttribute(key));
@@ -168,6 +242,8 @@ void EntryAttributes::remove(const QString& key)
 
     m_attributes.remove(key);
     m_protectedAttributes.remove(key);
+    m_encryptedValues.remove(key);
+    m_attributesSize = -1;
 
     emit removed(key);
     emitModified();
@@ -188,16 +264,21 @@ void EntryAttributes::rename(const QString& oldKey, const QString& newKey)
         return;
     }
 
-    QString data = value(oldKey);
+    QString data = m_attributes.value(oldKey);
     bool protect = isProtected(oldKey);
 
     emit aboutToRename(oldKey, newKey);
 
+    const QString key = internKey(newKey);
     m_attributes.remove(oldKey);
-    m_attributes.insert(newKey, data);
+    m_attributes.insert(key, data);
+    if (m_encryptedValues.contains(oldKey)) {
+        m_encryptedValues.insert(key, m_encryptedValues.take(oldKey));
+    }
+    m_attributesSize = -1;
     if (protect) {
         m_protectedAttributes.remove(oldKey);
-        m_protectedAttributes.insert(newKey);
+        m_protectedAttributes.insert(key);
     }
 
     emitModified();
@@ -218,18 +299,23 @@ void EntryAttributes::copyCustomKeysFrom(const EntryAttributes* other)
         if (!isDefaultAttribute(key)) {
             m_attributes.remove(key);
             m_protectedAttributes.remove(key);
+            m_encryptedValues.remove(key);
         }
     }
 
     const QList<QString> otherKeyList = other->keys();
     for (const QString& key : otherKeyList) {
         if (!isDefaultAttribute(key)) {
-            m_attributes.insert(key, other->value(key));
+            m_attributes.insert(key, other->m_attributes.value(key));
             if (other->isProtected(key)) {
                 m_protectedAttributes.insert(key);
             }
+            if (other->m_encryptedValues.contains(key)) {
+                m_encryptedValues.insert(key, other->m_encryptedValues.value(key));
+            }
         }
     }
+    m_attributesSize = -1;
 
     emit reset();
     emitModified();
@@ -263,12 +349,38 @@ void EntryAttributes::copyDataFrom(const EntryAttributes* other)
 
         m_attributes = other->m_attributes;
         m_protectedAttributes = other->m_protectedAttributes;
+        m_encryptedValues = other->m_encryptedValues;
+        m_attributesSize = other->m_attributesSize;
 
         emit reset();
         emitModified();
     }
 }
 
+/**
+ * Replace values that are equal to the ones of other with other's implicitly shared copies.
+ * The content does not change, so no signals are emitted. Encrypted values are not shared,
+ * their placeholders are all empty.
+ */
+void EntryAttributes::shareDataFrom(const EntryAttributes* other)
+{
+    if (m_attributes.isSharedWith(other->m_attributes)) {
+        return;
+    }
+
+    if (m_attributes == other->m_attributes) {
+        m_attributes = other->m_attributes;
+        return;
+    }
+
+    for (auto it = m_attributes.begin(); it != m_attributes.end(); ++it) {
+        auto otherIt = other->m_attributes.constFind(it.key());
+        if (otherIt != other->m_attributes.constEnd() && otherIt.value() == it.value()) {
+            it.value() = otherIt.value();
+        }
+    }
+}
+
 QUuid EntryAttributes::referenceUuid(const QString& key) const
 {
     if (!m_attributes.contains(key)) {
@@ -287,23 +399,72 @@ QUuid EntryAttributes::referenceUuid(const QString& key) const
     return {};
 }
 
+/**
+ * Collect the uuids of all entries that are referenced by uuid ({REF:<Field>@I:<Uuid>})
+ * from one of the default attributes.
+ */
+QSet<QUuid> EntryAttributes::referencedUuids() const
+{
+    QSet<QUuid> uuids;
+    for (const QString& key : DefaultAttributes) {
+        const QString data = value(key);
+        if (!data.contains(QLatin1String("{REF:"), Qt::CaseInsensitive)) {
+            continue;
+        }
+
+        auto matches = referenceRegExp().globalMatch(data);
+        while (matches.hasNext()) {
+            const auto match = matches.next();
+            if (match.capturedRef(SearchInGroupName).compare(QLatin1String("I"), Qt::CaseInsensitive) != 0) {
+                continue;
+            }
+            const auto uuid = QUuid::fromRfc4122(QByteArray::fromHex(match.captured(SearchTextGroupName).toLatin1()));
+            if (!uuid.isNull()) {
+                uuids.insert(uuid);
+            }
+        }
+    }
+    return uuids;
+}
+
 bool EntryAttributes::operator==(const EntryAttributes& other) const
 {
-    return (m_attributes == other.m_attributes && m_protectedAttributes == other.m_protectedAttributes);
+    if (m_protectedAttributes != other.m_protectedAttributes) {
+        return false;
+    }
+    if (m_encryptedValues.isEmpty() && other.m_encryptedValues.isEmpty()) {
+        return m_attributes == other.m_attributes;
+    }
+    if (m_attributes.size() != other.m_attributes.size()) {
+        return false;
+    }
+
+    for (auto it = m_attributes.constBegin(); it != m_attributes.constEnd(); ++it) {
+        if (!other.m_attributes.contains(it.key())) {
+            return false;
+        }
+        // Values read from the same file compare without being decrypted
+        auto encrypted = m_encryptedValues.constFind(it.key());
+        auto otherEncrypted = other.m_encryptedValues.constFind(it.key());
+        if (encrypted != m_encryptedValues.constEnd() && otherEncrypted != other.m_encryptedValues.constEnd()
+            && *encrypted == *otherEncrypted) {
+            continue;
+        }
+        if (value(it.key()) != other.value(it.key())) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool EntryAttributes::operator!=(const EntryAttributes& other) const
 {
-    return (m_attributes != other.m_attributes || m_protectedAttributes != other.m_protectedAttributes);
+    return !(*this == other);
 }
 
 QRegularExpressionMatch EntryAttributes::matchReference(const QString& text)
 {
-    static QRegularExpression referenceRegExp(
-        "\\{REF:(?<WantedField>[TUPANI])@(?<SearchIn>[TUPANIO]):(?<SearchText>[^}]+)\\}",
-        QRegularExpression::CaseInsensitiveOption);
-
-    return referenceRegExp.match(text);
+    return referenceRegExp().match(text);
 }
 
 void EntryAttributes::clear()
@@ -312,10 +473,12 @@ void EntryAttributes::clear()
 
     m_attributes.clear();
     m_protectedAttributes.clear();
+    m_encryptedValues.clear();
 
     for (const QString& key : DefaultAttributes) {
         m_attributes.insert(key, "");
     }
+    m_attributesSize = -1;
 
     emit reset();
     emitModified();
@@ -323,9 +486,35 @@ void EntryAttributes::clear()
 
 int EntryAttributes::attributesSize() const
 {
-    int size = 0;
+    if (m_attributesSize < 0) {
+        int size = 0;
+        for (auto it = m_attributes.constBegin(); it != m_attributes.constEnd(); ++it) {
+            size += it.key().toUtf8().size() + it.value().toUtf8().size();
+        }
+        // The ciphertext is as long as the UTF-8 value
+        for (const ProtectedValue& value : m_encryptedValues) {
+            size += value.size();
+        }
+        m_attributesSize = size;
+    }
+    return m_attributesSize;
+}
+
+/**
+ * Estimate the heap memory held by the attributes. Keys and values shared
+ * with other objects are counted once, they are added to seen.
+ */
+qint64 EntryAttributes::memoryUsage(QSet<const void*>& seen) const
+{
+    qint64 size = m_attributes.size() * (MemoryUsage::NodeOverhead + qint64(sizeof(void*) + 2 * sizeof(QString)));
     for (auto it = m_attributes.constBegin(); it != m_attributes.constEnd(); ++it) {
-        size += it.key().toUtf8().size() + it.value().toUtf8().size();
+        size += MemoryUsage::sharedHeapSize(it.key(), seen) + MemoryUsage::sharedHeapSize(it.value(), seen);
+    }
+    size += m_protectedAttributes.capacity() * qint64(sizeof(void*))
+            + m_protectedAttributes.size() * (MemoryUsage::NodeOverhead + qint64(sizeof(QString)));
+    for (const auto& value : m_encryptedValues) {
+        // The ciphertext is as long as the UTF-8 value
+        size += MemoryUsage::NodeOverhead + qint64(sizeof(QString) + sizeof(ProtectedValue)) + value.size();
     }
     return size;
 }
@@ -22,8 +22,10 @@
 #include <QMap>
 #include <QObject>
 #include <QSet>
+#include <QUuid>
 
 #include "core/ModifiableObject.h"
+#include "core/ProtectedValue.h"
 
 class EntryAttributes : public ModifiableObject
 {
@@ -42,14 +44,18 @@ public:
     bool isProtected(const QString& key) const;
     bool isReference(const QString& key) const;
     void set(const QString& key, const QString& value, bool protect = false);
+    void setEncrypted(const QString& key, const ProtectedValue& value);
     void remove(const QString& key);
     void rename(const QString& oldKey, const QString& newKey);
     void copyCustomKeysFrom(const EntryAttributes* other);
     bool areCustomKeysDifferent(const EntryAttributes* other);
     void clear();
     int attributesSize() const;
+    qint64 memoryUsage(QSet<const void*>& seen) const;
     void copyDataFrom(const EntryAttributes* other);
+    void shareDataFrom(const EntryAttributes* other);
     QUuid referenceUuid(const QString& key) const;
+    QSet<QUuid> referencedUuids() const;
     bool operator==(const EntryAttributes& other) const;
     bool operator!=(const EntryAttributes& other) const;
 
@@ -86,6 +92,11 @@ signals:
 private:
     QMap<QString, QString> m_attributes;
     QSet<QString> m_protectedAttributes;
+    // Protected values still encrypted with the inner stream of the file they
+    // were read from, m_attributes holds an empty placeholder for them
+    QHash<QString, ProtectedValue> m_encryptedValues;
+    // Cached result of attributesSize(), -1 if it needs to be recomputed
+    mutable int m_attributesSize = -1;
 };
 
 #endif // KEEPASSX_ENTRYATTRIBUTES_H
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntryPasskeyIndex.h"
+
+#include "core/Entry.h"
+#include "core/MemoryUsage.h"
+
+namespace
+{
+    void removeFrom(QHash<QString, QSet<const Entry*>>& index, const QString& key, const Entry* entry)
+    {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return;
+        }
+        it->remove(entry);
+        if (it->isEmpty()) {
+            index.erase(it);
+        }
+    }
+} // namespace
+
+void EntryPasskeyIndex::clear()
+{
+    m_relyingParties.clear();
+    m_credentials.clear();
+    m_entryKeys.clear();
+}
+
+void EntryPasskeyIndex::addEntry(const Entry* entry)
+{
+    removeEntry(entry);
+
+    const auto* attributes = entry->attributes();
+    if (!attributes->hasPasskey()) {
+        return;
+    }
+
+    // Same attribute names as BrowserPasskeys, which is not part of the core library
+    const auto prefix = EntryAttributes::PasskeyAttribute;
+    const auto generatedUserIdKey = prefix + QStringLiteral("_GENERATED_USER_ID");
+
+    Keys keys;
+    keys.rpId = attributes->value(prefix + QStringLiteral("_RELYING_PARTY"));
+    keys.credentialId = attributes->hasKey(generatedUserIdKey)
+                            ? attributes->value(generatedUserIdKey)
+                            : attributes->value(prefix + QStringLiteral("_CREDENTIAL_ID"));
+    if (keys.rpId.isEmpty() && keys.credentialId.isEmpty()) {
+        return;
+    }
+
+    if (!keys.rpId.isEmpty()) {
+        m_relyingParties[keys.rpId].insert(entry);
+    }
+    if (!keys.credentialId.isEmpty()) {
+        m_credentials[keys.credentialId].insert(entry);
+    }
+    m_entryKeys.insert(entry, keys);
+}
+
+void EntryPasskeyIndex::removeEntry(const Entry* entry)
+{
+    auto it = m_entryKeys.find(entry);
+    if (it == m_entryKeys.end()) {
+        return;
+    }
+
+    removeFrom(m_relyingParties, it->rpId, entry);
+    removeFrom(m_credentials, it->credentialId, entry);
+    m_entryKeys.erase(it);
+}
+
+QSet<const Entry*> EntryPasskeyIndex::entriesForRelyingParty(const QString& rpId) const
+{
+    return m_relyingParties.value(rpId);
+}
+
+QSet<const Entry*> EntryPasskeyIndex::entriesForCredential(const QString& credentialId) const
+{
+    return m_credentials.value(credentialId);
+}
+
+qint64 EntryPasskeyIndex::memoryUsage() const
+{
+    qint64 size = MemoryUsage::heapSize(m_relyingParties) + MemoryUsage::heapSize(m_credentials);
+    size += m_entryKeys.capacity() * qint64(sizeof(void*))
+            + m_entryKeys.size() * (MemoryUsage::NodeOverhead + qint64(sizeof(const Entry*) + sizeof(Keys)));
+    for (const auto& keys : m_entryKeys) {
+        size += MemoryUsage::heapSize(keys.rpId) + MemoryUsage::heapSize(keys.credentialId);
+    }
+    return size;
+}
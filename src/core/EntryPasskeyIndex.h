@@ -0,0 +1,56 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ENTRYPASSKEYINDEX_H
+#define KEEPASSXC_ENTRYPASSKEYINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+class Entry;
+
+/**
+ * Index of passkey entries by relying party and by credential ID.
+ *
+ * The credential ID of an entry is its generated user ID when present, like
+ * PasskeyUtils::getCredentialIdFromEntry(), and its stored credential ID otherwise.
+ */
+class EntryPasskeyIndex
+{
+public:
+    void clear();
+    void addEntry(const Entry* entry);
+    void removeEntry(const Entry* entry);
+    qint64 memoryUsage() const;
+
+    QSet<const Entry*> entriesForRelyingParty(const QString& rpId) const;
+    QSet<const Entry*> entriesForCredential(const QString& credentialId) const;
+
+private:
+    struct Keys
+    {
+        QString rpId;
+        QString credentialId;
+    };
+
+    QHash<QString, QSet<const Entry*>> m_relyingParties;
+    QHash<QString, QSet<const Entry*>> m_credentials;
+    QHash<const Entry*, Keys> m_entryKeys;
+};
+
+#endif // KEEPASSXC_ENTRYPASSKEYINDEX_H
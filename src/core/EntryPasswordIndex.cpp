@@ -0,0 +1,181 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntryPasswordIndex.h"
+
+#include "core/Entry.h"
+#include "core/MemoryUsage.h"
+#include "core/PasswordHealth.h"
+
+#include <algorithm>
+
+void EntryPasswordIndex::clear()
+{
+    m_entries.clear();
+    m_passwordCounts.clear();
+    m_reuse.clear();
+    m_passwordCount = 0;
+    m_shortPasswords = 0;
+    m_totalPasswordLength = 0;
+}
+
+void EntryPasswordIndex::addEntry(const Entry* entry)
+{
+    removeEntry(entry);
+
+    if (entry->isRecycled()) {
+        return;
+    }
+
+    EntryPassword data;
+    data.password = entry->password();
+    data.reference = entry->isAttributeReference(EntryAttributes::PasswordKey);
+    m_entries.insert(entry, data);
+
+    if (data.password.isEmpty()) {
+        return;
+    }
+
+    ++m_passwordCount;
+    ++m_passwordCounts[data.password];
+    m_totalPasswordLength += data.password.size();
+    if (data.password.size() < PasswordHealth::Length::Short) {
+        ++m_shortPasswords;
+    }
+    if (!data.reference) {
+        m_reuse[data.password].append(entry);
+    }
+}
+
+void EntryPasswordIndex::removeEntry(const Entry* entry)
+{
+    auto it = m_entries.find(entry);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    const EntryPassword data = it.value();
+    m_entries.erase(it);
+
+    if (data.password.isEmpty()) {
+        return;
+    }
+
+    --m_passwordCount;
+    auto count = m_passwordCounts.find(data.password);
+    if (count != m_passwordCounts.end() && --count.value() <= 0) {
+        m_passwordCounts.erase(count);
+    }
+    m_totalPasswordLength -= data.password.size();
+    if (data.password.size() < PasswordHealth::Length::Short) {
+        --m_shortPasswords;
+    }
+    if (!data.reference) {
+        auto users = m_reuse.find(data.password);
+        if (users != m_reuse.end()) {
+            users->removeOne(entry);
+            if (users->isEmpty()) {
+                m_reuse.erase(users);
+            }
+        }
+    }
+}
+
+/**
+ * @return all entries outside the recycle bin, in no particular order
+ */
+QList<const Entry*> EntryPasswordIndex::entries() const
+{
+    return m_entries.keys();
+}
+
+/**
+ * @return the entries using the given password, not counting references
+ */
+QList<const Entry*> EntryPasswordIndex::entriesWithPassword(const QString& password) const
+{
+    return m_reuse.value(password);
+}
+
+int EntryPasswordIndex::reuseCount(const QString& password) const
+{
+    auto it = m_reuse.constFind(password);
+    return it == m_reuse.constEnd() ? 0 : it->size();
+}
+
+/**
+ * @return number of entries with a password
+ */
+int EntryPasswordIndex::passwordCount() const
+{
+    return m_passwordCount;
+}
+
+int EntryPasswordIndex::distinctPasswords() const
+{
+    return m_passwordCounts.size();
+}
+
+int EntryPasswordIndex::shortPasswords() const
+{
+    return m_shortPasswords;
+}
+
+/**
+ * @return the highest number of entries sharing the same password
+ */
+int EntryPasswordIndex::maxReuse() const
+{
+    int max = 0;
+    for (const auto& count : m_passwordCounts) {
+        max = std::max(max, count);
+    }
+    return max;
+}
+
+/**
+ * @return the number of passwords shared by the same number of entries, by that number
+ */
+QMap<int, int> EntryPasswordIndex::reuseClusters() const
+{
+    QMap<int, int> clusters;
+    for (const auto& count : m_passwordCounts) {
+        if (count > 1) {
+            ++clusters[count];
+        }
+    }
+    return clusters;
+}
+
+qint64 EntryPasswordIndex::totalPasswordLength() const
+{
+    return m_totalPasswordLength;
+}
+
+qint64 EntryPasswordIndex::memoryUsage() const
+{
+    // The passwords are shared with the entries, only the nodes are counted for them
+    const qint64 entryNode = MemoryUsage::NodeOverhead + qint64(sizeof(const Entry*) + sizeof(EntryPassword));
+    qint64 size = m_entries.capacity() * qint64(sizeof(void*)) + m_entries.size() * entryNode;
+    size += m_passwordCounts.capacity() * qint64(sizeof(void*))
+            + m_passwordCounts.size() * (MemoryUsage::NodeOverhead + qint64(sizeof(QString) + sizeof(int)));
+    for (const auto& entries : m_reuse) {
+        size += MemoryUsage::heapSize(entries);
+    }
+    return size + m_reuse.capacity() * qint64(sizeof(void*))
+           + m_reuse.size() * (MemoryUsage::NodeOverhead + qint64(sizeof(QString) + sizeof(QList<const Entry*>)));
+}
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ENTRYPASSWORDINDEX_H
+#define KEEPASSXC_ENTRYPASSWORDINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+class Entry;
+
+/**
+ * Passwords of all entries outside the recycle bin, kept up to date as
+ * entries change, so that password reuse and the database statistics
+ * are known without walking the tree.
+ *
+ * Entries referencing the password of another entry are counted in the
+ * statistics, but they don't reuse the password they point to.
+ */
+class EntryPasswordIndex
+{
+public:
+    void clear();
+    void addEntry(const Entry* entry);
+    void removeEntry(const Entry* entry);
+    qint64 memoryUsage() const;
+
+    QList<const Entry*> entries() const;
+    QList<const Entry*> entriesWithPassword(const QString& password) const;
+    int reuseCount(const QString& password) const;
+
+    int passwordCount() const;
+    int distinctPasswords() const;
+    int shortPasswords() const;
+    int maxReuse() const;
+    QMap<int, int> reuseClusters() const;
+    qint64 totalPasswordLength() const;
+
+private:
+    struct EntryPassword
+    {
+        QString password;
+        bool reference = false;
+    };
+
+    QHash<const Entry*, EntryPassword> m_entries;
+    QHash<QString, int> m_passwordCounts;
+    QHash<QString, QList<const Entry*>> m_reuse;
+    int m_passwordCount = 0;
+    int m_shortPasswords = 0;
+    qint64 m_totalPasswordLength = 0;
+};
+
+#endif // KEEPASSXC_ENTRYPASSWORDINDEX_H
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntrySearchIndex.h"
+
+#include "core/Entry.h"
+#include "core/MemoryUsage.h"
+
+#include <algorithm>
+
+void EntrySearchIndex::clear()
+{
+    m_postings.clear();
+    m_entryTrigrams.clear();
+    m_unresolved.clear();
+}
+
+void EntrySearchIndex::addEntry(const Entry* entry)
+{
+    removeEntry(entry);
+
+    const QStringList fields{entry->title(), entry->username(), entry->url(), entry->notes()};
+    for (const auto& field : fields) {
+        if (field.contains(QLatin1Char('{'))) {
+            m_unresolved.insert(entry);
+            return;
+        }
+    }
+
+    QSet<quint64> trigrams;
+    for (const auto& field : fields) {
+        addTrigrams(field, trigrams);
+    }
+    const QStringList tags = entry->tagList();
+    for (const auto& tag : tags) {
+        addTrigrams(tag, trigrams);
+    }
+
+    for (const auto trigram : asConst(trigrams)) {
+        m_postings[trigram].insert(entry);
+    }
+    m_entryTrigrams.insert(entry, trigrams);
+}
+
+void EntrySearchIndex::removeEntry(const Entry* entry)
+{
+    if (m_unresolved.remove(entry)) {
+        return;
+    }
+
+    const QSet<quint64> trigrams = m_entryTrigrams.take(entry);
+    for (const auto trigram : trigrams) {
+        auto it = m_postings.find(trigram);
+        if (it == m_postings.end()) {
+            continue;
+        }
+        it->remove(entry);
+        if (it->isEmpty()) {
+            m_postings.erase(it);
+        }
+    }
+}
+
+bool EntrySearchIndex::contains(const Entry* entry) const
+{
+    return m_entryTrigrams.contains(entry) || m_unresolved.contains(entry);
+}
+
+/**
+ * Find all indexed entries that contain every given literal fragment in one of the
+ * indexed fields. Fragments shorter than three characters do not restrict the result.
+ *
+ * @param fragments literal text that must occur in a matching entry
+ * @return superset of the entries containing all fragments
+ */
+QSet<const Entry*> EntrySearchIndex::candidates(const QStringList& fragments) const
+{
+    QSet<quint64> trigrams;
+    for (const auto& fragment : fragments) {
+        addTrigrams(fragment, trigrams);
+    }
+
+    QSet<const Entry*> result;
+    if (trigrams.isEmpty()) {
+        result = m_unresolved;
+        for (auto it = m_entryTrigrams.cbegin(); it != m_entryTrigrams.cend(); ++it) {
+            result.insert(it.key());
+        }
+        return result;
+    }
+
+    QList<const QSet<const Entry*>*> postings;
+    for (const auto trigram : asConst(trigrams)) {
+        auto it = m_postings.constFind(trigram);
+        if (it == m_postings.constEnd()) {
+            return m_unresolved;
+        }
+        postings.append(&it.value());
+    }
+
+    // Intersect starting from the rarest trigram
+    std::sort(postings.begin(), postings.end(), [](const QSet<const Entry*>* lhs, const QSet<const Entry*>* rhs) {
+        return lhs->size() < rhs->size();
+    });
+    result = *postings.first();
+    for (int i = 1; i < postings.size() && !result.isEmpty(); ++i) {
+        result.intersect(*postings.at(i));
+    }
+
+    result.unite(m_unresolved);
+    return result;
+}
+
+void EntrySearchIndex::addTrigrams(const QString& text, QSet<quint64>& trigrams)
+{
+    if (text.size() < 3) {
+        return;
+    }
+
+    const QString folded = text.toCaseFolded();
+    for (int i = 0; i + 2 < folded.size(); ++i) {
+        trigrams.insert(quint64(folded.at(i).unicode()) << 32 | quint64(folded.at(i + 1).unicode()) << 16
+                        | folded.at(i + 2).unicode());
+    }
+}
+
+qint64 EntrySearchIndex::memoryUsage() const
+{
+    return MemoryUsage::heapSize(m_postings) + MemoryUsage::heapSize(m_entryTrigrams)
+           + MemoryUsage::heapSize(m_unresolved);
+}
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ENTRYSEARCHINDEX_H
+#define KEEPASSXC_ENTRYSEARCHINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+class Entry;
+
+/**
+ * Trigram index over the title, username, URL, notes and tags of entries.
+ *
+ * The index only narrows down the entries a search has to look at, every
+ * candidate still needs to be verified against the actual search terms.
+ * Text is case folded, so lookups are valid for case sensitive and case
+ * insensitive searches alike.
+ */
+class EntrySearchIndex
+{
+public:
+    void clear();
+    void addEntry(const Entry* entry);
+    void removeEntry(const Entry* entry);
+    qint64 memoryUsage() const;
+    bool contains(const Entry* entry) const;
+
+    QSet<const Entry*> candidates(const QStringList& fragments) const;
+
+private:
+    static void addTrigrams(const QString& text, QSet<quint64>& trigrams);
+
+    QHash<quint64, QSet<const Entry*>> m_postings;
+    QHash<const Entry*, QSet<quint64>> m_entryTrigrams;
+    // Entries using placeholders in an indexed field, their resolved text is unknown to the index
+    QSet<const Entry*> m_unresolved;
+};
+
+#endif // KEEPASSXC_ENTRYSEARCHINDEX_H
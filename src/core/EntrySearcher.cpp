@@ -19,8 +19,375 @@
 #include "EntrySearcher.h"
 
 #include "PasswordHealth.h"
+#include "core/AttachmentTextIndex.h"
+#include "core/Database.h"
 #include "core/Group.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
+
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    struct RawSearchTerm
+    {
+        QString modifiers;
+        QString field;
+        QString word;
+
+        bool operator==(const RawSearchTerm& other) const
+        {
+            return modifiers == other.modifiers && field == other.field && word == other.word;
+        }
+    };
+
+    /**
+     * Split a search string into its terms without interpreting them.
+     */
+    QList<RawSearchTerm> splitSearchTerms(const QString& searchString)
+    {
+        // Group 1 = modifiers, Group 2 = field, Group 3 = quoted string, Group 4 = unquoted string
+        static QRegularExpression termParser(R"re(([-!*+]+)?(?:(\w*):)?(?:(?=")"((?:[^"\\]|\\.)*)"|([^ ]*))( |$))re");
+
+        QList<RawSearchTerm> terms;
+        auto results = termParser.globalMatch(searchString);
+        while (results.hasNext()) {
+            auto result = results.next();
+            RawSearchTerm term;
+
+            // Quoted string group
+            term.word = result.captured(3);
+            // Unescape quotes
+            term.word.replace("\\\"", "\"");
+
+            // If empty, use the unquoted string group
+            if (term.word.isEmpty()) {
+                term.word = result.captured(4);
+            }
+
+            // If still empty, ignore this match
+            if (term.word.isEmpty()) {
+                continue;
+            }
+
+            term.modifiers = result.captured(1);
+            term.field = result.captured(2);
+            terms.append(term);
+        }
+        return terms;
+    }
+
+    EntrySearcher::Field fieldFromName(const QString& field)
+    {
+        static const QList<QPair<QString, EntrySearcher::Field>> fieldnames{
+            {QStringLiteral("attachment"), EntrySearcher::Field::Attachment},
+            {QStringLiteral("content"), EntrySearcher::Field::AttachmentContent},
+            {QStringLiteral("attribute"), EntrySearcher::Field::AttributeKV},
+            {QStringLiteral("notes"), EntrySearcher::Field::Notes},
+            {QStringLiteral("pw"), EntrySearcher::Field::Password},
+            {QStringLiteral("password"), EntrySearcher::Field::Password},
+            {QStringLiteral("title"), EntrySearcher::Field::Title}, // title before tag to capture t:<word>
+            {QStringLiteral("username"), EntrySearcher::Field::Username}, // username before url to capture u:<word>
+            {QStringLiteral("url"), EntrySearcher::Field::Url},
+            {QStringLiteral("group"), EntrySearcher::Field::Group},
+            {QStringLiteral("tag"), EntrySearcher::Field::Tag},
+            {QStringLiteral("is"), EntrySearcher::Field::Is},
+            {QStringLiteral("uuid"), EntrySearcher::Field::Uuid}};
+
+        if (field.isEmpty()) {
+            return EntrySearcher::Field::Undefined;
+        }
+        if (field.startsWith("_", Qt::CaseInsensitive)) {
+            return EntrySearcher::Field::AttributeValue;
+        }
+        for (const auto& pair : fieldnames) {
+            if (pair.first.startsWith(field, Qt::CaseInsensitive)) {
+                return pair.second;
+            }
+        }
+        return EntrySearcher::Field::Undefined;
+    }
+
+    /**
+     * Check whether every entry matching the current search string also matched
+     * the previous one. This holds when terms were only appended, or when plain
+     * terms were extended at their end, since all terms must match and a longer
+     * substring can only match fewer entries.
+     *
+     * Tags are matched as a whole, so a longer term can match a tag the shorter
+     * one did not. If a term that matches tags was extended, recheckTagged is
+     * set and entries with tags have to be checked again.
+     */
+    bool isRefinement(const QString& previous, const QString& current, bool& recheckTagged)
+    {
+        recheckTagged = false;
+        const auto previousTerms = splitSearchTerms(previous);
+        const auto currentTerms = splitSearchTerms(current);
+        if (previousTerms.isEmpty() || currentTerms.size() < previousTerms.size()) {
+            return false;
+        }
+
+        for (int i = 0; i < previousTerms.size(); ++i) {
+            const auto& before = previousTerms.at(i);
+            const auto& after = currentTerms.at(i);
+
+            // Expiry and password health results change by themselves
+            const auto field = fieldFromName(before.field);
+            if (field == EntrySearcher::Field::Is) {
+                return false;
+            }
+            if (before == after) {
+                continue;
+            }
+
+            // Regex, exact and exclude terms do not narrow down when extended
+            if (!before.modifiers.isEmpty() || !after.modifiers.isEmpty() || before.field != after.field) {
+                return false;
+            }
+            if (!after.word.startsWith(before.word) || after.word.contains('|')) {
+                return false;
+            }
+            // Group terms switch to matching the full hierarchy once they contain a '/'
+            if (field == EntrySearcher::Field::Group && before.word.contains('/') != after.word.contains('/')) {
+                return false;
+            }
+            if (field == EntrySearcher::Field::Tag || field == EntrySearcher::Field::Undefined) {
+                recheckTagged = true;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Check whether the regex matches nothing but the given literal text,
+     * as is the case for search terms without wildcards.
+     *
+     * @param regex regex to inspect
+     * @param text receives the literal text
+     * @param exact receives whether the whole subject has to equal the text
+     * @return true if the regex is a plain literal
+     */
+    bool literalPattern(const QRegularExpression& regex, QString& text, bool& exact)
+    {
+        QString pattern = regex.pattern();
+        exact = pattern.startsWith(QLatin1String("^(?:")) && pattern.endsWith(QLatin1String(")$"));
+        if (exact) {
+            pattern = pattern.mid(4, pattern.size() - 6);
+        }
+        if (pattern.isEmpty()) {
+            return false;
+        }
+
+        static const QString metaCharacters = QStringLiteral("^$.|?*+()[]{}");
+        text.clear();
+        text.reserve(pattern.size());
+        for (int i = 0; i < pattern.size(); ++i) {
+            QChar c = pattern.at(i);
+            if (c == QLatin1Char('\\')) {
+                if (++i >= pattern.size()) {
+                    return false;
+                }
+                c = pattern.at(i);
+                // Escaped ASCII letters and digits are character classes or references
+                if (c.unicode() < 128 && c.isLetterOrNumber()) {
+                    return false;
+                }
+            } else if (metaCharacters.contains(c)) {
+                return false;
+            }
+            text.append(c);
+        }
+        return true;
+    }
+
+    /**
+     * Relative cost of matching a term, cheap terms are checked first.
+     */
+    int fieldCost(const EntrySearcher::SearchTerm& term)
+    {
+        switch (term.field) {
+        case EntrySearcher::Field::Uuid:
+            return 0;
+        case EntrySearcher::Field::Title:
+        case EntrySearcher::Field::Username:
+        case EntrySearcher::Field::Url:
+        case EntrySearcher::Field::Tag:
+            return 1;
+        case EntrySearcher::Field::Group:
+        case EntrySearcher::Field::Password:
+            return 2;
+        case EntrySearcher::Field::Undefined:
+            return 3;
+        case EntrySearcher::Field::Notes:
+        case EntrySearcher::Field::AttributeValue:
+            return 4;
+        case EntrySearcher::Field::AttributeKV:
+        case EntrySearcher::Field::Attachment:
+            return 5;
+        case EntrySearcher::Field::Is:
+            // Password health is computed on demand
+            return term.word.compare("weak", Qt::CaseInsensitive) == 0 ? 6 : 1;
+        case EntrySearcher::Field::AttachmentContent:
+            return 6;
+        default:
+            return 3;
+        }
+    }
+
+    /**
+     * Extract the literal text a match of the given regex must contain.
+     *
+     * Only patterns made of escaped literals, '.' and '.*' (as produced for
+     * plain and wildcard search terms) are understood, anything else returns
+     * false. Non-ASCII characters end a fragment to stay independent of
+     * Unicode case folding rules. Of the escaped letters and digits only the
+     * zero-width assertions are understood, the others (e.g. \x41 or \1)
+     * consume the characters following them.
+     */
+    bool literalFragments(const QRegularExpression& regex, QStringList& fragments)
+    {
+        QString pattern = regex.pattern();
+        if (pattern.startsWith(QLatin1String("^(?:")) && pattern.endsWith(QLatin1String(")$"))) {
+            pattern = pattern.mid(4, pattern.size() - 6);
+        }
+
+        QString current;
+        // Fragments shorter than a trigram cannot be looked up
+        auto flush = [&]() {
+            if (current.size() >= 3) {
+                fragments.append(current);
+            }
+            current.clear();
+        };
+
+        for (int i = 0; i < pattern.size(); ++i) {
+            QChar c = pattern.at(i);
+            if (c == QLatin1Char('\\')) {
+                if (++i >= pattern.size()) {
+                    return false;
+                }
+                c = pattern.at(i);
+                if (c.unicode() < 128 && !c.isLetterOrNumber()) {
+                    current.append(c);
+                } else if (c.unicode() >= 128 || QStringLiteral("bBAzZG").contains(c)) {
+                    flush();
+                } else {
+                    return false;
+                }
+            } else if (c == QLatin1Char('.')) {
+                flush();
+                if (i + 1 < pattern.size() && pattern.at(i + 1) == QLatin1Char('*')) {
+                    ++i;
+                }
+            } else if (c.unicode() >= 128) {
+                flush();
+            } else if (c.isLetterOrNumber() || c == QLatin1Char('_')) {
+                current.append(c);
+            } else {
+                return false;
+            }
+        }
+        flush();
+        return true;
+    }
+    // Edit distance between the strings, anything above maxDistance is reported as maxDistance + 1
+    int editDistance(const QString& lhs, const QString& rhs, int maxDistance)
+    {
+        if (qAbs(lhs.size() - rhs.size()) > maxDistance) {
+            return maxDistance + 1;
+        }
+
+        QVector<int> previous(rhs.size() + 1);
+        QVector<int> current(rhs.size() + 1);
+        for (int j = 0; j <= rhs.size(); ++j) {
+            previous[j] = j;
+        }
+        for (int i = 1; i <= lhs.size(); ++i) {
+            current[0] = i;
+            int rowMinimum = i;
+            for (int j = 1; j <= rhs.size(); ++j) {
+                const int substitution = previous[j - 1] + (lhs[i - 1] == rhs[j - 1] ? 0 : 1);
+                current[j] = qMin(qMin(previous[j], current[j - 1]) + 1, substitution);
+                rowMinimum = qMin(rowMinimum, current[j]);
+            }
+            if (rowMinimum > maxDistance) {
+                return maxDistance + 1;
+            }
+            std::swap(previous, current);
+        }
+        return qMin(previous[rhs.size()], maxDistance + 1);
+    }
+
+    /**
+     * How well text matches value: exactly, as a prefix, at the start of a
+     * word, anywhere, or with a typo in one of its words.
+     *
+     * @return match quality from 0 (no match) to 10 (exact match)
+     */
+    int matchQuality(const QString& value, const QString& text, Qt::CaseSensitivity caseSensitivity)
+    {
+        if (value.isEmpty() || text.isEmpty()) {
+            return 0;
+        }
+        if (value.compare(text, caseSensitivity) == 0) {
+            return 10;
+        }
+        if (value.startsWith(text, caseSensitivity)) {
+            return 8;
+        }
+
+        int quality = 0;
+        for (int pos = value.indexOf(text, 1, caseSensitivity); pos > 0;
+             pos = value.indexOf(text, pos + 1, caseSensitivity)) {
+            if (!value.at(pos - 1).isLetterOrNumber()) {
+                return 6;
+            }
+            quality = 4;
+        }
+        if (quality > 0) {
+            return quality;
+        }
+
+        // Forgive one typo for every four characters
+        const int maxDistance = text.size() / 4;
+        if (maxDistance == 0) {
+            return 0;
+        }
+        const auto fold = [caseSensitivity](const QString& str) {
+            return caseSensitivity == Qt::CaseInsensitive ? str.toCaseFolded() : str;
+        };
+        const QString foldedText = fold(text);
+        int distance = maxDistance + 1;
+        for (int start = 0; start < value.size(); ++start) {
+            if (!value.at(start).isLetterOrNumber()) {
+                continue;
+            }
+            int end = start;
+            while (end < value.size() && value.at(end).isLetterOrNumber()) {
+                ++end;
+            }
+            // Compare the whole word and its start, the word may not be typed completely yet
+            const QString word = fold(value.mid(start, end - start));
+            distance = qMin(distance, editDistance(word, foldedText, maxDistance));
+            if (word.size() > foldedText.size()) {
+                distance = qMin(distance, editDistance(word.left(foldedText.size()), foldedText, maxDistance));
+            }
+            start = end;
+        }
+        return distance <= maxDistance ? qMax(1, 3 - distance) : 0;
+    }
+
+    // Whether matching the entry depends on other entries or the current time
+    bool usesPlaceholders(const Entry* entry)
+    {
+        return entry->title().contains('{') || entry->username().contains('{') || entry->password().contains('{')
+               || entry->url().contains('{');
+    }
+} // namespace
 
 EntrySearcher::EntrySearcher(bool caseSensitive, bool skipProtected)
     : m_caseSensitive(caseSensitive)
@@ -39,6 +406,7 @@ QList<Entry*> EntrySearcher::search(const QList<SearchTerm>& searchTerms, const
 {
     Q_ASSERT(baseGroup);
     m_searchTerms = searchTerms;
+    compilePlan();
     return repeat(baseGroup, forceSearch);
 }
 
@@ -54,34 +422,312 @@ QList<Entry*> EntrySearcher::search(const QList<SearchTerm>& searchTerms, const
 QList<Entry*> EntrySearcher::search(const QString& searchString, const Group* baseGroup, bool forceSearch)
 {
     Q_ASSERT(baseGroup);
-    parseSearchTerms(searchString);
-    return repeat(baseGroup, forceSearch);
+    const auto results = repeatEntries(beginSearch(searchString, baseGroup, forceSearch));
+    finishSearch(results);
+    return results;
 }
 
 /**
- * Repeat the last search starting from the given group
+ * Start a search by string that is carried out in steps by the caller:
+ * pass the returned entries, in as many chunks as desired and in order,
+ * to repeatEntries() and hand all matches to finishSearch() once done.
+ * A search that is abandoned half way must simply not be finished.
+ *
+ * The returned entries are only valid as long as the database content
+ * does not change, see Database::contentRevision().
  *
+ * @param searchString search terms
  * @param baseGroup group to start search from, cannot be null
  * @param forceSearch ignore group search settings
- * @return list of entries that match the search terms
+ * @return entries that need to be checked against the search terms
  */
-QList<Entry*> EntrySearcher::repeat(const Group* baseGroup, bool forceSearch)
+QList<Entry*> EntrySearcher::beginSearch(const QString& searchString, const Group* baseGroup, bool forceSearch)
 {
     Q_ASSERT(baseGroup);
+    parseSearchTerms(searchString);
+
+    // While typing, every keystroke usually only narrows down the previous search
+    const Database* db = baseGroup->database();
+    bool recheckTagged = false;
+    const bool refine = db && m_lastSearch.finished && m_lastSearch.database == db
+                        && m_lastSearch.revision == db->contentRevision() && m_lastSearch.baseGroup == baseGroup
+                        && m_lastSearch.forceSearch == forceSearch && m_lastSearch.caseSensitive == m_caseSensitive
+                        && isRefinement(m_lastSearch.searchString, searchString, recheckTagged);
+
+    QList<Entry*> entries;
+    if (!refine) {
+        entries = candidates(baseGroup, forceSearch);
+    } else if (!recheckTagged) {
+        entries = m_lastSearch.results;
+    } else {
+        // Previous results and entries that may now match by one of their tags, in tree order
+        const auto previous = m_lastSearch.results.toSet();
+        for (const auto entry : candidates(baseGroup, forceSearch)) {
+            if (previous.contains(entry) || !entry->tags().isEmpty()) {
+                entries.append(entry);
+            }
+        }
+    }
+
+    m_lastSearch.searchString = searchString;
+    m_lastSearch.results.clear();
+    m_lastSearch.finished = false;
+    m_lastSearch.database = db;
+    m_lastSearch.revision = db ? db->contentRevision() : 0;
+    m_lastSearch.baseGroup = baseGroup;
+    m_lastSearch.forceSearch = forceSearch;
+    m_lastSearch.caseSensitive = m_caseSensitive;
+
+    return entries;
+}
+
+/**
+ * Complete a search started with beginSearch(), allowing the next search
+ * to build upon its results.
+ *
+ * @param results all entries that matched the search terms
+ */
+void EntrySearcher::finishSearch(const QList<Entry*>& results)
+{
+    m_lastSearch.results = results;
+    m_lastSearch.finished = true;
+}
 
+/**
+ * Search the same way as search(), but keep the results to bring them up to
+ * date on the next call with the same search string. Only the entries that
+ * changed since then, or whose fields use placeholders, are matched again.
+ * Meant for saved searches and tags which are selected over and over again.
+ */
+QList<Entry*> EntrySearcher::searchCached(const QString& searchString, const Group* baseGroup, bool forceSearch)
+{
+    Q_ASSERT(baseGroup);
+    parseSearchTerms(searchString);
+
+    // Expiry depends on the current time, the results can't be maintained
+    const Database* db = baseGroup->database();
+    const bool cacheable = db && std::none_of(m_searchTerms.cbegin(), m_searchTerms.cend(), [](const SearchTerm& term) {
+                               return term.field == Field::Is;
+                           });
+    if (!cacheable) {
+        return repeat(baseGroup, forceSearch);
+    }
+
+    QSet<const Entry*> changed;
+    auto it = m_cachedSearches.find(searchString);
+    const bool hit = it != m_cachedSearches.end() && it->database == db && it->baseGroup == baseGroup
+                     && it->forceSearch == forceSearch && it->caseSensitive == m_caseSensitive
+                     && db->changedEntriesSince(it->changeCursor, changed);
+    db->counters().recordSearchCacheLookup(hit);
+    if (!hit) {
+        if (it == m_cachedSearches.end() && m_cachedSearches.size() >= MaxCachedSearches) {
+            m_cachedSearches.clear();
+        }
+        it = m_cachedSearches.insert(searchString, CachedSearch());
+        it->database = db;
+        it->baseGroup = baseGroup;
+        it->forceSearch = forceSearch;
+        it->caseSensitive = m_caseSensitive;
+    }
+
+    auto& cached = *it;
+    cached.changeCursor = db->entryChangeCursor();
+    for (const auto entry : asConst(changed)) {
+        cached.evaluated.remove(entry);
+        cached.matched.remove(entry);
+        cached.placeholders.remove(entry);
+    }
+
+    // Walking the tree keeps the results in order and picks up entries of
+    // groups that were excluded from searching before
     QList<Entry*> results;
-    for (const auto group : baseGroup->groupsRecursive(true)) {
-        if (forceSearch || group->resolveSearchingEnabled()) {
-            for (const auto entry : group->entries()) {
-                if (searchEntryImpl(entry)) {
-                    results.append(entry);
-                }
+    for (const auto entry : candidates(baseGroup, forceSearch)) {
+        if (!cached.evaluated.contains(entry) || cached.placeholders.contains(entry)) {
+            cached.evaluated.insert(entry);
+            if (usesPlaceholders(entry)) {
+                cached.placeholders.insert(entry);
             }
+            if (searchEntryImpl(entry)) {
+                cached.matched.insert(entry);
+            } else {
+                cached.matched.remove(entry);
+            }
+        }
+        if (cached.matched.contains(entry)) {
+            results.append(entry);
+        }
+    }
+    return results;
+}
+
+void EntrySearcher::clearCachedSearches()
+{
+    m_cachedSearches.clear();
+}
+
+/**
+ * Search and order the results by relevance, best match first. Plain words
+ * searched in the title, username or url are scored by how well they match
+ * and may contain typos, all other terms have to match as usual.
+ *
+ * @param searchString search string
+ * @param baseGroup group to search in
+ * @param limit maximum number of results to keep, 0 for all of them
+ * @param forceSearch also search groups excluded from searching
+ * @return matching entries and their scores, ties in tree order
+ */
+QList<EntrySearcher::ScoredEntry>
+EntrySearcher::searchRanked(const QString& searchString, const Group* baseGroup, int limit, bool forceSearch)
+{
+    Q_ASSERT(baseGroup);
+    parseSearchTerms(searchString);
+
+    QList<PlannedTerm> ranked;
+    QList<PlannedTerm> required;
+    for (const auto& planned : asConst(m_plan)) {
+        const auto field = planned.term.field;
+        const bool rankable = planned.literal && !planned.exact && !planned.term.exclude
+                              && (field == Field::Undefined || field == Field::Title || field == Field::Username
+                                  || field == Field::Url);
+        (rankable ? ranked : required).append(planned);
+    }
+
+    struct Candidate
+    {
+        int score;
+        int order;
+        Entry* entry;
+    };
+    const auto better = [](const Candidate& lhs, const Candidate& rhs) {
+        return lhs.score != rhs.score ? lhs.score > rhs.score : lhs.order < rhs.order;
+    };
+
+    // Heap ordered by `better`, its front is the worst result kept so far
+    std::vector<Candidate> heap;
+    int order = 0;
+    // Misspelled words aren't in the index
+    for (const auto entry : candidates(baseGroup, forceSearch, ranked.isEmpty())) {
+        ResolvedFields fields(entry);
+        if ((!required.isEmpty() || ranked.isEmpty()) && !matchEntry(required, fields)) {
+            continue;
         }
+        const int score = rankEntry(ranked, fields);
+        if (score < 0) {
+            continue;
+        }
+
+        const Candidate candidate{score, order++, entry};
+        if (limit <= 0 || static_cast<int>(heap.size()) < limit) {
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(candidate, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = candidate;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), better);
+
+    QList<ScoredEntry> results;
+    results.reserve(static_cast<int>(heap.size()));
+    for (const auto& candidate : heap) {
+        results.append({candidate.entry, candidate.score});
     }
     return results;
 }
 
+/**
+ * Search several databases at once and merge the results by relevance.
+ * Results with the same score stay grouped by database, in the order of
+ * the databases.
+ *
+ * The databases are searched concurrently in their read snapshots, which
+ * keep their indexes until the database changes, so repeated searches
+ * only pay for the matching. Must be called on the thread owning the
+ * databases. Like the single group search, the search terms are kept for
+ * repeating the search.
+ *
+ * @param searchString search string
+ * @param databases databases to search in their root group
+ * @param limit maximum number of results to keep, 0 for all of them
+ * @param forceSearch also search groups excluded from searching
+ * @return matching entries of the given databases and their scores
+ */
+QList<EntrySearcher::ScoredEntry> EntrySearcher::searchRanked(const QString& searchString,
+                                                              const QList<QSharedPointer<Database>>& databases,
+                                                              int limit,
+                                                              bool forceSearch)
+{
+    TRACE_SCOPE("EntrySearcher::searchRanked");
+    parseSearchTerms(searchString);
+
+    QList<QSharedPointer<Database>> searched;
+    for (const auto& db : databases) {
+        if (db && db->rootGroup()) {
+            searched.append(db);
+        }
+    }
+    if (searched.size() == 1) {
+        return searchRanked(searchString, searched.first()->rootGroup(), limit, forceSearch);
+    }
+
+    struct Search
+    {
+        QSharedPointer<const Database> snapshot;
+        QList<ScoredEntry> results;
+    };
+    QVector<Search> searches;
+    for (const auto& db : asConst(searched)) {
+        searches.append({db->readSnapshot(), {}});
+    }
+
+    QtConcurrent::blockingMap(searches, [&](Search& search) {
+        EntrySearcher searcher(m_caseSensitive, m_skipProtected);
+        search.results = searcher.searchRanked(searchString, search.snapshot->rootGroup(), limit, forceSearch);
+    });
+
+    // Find the entries of the databases the snapshot entries are copies of
+    QList<ScoredEntry> found;
+    for (int i = 0; i < searched.size(); ++i) {
+        QHash<QUuid, int> indexes;
+        for (const auto& result : asConst(searches[i].results)) {
+            indexes.insert(result.entry->uuid(), found.size());
+            found.append({nullptr, result.score});
+        }
+        if (indexes.isEmpty()) {
+            continue;
+        }
+        searched[i]->rootGroup()->forEachEntryRecursive([&](Entry* entry) {
+            auto it = indexes.constFind(entry->uuid());
+            if (it != indexes.constEnd()) {
+                found[it.value()].entry = entry;
+            }
+        });
+    }
+    found.erase(std::remove_if(found.begin(), found.end(), [](const ScoredEntry& result) { return !result.entry; }),
+                found.end());
+
+    std::stable_sort(
+        found.begin(), found.end(), [](const auto& lhs, const auto& rhs) { return lhs.score > rhs.score; });
+    if (limit > 0 && found.size() > limit) {
+        found.erase(found.begin() + limit, found.end());
+    }
+    return found;
+}
+
+/**
+ * Repeat the last search starting from the given group
+ *
+ * @param baseGroup group to start search from, cannot be null
+ * @param forceSearch ignore group search settings
+ * @return list of entries that match the search terms
+ */
+QList<Entry*> EntrySearcher::repeat(const Group* baseGroup, bool forceSearch)
+{
+    Q_ASSERT(baseGroup);
+    return repeatEntries(candidates(baseGroup, forceSearch));
+}
+
 /**
  * Search provided entries by the provided search terms
  *
@@ -92,6 +738,7 @@ QList<Entry*> EntrySearcher::repeat(const Group* baseGroup, bool forceSearch)
 QList<Entry*> EntrySearcher::searchEntries(const QList<SearchTerm>& searchTerms, const QList<Entry*>& entries)
 {
     m_searchTerms = searchTerms;
+    compilePlan();
     return repeatEntries(entries);
 }
 
@@ -117,6 +764,17 @@ QList<Entry*> EntrySearcher::searchEntries(const QString& searchString, const QL
  */
 QList<Entry*> EntrySearcher::repeatEntries(const QList<Entry*>& entries)
 {
+    TRACE_SCOPE("EntrySearcher::search");
+    TRACE_COUNTER("searched entries", entries.size());
+    // Expiry and password health checks are not safe to run on other threads
+    const bool parallel = entries.size() >= ParallelShardSize * 2 && QThreadPool::globalInstance()->maxThreadCount() > 1
+                          && std::none_of(m_plan.cbegin(), m_plan.cend(), [](const PlannedTerm& planned) {
+                                 return planned.term.field == Field::Is;
+                             });
+    if (parallel) {
+        return repeatEntriesParallel(entries);
+    }
+
     QList<Entry*> results;
     for (auto* entry : entries) {
         if (searchEntryImpl(entry)) {
@@ -141,64 +799,252 @@ bool EntrySearcher::isCaseSensitive() const
     return m_caseSensitive;
 }
 
-bool EntrySearcher::searchEntryImpl(const Entry* entry)
+/**
+ * Collect the entries below the given group that need to be checked
+ * against the current search terms, in tree order.
+ */
+QList<Entry*> EntrySearcher::candidates(const Group* baseGroup, bool forceSearch, bool useIndex) const
+{
+    // Narrow down the entries to check using the database search index
+    QSet<const Entry*> indexed;
+    useIndex = useIndex && indexCandidates(baseGroup, indexed);
+
+    QList<Entry*> entries;
+    baseGroup->forEachGroupRecursive([&](const Group* group) {
+        if (forceSearch || group->resolveSearchingEnabled()) {
+            for (const auto entry : group->entries()) {
+                if (!useIndex || indexed.contains(entry)) {
+                    entries.append(entry);
+                }
+            }
+        }
+    });
+    return entries;
+}
+
+/**
+ * Collect the entries that may satisfy all text search terms from the search
+ * index of the database containing the base group.
+ *
+ * @param baseGroup group the search starts from
+ * @param candidates entries that still need to be checked
+ * @return false if the index cannot narrow down the search
+ */
+bool EntrySearcher::indexCandidates(const Group* baseGroup, QSet<const Entry*>& candidates) const
+{
+    const Database* db = baseGroup->database();
+    if (!db || !db->rootGroup()) {
+        return false;
+    }
+
+    // The index only covers the current tree of the database
+    const Group* root = baseGroup;
+    while (root->parentGroup()) {
+        root = root->parentGroup();
+    }
+    if (root != db->rootGroup()) {
+        return false;
+    }
+
+    bool restricted = false;
+    for (const auto& term : m_searchTerms) {
+        if (term.exclude) {
+            continue;
+        }
+        switch (term.field) {
+        case Field::Undefined:
+        case Field::Title:
+        case Field::Username:
+        case Field::Url:
+        case Field::Notes:
+        case Field::Tag:
+            break;
+        default:
+            continue;
+        }
+
+        QStringList fragments;
+        if (!literalFragments(term.regex, fragments) || fragments.isEmpty()) {
+            continue;
+        }
+
+        auto termCandidates = db->searchIndex().candidates(fragments);
+        if (restricted) {
+            candidates.intersect(termCandidates);
+        } else {
+            candidates = termCandidates;
+            restricted = true;
+        }
+    }
+
+    return restricted;
+}
+
+/**
+ * Placeholder resolved values of the fields a search may look at. Values
+ * are resolved on first use, or all at once by resolve() and caseFolded()
+ * so that other threads can match the entry without touching its caches.
+ */
+struct EntrySearcher::ResolvedFields
 {
-    // Pre-load in case they are needed
-    auto attributes_keys = entry->attributes()->customKeys();
-    auto attributes = QStringList(attributes_keys + entry->attributes()->values(attributes_keys));
-    auto attachments = QStringList(entry->attachments()->keys());
-    // Build a group hierarchy to allow searching for e.g. /group1/subgroup*
-    QString hierarchy;
-    if (entry->group()) {
-        hierarchy = entry->group()->hierarchy().join('/').prepend("/");
+    enum Field
+    {
+        Title,
+        Username,
+        Password,
+        Url,
+        FieldCount
+    };
+
+    explicit ResolvedFields(const Entry* entry = nullptr)
+        : entry(entry)
+    {
     }
 
+    void resolve(Field field)
+    {
+        if (resolved[field]) {
+            return;
+        }
+        switch (field) {
+        case Title:
+            values[field] = entry->resolvePlaceholder(entry->title());
+            break;
+        case Username:
+            values[field] = entry->resolvePlaceholder(entry->username());
+            break;
+        case Password:
+            values[field] = entry->resolvePlaceholder(entry->password());
+            break;
+        default:
+            values[field] = entry->resolvePlaceholder(entry->url());
+            break;
+        }
+        resolved[field] = true;
+    }
+
+    const QString& value(Field field)
+    {
+        resolve(field);
+        return values[field];
+    }
+
+    const Entry::CaseFoldedFields& caseFolded()
+    {
+        if (!caseFoldedFields) {
+            caseFoldedFields = &entry->caseFoldedFields();
+        }
+        return *caseFoldedFields;
+    }
+
+    // Case-folded value of the field, or nullptr if it isn't cached
+    const QString* folded(Entry::CaseFoldedFields::Field field)
+    {
+        const auto& fields = caseFolded();
+        return fields.folded[field] ? &fields.values[field] : nullptr;
+    }
+
+    const Entry* entry;
+    const Entry::CaseFoldedFields* caseFoldedFields = nullptr;
+    QString values[FieldCount];
+    bool resolved[FieldCount] = {};
+};
+
+bool EntrySearcher::searchEntryImpl(const Entry* entry)
+{
+    ResolvedFields fields(entry);
+    return matchEntry(m_plan, fields);
+}
+
+bool EntrySearcher::matchEntry(const QList<PlannedTerm>& plan, ResolvedFields& fields) const
+{
+    const Entry* entry = fields.entry;
+
     // By default, empty term matches every entry.
     // However when skipping protected fields, we will reject everything instead
     bool found = !m_skipProtected;
-    for (const auto& term : m_searchTerms) {
+    for (const auto& planned : plan) {
+        const auto& term = planned.term;
+        // Case insensitive literal terms are compared against the case-folded fields when cached
+        const auto matchesField = [&](ResolvedFields::Field field, Entry::CaseFoldedFields::Field foldedField) {
+            const QString* folded = planned.foldable ? fields.folded(foldedField) : nullptr;
+            return folded ? planned.matchesFolded(*folded) : planned.matches(fields.value(field));
+        };
+        const auto matchesNotes = [&]() {
+            const QString* folded = planned.foldable ? fields.folded(Entry::CaseFoldedFields::Notes) : nullptr;
+            return folded ? planned.matchesFolded(*folded) : planned.matches(entry->notes());
+        };
+        const auto matchesTags = [&]() {
+            return planned.foldable ? planned.matchesAnyFoldedExactly(fields.caseFolded().tags)
+                                    : planned.matchesAnyExactly(entry->tagList());
+        };
         switch (term.field) {
         case Field::Title:
-            found = term.regex.match(entry->resolvePlaceholder(entry->title())).hasMatch();
+            found = matchesField(ResolvedFields::Title, Entry::CaseFoldedFields::Title);
             break;
         case Field::Username:
-            found = term.regex.match(entry->resolvePlaceholder(entry->username())).hasMatch();
+            found = matchesField(ResolvedFields::Username, Entry::CaseFoldedFields::Username);
             break;
         case Field::Password:
             if (m_skipProtected) {
                 continue;
             }
-            found = term.regex.match(entry->resolvePlaceholder(entry->password())).hasMatch();
+            found = planned.matches(fields.value(ResolvedFields::Password));
             break;
         case Field::Url:
-            found = term.regex.match(entry->resolvePlaceholder(entry->url())).hasMatch();
+            found = matchesField(ResolvedFields::Url, Entry::CaseFoldedFields::Url);
             break;
         case Field::Notes:
-            found = term.regex.match(entry->notes()).hasMatch();
+            found = matchesNotes();
             break;
-        case Field::AttributeKV:
-            found = !attributes.filter(term.regex).empty();
+        case Field::AttributeKV: {
+            const auto attributesKeys = entry->attributes()->customKeys();
+            const auto attributes = QStringList(attributesKeys + entry->attributes()->values(attributesKeys));
+            found = planned.matchesAny(attributes);
             break;
+        }
         case Field::Attachment:
-            found = !attachments.filter(term.regex).empty();
+            found = planned.matchesAny(entry->attachments()->keys());
+            break;
+        case Field::AttachmentContent: {
+            // Attachments the index can't rule out are decoded on the spot
+            const auto db = entry->database();
+            const auto index = db && db->attachmentTextIndex()->isEnabled() ? db->attachmentTextIndex() : nullptr;
+            const auto attachments = entry->attachments();
+            found = false;
+            for (const auto& key : attachments->keys()) {
+                if (index && !index->mayContain(attachments->hash(key), planned.fragments)) {
+                    continue;
+                }
+                if (planned.matches(AttachmentTextIndex::extractText(attachments->value(key)))) {
+                    found = true;
+                    break;
+                }
+            }
             break;
+        }
         case Field::AttributeValue:
             if (m_skipProtected && entry->attributes()->isProtected(term.word)) {
                 continue;
             }
             found = entry->attributes()->contains(term.word)
-                    && term.regex.match(entry->attributes()->value(term.word)).hasMatch();
+                    && planned.matches(entry->attributes()->value(term.word));
             break;
         case Field::Group:
             // Match against the full hierarchy if the word contains a '/' otherwise just the group name
             if (term.word.contains('/')) {
-                found = term.regex.match(hierarchy).hasMatch();
+                // Build a group hierarchy to allow searching for e.g. /group1/subgroup*
+                QString hierarchy;
+                if (entry->group()) {
+                    hierarchy = entry->group()->hierarchy().join('/').prepend("/");
+                }
+                found = planned.matches(hierarchy);
             } else if (entry->group()) {
-                found = term.regex.match(entry->group()->name()).hasMatch();
+                found = planned.matches(entry->group()->name());
             }
             break;
         case Field::Tag:
-            found = entry->tagList().indexOf(term.regex) != -1;
+            found = matchesTags();
             break;
         case Field::Is:
             if (term.word.startsWith("expired", Qt::CaseInsensitive)) {
@@ -222,14 +1068,14 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
             found = false;
             break;
         case Field::Uuid:
-            found = term.regex.match(entry->uuidToHex()).hasMatch();
+            found = planned.matches(entry->uuidToHex());
             break;
         default:
             // Terms without a specific field try to match title, username, url, and notes
-            found = term.regex.match(entry->resolvePlaceholder(entry->title())).hasMatch()
-                    || term.regex.match(entry->resolvePlaceholder(entry->username())).hasMatch()
-                    || term.regex.match(entry->resolvePlaceholder(entry->url())).hasMatch()
-                    || entry->tagList().indexOf(term.regex) != -1 || term.regex.match(entry->notes()).hasMatch();
+            found = matchesField(ResolvedFields::Title, Entry::CaseFoldedFields::Title)
+                    || matchesField(ResolvedFields::Username, Entry::CaseFoldedFields::Username)
+                    || matchesField(ResolvedFields::Url, Entry::CaseFoldedFields::Url) || matchesTags()
+                    || matchesNotes();
         }
 
         // negate the result if exclude:
@@ -246,82 +1092,241 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
     return found;
 }
 
-void EntrySearcher::parseSearchTerms(const QString& searchString)
+/**
+ * Score of the entry for the ranked terms, -1 if one of them doesn't match.
+ * Terms are weighted by the field they match best in.
+ */
+int EntrySearcher::rankEntry(const QList<PlannedTerm>& ranked, ResolvedFields& fields) const
 {
-    static const QList<QPair<QString, Field>> fieldnames{
-        {QStringLiteral("attachment"), Field::Attachment},
-        {QStringLiteral("attribute"), Field::AttributeKV},
-        {QStringLiteral("notes"), Field::Notes},
-        {QStringLiteral("pw"), Field::Password},
-        {QStringLiteral("password"), Field::Password},
-        {QStringLiteral("title"), Field::Title}, // title before tag to capture t:<word>
-        {QStringLiteral("username"), Field::Username}, // username before url to capture u:<word>
-        {QStringLiteral("url"), Field::Url},
-        {QStringLiteral("group"), Field::Group},
-        {QStringLiteral("tag"), Field::Tag},
-        {QStringLiteral("is"), Field::Is},
-        {QStringLiteral("uuid"), Field::Uuid}};
-
-    // Group 1 = modifiers, Group 2 = field, Group 3 = quoted string, Group 4 = unquoted string
-    static QRegularExpression termParser(R"re(([-!*+]+)?(?:(\w*):)?(?:(?=")"((?:[^"\\]|\\.)*)"|([^ ]*))( |$))re");
+    int score = 0;
+    for (const auto& planned : ranked) {
+        const auto field = planned.term.field;
+        const auto quality = [&](ResolvedFields::Field resolvedField) {
+            return matchQuality(fields.value(resolvedField), planned.text, planned.caseSensitivity);
+        };
 
-    m_searchTerms.clear();
-    auto results = termParser.globalMatch(searchString);
-    while (results.hasNext()) {
-        auto result = results.next();
-        SearchTerm term{};
+        int termScore = 0;
+        if (field == Field::Undefined || field == Field::Title) {
+            termScore = qMax(termScore, 3 * quality(ResolvedFields::Title));
+        }
+        if (field == Field::Undefined || field == Field::Username) {
+            termScore = qMax(termScore, 2 * quality(ResolvedFields::Username));
+        }
+        if (field == Field::Undefined || field == Field::Url) {
+            termScore = qMax(termScore, quality(ResolvedFields::Url));
+        }
 
-        // Quoted string group
-        term.word = result.captured(3);
-        // Unescape quotes
-        term.word.replace("\\\"", "\"");
+        // Words without a field may still match the notes or tags
+        if (termScore == 0) {
+            if (field != Field::Undefined || !matchEntry({planned}, fields)) {
+                return -1;
+            }
+            termScore = 1;
+        }
+        score += termScore;
+    }
+    return score;
+}
 
-        // If empty, use the unquoted string group
-        if (term.word.isEmpty()) {
-            term.word = result.captured(4);
+/**
+ * Match a large number of entries on the global thread pool.
+ *
+ * Placeholders and case-folded fields are resolved up front on the
+ * calling thread, which stays blocked until all shards are done. Workers therefore only read entry
+ * data that cannot change while they run. Every shard compiles its own
+ * copy of the search terms.
+ */
+QList<Entry*> EntrySearcher::repeatEntriesParallel(const QList<Entry*>& entries)
+{
+    bool needed[ResolvedFields::FieldCount] = {};
+    for (const auto& term : asConst(m_searchTerms)) {
+        switch (term.field) {
+        case Field::Title:
+            needed[ResolvedFields::Title] = true;
+            break;
+        case Field::Username:
+            needed[ResolvedFields::Username] = true;
+            break;
+        case Field::Password:
+            needed[ResolvedFields::Password] = !m_skipProtected;
+            break;
+        case Field::Url:
+            needed[ResolvedFields::Url] = true;
+            break;
+        case Field::Undefined:
+            needed[ResolvedFields::Title] = true;
+            needed[ResolvedFields::Username] = true;
+            needed[ResolvedFields::Url] = true;
+            break;
+        default:
+            break;
         }
+    }
 
-        // If still empty, ignore this match
-        if (term.word.isEmpty()) {
-            continue;
+    const bool neededFolded =
+        std::any_of(m_plan.cbegin(), m_plan.cend(), [](const PlannedTerm& planned) { return planned.foldable; });
+
+    QVector<ResolvedFields> fields;
+    fields.reserve(entries.size());
+    for (const auto entry : entries) {
+        fields.append(ResolvedFields(entry));
+        for (int field = 0; field < ResolvedFields::FieldCount; ++field) {
+            if (needed[field]) {
+                fields.last().resolve(static_cast<ResolvedFields::Field>(field));
+            }
+        }
+        if (neededFolded) {
+            fields.last().caseFolded();
+        }
+    }
+
+    struct Shard
+    {
+        int begin;
+        int end;
+    };
+    const int shardCount =
+        qMin(QThreadPool::globalInstance()->maxThreadCount() * 4, entries.size() / ParallelShardSize);
+    QVector<Shard> shards;
+    for (int i = 0; i < shardCount; ++i) {
+        shards.append({entries.size() * i / shardCount, entries.size() * (i + 1) / shardCount});
+    }
+
+    QVector<char> matched(entries.size(), 0);
+    // Raw pointers, so that workers never check the containers for detaching
+    ResolvedFields* fieldData = fields.data();
+    char* matchedData = matched.data();
+    QtConcurrent::blockingMap(shards, [&](const Shard& shard) {
+        QList<PlannedTerm> plan = m_plan;
+        for (auto& planned : plan) {
+            planned.term.regex = QRegularExpression(planned.term.regex.pattern(), planned.term.regex.patternOptions());
+        }
+        for (int i = shard.begin; i < shard.end; ++i) {
+            matchedData[i] = matchEntry(plan, fieldData[i]);
+        }
+    });
+
+    // Merge back in the original order
+    QList<Entry*> results;
+    for (int i = 0; i < entries.size(); ++i) {
+        if (matched[i]) {
+            results.append(entries[i]);
         }
+    }
+    return results;
+}
 
-        auto mods = result.captured(1);
+void EntrySearcher::parseSearchTerms(const QString& searchString)
+{
+    m_searchTerms.clear();
+    for (const auto& rawTerm : splitSearchTerms(searchString)) {
+        SearchTerm term{};
+        term.word = rawTerm.word;
 
         // Convert term to regex
         int opts = m_caseSensitive ? Tools::RegexConvertOpts::CASE_SENSITIVE : Tools::RegexConvertOpts::DEFAULT;
-        if (!mods.contains("*")) {
+        if (!rawTerm.modifiers.contains("*")) {
             opts |= Tools::RegexConvertOpts::WILDCARD_ALL;
         }
-        if (mods.contains("+")) {
+        if (rawTerm.modifiers.contains("+")) {
             opts |= Tools::RegexConvertOpts::EXACT_MATCH;
         }
         term.regex = Tools::convertToRegex(term.word, opts);
 
         // Exclude modifier
-        term.exclude = mods.contains("-") || mods.contains("!");
+        term.exclude = rawTerm.modifiers.contains("-") || rawTerm.modifiers.contains("!");
 
         // Determine the field to search
-        term.field = Field::Undefined;
-
-        QString field = result.captured(2);
-        if (!field.isEmpty()) {
-            if (field.startsWith("_", Qt::CaseInsensitive)) {
-                term.field = Field::AttributeValue;
-                // searching a custom attribute
-                // in this case term.word is the attribute key (removing the leading "_")
-                // and term.regex is used to match attribute value
-                term.word = field.mid(1);
-            } else {
-                for (const auto& pair : fieldnames) {
-                    if (pair.first.startsWith(field, Qt::CaseInsensitive)) {
-                        term.field = pair.second;
-                        break;
-                    }
-                }
-            }
+        term.field = fieldFromName(rawTerm.field);
+        if (term.field == Field::AttributeValue) {
+            // searching a custom attribute
+            // in this case term.word is the attribute key (removing the leading "_")
+            // and term.regex is used to match attribute value
+            term.word = rawTerm.field.mid(1);
         }
 
         m_searchTerms.append(term);
     }
+
+    compilePlan();
+}
+
+/**
+ * Prepare the current search terms for matching: detect terms that are
+ * plain text and order all terms so that cheap fields are checked first.
+ * As every term has to match, the order does not change the result.
+ */
+void EntrySearcher::compilePlan()
+{
+    m_plan.clear();
+    for (const auto& term : asConst(m_searchTerms)) {
+        PlannedTerm planned;
+        planned.term = term;
+        planned.literal = literalPattern(term.regex, planned.text, planned.exact);
+        planned.caseSensitivity = (term.regex.patternOptions() & QRegularExpression::CaseInsensitiveOption)
+                                      ? Qt::CaseInsensitive
+                                      : Qt::CaseSensitive;
+        planned.foldable = planned.literal && planned.caseSensitivity == Qt::CaseInsensitive;
+        if (planned.foldable) {
+            planned.foldedText = planned.text.toCaseFolded();
+        }
+        if (term.field == Field::AttachmentContent && !literalFragments(term.regex, planned.fragments)) {
+            planned.fragments.clear();
+        }
+        planned.cost = fieldCost(term);
+        m_plan.append(planned);
+    }
+
+    std::stable_sort(m_plan.begin(), m_plan.end(), [](const PlannedTerm& lhs, const PlannedTerm& rhs) {
+        if (lhs.cost != rhs.cost) {
+            return lhs.cost < rhs.cost;
+        }
+        // Exclusions tend to reject more entries
+        return lhs.term.exclude && !rhs.term.exclude;
+    });
+}
+
+bool EntrySearcher::PlannedTerm::matches(const QString& value) const
+{
+    if (!literal) {
+        return term.regex.match(value).hasMatch();
+    }
+    if (exact) {
+        return value.compare(text, caseSensitivity) == 0;
+    }
+    return value.contains(text, caseSensitivity);
+}
+
+bool EntrySearcher::PlannedTerm::matchesFolded(const QString& folded) const
+{
+    Q_ASSERT(foldable);
+    if (exact) {
+        return folded == foldedText;
+    }
+    return folded.contains(foldedText);
+}
+
+bool EntrySearcher::PlannedTerm::matchesAny(const QStringList& values) const
+{
+    return std::any_of(values.cbegin(), values.cend(), [this](const QString& value) { return matches(value); });
+}
+
+/**
+ * Same as QStringList::indexOf(QRegularExpression) != -1, which requires
+ * the whole string to match.
+ */
+bool EntrySearcher::PlannedTerm::matchesAnyExactly(const QStringList& values) const
+{
+    if (!literal) {
+        return values.indexOf(term.regex) != -1;
+    }
+    return std::any_of(values.cbegin(), values.cend(), [this](const QString& value) {
+        return value.compare(text, caseSensitivity) == 0;
+    });
+}
+
+bool EntrySearcher::PlannedTerm::matchesAnyFoldedExactly(const QStringList& folded) const
+{
+    Q_ASSERT(foldable);
+    return folded.contains(foldedText);
 }
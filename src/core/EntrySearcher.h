@@ -19,8 +19,13 @@
 #ifndef KEEPASSX_ENTRYSEARCHER_H
 #define KEEPASSX_ENTRYSEARCHER_H
 
+#include <QHash>
+#include <QPointer>
 #include <QRegularExpression>
+#include <QSet>
+#include <QSharedPointer>
 
+class Database;
 class Group;
 class Entry;
 
@@ -41,7 +46,8 @@ public:
         Group,
         Tag,
         Is,
-        Uuid
+        Uuid,
+        AttachmentContent
     };
 
     struct SearchTerm
@@ -53,12 +59,30 @@ public:
         bool exclude;
     };
 
+    struct ScoredEntry
+    {
+        Entry* entry;
+        int score;
+    };
+
     explicit EntrySearcher(bool caseSensitive = false, bool skipProtected = false);
 
     QList<Entry*> search(const QList<SearchTerm>& searchTerms, const Group* baseGroup, bool forceSearch = false);
     QList<Entry*> search(const QString& searchString, const Group* baseGroup, bool forceSearch = false);
     QList<Entry*> repeat(const Group* baseGroup, bool forceSearch = false);
 
+    QList<Entry*> beginSearch(const QString& searchString, const Group* baseGroup, bool forceSearch = false);
+    void finishSearch(const QList<Entry*>& results);
+
+    QList<Entry*> searchCached(const QString& searchString, const Group* baseGroup, bool forceSearch = false);
+    QList<ScoredEntry>
+    searchRanked(const QString& searchString, const Group* baseGroup, int limit = 0, bool forceSearch = false);
+    QList<ScoredEntry> searchRanked(const QString& searchString,
+                                    const QList<QSharedPointer<Database>>& databases,
+                                    int limit = 0,
+                                    bool forceSearch = false);
+    void clearCachedSearches();
+
     QList<Entry*> searchEntries(const QList<SearchTerm>& searchTerms, const QList<Entry*>& entries);
     QList<Entry*> searchEntries(const QString& searchString, const QList<Entry*>& entries);
     QList<Entry*> repeatEntries(const QList<Entry*>& entries);
@@ -67,12 +91,80 @@ public:
     bool isCaseSensitive() const;
 
 private:
+    struct ResolvedFields;
+
+    /**
+     * Search term prepared for matching. Terms whose regex only describes
+     * literal text are matched by plain string comparison instead, against
+     * the entry's case-folded fields when the term is case insensitive.
+     */
+    struct PlannedTerm
+    {
+        SearchTerm term;
+        bool literal = false;
+        bool exact = false;
+        QString text;
+        Qt::CaseSensitivity caseSensitivity = Qt::CaseInsensitive;
+        // Case-folded text, set when the term can match case-folded fields
+        bool foldable = false;
+        QString foldedText;
+        // Literal text every match of an attachment content term contains
+        QStringList fragments;
+        int cost = 0;
+
+        bool matches(const QString& value) const;
+        bool matchesFolded(const QString& folded) const;
+        bool matchesAny(const QStringList& values) const;
+        bool matchesAnyExactly(const QStringList& values) const;
+        bool matchesAnyFoldedExactly(const QStringList& folded) const;
+    };
+
+    // Minimum number of entries matched per thread when searching in parallel
+    static constexpr int ParallelShardSize = 512;
+    static constexpr int MaxCachedSearches = 32;
+
+    QList<Entry*> candidates(const Group* baseGroup, bool forceSearch, bool useIndex = true) const;
+    QList<Entry*> repeatEntriesParallel(const QList<Entry*>& entries);
+    bool matchEntry(const QList<PlannedTerm>& plan, ResolvedFields& fields) const;
+    int rankEntry(const QList<PlannedTerm>& ranked, ResolvedFields& fields) const;
+    bool indexCandidates(const Group* baseGroup, QSet<const Entry*>& candidates) const;
     bool searchEntryImpl(const Entry* entry);
     void parseSearchTerms(const QString& searchString);
+    void compilePlan();
 
     bool m_caseSensitive;
     bool m_skipProtected;
     QList<SearchTerm> m_searchTerms;
+    // m_searchTerms ordered by matching cost
+    QList<PlannedTerm> m_plan;
+
+    // Result of the last search by string, reused when the next search only refines it
+    struct
+    {
+        QString searchString;
+        QList<Entry*> results;
+        bool finished = false;
+        QPointer<const Database> database;
+        quint64 revision = 0;
+        QPointer<const Group> baseGroup;
+        bool forceSearch = false;
+        bool caseSensitive = false;
+    } m_lastSearch;
+
+    // Results of searchCached(), kept up to date using the changed entries of the database
+    struct CachedSearch
+    {
+        QPointer<const Database> database;
+        quint64 changeCursor = 0;
+        QPointer<const Group> baseGroup;
+        bool forceSearch = false;
+        bool caseSensitive = false;
+        QSet<const Entry*> evaluated;
+        QSet<const Entry*> matched;
+        // Entries that have to be matched again every time
+        QSet<const Entry*> placeholders;
+    };
+    QHash<QString, CachedSearch> m_cachedSearches;
 
     friend class TestEntrySearcher;
 };
@@ -0,0 +1,131 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntryUrlIndex.h"
+
+#include "core/Entry.h"
+#include "core/MemoryUsage.h"
+
+void EntryUrlIndex::clear()
+{
+    m_domains.clear();
+    m_entryDomains.clear();
+    m_unresolved.clear();
+}
+
+void EntryUrlIndex::addEntry(const Entry* entry)
+{
+    removeEntry(entry);
+
+    // Same URLs as Entry::getAllUrls(), without resolving placeholders
+    QStringList urls{entry->url()};
+    const auto* attributes = entry->attributes();
+    const auto relyingPartyKey = QString("%1_RELYING_PARTY").arg(EntryAttributes::PasskeyAttribute);
+    for (const auto& key : attributes->keys()) {
+        if (key.startsWith(EntryAttributes::AdditionalUrlAttribute) || key == relyingPartyKey) {
+            urls << attributes->value(key);
+        }
+    }
+
+    QStringList domains;
+    for (const auto& url : asConst(urls)) {
+        if (url.contains(QLatin1Char('{'))) {
+            m_unresolved.insert(entry);
+            return;
+        }
+
+        auto host = hostFromUrl(url);
+        if (host.isEmpty()) {
+            continue;
+        }
+        domains << domainKey(host);
+        // Browser matching may omit the www subdomain of entry URLs
+        if (host.startsWith("www.")) {
+            domains << domainKey(host.remove("www."));
+        }
+    }
+    domains.removeDuplicates();
+
+    for (const auto& domain : asConst(domains)) {
+        m_domains[domain].insert(entry);
+    }
+    if (!domains.isEmpty()) {
+        m_entryDomains.insert(entry, domains);
+    }
+}
+
+void EntryUrlIndex::removeEntry(const Entry* entry)
+{
+    if (m_unresolved.remove(entry)) {
+        return;
+    }
+
+    const QStringList domains = m_entryDomains.take(entry);
+    for (const auto& domain : domains) {
+        auto it = m_domains.find(domain);
+        if (it == m_domains.end()) {
+            continue;
+        }
+        it->remove(entry);
+        if (it->isEmpty()) {
+            m_domains.erase(it);
+        }
+    }
+}
+
+/**
+ * Find all indexed entries with an URL that may share the base domain with the given host.
+ *
+ * @param host host name of the site, e.g. login.example.com
+ * @return superset of the entries with an URL below the same base domain
+ */
+QSet<const Entry*> EntryUrlIndex::candidates(const QString& host) const
+{
+    QSet<const Entry*> result = m_unresolved;
+    if (host.isEmpty()) {
+        return result;
+    }
+    result.unite(m_domains.value(domainKey(host.toLower())));
+    return result;
+}
+
+/**
+ * Host of an entry URL as interpreted by browser matching, see Entry::parseUrl().
+ */
+QString EntryUrlIndex::hostFromUrl(const QString& url)
+{
+    return Entry::parseUrl(url).host;
+}
+
+/**
+ * Last two labels of a host, e.g. another.example.co.uk -> co.uk. Hosts with
+ * the same base domain always share this key.
+ */
+QString EntryUrlIndex::domainKey(const QString& host)
+{
+    int pos = host.lastIndexOf(QLatin1Char('.'));
+    if (pos > 0) {
+        pos = host.lastIndexOf(QLatin1Char('.'), pos - 1);
+    }
+    return pos < 0 ? host : host.mid(pos + 1);
+}
+
+qint64 EntryUrlIndex::memoryUsage() const
+{
+    return MemoryUsage::heapSize(m_domains) + MemoryUsage::heapSize(m_entryDomains)
+           + MemoryUsage::heapSize(m_unresolved);
+}
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ENTRYURLINDEX_H
+#define KEEPASSXC_ENTRYURLINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+class Entry;
+
+/**
+ * Index of entries by the domain of their URL and additional URLs.
+ *
+ * Entries are keyed by the last two labels of each host, which is never more
+ * specific than the registrable domain. A lookup therefore returns a superset
+ * of the entries whose URLs share the base domain with the given host, and
+ * candidates still need to be verified by the caller.
+ */
+class EntryUrlIndex
+{
+public:
+    void clear();
+    void addEntry(const Entry* entry);
+    void removeEntry(const Entry* entry);
+    qint64 memoryUsage() const;
+
+    QSet<const Entry*> candidates(const QString& host) const;
+
+    static QString hostFromUrl(const QString& url);
+    static QString domainKey(const QString& host);
+
+private:
+    QHash<QString, QSet<const Entry*>> m_domains;
+    QHash<const Entry*, QStringList> m_entryDomains;
+    // Entries using placeholders in an URL, their resolved host is unknown to the index
+    QSet<const Entry*> m_unresolved;
+};
+
+#endif // KEEPASSXC_ENTRYURLINDEX_H
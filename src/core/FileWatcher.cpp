@@ -18,10 +18,16 @@
 #include "FileWatcher.h"
 
 #include "core/AsyncTask.h"
+#include "core/NetworkFile.h"
+
+#include <QFileInfo>
 
 #ifdef Q_OS_LINUX
 #include <sys/statfs.h>
 #endif
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
 
 FileWatcher::FileWatcher(QObject* parent)
     : QObject(parent)
@@ -42,13 +48,15 @@ void FileWatcher::start(const QString& filePath, int checksumIntervalSeconds, in
 {
     stop();
 
+    m_onNetworkFileSystem = NetworkFile::isOnNetworkFileSystem(filePath);
+
 #if defined(Q_OS_LINUX)
     struct statfs statfsBuf;
     bool forcePolling = false;
     const auto NFS_SUPER_MAGIC = 0x6969;
 
     if (!statfs(filePath.toLocal8Bit().constData(), &statfsBuf)) {
-        forcePolling = (statfsBuf.f_type == NFS_SUPER_MAGIC);
+        forcePolling = (statfsBuf.f_type == NFS_SUPER_MAGIC) || m_onNetworkFileSystem;
     } else {
         // if we can't get the fs type let's fall back to polling
         forcePolling = true;
@@ -62,6 +70,8 @@ void FileWatcher::start(const QString& filePath, int checksumIntervalSeconds, in
 
     // Handle file checksum
     m_fileChecksumSizeBytes = checksumSizeKibibytes * 1024;
+    // Taken before hashing, a change while hashing is then seen by the next check
+    m_fileStat = fileStat();
     m_fileChecksum = calculateChecksum();
     if (checksumIntervalSeconds > 0) {
         m_fileChecksumTimer.start(checksumIntervalSeconds * 1000);
@@ -77,6 +87,7 @@ void FileWatcher::stop()
     }
     m_filePath.clear();
     m_fileChecksum.clear();
+    m_fileStat = {};
     m_fileChecksumTimer.stop();
     m_fileChangeDelayTimer.stop();
 }
@@ -104,6 +115,11 @@ bool FileWatcher::shouldIgnoreChanges()
 
 bool FileWatcher::hasSameFileChecksum()
 {
+    // The file is only read if its metadata changed
+    const auto currentStat = fileStat();
+    if (currentStat.valid && currentStat == m_fileStat) {
+        return true;
+    }
     return calculateChecksum() == m_fileChecksum;
 }
 
@@ -113,28 +129,48 @@ void FileWatcher::checkFileChanged()
         return;
     }
 
+    // Files replaced by renaming another file over them are no longer watched
+    if (!m_fileWatcher.files().contains(m_filePath) && QFile::exists(m_filePath)) {
+        m_fileWatcher.addPath(m_filePath);
+    }
+
+    // Polling only costs a stat call, the file is hashed once its metadata changed.
+    // If the file can't be accessed it is considered unchanged, like in calculateChecksum().
+    const auto currentStat = fileStat();
+    if (!currentStat.valid || currentStat == m_fileStat) {
+        return;
+    }
+
     // Prevent reentrance
     m_ignoreFileChange = true;
 
     AsyncTask::runThenCallback([=] { return calculateChecksum(); },
                                this,
                                [=](QByteArray checksum) {
+                                   m_fileStat = currentStat;
                                    if (checksum != m_fileChecksum) {
                                        m_fileChecksum = checksum;
                                        m_fileChangeDelayTimer.start(0);
                                    }
 
                                    m_ignoreFileChange = false;
-                               });
+                               },
+                               AsyncTask::Priority::Background);
 }
 
 QByteArray FileWatcher::calculateChecksum()
 {
     QFile file(m_filePath);
-    if (file.open(QFile::ReadOnly)) {
+    // On network shares the hashed part is requested at once instead of in buffer sized reads
+    const auto mode = m_onNetworkFileSystem ? QFile::ReadOnly | QFile::Unbuffered : QFile::ReadOnly;
+    if (file.open(mode)) {
         QCryptographicHash hash(QCryptographicHash::Sha256);
         if (m_fileChecksumSizeBytes > 0) {
             hash.addData(file.read(m_fileChecksumSizeBytes));
+            // Catch changes past the hashed part that change the size
+            hash.addData(QByteArray::number(file.size()));
+        } else if (m_onNetworkFileSystem) {
+            hash.addData(file.readAll());
         } else {
             hash.addData(&file);
         }
@@ -144,3 +180,35 @@ QByteArray FileWatcher::calculateChecksum()
     // prevents unnecessary merge requests on intermittent network shares
     return m_fileChecksum;
 }
+
+FileWatcher::FileStat FileWatcher::fileStat() const
+{
+    FileStat result;
+    QFileInfo fileInfo(m_filePath);
+    if (!fileInfo.exists()) {
+        return result;
+    }
+    result.valid = true;
+    result.size = fileInfo.size();
+    result.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+#ifdef Q_OS_UNIX
+    // Tells files replaced by renaming apart, even with the same size and time
+    struct stat statBuf;
+    if (::stat(QFile::encodeName(m_filePath).constData(), &statBuf) == 0) {
+        result.device = statBuf.st_dev;
+        result.inode = statBuf.st_ino;
+    }
+#endif
+    return result;
+}
+
+bool FileWatcher::FileStat::operator==(const FileStat& other) const
+{
+    return valid == other.valid && size == other.size && lastModified == other.lastModified && device == other.device
+           && inode == other.inode;
+}
+
+bool FileWatcher::FileStat::operator!=(const FileStat& other) const
+{
+    return !(*this == other);
+}
@@ -45,16 +45,32 @@ private slots:
     void checkFileChanged();
 
 private:
+    // Metadata that changes whenever the file is written or replaced
+    struct FileStat
+    {
+        bool valid = false;
+        qint64 size = -1;
+        qint64 lastModified = -1;
+        quint64 device = 0;
+        quint64 inode = 0;
+
+        bool operator==(const FileStat& other) const;
+        bool operator!=(const FileStat& other) const;
+    };
+
     QByteArray calculateChecksum();
+    FileStat fileStat() const;
     bool shouldIgnoreChanges();
 
     QString m_filePath;
     QFileSystemWatcher m_fileWatcher;
     QByteArray m_fileChecksum;
+    FileStat m_fileStat;
     QTimer m_fileChangeDelayTimer;
     QTimer m_fileIgnoreDelayTimer;
     QTimer m_fileChecksumTimer;
     int m_fileChecksumSizeBytes = -1;
+    bool m_onNetworkFileSystem = false;
     bool m_ignoreFileChange = false;
 };
 
@@ -29,6 +29,7 @@
 #include "core/Metadata.h"
 #include "core/Tools.h"
 
+#include <QThread>
 #include <QtConcurrent>
 #include <QtConcurrentFilter>
 
@@ -37,6 +38,19 @@ const int Group::OpenFolderIconNumber = 49;
 const int Group::RecycleBinIconNumber = 43;
 const QString Group::RootAutoTypeSequence = "{USERNAME}{TAB}{PASSWORD}{ENTER}";
 
+namespace
+{
+    bool isSameOrDescendantOf(const Group* group, const Group* ancestor)
+    {
+        for (; group; group = group->parentGroup()) {
+            if (group == ancestor) {
+                return true;
+            }
+        }
+        return false;
+    }
+} // namespace
+
 Group::Group()
     : m_customData(new CustomData(this))
     , m_updateTimeinfo(true)
@@ -48,6 +62,7 @@ Group::Group()
     m_data.mergeMode = Default;
 
     connect(m_customData, &CustomData::modified, this, &Group::modified);
+    connect(m_customData, &CustomData::modified, this, &Group::invalidateResolvedCustomData);
     connect(this, &Group::modified, this, &Group::updateTimeinfo);
     connect(this, &Group::groupNonDataChange, this, &Group::updateTimeinfo);
 }
@@ -67,11 +82,14 @@ Group::~Group()
         delete group;
     }
 
-    if (m_db && m_parent) {
-        DeletedObject delGroup;
-        delGroup.deletionTime = Clock::currentDateTimeUtc();
-        delGroup.uuid = m_uuid;
-        m_db->addDeletedObject(delGroup);
+    if (m_db) {
+        m_db->unindexGroup(this);
+        if (m_parent) {
+            DeletedObject delGroup;
+            delGroup.deletionTime = Clock::currentDateTimeUtc();
+            delGroup.uuid = m_uuid;
+            m_db->addDeletedObject(delGroup);
+        }
     }
 
     cleanupParent();
@@ -239,7 +257,7 @@ bool Group::isRecycled() const
 
 bool Group::isExpired() const
 {
-    return m_data.timeInfo.expires() && m_data.timeInfo.expiryTime() < Clock::currentDateTimeUtc();
+    return m_data.timeInfo.isExpiredAt(Clock::currentDateTimeUtc());
 }
 
 bool Group::isEmpty() const
@@ -259,16 +277,18 @@ const CustomData* Group::customData() const
 
 Group::TriState Group::resolveCustomDataTriState(const QString& key, bool checkParent) const
 {
-    // If not defined, check our parent up to the root group
-    if (!m_customData->contains(key)) {
-        if (!m_parent || !checkParent) {
+    if (!checkParent) {
+        if (!m_customData->contains(key)) {
             return Inherit;
-        } else {
-            return m_parent->resolveCustomDataTriState(key);
         }
+        return m_customData->value(key) == TRUE_STR ? Enable : Disable;
     }
 
-    return m_customData->value(key) == TRUE_STR ? Enable : Disable;
+    QString value;
+    if (!resolveCustomDataValue(key, value)) {
+        return Inherit;
+    }
+    return value == TRUE_STR ? Enable : Disable;
 }
 
 void Group::setCustomDataTriState(const QString& key, const Group::TriState& value)
@@ -289,16 +309,59 @@ void Group::setCustomDataTriState(const QString& key, const Group::TriState& val
 // Note that this returns an empty string both if the key is missing *or* if the key is present but value is empty.
 QString Group::resolveCustomDataString(const QString& key, bool checkParent) const
 {
-    // If not defined, check our parent up to the root group
-    if (!m_customData->contains(key)) {
-        if (!m_parent || !checkParent) {
-            return QString();
+    if (!checkParent) {
+        return m_customData->value(key);
+    }
+
+    QString value;
+    resolveCustomDataValue(key, value);
+    return value;
+}
+
+/**
+ * Look up a custom data value on this group or, if not defined, on the
+ * closest parent defining it. Results are cached per group until custom
+ * data or the parent of any group in the database changes.
+ *
+ * @return false if neither this group nor a parent defines the key
+ */
+bool Group::resolveCustomDataValue(const QString& key, QString& value) const
+{
+    // The cache is only used from the thread owning the group
+    const bool useCache = m_db && QThread::currentThread() == thread();
+    if (useCache) {
+        if (m_resolvedCustomDataDb != m_db || m_resolvedCustomDataRevision != m_db->m_groupCustomDataRevision) {
+            m_resolvedCustomData.clear();
+            m_resolvedCustomDataDb = m_db;
+            m_resolvedCustomDataRevision = m_db->m_groupCustomDataRevision;
         } else {
-            return m_parent->resolveCustomDataString(key);
+            auto it = m_resolvedCustomData.constFind(key);
+            if (it != m_resolvedCustomData.cend()) {
+                value = it->value;
+                return it->found;
+            }
         }
     }
 
-    return m_customData->value(key);
+    bool found = m_customData->contains(key);
+    if (found) {
+        value = m_customData->value(key);
+    } else if (m_parent) {
+        found = m_parent->resolveCustomDataValue(key, value);
+    }
+
+    if (useCache) {
+        m_resolvedCustomData.insert(key, {found, found ? value : QString()});
+    }
+    return found;
+}
+
+void Group::invalidateResolvedCustomData()
+{
+    // Children inherit our custom data, so invalidate all groups of the database
+    if (m_db) {
+        ++m_db->m_groupCustomDataRevision;
+    }
 }
 
 bool Group::equals(const Group* other, CompareItemOptions options) const
@@ -336,7 +399,17 @@ bool Group::equals(const Group* other, CompareItemOptions options) const
 
 void Group::setUuid(const QUuid& uuid)
 {
+    if (m_uuid == uuid) {
+        return;
+    }
+
+    if (m_db) {
+        m_db->unindexGroup(this);
+    }
     set(m_uuid, uuid);
+    if (m_db) {
+        m_db->indexGroup(this);
+    }
 }
 
 void Group::setName(const QString& name)
@@ -461,6 +534,9 @@ void Group::setParent(Group* parent, int index, bool trackPrevious)
         return;
     }
 
+    // Inherited custom data changes with the parent
+    invalidateResolvedCustomData();
+
     if (!moveWithinDatabase) {
         cleanupParent();
         m_parent = parent;
@@ -486,11 +562,17 @@ void Group::setParent(Group* parent, int index, bool trackPrevious)
         if (trackPrevious && m_parent != parent) {
             setPreviousParentGroup(m_parent);
         }
+        const bool wasRecycled = isRecycled();
         m_parent->m_children.removeAll(this);
         m_parent = parent;
         QObject::setParent(parent);
         Q_ASSERT(index <= parent->m_children.size());
         parent->m_children.insert(index, this);
+
+        // Tags of recycled entries are not counted
+        if (wasRecycled != isRecycled()) {
+            forEachEntryRecursive([this](Entry* entry) { m_db->updateEntryStatistics(entry); });
+        }
     }
 
     if (m_updateTimeinfo) {
@@ -499,6 +581,11 @@ void Group::setParent(Group* parent, int index, bool trackPrevious)
 
     emitModified();
 
+    invalidateResolvedCustomData();
+    if (m_db) {
+        ++m_db->m_groupHierarchyRevision;
+    }
+
     if (!moveWithinDatabase) {
         emit groupAdded();
     } else {
@@ -515,33 +602,50 @@ void Group::setParent(Database* db)
 
     m_parent = nullptr;
     connectDatabaseSignalsRecursive(db);
+    invalidateResolvedCustomData();
+    ++db->m_groupHierarchyRevision;
 
     QObject::setParent(db);
 }
 
+/**
+ * Names of the groups from the root group down to this one.
+ *
+ * @param height number of names to return counting from this group, -1 for all
+ */
 QStringList Group::hierarchy(int height) const
 {
-    QStringList hierarchy;
-    const Group* group = this;
-    const Group* parent = m_parent;
-
     if (height == 0) {
-        return hierarchy;
+        return {};
     }
 
-    hierarchy.prepend(group->name());
+    const QStringList hierarchy = fullHierarchy();
+    if (height < 0 || height >= hierarchy.size()) {
+        return hierarchy;
+    }
+    return hierarchy.mid(hierarchy.size() - height);
+}
 
-    int level = 1;
-    bool heightReached = level == height;
+/**
+ * The complete hierarchy, cached per group until any group of the database
+ * is renamed or moved.
+ */
+QStringList Group::fullHierarchy() const
+{
+    // The cache is only used from the thread owning the group
+    const bool useCache = m_db && QThread::currentThread() == thread();
+    if (useCache && m_hierarchyDb == m_db && m_hierarchyRevision == m_db->m_groupHierarchyRevision) {
+        return m_hierarchy;
+    }
 
-    while (parent && !heightReached) {
-        group = group->parentGroup();
-        parent = group->parentGroup();
-        heightReached = ++level == height;
+    QStringList hierarchy = m_parent ? m_parent->fullHierarchy() : QStringList();
+    hierarchy.append(name());
 
-        hierarchy.prepend(group->name());
+    if (useCache) {
+        m_hierarchy = hierarchy;
+        m_hierarchyDb = m_db;
+        m_hierarchyRevision = m_db->m_groupHierarchyRevision;
     }
-
     return hierarchy;
 }
 
@@ -583,24 +687,23 @@ const QList<Entry*>& Group::entries() const
 QList<Entry*> Group::entriesRecursive(bool includeHistoryItems) const
 {
     QList<Entry*> entryList;
-
-    entryList.append(m_entries);
-
-    if (includeHistoryItems) {
-        for (Entry* entry : m_entries) {
-            entryList.append(entry->historyItems());
-        }
-    }
-
-    for (Group* group : m_children) {
-        entryList.append(group->entriesRecursive(includeHistoryItems));
-    }
-
+    forEachEntryRecursive([&](Entry* entry) { entryList.append(entry); }, includeHistoryItems);
     return entryList;
 }
 
 QList<Entry*> Group::referencesRecursive(const Entry* entry) const
 {
+    if (m_db) {
+        QList<Entry*> references;
+        const auto& index = m_db->m_referenceIndex;
+        for (auto it = index.constFind(entry->uuid()); it != index.cend() && it.key() == entry->uuid(); ++it) {
+            if (isSameOrDescendantOf(it.value()->group(), this)) {
+                references.append(it.value());
+            }
+        }
+        return references;
+    }
+
     auto entries = entriesRecursive();
     return QtConcurrent::blockingFiltered(entries,
                                           [entry](const Entry* e) { return e->hasReferencesTo(entry->uuid()); });
@@ -612,6 +715,18 @@ Entry* Group::findEntryByUuid(const QUuid& uuid, bool recursive) const
         return nullptr;
     }
 
+    if (m_db) {
+        // The database index may also contain entries outside of this group
+        for (auto it = m_db->m_entryIndex.constFind(uuid); it != m_db->m_entryIndex.cend() && it.key() == uuid;
+             ++it) {
+            Entry* entry = it.value();
+            if (entry->group() == this || (recursive && isSameOrDescendantOf(entry->group(), this))) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
     auto entries = m_entries;
     if (recursive) {
         entries = entriesRecursive(false);
@@ -638,6 +753,9 @@ Entry* Group::findEntryByPath(const QString& entryPath) const
     if (!normalizedEntryPath.startsWith("/") && normalizedEntryPath.contains("/")) {
         normalizedEntryPath = "/" + normalizedEntryPath;
     }
+    if (m_db) {
+        return m_db->findEntryByPath(normalizedEntryPath, this);
+    }
     return findEntryByPathRecursive(normalizedEntryPath, "/");
 }
 
@@ -647,45 +765,44 @@ Entry* Group::findEntryBySearchTerm(const QString& term, EntryReferenceType refe
                "Database::findEntryRecursive",
                "Can't search entry with \"referenceType\" parameter equal to \"Unknown\"");
 
-    const QList<Group*> groups = groupsRecursive(true);
+    if (referenceType == EntryReferenceType::QUuid) {
+        return findEntryByUuid(QUuid::fromRfc4122(QByteArray::fromHex(term.toLatin1())), true);
+    }
 
-    for (const Group* group : groups) {
+    Entry* result = nullptr;
+    forEachEntryRecursive([&](Entry* entry) {
         bool found = false;
-        const QList<Entry*>& entryList = group->entries();
-        for (Entry* entry : entryList) {
-            switch (referenceType) {
-            case EntryReferenceType::Unknown:
-                return nullptr;
-            case EntryReferenceType::Title:
-                found = entry->title() == term;
-                break;
-            case EntryReferenceType::UserName:
-                found = entry->username() == term;
-                break;
-            case EntryReferenceType::Password:
-                found = entry->password() == term;
-                break;
-            case EntryReferenceType::Url:
-                found = entry->url() == term;
-                break;
-            case EntryReferenceType::Notes:
-                found = entry->notes() == term;
-                break;
-            case EntryReferenceType::QUuid:
-                found = entry->uuid() == QUuid::fromRfc4122(QByteArray::fromHex(term.toLatin1()));
-                break;
-            case EntryReferenceType::CustomAttributes:
-                found = entry->attributes()->containsValue(term);
-                break;
-            }
+        switch (referenceType) {
+        case EntryReferenceType::Unknown:
+        case EntryReferenceType::QUuid:
+            return false;
+        case EntryReferenceType::Title:
+            found = entry->title() == term;
+            break;
+        case EntryReferenceType::UserName:
+            found = entry->username() == term;
+            break;
+        case EntryReferenceType::Password:
+            found = entry->password() == term;
+            break;
+        case EntryReferenceType::Url:
+            found = entry->url() == term;
+            break;
+        case EntryReferenceType::Notes:
+            found = entry->notes() == term;
+            break;
+        case EntryReferenceType::CustomAttributes:
+            found = entry->attributes()->containsValue(term);
+            break;
+        }
 
-            if (found) {
-                return entry;
-            }
+        if (found) {
+            result = entry;
         }
-    }
+        return !found;
+    });
 
-    return nullptr;
+    return result;
 }
 
 Entry* Group::findEntryByPathRecursive(const QString& entryPath, const QString& basePath) const
@@ -725,6 +842,9 @@ Group* Group::findGroupByPath(const QString& groupPath)
             + (groupPath.endsWith("/") ? "" : "/");
         // clang-format on
     }
+    if (m_db) {
+        return m_db->findGroupByPath(normalizedGroupPath, this);
+    }
     return findGroupByPathRecursive(normalizedGroupPath, "/");
 }
 
@@ -786,28 +906,14 @@ QString Group::print(bool recursive, bool flatten, int depth)
 QList<const Group*> Group::groupsRecursive(bool includeSelf) const
 {
     QList<const Group*> groupList;
-    if (includeSelf) {
-        groupList.append(this);
-    }
-
-    for (const Group* group : asConst(m_children)) {
-        groupList.append(group->groupsRecursive(true));
-    }
-
+    forEachGroupRecursive([&](const Group* group) { groupList.append(group); }, includeSelf);
     return groupList;
 }
 
 QList<Group*> Group::groupsRecursive(bool includeSelf)
 {
     QList<Group*> groupList;
-    if (includeSelf) {
-        groupList.append(this);
-    }
-
-    for (Group* group : asConst(m_children)) {
-        groupList.append(group->groupsRecursive(true));
-    }
-
+    forEachGroupRecursive([&](Group* group) { groupList.append(group); }, includeSelf);
     return groupList;
 }
 
@@ -815,20 +921,19 @@ QSet<QUuid> Group::customIconsRecursive() const
 {
     QSet<QUuid> result;
 
-    if (!iconUuid().isNull()) {
-        result.insert(iconUuid());
-    }
-
-    const QList<Entry*> entryList = entriesRecursive(true);
-    for (Entry* entry : entryList) {
-        if (!entry->iconUuid().isNull()) {
-            result.insert(entry->iconUuid());
+    forEachGroupRecursive([&](const Group* group) {
+        if (!group->iconUuid().isNull()) {
+            result.insert(group->iconUuid());
         }
-    }
+    });
 
-    for (Group* group : m_children) {
-        result.unite(group->customIconsRecursive());
-    }
+    forEachEntryRecursive(
+        [&](const Entry* entry) {
+            if (!entry->iconUuid().isNull()) {
+                result.insert(entry->iconUuid());
+            }
+        },
+        true);
 
     return result;
 }
@@ -837,12 +942,12 @@ QList<QString> Group::usernamesRecursive(int topN) const
 {
     // Collect all usernames and sort for easy counting
     QHash<QString, int> countedUsernames;
-    for (const auto* entry : entriesRecursive()) {
+    forEachEntryRecursive([&](const Entry* entry) {
         const auto username = entry->username();
         if (!username.isEmpty() && !entry->isAttributeReference(EntryAttributes::UserNameKey)) {
             countedUsernames.insert(username, ++countedUsernames[username]);
         }
-    }
+    });
 
     // Sort username/frequency pairs by frequency and name
     QList<QPair<QString, int>> sortedUsernames;
@@ -871,17 +976,7 @@ QList<QString> Group::usernamesRecursive(int topN) const
 
 Group* Group::findGroupByUuid(const QUuid& uuid)
 {
-    if (uuid.isNull()) {
-        return nullptr;
-    }
-
-    for (Group* group : groupsRecursive(true)) {
-        if (group->uuid() == uuid) {
-            return group;
-        }
-    }
-
-    return nullptr;
+    return const_cast<Group*>(asConst(*this).findGroupByUuid(uuid));
 }
 
 const Group* Group::findGroupByUuid(const QUuid& uuid) const
@@ -890,6 +985,16 @@ const Group* Group::findGroupByUuid(const QUuid& uuid) const
         return nullptr;
     }
 
+    if (m_db) {
+        // The database index may also contain groups outside of this subtree
+        for (auto it = m_db->m_groupIndex.constFind(uuid); it != m_db->m_groupIndex.cend() && it.key() == uuid; ++it) {
+            if (isSameOrDescendantOf(it.value(), this)) {
+                return it.value();
+            }
+        }
+        return nullptr;
+    }
+
     for (const Group* group : groupsRecursive(true)) {
         if (group->uuid() == uuid) {
             return group;
@@ -931,16 +1036,23 @@ Group* Group::clone(Entry::CloneFlags entryFlags, Group::CloneFlags groupFlags)
     clonedGroup->m_customData->copyDataFrom(m_customData);
 
     if (groupFlags & Group::CloneIncludeEntries) {
-        const QList<Entry*> entryList = entries();
-        for (Entry* entry : entryList) {
+        // The clones keep the location times they were given
+        clonedGroup->m_entries.reserve(m_entries.size());
+        for (Entry* entry : asConst(m_entries)) {
             Entry* clonedEntry = entry->clone(entryFlags);
+            clonedEntry->setUpdateTimeinfo(false);
             clonedEntry->setGroup(clonedGroup);
+            clonedEntry->setUpdateTimeinfo(true);
         }
 
-        const QList<Group*> childrenGroups = children();
-        for (Group* groupChild : childrenGroups) {
+        // The cloned tree has no database and no observers yet, so the children are attached
+        // directly instead of through setParent(), which walks the whole subtree on every level
+        clonedGroup->m_children.reserve(m_children.size());
+        for (Group* groupChild : asConst(m_children)) {
             Group* clonedGroupChild = groupChild->clone(entryFlags, groupFlags);
-            clonedGroupChild->setParent(clonedGroup);
+            clonedGroupChild->m_parent = clonedGroup;
+            clonedGroupChild->QObject::setParent(clonedGroup);
+            clonedGroup->m_children.append(clonedGroupChild);
         }
     }
 
@@ -981,6 +1093,7 @@ void Group::addEntry(Entry* entry)
     connect(entry, &Entry::entryDataChanged, this, &Group::entryDataChanged);
     if (m_db) {
         connect(entry, &Entry::modified, m_db, &Database::markAsModified);
+        m_db->indexEntry(entry);
     }
 
     emitModified();
@@ -998,6 +1111,7 @@ void Group::removeEntry(Entry* entry)
     entry->disconnect(this);
     if (m_db) {
         entry->disconnect(m_db);
+        m_db->unindexEntry(entry);
     }
     m_entries.removeAll(entry);
     emitModified();
@@ -1034,14 +1148,17 @@ void Group::connectDatabaseSignalsRecursive(Database* db)
 {
     if (m_db) {
         disconnect(m_db);
+        m_db->unindexGroup(this);
     }
 
     for (Entry* entry : asConst(m_entries)) {
         if (m_db) {
             entry->disconnect(m_db);
+            m_db->unindexEntry(entry);
         }
         if (db) {
             connect(entry, &Entry::modified, db, &Database::markAsModified);
+            db->indexEntry(entry);
         }
     }
 
@@ -1054,9 +1171,15 @@ void Group::connectDatabaseSignalsRecursive(Database* db)
         connect(this, &Group::groupAdded, db, &Database::groupAdded);
         connect(this, &Group::aboutToMove, db, &Database::groupAboutToMove);
         connect(this, &Group::groupMoved, db, &Database::groupMoved);
+        connect(this, &Group::entryAboutToAdd, db, &Database::entryAboutToAdd);
+        connect(this, &Group::entryAdded, db, &Database::entryAdded);
+        connect(this, &Group::entryAboutToRemove, db, &Database::entryAboutToRemove);
+        connect(this, &Group::entryRemoved, db, &Database::entryRemoved);
+        connect(this, &Group::entryDataChanged, db, &Database::entryDataChanged);
         connect(this, &Group::groupNonDataChange, db, &Database::markNonDataChange);
         connect(this, &Group::modified, db, &Database::markAsModified);
         // clang-format on
+        db->indexGroup(this);
     }
 
     m_db = db;
@@ -1066,6 +1189,33 @@ void Group::connectDatabaseSignalsRecursive(Database* db)
     }
 }
 
+/**
+ * Drop all signal connections of this group, its entries and its children,
+ * and forget the database without unindexing them one by one. The database
+ * clears its indexes as a whole; deleting the tree afterwards notifies nobody.
+ */
+void Group::detachRecursive()
+{
+    disconnect();
+    m_db = nullptr;
+
+    for (Entry* entry : asConst(m_entries)) {
+        entry->disconnect();
+        // Opened attachments are watched by the GUI thread
+        entry->attachments()->closeOpenedAttachments();
+        // Serialized history items have no opened attachments
+        if (!entry->serializedHistory()) {
+            for (Entry* historyItem : entry->historyItems()) {
+                historyItem->attachments()->closeOpenedAttachments();
+            }
+        }
+    }
+
+    for (Group* group : asConst(m_children)) {
+        group->detachRecursive();
+    }
+}
+
 void Group::cleanupParent()
 {
     if (m_parent) {
@@ -1191,16 +1341,12 @@ void Group::applyGroupIconTo(Group* other)
 
 void Group::applyGroupIconToChildGroups()
 {
-    for (Group* recursiveChild : groupsRecursive(false)) {
-        applyGroupIconTo(recursiveChild);
-    }
+    forEachGroupRecursive([this](Group* recursiveChild) { applyGroupIconTo(recursiveChild); }, false);
 }
 
 void Group::applyGroupIconToChildEntries()
 {
-    for (Entry* recursiveEntry : entriesRecursive(false)) {
-        applyGroupIconTo(recursiveEntry);
-    }
+    forEachEntryRecursive([this](Entry* recursiveEntry) { applyGroupIconTo(recursiveEntry); });
 }
 
 void Group::sortChildrenRecursively(bool reverse)
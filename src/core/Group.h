@@ -19,8 +19,11 @@
 #ifndef KEEPASSX_GROUP_H
 #define KEEPASSX_GROUP_H
 
+#include <QHash>
 #include <QPointer>
 
+#include <type_traits>
+
 #include "core/CustomData.h"
 #include "core/Database.h"
 #include "core/Entry.h"
@@ -158,6 +161,17 @@ public:
     QList<Entry*> entriesRecursive(bool includeHistoryItems = false) const;
     QList<const Group*> groupsRecursive(bool includeSelf) const;
     QList<Group*> groupsRecursive(bool includeSelf);
+
+    /**
+     * Visit all entries of this group and its children without building an intermediate list.
+     * The visitor may return false to stop the iteration early. It must not add or remove
+     * entries or groups while the walk is in progress.
+     *
+     * @return false if the visitor stopped the iteration
+     */
+    template <typename Visitor> bool forEachEntryRecursive(Visitor&& visitor, bool includeHistoryItems = false) const;
+    template <typename Visitor> bool forEachGroupRecursive(Visitor&& visitor, bool includeSelf = true) const;
+    template <typename Visitor> bool forEachGroupRecursive(Visitor&& visitor, bool includeSelf = true);
     QSet<QUuid> customIconsRecursive() const;
     QList<QString> usernamesRecursive(int topN = -1) const;
 
@@ -201,16 +215,21 @@ signals:
 
 private slots:
     void updateTimeinfo();
+    void invalidateResolvedCustomData();
 
 private:
     template <class P, class V> bool set(P& property, const V& value);
+    template <typename Visitor, typename T> static bool visit(Visitor& visitor, T* item);
 
     void setParent(Database* db);
 
     void connectDatabaseSignalsRecursive(Database* db);
+    void detachRecursive();
     void cleanupParent();
+    bool resolveCustomDataValue(const QString& key, QString& value) const;
     void recCreateDelObjects();
 
+    QStringList fullHierarchy() const;
     Entry* findEntryByPathRecursive(const QString& entryPath, const QString& basePath) const;
     Group* findGroupByPathRecursive(const QString& groupPath, const QString& basePath);
 
@@ -227,9 +246,91 @@ private:
 
     bool m_updateTimeinfo;
 
+    struct ResolvedCustomData
+    {
+        bool found;
+        QString value;
+    };
+    // Custom data inherited from the parents, valid while the revision of the database is unchanged
+    mutable QHash<QString, ResolvedCustomData> m_resolvedCustomData;
+    mutable const Database* m_resolvedCustomDataDb = nullptr;
+    mutable quint64 m_resolvedCustomDataRevision = 0;
+    // Names from the root group down to this group, valid while the hierarchy revision of the database is unchanged
+    mutable QStringList m_hierarchy;
+    mutable const Database* m_hierarchyDb = nullptr;
+    mutable quint64 m_hierarchyRevision = 0;
+
     friend Group* Database::setRootGroup(Group* group);
+    friend void Database::releaseData(bool inBackground);
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Group::CloneFlags)
 
+template <typename Visitor, typename T> inline bool Group::visit(Visitor& visitor, T* item)
+{
+    if constexpr (std::is_same<decltype(visitor(item)), bool>::value) {
+        return visitor(item);
+    } else {
+        visitor(item);
+        return true;
+    }
+}
+
+template <typename Visitor> bool Group::forEachEntryRecursive(Visitor&& visitor, bool includeHistoryItems) const
+{
+    for (Entry* entry : m_entries) {
+        if (!visit(visitor, entry)) {
+            return false;
+        }
+    }
+
+    if (includeHistoryItems) {
+        for (Entry* entry : m_entries) {
+            for (Entry* historyItem : entry->historyItems()) {
+                if (!visit(visitor, historyItem)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    for (const Group* group : m_children) {
+        if (!group->forEachEntryRecursive(visitor, includeHistoryItems)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename Visitor> bool Group::forEachGroupRecursive(Visitor&& visitor, bool includeSelf) const
+{
+    if (includeSelf && !visit(visitor, this)) {
+        return false;
+    }
+
+    for (const Group* group : m_children) {
+        if (!group->forEachGroupRecursive(visitor, true)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename Visitor> bool Group::forEachGroupRecursive(Visitor&& visitor, bool includeSelf)
+{
+    if (includeSelf && !visit(visitor, this)) {
+        return false;
+    }
+
+    for (Group* group : asConst(m_children)) {
+        if (!group->forEachGroupRecursive(visitor, true)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 #endif // KEEPASSX_GROUP_H
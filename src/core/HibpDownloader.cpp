@@ -16,13 +16,20 @@
  */
 
 #include "HibpDownloader.h"
+#include "core/Global.h"
 #include "core/NetworkManager.h"
 
 #include <QCryptographicHash>
 #include <QNetworkReply>
+#include <QtConcurrent>
 
 namespace
 {
+    // HTTP/2 multiplexes these over one connection, HTTP/1.1 uses up to six
+    constexpr int MAX_CONCURRENT_REQUESTS = 6;
+    // Cached range responses younger than this are used without revalidation
+    constexpr qint64 CACHE_FRESH_SECS = 24 * 60 * 60;
+
     /*
      * Return the SHA1 hash of the specified password in upper-case hex.
      *
@@ -41,11 +48,11 @@ namespace
      * Returns the number of times the password is found in breaches, or
      * 0 if the password is not in the HIBP result.
      */
-    int pwnCount(const QString& password, const QString& hibpResult)
+    int pwnCount(const QString& passwordSha1Hex, const QString& hibpResult)
     {
         // The first 5 characters of the hash are in the URL already,
         // the HIBP result contains the remainder
-        auto pos = hibpResult.indexOf(sha1Hex(password).mid(5));
+        auto pos = hibpResult.indexOf(passwordSha1Hex.mid(5));
         if (pos < 0) {
             return 0;
         }
@@ -82,21 +89,60 @@ HibpDownloader::~HibpDownloader()
  */
 void HibpDownloader::add(const QString& password)
 {
-    if (!m_pwdsToTry.contains(password)) {
+    if (!m_pwdsAdded.contains(password)) {
+        m_pwdsAdded.insert(password);
         m_pwdsToTry << password;
     }
 }
 
 /*
  * Start validating the passwords against HIBP.
+ *
+ * Passwords whose hashes share the 5 character prefix sent to HIBP
+ * are validated with a single request.
  */
 void HibpDownloader::validate()
 {
-    for (auto password : m_pwdsToTry) {
+    const auto hashes = QtConcurrent::blockingMapped(m_pwdsToTry, sha1Hex);
+
+    QHash<QString, PendingReply> requests;
+    for (int i = 0; i < m_pwdsToTry.size(); ++i) {
+        auto& request = requests[hashes[i].left(5)];
+        request.prefix = hashes[i].left(5);
+        request.passwords << m_pwdsToTry[i];
+        request.sha1Hexes << hashes[i];
+    }
+
+    for (const auto& request : asConst(requests)) {
+        m_queuedRequests.append(request);
+        m_pwdsRemaining += request.passwords.size();
+    }
+
+    m_pwdsToTry.clear();
+    m_pwdsAdded.clear();
+
+    startRequests();
+}
+
+/*
+ * Answer queued requests from the cache or submit them to HIBP,
+ * keeping at most MAX_CONCURRENT_REQUESTS in flight.
+ */
+void HibpDownloader::startRequests()
+{
+    while (!m_queuedRequests.isEmpty() && m_replies.size() < MAX_CONCURRENT_REQUESTS) {
+        auto pending = m_queuedRequests.takeFirst();
+
+        bool fresh = false;
+        if (readCache(pending, fresh) && fresh) {
+            sendResults(pending, pending.cachedData);
+            continue;
+        }
+
         // The URL we query is https://api.pwnedpasswords.com/range/XXXXX,
         // where XXXXX is the first five bytes of the hex representation of
         // the password's SHA1.
-        const auto url = QString("https://api.pwnedpasswords.com/range/") + sha1Hex(password).left(5);
+        const auto url = QString("https://api.pwnedpasswords.com/range/") + pending.prefix;
 
         // HIBP requires clients to specify a user agent in the request
         // (https://haveibeenpwned.com/API/v3#UserAgent); however, in order
@@ -104,15 +150,52 @@ void HibpDownloader::validate()
         // we don't add the KeePassXC version number or platform.
         auto request = QNetworkRequest(url);
         request.setRawHeader("User-Agent", "KeePassXC");
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+        request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+#endif
+        if (!pending.cachedETag.isEmpty()) {
+            request.setRawHeader("If-None-Match", pending.cachedETag);
+        }
 
         // Finally, submit the request to HIBP.
         auto reply = getNetMgr()->get(request);
         connect(reply, &QNetworkReply::finished, this, &HibpDownloader::fetchFinished);
         connect(reply, &QIODevice::readyRead, this, &HibpDownloader::fetchReadyRead);
-        m_replies.insert(reply, {password, {}});
+        m_replies.insert(reply, pending);
     }
+}
 
-    m_pwdsToTry.clear();
+/*
+ * Send the results for all passwords of a range response to the caller.
+ */
+void HibpDownloader::sendResults(const PendingReply& pending, const QByteArray& hibpReply)
+{
+    const auto hibpResultText = QString::fromUtf8(hibpReply);
+    for (int i = 0; i < pending.passwords.size(); ++i) {
+        --m_pwdsRemaining;
+        emit hibpResult(pending.passwords[i], pwnCount(pending.sha1Hexes[i], hibpResultText));
+    }
+}
+
+/*
+ * Load the cached ETag and range response for a request.
+ */
+bool HibpDownloader::readCache(PendingReply& pending, bool& fresh) const
+{
+    const auto cached = m_cache.constFind(pending.prefix);
+    if (cached == m_cache.constEnd()) {
+        return false;
+    }
+
+    pending.cachedETag = cached->etag;
+    pending.cachedData = cached->data;
+    fresh = cached->fetched.secsTo(QDateTime::currentDateTimeUtc()) < CACHE_FRESH_SECS;
+    return true;
+}
+
+void HibpDownloader::writeCache(const QString& prefix, const QByteArray& etag, const QByteArray& data)
+{
+    m_cache.insert(prefix, {etag, data, QDateTime::currentDateTimeUtc()});
 }
 
 int HibpDownloader::passwordsToValidate() const
@@ -122,7 +205,7 @@ int HibpDownloader::passwordsToValidate() const
 
 int HibpDownloader::passwordsRemaining() const
 {
-    return m_replies.size();
+    return m_pwdsRemaining;
 }
 
 /*
@@ -135,6 +218,8 @@ void HibpDownloader::abort()
         reply->deleteLater();
     }
     m_replies.clear();
+    m_queuedRequests.clear();
+    m_pwdsRemaining = 0;
 }
 
 /*
@@ -145,7 +230,7 @@ void HibpDownloader::fetchReadyRead()
     const auto reply = qobject_cast<QNetworkReply*>(sender());
     auto entry = m_replies.find(reply);
     if (entry != m_replies.end()) {
-        entry->second += reply->readAll();
+        entry->data += reply->readAll();
     }
 }
 
@@ -164,8 +249,8 @@ void HibpDownloader::fetchFinished()
     const auto ok = reply->error() == QNetworkReply::NoError;
     const auto err = reply->errorString();
 
-    const auto password = entry->first;
-    const auto hibpReply = entry->second;
+    const auto pending = entry.value();
+    const auto& hibpReply = pending.data;
 
     reply->deleteLater();
     m_replies.remove(reply);
@@ -182,6 +267,15 @@ void HibpDownloader::fetchFinished()
         return;
     }
 
-    // Current password validated, send the result to the caller
-    emit hibpResult(password, pwnCount(password, hibpReply));
+    // Not modified since cached, refresh the cache timestamp
+    const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 304 && !pending.cachedData.isEmpty()) {
+        writeCache(pending.prefix, pending.cachedETag, pending.cachedData);
+        sendResults(pending, pending.cachedData);
+    } else {
+        writeCache(pending.prefix, reply->rawHeader("ETag"), hibpReply);
+        sendResults(pending, hibpReply);
+    }
+
+    startRequests();
 }
@@ -19,8 +19,11 @@
 #define KEEPASSXC_HIBPDOWNLOADER_H
 
 #include "config-keepassx.h"
+#include <QDateTime>
 #include <QHash>
 #include <QObject>
+#include <QSet>
+#include <QStringList>
 
 #ifndef WITH_XC_NETWORKING
 #error This file requires KeePassXC to be built with network support.
@@ -36,6 +39,11 @@ class QNetworkReply;
  * Usage: Pass the password to check to the ctor and process
  * the `finished` signal to get the result. Process the
  * `failed` signal to handle errors.
+ *
+ * A bounded number of range requests is in flight at a time. Range
+ * responses are kept in memory for the lifetime of the downloader and
+ * revalidated with their ETag once they are older than a day. Nothing
+ * is written to disk, as the hash prefixes hint at the checked passwords.
  */
 class HibpDownloader : public QObject
 {
@@ -62,8 +70,34 @@ private slots:
     void fetchReadyRead();
 
 private:
+    struct PendingReply
+    {
+        QString prefix;
+        QStringList passwords; // All passwords sharing the hash prefix of the request
+        QStringList sha1Hexes;
+        QByteArray data;
+        QByteArray cachedETag;
+        QByteArray cachedData;
+    };
+
+    struct CachedRange
+    {
+        QByteArray etag;
+        QByteArray data;
+        QDateTime fetched;
+    };
+
+    void startRequests();
+    void sendResults(const PendingReply& pending, const QByteArray& hibpReply);
+    bool readCache(PendingReply& pending, bool& fresh) const;
+    void writeCache(const QString& prefix, const QByteArray& etag, const QByteArray& data);
+
     QStringList m_pwdsToTry; // The list of remaining passwords to validate
-    QHash<QNetworkReply*, QPair<QString, QByteArray>> m_replies;
+    QSet<QString> m_pwdsAdded;
+    QList<PendingReply> m_queuedRequests;
+    QHash<QNetworkReply*, PendingReply> m_replies;
+    int m_pwdsRemaining = 0;
+    QHash<QString, CachedRange> m_cache; // Range responses by hash prefix
 };
 
 #endif // KEEPASSXC_HIBPDOWNLOADER_H
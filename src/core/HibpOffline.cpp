@@ -17,15 +17,30 @@
 
 #include "HibpOffline.h"
 
+#include "core/Global.h"
 #include "core/Group.h"
 
 #include <QCryptographicHash>
+#include <QFile>
+#include <QtEndian>
 #include <QProcess>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
 
 namespace HibpOffline
 {
     const std::size_t SHA1_BYTES = 20;
 
+    // Binary index: header, then fixed size records of SHA-1 and big endian count ordered by hash
+    const char INDEX_MAGIC[] = "KPXCHIBP";
+    const std::size_t INDEX_MAGIC_BYTES = 8;
+    const quint32 INDEX_VERSION = 1;
+    const std::size_t INDEX_HEADER_BYTES = 16;
+    const std::size_t INDEX_RECORD_BYTES = SHA1_BYTES + 4;
+
     enum class ParseResult
     {
         Ok,
@@ -75,16 +90,50 @@ namespace HibpOffline
         return ParseResult::Ok;
     }
 
-    bool
-    report(QSharedPointer<Database> db, QIODevice& hibpInput, QList<QPair<const Entry*, int>>& findings, QString* error)
+    QByteArray passwordSha1(const QString& password)
     {
-        QMultiHash<QByteArray, const Entry*> entriesBySha1;
-        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
+        return QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha1);
+    }
+
+    /**
+     * Map the SHA-1 of every password to the entries using it. Identical
+     * passwords are hashed only once, and in parallel across all cores.
+     *
+     * @param includeHistory also map the passwords of history items
+     */
+    QMultiHash<QByteArray, const Entry*> passwordHashes(QSharedPointer<Database> db, bool includeHistory)
+    {
+        QHash<QString, QList<const Entry*>> entriesByPassword;
+        db->rootGroup()->forEachEntryRecursive([&](const Entry* entry) {
             if (!entry->isRecycled()) {
-                const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
-                entriesBySha1.insert(sha1, entry);
+                entriesByPassword[entry->password()].append(entry);
+                if (includeHistory) {
+                    for (const auto* historyItem : entry->historyItems()) {
+                        entriesByPassword[historyItem->password()].append(historyItem);
+                    }
+                }
+            }
+        });
+
+        const auto passwords = entriesByPassword.keys();
+        const auto hashes = QtConcurrent::blockingMapped(passwords, passwordSha1);
+
+        QMultiHash<QByteArray, const Entry*> entriesBySha1;
+        for (int i = 0; i < passwords.size(); ++i) {
+            for (const auto* entry : entriesByPassword.value(passwords[i])) {
+                entriesBySha1.insert(hashes[i], entry);
             }
         }
+        return entriesBySha1;
+    }
+
+    bool report(QSharedPointer<Database> db,
+                QIODevice& hibpInput,
+                QList<QPair<const Entry*, int>>& findings,
+                QString* error,
+                bool includeHistory)
+    {
+        const auto entriesBySha1 = passwordHashes(db, includeHistory);
 
         QByteArray sha1;
         for (quint64 lineNum = 1;; ++lineNum) {
@@ -106,11 +155,289 @@ namespace HibpOffline
         }
     }
 
+    int hexValue(char c)
+    {
+        if ('0' <= c && c <= '9') {
+            return c - '0';
+        } else if ('a' <= c && c <= 'f') {
+            return c - 'a' + 10;
+        } else if ('A' <= c && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    /**
+     * Parse the line starting at offset of a memory mapped HIBP file.
+     *
+     * @param end set to the start of the next line
+     * @return false if the line is malformed
+     */
+    bool parseHibpLine(const char* data, qint64 size, qint64 offset, char* sha1, int& count, qint64& end)
+    {
+        const qint64 hexLength = SHA1_BYTES * 2;
+        if (size - offset < hexLength + 2) {
+            return false;
+        }
+        for (std::size_t i = 0; i < SHA1_BYTES; ++i) {
+            const int high = hexValue(data[offset + 2 * i]);
+            const int low = hexValue(data[offset + 2 * i + 1]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            sha1[i] = static_cast<char>(high << 4 | low);
+        }
+
+        qint64 pos = offset + hexLength;
+        if (data[pos++] != ':') {
+            return false;
+        }
+        count = 0;
+        const qint64 digitsStart = pos;
+        while (pos < size && '0' <= data[pos] && data[pos] <= '9') {
+            count = count * 10 + (data[pos++] - '0');
+        }
+        if (pos == digitsStart || (pos < size && data[pos] != '\n' && data[pos] != '\r')) {
+            return false;
+        }
+
+        while (pos < size && (data[pos] == '\n' || data[pos] == '\r')) {
+            ++pos;
+        }
+        end = pos;
+        return true;
+    }
+
+    /**
+     * Find the start of the line containing offset, which must be inside the
+     * data. An offset on the \n of a \r\n terminator belongs to the line the
+     * terminator ends, like the official downloads use.
+     */
+    qint64 lineStart(const char* data, qint64 lowerBound, qint64 offset)
+    {
+        while (offset > lowerBound) {
+            const char previous = data[offset - 1];
+            if (previous == '\n' || (previous == '\r' && data[offset] != '\n')) {
+                break;
+            }
+            --offset;
+        }
+        return offset;
+    }
+
+    /**
+     * Check a number of evenly spaced lines for ascending hashes. The other HIBP
+     * download is ordered by prevalence, whose hashes are not ordered at all.
+     */
+    bool isOrderedByHash(const char* data, qint64 size)
+    {
+        const int samples = 64;
+        QByteArray previous;
+        for (int i = 0; i < samples; ++i) {
+            const qint64 offset = lineStart(data, 0, size / samples * i);
+            QByteArray sha1(SHA1_BYTES, '\0');
+            int count;
+            qint64 end;
+            if (!parseHibpLine(data, size, offset, sha1.data(), count, end)) {
+                return false;
+            }
+            if (!previous.isEmpty() && sha1 < previous) {
+                return false;
+            }
+            previous = sha1;
+        }
+        return true;
+    }
+
+    /**
+     * Check the passwords of all entries against a HIBP file ordered by hash,
+     * looking up each distinct password hash with a binary search.
+     *
+     * @param hibpData contents of the file, usually memory mapped
+     */
+    bool reportSorted(QSharedPointer<Database> db,
+                      const char* hibpData,
+                      qint64 size,
+                      QList<QPair<const Entry*, int>>& findings,
+                      QString* error,
+                      bool includeHistory)
+    {
+        const auto entriesBySha1 = passwordHashes(db, includeHistory);
+        auto hashes = entriesBySha1.uniqueKeys();
+        // Report in the order of the file like report()
+        std::sort(hashes.begin(), hashes.end());
+
+        char lineSha1[SHA1_BYTES];
+        for (const auto& sha1 : asConst(hashes)) {
+            // Both bounds always point to the start of a line
+            qint64 lower = 0;
+            qint64 upper = size;
+            while (lower < upper) {
+                const qint64 start = lineStart(hibpData, lower, lower + (upper - lower) / 2);
+                int count = 0;
+                qint64 end;
+                if (!parseHibpLine(hibpData, size, start, lineSha1, count, end)) {
+                    *error = QObject::tr("HIBP file, offset %1: parse error").arg(start);
+                    return false;
+                }
+
+                const int cmp = std::memcmp(lineSha1, sha1.constData(), SHA1_BYTES);
+                if (cmp == 0) {
+                    for (const auto* entry : entriesBySha1.values(sha1)) {
+                        findings.append({entry, count});
+                    }
+                    break;
+                } else if (cmp < 0) {
+                    lower = end;
+                } else {
+                    upper = start;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Check against a HIBP file or binary index, with a binary search if it can
+     * be memory mapped and is ordered by hash and with a full scan otherwise.
+     */
+    bool reportFile(QSharedPointer<Database> db,
+                    QFile& hibpFile,
+                    QList<QPair<const Entry*, int>>& findings,
+                    QString* error,
+                    bool includeHistory)
+    {
+        const qint64 size = hibpFile.size();
+        uchar* data = size > 0 ? hibpFile.map(0, size) : nullptr;
+        if (data) {
+            const auto* hibpData = reinterpret_cast<const char*>(data);
+            if (isIndex(hibpData, size)) {
+                const bool ok = indexReport(db, hibpData, size, findings, error, includeHistory);
+                hibpFile.unmap(data);
+                return ok;
+            }
+            if (isOrderedByHash(hibpData, size)) {
+                const bool ok = reportSorted(db, hibpData, size, findings, error, includeHistory);
+                hibpFile.unmap(data);
+                return ok;
+            }
+            hibpFile.unmap(data);
+        }
+
+        return report(db, hibpFile, findings, error, includeHistory);
+    }
+
+    /**
+     * Convert a HIBP file ordered by hash to the binary index format, which is
+     * about half the size and needs no parsing when searched.
+     */
+    bool writeIndex(QIODevice& hibpInput, QIODevice& indexOutput, QString* error)
+    {
+        char header[INDEX_HEADER_BYTES] = {};
+        std::memcpy(header, INDEX_MAGIC, INDEX_MAGIC_BYTES);
+        qToBigEndian(INDEX_VERSION, header + INDEX_MAGIC_BYTES);
+        if (indexOutput.write(header, sizeof(header)) != sizeof(header)) {
+            *error = indexOutput.errorString();
+            return false;
+        }
+
+        QByteArray sha1;
+        QByteArray previous;
+        char record[INDEX_RECORD_BYTES];
+        for (quint64 lineNum = 1;; ++lineNum) {
+            int count = 0;
+
+            switch (parseHibpLine(hibpInput, sha1, count)) {
+            case ParseResult::Eof:
+                return true;
+            case ParseResult::Error:
+                *error = QObject::tr("HIBP file, line %1: parse error").arg(lineNum);
+                return false;
+            default:
+                break;
+            }
+
+            if (sha1.size() != static_cast<int>(SHA1_BYTES)) {
+                *error = QObject::tr("HIBP file, line %1: parse error").arg(lineNum);
+                return false;
+            }
+            if (sha1 <= previous) {
+                *error = QObject::tr("HIBP file, line %1: not ordered by hash").arg(lineNum);
+                return false;
+            }
+            previous = sha1;
+
+            std::memcpy(record, sha1.constData(), SHA1_BYTES);
+            qToBigEndian(static_cast<quint32>(count), record + SHA1_BYTES);
+            if (indexOutput.write(record, sizeof(record)) != sizeof(record)) {
+                *error = indexOutput.errorString();
+                return false;
+            }
+        }
+    }
+
+    bool isIndex(const char* data, qint64 size)
+    {
+        return size >= static_cast<qint64>(INDEX_HEADER_BYTES)
+               && std::memcmp(data, INDEX_MAGIC, INDEX_MAGIC_BYTES) == 0;
+    }
+
+    /**
+     * Check the passwords of all entries against a binary index written by
+     * writeIndex(), looking up each distinct password hash with a binary search.
+     */
+    bool indexReport(QSharedPointer<Database> db,
+                     const char* indexData,
+                     qint64 size,
+                     QList<QPair<const Entry*, int>>& findings,
+                     QString* error,
+                     bool includeHistory)
+    {
+        if (!isIndex(indexData, size) || qFromBigEndian<quint32>(indexData + INDEX_MAGIC_BYTES) != INDEX_VERSION
+            || (size - INDEX_HEADER_BYTES) % INDEX_RECORD_BYTES != 0) {
+            *error = QObject::tr("Unsupported or damaged HIBP index file");
+            return false;
+        }
+
+        const char* records = indexData + INDEX_HEADER_BYTES;
+        const qint64 recordCount = (size - INDEX_HEADER_BYTES) / INDEX_RECORD_BYTES;
+
+        const auto entriesBySha1 = passwordHashes(db, includeHistory);
+        auto hashes = entriesBySha1.uniqueKeys();
+        std::sort(hashes.begin(), hashes.end());
+
+        for (const auto& sha1 : asConst(hashes)) {
+            qint64 lower = 0;
+            qint64 upper = recordCount;
+            while (lower < upper) {
+                const qint64 middle = lower + (upper - lower) / 2;
+                const char* record = records + middle * INDEX_RECORD_BYTES;
+
+                const int cmp = std::memcmp(record, sha1.constData(), SHA1_BYTES);
+                if (cmp == 0) {
+                    const auto count = qFromBigEndian<quint32>(record + SHA1_BYTES);
+                    for (const auto* entry : entriesBySha1.values(sha1)) {
+                        findings.append({entry, static_cast<int>(qMin<quint32>(count, INT_MAX))});
+                    }
+                    break;
+                } else if (cmp < 0) {
+                    lower = middle + 1;
+                } else {
+                    upper = middle;
+                }
+            }
+        }
+
+        return true;
+    }
+
     bool okonReport(QSharedPointer<Database> db,
                     const QString& okon,
                     const QString& okonDatabase,
                     QList<QPair<const Entry*, int>>& findings,
-                    QString* error)
+                    QString* error,
+                    bool includeHistory)
     {
         if (!okonDatabase.endsWith(".okon")) {
             *error = QObject::tr("To use okon, you must provide a post-processed file (e.g. file.okon)");
@@ -119,28 +446,29 @@ namespace HibpOffline
 
         QProcess okonProcess;
 
-        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
-            if (!entry->isRecycled()) {
-                const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
-                okonProcess.start(okon, {"--path", okonDatabase, "--hash", QString::fromLatin1(sha1.toHex())});
-                if (!okonProcess.waitForStarted()) {
-                    *error = QObject::tr("Could not start okon process: %1").arg(okon);
-                    return false;
-                }
+        // Run okon once per distinct password
+        const auto entriesBySha1 = passwordHashes(db, includeHistory);
+        for (const auto& sha1 : entriesBySha1.uniqueKeys()) {
+            okonProcess.start(okon, {"--path", okonDatabase, "--hash", QString::fromLatin1(sha1.toHex())});
+            if (!okonProcess.waitForStarted()) {
+                *error = QObject::tr("Could not start okon process: %1").arg(okon);
+                return false;
+            }
 
-                if (!okonProcess.waitForFinished()) {
-                    *error = QObject::tr("Error: okon process did not finish");
-                    return false;
-                }
+            if (!okonProcess.waitForFinished()) {
+                *error = QObject::tr("Error: okon process did not finish");
+                return false;
+            }
 
-                switch (okonProcess.exitCode()) {
-                case 1:
+            switch (okonProcess.exitCode()) {
+            case 1:
+                for (const auto* entry : entriesBySha1.values(sha1)) {
                     findings.append({entry, -1});
-                    break;
-                case 2:
-                    *error = QObject::tr("Failed to load okon processed database: %1").arg(okonDatabase);
-                    return false;
                 }
+                break;
+            case 2:
+                *error = QObject::tr("Failed to load okon processed database: %1").arg(okonDatabase);
+                return false;
             }
         }
 
@@ -20,6 +20,7 @@
 
 #include <QSharedPointer>
 
+class QFile;
 class QIODevice;
 
 class Database;
@@ -30,13 +31,39 @@ namespace HibpOffline
     bool report(QSharedPointer<Database> db,
                 QIODevice& hibpInput,
                 QList<QPair<const Entry*, int>>& findings,
-                QString* error);
+                QString* error,
+                bool includeHistory = false);
+
+    bool reportSorted(QSharedPointer<Database> db,
+                      const char* hibpData,
+                      qint64 size,
+                      QList<QPair<const Entry*, int>>& findings,
+                      QString* error,
+                      bool includeHistory = false);
+
+    bool reportFile(QSharedPointer<Database> db,
+                    QFile& hibpFile,
+                    QList<QPair<const Entry*, int>>& findings,
+                    QString* error,
+                    bool includeHistory = false);
+
+    bool writeIndex(QIODevice& hibpInput, QIODevice& indexOutput, QString* error);
+
+    bool isIndex(const char* data, qint64 size);
+
+    bool indexReport(QSharedPointer<Database> db,
+                     const char* indexData,
+                     qint64 size,
+                     QList<QPair<const Entry*, int>>& findings,
+                     QString* error,
+                     bool includeHistory = false);
 
     bool okonReport(QSharedPointer<Database> db,
                     const QString& okon,
                     const QString& okonDatabase,
                     QList<QPair<const Entry*, int>>& findings,
-                    QString* error);
+                    QString* error,
+                    bool includeHistory = false);
 } // namespace HibpOffline
 
 #endif // KEEPASSXC_HIBPOFFLINE_H
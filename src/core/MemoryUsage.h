@@ -0,0 +1,145 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_MEMORYUSAGE_H
+#define KEEPASSXC_MEMORYUSAGE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QUuid>
+#include <QVector>
+
+#include <type_traits>
+
+/**
+ * Estimates of the heap memory held by Qt values and containers.
+ *
+ * The estimates count the allocated capacity and a fixed overhead for each
+ * node of node based containers, the exact allocator overhead is unknown.
+ * Implicitly shared data is counted for each value sharing it, unless the
+ * caller passes a set of data that was already counted.
+ */
+namespace MemoryUsage
+{
+    // Pointers to the next node and the cached hash or the tree links of a node
+    constexpr qint64 NodeOverhead = 2 * sizeof(void*);
+
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value || std::is_pointer<T>::value, qint64>::type
+    heapSize(const T&)
+    {
+        return 0;
+    }
+
+    inline qint64 heapSize(const QString& value)
+    {
+        return value.capacity() * qint64(sizeof(QChar));
+    }
+
+    inline qint64 heapSize(const QByteArray& value)
+    {
+        return value.capacity();
+    }
+
+    // Kept inline by the value, except for date times with a time zone
+    inline qint64 heapSize(const QDateTime&)
+    {
+        return 0;
+    }
+
+    inline qint64 heapSize(const QUuid&)
+    {
+        return 0;
+    }
+
+    template <typename T> qint64 heapSize(const QList<T>& list);
+    template <typename T> qint64 heapSize(const QVector<T>& vector);
+    template <typename T> qint64 heapSize(const QSet<T>& set);
+    template <typename K, typename V> qint64 heapSize(const QHash<K, V>& hash);
+    template <typename K, typename V> qint64 heapSize(const QMap<K, V>& map);
+
+    template <typename T> qint64 heapSize(const QList<T>& list)
+    {
+        // Elements larger than a pointer are allocated one by one
+        qint64 size = list.size() * qint64(sizeof(void*));
+        if (sizeof(T) > sizeof(void*)) {
+            size += list.size() * qint64(sizeof(T));
+        }
+        for (const auto& value : list) {
+            size += heapSize(value);
+        }
+        return size;
+    }
+
+    template <typename T> qint64 heapSize(const QVector<T>& vector)
+    {
+        qint64 size = vector.capacity() * qint64(sizeof(T));
+        for (const auto& value : vector) {
+            size += heapSize(value);
+        }
+        return size;
+    }
+
+    template <typename T> qint64 heapSize(const QSet<T>& set)
+    {
+        qint64 size = set.capacity() * qint64(sizeof(void*)) + set.size() * (NodeOverhead + qint64(sizeof(T)));
+        for (const auto& value : set) {
+            size += heapSize(value);
+        }
+        return size;
+    }
+
+    template <typename K, typename V> qint64 heapSize(const QHash<K, V>& hash)
+    {
+        qint64 size =
+            hash.capacity() * qint64(sizeof(void*)) + hash.size() * (NodeOverhead + qint64(sizeof(K) + sizeof(V)));
+        for (auto it = hash.constBegin(); it != hash.constEnd(); ++it) {
+            size += heapSize(it.key()) + heapSize(it.value());
+        }
+        return size;
+    }
+
+    template <typename K, typename V> qint64 heapSize(const QMap<K, V>& map)
+    {
+        // Tree nodes link to their parent as well
+        qint64 size = map.size() * (NodeOverhead + qint64(sizeof(void*) + sizeof(K) + sizeof(V)));
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            size += heapSize(it.key()) + heapSize(it.value());
+        }
+        return size;
+    }
+
+    /**
+     * Heap size of implicitly shared data that is counted only the first
+     * time it is seen.
+     */
+    template <typename T> qint64 sharedHeapSize(const T& value, QSet<const void*>& seen)
+    {
+        if (value.isEmpty() || seen.contains(value.constData())) {
+            return 0;
+        }
+        seen.insert(value.constData());
+        return heapSize(value);
+    }
+} // namespace MemoryUsage
+
+#endif // KEEPASSXC_MEMORYUSAGE_H
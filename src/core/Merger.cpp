@@ -18,6 +18,19 @@
 #include "Merger.h"
 
 #include "core/Metadata.h"
+#include "core/Trace.h"
+
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace
+{
+    const QString WatermarkKeyPrefix = QStringLiteral("KPXC_MERGE_WATERMARK_");
+} // namespace
 
 Merger::Merger(const Database* sourceDb, Database* targetDb)
     : m_mode(Group::Default)
@@ -57,19 +70,110 @@ void Merger::resetForcedMergeMode()
     m_mode = Group::Default;
 }
 
+/**
+ * Skip source entries that were not modified or moved since the last
+ * incremental merge from the same source database.
+ *
+ * The watermark is the newest source timestamp seen by that merge and is
+ * stored in the custom data of the target database. Without a watermark
+ * all entries are merged.
+ */
+void Merger::setIncremental(bool incremental)
+{
+    m_incremental = incremental;
+}
+
+/**
+ * Decide how entries present in both databases are merged on the thread pool.
+ *
+ * The decisions are made after the groups and entries of the target are
+ * created and moved, and are then applied in tree order before deletions are
+ * merged. Only large merges use more than one thread.
+ */
+void Merger::setParallel(bool parallel)
+{
+    m_parallel = parallel;
+}
+
+/**
+ * Custom data key of the incremental merge watermark for a source database,
+ * identified by its root group and file so copies of one database are told apart.
+ */
+QString Merger::watermarkKey(const Database* sourceDb)
+{
+    const auto canonicalPath = QFileInfo(sourceDb->filePath()).canonicalFilePath();
+    const auto source = sourceDb->rootGroup()->uuid().toRfc4122() + canonicalPath.toUtf8();
+    const auto hash = QCryptographicHash::hash(source, QCryptographicHash::Sha256).toHex().left(16);
+    return WatermarkKeyPrefix + QString::fromLatin1(hash);
+}
+
+/**
+ * Watermarks describe what the database itself has merged, they are never taken
+ * over from or removed by the custom data of another database.
+ */
+bool Merger::isWatermarkKey(const QString& key)
+{
+    return key.startsWith(WatermarkKeyPrefix);
+}
+
+bool Merger::isBeforeWatermark(const Entry* sourceEntry)
+{
+    const auto& timeInfo = sourceEntry->timeInfo();
+    const auto modified = qMax(timeInfo.lastModificationTime(), timeInfo.locationChanged());
+    if (!m_newWatermark.isValid() || modified > m_newWatermark) {
+        m_newWatermark = modified;
+    }
+    return m_watermark.isValid() && modified <= m_watermark;
+}
+
+/**
+ * Whether the target still has the state of a source entry that is older than the
+ * watermark. The target may have lost it since, e.g. when restored from a backup.
+ */
+bool Merger::isAlreadyMerged(const Entry* sourceEntry, const Entry* targetEntry)
+{
+    const auto& sourceTimeInfo = sourceEntry->timeInfo();
+    const auto& targetTimeInfo = targetEntry->timeInfo();
+    if (sourceTimeInfo.lastModificationTime() == targetTimeInfo.lastModificationTime()
+        && sourceTimeInfo.locationChanged() == targetTimeInfo.locationChanged()
+        && sourceEntry->historyCount() == targetEntry->historyCount()) {
+        return true;
+    }
+    return sourceEntry->fingerprint() == targetEntry->fingerprint();
+}
+
 QStringList Merger::merge()
 {
+    TRACE_SCOPE("Merger::merge");
+    Database::BatchUpdate batch(m_context.m_targetDb);
+
+    auto targetCustomData = m_context.m_targetDb->metadata()->customData();
+    const auto watermarkKey = Merger::watermarkKey(m_context.m_sourceDb);
+    if (m_incremental && m_context.m_sourceGroup == m_context.m_sourceRootGroup) {
+        if (targetCustomData->contains(watermarkKey)) {
+            m_watermark = QDateTime::fromMSecsSinceEpoch(targetCustomData->value(watermarkKey).toLongLong(), Qt::UTC);
+        }
+    }
+
     // Order of merge steps is important - it is possible that we
     // create some items before deleting them afterwards
     ChangeList changes;
     changes << mergeGroup(m_context);
+    changes << resolvePendingEntryMerges();
     changes << mergeDeletions(m_context);
     changes << mergeMetadata(m_context);
 
+    if (m_incremental && m_context.m_sourceGroup == m_context.m_sourceRootGroup) {
+        if (m_newWatermark.isValid() && (!m_watermark.isValid() || m_newWatermark > m_watermark)) {
+            targetCustomData->set(watermarkKey, QString::number(m_newWatermark.toMSecsSinceEpoch()));
+        }
+    }
+
     // At this point we have a list of changes we may want to show the user
     if (!changes.isEmpty()) {
         m_context.m_targetDb->markAsModified();
     }
+    TRACE_COUNTER("merge changes", changes.size());
     return changes;
 }
 
@@ -79,7 +183,12 @@ Merger::ChangeList Merger::mergeGroup(const MergeContext& context)
     // merge entries
     const QList<Entry*> sourceEntries = context.m_sourceGroup->entries();
     for (Entry* sourceEntry : sourceEntries) {
+        const bool beforeWatermark = isBeforeWatermark(sourceEntry);
         Entry* targetEntry = context.m_targetRootGroup->findEntryByUuid(sourceEntry->uuid());
+        if (targetEntry && beforeWatermark && isAlreadyMerged(sourceEntry, targetEntry)) {
+            // Already merged by the last incremental merge
+            continue;
+        }
         if (!targetEntry) {
             changes << tr("Creating missing %1 [%2]").arg(sourceEntry->title(), sourceEntry->uuidToHex());
             // This entry does not exist at all. Create it.
@@ -219,8 +328,8 @@ void Merger::moveGroup(Group* group, Group* targetGroup)
 void Merger::eraseEntry(Entry* entry)
 {
     Database* database = entry->database();
-    // most simple method to remove an item from DeletedObjects :(
-    const QList<DeletedObject> deletions = database->deletedObjects();
+    // Deleting only appends to the deleted objects, forget what was added
+    const int deletionCount = asConst(*database).deletedObjects().size();
     Group* parentGroup = entry->group();
     const bool groupUpdateTimeInfo = parentGroup ? parentGroup->canUpdateTimeinfo() : false;
     if (parentGroup) {
@@ -230,14 +339,14 @@ void Merger::eraseEntry(Entry* entry)
     if (parentGroup) {
         parentGroup->setUpdateTimeinfo(groupUpdateTimeInfo);
     }
-    database->setDeletedObjects(deletions);
+    database->truncateDeletedObjects(deletionCount);
 }
 
 void Merger::eraseGroup(Group* group)
 {
     Database* database = group->database();
-    // most simple method to remove an item from DeletedObjects :(
-    const QList<DeletedObject> deletions = database->deletedObjects();
+    // Deleting only appends to the deleted objects, forget what was added
+    const int deletionCount = asConst(*database).deletedObjects().size();
     Group* parentGroup = group->parentGroup();
     const bool groupUpdateTimeInfo = parentGroup ? parentGroup->canUpdateTimeinfo() : false;
     if (parentGroup) {
@@ -247,22 +356,69 @@ void Merger::eraseGroup(Group* group)
     if (parentGroup) {
         parentGroup->setUpdateTimeinfo(groupUpdateTimeInfo);
     }
-    database->setDeletedObjects(deletions);
+    database->truncateDeletedObjects(deletionCount);
 }
 
-Merger::ChangeList Merger::resolveEntryConflict_MergeHistories(const MergeContext& context,
-                                                               const Entry* sourceEntry,
-                                                               Entry* targetEntry,
-                                                               Group::MergeMode mergeMethod)
+Merger::ChangeList
+Merger::resolveEntryConflict(const MergeContext& context, const Entry* sourceEntry, Entry* targetEntry)
 {
     Q_UNUSED(context);
+    EntryMerge entryMerge;
+    entryMerge.sourceEntry = sourceEntry;
+    entryMerge.targetEntry = targetEntry;
+    entryMerge.maxItems = targetEntry->database()->metadata()->historyMaxItems();
+    if (m_parallel) {
+        // Decided together with the other entries once the structure of the target is merged. History
+        // items are only loaded on the thread owning the entries, so they are loaded beforehand.
+        sourceEntry->historyItems();
+        targetEntry->historyItems();
+        m_pendingEntryMerges.append(entryMerge);
+        return {};
+    }
+    planEntryMerge(entryMerge);
+    return applyEntryMerge(entryMerge);
+}
 
-    ChangeList changes;
+/**
+ * Decide how an entry is merged without changing either database, so this
+ * may run for several entries at once on the thread pool.
+ */
+void Merger::planEntryMerge(EntryMerge& entryMerge)
+{
+    const Entry* sourceEntry = entryMerge.sourceEntry;
+    const Entry* targetEntry = entryMerge.targetEntry;
+
+    // Identical entries, the common case after a sync client touched the file, merge without changes
+    entryMerge.identical = sourceEntry->fingerprint() == targetEntry->fingerprint();
+    if (entryMerge.identical) {
+        return;
+    }
+
+    // We need to cut off the milliseconds since the persistent format only supports times down to seconds
+    // so when we import data from a remote source, it may represent the (or even some msec newer) data
+    // which may be discarded due to higher runtime precision
     const int comparison = compare(targetEntry->timeInfo().lastModificationTime(),
                                    sourceEntry->timeInfo().lastModificationTime(),
                                    CompareItemIgnoreMilliseconds);
-    const int maxItems = targetEntry->database()->metadata()->historyMaxItems();
-    if (comparison < 0) {
+    entryMerge.sourceIsNewer = comparison < 0;
+    if (entryMerge.sourceIsNewer) {
+        // The history of the target is merged into a copy of the source
+        entryMerge.historyChanged = planHistory(targetEntry, sourceEntry, entryMerge.maxItems, entryMerge.history);
+    } else {
+        entryMerge.historyChanged = planHistory(sourceEntry, targetEntry, entryMerge.maxItems, entryMerge.history);
+    }
+}
+
+Merger::ChangeList Merger::applyEntryMerge(const EntryMerge& entryMerge)
+{
+    ChangeList changes;
+    if (entryMerge.identical) {
+        return changes;
+    }
+
+    const Entry* sourceEntry = entryMerge.sourceEntry;
+    Entry* targetEntry = entryMerge.targetEntry;
+    if (entryMerge.sourceIsNewer) {
         Group* currentGroup = targetEntry->group();
         Entry* clonedEntry = sourceEntry->clone(Entry::CloneIncludeHistory);
         qDebug("Merge %s/%s with alien on top under %s",
@@ -270,7 +426,9 @@ Merger::ChangeList Merger::resolveEntryConflict_MergeHistories(const MergeContex
                qPrintable(sourceEntry->title()),
                qPrintable(currentGroup->name()));
         changes << tr("Synchronizing from newer source %1 [%2]").arg(targetEntry->title(), targetEntry->uuidToHex());
-        mergeHistory(targetEntry, clonedEntry, mergeMethod, maxItems);
+        if (entryMerge.historyChanged) {
+            applyHistory(entryMerge.history, clonedEntry);
+        }
         eraseEntry(targetEntry);
         moveEntry(clonedEntry, currentGroup);
     } else {
@@ -278,8 +436,8 @@ Merger::ChangeList Merger::resolveEntryConflict_MergeHistories(const MergeContex
                qPrintable(targetEntry->title()),
                qPrintable(sourceEntry->title()),
                qPrintable(targetEntry->group()->name()));
-        const bool changed = mergeHistory(sourceEntry, targetEntry, mergeMethod, maxItems);
-        if (changed) {
+        if (entryMerge.historyChanged) {
+            applyHistory(entryMerge.history, targetEntry);
             changes
                 << tr("Synchronizing from older source %1 [%2]").arg(targetEntry->title(), targetEntry->uuidToHex());
         }
@@ -287,33 +445,48 @@ Merger::ChangeList Merger::resolveEntryConflict_MergeHistories(const MergeContex
     return changes;
 }
 
-Merger::ChangeList
-Merger::resolveEntryConflict(const MergeContext& context, const Entry* sourceEntry, Entry* targetEntry)
+Merger::ChangeList Merger::resolvePendingEntryMerges()
 {
-    // We need to cut off the milliseconds since the persistent format only supports times down to seconds
-    // so when we import data from a remote source, it may represent the (or even some msec newer) data
-    // which may be discarded due to higher runtime precision
+    const bool parallel = m_pendingEntryMerges.size() >= ParallelMinimumEntries
+                          && QThreadPool::globalInstance()->maxThreadCount() > 1;
+    if (parallel) {
+        QtConcurrent::blockingMap(m_pendingEntryMerges, &Merger::planEntryMerge);
+    } else {
+        for (auto& entryMerge : m_pendingEntryMerges) {
+            planEntryMerge(entryMerge);
+        }
+    }
 
-    Group::MergeMode mergeMode = m_mode == Group::Default ? context.m_targetGroup->mergeMode() : m_mode;
-    return resolveEntryConflict_MergeHistories(context, sourceEntry, targetEntry, mergeMode);
+    // Applied serially in tree order
+    ChangeList changes;
+    for (const auto& entryMerge : asConst(m_pendingEntryMerges)) {
+        changes << applyEntryMerge(entryMerge);
+    }
+    m_pendingEntryMerges.clear();
+    return changes;
 }
 
-bool Merger::mergeHistory(const Entry* sourceEntry,
-                          Entry* targetEntry,
-                          Group::MergeMode mergeMethod,
-                          const int maxItems)
+/**
+ * Merge the histories of both entries and the entry of sourceEntry into the history of targetEntry.
+ * The items of the merged history are referenced in history, from oldest to newest.
+ *
+ * @return true if the history of targetEntry changes
+ */
+bool Merger::planHistory(const Entry* sourceEntry,
+                         const Entry* targetEntry,
+                         const int maxItems,
+                         QList<const Entry*>& history)
 {
-    Q_UNUSED(mergeMethod);
-    const auto targetHistoryItems = targetEntry->historyItems();
-    const auto sourceHistoryItems = sourceEntry->historyItems();
+    const auto& targetHistoryItems = targetEntry->historyItems();
+    const auto& sourceHistoryItems = sourceEntry->historyItems();
     const int comparison = compare(sourceEntry->timeInfo().lastModificationTime(),
                                    targetEntry->timeInfo().lastModificationTime(),
                                    CompareItemIgnoreMilliseconds);
     const bool preferLocal = comparison < 0;
     const bool preferRemote = comparison > 0;
 
-    QMap<QDateTime, Entry*> merged;
-    for (Entry* historyItem : targetHistoryItems) {
+    QMap<QDateTime, const Entry*> merged;
+    for (const Entry* historyItem : targetHistoryItems) {
         const QDateTime modificationTime = Clock::serialized(historyItem->timeInfo().lastModificationTime());
         if (merged.contains(modificationTime)
             && !merged[modificationTime]->equals(historyItem, CompareItemIgnoreMilliseconds)) {
@@ -323,9 +496,9 @@ bool Merger::mergeHistory(const Entry* sourceEntry,
                        qPrintable(sourceEntry->uuidToHex()),
                        qPrintable(modificationTime.toString("yyyy-MM-dd HH-mm-ss-zzz")));
         }
-        merged[modificationTime] = historyItem->clone(Entry::CloneNoFlags);
+        merged[modificationTime] = historyItem;
     }
-    for (Entry* historyItem : sourceHistoryItems) {
+    for (const Entry* historyItem : sourceHistoryItems) {
         // Items with same modification-time changes will be regarded as same (like KeePass2)
         const QDateTime modificationTime = Clock::serialized(historyItem->timeInfo().lastModificationTime());
         if (merged.contains(modificationTime)
@@ -338,10 +511,10 @@ bool Merger::mergeHistory(const Entry* sourceEntry,
         }
         if (preferRemote && merged.contains(modificationTime)) {
             // forcefully apply the remote history item
-            delete merged.take(modificationTime);
+            merged.remove(modificationTime);
         }
         if (!merged.contains(modificationTime)) {
-            merged[modificationTime] = historyItem->clone(Entry::CloneNoFlags);
+            merged[modificationTime] = historyItem;
         }
     }
 
@@ -358,47 +531,50 @@ bool Merger::mergeHistory(const Entry* sourceEntry,
     if (targetModificationTime < sourceModificationTime) {
         if (preferLocal && merged.contains(targetModificationTime)) {
             // forcefully apply the local history item
-            delete merged.take(targetModificationTime);
+            merged.remove(targetModificationTime);
         }
         if (!merged.contains(targetModificationTime)) {
-            merged[targetModificationTime] = targetEntry->clone(Entry::CloneNoFlags);
+            merged[targetModificationTime] = targetEntry;
         }
     } else if (targetModificationTime > sourceModificationTime) {
-        if (preferRemote && !merged.contains(sourceModificationTime)) {
-            // forcefully apply the remote history item
-            delete merged.take(sourceModificationTime);
-        }
         if (!merged.contains(sourceModificationTime)) {
-            merged[sourceModificationTime] = sourceEntry->clone(Entry::CloneNoFlags);
+            merged[sourceModificationTime] = sourceEntry;
         }
     }
 
-    bool changed = false;
-    const auto updatedHistoryItems = merged.values();
+    history = merged.values();
+    // History items have no history of their own, the merged entries do
+    const CompareItemOptions options = CompareItemIgnoreMilliseconds | CompareItemIgnoreHistory;
     for (int i = 0; i < maxItems; ++i) {
         const Entry* oldEntry = targetHistoryItems.value(targetHistoryItems.count() - i);
-        const Entry* newEntry = updatedHistoryItems.value(updatedHistoryItems.count() - i);
+        const Entry* newEntry = history.value(history.count() - i);
         if (!oldEntry && !newEntry) {
             continue;
         }
-        if (oldEntry && newEntry && oldEntry->equals(newEntry, CompareItemIgnoreMilliseconds)) {
+        if (oldEntry && newEntry && oldEntry->equals(newEntry, options)) {
             continue;
         }
-        changed = true;
-        break;
+        return true;
     }
-    if (!changed) {
-        qDeleteAll(updatedHistoryItems);
-        return false;
+    return false;
+}
+
+void Merger::applyHistory(const QList<const Entry*>& history, Entry* targetEntry)
+{
+    // Copy first, the history may contain the current history items of targetEntry
+    QList<Entry*> historyItems;
+    for (const Entry* historyItem : history) {
+        historyItems.append(historyItem->clone(Entry::CloneNoFlags));
     }
+
     // We need to prevent any modification to the database since every change should be tracked either
     // in a clone history item or in the Entry itself
     const TimeInfo timeInfo = targetEntry->timeInfo();
     const bool blockedSignals = targetEntry->blockSignals(true);
     bool updateTimeInfo = targetEntry->canUpdateTimeinfo();
     targetEntry->setUpdateTimeinfo(false);
-    targetEntry->removeHistoryItems(targetHistoryItems);
-    for (Entry* historyItem : merged) {
+    targetEntry->removeHistoryItems(targetEntry->historyItems());
+    for (Entry* historyItem : asConst(historyItems)) {
         Q_ASSERT(!historyItem->parent());
         targetEntry->addHistoryItem(historyItem);
     }
@@ -407,7 +583,6 @@ bool Merger::mergeHistory(const Entry* sourceEntry,
     targetEntry->setUpdateTimeinfo(updateTimeInfo);
     Q_ASSERT(timeInfo == targetEntry->timeInfo());
     Q_UNUSED(timeInfo);
-    return true;
 }
 
 Merger::ChangeList Merger::mergeDeletions(const MergeContext& context)
@@ -423,7 +598,7 @@ Merger::ChangeList Merger::mergeDeletions(const MergeContext& context)
     const auto sourceDeletions = context.m_sourceDb->deletedObjects();
 
     QList<DeletedObject> deletions;
-    QMap<QUuid, DeletedObject> mergedDeletions;
+    QHash<QUuid, DeletedObject> mergedDeletions;
     QList<Entry*> entries;
     QList<Group*> groups;
 
@@ -466,19 +641,23 @@ Merger::ChangeList Merger::mergeDeletions(const MergeContext& context)
         eraseEntry(entry);
     }
 
+    QSet<Group*> pendingGroups = groups.toSet();
     while (!groups.isEmpty()) {
         auto* group = groups.takeFirst();
-        if (!(group->children().toSet() & groups.toSet()).isEmpty()) {
+        const auto& children = group->children();
+        if (std::any_of(
+                children.begin(), children.end(), [&](Group* child) { return pendingGroups.contains(child); })) {
             // we need to finish all children before we are able to determine if the group can be removed
             groups << group;
             continue;
         }
+        pendingGroups.remove(group);
         const auto& object = mergedDeletions[group->uuid()];
         if (group->timeInfo().lastModificationTime() > object.deletionTime) {
             // keep deleted group since it was changed after deletion date
             continue;
         }
-        if (!group->entriesRecursive(false).isEmpty() || !group->groupsRecursive(false).isEmpty()) {
+        if (!group->entries().isEmpty() || !group->children().isEmpty()) {
             // keep deleted group since it contains undeleted content
             continue;
         }
@@ -526,7 +705,8 @@ Merger::ChangeList Merger::mergeMetadata(const MergeContext& context)
         // Check missing keys from source. Remove those from target
         for (const auto& key : targetCustomDataKeys) {
             // Do not remove protected custom data
-            if (!sourceMetadata->customData()->contains(key) && !sourceMetadata->customData()->isProtected(key)) {
+            if (!sourceMetadata->customData()->contains(key) && !sourceMetadata->customData()->isProtected(key)
+                && !isWatermarkKey(key)) {
                 auto value = targetMetadata->customData()->value(key);
                 targetMetadata->customData()->remove(key);
                 changes << tr("Removed custom data %1 [%2]").arg(key, value);
@@ -536,7 +716,7 @@ Merger::ChangeList Merger::mergeMetadata(const MergeContext& context)
         // Transfer new/existing keys
         for (const auto& key : sourceCustomDataKeys) {
             // Don't merge this meta field, it is updated automatically.
-            if (key == CustomData::LastModified) {
+            if (key == CustomData::LastModified || isWatermarkKey(key)) {
                 continue;
             }
 
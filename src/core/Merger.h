@@ -31,8 +31,13 @@ public:
     Merger(const Group* sourceGroup, Group* targetGroup);
     void setForcedMergeMode(Group::MergeMode mode);
     void resetForcedMergeMode();
+    void setIncremental(bool incremental);
+    void setParallel(bool parallel);
     QStringList merge();
 
+    static QString watermarkKey(const Database* sourceDb);
+    static bool isWatermarkKey(const QString& key);
+
 private:
     typedef QString Change;
     typedef QStringList ChangeList;
@@ -46,10 +51,25 @@ private:
         QPointer<const Group> m_sourceGroup;
         QPointer<Group> m_targetGroup;
     };
+
+    struct EntryMerge
+    {
+        const Entry* sourceEntry = nullptr;
+        Entry* targetEntry = nullptr;
+        int maxItems = 0;
+        // Decided by planEntryMerge()
+        bool identical = false;
+        bool sourceIsNewer = false;
+        bool historyChanged = false;
+        // Merged history from oldest to newest, the items still belong to the source or target database
+        QList<const Entry*> history;
+    };
+
     ChangeList mergeGroup(const MergeContext& context);
     ChangeList mergeDeletions(const MergeContext& context);
     ChangeList mergeMetadata(const MergeContext& context);
-    bool mergeHistory(const Entry* sourceEntry, Entry* targetEntry, Group::MergeMode mergeMethod, const int maxItems);
+    bool isBeforeWatermark(const Entry* sourceEntry);
+    static bool isAlreadyMerged(const Entry* sourceEntry, const Entry* targetEntry);
     void moveEntry(Entry* entry, Group* targetGroup);
     void moveGroup(Group* group, Group* targetGroup);
     // remove an entry without a trace in the deletedObjects - needed for elemination cloned entries
@@ -58,14 +78,26 @@ private:
     void eraseGroup(Group* group);
     ChangeList resolveEntryConflict(const MergeContext& context, const Entry* existingEntry, Entry* otherEntry);
     ChangeList resolveGroupConflict(const MergeContext& context, const Group* existingGroup, Group* otherGroup);
-    Merger::ChangeList resolveEntryConflict_MergeHistories(const MergeContext& context,
-                                                           const Entry* sourceEntry,
-                                                           Entry* targetEntry,
-                                                           Group::MergeMode mergeMethod);
+    static void planEntryMerge(EntryMerge& entryMerge);
+    static bool planHistory(const Entry* sourceEntry,
+                            const Entry* targetEntry,
+                            const int maxItems,
+                            QList<const Entry*>& history);
+    ChangeList applyEntryMerge(const EntryMerge& entryMerge);
+    void applyHistory(const QList<const Entry*>& history, Entry* targetEntry);
+    ChangeList resolvePendingEntryMerges();
+
+    // Minimum number of entries to decide in parallel
+    static constexpr int ParallelMinimumEntries = 256;
 
 private:
     MergeContext m_context;
     Group::MergeMode m_mode;
+    bool m_incremental = false;
+    bool m_parallel = false;
+    QList<EntryMerge> m_pendingEntryMerges;
+    QDateTime m_watermark;
+    QDateTime m_newWatermark;
 };
 
 #endif // KEEPASSXC_MERGER_H
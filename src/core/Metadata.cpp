@@ -79,6 +79,7 @@ void Metadata::clear()
     m_customIcons.clear();
     m_customIconsOrder.clear();
     m_customIconsHashes.clear();
+    m_customIconsHashed = false;
     m_customData->clear();
 }
 
@@ -375,13 +376,16 @@ void Metadata::addCustomIcon(const QUuid& uuid, const CustomIconData& iconData)
     Q_ASSERT(!m_customIcons.contains(uuid));
 
     // remove all uuids to prevent duplicates in release mode
+    if (m_customIcons.contains(uuid)) {
+        m_customIconsOrder.removeAll(uuid);
+    }
     m_customIcons[uuid] = iconData;
-    m_customIconsOrder.removeAll(uuid);
     m_customIconsOrder.append(uuid);
 
-    // Associate image hash to uuid
-    QByteArray hash = hashIcon(iconData.data);
-    m_customIconsHashes[hash] = uuid;
+    // Associate image hash to uuid, unless the hashes are built on demand
+    if (m_customIconsHashed) {
+        m_customIconsHashes[hashIcon(iconData.data)] = uuid;
+    }
     Q_ASSERT(m_customIcons.count() == m_customIconsOrder.count());
 
     emitModified();
@@ -401,9 +405,11 @@ void Metadata::removeCustomIcon(const QUuid& uuid)
     Q_ASSERT(m_customIcons.contains(uuid));
 
     // Remove hash record only if this is the same uuid
-    QByteArray hash = hashIcon(m_customIcons[uuid].data);
-    if (m_customIconsHashes.contains(hash) && m_customIconsHashes[hash] == uuid) {
-        m_customIconsHashes.remove(hash);
+    if (m_customIconsHashed) {
+        QByteArray hash = hashIcon(m_customIcons[uuid].data);
+        if (m_customIconsHashes.contains(hash) && m_customIconsHashes[hash] == uuid) {
+            m_customIconsHashes.remove(hash);
+        }
     }
 
     m_customIcons.remove(uuid);
@@ -413,8 +419,22 @@ void Metadata::removeCustomIcon(const QUuid& uuid)
     emitModified();
 }
 
+/**
+ * Find a custom icon with the given image data.
+ *
+ * The image hashes are only computed the first time an icon is looked up,
+ * so databases with many icons don't hash all of them when they are opened.
+ */
 QUuid Metadata::findCustomIcon(const QByteArray& candidate)
 {
+    if (!m_customIconsHashed) {
+        m_customIconsHashes.reserve(m_customIconsOrder.size());
+        for (const QUuid& uuid : asConst(m_customIconsOrder)) {
+            m_customIconsHashes[hashIcon(m_customIcons.value(uuid).data)] = uuid;
+        }
+        m_customIconsHashed = true;
+    }
+
     QByteArray hash = hashIcon(candidate);
     return m_customIconsHashes.value(hash, QUuid());
 }
@@ -178,6 +178,7 @@ private:
     QList<QUuid> m_customIconsOrder;
     QHash<QUuid, CustomIconData> m_customIcons;
     QHash<QByteArray, QUuid> m_customIconsHashes;
+    bool m_customIconsHashed = false;
 
     QPointer<Group> m_recycleBin;
     QDateTime m_recycleBinChanged;
@@ -0,0 +1,208 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NetworkFile.h"
+
+#include "core/Endian.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStorageInfo>
+
+#ifdef Q_OS_WIN
+#include <Windows.h>
+#endif
+
+namespace
+{
+    struct CacheState
+    {
+        QMutex mutex;
+        QString directory;
+    };
+    Q_GLOBAL_STATIC(CacheState, s_cache)
+
+    const QByteArray CacheMagic("KPXCNFC1");
+    const int CacheHeaderSize = 8 + 2 * sizeof(qint64);
+
+    // Size and modification time of the file on the share
+    struct Stamp
+    {
+        qint64 size;
+        qint64 lastModified;
+    };
+
+    Stamp stampOf(const QString& path)
+    {
+        const QFileInfo info(path);
+        return {info.size(), info.lastModified().toMSecsSinceEpoch()};
+    }
+
+    QString cacheFilePath(const QString& path)
+    {
+        QMutexLocker locker(&s_cache->mutex);
+        if (s_cache->directory.isEmpty()) {
+            return {};
+        }
+        // The absolute path needs no request to the share, unlike the canonical one
+        const QByteArray key = QFileInfo(path).absoluteFilePath().toUtf8();
+        const QString name = QCryptographicHash::hash(key, QCryptographicHash::Sha256).toHex();
+        return QDir(s_cache->directory).filePath(name + ".cache");
+    }
+
+    bool readCache(const QString& cachePath, const Stamp& stamp, QByteArray& data)
+    {
+        QFile file(cachePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        const QByteArray cached = file.readAll();
+        if (cached.size() != CacheHeaderSize + stamp.size || !cached.startsWith(CacheMagic)) {
+            return false;
+        }
+
+        const char* header = cached.constData() + CacheMagic.size();
+        const auto size = Endian::bytesToSizedInt<qint64>(header, QSysInfo::LittleEndian);
+        const auto lastModified = Endian::bytesToSizedInt<qint64>(header + sizeof(qint64), QSysInfo::LittleEndian);
+        if (size != stamp.size || lastModified != stamp.lastModified) {
+            return false;
+        }
+
+        data = cached.mid(CacheHeaderSize);
+        return true;
+    }
+
+    void writeCache(const QString& cachePath, const Stamp& stamp, const QByteArray& data)
+    {
+        if (!QDir().mkpath(QFileInfo(cachePath).absolutePath())) {
+            return;
+        }
+
+        QSaveFile file(cachePath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return;
+        }
+        file.setPermissions(QFile::ReadOwner | QFile::WriteOwner);
+        file.write(CacheMagic);
+        file.write(Endian::sizedIntToBytes<qint64>(stamp.size, QSysInfo::LittleEndian));
+        file.write(Endian::sizedIntToBytes<qint64>(stamp.lastModified, QSysInfo::LittleEndian));
+        file.write(data);
+        if (!file.commit()) {
+            QFile::remove(cachePath);
+        }
+    }
+} // namespace
+
+namespace NetworkFile
+{
+    /**
+     * Check if a file is stored on a network share. Unknown file systems
+     * are treated as local.
+     */
+    bool isOnNetworkFileSystem(const QString& path)
+    {
+        const QStorageInfo storage(QFileInfo(path).absolutePath());
+#ifdef Q_OS_WIN
+        const QString root = QDir::toNativeSeparators(storage.isValid() ? storage.rootPath() : path);
+        if (root.startsWith("\\\\")) {
+            return true;
+        }
+        return GetDriveTypeW(reinterpret_cast<LPCWSTR>(root.utf16())) == DRIVE_REMOTE;
+#else
+        static const QList<QByteArray> networkTypes = {
+            "nfs", "nfs4", "cifs", "smb2", "smb3", "smbfs", "afpfs", "webdav", "davfs", "fuse.sshfs"};
+        return storage.isValid() && networkTypes.contains(storage.fileSystemType().toLower());
+#endif
+    }
+
+    /**
+     * Set the directory to keep local copies of files in. An empty path
+     * disables the copies.
+     */
+    void setCacheDirectory(const QString& path)
+    {
+        QMutexLocker locker(&s_cache->mutex);
+        s_cache->directory = path;
+    }
+
+    QString cacheDirectory()
+    {
+        QMutexLocker locker(&s_cache->mutex);
+        return s_cache->directory;
+    }
+
+    /**
+     * Read a whole file, from the local copy if it is still current.
+     *
+     * @param path file to read
+     * @param data content of the file
+     * @param error error message in case of failure
+     * @return true on success
+     */
+    bool read(const QString& path, QByteArray& data, QString* error)
+    {
+        // Taken before reading, a change while reading makes the copy stale
+        const Stamp stamp = stampOf(path);
+        const QString cachePath = cacheFilePath(path);
+        if (!cachePath.isEmpty() && readCache(cachePath, stamp, data)) {
+            return true;
+        }
+
+        // Unbuffered, the whole file is requested at once
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+            if (error) {
+                *error = file.errorString();
+            }
+            return false;
+        }
+        data = file.readAll();
+        if (file.error() != QFileDevice::NoError) {
+            if (error) {
+                *error = file.errorString();
+            }
+            return false;
+        }
+
+        if (!cachePath.isEmpty() && data.size() == stamp.size) {
+            writeCache(cachePath, stamp, data);
+        }
+        return true;
+    }
+
+    /**
+     * Replace the local copy of a file after it was written with data.
+     */
+    void updateCache(const QString& path, const QByteArray& data)
+    {
+        const QString cachePath = cacheFilePath(path);
+        if (cachePath.isEmpty()) {
+            return;
+        }
+
+        const Stamp stamp = stampOf(path);
+        if (stamp.size != data.size()) {
+            QFile::remove(cachePath);
+            return;
+        }
+        writeCache(cachePath, stamp, data);
+    }
+} // namespace NetworkFile
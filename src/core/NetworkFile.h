@@ -0,0 +1,47 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_NETWORKFILE_H
+#define KEEPASSXC_NETWORKFILE_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * File access for databases on network file systems such as SMB or NFS.
+ *
+ * Every request to a share pays the network latency, so files there are
+ * read in a single request and written by the caller in one block. If a
+ * cache directory is set, a local copy of each file read or written is kept
+ * and used instead of the share as long as the size and modification time
+ * of the file on the share are unchanged. The copy holds the file as it is,
+ * so databases stay encrypted.
+ *
+ * All functions can be called from any thread.
+ */
+namespace NetworkFile
+{
+    bool isOnNetworkFileSystem(const QString& path);
+
+    void setCacheDirectory(const QString& path);
+    QString cacheDirectory();
+
+    bool read(const QString& path, QByteArray& data, QString* error = nullptr);
+    void updateCache(const QString& path, const QByteArray& data);
+} // namespace NetworkFile
+
+#endif // KEEPASSXC_NETWORKFILE_H
@@ -17,10 +17,11 @@
 
 #include "PassphraseGenerator.h"
 
-#include <QFile>
-#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <cmath>
 
+#include "core/PassphraseWordlist.h"
 #include "core/Resources.h"
 #include "crypto/Random.h"
 
@@ -37,14 +38,14 @@ PassphraseGenerator::PassphraseGenerator()
 
 double PassphraseGenerator::estimateEntropy(int wordCount)
 {
-    if (m_wordlist.isEmpty()) {
+    if (wordlistSize() == 0) {
         return 0.0;
     }
     if (wordCount < 1) {
         wordCount = m_wordCount;
     }
 
-    return std::log2(m_wordlist.size()) * wordCount;
+    return std::log2(wordlistSize()) * wordCount;
 }
 
 void PassphraseGenerator::setWordCount(int wordCount)
@@ -59,40 +60,13 @@ void PassphraseGenerator::setWordCase(PassphraseWordCase wordCase)
 
 void PassphraseGenerator::setWordList(const QString& path)
 {
-    m_wordlist.clear();
-
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    m_wordlist = PassphraseWordlist::load(path);
+    if (!m_wordlist) {
         qWarning("Couldn't load passphrase wordlist.");
         return;
     }
 
-    QTextStream in(&file);
-    QString line = in.readLine();
-    bool isSigned = line.startsWith("-----BEGIN PGP SIGNED MESSAGE-----");
-    if (isSigned) {
-        while (!line.isNull() && !line.trimmed().isEmpty()) {
-            line = in.readLine();
-        }
-    }
-    QRegExp rx("^[0-9]+(-[0-9]+)*\\s+([^\\s]+)$");
-    while (!line.isNull()) {
-        if (isSigned && line.startsWith("-----BEGIN PGP SIGNATURE-----")) {
-            break;
-        }
-        // Handle dash-escaped lines (if the wordlist is signed)
-        if (isSigned && line.startsWith("- ")) {
-            line.remove(0, 2);
-        }
-        line = line.trimmed();
-        line.replace(rx, "\\2");
-        if (!line.isEmpty()) {
-            m_wordlist.append(line);
-        }
-        line = in.readLine();
-    }
-
-    if (m_wordlist.size() < 4000) {
+    if (m_wordlist->size() < 4000) {
         qWarning("Wordlist too short!");
         return;
     }
@@ -111,43 +85,98 @@ void PassphraseGenerator::setWordSeparator(const QString& separator)
 
 QString PassphraseGenerator::generatePassphrase() const
 {
-    QString tmpWord;
     Q_ASSERT(isValid());
 
     // In case there was an error loading the wordlist
-    if (m_wordlist.length() == 0) {
+    if (wordlistSize() == 0) {
         return {};
     }
 
     QStringList words;
     for (int i = 0; i < m_wordCount; ++i) {
-        int wordIndex = randomGen()->randomUInt(static_cast<quint32>(m_wordlist.length()));
-        tmpWord = m_wordlist.at(wordIndex);
-
-        // convert case
-        switch (m_wordCase) {
-        case UPPERCASE:
-            tmpWord = tmpWord.toUpper();
-            break;
-        case TITLECASE:
-            tmpWord = tmpWord.replace(0, 1, tmpWord.left(1).toUpper());
-            break;
-        case LOWERCASE:
-        default:
-            tmpWord = tmpWord.toLower();
-            break;
-        }
-        words.append(tmpWord);
+        int wordIndex = randomGen()->randomUInt(static_cast<quint32>(m_wordlist->size()));
+        words.append(convertCase(m_wordlist->word(wordIndex)));
     }
 
     return words.join(m_separator);
 }
 
+/**
+ * Generate several passphrases with the current settings.
+ *
+ * Only the sampled words are decoded, and large batches are split into
+ * shards generated on the global thread pool.
+ *
+ * @param count number of passphrases to generate
+ * @return the generated passphrases
+ */
+QStringList PassphraseGenerator::generatePassphrases(int count) const
+{
+    Q_ASSERT(isValid());
+
+    if (count <= 0 || wordlistSize() == 0) {
+        return {};
+    }
+
+    const auto size = static_cast<quint32>(m_wordlist->size());
+
+    QVector<QString> passphrases(count);
+    // Raw pointer, so that workers never check the container for detaching
+    QString* passphraseData = passphrases.data();
+    auto generateRange = [&](int begin, int end) {
+        QStringList words;
+        for (int i = begin; i < end; ++i) {
+            words.clear();
+            for (int j = 0; j < m_wordCount; ++j) {
+                words.append(convertCase(m_wordlist->word(randomGen()->randomUInt(size))));
+            }
+            passphraseData[i] = words.join(m_separator);
+        }
+    };
+
+    if (count < ParallelShardSize * 2 || QThreadPool::globalInstance()->maxThreadCount() <= 1) {
+        generateRange(0, count);
+        return passphrases.toList();
+    }
+
+    struct Shard
+    {
+        int begin;
+        int end;
+    };
+    const int shardCount = qMin(QThreadPool::globalInstance()->maxThreadCount() * 4, count / ParallelShardSize);
+    QVector<Shard> shards;
+    for (int i = 0; i < shardCount; ++i) {
+        shards.append({count * i / shardCount, count * (i + 1) / shardCount});
+    }
+    QtConcurrent::blockingMap(shards, [&](const Shard& shard) { generateRange(shard.begin, shard.end); });
+
+    return passphrases.toList();
+}
+
+QString PassphraseGenerator::convertCase(QString word) const
+{
+    switch (m_wordCase) {
+    case UPPERCASE:
+        return word.toUpper();
+    case TITLECASE:
+        return word.replace(0, 1, word.left(1).toUpper());
+    case LOWERCASE:
+    default:
+        return word.toLower();
+    }
+}
+
 bool PassphraseGenerator::isValid() const
 {
     if (m_wordCount == 0) {
         return false;
     }
 
-    return m_wordlist.size() >= 1000;
+    return wordlistSize() >= 1000;
+}
+
+int PassphraseGenerator::wordlistSize() const
+{
+    return m_wordlist ? m_wordlist->size() : 0;
 }
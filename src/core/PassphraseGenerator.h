@@ -18,7 +18,10 @@
 #ifndef KEEPASSX_PASSPHRASEGENERATOR_H
 #define KEEPASSX_PASSPHRASEGENERATOR_H
 
-#include <QVector>
+#include <QSharedPointer>
+#include <QStringList>
+
+class PassphraseWordlist;
 
 class PassphraseGenerator
 {
@@ -42,16 +45,22 @@ public:
     bool isValid() const;
 
     QString generatePassphrase() const;
+    QStringList generatePassphrases(int count) const;
 
     static constexpr int DefaultWordCount = 7;
     static const char* DefaultSeparator;
     static const char* DefaultWordList;
+    // Batches of at least twice this size are generated in parallel
+    static constexpr int ParallelShardSize = 256;
 
 private:
+    QString convertCase(QString word) const;
+    int wordlistSize() const;
+
     int m_wordCount;
     PassphraseWordCase m_wordCase;
     QString m_separator;
-    QVector<QString> m_wordlist;
+    QSharedPointer<const PassphraseWordlist> m_wordlist;
 };
 
 #endif // KEEPASSX_PASSPHRASEGENERATOR_H
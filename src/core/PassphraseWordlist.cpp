@@ -0,0 +1,223 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PassphraseWordlist.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    struct WordlistCache
+    {
+        QMutex mutex;
+        QHash<QString, QWeakPointer<const PassphraseWordlist>> wordlists;
+    };
+    Q_GLOBAL_STATIC(WordlistCache, s_cache)
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    bool startsWith(const char* begin, const char* end, const char* prefix)
+    {
+        const auto length = static_cast<size_t>(std::strlen(prefix));
+        return static_cast<size_t>(end - begin) >= length && std::memcmp(begin, prefix, length) == 0;
+    }
+
+    /**
+     * Skip a dice roll such as "12345" or "1-2-3-4-5" followed by
+     * whitespace and a single word.
+     *
+     * @return start of the word, or begin if the line has no dice roll
+     */
+    const char* skipDiceRoll(const char* begin, const char* end)
+    {
+        const char* p = begin;
+        while (true) {
+            if (p == end || !isDigit(*p)) {
+                return begin;
+            }
+            while (p != end && isDigit(*p)) {
+                ++p;
+            }
+            if (p == end || *p != '-') {
+                break;
+            }
+            ++p;
+        }
+
+        if (p == end || !isSpace(*p)) {
+            return begin;
+        }
+        while (p != end && isSpace(*p)) {
+            ++p;
+        }
+        for (const char* q = p; q != end; ++q) {
+            if (isSpace(*q)) {
+                return begin;
+            }
+        }
+        return p;
+    }
+} // namespace
+
+/**
+ * Load a word list, reusing the copy already loaded by this process
+ * unless the file has changed since.
+ *
+ * @param path word list file
+ * @return the word list, or null if the file cannot be read
+ */
+QSharedPointer<const PassphraseWordlist> PassphraseWordlist::load(const QString& path)
+{
+    const QString canonicalPath = QFileInfo(path).canonicalFilePath();
+    if (canonicalPath.isEmpty()) {
+        return {};
+    }
+
+    QMutexLocker locker(&s_cache->mutex);
+
+    auto cached = s_cache->wordlists.value(canonicalPath).toStrongRef();
+    if (cached && cached->isCurrent(canonicalPath)) {
+        return cached;
+    }
+
+    QSharedPointer<PassphraseWordlist> wordlist(new PassphraseWordlist());
+    if (!wordlist->open(canonicalPath)) {
+        s_cache->wordlists.remove(canonicalPath);
+        return {};
+    }
+
+    s_cache->wordlists.insert(canonicalPath, wordlist);
+    return wordlist;
+}
+
+int PassphraseWordlist::size() const
+{
+    return m_words.size();
+}
+
+bool PassphraseWordlist::isEmpty() const
+{
+    return m_words.isEmpty();
+}
+
+/**
+ * Decode a single word of the list.
+ */
+QString PassphraseWordlist::word(int index) const
+{
+    Q_ASSERT(index >= 0 && index < m_words.size());
+
+    const Span& span = m_words.at(index);
+    return QString::fromUtf8(m_data.constData() + span.offset, static_cast<int>(span.length));
+}
+
+bool PassphraseWordlist::open(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    m_size = file.size();
+    m_lastModified = QFileInfo(file).lastModified();
+    // Spans are 32 bit, and a QByteArray holds less than 2 GiB anyway
+    if (m_size > std::numeric_limits<int>::max()) {
+        return false;
+    }
+
+    // The file isn't kept open, so it can be replaced or removed while the list is in use
+    m_data = file.readAll();
+    if (file.error() != QFileDevice::NoError) {
+        return false;
+    }
+    file.close();
+
+    buildIndex();
+    return true;
+}
+
+void PassphraseWordlist::buildIndex()
+{
+    const char* const data = m_data.constData();
+    const char* const end = data + m_data.size();
+
+    const char* lineBegin = data;
+    // Skip a UTF-8 byte order mark
+    if (startsWith(lineBegin, end, "\xEF\xBB\xBF")) {
+        lineBegin += 3;
+    }
+
+    const bool isSigned = startsWith(lineBegin, end, "-----BEGIN PGP SIGNED MESSAGE-----");
+    // The armor headers of a signed list end with an empty line
+    bool inHeader = isSigned;
+
+    while (lineBegin < end) {
+        const auto* newline = static_cast<const char*>(std::memchr(lineBegin, '\n', end - lineBegin));
+        const char* begin = lineBegin;
+        const char* stop = newline ? newline : end;
+        lineBegin = newline ? newline + 1 : end;
+
+        if (isSigned && !inHeader) {
+            if (startsWith(begin, stop, "-----BEGIN PGP SIGNATURE-----")) {
+                break;
+            }
+            // Handle dash-escaped lines
+            if (startsWith(begin, stop, "- ")) {
+                begin += 2;
+            }
+        }
+
+        while (begin != stop && isSpace(*begin)) {
+            ++begin;
+        }
+        while (stop != begin && isSpace(*(stop - 1))) {
+            --stop;
+        }
+
+        if (inHeader) {
+            inHeader = begin != stop;
+            continue;
+        }
+
+        begin = skipDiceRoll(begin, stop);
+        if (begin != stop) {
+            m_words.append({static_cast<quint32>(begin - data), static_cast<quint32>(stop - begin)});
+        }
+    }
+
+    m_words.squeeze();
+}
+
+bool PassphraseWordlist::isCurrent(const QString& path) const
+{
+    const QFileInfo info(path);
+    return info.size() == m_size && info.lastModified() == m_lastModified;
+}
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_PASSPHRASEWORDLIST_H
+#define KEEPASSXC_PASSPHRASEWORDLIST_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QSharedPointer>
+#include <QVector>
+
+/**
+ * Read-only word list for the passphrase generator.
+ *
+ * The file is read in one piece and closed, then indexed once: only the
+ * offset and length of each word are stored next to the raw contents, and
+ * a word is decoded from UTF-8 when it is sampled. Word lists are shared by
+ * all generators in the process and reloaded when the file changes on disk.
+ *
+ * Lines are parsed like diceware lists: an optional dice roll prefix is
+ * stripped, and PGP signed lists are read from their signed body.
+ */
+class PassphraseWordlist
+{
+public:
+    Q_DISABLE_COPY(PassphraseWordlist)
+
+    static QSharedPointer<const PassphraseWordlist> load(const QString& path);
+
+    int size() const;
+    bool isEmpty() const;
+    QString word(int index) const;
+
+private:
+    struct Span
+    {
+        quint32 offset;
+        quint32 length;
+    };
+
+    PassphraseWordlist() = default;
+
+    bool open(const QString& path);
+    void buildIndex();
+    bool isCurrent(const QString& path) const;
+
+    QByteArray m_data;
+    qint64 m_size = 0;
+    QDateTime m_lastModified;
+    QVector<Span> m_words;
+};
+
+#endif // KEEPASSXC_PASSPHRASEWORDLIST_H
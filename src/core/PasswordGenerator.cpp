@@ -20,6 +20,9 @@
 
 #include "crypto/Random.h"
 
+#include <QThreadPool>
+#include <QtConcurrent>
+
 const int PasswordGenerator::DefaultLength = 32;
 const char* PasswordGenerator::DefaultCustomCharacterSet = "";
 const char* PasswordGenerator::DefaultExcludedChars = "";
@@ -62,15 +65,67 @@ QString PasswordGenerator::generatePassword() const
     Q_ASSERT(isValid());
 
     const QVector<PasswordGroup> groups = passwordGroups();
+    return generatePassword(groups, flattenGroups(groups));
+}
 
-    QVector<QChar> passwordChars;
-    for (const PasswordGroup& group : groups) {
-        for (QChar ch : group) {
-            passwordChars.append(ch);
+/**
+ * Generate several passwords with the current settings.
+ *
+ * The character groups are built once for the whole batch, and large
+ * batches are split into shards generated on the global thread pool.
+ * Random bytes are buffered per thread, so the workers do not contend
+ * for the random number generator.
+ *
+ * @param count number of passwords to generate
+ * @return the generated passwords
+ */
+QStringList PasswordGenerator::generatePasswords(int count) const
+{
+    Q_ASSERT(isValid());
+
+    if (count <= 0) {
+        return {};
+    }
+
+    const QVector<PasswordGroup> groups = passwordGroups();
+    const QVector<QChar> passwordChars = flattenGroups(groups);
+
+    QVector<QString> passwords(count);
+    // Raw pointer, so that workers never check the container for detaching
+    QString* passwordData = passwords.data();
+
+    if (count < ParallelShardSize * 2 || QThreadPool::globalInstance()->maxThreadCount() <= 1) {
+        for (int i = 0; i < count; ++i) {
+            passwordData[i] = generatePassword(groups, passwordChars);
         }
+        return passwords.toList();
+    }
+
+    struct Shard
+    {
+        int begin;
+        int end;
+    };
+    const int shardCount = qMin(QThreadPool::globalInstance()->maxThreadCount() * 4, count / ParallelShardSize);
+    QVector<Shard> shards;
+    for (int i = 0; i < shardCount; ++i) {
+        shards.append({count * i / shardCount, count * (i + 1) / shardCount});
     }
 
+    QtConcurrent::blockingMap(shards, [&](const Shard& shard) {
+        for (int i = shard.begin; i < shard.end; ++i) {
+            passwordData[i] = generatePassword(groups, passwordChars);
+        }
+    });
+
+    return passwords.toList();
+}
+
+QString PasswordGenerator::generatePassword(const QVector<PasswordGroup>& groups,
+                                            const QVector<QChar>& passwordChars) const
+{
     QString password;
+    password.reserve(m_length);
 
     if (m_flags & CharFromEveryGroup) {
         for (const auto& group : groups) {
@@ -104,6 +159,15 @@ QString PasswordGenerator::generatePassword() const
     return password;
 }
 
+QVector<QChar> PasswordGenerator::flattenGroups(const QVector<PasswordGroup>& groups)
+{
+    QVector<QChar> passwordChars;
+    for (const PasswordGroup& group : groups) {
+        passwordChars += group;
+    }
+    return passwordChars;
+}
+
 bool PasswordGenerator::isValid() const
 {
     if (m_classes == CharClass::NoClass && m_custom.isEmpty()) {
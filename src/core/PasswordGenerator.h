@@ -20,6 +20,7 @@
 #define KEEPASSX_PASSWORDGENERATOR_H
 
 #include <QObject>
+#include <QStringList>
 #include <QVector>
 
 typedef QVector<QChar> PasswordGroup;
@@ -75,12 +76,17 @@ public:
     const QString& getExcludedCharacterSet() const;
 
     QString generatePassword() const;
+    QStringList generatePasswords(int count) const;
 
     static const int DefaultLength;
     static const char* DefaultCustomCharacterSet;
     static const char* DefaultExcludedChars;
+    // Batches of at least twice this size are generated in parallel
+    static constexpr int ParallelShardSize = 256;
 
 private:
+    QString generatePassword(const QVector<PasswordGroup>& groups, const QVector<QChar>& passwordChars) const;
+    static QVector<QChar> flattenGroups(const QVector<PasswordGroup>& groups);
     QVector<PasswordGroup> passwordGroups() const;
     int numCharClasses() const;
 
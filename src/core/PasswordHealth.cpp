@@ -16,16 +16,65 @@
  */
 
 #include <QString>
+#include <QtEndian>
+
+#include <cstring>
 
 #include "Group.h"
+#include "Metadata.h"
 #include "PasswordHealth.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
 #include "zxcvbn.h"
 
 namespace
 {
     const static int ZXCVBN_ESTIMATE_THRESHOLD = 256;
+
+    // Bounds the memory used by the cache when many passwords are typed or generated
+    const static int CACHE_MAX_SIZE = 1 << 17;
+
+    // A stored record is a truncated keyed hash of the password and its entropy
+    const static int STORED_HASH_SIZE = 16;
+    const static int STORED_RECORD_SIZE = STORED_HASH_SIZE + 8;
+    const static int STORED_KEY_SIZE = 32;
+    const static QString STORED_VERSION = QStringLiteral("1");
+
+    double estimateEntropy(const QString& pwd)
+    {
+        auto entropy = 0.0;
+        entropy += ZxcvbnMatch(pwd.left(ZXCVBN_ESTIMATE_THRESHOLD).toUtf8(), nullptr, nullptr);
+        if (pwd.length() > ZXCVBN_ESTIMATE_THRESHOLD) {
+            // Add the average entropy per character for any characters above the estimate threshold
+            auto average = entropy / ZXCVBN_ESTIMATE_THRESHOLD;
+            entropy += average * (pwd.length() - ZXCVBN_ESTIMATE_THRESHOLD);
+        }
+        return entropy;
+    }
+
+    QByteArray storedHash(const QString& password, const QByteArray& key)
+    {
+        return CryptoHash::hmac(password.toUtf8(), key, CryptoHash::Sha256).left(STORED_HASH_SIZE);
+    }
+
+    // The passwords of the entries of a database, as the entries analyse them
+    QSet<QString> databasePasswords(const Database* db)
+    {
+        QSet<QString> passwords;
+        db->rootGroup()->forEachEntryRecursive([&passwords](const Entry* entry) {
+            if (!entry->isRecycled() && !entry->password().isEmpty()) {
+                passwords.insert(entry->password());
+                passwords.insert(entry->resolvePlaceholder(entry->password()));
+            }
+        });
+        return passwords;
+    }
 } // namespace
 
+Q_GLOBAL_STATIC(PasswordHealthCache, s_passwordHealthCache)
+
+const QString PasswordHealthCache::CustomDataKey = QStringLiteral("KPXC_PASSWORD_HEALTH");
+
 PasswordHealth::PasswordHealth(double entropy)
 {
     init(entropy);
@@ -33,14 +82,7 @@ PasswordHealth::PasswordHealth(double entropy)
 
 PasswordHealth::PasswordHealth(const QString& pwd)
 {
-    auto entropy = 0.0;
-    entropy += ZxcvbnMatch(pwd.left(ZXCVBN_ESTIMATE_THRESHOLD).toUtf8(), nullptr, nullptr);
-    if (pwd.length() > ZXCVBN_ESTIMATE_THRESHOLD) {
-        // Add the average entropy per character for any characters above the estimate threshold
-        auto average = entropy / ZXCVBN_ESTIMATE_THRESHOLD;
-        entropy += average * (pwd.length() - ZXCVBN_ESTIMATE_THRESHOLD);
-    }
-    init(entropy);
+    init(PasswordHealthCache::instance()->entropy(pwd));
 }
 
 void PasswordHealth::init(double entropy)
@@ -114,14 +156,10 @@ PasswordHealth::Quality PasswordHealth::quality() const
  * than can be derived from the password itself (re-use, expiry).
  */
 HealthChecker::HealthChecker(QSharedPointer<Database> db)
+    : m_db(std::move(db))
 {
-    // Build the cache of re-used passwords
-    for (const auto* entry : db->rootGroup()->entriesRecursive()) {
-        if (!entry->isRecycled() && !entry->isAttributeReference("Password")) {
-            m_reuse[entry->password()]
-                << QObject::tr("Used in %1/%2").arg(entry->group()->hierarchy().join('/'), entry->title());
-        }
-    }
+    // Build the password index now, so evaluating entries from other threads only reads it
+    m_db->passwordIndex();
 }
 
 /**
@@ -138,23 +176,47 @@ QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry) const
     }
 
     // First analyse the password itself
+    return evaluate(entry, PasswordHealth(entry->password()));
+}
+
+/**
+ * Returns the health of `entry` from the health of its password alone.
+ *
+ * The password analysis is the expensive part, so callers may run it
+ * elsewhere, once for every distinct password, and finish each entry here.
+ * Putting the description together is not free either; callers that only
+ * show some of it can ask for less.
+ */
+QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry,
+                                                      const PasswordHealth& passwordHealth,
+                                                      Description description) const
+{
+    if (!entry) {
+        return {};
+    }
+
     const auto pwd = entry->password();
-    auto health = QSharedPointer<PasswordHealth>(new PasswordHealth(pwd));
+    auto health = QSharedPointer<PasswordHealth>(new PasswordHealth(passwordHealth));
 
     // Second, if the password is in the database more than once,
     // reduce the score accordingly
-    const auto& used = m_reuse[pwd];
-    const auto count = used.size();
+    const auto count = m_db->passwordIndex().reuseCount(pwd);
     if (count > 1) {
         constexpr auto penalty = 15;
         health->adjustScore(-penalty * (count - 1));
-        health->addScoreReason(QObject::tr("Password is used %1 time(s)", "", count).arg(QString::number(count)));
-        // Add the first 20 uses of the password to prevent the details display from growing too large
-        for (int i = 0; i < used.size(); ++i) {
-            health->addScoreDetails(used[i]);
-            if (i == 19) {
-                health->addScoreDetails("…");
-                break;
+        if (description != Description::None) {
+            health->addScoreReason(QObject::tr("Password is used %1 time(s)", "", count).arg(QString::number(count)));
+        }
+        if (description == Description::Full) {
+            // Add the first 20 uses of the password to prevent the details display from growing too large
+            const auto used = m_db->passwordIndex().entriesWithPassword(pwd);
+            for (int i = 0; i < used.size(); ++i) {
+                health->addScoreDetails(
+                    QObject::tr("Used in %1/%2").arg(used[i]->group()->hierarchy().join('/'), used[i]->title()));
+                if (i == 19) {
+                    health->addScoreDetails("…");
+                    break;
+                }
             }
         }
 
@@ -170,9 +232,13 @@ QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry) const
     // reduce score by 2 points per day.
     if (entry->isExpired()) {
         health->setScore(0);
-        health->addScoreReason(QObject::tr("Password has expired"));
-        health->addScoreDetails(QObject::tr("Password expiry was %1")
-                                    .arg(entry->timeInfo().expiryTime().toString(Qt::DefaultLocaleShortDate)));
+        if (description != Description::None) {
+            health->addScoreReason(QObject::tr("Password has expired"));
+        }
+        if (description == Description::Full) {
+            health->addScoreDetails(QObject::tr("Password expiry was %1")
+                                        .arg(entry->timeInfo().expiryTime().toString(Qt::DefaultLocaleShortDate)));
+        }
     } else if (entry->timeInfo().expires()) {
         const int days = QDateTime::currentDateTime().daysTo(entry->timeInfo().expiryTime());
         if (days <= 30) {
@@ -186,14 +252,19 @@ QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry) const
             }
 
             health->adjustScore((30 - days) * -2);
-            health->addScoreDetails(QObject::tr("Password expires on %1")
-                                        .arg(entry->timeInfo().expiryTime().toString(Qt::DefaultLocaleShortDate)));
-            if (days <= 2) {
-                health->addScoreReason(QObject::tr("Password is about to expire"));
-            } else if (days <= 10) {
-                health->addScoreReason(QObject::tr("Password expires in %1 day(s)", "", days).arg(days));
-            } else {
-                health->addScoreReason(QObject::tr("Password will expire soon"));
+            if (description == Description::Full) {
+                health->addScoreDetails(
+                    QObject::tr("Password expires on %1")
+                        .arg(entry->timeInfo().expiryTime().toString(Qt::DefaultLocaleShortDate)));
+            }
+            if (description != Description::None) {
+                if (days <= 2) {
+                    health->addScoreReason(QObject::tr("Password is about to expire"));
+                } else if (days <= 10) {
+                    health->addScoreReason(QObject::tr("Password expires in %1 day(s)", "", days).arg(days));
+                } else {
+                    health->addScoreReason(QObject::tr("Password will expire soon"));
+                }
             }
         }
     }
@@ -201,3 +272,168 @@ QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry) const
     // Return the result
     return health;
 }
+
+/**
+ * Returns the quality of the password in `entry`. The score is the same
+ * as with evaluate(), but no reasons or details are put together.
+ */
+PasswordHealth::Quality HealthChecker::quality(const Entry* entry) const
+{
+    if (!entry) {
+        return PasswordHealth::Quality::Bad;
+    }
+    return evaluate(entry, PasswordHealth(entry->password()), Description::None)->quality();
+}
+
+PasswordHealthCache::PasswordHealthCache()
+    : m_key(randomGen()->randomArray(32))
+{
+}
+
+PasswordHealthCache* PasswordHealthCache::instance()
+{
+    return s_passwordHealthCache;
+}
+
+QByteArray PasswordHealthCache::sessionHash(const QString& password) const
+{
+    return CryptoHash::hmac(password.toUtf8(), m_key, CryptoHash::Sha256);
+}
+
+/**
+ * Returns the entropy of `password`, analysing it only if it was not
+ * analysed before in this session. Safe to call from any thread.
+ */
+double PasswordHealthCache::entropy(const QString& password)
+{
+    const auto hash = sessionHash(password);
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entropy.constFind(hash);
+        if (it != m_entropy.constEnd()) {
+            return it.value();
+        }
+    }
+
+    // Analyse outside of the lock, passwords are analysed in parallel
+    const double entropy = estimateEntropy(password);
+
+    QMutexLocker locker(&m_mutex);
+    if (m_entropy.size() >= CACHE_MAX_SIZE) {
+        m_entropy.clear();
+    }
+    m_entropy.insert(hash, entropy);
+    return entropy;
+}
+
+bool PasswordHealthCache::contains(const QString& password) const
+{
+    const auto hash = sessionHash(password);
+    QMutexLocker locker(&m_mutex);
+    return m_entropy.contains(hash);
+}
+
+void PasswordHealthCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entropy.clear();
+}
+
+/**
+ * Add the results stored in the custom data of `db` to the cache.
+ * Stored records are looked up by the passwords of the database entries,
+ * records for passwords no longer in use are ignored.
+ */
+void PasswordHealthCache::load(const Database* db)
+{
+    const auto value = db->metadata()->customData()->value(CustomDataKey);
+    const auto parts = value.split(';');
+    if (parts.size() != 3 || parts[0] != STORED_VERSION) {
+        return;
+    }
+
+    const auto key = QByteArray::fromBase64(parts[1].toLatin1());
+    const auto records = QByteArray::fromBase64(parts[2].toLatin1());
+    if (key.size() != STORED_KEY_SIZE || records.size() % STORED_RECORD_SIZE != 0) {
+        return;
+    }
+
+    QHash<QByteArray, double> stored;
+    for (int i = 0; i < records.size(); i += STORED_RECORD_SIZE) {
+        const auto bits = qFromBigEndian<quint64>(records.constData() + i + STORED_HASH_SIZE);
+        double entropy;
+        memcpy(&entropy, &bits, sizeof(entropy));
+        stored.insert(records.mid(i, STORED_HASH_SIZE), entropy);
+    }
+
+    const auto passwords = databasePasswords(db);
+    for (const auto& password : passwords) {
+        auto it = stored.constFind(storedHash(password, key));
+        if (it != stored.constEnd()) {
+            const auto hash = sessionHash(password);
+            QMutexLocker locker(&m_mutex);
+            if (m_entropy.size() < CACHE_MAX_SIZE) {
+                m_entropy.insert(hash, it.value());
+            }
+        }
+    }
+}
+
+/**
+ * Store the cached results for the passwords of `db` in its custom data.
+ * A new key is used every time, so stored records can't be matched between
+ * versions of the file. This does not mark the database as modified.
+ */
+void PasswordHealthCache::store(Database* db) const
+{
+    const auto key = randomGen()->randomArray(STORED_KEY_SIZE);
+
+    QByteArray records;
+    const auto passwords = databasePasswords(db);
+    for (const auto& password : passwords) {
+        double entropy;
+        {
+            const auto hash = sessionHash(password);
+            QMutexLocker locker(&m_mutex);
+            auto it = m_entropy.constFind(hash);
+            if (it == m_entropy.constEnd()) {
+                continue;
+            }
+            entropy = it.value();
+        }
+
+        quint64 bits;
+        memcpy(&bits, &entropy, sizeof(bits));
+        char bytes[sizeof(bits)];
+        qToBigEndian(bits, bytes);
+        records.append(storedHash(password, key));
+        records.append(bytes, sizeof(bytes));
+    }
+
+    const bool emitModified = db->modifiedSignalEnabled();
+    db->setEmitModified(false);
+    if (records.isEmpty()) {
+        db->metadata()->customData()->remove(CustomDataKey);
+    } else {
+        db->metadata()->customData()->set(
+            CustomDataKey,
+            QStringList({STORED_VERSION, QString::fromLatin1(key.toBase64()), QString::fromLatin1(records.toBase64())})
+                .join(';'));
+    }
+    db->setEmitModified(emitModified);
+}
+
+/**
+ * Remove the stored results from the custom data of `db`, without marking it as modified.
+ */
+void PasswordHealthCache::remove(Database* db)
+{
+    if (!db->metadata()->customData()->contains(CustomDataKey)) {
+        return;
+    }
+
+    const bool emitModified = db->modifiedSignalEnabled();
+    db->setEmitModified(false);
+    db->metadata()->customData()->remove(CustomDataKey);
+    db->setEmitModified(emitModified);
+}
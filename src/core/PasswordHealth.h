@@ -19,6 +19,7 @@
 #define KEEPASSX_PASSWORDHEALTH_H
 
 #include <QHash>
+#include <QMutex>
 #include <QSharedPointer>
 
 class Database;
@@ -107,12 +108,60 @@ class HealthChecker
 public:
     explicit HealthChecker(QSharedPointer<Database>);
 
+    // How much of the description of a health status to put together
+    enum class Description
+    {
+        None,
+        Reasons,
+        Full
+    };
+
     // Get the health status of an entry in the database
     QSharedPointer<PasswordHealth> evaluate(const Entry* entry) const;
+    // Same, but starting from the already analysed health of the entry's password
+    QSharedPointer<PasswordHealth> evaluate(const Entry* entry,
+                                            const PasswordHealth& passwordHealth,
+                                            Description description = Description::Full) const;
+    // Get only the quality of an entry, without building any description
+    PasswordHealth::Quality quality(const Entry* entry) const;
 
 private:
-    // To determine password re-use: first = password, second = entries that use it
-    QHash<QString, QStringList> m_reuse;
+    // Password re-use is looked up in the password index of the database
+    QSharedPointer<Database> m_db;
+};
+
+/**
+ * Entropy of the passwords analysed in this session, shared by everything
+ * that creates a PasswordHealth. Passwords are looked up by a keyed hash
+ * with a random session key, so the cache holds no plaintext.
+ *
+ * The results for the passwords of a database can also be kept in its
+ * custom data, which is encrypted with the database, so that the health
+ * of its entries is known right after unlocking.
+ */
+class PasswordHealthCache
+{
+public:
+    PasswordHealthCache();
+
+    static PasswordHealthCache* instance();
+
+    double entropy(const QString& password);
+    bool contains(const QString& password) const;
+    void clear();
+
+    void load(const Database* db);
+    void store(Database* db) const;
+    static void remove(Database* db);
+
+    static const QString CustomDataKey;
+
+private:
+    QByteArray sessionHash(const QString& password) const;
+
+    mutable QMutex m_mutex;
+    const QByteArray m_key;
+    QHash<QByteArray, double> m_entropy;
 };
 
 #endif // KEEPASSX_PASSWORDHEALTH_H
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PasswordStrengthEstimator.h"
+
+#include "core/AsyncTask.h"
+#include "core/PasswordHealth.h"
+
+#include <cmath>
+
+PasswordStrengthEstimator::PasswordStrengthEstimator(QObject* parent)
+    : QObject(parent)
+{
+    m_delay.setSingleShot(true);
+    m_delay.setInterval(150);
+    connect(&m_delay, SIGNAL(timeout()), SLOT(startAnalysis()));
+    connect(&m_watcher, SIGNAL(finished()), SLOT(finishAnalysis()));
+}
+
+/**
+ * Estimate the entropy of `password`, replacing any password given before.
+ * The result is reported with the estimated() signal, possibly before
+ * this returns.
+ */
+void PasswordStrengthEstimator::estimate(const QString& password)
+{
+    m_password = password;
+
+    if (!needsAnalysis(password)) {
+        m_delay.stop();
+        emit estimated(password.isEmpty() ? 0.0 : PasswordHealthCache::instance()->entropy(password), false);
+        return;
+    }
+
+    emit estimated(charsetEntropy(password), true);
+    m_delay.start();
+}
+
+/**
+ * Drop the password given before, nothing is reported for it any more.
+ */
+void PasswordStrengthEstimator::cancel()
+{
+    m_password.clear();
+    m_delay.stop();
+}
+
+/**
+ * Time to wait for typing to pause before analysing a long password.
+ */
+void PasswordStrengthEstimator::setDelay(int msec)
+{
+    m_delay.setInterval(msec);
+}
+
+/**
+ * Entropy of a random password of the same length drawn from the
+ * character classes used in `password`. Cheap, but only an upper bound.
+ */
+double PasswordStrengthEstimator::charsetEntropy(const QString& password)
+{
+    bool lower = false, upper = false, digits = false, symbols = false, other = false;
+    for (const auto& c : password) {
+        if (c >= 'a' && c <= 'z') {
+            lower = true;
+        } else if (c >= 'A' && c <= 'Z') {
+            upper = true;
+        } else if (c >= '0' && c <= '9') {
+            digits = true;
+        } else if (c.unicode() < 128) {
+            symbols = true;
+        } else {
+            other = true;
+        }
+    }
+
+    // The same character classes as the zxcvbn brute force estimate
+    const int cardinality = (lower ? 26 : 0) + (upper ? 26 : 0) + (digits ? 10 : 0) + (symbols ? 33 : 0)
+                            + (other ? 100 : 0);
+    return cardinality == 0 ? 0.0 : password.size() * std::log2(cardinality);
+}
+
+bool PasswordStrengthEstimator::needsAnalysis(const QString& password) const
+{
+    return password.size() > SyncLength && !PasswordHealthCache::instance()->contains(password);
+}
+
+void PasswordStrengthEstimator::startAnalysis()
+{
+    // The running analysis picks up the latest password once it is done
+    if (m_watcher.isRunning()) {
+        return;
+    }
+
+    m_analysedPassword = m_password;
+    m_watcher.setFuture(
+        AsyncTask::run([password = m_password] { return PasswordHealthCache::instance()->entropy(password); }));
+}
+
+void PasswordStrengthEstimator::finishAnalysis()
+{
+    if (m_analysedPassword == m_password) {
+        emit estimated(m_watcher.result(), false);
+    } else if (!m_delay.isActive() && needsAnalysis(m_password)) {
+        // The password changed while it was analysed and typing has paused since
+        startAnalysis();
+    }
+    m_analysedPassword.clear();
+}
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_PASSWORDSTRENGTHESTIMATOR_H
+#define KEEPASSXC_PASSWORDSTRENGTHESTIMATOR_H
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QTimer>
+
+/**
+ * Entropy of a password that is being typed, for strength meters.
+ *
+ * Short passwords and passwords analysed before are estimated right away.
+ * Longer ones are analysed on the thread pool once typing pauses; until
+ * then a cheap estimate from the character classes is reported. Only the
+ * latest password is ever analysed, results for older ones are dropped.
+ */
+class PasswordStrengthEstimator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PasswordStrengthEstimator(QObject* parent = nullptr);
+
+    void estimate(const QString& password);
+    void cancel();
+    void setDelay(int msec);
+
+    static double charsetEntropy(const QString& password);
+
+    // Passwords up to this length are analysed right away
+    static const int SyncLength = 32;
+
+signals:
+    // provisional is set for the character class estimate reported until the analysis is done
+    void estimated(double entropy, bool provisional);
+
+private slots:
+    void startAnalysis();
+    void finishAnalysis();
+
+private:
+    bool needsAnalysis(const QString& password) const;
+
+    QString m_password;
+    QString m_analysedPassword;
+    QTimer m_delay;
+    QFutureWatcher<double> m_watcher;
+};
+
+#endif // KEEPASSXC_PASSWORDSTRENGTHESTIMATOR_H
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProtectedValue.h"
+
+/**
+ * @param keyStream key stream of the file the value was read from
+ * @param offset offset of the value in the key stream
+ * @param ciphertext encrypted UTF-8 value
+ */
+ProtectedValue::ProtectedValue(QSharedPointer<const KeyStream> keyStream, qint64 offset, QByteArray ciphertext)
+    : m_keyStream(std::move(keyStream))
+    , m_offset(offset)
+    , m_ciphertext(std::move(ciphertext))
+{
+}
+
+bool ProtectedValue::isNull() const
+{
+    return !m_keyStream;
+}
+
+/**
+ * @return size of the value in UTF-8, which is the size of the ciphertext
+ */
+int ProtectedValue::size() const
+{
+    return m_ciphertext.size();
+}
+
+QString ProtectedValue::decrypt() const
+{
+    if (isNull() || m_ciphertext.isEmpty()) {
+        return {};
+    }
+
+    QByteArray plaintext(m_ciphertext.constData(), m_ciphertext.size());
+    if (!m_keyStream->apply(m_offset, plaintext.data(), plaintext.size())) {
+        qWarning("Failed to decrypt protected value");
+        return {};
+    }
+
+    const QString value = QString::fromUtf8(plaintext);
+    plaintext.fill('\0');
+    return value;
+}
+
+bool ProtectedValue::operator==(const ProtectedValue& other) const
+{
+    return m_keyStream == other.m_keyStream && m_offset == other.m_offset && m_ciphertext == other.m_ciphertext;
+}
+
+bool ProtectedValue::operator!=(const ProtectedValue& other) const
+{
+    return !(*this == other);
+}
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_PROTECTEDVALUE_H
+#define KEEPASSXC_PROTECTEDVALUE_H
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+
+/**
+ * Protected value as it was read from a database file, still encrypted
+ * with the inner stream of the file. It is decrypted every time it is
+ * accessed, so the plain value is not kept in memory.
+ */
+class ProtectedValue
+{
+public:
+    /**
+     * Key stream a value was encrypted with, applied at any offset.
+     * Implementations must be safe to use from several threads.
+     */
+    class KeyStream
+    {
+    public:
+        virtual ~KeyStream() = default;
+        virtual bool apply(qint64 offset, char* data, int size) const = 0;
+    };
+
+    ProtectedValue() = default;
+    ProtectedValue(QSharedPointer<const KeyStream> keyStream, qint64 offset, QByteArray ciphertext);
+
+    bool isNull() const;
+    int size() const;
+    QString decrypt() const;
+
+    bool operator==(const ProtectedValue& other) const;
+    bool operator!=(const ProtectedValue& other) const;
+
+private:
+    QSharedPointer<const KeyStream> m_keyStream;
+    qint64 m_offset = 0;
+    QByteArray m_ciphertext;
+};
+
+#endif // KEEPASSXC_PROTECTEDVALUE_H
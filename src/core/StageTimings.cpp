@@ -0,0 +1,116 @@
+/*
+ *  Copyright (C) 2024 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StageTimings.h"
+
+#include <QStringList>
+
+/**
+ * Discard all recorded stages and start timing the first one.
+ */
+void StageTimings::start()
+{
+    m_stages.clear();
+    m_timer.start();
+}
+
+/**
+ * Record the time since the previous lap as the duration of a stage.
+ * Stages recorded more than once are summed up.
+ */
+void StageTimings::lap(const QString& stage)
+{
+    if (!m_timer.isValid()) {
+        return;
+    }
+
+    const qint64 elapsed = m_timer.nsecsElapsed();
+    m_timer.start();
+
+    for (auto& recorded : m_stages) {
+        if (recorded.first == stage) {
+            recorded.second += elapsed;
+            return;
+        }
+    }
+    m_stages.append({stage, elapsed});
+}
+
+/**
+ * Record the stages of a nested operation that ran since the previous lap.
+ */
+void StageTimings::append(const StageTimings& other)
+{
+    if (!m_timer.isValid()) {
+        return;
+    }
+
+    m_timer.start();
+    for (const auto& stage : other.m_stages) {
+        m_stages.append(stage);
+    }
+}
+
+void StageTimings::clear()
+{
+    m_stages.clear();
+    m_timer.invalidate();
+}
+
+bool StageTimings::isEmpty() const
+{
+    return m_stages.isEmpty();
+}
+
+QList<StageTimings::Stage> StageTimings::stages() const
+{
+    return m_stages;
+}
+
+/**
+ * @return duration of the given stage, or -1 if it was not recorded
+ */
+qint64 StageTimings::nsecs(const QString& stage) const
+{
+    for (const auto& recorded : m_stages) {
+        if (recorded.first == stage) {
+            return recorded.second;
+        }
+    }
+    return -1;
+}
+
+qint64 StageTimings::totalNsecs() const
+{
+    qint64 total = 0;
+    for (const auto& stage : m_stages) {
+        total += stage.second;
+    }
+    return total;
+}
+
+/**
+ * @return the stages as "name: 1.23 ms" separated by commas
+ */
+QString StageTimings::toString() const
+{
+    QStringList parts;
+    for (const auto& stage : m_stages) {
+        parts << QString("%1: %2 ms").arg(stage.first).arg(stage.second / 1e6, 0, 'f', 2);
+    }
+    return parts.join(", ");
+}
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (C) 2024 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_STAGETIMINGS_H
+#define KEEPASSXC_STAGETIMINGS_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/**
+ * Wall-clock durations of the consecutive stages of an operation,
+ * such as reading or writing a database file.
+ *
+ * Each call to lap() records the time since the previous lap, so the
+ * stages add up to the duration of the whole operation.
+ */
+class StageTimings
+{
+public:
+    using Stage = QPair<QString, qint64>;
+
+    void start();
+    void lap(const QString& stage);
+    void append(const StageTimings& other);
+    void clear();
+
+    bool isEmpty() const;
+    QList<Stage> stages() const;
+    qint64 nsecs(const QString& stage) const;
+    qint64 totalNsecs() const;
+    QString toString() const;
+
+private:
+    QElapsedTimer m_timer;
+    QList<Stage> m_stages;
+};
+
+#endif // KEEPASSXC_STAGETIMINGS_H
@@ -17,11 +17,36 @@
 
 #include "TimeInfo.h"
 
+#include <limits>
+
+namespace
+{
+    // Invalid date times are stored as the smallest value so they still sort first
+    const qint64 InvalidMSecs = std::numeric_limits<qint64>::min();
+
+    // Same as Clock::serialized(), the milliseconds are dropped towards the past
+    qint64 withoutMilliseconds(qint64 msecs)
+    {
+        if (msecs == InvalidMSecs) {
+            return msecs;
+        }
+        return msecs - ((msecs % 1000) + 1000) % 1000;
+    }
+
+    short compareMSecs(qint64 lhs, qint64 rhs, CompareItemOptions options)
+    {
+        if (options.testFlag(CompareItemIgnoreMilliseconds)) {
+            return compareGeneric(withoutMilliseconds(lhs), withoutMilliseconds(rhs), options);
+        }
+        return compareGeneric(lhs, rhs, options);
+    }
+} // namespace
+
 TimeInfo::TimeInfo()
-    : m_expires(false)
-    , m_usageCount(0)
+    : m_usageCount(0)
+    , m_expires(false)
 {
-    QDateTime now = Clock::currentDateTimeUtc();
+    const qint64 now = toMSecs(Clock::currentDateTimeUtc());
     m_lastModificationTime = now;
     m_creationTime = now;
     m_lastAccessTime = now;
@@ -29,24 +54,37 @@ TimeInfo::TimeInfo()
     m_locationChanged = now;
 }
 
+qint64 TimeInfo::toMSecs(const QDateTime& dateTime)
+{
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : InvalidMSecs;
+}
+
+QDateTime TimeInfo::fromMSecs(qint64 msecs)
+{
+    if (msecs == InvalidMSecs) {
+        return {};
+    }
+    return QDateTime::fromMSecsSinceEpoch(msecs, Qt::UTC);
+}
+
 QDateTime TimeInfo::lastModificationTime() const
 {
-    return m_lastModificationTime;
+    return fromMSecs(m_lastModificationTime);
 }
 
 QDateTime TimeInfo::creationTime() const
 {
-    return m_creationTime;
+    return fromMSecs(m_creationTime);
 }
 
 QDateTime TimeInfo::lastAccessTime() const
 {
-    return m_lastAccessTime;
+    return fromMSecs(m_lastAccessTime);
 }
 
 QDateTime TimeInfo::expiryTime() const
 {
-    return m_expiryTime;
+    return fromMSecs(m_expiryTime);
 }
 
 bool TimeInfo::expires() const
@@ -54,6 +92,14 @@ bool TimeInfo::expires() const
     return m_expires;
 }
 
+/**
+ * @return true if the item expires and its expiry time is before the given time
+ */
+bool TimeInfo::isExpiredAt(const QDateTime& dateTime) const
+{
+    return m_expires && m_expiryTime < toMSecs(dateTime);
+}
+
 int TimeInfo::usageCount() const
 {
     return m_usageCount;
@@ -61,31 +107,31 @@ int TimeInfo::usageCount() const
 
 QDateTime TimeInfo::locationChanged() const
 {
-    return m_locationChanged;
+    return fromMSecs(m_locationChanged);
 }
 
 void TimeInfo::setLastModificationTime(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_lastModificationTime = dateTime;
+    m_lastModificationTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setCreationTime(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_creationTime = dateTime;
+    m_creationTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setLastAccessTime(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_lastAccessTime = dateTime;
+    m_lastAccessTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setExpiryTime(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_expiryTime = dateTime;
+    m_expiryTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setExpires(bool expires)
@@ -101,7 +147,7 @@ void TimeInfo::setUsageCount(int count)
 void TimeInfo::setLocationChanged(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_locationChanged = dateTime;
+    m_locationChanged = toMSecs(dateTime);
 }
 
 bool TimeInfo::operator==(const TimeInfo& other) const
@@ -117,22 +163,28 @@ bool TimeInfo::operator!=(const TimeInfo& other) const
 bool TimeInfo::equals(const TimeInfo& other, CompareItemOptions options) const
 {
     // clang-format off
-    if (::compare(m_lastModificationTime, other.m_lastModificationTime, options) != 0) {
+    if (compareMSecs(m_lastModificationTime, other.m_lastModificationTime, options) != 0) {
+        return false;
+    }
+    if (compareMSecs(m_creationTime, other.m_creationTime, options) != 0) {
         return false;
     }
-    if (::compare(m_creationTime, other.m_creationTime, options) != 0) {
+    if (!options.testFlag(CompareItemIgnoreStatistics)
+        && compareMSecs(m_lastAccessTime, other.m_lastAccessTime, options) != 0) {
         return false;
     }
-    if (::compare(!options.testFlag(CompareItemIgnoreStatistics), m_lastAccessTime, other.m_lastAccessTime, options) != 0) {
+    if (m_expires != other.m_expires) {
         return false;
     }
-    if (::compare(m_expires, m_expiryTime, other.m_expires, other.expiryTime(), options) != 0) {
+    if ((m_expires || !options.testFlag(CompareItemIgnoreDisabled))
+        && compareMSecs(m_expiryTime, other.m_expiryTime, options) != 0) {
         return false;
     }
     if (::compare(!options.testFlag(CompareItemIgnoreStatistics), m_usageCount, other.m_usageCount, options) != 0) {
         return false;
     }
-    if (::compare(!options.testFlag(CompareItemIgnoreLocation), m_locationChanged, other.m_locationChanged, options) != 0) {
+    if (!options.testFlag(CompareItemIgnoreLocation)
+        && compareMSecs(m_locationChanged, other.m_locationChanged, options) != 0) {
         return false;
     }
     return true;
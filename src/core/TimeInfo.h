@@ -22,6 +22,13 @@
 
 #include "core/Compare.h"
 
+/**
+ * Timestamps and usage statistics of an entry or group.
+ *
+ * The times are kept as UTC milliseconds since the epoch, which is smaller
+ * than a QDateTime and is compared without any time zone handling. They are
+ * converted to QDateTime only when they are read or set.
+ */
 class TimeInfo
 {
 public:
@@ -32,6 +39,7 @@ public:
     QDateTime lastAccessTime() const;
     QDateTime expiryTime() const;
     bool expires() const;
+    bool isExpiredAt(const QDateTime& dateTime) const;
     int usageCount() const;
     QDateTime locationChanged() const;
 
@@ -48,13 +56,16 @@ public:
     void setLocationChanged(const QDateTime& dateTime);
 
 private:
-    QDateTime m_lastModificationTime;
-    QDateTime m_creationTime;
-    QDateTime m_lastAccessTime;
-    QDateTime m_expiryTime;
-    bool m_expires;
+    static qint64 toMSecs(const QDateTime& dateTime);
+    static QDateTime fromMSecs(qint64 msecs);
+
+    qint64 m_lastModificationTime;
+    qint64 m_creationTime;
+    qint64 m_lastAccessTime;
+    qint64 m_expiryTime;
+    qint64 m_locationChanged;
     int m_usageCount;
-    QDateTime m_locationChanged;
+    bool m_expires;
 };
 
 #endif // KEEPASSX_TIMEINFO_H
@@ -192,6 +192,20 @@ QString Totp::writeSettings(const QSharedPointer<Totp::Settings>& settings,
     }
 }
 
+/**
+ * @return the number of the time step containing the given time, or the current time if 0
+ */
+quint64 Totp::timeCounter(const QSharedPointer<Totp::Settings>& settings, const quint64 time)
+{
+    Q_ASSERT(!settings.isNull());
+
+    uint step = settings->custom ? settings->step : settings->encoder.step;
+    if (time == 0) {
+        return static_cast<quint64>(Clock::currentSecondsSinceEpoch()) / step;
+    }
+    return time / step;
+}
+
 QString Totp::generateTotp(const QSharedPointer<Totp::Settings>& settings, const quint64 time)
 {
     Q_ASSERT(!settings.isNull());
@@ -200,15 +214,9 @@ QString Totp::generateTotp(const QSharedPointer<Totp::Settings>& settings, const
     }
 
     const Encoder& encoder = settings->encoder;
-    uint step = settings->custom ? settings->step : encoder.step;
     uint digits = settings->custom ? settings->digits : encoder.digits;
 
-    quint64 current;
-    if (time == 0) {
-        current = qToBigEndian(static_cast<quint64>(Clock::currentSecondsSinceEpoch()) / step);
-    } else {
-        current = qToBigEndian(time / step);
-    }
+    quint64 current = qToBigEndian(timeCounter(settings, time));
 
     QVariant secret = Base32::decode(Base32::sanitizeInput(settings->key.toLatin1()));
     if (secret.isNull()) {
@@ -84,6 +84,7 @@ namespace Totp
                           const QString& username = {},
                           bool forceOtp = false);
 
+    quint64 timeCounter(const QSharedPointer<Totp::Settings>& settings, const quint64 time = 0ull);
     QString generateTotp(const QSharedPointer<Totp::Settings>& settings, const quint64 time = 0ull);
 
     QList<QPair<QString, QString>> supportedEncoders();
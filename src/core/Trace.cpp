@@ -0,0 +1,166 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Trace.h"
+
+#include "core/Global.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        char phase;
+        quintptr thread;
+        qint64 timestamp;
+        // Duration of a span or value of a counter
+        qint64 value;
+    };
+
+    struct TraceState
+    {
+        QMutex mutex;
+        QString filePath;
+        QElapsedTimer timer;
+        QVector<Event> events;
+    };
+    Q_GLOBAL_STATIC(TraceState, s_trace)
+    QAtomicInt s_active(0);
+
+    qint64 now()
+    {
+        return s_trace->timer.nsecsElapsed() / 1000;
+    }
+
+    void record(const Event& event)
+    {
+        QMutexLocker locker(&s_trace->mutex);
+        // The trace may have been stopped since the caller checked
+        if (s_active.loadAcquire()) {
+            s_trace->events.append(event);
+        }
+    }
+
+    quintptr currentThread()
+    {
+        return reinterpret_cast<quintptr>(QThread::currentThreadId());
+    }
+} // namespace
+
+namespace Trace
+{
+    /**
+     * Start recording a trace that stop() writes to a file.
+     *
+     * @return false if a trace is already recorded
+     */
+    bool start(const QString& filePath)
+    {
+        QMutexLocker locker(&s_trace->mutex);
+        if (s_active.loadAcquire()) {
+            return false;
+        }
+        s_trace->filePath = filePath;
+        s_trace->events.clear();
+        s_trace->timer.start();
+        s_active.storeRelease(1);
+        return true;
+    }
+
+    /**
+     * Stop recording and write the trace as Chrome trace event JSON.
+     *
+     * @return true on success or if no trace was recorded
+     */
+    bool stop(QString* error)
+    {
+        QVector<Event> events;
+        QString filePath;
+        {
+            QMutexLocker locker(&s_trace->mutex);
+            if (!s_active.loadAcquire()) {
+                return true;
+            }
+            s_active.storeRelease(0);
+            events.swap(s_trace->events);
+            filePath = s_trace->filePath;
+        }
+
+        const qint64 pid = QCoreApplication::applicationPid();
+        QJsonArray traceEvents;
+        for (const Event& event : asConst(events)) {
+            QJsonObject object{{"name", QLatin1String(event.name)},
+                               {"ph", QString(QLatin1Char(event.phase))},
+                               {"pid", pid},
+                               {"tid", static_cast<qint64>(event.thread)},
+                               {"ts", event.timestamp}};
+            if (event.phase == 'X') {
+                object.insert("dur", event.value);
+            } else {
+                object.insert("args", QJsonObject{{"value", event.value}});
+            }
+            traceEvents.append(object);
+        }
+        const QJsonObject trace{{"traceEvents", traceEvents}, {"displayTimeUnit", "ms"}};
+
+        QSaveFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) < 0
+            || !file.commit()) {
+            if (error) {
+                *error = file.errorString();
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool isActive()
+    {
+        return s_active.loadAcquire();
+    }
+
+    void counter(const char* name, qint64 value)
+    {
+        if (s_active.loadAcquire()) {
+            record({name, 'C', currentThread(), now(), value});
+        }
+    }
+
+    Span::Span(const char* name)
+        : m_name(name)
+        , m_start(s_active.loadAcquire() ? now() : -1)
+    {
+    }
+
+    Span::~Span()
+    {
+        if (m_start >= 0) {
+            record({m_name, 'X', currentThread(), m_start, now() - m_start});
+        }
+    }
+} // namespace Trace
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TRACE_H
+#define KEEPASSXC_TRACE_H
+
+#include "config-keepassx.h"
+
+#include <QString>
+
+/**
+ * Trace of where time goes, written in the Chrome trace event format that
+ * chrome://tracing and Perfetto open.
+ *
+ * Code is instrumented with TRACE_SCOPE() for the duration of a scope and
+ * TRACE_COUNTER() for values over time. Names must be string literals. The
+ * macros compile to nothing unless WITH_XC_TRACING is set, and cost a
+ * single atomic load while no trace is recorded.
+ */
+namespace Trace
+{
+    bool start(const QString& filePath);
+    bool stop(QString* error = nullptr);
+    bool isActive();
+
+    void counter(const char* name, qint64 value);
+
+    class Span
+    {
+    public:
+        explicit Span(const char* name);
+        ~Span();
+
+    private:
+        Q_DISABLE_COPY(Span)
+
+        const char* m_name;
+        // Start time in microseconds, or -1 while no trace is recorded
+        qint64 m_start;
+    };
+} // namespace Trace
+
+#ifdef WITH_XC_TRACING
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_COUNTER(name, value) Trace::counter(name, value)
+#else
+#define TRACE_SCOPE(name)                                                                                              \
+    do {                                                                                                               \
+    } while (false)
+#define TRACE_COUNTER(name, value)                                                                                     \
+    do {                                                                                                               \
+    } while (false)
+#endif
+
+#endif // KEEPASSXC_TRACE_H
@@ -55,6 +55,27 @@ QUrl UrlTools::getRedirectTarget(QNetworkReply* reply) const
  * Up-to-date list can be found: https://publicsuffix.org/list/public_suffix_list.dat
  */
 QString UrlTools::getBaseDomainFromUrl(const QString& url) const
+{
+    static const int MaxCachedBaseDomains = 4096;
+
+    QMutexLocker locker(&m_baseDomainsMutex);
+    auto it = m_baseDomains.constFind(url);
+    if (it != m_baseDomains.cend()) {
+        return it.value();
+    }
+    locker.unlock();
+
+    const auto baseDomain = lookupBaseDomain(url);
+
+    locker.relock();
+    if (m_baseDomains.size() >= MaxCachedBaseDomains) {
+        m_baseDomains.clear();
+    }
+    m_baseDomains.insert(url, baseDomain);
+    return baseDomain;
+}
+
+QString UrlTools::lookupBaseDomain(const QString& url) const
 {
     auto qUrl = QUrl::fromUserInput(url);
 
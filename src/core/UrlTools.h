@@ -19,6 +19,8 @@
 #define KEEPASSXC_URLTOOLS_H
 
 #include "config-keepassx.h"
+#include <QHash>
+#include <QMutex>
 #include <QNetworkReply>
 #include <QObject>
 #include <QUrl>
@@ -44,6 +46,13 @@ public:
 
 private:
     QUrl convertVariantToUrl(const QVariant& var) const;
+#if defined(WITH_XC_NETWORKING) || defined(WITH_XC_BROWSER)
+    QString lookupBaseDomain(const QString& url) const;
+
+    // Public suffix lookups are expensive, remember the base domain of recent URLs
+    mutable QMutex m_baseDomainsMutex;
+    mutable QHash<QString, QString> m_baseDomains;
+#endif
 
 private:
     Q_DISABLE_COPY(UrlTools);
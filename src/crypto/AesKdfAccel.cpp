@@ -0,0 +1,207 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AesKdfAccel.h"
+
+#include <QtGlobal>
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AESKDF_X86
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define AESKDF_TARGET __attribute__((target("aes,sse2")))
+#else
+#define AESKDF_TARGET
+#endif
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+#define AESKDF_ARMV8
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    constexpr int AesRounds = 14;
+    constexpr int RoundKeysSize = (AesRounds + 1) * 16;
+
+    // clang-format off
+    const unsigned char SBox[256] = {
+        0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+        0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+        0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+        0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+        0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+        0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+        0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+        0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+        0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+        0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+        0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+        0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+        0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+        0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+        0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+        0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+    };
+    // clang-format on
+
+    /**
+     * AES-256 key expansion as specified in FIPS-197 section 5.2. Both AES-NI
+     * and the ARMv8 crypto extension consume the round keys in this layout.
+     */
+    void expandKey(const unsigned char* key, unsigned char* roundKeys)
+    {
+        memcpy(roundKeys, key, 32);
+
+        unsigned char rcon = 0x01;
+        for (int i = 32; i < RoundKeysSize; i += 4) {
+            unsigned char temp[4];
+            memcpy(temp, roundKeys + i - 4, 4);
+
+            if (i % 32 == 0) {
+                const unsigned char first = temp[0];
+                temp[0] = SBox[temp[1]] ^ rcon;
+                temp[1] = SBox[temp[2]];
+                temp[2] = SBox[temp[3]];
+                temp[3] = SBox[first];
+                rcon = static_cast<unsigned char>((rcon << 1) ^ ((rcon & 0x80) ? 0x1b : 0));
+            } else if (i % 32 == 16) {
+                for (unsigned char& byte : temp) {
+                    byte = SBox[byte];
+                }
+            }
+
+            for (int j = 0; j < 4; ++j) {
+                roundKeys[i + j] = roundKeys[i - 32 + j] ^ temp[j];
+            }
+        }
+    }
+
+#if defined(AESKDF_X86)
+    AESKDF_TARGET void transformAesNi(const unsigned char* roundKeys, int rounds, unsigned char* data)
+    {
+        __m128i k[AesRounds + 1];
+        for (int i = 0; i <= AesRounds; ++i) {
+            k[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + i * 16));
+        }
+
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+
+        for (int r = 0; r < rounds; ++r) {
+            a = _mm_xor_si128(a, k[0]);
+            b = _mm_xor_si128(b, k[0]);
+            for (int i = 1; i < AesRounds; ++i) {
+                a = _mm_aesenc_si128(a, k[i]);
+                b = _mm_aesenc_si128(b, k[i]);
+            }
+            a = _mm_aesenclast_si128(a, k[AesRounds]);
+            b = _mm_aesenclast_si128(b, k[AesRounds]);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + 16), b);
+    }
+
+    bool cpuHasAesNi()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 25)) && (info[3] & (1 << 26));
+#elif defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("aes") && __builtin_cpu_supports("sse2");
+#else
+        return false;
+#endif
+    }
+#elif defined(AESKDF_ARMV8)
+    void transformArmv8(const unsigned char* roundKeys, int rounds, unsigned char* data)
+    {
+        uint8x16_t k[AesRounds + 1];
+        for (int i = 0; i <= AesRounds; ++i) {
+            k[i] = vld1q_u8(roundKeys + i * 16);
+        }
+
+        uint8x16_t a = vld1q_u8(data);
+        uint8x16_t b = vld1q_u8(data + 16);
+
+        // AESE combines AddRoundKey, SubBytes and ShiftRows, so the last
+        // round key is applied separately
+        for (int r = 0; r < rounds; ++r) {
+            for (int i = 0; i < AesRounds - 1; ++i) {
+                a = vaesmcq_u8(vaeseq_u8(a, k[i]));
+                b = vaesmcq_u8(vaeseq_u8(b, k[i]));
+            }
+            a = veorq_u8(vaeseq_u8(a, k[AesRounds - 1]), k[AesRounds]);
+            b = veorq_u8(vaeseq_u8(b, k[AesRounds - 1]), k[AesRounds]);
+        }
+
+        vst1q_u8(data, a);
+        vst1q_u8(data + 16, b);
+    }
+#endif
+} // namespace
+
+namespace AesKdfAccel
+{
+    bool isSupported()
+    {
+#if defined(AESKDF_X86)
+        static const bool supported = cpuHasAesNi();
+        return supported;
+#elif defined(AESKDF_ARMV8)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Encrypt both halves of data rounds times with the 32 byte key.
+     * Only call this if isSupported() returns true.
+     *
+     * @param key AES-256 key (the KDF seed)
+     * @param rounds number of rounds
+     * @param data 32 bytes transformed in place
+     */
+    void transform(const unsigned char* key, int rounds, unsigned char* data)
+    {
+        unsigned char roundKeys[RoundKeysSize];
+        expandKey(key, roundKeys);
+
+#if defined(AESKDF_X86)
+        transformAesNi(roundKeys, rounds, data);
+#elif defined(AESKDF_ARMV8)
+        transformArmv8(roundKeys, rounds, data);
+#else
+        Q_UNUSED(rounds);
+        Q_UNUSED(data);
+#endif
+
+        // Do not leave the key schedule on the stack
+        volatile unsigned char* wipe = roundKeys;
+        for (int i = 0; i < RoundKeysSize; ++i) {
+            wipe[i] = 0;
+        }
+    }
+} // namespace AesKdfAccel
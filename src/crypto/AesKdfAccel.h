@@ -0,0 +1,36 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_AESKDFACCEL_H
+#define KEEPASSXC_AESKDFACCEL_H
+
+/**
+ * Hardware accelerated rounds of the KDBX3 AES-KDF.
+ *
+ * The AES-KDF encrypts both 16 byte halves of a 32 byte key independently
+ * with AES-256 in ECB mode, once per round. Going through a generic block
+ * cipher interface costs a virtual call and a dispatch per round; this
+ * implementation keeps the expanded key in registers and interleaves both
+ * halves so the AES unit always has two independent blocks in flight.
+ */
+namespace AesKdfAccel
+{
+    bool isSupported();
+    void transform(const unsigned char* key, int rounds, unsigned char* data);
+} // namespace AesKdfAccel
+
+#endif // KEEPASSXC_AESKDFACCEL_H
@@ -0,0 +1,946 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Argon2Accel.h"
+
+#include <QVector>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <botan/hash.h>
+#include <botan/mem_ops.h>
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ARGON2_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define ARGON2_TARGET(features) __attribute__((target(features)))
+#else
+#define ARGON2_TARGET(features)
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ARGON2_NEON
+#include <arm_neon.h>
+#endif
+
+// One round of the BLAKE2b permutation on the words v[0] to v[15],
+// first on the columns and then on the diagonals of the 4x4 matrix
+#define ARGON2_ROUND(mix, v)                                                                                           \
+    mix(v[0], v[4], v[8], v[12]);                                                                                      \
+    mix(v[1], v[5], v[9], v[13]);                                                                                      \
+    mix(v[2], v[6], v[10], v[14]);                                                                                     \
+    mix(v[3], v[7], v[11], v[15]);                                                                                     \
+    mix(v[0], v[5], v[10], v[15]);                                                                                     \
+    mix(v[1], v[6], v[11], v[12]);                                                                                     \
+    mix(v[2], v[7], v[8], v[13]);                                                                                      \
+    mix(v[3], v[4], v[9], v[14])
+
+namespace
+{
+    using Argon2Accel::Kernel;
+    using Argon2Accel::Type;
+
+    constexpr int BlockWords = 128;
+    constexpr int BlockBytes = BlockWords * 8;
+    constexpr int PrehashBytes = 64;
+    constexpr quint32 SyncPoints = 4;
+    constexpr quint32 MinSaltSize = 8;
+    constexpr int MinOutputSize = 4;
+
+    /**
+     * A block of Argon2 memory, viewed as an 8x8 matrix of 16 byte registers.
+     * The permutation runs over each row (16 consecutive words) and then over
+     * each column (two adjacent words from every row).
+     */
+    struct alignas(64) Block
+    {
+        quint64 v[BlockWords];
+    };
+
+    /**
+     * The compression function G: next = P(prev ^ ref) ^ prev ^ ref, XORed
+     * into the old contents of next when withXor is set. next may alias ref.
+     */
+    using CompressFunction = void (*)(const Block& prev, const Block& ref, Block& next, bool withXor);
+
+    inline quint64 rotr(quint64 x, int n)
+    {
+        return (x >> n) | (x << (64 - n));
+    }
+
+    // The BLAKE2b addition, hardened with a multiplication of the low halves
+    inline quint64 blaMka(quint64 a, quint64 b)
+    {
+        return a + b + 2 * (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    }
+
+    inline void mixPortable(quint64& a, quint64& b, quint64& c, quint64& d)
+    {
+        a = blaMka(a, b);
+        d = rotr(d ^ a, 32);
+        c = blaMka(c, d);
+        b = rotr(b ^ c, 24);
+        a = blaMka(a, b);
+        d = rotr(d ^ a, 16);
+        c = blaMka(c, d);
+        b = rotr(b ^ c, 63);
+    }
+
+    void compressPortable(const Block& prev, const Block& ref, Block& next, bool withXor)
+    {
+        Block r;
+        Block t;
+        for (int i = 0; i < BlockWords; ++i) {
+            r.v[i] = prev.v[i] ^ ref.v[i];
+            t.v[i] = withXor ? r.v[i] ^ next.v[i] : r.v[i];
+        }
+
+        for (int row = 0; row < 8; ++row) {
+            quint64* v = r.v + 16 * row;
+            ARGON2_ROUND(mixPortable, v);
+        }
+        for (int column = 0; column < 8; ++column) {
+            quint64 v[16];
+            for (int i = 0; i < 8; ++i) {
+                v[2 * i] = r.v[16 * i + 2 * column];
+                v[2 * i + 1] = r.v[16 * i + 2 * column + 1];
+            }
+            ARGON2_ROUND(mixPortable, v);
+            for (int i = 0; i < 8; ++i) {
+                r.v[16 * i + 2 * column] = v[2 * i];
+                r.v[16 * i + 2 * column + 1] = v[2 * i + 1];
+            }
+        }
+
+        for (int i = 0; i < BlockWords; ++i) {
+            next.v[i] = t.v[i] ^ r.v[i];
+        }
+    }
+
+    /*
+     * The 128-bit kernels keep the sixteen words of one permutation in eight
+     * registers of two words and rotate the second, third and fourth row of
+     * the 4x4 matrix between the column and the diagonal step. The wider
+     * kernels run several permutations side by side instead, one per vector
+     * lane: the words of four or eight rows (or columns) are transposed into
+     * the lanes of sixteen vectors, so that the round needs no shuffles.
+     */
+
+#if defined(ARGON2_X86)
+    ARGON2_TARGET("sse2") inline __m128i blaMkaSse2(__m128i a, __m128i b)
+    {
+        const __m128i product = _mm_mul_epu32(a, b);
+        return _mm_add_epi64(_mm_add_epi64(a, b), _mm_add_epi64(product, product));
+    }
+
+    ARGON2_TARGET("sse2") inline void mixSse2(__m128i& a, __m128i& b, __m128i& c, __m128i& d)
+    {
+        a = blaMkaSse2(a, b);
+        d = _mm_shuffle_epi32(_mm_xor_si128(d, a), _MM_SHUFFLE(2, 3, 0, 1));
+        c = blaMkaSse2(c, d);
+        b = _mm_xor_si128(b, c);
+        b = _mm_or_si128(_mm_srli_epi64(b, 24), _mm_slli_epi64(b, 40));
+        a = blaMkaSse2(a, b);
+        d = _mm_xor_si128(d, a);
+        d = _mm_or_si128(_mm_srli_epi64(d, 16), _mm_slli_epi64(d, 48));
+        c = blaMkaSse2(c, d);
+        b = _mm_xor_si128(b, c);
+        b = _mm_or_si128(_mm_srli_epi64(b, 63), _mm_add_epi64(b, b));
+    }
+
+    // The high word of x followed by the low word of y
+    ARGON2_TARGET("sse2") inline __m128i alignSse2(__m128i x, __m128i y)
+    {
+        return _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(x), _mm_castsi128_pd(y), 1));
+    }
+
+    /**
+     * Permute one row or column, whose word pairs are at v + i * stride.
+     */
+    ARGON2_TARGET("sse2") void permuteSse2(quint64* v, int stride)
+    {
+        __m128i x[8];
+        for (int i = 0; i < 8; ++i) {
+            x[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(v + i * stride));
+        }
+
+        mixSse2(x[0], x[2], x[4], x[6]);
+        mixSse2(x[1], x[3], x[5], x[7]);
+
+        __m128i b0 = alignSse2(x[2], x[3]);
+        __m128i b1 = alignSse2(x[3], x[2]);
+        __m128i d0 = alignSse2(x[7], x[6]);
+        __m128i d1 = alignSse2(x[6], x[7]);
+        mixSse2(x[0], b0, x[5], d0);
+        mixSse2(x[1], b1, x[4], d1);
+        x[2] = alignSse2(b1, b0);
+        x[3] = alignSse2(b0, b1);
+        x[6] = alignSse2(d0, d1);
+        x[7] = alignSse2(d1, d0);
+
+        for (int i = 0; i < 8; ++i) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(v + i * stride), x[i]);
+        }
+    }
+
+    ARGON2_TARGET("sse2") void compressSse2(const Block& prev, const Block& ref, Block& next, bool withXor)
+    {
+        Block r;
+        Block t;
+        for (int i = 0; i < BlockWords; i += 2) {
+            const __m128i x = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(prev.v + i)),
+                                             _mm_load_si128(reinterpret_cast<const __m128i*>(ref.v + i)));
+            _mm_store_si128(reinterpret_cast<__m128i*>(r.v + i), x);
+            _mm_store_si128(reinterpret_cast<__m128i*>(t.v + i),
+                            withXor ? _mm_xor_si128(x, _mm_load_si128(reinterpret_cast<const __m128i*>(next.v + i)))
+                                    : x);
+        }
+
+        for (int row = 0; row < 8; ++row) {
+            permuteSse2(r.v + 16 * row, 2);
+        }
+        for (int column = 0; column < 8; ++column) {
+            permuteSse2(r.v + 2 * column, 16);
+        }
+
+        for (int i = 0; i < BlockWords; i += 2) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(next.v + i),
+                            _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(t.v + i)),
+                                          _mm_load_si128(reinterpret_cast<const __m128i*>(r.v + i))));
+        }
+    }
+
+    ARGON2_TARGET("avx2") inline __m256i blaMkaAvx2(__m256i a, __m256i b)
+    {
+        const __m256i product = _mm256_mul_epu32(a, b);
+        return _mm256_add_epi64(_mm256_add_epi64(a, b), _mm256_add_epi64(product, product));
+    }
+
+    ARGON2_TARGET("avx2") inline void mixAvx2(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+    {
+        // Rotations by whole bytes are byte shuffles
+        const __m256i rotr24 = _mm256_setr_epi8(
+            3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10, 3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+        const __m256i rotr16 = _mm256_setr_epi8(
+            2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9, 2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+
+        a = blaMkaAvx2(a, b);
+        d = _mm256_shuffle_epi32(_mm256_xor_si256(d, a), _MM_SHUFFLE(2, 3, 0, 1));
+        c = blaMkaAvx2(c, d);
+        b = _mm256_shuffle_epi8(_mm256_xor_si256(b, c), rotr24);
+        a = blaMkaAvx2(a, b);
+        d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rotr16);
+        c = blaMkaAvx2(c, d);
+        b = _mm256_xor_si256(b, c);
+        b = _mm256_or_si256(_mm256_srli_epi64(b, 63), _mm256_add_epi64(b, b));
+    }
+
+    // Transpose a 4x4 matrix of words, the vectors being its rows
+    ARGON2_TARGET("avx2") inline void transposeAvx2(__m256i& x0, __m256i& x1, __m256i& x2, __m256i& x3)
+    {
+        const __m256i t0 = _mm256_unpacklo_epi64(x0, x1);
+        const __m256i t1 = _mm256_unpackhi_epi64(x0, x1);
+        const __m256i t2 = _mm256_unpacklo_epi64(x2, x3);
+        const __m256i t3 = _mm256_unpackhi_epi64(x2, x3);
+        x0 = _mm256_permute2x128_si256(t0, t2, 0x20);
+        x1 = _mm256_permute2x128_si256(t1, t3, 0x20);
+        x2 = _mm256_permute2x128_si256(t0, t2, 0x31);
+        x3 = _mm256_permute2x128_si256(t1, t3, 0x31);
+    }
+
+    // Permute the four rows starting at rows
+    ARGON2_TARGET("avx2") void permuteRowsAvx2(quint64* rows)
+    {
+        __m256i v[16];
+        for (int i = 0; i < 16; i += 4) {
+            __m256i x0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(rows + i));
+            __m256i x1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(rows + 16 + i));
+            __m256i x2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(rows + 32 + i));
+            __m256i x3 = _mm256_load_si256(reinterpret_cast<const __m256i*>(rows + 48 + i));
+            transposeAvx2(x0, x1, x2, x3);
+            v[i] = x0;
+            v[i + 1] = x1;
+            v[i + 2] = x2;
+            v[i + 3] = x3;
+        }
+
+        ARGON2_ROUND(mixAvx2, v);
+
+        for (int i = 0; i < 16; i += 4) {
+            transposeAvx2(v[i], v[i + 1], v[i + 2], v[i + 3]);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(rows + i), v[i]);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(rows + 16 + i), v[i + 1]);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(rows + 32 + i), v[i + 2]);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(rows + 48 + i), v[i + 3]);
+        }
+    }
+
+    // Permute the four columns starting at columns, their words are the even and odd words of 8 consecutive ones
+    ARGON2_TARGET("avx2") void permuteColumnsAvx2(quint64* columns)
+    {
+        __m256i v[16];
+        for (int i = 0; i < 8; ++i) {
+            const __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i*>(columns + 16 * i));
+            const __m256i y = _mm256_load_si256(reinterpret_cast<const __m256i*>(columns + 16 * i + 4));
+            v[2 * i] = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(x, y), _MM_SHUFFLE(3, 1, 2, 0));
+            v[2 * i + 1] = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(x, y), _MM_SHUFFLE(3, 1, 2, 0));
+        }
+
+        ARGON2_ROUND(mixAvx2, v);
+
+        for (int i = 0; i < 8; ++i) {
+            const __m256i even = _mm256_permute4x64_epi64(v[2 * i], _MM_SHUFFLE(3, 1, 2, 0));
+            const __m256i odd = _mm256_permute4x64_epi64(v[2 * i + 1], _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(columns + 16 * i), _mm256_unpacklo_epi64(even, odd));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(columns + 16 * i + 4), _mm256_unpackhi_epi64(even, odd));
+        }
+    }
+
+    ARGON2_TARGET("avx2") void compressAvx2(const Block& prev, const Block& ref, Block& next, bool withXor)
+    {
+        Block r;
+        Block t;
+        for (int i = 0; i < BlockWords; i += 4) {
+            const __m256i x = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(prev.v + i)),
+                                               _mm256_load_si256(reinterpret_cast<const __m256i*>(ref.v + i)));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(r.v + i), x);
+            _mm256_store_si256(
+                reinterpret_cast<__m256i*>(t.v + i),
+                withXor ? _mm256_xor_si256(x, _mm256_load_si256(reinterpret_cast<const __m256i*>(next.v + i))) : x);
+        }
+
+        permuteRowsAvx2(r.v);
+        permuteRowsAvx2(r.v + 64);
+        permuteColumnsAvx2(r.v);
+        permuteColumnsAvx2(r.v + 8);
+
+        for (int i = 0; i < BlockWords; i += 4) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(next.v + i),
+                               _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(t.v + i)),
+                                                _mm256_load_si256(reinterpret_cast<const __m256i*>(r.v + i))));
+        }
+    }
+
+    ARGON2_TARGET("avx512f") inline __m512i blaMkaAvx512(__m512i a, __m512i b)
+    {
+        const __m512i product = _mm512_mul_epu32(a, b);
+        return _mm512_add_epi64(_mm512_add_epi64(a, b), _mm512_add_epi64(product, product));
+    }
+
+    ARGON2_TARGET("avx512f") inline void mixAvx512(__m512i& a, __m512i& b, __m512i& c, __m512i& d)
+    {
+        a = blaMkaAvx512(a, b);
+        d = _mm512_ror_epi64(_mm512_xor_si512(d, a), 32);
+        c = blaMkaAvx512(c, d);
+        b = _mm512_ror_epi64(_mm512_xor_si512(b, c), 24);
+        a = blaMkaAvx512(a, b);
+        d = _mm512_ror_epi64(_mm512_xor_si512(d, a), 16);
+        c = blaMkaAvx512(c, d);
+        b = _mm512_ror_epi64(_mm512_xor_si512(b, c), 63);
+    }
+
+    // Transpose an 8x8 matrix of words, the vectors being its rows
+    ARGON2_TARGET("avx512f") inline void transposeAvx512(__m512i* x)
+    {
+        __m512i t[8];
+        for (int i = 0; i < 8; i += 2) {
+            t[i] = _mm512_unpacklo_epi64(x[i], x[i + 1]);
+            t[i + 1] = _mm512_unpackhi_epi64(x[i], x[i + 1]);
+        }
+
+        __m512i u[8];
+        for (int i = 0; i < 8; i += 4) {
+            u[i] = _mm512_shuffle_i64x2(t[i], t[i + 2], 0x88);
+            u[i + 1] = _mm512_shuffle_i64x2(t[i + 1], t[i + 3], 0x88);
+            u[i + 2] = _mm512_shuffle_i64x2(t[i], t[i + 2], 0xDD);
+            u[i + 3] = _mm512_shuffle_i64x2(t[i + 1], t[i + 3], 0xDD);
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            x[i] = _mm512_shuffle_i64x2(u[i], u[i + 4], 0x88);
+            x[i + 4] = _mm512_shuffle_i64x2(u[i], u[i + 4], 0xDD);
+        }
+    }
+
+    // Permute all eight rows at once
+    ARGON2_TARGET("avx512f") void permuteRowsAvx512(quint64* rows)
+    {
+        __m512i v[16];
+        for (int half = 0; half < 16; half += 8) {
+            for (int i = 0; i < 8; ++i) {
+                v[half + i] = _mm512_load_si512(rows + 16 * i + half);
+            }
+            transposeAvx512(v + half);
+        }
+
+        ARGON2_ROUND(mixAvx512, v);
+
+        for (int half = 0; half < 16; half += 8) {
+            transposeAvx512(v + half);
+            for (int i = 0; i < 8; ++i) {
+                _mm512_store_si512(rows + 16 * i + half, v[half + i]);
+            }
+        }
+    }
+
+    // Permute all eight columns at once, their words are the even and odd words of each row
+    ARGON2_TARGET("avx512f") void permuteColumnsAvx512(quint64* rows)
+    {
+        const __m512i evenWords = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+        const __m512i oddWords = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+        const __m512i lowWords = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+        const __m512i highWords = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+
+        __m512i v[16];
+        for (int i = 0; i < 8; ++i) {
+            const __m512i x = _mm512_load_si512(rows + 16 * i);
+            const __m512i y = _mm512_load_si512(rows + 16 * i + 8);
+            v[2 * i] = _mm512_permutex2var_epi64(x, evenWords, y);
+            v[2 * i + 1] = _mm512_permutex2var_epi64(x, oddWords, y);
+        }
+
+        ARGON2_ROUND(mixAvx512, v);
+
+        for (int i = 0; i < 8; ++i) {
+            _mm512_store_si512(rows + 16 * i, _mm512_permutex2var_epi64(v[2 * i], lowWords, v[2 * i + 1]));
+            _mm512_store_si512(rows + 16 * i + 8, _mm512_permutex2var_epi64(v[2 * i], highWords, v[2 * i + 1]));
+        }
+    }
+
+    ARGON2_TARGET("avx512f") void compressAvx512(const Block& prev, const Block& ref, Block& next, bool withXor)
+    {
+        Block r;
+        Block t;
+        for (int i = 0; i < BlockWords; i += 8) {
+            const __m512i x = _mm512_xor_si512(_mm512_load_si512(prev.v + i), _mm512_load_si512(ref.v + i));
+            _mm512_store_si512(r.v + i, x);
+            _mm512_store_si512(t.v + i, withXor ? _mm512_xor_si512(x, _mm512_load_si512(next.v + i)) : x);
+        }
+
+        permuteRowsAvx512(r.v);
+        permuteColumnsAvx512(r.v);
+
+        for (int i = 0; i < BlockWords; i += 8) {
+            _mm512_store_si512(next.v + i, _mm512_xor_si512(_mm512_load_si512(t.v + i), _mm512_load_si512(r.v + i)));
+        }
+    }
+
+    bool cpuSupports(Kernel kernel)
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        const bool sse2 = info[3] & (1 << 26);
+        // The OS must save the vector registers on context switches
+        const bool osxsave = info[2] & (1 << 27);
+        const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        int extended[4] = {};
+        if (maxLeaf >= 7) {
+            __cpuidex(extended, 7, 0);
+        }
+
+        switch (kernel) {
+        case Kernel::Sse2:
+            return sse2;
+        case Kernel::Avx2:
+            return (xcr0 & 0x6) == 0x6 && (extended[1] & (1 << 5));
+        case Kernel::Avx512:
+            return (xcr0 & 0xE6) == 0xE6 && (extended[1] & (1 << 16));
+        default:
+            return false;
+        }
+#elif defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        switch (kernel) {
+        case Kernel::Sse2:
+            return __builtin_cpu_supports("sse2");
+        case Kernel::Avx2:
+            return __builtin_cpu_supports("avx2");
+        case Kernel::Avx512:
+            return __builtin_cpu_supports("avx512f");
+        default:
+            return false;
+        }
+#else
+        Q_UNUSED(kernel);
+        return false;
+#endif
+    }
+#elif defined(ARGON2_NEON)
+    inline uint64x2_t blaMkaNeon(uint64x2_t a, uint64x2_t b)
+    {
+        const uint64x2_t product = vmull_u32(vmovn_u64(a), vmovn_u64(b));
+        return vaddq_u64(vaddq_u64(a, b), vaddq_u64(product, product));
+    }
+
+    inline void mixNeon(uint64x2_t& a, uint64x2_t& b, uint64x2_t& c, uint64x2_t& d)
+    {
+        a = blaMkaNeon(a, b);
+        d = veorq_u64(d, a);
+        d = vreinterpretq_u64_u32(vrev64q_u32(vreinterpretq_u32_u64(d)));
+        c = blaMkaNeon(c, d);
+        b = veorq_u64(b, c);
+        b = vsriq_n_u64(vshlq_n_u64(b, 40), b, 24);
+        a = blaMkaNeon(a, b);
+        d = veorq_u64(d, a);
+        d = vsriq_n_u64(vshlq_n_u64(d, 48), d, 16);
+        c = blaMkaNeon(c, d);
+        b = veorq_u64(b, c);
+        b = vsriq_n_u64(vshlq_n_u64(b, 1), b, 63);
+    }
+
+    // Same layout as permuteSse2()
+    void permuteNeon(quint64* v, int stride)
+    {
+        uint64x2_t x[8];
+        for (int i = 0; i < 8; ++i) {
+            x[i] = vld1q_u64(v + i * stride);
+        }
+
+        mixNeon(x[0], x[2], x[4], x[6]);
+        mixNeon(x[1], x[3], x[5], x[7]);
+
+        uint64x2_t b0 = vextq_u64(x[2], x[3], 1);
+        uint64x2_t b1 = vextq_u64(x[3], x[2], 1);
+        uint64x2_t d0 = vextq_u64(x[7], x[6], 1);
+        uint64x2_t d1 = vextq_u64(x[6], x[7], 1);
+        mixNeon(x[0], b0, x[5], d0);
+        mixNeon(x[1], b1, x[4], d1);
+        x[2] = vextq_u64(b1, b0, 1);
+        x[3] = vextq_u64(b0, b1, 1);
+        x[6] = vextq_u64(d0, d1, 1);
+        x[7] = vextq_u64(d1, d0, 1);
+
+        for (int i = 0; i < 8; ++i) {
+            vst1q_u64(v + i * stride, x[i]);
+        }
+    }
+
+    void compressNeon(const Block& prev, const Block& ref, Block& next, bool withXor)
+    {
+        Block r;
+        Block t;
+        for (int i = 0; i < BlockWords; i += 2) {
+            const uint64x2_t x = veorq_u64(vld1q_u64(prev.v + i), vld1q_u64(ref.v + i));
+            vst1q_u64(r.v + i, x);
+            vst1q_u64(t.v + i, withXor ? veorq_u64(x, vld1q_u64(next.v + i)) : x);
+        }
+
+        for (int row = 0; row < 8; ++row) {
+            permuteNeon(r.v + 16 * row, 2);
+        }
+        for (int column = 0; column < 8; ++column) {
+            permuteNeon(r.v + 2 * column, 16);
+        }
+
+        for (int i = 0; i < BlockWords; i += 2) {
+            vst1q_u64(next.v + i, veorq_u64(vld1q_u64(t.v + i), vld1q_u64(r.v + i)));
+        }
+    }
+#endif
+
+    CompressFunction compressFunction(Kernel kernel)
+    {
+        switch (kernel) {
+#if defined(ARGON2_X86)
+        case Kernel::Sse2:
+            return compressSse2;
+        case Kernel::Avx2:
+            return compressAvx2;
+        case Kernel::Avx512:
+            return compressAvx512;
+#elif defined(ARGON2_NEON)
+        case Kernel::Neon:
+            return compressNeon;
+#endif
+        default:
+            return compressPortable;
+        }
+    }
+
+    Kernel detectBestKernel()
+    {
+        for (auto kernel : {Kernel::Avx512, Kernel::Avx2, Kernel::Sse2, Kernel::Neon}) {
+            if (Argon2Accel::isSupported(kernel)) {
+                return kernel;
+            }
+        }
+        return Kernel::Portable;
+    }
+
+    struct Instance
+    {
+        Block* memory;
+        CompressFunction compress;
+        Type type;
+        quint32 version;
+        quint32 passes;
+        quint32 lanes;
+        quint32 memoryBlocks;
+        quint32 segmentLength;
+        quint32 laneLength;
+    };
+
+    /**
+     * Map the pseudo-random value of a block to the index of its reference
+     * block within the reference lane.
+     */
+    quint32 referenceIndex(const Instance& instance,
+                           quint32 pass,
+                           quint32 slice,
+                           quint32 index,
+                           quint32 pseudoRandom,
+                           bool sameLane)
+    {
+        // Blocks that are computed in the current segment of other lanes are excluded
+        quint32 areaSize;
+        if (pass == 0) {
+            if (slice == 0) {
+                areaSize = index - 1;
+            } else if (sameLane) {
+                areaSize = slice * instance.segmentLength + index - 1;
+            } else {
+                areaSize = slice * instance.segmentLength - (index == 0 ? 1 : 0);
+            }
+        } else if (sameLane) {
+            areaSize = instance.laneLength - instance.segmentLength + index - 1;
+        } else {
+            areaSize = instance.laneLength - instance.segmentLength - (index == 0 ? 1 : 0);
+        }
+
+        // Non-uniform mapping that prefers recent blocks
+        quint64 relative = pseudoRandom;
+        relative = relative * relative >> 32;
+        relative = areaSize - 1 - (areaSize * relative >> 32);
+
+        quint32 start = 0;
+        if (pass != 0 && slice != SyncPoints - 1) {
+            start = (slice + 1) * instance.segmentLength;
+        }
+        return static_cast<quint32>((start + relative) % instance.laneLength);
+    }
+
+    void fillSegment(const Instance& instance, quint32 pass, quint32 slice, quint32 lane)
+    {
+        const bool dataIndependent = instance.type == Type::Argon2i
+                                     || (instance.type == Type::Argon2id && pass == 0 && slice < SyncPoints / 2);
+
+        // Data-independent reference positions are taken from blocks of
+        // addresses, G(0, G(0, input)) with a counter in the input
+        Block zero = {};
+        Block input = {};
+        Block addresses;
+        input.v[0] = pass;
+        input.v[1] = lane;
+        input.v[2] = slice;
+        input.v[3] = instance.memoryBlocks;
+        input.v[4] = instance.passes;
+        input.v[5] = static_cast<quint64>(instance.type);
+        auto nextAddresses = [&]() {
+            ++input.v[6];
+            instance.compress(zero, input, addresses, false);
+            instance.compress(zero, addresses, addresses, false);
+        };
+
+        quint32 startIndex = 0;
+        if (pass == 0 && slice == 0) {
+            // The first two blocks of each lane come from the pre-hash
+            startIndex = 2;
+            if (dataIndependent) {
+                nextAddresses();
+            }
+        }
+
+        quint64 offset = static_cast<quint64>(lane) * instance.laneLength + slice * instance.segmentLength + startIndex;
+        quint64 prevOffset = offset % instance.laneLength == 0 ? offset + instance.laneLength - 1 : offset - 1;
+
+        for (quint32 i = startIndex; i < instance.segmentLength; ++i, ++offset, ++prevOffset) {
+            // The previous block of the first block of a lane is the last one
+            if (offset % instance.laneLength == 1) {
+                prevOffset = offset - 1;
+            }
+
+            quint64 pseudoRandom;
+            if (dataIndependent) {
+                if (i % BlockWords == 0) {
+                    nextAddresses();
+                }
+                pseudoRandom = addresses.v[i % BlockWords];
+            } else {
+                pseudoRandom = instance.memory[prevOffset].v[0];
+            }
+
+            quint32 refLane = static_cast<quint32>((pseudoRandom >> 32) % instance.lanes);
+            if (pass == 0 && slice == 0) {
+                refLane = lane;
+            }
+            const quint32 refIndex = referenceIndex(
+                instance, pass, slice, i, static_cast<quint32>(pseudoRandom & 0xFFFFFFFF), refLane == lane);
+
+            const Block& ref = instance.memory[static_cast<quint64>(refLane) * instance.laneLength + refIndex];
+            // Version 1.3 overwrites blocks of earlier passes by XORing into them
+            const bool withXor = instance.version != 0x10 && pass != 0;
+            instance.compress(instance.memory[prevOffset], ref, instance.memory[offset], withXor);
+        }
+    }
+
+    std::unique_ptr<Botan::HashFunction> blake2b(size_t outputSize)
+    {
+        return Botan::HashFunction::create_or_throw("BLAKE2b(" + std::to_string(outputSize * 8) + ")");
+    }
+
+    void updateLe32(Botan::HashFunction& hash, quint32 value)
+    {
+        uchar bytes[4];
+        qToLittleEndian(value, bytes);
+        hash.update(bytes, sizeof(bytes));
+    }
+
+    /**
+     * The variable length hash function H' of the specification.
+     */
+    void longHash(uchar* out, size_t outSize, const uchar* in, size_t inSize)
+    {
+        if (outSize <= 64) {
+            auto hash = blake2b(outSize);
+            updateLe32(*hash, static_cast<quint32>(outSize));
+            hash->update(in, inSize);
+            hash->final(out);
+            return;
+        }
+
+        // Chain full BLAKE2b hashes and use the first half of each
+        uchar v[64];
+        auto hash = blake2b(64);
+        updateLe32(*hash, static_cast<quint32>(outSize));
+        hash->update(in, inSize);
+        hash->final(v);
+
+        size_t remaining = outSize;
+        while (remaining > 64) {
+            memcpy(out, v, 32);
+            out += 32;
+            remaining -= 32;
+            if (remaining > 64) {
+                hash->update(v, sizeof(v));
+                hash->final(v);
+            }
+        }
+
+        auto last = blake2b(remaining);
+        last->update(v, sizeof(v));
+        last->final(out);
+        Botan::secure_scrub_memory(v, sizeof(v));
+    }
+
+    void loadBlock(Block& block, const uchar* bytes)
+    {
+        for (int i = 0; i < BlockWords; ++i) {
+            block.v[i] = qFromLittleEndian<quint64>(bytes + 8 * i);
+        }
+    }
+
+    void storeBlock(uchar* bytes, const Block& block)
+    {
+        for (int i = 0; i < BlockWords; ++i) {
+            qToLittleEndian(block.v[i], bytes + 8 * i);
+        }
+    }
+} // namespace
+
+namespace Argon2Accel
+{
+    /**
+     * @return fastest kernel that the CPU supports
+     */
+    Kernel bestKernel()
+    {
+        static const Kernel kernel = detectBestKernel();
+        return kernel;
+    }
+
+    bool isSupported(Kernel kernel)
+    {
+        switch (kernel) {
+        case Kernel::Portable:
+            return true;
+#if defined(ARGON2_X86)
+        case Kernel::Sse2: {
+            static const bool supported = cpuSupports(Kernel::Sse2);
+            return supported;
+        }
+        case Kernel::Avx2: {
+            static const bool supported = cpuSupports(Kernel::Avx2);
+            return supported;
+        }
+        case Kernel::Avx512: {
+            static const bool supported = cpuSupports(Kernel::Avx512);
+            return supported;
+        }
+#elif defined(ARGON2_NEON)
+        case Kernel::Neon:
+            return true;
+#endif
+        default:
+            return false;
+        }
+    }
+
+    const char* kernelName(Kernel kernel)
+    {
+        switch (kernel) {
+        case Kernel::Sse2:
+            return "SSE2";
+        case Kernel::Avx2:
+            return "AVX2";
+        case Kernel::Avx512:
+            return "AVX-512";
+        case Kernel::Neon:
+            return "NEON";
+        default:
+            return "portable";
+        }
+    }
+
+    /**
+     * Compute an Argon2 hash without secret key or associated data, using
+     * one thread per lane.
+     *
+     * @param kernel compression kernel, must be supported by the CPU
+     * @param type Argon2 variant
+     * @param version 0x10 or 0x13
+     * @param iterations number of passes over the memory
+     * @param memory memory size in kibibytes
+     * @param lanes degree of parallelism
+     * @param password password
+     * @param salt salt, at least 8 bytes
+     * @param out receives the tag, its size is the tag length
+     * @return true on success
+     */
+    bool hash(Kernel kernel,
+              Type type,
+              quint32 version,
+              quint32 iterations,
+              quint32 memory,
+              quint32 lanes,
+              const QByteArray& password,
+              const QByteArray& salt,
+              QByteArray& out)
+    {
+        if (!isSupported(kernel) || iterations < 1 || lanes < 1 || lanes >= (1 << 24)
+            || static_cast<quint32>(salt.size()) < MinSaltSize || out.size() < MinOutputSize) {
+            qWarning("Argon2 error: Invalid parameters");
+            return false;
+        }
+
+        // The memory is rounded down to whole segments of at least two blocks
+        quint32 memoryBlocks = qMax(memory, 2 * SyncPoints * lanes);
+        const quint32 segmentLength = memoryBlocks / (lanes * SyncPoints);
+        memoryBlocks = segmentLength * lanes * SyncPoints;
+
+        std::unique_ptr<Block[]> blocks(new (std::nothrow) Block[memoryBlocks]);
+        if (!blocks) {
+            qWarning("Argon2 error: Memory allocation failed");
+            return false;
+        }
+
+        const Instance instance = {blocks.get(),
+                                   compressFunction(kernel),
+                                   type,
+                                   version,
+                                   iterations,
+                                   lanes,
+                                   memoryBlocks,
+                                   segmentLength,
+                                   segmentLength * SyncPoints};
+
+        bool ok = true;
+        uchar prehash[PrehashBytes + 8];
+        uchar blockBytes[BlockBytes];
+        try {
+            auto hash = blake2b(PrehashBytes);
+            updateLe32(*hash, lanes);
+            updateLe32(*hash, static_cast<quint32>(out.size()));
+            updateLe32(*hash, memory);
+            updateLe32(*hash, iterations);
+            updateLe32(*hash, version);
+            updateLe32(*hash, static_cast<quint32>(type));
+            updateLe32(*hash, static_cast<quint32>(password.size()));
+            hash->update(reinterpret_cast<const uchar*>(password.constData()), password.size());
+            updateLe32(*hash, static_cast<quint32>(salt.size()));
+            hash->update(reinterpret_cast<const uchar*>(salt.constData()), salt.size());
+            // No secret key and no associated data
+            updateLe32(*hash, 0);
+            updateLe32(*hash, 0);
+            hash->final(prehash);
+
+            for (quint32 lane = 0; lane < lanes; ++lane) {
+                for (quint32 i = 0; i < 2; ++i) {
+                    qToLittleEndian(i, prehash + PrehashBytes);
+                    qToLittleEndian(lane, prehash + PrehashBytes + 4);
+                    longHash(blockBytes, BlockBytes, prehash, sizeof(prehash));
+                    loadBlock(blocks[static_cast<quint64>(lane) * instance.laneLength + i], blockBytes);
+                }
+            }
+
+            // Lanes are independent within a slice and synchronize after it
+            QVector<quint32> laneIndexes;
+            for (quint32 lane = 0; lane < lanes; ++lane) {
+                laneIndexes.append(lane);
+            }
+            for (quint32 pass = 0; pass < iterations; ++pass) {
+                for (quint32 slice = 0; slice < SyncPoints; ++slice) {
+                    if (lanes == 1) {
+                        fillSegment(instance, pass, slice, 0);
+                    } else {
+                        QtConcurrent::blockingMap(
+                            laneIndexes, [&](quint32 lane) { fillSegment(instance, pass, slice, lane); });
+                    }
+                }
+            }
+
+            Block finalBlock = blocks[instance.laneLength - 1];
+            for (quint32 lane = 1; lane < lanes; ++lane) {
+                const Block& last = blocks[static_cast<quint64>(lane) * instance.laneLength + instance.laneLength - 1];
+                for (int i = 0; i < BlockWords; ++i) {
+                    finalBlock.v[i] ^= last.v[i];
+                }
+            }
+            storeBlock(blockBytes, finalBlock);
+            Botan::secure_scrub_memory(&finalBlock, sizeof(finalBlock));
+            longHash(reinterpret_cast<uchar*>(out.data()), out.size(), blockBytes, BlockBytes);
+        } catch (std::exception& e) {
+            qWarning("Argon2 error: %s", e.what());
+            ok = false;
+        }
+
+        Botan::secure_scrub_memory(prehash, sizeof(prehash));
+        Botan::secure_scrub_memory(blockBytes, sizeof(blockBytes));
+        Botan::secure_scrub_memory(blocks.get(), sizeof(Block) * memoryBlocks);
+        return ok;
+    }
+} // namespace Argon2Accel
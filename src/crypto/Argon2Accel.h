@@ -0,0 +1,65 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ARGON2ACCEL_H
+#define KEEPASSXC_ARGON2ACCEL_H
+
+#include <QByteArray>
+
+/**
+ * Argon2 with a compression kernel chosen for the CPU at runtime.
+ *
+ * Distribution packages of libargon2 are usually built for a generic CPU,
+ * which leaves out the vectorized compression function. This implementation
+ * contains the SIMD kernels that the CPU may have and picks the best one
+ * when it is first used. All kernels produce the same output as the
+ * reference implementation.
+ */
+namespace Argon2Accel
+{
+    enum class Kernel
+    {
+        Portable,
+        Sse2,
+        Avx2,
+        Avx512,
+        Neon
+    };
+
+    enum class Type
+    {
+        Argon2d = 0,
+        Argon2i = 1,
+        Argon2id = 2
+    };
+
+    Kernel bestKernel();
+    bool isSupported(Kernel kernel);
+    const char* kernelName(Kernel kernel);
+
+    bool hash(Kernel kernel,
+              Type type,
+              quint32 version,
+              quint32 iterations,
+              quint32 memory,
+              quint32 lanes,
+              const QByteArray& password,
+              const QByteArray& salt,
+              QByteArray& out);
+} // namespace Argon2Accel
+
+#endif // KEEPASSXC_ARGON2ACCEL_H
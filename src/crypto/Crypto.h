@@ -23,7 +23,7 @@
 
 namespace Crypto
 {
-    bool init();
+    bool init(bool selfTests = true);
     QString errorString();
     QString debugInfo();
 }; // namespace Crypto
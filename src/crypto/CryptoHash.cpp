@@ -109,17 +109,51 @@ QByteArray CryptoHash::result() const
     return {reinterpret_cast<const char*>(result.data()), int(result.size())};
 }
 
+/**
+ * Discard any data added so far and, for HMAC, the key.
+ */
+void CryptoHash::reset()
+{
+    Q_D(CryptoHash);
+
+    if (d->hmacFunction) {
+        d->hmacFunction->clear();
+    } else if (d->hashFunction) {
+        d->hashFunction->clear();
+    }
+}
+
+/**
+ * Get a hash object owned by the calling thread. The static helpers use these
+ * so they do not look up and allocate a new Botan algorithm on every call.
+ * Finish with result() (and reset() for HMAC) before calling hash() or hmac()
+ * with the same algorithm, they share the object.
+ */
+CryptoHash& CryptoHash::threadInstance(Algorithm algo, bool hmac)
+{
+    thread_local QScopedPointer<CryptoHash> instances[4];
+
+    auto& instance = instances[(algo == Sha512 ? 2 : 0) + (hmac ? 1 : 0)];
+    if (!instance) {
+        instance.reset(new CryptoHash(algo, hmac));
+    }
+    return *instance;
+}
+
 QByteArray CryptoHash::hash(const QByteArray& data, Algorithm algo)
 {
-    CryptoHash cryptoHash(algo);
+    auto& cryptoHash = threadInstance(algo, false);
     cryptoHash.addData(data);
     return cryptoHash.result();
 }
 
 QByteArray CryptoHash::hmac(const QByteArray& data, const QByteArray& key, Algorithm algo)
 {
-    CryptoHash cryptoHash(algo, true);
+    auto& cryptoHash = threadInstance(algo, true);
     cryptoHash.setKey(key);
     cryptoHash.addData(data);
-    return cryptoHash.result();
+    QByteArray result = cryptoHash.result();
+    // Do not keep the key around in the pooled object
+    cryptoHash.reset();
+    return result;
 }
@@ -37,9 +37,11 @@ public:
     void addData(const QByteArray& data);
     QByteArray result() const;
     void setKey(const QByteArray& data);
+    void reset();
 
     static QByteArray hash(const QByteArray& data, Algorithm algo);
     static QByteArray hmac(const QByteArray& data, const QByteArray& key, Algorithm algo);
+    static CryptoHash& threadInstance(Algorithm algo, bool hmac = false);
 
 private:
     CryptoHashPrivate* const d_ptr;
@@ -21,8 +21,32 @@
 
 #include <QSharedPointer>
 
+#include <atomic>
+#include <cstring>
+
 #include <botan/system_rng.h>
 
+#ifdef Q_OS_UNIX
+#include <pthread.h>
+#endif
+
+namespace
+{
+    // Small requests are served from a per-thread buffer refilled from the system RNG
+    constexpr size_t ThreadBufferSize = 4096;
+    constexpr size_t MaxBufferedRequest = 256;
+
+    // Incremented in the child after fork() so buffered bytes are never shared with the parent
+    std::atomic<int> s_forkGeneration(0);
+
+    struct ThreadBuffer
+    {
+        Botan::secure_vector<uint8_t> data;
+        size_t offset = 0;
+        int forkGeneration = -1;
+    };
+} // namespace
+
 QSharedPointer<Random> Random::m_instance;
 
 QSharedPointer<Random> Random::instance()
@@ -40,6 +64,10 @@ Random::Random()
 #else
     m_rng.reset(new Botan::Autoseeded_RNG);
 #endif
+
+#ifdef Q_OS_UNIX
+    pthread_atfork(nullptr, nullptr, [] { ++s_forkGeneration; });
+#endif
 }
 
 QSharedPointer<Botan::RandomNumberGenerator> Random::getRng()
@@ -49,7 +77,38 @@ QSharedPointer<Botan::RandomNumberGenerator> Random::getRng()
 
 void Random::randomize(QByteArray& ba)
 {
-    m_rng->randomize(reinterpret_cast<uint8_t*>(ba.data()), ba.size());
+    randomize(reinterpret_cast<uint8_t*>(ba.data()), static_cast<size_t>(ba.size()));
+}
+
+/**
+ * Fill the output with random bytes.
+ *
+ * Generators request a few bytes at a time, which would cost a system call
+ * each. Small requests are instead served from a buffer owned by the calling
+ * thread, so generating in parallel needs no locking. Served bytes are wiped
+ * from the buffer, and the buffer is discarded in a forked child.
+ */
+void Random::randomize(uint8_t* out, size_t len)
+{
+    if (len > MaxBufferedRequest) {
+        m_rng->randomize(out, len);
+        return;
+    }
+
+    thread_local ThreadBuffer buffer;
+
+    const int forkGeneration = s_forkGeneration.load(std::memory_order_relaxed);
+    if (buffer.forkGeneration != forkGeneration || buffer.data.size() - buffer.offset < len) {
+        buffer.data.resize(ThreadBufferSize);
+        m_rng->randomize(buffer.data.data(), buffer.data.size());
+        buffer.offset = 0;
+        buffer.forkGeneration = forkGeneration;
+    }
+
+    uint8_t* source = buffer.data.data() + buffer.offset;
+    memcpy(out, source, len);
+    Botan::secure_scrub_memory(source, len);
+    buffer.offset += len;
 }
 
 QByteArray Random::randomArray(int len)
@@ -71,7 +130,7 @@ quint32 Random::randomUInt(quint32 limit)
 
     // To avoid modulo bias make sure rand is below the largest number where rand%limit==0
     do {
-        m_rng->randomize(reinterpret_cast<uint8_t*>(&rand), 4);
+        randomize(reinterpret_cast<uint8_t*>(&rand), sizeof(rand));
     } while (rand > ceil);
 
     return (rand % limit);
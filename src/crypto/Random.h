@@ -28,6 +28,7 @@ public:
     static QSharedPointer<Random> instance();
 
     void randomize(QByteArray& ba);
+    void randomize(uint8_t* out, size_t len);
     QByteArray randomArray(int len);
 
     /**
@@ -18,14 +18,65 @@
 #include "SymmetricCipher.h"
 
 #include "config-keepassx.h"
+#include "core/Global.h"
+#include "crypto/AesKdfAccel.h"
 #include "format/KeePass2.h"
 
+#include <QThread>
+#include <QtConcurrent>
+
 #include <botan/block_cipher.h>
 #include <botan/cipher_mode.h>
+#include <botan/stream_cipher.h>
+
+namespace
+{
+    // Smaller payloads are processed on the calling thread only
+    constexpr int ParallelThreshold = 256 * 1024;
+    constexpr int MinSegmentSize = 64 * 1024;
+    // ChaCha20 generates its keystream in blocks of 64 bytes
+    constexpr int ChaCha20BlockSize = 64;
+
+    /**
+     * Split data into segments of whole blocks, one per thread.
+     *
+     * @return start offsets of the segments followed by the data length,
+     *         or an empty list if the data is too short to be split
+     */
+    QVector<int> segmentOffsets(int len, int blockLen)
+    {
+        const int segments = qBound(1, len / MinSegmentSize, QThread::idealThreadCount());
+        if (segments < 2) {
+            return {};
+        }
+
+        const int blocks = len / blockLen;
+        QVector<int> offsets;
+        for (int i = 0; i < segments; ++i) {
+            offsets.append(static_cast<int>(static_cast<qint64>(blocks) * i / segments) * blockLen);
+        }
+        offsets.append(len);
+        return offsets;
+    }
+} // namespace
 
 bool SymmetricCipher::init(Mode mode, Direction direction, const QByteArray& key, const QByteArray& iv)
 {
+    // Re-initializing with the same algorithm and direction only rekeys the existing
+    // Botan objects instead of looking up and allocating new ones
+    const bool reuseCipher = isInitalized() && m_mode == mode && m_direction == direction;
+    if (!reuseCipher) {
+        m_cipher.reset();
+        m_workers.clear();
+        m_stream.reset();
+        m_streamWorkers.clear();
+    }
+
     m_mode = mode;
+    m_direction = direction;
+    m_key.clear();
+    m_iv.clear();
+    m_streamPosition = 0;
     if (mode == InvalidMode) {
         m_error = QObject::tr("SymmetricCipher::init: Invalid cipher mode.");
         return false;
@@ -33,11 +84,39 @@ bool SymmetricCipher::init(Mode mode, Direction direction, const QByteArray& key
 
     try {
         auto botanMode = modeToString(mode);
-        auto botanDirection =
-            (direction == SymmetricCipher::Encrypt ? Botan::Cipher_Dir::ENCRYPTION : Botan::Cipher_Dir::DECRYPTION);
+        if (mode == ChaCha20) {
+            // ChaCha20 is processed by the seekable keystream alone
+            if (!m_stream) {
+                auto stream = Botan::StreamCipher::create_or_throw("ChaCha(20)");
+                m_stream.reset(stream.release());
+            }
+            if (!m_stream->valid_iv_length(iv.size())) {
+                m_mode = InvalidMode;
+                m_stream.reset();
+                m_streamWorkers.clear();
+                m_error =
+                    QObject::tr("SymmetricCipher::init: Invalid IV size of %1 for %2.").arg(iv.size()).arg(botanMode);
+                return false;
+            }
+            m_stream->set_key(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+            m_stream->set_iv(reinterpret_cast<const uint8_t*>(iv.data()), iv.size());
+            for (const auto& worker : asConst(m_streamWorkers)) {
+                worker->set_key(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+                worker->set_iv(reinterpret_cast<const uint8_t*>(iv.data()), iv.size());
+            }
+            m_key = key;
+            m_iv = iv;
+            return true;
+        }
 
-        auto cipher = Botan::Cipher_Mode::create_or_throw(botanMode.toStdString(), botanDirection);
-        m_cipher.reset(cipher.release());
+        if (reuseCipher) {
+            m_cipher->clear();
+        } else {
+            auto botanDirection =
+                (direction == SymmetricCipher::Encrypt ? Botan::Cipher_Dir::ENCRYPTION : Botan::Cipher_Dir::DECRYPTION);
+            auto cipher = Botan::Cipher_Mode::create_or_throw(botanMode.toStdString(), botanDirection);
+            m_cipher.reset(cipher.release());
+        }
         m_cipher->set_key(reinterpret_cast<const uint8_t*>(key.data()), key.size());
 
         if (!m_cipher->valid_nonce_length(iv.size())) {
@@ -47,6 +126,13 @@ bool SymmetricCipher::init(Mode mode, Direction direction, const QByteArray& key
             return false;
         }
         m_cipher->start(reinterpret_cast<const uint8_t*>(iv.data()), iv.size());
+
+        if (direction == Decrypt && (mode == Aes128_CBC || mode == Aes256_CBC || mode == Twofish_CBC)) {
+            m_key = key;
+            for (const auto& worker : asConst(m_workers)) {
+                worker->set_key(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+            }
+        }
     } catch (std::exception& e) {
         m_mode = InvalidMode;
         m_cipher.reset();
@@ -61,7 +147,7 @@ bool SymmetricCipher::init(Mode mode, Direction direction, const QByteArray& key
 
 bool SymmetricCipher::isInitalized() const
 {
-    return m_cipher;
+    return m_cipher || m_stream;
 }
 
 bool SymmetricCipher::process(char* data, int len)
@@ -78,7 +164,13 @@ bool SymmetricCipher::process(char* data, int len)
 
     try {
         // Block size is checked by Botan, an exception is thrown if invalid
-        m_cipher->process(reinterpret_cast<uint8_t*>(data), len);
+        if (m_stream) {
+            processChaCha20(data, len);
+        } else if (!m_key.isEmpty() && len >= ParallelThreshold && len % blockSize(m_mode) == 0) {
+            decryptCbcParallel(data, len);
+        } else {
+            m_cipher->process(reinterpret_cast<uint8_t*>(data), len);
+        }
         return true;
     } catch (std::exception& e) {
         m_error = e.what();
@@ -100,6 +192,14 @@ bool SymmetricCipher::finish(QByteArray& data)
     }
 
     try {
+        // ChaCha20 has no padding, finishing only processes the remaining data
+        if (m_stream) {
+            if (!data.isEmpty()) {
+                processChaCha20(data.data(), data.size());
+            }
+            return true;
+        }
+
         // Error checking is done by Botan, an exception is thrown if invalid
         Botan::secure_vector<uint8_t> input(data.begin(), data.end());
         m_cipher->finish(input);
@@ -114,12 +214,105 @@ bool SymmetricCipher::finish(QByteArray& data)
     }
 }
 
+/**
+ * Decrypt CBC data in segments on several threads.
+ *
+ * Every plaintext block only depends on its own and the previous ciphertext
+ * block, so each segment is started with the last ciphertext block of the
+ * segment before it as IV. Afterwards the cipher continues from the last
+ * ciphertext block, as if the data had been decrypted in one go.
+ */
+void SymmetricCipher::decryptCbcParallel(char* data, int len)
+{
+    const int blockLen = blockSize(m_mode);
+    const QVector<int> offsets = segmentOffsets(len, blockLen);
+    if (offsets.isEmpty()) {
+        m_cipher->process(reinterpret_cast<uint8_t*>(data), len);
+        return;
+    }
+    const int segments = offsets.size() - 1;
+
+    // The ciphertext is overwritten, so the IVs are copied first
+    QVector<QByteArray> ivs;
+    for (int i = 1; i <= segments; ++i) {
+        ivs.append(QByteArray(data + offsets.at(i) - blockLen, blockLen));
+    }
+
+    while (m_workers.size() < segments - 1) {
+        auto cipher = Botan::Cipher_Mode::create_or_throw(modeToString(m_mode).toStdString(),
+                                                          Botan::Cipher_Dir::DECRYPTION);
+        cipher->set_key(reinterpret_cast<const uint8_t*>(m_key.constData()), m_key.size());
+        m_workers.append(QSharedPointer<Botan::Cipher_Mode>(cipher.release()));
+    }
+
+    QVector<int> indexes;
+    for (int i = 0; i < segments; ++i) {
+        indexes.append(i);
+    }
+    QtConcurrent::blockingMap(indexes, [&](int i) {
+        Botan::Cipher_Mode* cipher = m_cipher.data();
+        if (i > 0) {
+            cipher = m_workers.at(i - 1).data();
+            cipher->start(reinterpret_cast<const uint8_t*>(ivs.at(i - 1).constData()), blockLen);
+        }
+        cipher->process(reinterpret_cast<uint8_t*>(data + offsets.at(i)), offsets.at(i + 1) - offsets.at(i));
+    });
+
+    m_cipher->start(reinterpret_cast<const uint8_t*>(ivs.last().constData()), blockLen);
+}
+
+/**
+ * Encrypt or decrypt ChaCha20 data, on several threads if it is large.
+ *
+ * The keystream can be computed from any position, so every segment is
+ * processed by its own cipher that is seeked to the segment's position in
+ * the stream. The first segment continues on the main keystream, which is
+ * then moved past the end of the data.
+ */
+void SymmetricCipher::processChaCha20(char* data, int len)
+{
+    const QVector<int> offsets = len >= ParallelThreshold ? segmentOffsets(len, ChaCha20BlockSize) : QVector<int>();
+    if (offsets.isEmpty()) {
+        m_stream->cipher1(reinterpret_cast<uint8_t*>(data), len);
+        m_streamPosition += len;
+        return;
+    }
+    const int segments = offsets.size() - 1;
+
+    while (m_streamWorkers.size() < segments - 1) {
+        auto stream = Botan::StreamCipher::create_or_throw("ChaCha(20)");
+        stream->set_key(reinterpret_cast<const uint8_t*>(m_key.constData()), m_key.size());
+        stream->set_iv(reinterpret_cast<const uint8_t*>(m_iv.constData()), m_iv.size());
+        m_streamWorkers.append(QSharedPointer<Botan::StreamCipher>(stream.release()));
+    }
+
+    QVector<int> indexes;
+    for (int i = 0; i < segments; ++i) {
+        indexes.append(i);
+    }
+    QtConcurrent::blockingMap(indexes, [&](int i) {
+        Botan::StreamCipher* stream = m_stream.data();
+        if (i > 0) {
+            stream = m_streamWorkers.at(i - 1).data();
+            stream->seek(m_streamPosition + offsets.at(i));
+        }
+        stream->cipher1(reinterpret_cast<uint8_t*>(data + offsets.at(i)), offsets.at(i + 1) - offsets.at(i));
+    });
+
+    m_streamPosition += len;
+    m_stream->seek(m_streamPosition);
+}
+
 void SymmetricCipher::reset()
 {
     m_error.clear();
-    if (isInitalized()) {
-        m_cipher.reset();
-    }
+    m_key.clear();
+    m_workers.clear();
+    m_iv.clear();
+    m_streamPosition = 0;
+    m_cipher.reset();
+    m_stream.reset();
+    m_streamWorkers.clear();
 }
 
 SymmetricCipher::Mode SymmetricCipher::mode()
@@ -129,6 +322,12 @@ SymmetricCipher::Mode SymmetricCipher::mode()
 
 bool SymmetricCipher::aesKdf(const QByteArray& key, int rounds, QByteArray& data)
 {
+    if (key.size() == 32 && data.size() == 32 && AesKdfAccel::isSupported()) {
+        auto keyData = reinterpret_cast<const unsigned char*>(key.constData());
+        AesKdfAccel::transform(keyData, rounds, reinterpret_cast<unsigned char*>(data.data()));
+        return true;
+    }
+
     try {
         std::unique_ptr<Botan::BlockCipher> cipher(Botan::BlockCipher::create("AES-256"));
         cipher->set_key(reinterpret_cast<const uint8_t*>(key.data()), key.size());
@@ -21,10 +21,12 @@
 #include <QByteArray>
 #include <QSharedPointer>
 #include <QString>
+#include <QVector>
 
 namespace Botan
 {
     class Cipher_Mode;
+    class StreamCipher;
 }
 
 class SymmetricCipher
@@ -74,10 +76,21 @@ public:
 
 private:
     static QString modeToString(const Mode mode);
+    void decryptCbcParallel(char* data, int len);
+    void processChaCha20(char* data, int len);
 
     QString m_error;
-    Mode m_mode;
+    Mode m_mode = InvalidMode;
+    Direction m_direction = Decrypt;
     QSharedPointer<Botan::Cipher_Mode> m_cipher;
+    // Key and ciphers for decrypting CBC data on several threads
+    QByteArray m_key;
+    QVector<QSharedPointer<Botan::Cipher_Mode>> m_workers;
+    // Seekable keystreams for processing ChaCha20 data on several threads
+    QByteArray m_iv;
+    quint64 m_streamPosition = 0;
+    QSharedPointer<Botan::StreamCipher> m_stream;
+    QVector<QSharedPointer<Botan::StreamCipher>> m_streamWorkers;
 
     Q_DISABLE_COPY(SymmetricCipher)
 };
@@ -19,6 +19,7 @@
 
 #include <QtConcurrent>
 
+#include "core/Trace.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/SymmetricCipher.h"
 #include "format/KeePass2.h"
@@ -62,6 +63,7 @@ QVariantMap AesKdf::writeParameters()
 
 bool AesKdf::transform(const QByteArray& raw, QByteArray& result) const
 {
+    TRACE_SCOPE("Kdf::transform");
     return transformKeyRaw(raw, m_seed, m_rounds, &result);
 }
 
@@ -82,24 +84,9 @@ QSharedPointer<Kdf> AesKdf::clone() const
     return QSharedPointer<AesKdf>::create(*this);
 }
 
-int AesKdf::benchmark(int msec) const
+int AesKdf::benchmarkProbeRounds() const
 {
-    QByteArray key(16, '\x7E');
-    QByteArray seed(32, '\x4B');
-
-    int trials = 3;
-    int rounds = 1000000;
-
-    QElapsedTimer timer;
-    timer.start();
-    for (int i = 0; i < trials; ++i) {
-        QByteArray result;
-        if (!transformKeyRaw(key, seed, rounds, &result)) {
-            return rounds;
-        }
-    }
-
-    return static_cast<int>(rounds * trials * static_cast<float>(msec) / timer.elapsed());
+    return 250000;
 }
 
 QString AesKdf::toString() const
@@ -32,7 +32,8 @@ public:
     QSharedPointer<Kdf> clone() const override;
     QString toString() const override;
 
-    int benchmark(int msec) const override;
+protected:
+    int benchmarkProbeRounds() const override;
 
 private:
     Q_REQUIRED_RESULT static bool
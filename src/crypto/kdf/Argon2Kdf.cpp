@@ -17,11 +17,12 @@
 
 #include "Argon2Kdf.h"
 
-#include <QElapsedTimer>
 #include <QThread>
 
 #include <argon2.h>
 
+#include "core/Trace.h"
+#include "crypto/Argon2Accel.h"
 #include "format/KeePass2.h"
 
 /**
@@ -163,8 +164,24 @@ QVariantMap Argon2Kdf::writeParameters()
 
 bool Argon2Kdf::transform(const QByteArray& raw, QByteArray& result) const
 {
+    TRACE_SCOPE("Kdf::transform");
     result.clear();
     result.resize(32);
+
+    const auto kernel = Argon2Accel::bestKernel();
+    if (kernel != Argon2Accel::Kernel::Portable) {
+        return Argon2Accel::hash(kernel,
+                                 type() == Type::Argon2d ? Argon2Accel::Type::Argon2d : Argon2Accel::Type::Argon2id,
+                                 version(),
+                                 static_cast<quint32>(rounds()),
+                                 static_cast<quint32>(memory()),
+                                 parallelism(),
+                                 raw,
+                                 seed(),
+                                 result);
+    }
+
+    // Without a SIMD kernel, fall back to the system library which may have been built for this CPU
     // Time Cost, Mem Cost, Threads/Lanes, Password, length, Salt, length, out, length
 
     int rc = argon2_hash(rounds(),
@@ -193,17 +210,9 @@ QSharedPointer<Kdf> Argon2Kdf::clone() const
     return QSharedPointer<Argon2Kdf>::create(*this);
 }
 
-int Argon2Kdf::benchmark(int msec) const
+int Argon2Kdf::benchmarkProbeRounds() const
 {
-    QByteArray key = QByteArray(16, '\x7E');
-
-    QElapsedTimer timer;
-    timer.start();
-
-    if (transform(key, key)) {
-        return static_cast<int>(rounds() * (static_cast<float>(msec) / timer.elapsed()));
-    }
-
+    // A single pass over the configured memory already takes a noticeable time
     return 1;
 }
 
@@ -212,3 +221,15 @@ QString Argon2Kdf::toString() const
     return QObject::tr("Argon2%1 (%2 rounds, %3 KB)")
         .arg(type() == Type::Argon2d ? "d" : "id", QString::number(rounds()), QString::number(memory()));
 }
+
+/**
+ * @return name of the Argon2 implementation that transform() uses on this CPU
+ */
+QString Argon2Kdf::implementation() const
+{
+    const auto kernel = Argon2Accel::bestKernel();
+    if (kernel == Argon2Accel::Kernel::Portable) {
+        return QStringLiteral("libargon2");
+    }
+    return QString::fromLatin1(Argon2Accel::kernelName(kernel));
+}
@@ -44,8 +44,10 @@ public:
     quint32 parallelism() const;
     bool setParallelism(quint32 threads);
     QString toString() const override;
+    QString implementation() const override;
 
-    int benchmark(int msec) const override;
+protected:
+    int benchmarkProbeRounds() const override;
 
     quint32 m_version;
     quint64 m_memory;
@@ -17,8 +17,29 @@
 
 #include "Kdf.h"
 
+#include "core/Global.h"
 #include "crypto/Random.h"
 
+#include <QElapsedTimer>
+#include <QVector>
+#include <QtMath>
+
+#include <algorithm>
+
+namespace
+{
+    // Always take this many sample pairs, even if they exceed the target time
+    const int MinBenchmarkSamples = 2;
+    const int MaxBenchmarkSamples = 5;
+
+    qreal median(QVector<qreal> values)
+    {
+        std::sort(values.begin(), values.end());
+        const int mid = values.size() / 2;
+        return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+    }
+} // namespace
+
 Kdf::Kdf(const QUuid& uuid)
     : m_rounds(KDF_DEFAULT_ROUNDS)
     , m_seed(QByteArray(KDF_MAX_SEED_SIZE, 0))
@@ -65,3 +86,106 @@ void Kdf::randomizeSeed()
 {
     setSeed(randomGen()->randomArray(m_seed.size()));
 }
+
+/**
+ * @return name of the implementation that transforms keys, if there is a choice
+ */
+QString Kdf::implementation() const
+{
+    return {};
+}
+
+/**
+ * Estimate the number of rounds that take the given time to transform.
+ *
+ * @param msec target transform time in milliseconds
+ * @return number of rounds
+ */
+int Kdf::benchmark(int msec) const
+{
+    return benchmarkDetailed(msec).rounds;
+}
+
+/**
+ * Measure the cost of this KDF with its current parameters (memory,
+ * parallelism) and estimate the number of rounds for the given time.
+ *
+ * A discarded warm-up run ramps up the CPU clock before timing starts. Pairs
+ * of transforms with one and two times benchmarkProbeRounds() are then timed,
+ * and the medians give the cost per round separately from the fixed cost per
+ * transform (allocating and faulting in memory). Sampling stops once the
+ * target time is spent, after at least MinBenchmarkSamples pairs.
+ *
+ * @param msec target transform time in milliseconds
+ * @return estimated rounds, the fitted costs and the relative standard
+ *         deviation of the samples
+ */
+Kdf::BenchmarkResult Kdf::benchmarkDetailed(int msec) const
+{
+    BenchmarkResult result;
+    result.implementation = implementation();
+
+    const int probeRounds = benchmarkProbeRounds();
+    auto kdf = clone();
+    QByteArray key(16, '\x7E');
+    QByteArray transformed;
+
+    auto sample = [&](int rounds, qreal& elapsed) {
+        kdf->setRounds(rounds);
+        QElapsedTimer timer;
+        timer.start();
+        bool ok = kdf->transform(key, transformed);
+        elapsed = timer.nsecsElapsed() / 1e6;
+        return ok;
+    };
+
+    qreal elapsed;
+    if (!sample(probeRounds, elapsed)) {
+        return result;
+    }
+
+    QVector<qreal> shortRuns;
+    QVector<qreal> longRuns;
+    QElapsedTimer budget;
+    budget.start();
+    do {
+        qreal shortRun;
+        qreal longRun;
+        if (!sample(probeRounds, shortRun) || !sample(probeRounds * 2, longRun)) {
+            return result;
+        }
+        shortRuns << shortRun;
+        longRuns << longRun;
+    } while (shortRuns.size() < MinBenchmarkSamples
+             || (shortRuns.size() < MaxBenchmarkSamples && budget.elapsed() < msec));
+
+    const qreal shortMedian = median(shortRuns);
+    const qreal longMedian = median(longRuns);
+    result.samples = longRuns.size();
+    result.msecPerRound = (longMedian - shortMedian) / probeRounds;
+    if (result.msecPerRound > 0) {
+        result.msecOverhead = qMax<qreal>(0, shortMedian - result.msecPerRound * probeRounds);
+    } else {
+        // Too noisy to separate the fixed cost, fall back to the average
+        result.msecPerRound = longMedian / (probeRounds * 2);
+        result.msecOverhead = 0;
+    }
+
+    qreal mean = 0;
+    for (qreal run : asConst(longRuns)) {
+        mean += run;
+    }
+    mean /= longRuns.size();
+    qreal variance = 0;
+    for (qreal run : asConst(longRuns)) {
+        variance += (run - mean) * (run - mean);
+    }
+    variance /= longRuns.size();
+    result.deviation = mean > 0 ? qSqrt(variance) / mean : 0;
+
+    if (result.msecPerRound > 0) {
+        const qreal rounds = (msec - result.msecOverhead) / result.msecPerRound;
+        result.rounds = static_cast<int>(qBound<qreal>(1, rounds, INT_MAX - 1));
+    }
+    return result;
+}
@@ -45,8 +45,20 @@ public:
     virtual QSharedPointer<Kdf> clone() const = 0;
 
     virtual QString toString() const = 0;
+    virtual QString implementation() const;
 
-    virtual int benchmark(int msec) const = 0;
+    struct BenchmarkResult
+    {
+        int rounds = 1;
+        qreal msecPerRound = 0;
+        qreal msecOverhead = 0;
+        qreal deviation = 0;
+        int samples = 0;
+        QString implementation;
+    };
+
+    int benchmark(int msec) const;
+    BenchmarkResult benchmarkDetailed(int msec) const;
 
     /*
      * Default target encryption time, in MS.
@@ -62,6 +74,8 @@ public:
     static const int MAX_ENCRYPTION_TIME = 5000;
 
 protected:
+    virtual int benchmarkProbeRounds() const = 0;
+
     int m_rounds;
     QByteArray m_seed;
 
@@ -17,6 +17,8 @@
 
 #include "fdosecrets/dbus/DBusObject.h"
 
+#include "core/Trace.h"
+
 #include <QDBusMetaType>
 #include <QThread>
 #include <QtDBus>
@@ -164,6 +166,7 @@ namespace FdoSecrets
 
     bool DBusMgr::handleMessage(const QDBusMessage& message, const QDBusConnection&)
     {
+        TRACE_SCOPE("DBusMgr::handleMessage");
         // save a mutable copy of the message, as we may modify it to unify property access
         // and method call
         RequestedMethod req{
@@ -239,7 +242,7 @@ namespace FdoSecrets
                                  const RequestedMethod& req,
                                  const QDBusMessage& msg)
     {
-        auto obj = m_objects.value(path, nullptr);
+        auto obj = objectAt(path);
         if (!obj) {
             qDebug() << "DBusMgr::handleMessage with unknown path" << msg;
             return false;
@@ -228,6 +228,10 @@ namespace FdoSecrets
         m_watcher.setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
         connect(&m_watcher, &QDBusServiceWatcher::serviceUnregistered, this, &DBusMgr::dbusServiceUnregistered);
         m_watcher.setConnection(m_conn);
+
+        m_flushSignalsTimer.setSingleShot(true);
+        m_flushSignalsTimer.setInterval(0);
+        connect(&m_flushSignalsTimer, &QTimer::timeout, this, &DBusMgr::flushChangedSignals);
     }
 
     void DBusMgr::populateMethodCache()
@@ -287,11 +291,42 @@ namespace FdoSecrets
                                  const QString& name,
                                  const QVariantList& arguments)
     {
+        flushChangedSignals();
+
         auto msg = QDBusMessage::createSignal(path, interface, name);
         msg.setArguments(arguments);
         return sendDBus(msg);
     }
 
+    void DBusMgr::queueChangedSignal(const QString& path,
+                                     const QString& interface,
+                                     const QString& name,
+                                     const QVariantList& arguments)
+    {
+        // the changed object is the only argument
+        auto key = QStringLiteral("%1 %2 %3").arg(path, name, arguments.value(0).value<QDBusObjectPath>().path());
+        if (m_pendingSignalKeys.contains(key)) {
+            return;
+        }
+        m_pendingSignalKeys.insert(key);
+
+        auto msg = QDBusMessage::createSignal(path, interface, name);
+        msg.setArguments(arguments);
+        m_pendingSignals.append(msg);
+        m_flushSignalsTimer.start();
+    }
+
+    void DBusMgr::flushChangedSignals()
+    {
+        m_flushSignalsTimer.stop();
+        QList<QDBusMessage> pending;
+        pending.swap(m_pendingSignals);
+        m_pendingSignalKeys.clear();
+        for (const auto& msg : pending) {
+            sendDBus(msg);
+        }
+    }
+
     bool DBusMgr::sendDBus(const QDBusMessage& reply)
     {
         bool ok = m_conn.send(reply);
@@ -405,9 +440,12 @@ namespace FdoSecrets
             .arg(otherService);
     }
 
-    bool DBusMgr::registerObject(const QString& path, DBusObject* obj, bool primary)
+    bool DBusMgr::registerObject(const QString& path,
+                                 DBusObject* obj,
+                                 bool primary,
+                                 QDBusConnection::VirtualObjectRegisterOption options)
     {
-        if (!m_conn.registerVirtualObject(path, this)) {
+        if (!m_conn.registerVirtualObject(path, this, options)) {
             qDebug() << "failed to register" << obj << "at" << path;
             return false;
         }
@@ -447,12 +485,13 @@ namespace FdoSecrets
     {
         auto name = encodePath(coll->name());
         auto path = DBUS_PATH_TEMPLATE_COLLECTION.arg(DBUS_PATH_SECRETS, name);
-        if (!registerObject(path, coll)) {
+        // the collection owns the subtree, so messages to its items reach us without registering each item
+        if (!registerObject(path, coll, true, QDBusConnection::SubPath)) {
             // try again with a suffix
             name.append(QString("_%1").arg(Tools::uuidToHex(QUuid::createUuid()).left(4)));
             path = DBUS_PATH_TEMPLATE_COLLECTION.arg(DBUS_PATH_SECRETS, name);
 
-            if (!registerObject(path, coll)) {
+            if (!registerObject(path, coll, true, QDBusConnection::SubPath)) {
                 qDebug() << "Failed to register database on DBus under name" << name;
                 emit error(tr("Failed to register database on DBus under the name '%1'").arg(name));
                 return false;
@@ -479,10 +518,14 @@ namespace FdoSecrets
     bool DBusMgr::registerObject(Item* item)
     {
         auto path = DBUS_PATH_TEMPLATE_ITEM.arg(item->collection()->objectPath().path(), item->backend()->uuidToHex());
-        if (!registerObject(path, item)) {
+        // item paths are covered by the collection's subtree registration
+        if (m_objects.contains(path)) {
             emit error(tr("Failed to register item on DBus at path '%1'").arg(path));
             return false;
         }
+        connect(item, &DBusObject::destroyed, this, &DBusMgr::unregisterObject);
+        m_objects.insert(path, item);
+        item->setObjectPath(path);
         return true;
     }
 
@@ -501,13 +544,32 @@ namespace FdoSecrets
 
     void DBusMgr::unregisterObject(DBusObject* obj)
     {
-        auto count = m_objects.remove(obj->objectPath().path());
+        const auto path = obj->objectPath().path();
+        auto count = m_objects.remove(path);
         if (count > 0) {
-            m_conn.unregisterObject(obj->objectPath().path());
+            if (parsePath(path).type != PathType::Item) {
+                m_conn.unregisterObject(path);
+            }
             obj->setObjectPath("/");
         }
     }
 
+    DBusObject* DBusMgr::objectAt(const QString& path) const
+    {
+        auto obj = m_objects.value(path, nullptr);
+        if (obj) {
+            return obj;
+        }
+        if (parsePath(path).type != PathType::Item) {
+            return nullptr;
+        }
+        auto coll = qobject_cast<Collection*>(m_objects.value(path.section('/', 0, -2), nullptr));
+        if (!coll) {
+            return nullptr;
+        }
+        return coll->itemForId(path.section('/', -1));
+    }
+
     bool DBusMgr::registerAlias(Collection* coll, const QString& alias)
     {
         auto path = DBUS_PATH_TEMPLATE_ALIAS.arg(DBUS_PATH_SECRETS, alias);
@@ -541,7 +603,7 @@ namespace FdoSecrets
     {
         QVariantList args;
         args += QVariant::fromValue(coll->objectPath());
-        sendDBusSignal(DBUS_PATH_SECRETS, DBUS_INTERFACE_SECRET_SERVICE, "CollectionChanged", args);
+        queueChangedSignal(DBUS_PATH_SECRETS, DBUS_INTERFACE_SECRET_SERVICE, QStringLiteral("CollectionChanged"), args);
     }
 
     void DBusMgr::emitCollectionDeleted(Collection* coll)
@@ -572,12 +634,12 @@ namespace FdoSecrets
         QVariantList args;
         args += QVariant::fromValue(item->objectPath());
         // send on primary path
-        sendDBusSignal(
+        queueChangedSignal(
             coll->objectPath().path(), DBUS_INTERFACE_SECRET_COLLECTION, QStringLiteral("ItemChanged"), args);
         // also send on all alias path
         for (const auto& alias : coll->aliases()) {
             auto path = DBUS_PATH_TEMPLATE_ALIAS.arg(DBUS_PATH_SECRETS, alias);
-            sendDBusSignal(path, DBUS_INTERFACE_SECRET_COLLECTION, QStringLiteral("ItemChanged"), args);
+            queueChangedSignal(path, DBUS_INTERFACE_SECRET_COLLECTION, QStringLiteral("ItemChanged"), args);
         }
     }
 
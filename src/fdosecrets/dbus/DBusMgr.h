@@ -24,6 +24,7 @@
 #include <QDBusServiceWatcher>
 #include <QDBusVirtualObject>
 #include <QDebug>
+#include <QTimer>
 #include <QtDBus>
 
 class TestFdoSecrets;
@@ -74,6 +75,10 @@ namespace FdoSecrets
      *                                   Z& output1,
      *                                   ZZ& output2)
      * Note that the first parameter of client is optional.
+     *
+     * All calls are handled on the GUI thread, which owns the exposed databases. Database, Group and Entry have no
+     * locking, so a separate D-Bus thread would have no consistent view to answer read-only calls from. The
+     * expensive part of SearchItems runs in parallel inside EntrySearcher while the call waits.
      */
     class DBusMgr : public QDBusVirtualObject
     {
@@ -169,7 +174,7 @@ namespace FdoSecrets
             if (path.path() == QStringLiteral("/")) {
                 return nullptr;
             }
-            auto obj = qobject_cast<T*>(m_objects.value(path.path(), nullptr));
+            auto obj = qobject_cast<T*>(objectAt(path.path()));
             if (!obj) {
                 qDebug() << "object not found at path" << path.path();
                 qDebug() << m_objects;
@@ -227,6 +232,20 @@ namespace FdoSecrets
                             const QVariantList& arguments);
         bool sendDBus(const QDBusMessage& reply);
 
+        /**
+         * Queue a *Changed signal. Repeated changes of the same object before control
+         * returns to the event loop are sent once. Other signals flush the queue first,
+         * so the order seen by clients is kept.
+         */
+        void queueChangedSignal(const QString& path,
+                                const QString& interface,
+                                const QString& name,
+                                const QVariantList& arguments);
+        void flushChangedSignals();
+        QList<QDBusMessage> m_pendingSignals{};
+        QSet<QString> m_pendingSignalKeys{};
+        QTimer m_flushSignalsTimer{};
+
         // object path registration
         QHash<QString, QPointer<DBusObject>> m_objects{};
         enum class PathType
@@ -253,7 +272,15 @@ namespace FdoSecrets
             }
         };
         static ParsedPath parsePath(const QString& path);
-        bool registerObject(const QString& path, DBusObject* obj, bool primary = true);
+        bool registerObject(const QString& path,
+                            DBusObject* obj,
+                            bool primary = true,
+                            QDBusConnection::VirtualObjectRegisterOption options = QDBusConnection::SingleNode);
+        /**
+         * Find the object exported at path. Items are created by their collection on first access.
+         * @return the object, or nullptr if nothing is exported at path
+         */
+        DBusObject* objectAt(const QString& path) const;
 
         // method dispatching
         struct MethodData
@@ -29,6 +29,8 @@
 #include <QEventLoop>
 #include <QFileInfo>
 
+#include <algorithm>
+
 namespace FdoSecrets
 {
     Collection* Collection::Create(Service* parent, DatabaseWidget* backend)
@@ -64,9 +66,9 @@ namespace FdoSecrets
 
         // delete all items
         // this has to be done because the backend is actually still there, just we don't expose them
-        // NOTE: Do NOT use a for loop, because Item::removeFromDBus will remove itself from m_items.
-        while (!m_items.isEmpty()) {
-            m_items.first()->removeFromDBus();
+        // NOTE: Do NOT use a for loop, because Item::removeFromDBus will remove itself from m_entryToItem.
+        while (!m_entryToItem.isEmpty()) {
+            m_entryToItem.begin().value()->removeFromDBus();
         }
         cleanupConnections();
         dbus()->unregisterObject(this);
@@ -113,13 +115,23 @@ namespace FdoSecrets
         return {};
     }
 
-    DBusResult Collection::items(QList<Item*>& items) const
+    DBusResult Collection::items(QList<QDBusObjectPath>& items) const
     {
         auto ret = ensureBackend();
         if (ret.err()) {
             return ret;
         }
-        items = m_items;
+        items.clear();
+        if (!m_exposedGroup) {
+            return {};
+        }
+        // list paths without creating the items, they are created when a client accesses them
+        const auto entries = m_exposedGroup->entriesRecursive(false);
+        for (const auto& entry : entries) {
+            if (m_indexedAttributes.contains(entry)) {
+                items << QDBusObjectPath(DBUS_PATH_TEMPLATE_ITEM.arg(objectPath().path(), entry->uuidToHex()));
+            }
+        }
         return {};
     }
 
@@ -230,8 +242,9 @@ namespace FdoSecrets
         if (attributes.contains(ItemAttributes::UuidKey)) {
             auto uuid = QUuid::fromRfc4122(QByteArray::fromHex(attributes.value(ItemAttributes::UuidKey).toLatin1()));
             auto entry = m_exposedGroup->findEntryByUuid(uuid);
-            if (entry) {
-                items += m_entryToItem.value(entry);
+            auto item = itemForEntry(entry);
+            if (item) {
+                items << item;
             }
             return {};
         }
@@ -239,12 +252,17 @@ namespace FdoSecrets
         if (attributes.contains(ItemAttributes::PathKey)) {
             auto path = attributes.value(ItemAttributes::PathKey);
             auto entry = m_exposedGroup->findEntryByPath(path);
-            if (entry) {
-                items += m_entryToItem.value(entry);
+            auto item = itemForEntry(entry);
+            if (item) {
+                items << item;
             }
             return {};
         }
 
+        if (searchAttributeIndex(attributes, items)) {
+            return {};
+        }
+
         QList<EntrySearcher::SearchTerm> terms;
         for (auto it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
             terms << attributeToTerm(it.key(), it.value());
@@ -257,7 +275,7 @@ namespace FdoSecrets
             EntrySearcher(caseSensitive, skipProtected).search(terms, m_exposedGroup, forceSearch);
         items.reserve(foundEntries.size());
         for (const auto& entry : foundEntries) {
-            const auto item = m_entryToItem.value(entry);
+            const auto item = itemForEntry(entry);
             // it's possible that we don't have a corresponding item for the entry
             // this can happen when the recycle bin is below the exposed group.
             if (item) {
@@ -267,6 +285,94 @@ namespace FdoSecrets
         return {};
     }
 
+    /**
+     * Look up items by exact custom attribute values, the common case for libsecret clients.
+     *
+     * @return false if the attributes need a full search, because they are empty,
+     *         name a default attribute or an attribute protected in some entry
+     */
+    bool Collection::searchAttributeIndex(const StringStringMap& attributes, QList<Item*>& items)
+    {
+        if (attributes.isEmpty()) {
+            return false;
+        }
+        for (auto it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
+            if (EntryAttributes::isDefaultAttribute(it.key()) || m_protectedAttributeCount.value(it.key()) > 0) {
+                return false;
+            }
+        }
+
+        // Intersect starting from the smallest candidate set
+        QList<const QSet<const Entry*>*> candidates;
+        static const QSet<const Entry*> noEntries;
+        for (auto it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
+            const auto found = m_attributeIndex.constFind(qMakePair(it.key(), it.value()));
+            candidates << (found == m_attributeIndex.constEnd() ? &noEntries : &found.value());
+        }
+        std::sort(candidates.begin(),
+                  candidates.end(),
+                  [](const QSet<const Entry*>* lhs, const QSet<const Entry*>* rhs) {
+                      return lhs->size() < rhs->size();
+                  });
+
+        QList<Entry*> matched;
+        for (const auto* entry : *candidates.first()) {
+            bool matches = true;
+            for (int i = 1; i < candidates.size() && matches; ++i) {
+                matches = candidates[i]->contains(entry);
+            }
+            if (matches) {
+                matched << const_cast<Entry*>(entry);
+            }
+        }
+        // creating items may touch the index, so only do it after the lookup
+        for (auto* entry : asConst(matched)) {
+            auto item = itemForEntry(entry);
+            if (item) {
+                items << item;
+            }
+        }
+        return true;
+    }
+
+    void Collection::indexEntry(const Entry* entry)
+    {
+        unindexEntry(entry);
+
+        const auto* entryAttrs = entry->attributes();
+        IndexedAttributes indexed;
+        for (const auto& key : entryAttrs->customKeys()) {
+            if (entryAttrs->isProtected(key)) {
+                indexed.protectedKeys << key;
+                ++m_protectedAttributeCount[key];
+            } else {
+                const auto pair = qMakePair(key, entryAttrs->value(key));
+                indexed.values << pair;
+                m_attributeIndex[pair].insert(entry);
+            }
+        }
+        m_indexedAttributes.insert(entry, indexed);
+    }
+
+    void Collection::unindexEntry(const Entry* entry)
+    {
+        const auto indexed = m_indexedAttributes.take(entry);
+        for (const auto& pair : indexed.values) {
+            auto it = m_attributeIndex.find(pair);
+            if (it != m_attributeIndex.end()) {
+                it->remove(entry);
+                if (it->isEmpty()) {
+                    m_attributeIndex.erase(it);
+                }
+            }
+        }
+        for (const auto& key : indexed.protectedKeys) {
+            if (--m_protectedAttributeCount[key] <= 0) {
+                m_protectedAttributeCount.remove(key);
+            }
+        }
+    }
+
     EntrySearcher::SearchTerm Collection::attributeToTerm(const QString& key, const QString& value)
     {
         static QMap<QString, EntrySearcher::Field> attrKeyToField{
@@ -462,12 +568,18 @@ namespace FdoSecrets
             onDatabaseExposedGroupChanged();
         });
 
-        // Add items for existing entry
+        // Track existing entries, their items are created on demand
         const auto entries = m_exposedGroup->entriesRecursive(false);
         for (const auto& entry : entries) {
             onEntryAdded(entry, false);
         }
 
+        // Hold back ItemChanged while the database is batch updated, e.g. by a merge
+        connect(m_backend->database().data(), &Database::batchUpdateStarted, this, [this]() {
+            m_inBatchUpdate = true;
+        });
+        connect(m_backend->database().data(), &Database::batchUpdateFinished, this, &Collection::onBatchUpdateFinished);
+
         // Do not connect to Database::modified signal because we only want signals for the subset under m_exposedGroup
         connect(m_backend->database()->metadata(), &Metadata::modified, this, &Collection::collectionChanged);
         connectGroupSignalRecursive(m_exposedGroup);
@@ -478,7 +590,8 @@ namespace FdoSecrets
         // delete all items
         // this has to be done because the backend is actually still there
         // just we don't expose them
-        for (const auto& item : asConst(m_items)) {
+        const auto items = m_entryToItem.values();
+        for (const auto& item : items) {
             item->removeFromDBus();
         }
 
@@ -494,32 +607,104 @@ namespace FdoSecrets
             return;
         }
 
-        auto item = Item::Create(this, entry);
-        if (!item) {
+        indexEntry(entry);
+        connect(entry, &Entry::modified, this, [this, entry]() { onEntryModified(entry); });
+
+        if (emitSignal) {
+            auto item = itemForEntry(entry);
+            if (item) {
+                emit itemCreated(item);
+            }
+        }
+    }
+
+    void Collection::onEntryModified(Entry* entry)
+    {
+        indexEntry(entry);
+        if (m_inBatchUpdate) {
+            m_batchModifiedEntries.insert(entry);
             return;
         }
+        auto item = itemForEntry(entry);
+        if (item) {
+            emit itemChanged(item);
+        }
+    }
+
+    void Collection::onBatchUpdateFinished()
+    {
+        // Past a handful of items, e.g. after a merge, one CollectionChanged is cheaper
+        // for every listening client than a signal per item
+        static const int MaxItemChangedSignals = 50;
 
-        m_items << item;
-        m_entryToItem[entry] = item;
+        m_inBatchUpdate = false;
+        QSet<const Entry*> modified;
+        modified.swap(m_batchModifiedEntries);
 
-        // forward delete signals
-        connect(entry->group(), &Group::entryAboutToRemove, item, [item](Entry* toBeRemoved) {
-            if (item->backend() == toBeRemoved) {
-                item->removeFromDBus();
+        QList<Entry*> entries;
+        for (const auto* entry : modified) {
+            // skip entries removed during the batch
+            if (m_indexedAttributes.contains(entry)) {
+                entries << const_cast<Entry*>(entry);
             }
-        });
+        }
+        if (entries.size() > MaxItemChangedSignals) {
+            emit collectionChanged();
+            return;
+        }
+        for (auto* entry : asConst(entries)) {
+            auto item = itemForEntry(entry);
+            if (item) {
+                emit itemChanged(item);
+            }
+        }
+    }
+
+    void Collection::onEntryAboutToRemove(Entry* entry)
+    {
+        if (!m_indexedAttributes.contains(entry)) {
+            return;
+        }
+        // clients may hold the path from the Items property, so they still get an ItemDeleted signal
+        auto item = itemForEntry(entry);
+        unindexEntry(entry);
+        m_batchModifiedEntries.remove(entry);
+        entry->disconnect(this);
+        if (item) {
+            item->removeFromDBus();
+        }
+    }
+
+    Item* Collection::itemForId(const QString& itemId)
+    {
+        if (!m_exposedGroup || backendLocked()) {
+            return nullptr;
+        }
+        auto uuid = QUuid::fromRfc4122(QByteArray::fromHex(itemId.toLatin1()));
+        return itemForEntry(m_exposedGroup->findEntryByUuid(uuid));
+    }
+
+    Item* Collection::itemForEntry(Entry* entry)
+    {
+        if (!entry || !m_indexedAttributes.contains(entry)) {
+            // not exposed, e.g. recycled entries below the exposed group
+            return nullptr;
+        }
+        auto item = m_entryToItem.value(entry, nullptr);
+        if (item) {
+            return item;
+        }
 
-        // relay signals
-        connect(item, &Item::itemChanged, this, [this, item]() { emit itemChanged(item); });
+        item = Item::Create(this, entry);
+        if (!item) {
+            return nullptr;
+        }
+        m_entryToItem.insert(entry, item);
         connect(item, &Item::itemAboutToDelete, this, [this, item]() {
-            m_items.removeAll(item);
             m_entryToItem.remove(item->backend());
             emit itemDeleted(item);
         });
-
-        if (emitSignal) {
-            emit itemCreated(item);
-        }
+        return item;
     }
 
     void Collection::connectGroupSignalRecursive(Group* group)
@@ -530,6 +715,7 @@ namespace FdoSecrets
 
         connect(group, &Group::modified, this, &Collection::collectionChanged);
         connect(group, &Group::entryAdded, this, [this](Entry* entry) { onEntryAdded(entry, true); });
+        connect(group, &Group::entryAboutToRemove, this, &Collection::onEntryAboutToRemove);
 
         const auto children = group->children();
         for (const auto& cg : children) {
@@ -600,13 +786,21 @@ namespace FdoSecrets
     void Collection::cleanupConnections()
     {
         m_backend->database()->metadata()->customData()->disconnect(this);
+        m_backend->database()->disconnect(this);
+        m_inBatchUpdate = false;
+        m_batchModifiedEntries.clear();
         if (m_exposedGroup) {
             for (const auto group : m_exposedGroup->groupsRecursive(true)) {
                 group->disconnect(this);
             }
+            for (const auto entry : m_exposedGroup->entriesRecursive(false)) {
+                entry->disconnect(this);
+            }
         }
 
-        m_items.clear();
+        m_attributeIndex.clear();
+        m_protectedAttributeCount.clear();
+        m_indexedAttributes.clear();
     }
 
     QString Collection::backendFilePath() const
@@ -691,7 +885,7 @@ namespace FdoSecrets
         client->setItemAuthorized(entry->uuid(), AuthDecision::Allowed);
 
         // when creation finishes in backend, we will already have item
-        auto created = m_entryToItem.value(entry, nullptr);
+        auto created = itemForEntry(entry);
 
         return created;
     }
@@ -52,7 +52,7 @@ namespace FdoSecrets
          */
         static Collection* Create(Service* parent, DatabaseWidget* backend);
 
-        Q_INVOKABLE DBUS_PROPERTY DBusResult items(QList<Item*>& items) const;
+        Q_INVOKABLE DBUS_PROPERTY DBusResult items(QList<QDBusObjectPath>& items) const;
 
         Q_INVOKABLE DBUS_PROPERTY DBusResult label(QString& label) const;
         Q_INVOKABLE DBusResult setLabel(const QString& label);
@@ -110,6 +110,13 @@ namespace FdoSecrets
 
         static EntrySearcher::SearchTerm attributeToTerm(const QString& key, const QString& value);
 
+        /**
+         * Items are only created when a client first touches them
+         * @param itemId the uuid of the entry in hex, as used in the item path
+         * @return the item, or nullptr if no exposed entry has the uuid
+         */
+        Item* itemForId(const QString& itemId);
+
     public slots:
         // expose some methods for Prompt to use
 
@@ -140,6 +147,13 @@ namespace FdoSecrets
         friend class CreateCollectionPrompt;
 
         void onEntryAdded(Entry* entry, bool emitSignal);
+        void onEntryModified(Entry* entry);
+        void onBatchUpdateFinished();
+        void onEntryAboutToRemove(Entry* entry);
+        Item* itemForEntry(Entry* entry);
+        void indexEntry(const Entry* entry);
+        void unindexEntry(const Entry* entry);
+        bool searchAttributeIndex(const StringStringMap& attributes, QList<Item*>& items);
         void populateContents();
         void connectGroupSignalRecursive(Group* group);
         void cleanupConnections();
@@ -171,8 +185,23 @@ namespace FdoSecrets
         QPointer<Group> m_exposedGroup;
 
         QSet<QString> m_aliases;
-        QList<Item*> m_items;
-        QMap<const Entry*, Item*> m_entryToItem;
+        // only the items created so far, see itemForId
+        QHash<const Entry*, Item*> m_entryToItem;
+
+        // Exact (custom attribute, value) lookups for searchItems
+        struct IndexedAttributes
+        {
+            QList<QPair<QString, QString>> values;
+            QStringList protectedKeys;
+        };
+        QHash<QPair<QString, QString>, QSet<const Entry*>> m_attributeIndex;
+        QHash<QString, int> m_protectedAttributeCount;
+        // also serves as the set of exposed entries
+        QHash<const Entry*, IndexedAttributes> m_indexedAttributes;
+
+        // Entries modified during a batch update of the database, reported when the batch finishes
+        bool m_inBatchUpdate = false;
+        QSet<const Entry*> m_batchModifiedEntries;
     };
 
 } // namespace FdoSecrets
@@ -257,6 +257,20 @@ namespace FdoSecrets
     }
 
     DBusResult Item::getSecretNoNotification(const DBusClientPtr& client, Session* session, Secret& secret) const
+    {
+        auto ret = getPlainSecretNoNotification(client, session, secret);
+        if (ret.err()) {
+            return ret;
+        }
+
+        // encode using session
+        secret = session->encode(secret);
+
+        return {};
+    }
+
+    DBusResult
+    Item::getPlainSecretNoNotification(const DBusClientPtr& client, Session* session, Secret& secret) const
     {
         auto ret = ensureBackend();
         if (ret.err()) {
@@ -276,9 +290,6 @@ namespace FdoSecrets
 
         secret = getEntrySecret(m_backend);
 
-        // encode using session
-        secret = session->encode(secret);
-
         return {};
     }
 
@@ -79,6 +79,11 @@ namespace FdoSecrets
         static const QSet<QString> ReadOnlyAttributes;
 
         DBusResult getSecretNoNotification(const DBusClientPtr& client, Session* session, Secret& secret) const;
+        /**
+         * Same checks as getSecretNoNotification, but leaves the secret unencoded,
+         * so a batch of secrets can be encoded together.
+         */
+        DBusResult getPlainSecretNoNotification(const DBusClientPtr& client, Session* session, Secret& secret) const;
         DBusResult setProperties(const QVariantMap& properties);
 
         Entry* backend() const;
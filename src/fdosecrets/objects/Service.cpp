@@ -432,11 +432,20 @@ namespace FdoSecrets
             return DBusResult(DBUS_ERROR_SECRET_NO_SESSION);
         }
 
+        QList<Secret> plainSecrets;
+        plainSecrets.reserve(items.size());
         for (const auto& item : asConst(items)) {
-            auto ret = item->getSecretNoNotification(client, session, secrets[item]);
+            Secret secret;
+            auto ret = item->getPlainSecretNoNotification(client, session, secret);
             if (ret.err()) {
                 return ret;
             }
+            plainSecrets << secret;
+        }
+
+        const auto encoded = session->encodeAll(plainSecrets);
+        for (int i = 0; i != items.size(); ++i) {
+            secrets[items.at(i)] = encoded.at(i);
         }
         plugin()->emitRequestShowNotification(
             tr(R"(%n Entry(s) was used by %1)", "%1 is the name of an application", secrets.size())
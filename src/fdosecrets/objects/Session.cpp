@@ -72,6 +72,15 @@ namespace FdoSecrets
         return output;
     }
 
+    QList<Secret> Session::encodeAll(const QList<Secret>& inputs) const
+    {
+        auto outputs = m_cipher->encryptAll(inputs);
+        for (auto& output : outputs) {
+            output.session = this;
+        }
+        return outputs;
+    }
+
     Secret Session::decode(const Secret& input) const
     {
         Q_ASSERT(input.session == this);
@@ -51,6 +51,13 @@ namespace FdoSecrets
          */
         Secret encode(const Secret& input) const;
 
+        /**
+         * Encode a batch of secret structs in one pass over the session cipher.
+         * @param inputs
+         * @return the encoded secrets, in the same order as inputs
+         */
+        QList<Secret> encodeAll(const QList<Secret>& inputs) const;
+
         /**
          * Decode the secret struct.
          * @param input
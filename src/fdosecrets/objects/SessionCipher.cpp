@@ -38,6 +38,16 @@ namespace FdoSecrets
     constexpr char PlainCipher::Algorithm[];
     constexpr char DhIetf1024Sha256Aes128CbcPkcs7::Algorithm[];
 
+    QList<Secret> CipherPair::encryptAll(const QList<Secret>& inputs)
+    {
+        QList<Secret> outputs;
+        outputs.reserve(inputs.size());
+        for (const auto& input : inputs) {
+            outputs << encrypt(input);
+        }
+        return outputs;
+    }
+
     DhIetf1024Sha256Aes128CbcPkcs7::DhIetf1024Sha256Aes128CbcPkcs7(const QByteArray& clientPublicKey)
     {
         try {
@@ -83,22 +93,39 @@ namespace FdoSecrets
     }
 
     Secret DhIetf1024Sha256Aes128CbcPkcs7::encrypt(const Secret& input)
+    {
+        return encrypt(input, randomGen()->randomArray(SymmetricCipher::defaultIvSize(SymmetricCipher::Aes128_CBC)));
+    }
+
+    QList<Secret> DhIetf1024Sha256Aes128CbcPkcs7::encryptAll(const QList<Secret>& inputs)
+    {
+        // Draw the IVs for the whole batch at once, the cipher itself is only rekeyed per secret
+        const auto ivSize = SymmetricCipher::defaultIvSize(SymmetricCipher::Aes128_CBC);
+        const auto IVs = randomGen()->randomArray(ivSize * inputs.size());
+
+        QList<Secret> outputs;
+        outputs.reserve(inputs.size());
+        for (int i = 0; i != inputs.size(); ++i) {
+            outputs << encrypt(inputs.at(i), IVs.mid(i * ivSize, ivSize));
+        }
+        return outputs;
+    }
+
+    Secret DhIetf1024Sha256Aes128CbcPkcs7::encrypt(const Secret& input, const QByteArray& IV)
     {
         Secret output = input;
         output.parameters.clear();
         output.value.clear();
 
-        SymmetricCipher encrypter;
-        auto IV = randomGen()->randomArray(SymmetricCipher::defaultIvSize(SymmetricCipher::Aes128_CBC));
-        if (!encrypter.init(SymmetricCipher::Aes128_CBC, SymmetricCipher::Encrypt, m_aesKey, IV)) {
-            qWarning() << "Error encrypt: " << encrypter.errorString();
+        if (!m_encrypter.init(SymmetricCipher::Aes128_CBC, SymmetricCipher::Encrypt, m_aesKey, IV)) {
+            qWarning() << "Error encrypt: " << m_encrypter.errorString();
             return output;
         }
 
         output.parameters = IV;
         output.value = input.value;
-        if (!encrypter.finish(output.value)) {
-            qWarning() << "Error encrypt: " << encrypter.errorString();
+        if (!m_encrypter.finish(output.value)) {
+            qWarning() << "Error encrypt: " << m_encrypter.errorString();
             return output;
         }
 
@@ -107,16 +134,15 @@ namespace FdoSecrets
 
     Secret DhIetf1024Sha256Aes128CbcPkcs7::decrypt(const Secret& input)
     {
-        SymmetricCipher decrypter;
-        if (!decrypter.init(SymmetricCipher::Aes128_CBC, SymmetricCipher::Decrypt, m_aesKey, input.parameters)) {
-            qWarning() << "Error decoding: " << decrypter.errorString();
+        if (!m_decrypter.init(SymmetricCipher::Aes128_CBC, SymmetricCipher::Decrypt, m_aesKey, input.parameters)) {
+            qWarning() << "Error decoding: " << m_decrypter.errorString();
             return input;
         }
 
         Secret output = input;
         output.parameters.clear();
-        if (!decrypter.finish(output.value)) {
-            qWarning() << "Error decoding: " << decrypter.errorString();
+        if (!m_decrypter.finish(output.value)) {
+            qWarning() << "Error decoding: " << m_decrypter.errorString();
             return input;
         }
         return output;
@@ -18,6 +18,7 @@
 #ifndef KEEPASSXC_FDOSECRETS_SESSIONCIPHER_H
 #define KEEPASSXC_FDOSECRETS_SESSIONCIPHER_H
 
+#include "crypto/SymmetricCipher.h"
 #include "fdosecrets/dbus/DBusTypes.h"
 
 #include <QSharedPointer>
@@ -37,6 +38,10 @@ namespace FdoSecrets
         virtual ~CipherPair() = default;
         virtual Secret encrypt(const Secret& input) = 0;
         virtual Secret decrypt(const Secret& input) = 0;
+        /**
+         * Encrypt a batch of secrets, same as calling encrypt on each of them
+         */
+        virtual QList<Secret> encryptAll(const QList<Secret>& inputs);
         virtual bool isValid() const = 0;
         virtual QVariant negotiationOutput() const = 0;
     };
@@ -53,6 +58,11 @@ namespace FdoSecrets
             return input;
         }
 
+        QList<Secret> encryptAll(const QList<Secret>& inputs) override
+        {
+            return inputs;
+        }
+
         Secret decrypt(const Secret& input) override
         {
             return input;
@@ -78,17 +88,23 @@ namespace FdoSecrets
 
         Secret encrypt(const Secret& input) override;
         Secret decrypt(const Secret& input) override;
+        QList<Secret> encryptAll(const QList<Secret>& inputs) override;
         bool isValid() const override;
         QVariant negotiationOutput() const override;
 
         bool updateClientPublicKey(const QByteArray& clientPublicKey);
 
     private:
+        Secret encrypt(const Secret& input, const QByteArray& IV);
+
         Q_DISABLE_COPY(DhIetf1024Sha256Aes128CbcPkcs7);
 
         bool m_valid = false;
         QSharedPointer<Botan::DH_PrivateKey> m_privateKey;
         QByteArray m_aesKey;
+        // Kept across secrets so each one only rekeys the cipher
+        SymmetricCipher m_encrypter;
+        SymmetricCipher m_decrypter;
     };
 
 } // namespace FdoSecrets
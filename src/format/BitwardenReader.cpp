@@ -17,8 +17,11 @@
 
 #include "BitwardenReader.h"
 
+#include "BulkImport.h"
+#include "JsonStreamReader.h"
 #include "core/Database.h"
 #include "core/Entry.h"
+#include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
@@ -29,16 +32,18 @@
 #include <botan/kdf.h>
 #include <botan/pwdhash.h>
 
+#include <QBuffer>
 #include <QFileInfo>
 #include <QJsonArray>
-#include <QJsonDocument>
 #include <QJsonObject>
-#include <QJsonParseError>
 #include <QMap>
 #include <QScopedPointer>
 
 namespace
 {
+    // Items are converted in batches of this size, the JSON of a batch is released before the next one is read
+    const int ITEM_BATCH_SIZE = 1024;
+
     Entry* readItem(const QJsonObject& item, QString& folderId)
     {
         // Create the item map and extract the folder id
@@ -158,32 +163,80 @@ namespace
         return entry.take();
     }
 
-    void writeVaultToDatabase(const QJsonObject& vault, QSharedPointer<Database> db)
+    /**
+     * Read a vault and convert each item as it is parsed. Members other than
+     * the folders and items, such as the encryption parameters, are stored in
+     * header.
+     */
+    bool readVault(JsonStreamReader& reader, const QSharedPointer<Database>& db, QVariantMap& header)
     {
-        if (!vault.contains("folders") || !vault.contains("items")) {
-            // Early out if the vault is missing critical items
-            return;
+        if (!reader.enterObject()) {
+            return false;
         }
 
-        // Create groups from folders and store a temporary map of id -> uuid
+        bool hasFolders = false;
+        bool hasItems = false;
         QMap<QString, Group*> folderMap;
-        for (const auto& folder : vault.value("folders").toArray()) {
-            auto group = new Group();
-            group->setUuid(QUuid::createUuid());
-            group->setName(folder.toObject().value("name").toString());
-            group->setParent(db->rootGroup());
+        QList<Entry*> entries;
+        QVector<QString> folderIds;
+
+        QString key;
+        while (reader.nextKey(key)) {
+            if (key == "folders") {
+                // Create groups from folders and store a temporary map of id -> group
+                hasFolders = true;
+                if (!reader.enterArray()) {
+                    break;
+                }
+                while (reader.nextElement()) {
+                    const auto folder = reader.readValue().toObject();
+                    auto group = new Group();
+                    group->setUuid(QUuid::createUuid());
+                    group->setName(folder.value("name").toString());
+                    group->setParent(db->rootGroup());
+
+                    folderMap.insert(folder.value("id").toString(), group);
+                }
+            } else if (key == "items") {
+                hasItems = true;
+                if (!reader.enterArray()) {
+                    break;
+                }
 
-            folderMap.insert(folder.toObject().value("id").toString(), group);
+                QVector<QJsonObject> items;
+                auto convertItems = [&] {
+                    // Each item only writes its own folder id
+                    QVector<QString> itemFolderIds(items.size());
+                    entries.append(BulkImport::buildEntries(
+                        items.size(), [&](int i) { return readItem(items.at(i), itemFolderIds[i]); }));
+                    folderIds += itemFolderIds;
+                    items.clear();
+                };
+                while (reader.nextElement()) {
+                    items.append(reader.readValue().toObject());
+                    if (items.size() >= ITEM_BATCH_SIZE) {
+                        convertItems();
+                    }
+                }
+                convertItems();
+            } else {
+                header.insert(key, reader.readValue().toVariant());
+            }
         }
 
-        QString folderId;
-        const auto items = vault.value("items").toArray();
-        for (const auto& item : items) {
-            auto entry = readItem(item.toObject(), folderId);
-            if (entry) {
-                entry->setGroup(folderMap.value(folderId, db->rootGroup()), false);
-            }
+        if (reader.hasError() || !hasFolders || !hasItems) {
+            // Early out if the vault is missing critical items
+            qDeleteAll(entries);
+            qDeleteAll(folderMap);
+            return !reader.hasError();
         }
+
+        QList<Group*> groups;
+        for (const auto& folderId : asConst(folderIds)) {
+            groups.append(folderMap.value(folderId, db->rootGroup()));
+        }
+        BulkImport::attachEntries(db.data(), entries, groups);
+        return true;
     }
 } // namespace
 
@@ -214,11 +267,14 @@ QSharedPointer<Database> BitwardenReader::convert(const QString& path, const QSt
         return {};
     }
 
-    QJsonParseError error;
-    auto json = QJsonDocument::fromJson(file.readAll(), &error).object();
-    if (error.error != QJsonParseError::NoError) {
-        m_error =
-            QObject::tr("Cannot parse file: %1 at position %2").arg(error.errorString(), QString::number(error.offset));
+    auto db = QSharedPointer<Database>::create();
+    db->rootGroup()->setName(QObject::tr("Bitwarden Import"));
+
+    QVariantMap json;
+    JsonStreamReader reader(&file);
+    if (!readVault(reader, db, json)) {
+        m_error = QObject::tr("Cannot parse file: %1 at position %2")
+                      .arg(reader.errorString(), QString::number(reader.errorOffset()));
         return {};
     }
 
@@ -297,17 +353,15 @@ QSharedPointer<Database> BitwardenReader::convert(const QString& path, const QSt
             return {};
         }
 
-        json = QJsonDocument::fromJson(data, &error).object();
-        if (error.error != QJsonParseError::NoError) {
-            m_error = buildError(error.errorString());
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        JsonStreamReader decryptedReader(&buffer);
+        QVariantMap decryptedHeader;
+        if (!readVault(decryptedReader, db, decryptedHeader)) {
+            m_error = buildError(decryptedReader.errorString());
             return {};
         }
     }
 
-    auto db = QSharedPointer<Database>::create();
-    db->rootGroup()->setName(QObject::tr("Bitwarden Import"));
-
-    writeVaultToDatabase(json, db);
-
     return db;
 }
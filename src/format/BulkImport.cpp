@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BulkImport.h"
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+namespace BulkImport
+{
+    // Imports smaller than this are not worth the thread overhead
+    const int MIN_CHUNK_SIZE = 256;
+
+    /**
+     * Build the entries for count input items in parallel chunks.
+     *
+     * The build function runs on worker threads, so it must only read its
+     * input and create a detached entry, or return nullptr to skip the item.
+     * The entries are moved to the calling thread and returned in input order,
+     * with nullptr for skipped items.
+     *
+     * @param progress called on the calling thread after each chunk
+     */
+    QList<Entry*> buildEntries(int count, const BuildFunction& build, const ProgressFunction& progress)
+    {
+        QThread* thread = QThread::currentThread();
+        auto buildChunk = [&build, thread](int begin, int end) {
+            QList<Entry*> entries;
+            entries.reserve(end - begin);
+            for (int i = begin; i < end; ++i) {
+                auto entry = build(i);
+                if (entry && entry->thread() != thread) {
+                    entry->moveToThread(thread);
+                }
+                entries.append(entry);
+            }
+            return entries;
+        };
+
+        const int chunks = qBound(1, count / MIN_CHUNK_SIZE, QThread::idealThreadCount() * 4);
+        const int chunkSize = (count + chunks - 1) / chunks;
+
+        QList<Entry*> entries;
+        entries.reserve(count);
+        if (chunks == 1) {
+            entries = buildChunk(0, count);
+            if (progress) {
+                progress(count, count);
+            }
+            return entries;
+        }
+
+        QList<QFuture<QList<Entry*>>> futures;
+        for (int begin = 0; begin < count; begin += chunkSize) {
+            const int end = qMin(count, begin + chunkSize);
+            futures.append(QtConcurrent::run([buildChunk, begin, end] { return buildChunk(begin, end); }));
+        }
+
+        for (auto& future : futures) {
+            entries.append(future.result());
+            if (progress) {
+                progress(entries.size(), count);
+            }
+        }
+        return entries;
+    }
+
+    /**
+     * Attach built entries to their groups in one batch update of the database.
+     * Entries without a group are deleted.
+     */
+    void attachEntries(Database* db, const QList<Entry*>& entries, const QList<Group*>& groups)
+    {
+        Q_ASSERT(entries.size() == groups.size());
+
+        Database::BatchUpdate batch(db);
+        for (int i = 0; i < entries.size(); ++i) {
+            if (!entries[i]) {
+                continue;
+            }
+            if (i < groups.size() && groups[i]) {
+                entries[i]->setGroup(groups[i], false);
+            } else {
+                delete entries[i];
+            }
+        }
+    }
+} // namespace BulkImport
@@ -0,0 +1,42 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BULKIMPORT_H
+#define KEEPASSXC_BULKIMPORT_H
+
+#include <QList>
+
+#include <functional>
+
+class Database;
+class Entry;
+class Group;
+
+/*!
+ * Builds the entries of large imports in parallel chunks and attaches
+ * them to the database in one batch update.
+ */
+namespace BulkImport
+{
+    using BuildFunction = std::function<Entry*(int index)>;
+    using ProgressFunction = std::function<void(int done, int total)>;
+
+    QList<Entry*> buildEntries(int count, const BuildFunction& build, const ProgressFunction& progress = {});
+    void attachEntries(Database* db, const QList<Entry*>& entries, const QList<Group*>& groups);
+} // namespace BulkImport
+
+#endif // KEEPASSXC_BULKIMPORT_H
@@ -18,10 +18,17 @@
 
 #include "CsvExporter.h"
 
+#include <QBuffer>
 #include <QFile>
 
 #include "core/Group.h"
 
+namespace
+{
+    // Number of characters collected before they are written to the device
+    constexpr int BufferSize = 64 * 1024;
+} // namespace
+
 bool CsvExporter::exportDatabase(const QString& filename, const QSharedPointer<const Database>& db)
 {
     QFile file(filename);
@@ -32,24 +39,30 @@ bool CsvExporter::exportDatabase(const QString& filename, const QSharedPointer<c
     return exportDatabase(&file, db);
 }
 
+/**
+ * Write the database as CSV to a device.
+ *
+ * Rows are collected in a small buffer that is written out whenever it
+ * fills up, so the output starts immediately and memory use does not
+ * grow with the size of the database.
+ */
 bool CsvExporter::exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db)
 {
-    if (device->write(exportHeader().toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
-    }
+    m_pending.clear();
+    m_pending.reserve(BufferSize + BufferSize / 4);
+    m_pending.append(exportHeader());
 
-    if (device->write(exportGroup(db->rootGroup()).toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
-    }
-
-    return true;
+    bool ok = exportGroup(device, db->rootGroup()) && flush(device);
+    m_pending.clear();
+    return ok;
 }
 
 QString CsvExporter::exportDatabase(const QSharedPointer<const Database>& db)
 {
-    return exportHeader() + exportGroup(db->rootGroup());
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    exportDatabase(&buffer, db);
+    return QString::fromUtf8(buffer.data());
 }
 
 QString CsvExporter::errorString() const
@@ -73,9 +86,8 @@ QString CsvExporter::exportHeader()
     return header + QString("\n");
 }
 
-QString CsvExporter::exportGroup(const Group* group, QString groupPath)
+bool CsvExporter::exportGroup(QIODevice* device, const Group* group, QString groupPath)
 {
-    QString response;
     if (!groupPath.isEmpty()) {
         groupPath.append("/");
     }
@@ -97,15 +109,39 @@ QString CsvExporter::exportGroup(const Group* group, QString groupPath)
         addColumn(line, entry->timeInfo().creationTime().toString(Qt::ISODate));
 
         line.append("\n");
-        response.append(line);
+        m_pending.append(line);
+
+        if (!flush(device, BufferSize)) {
+            return false;
+        }
     }
 
     const QList<Group*>& children = group->children();
     for (const Group* child : children) {
-        response.append(exportGroup(child, groupPath));
+        if (!exportGroup(device, child, groupPath)) {
+            return false;
+        }
     }
 
-    return response;
+    return true;
+}
+
+/**
+ * Write the pending rows to the device once they reach the given number
+ * of characters. The pending buffer keeps its capacity for the next rows.
+ */
+bool CsvExporter::flush(QIODevice* device, int threshold)
+{
+    if (m_pending.isEmpty() || m_pending.size() < threshold) {
+        return true;
+    }
+
+    if (device->write(m_pending.toUtf8()) == -1) {
+        m_error = device->errorString();
+        return false;
+    }
+    m_pending.resize(0);
+    return true;
 }
 
 void CsvExporter::addColumn(QString& str, const QString& column)
@@ -115,6 +151,10 @@ void CsvExporter::addColumn(QString& str, const QString& column)
     }
 
     str.append("\"");
-    str.append(QString(column).replace("\"", "\"\""));
+    if (column.contains('"')) {
+        str.append(QString(column).replace("\"", "\"\""));
+    } else {
+        str.append(column);
+    }
     str.append("\"");
 }
@@ -35,11 +35,14 @@ public:
     QString errorString() const;
 
 private:
-    QString exportGroup(const Group* group, QString groupPath = QString());
+    bool exportGroup(QIODevice* device, const Group* group, QString groupPath = QString());
+    bool flush(QIODevice* device, int threshold = 0);
     QString exportHeader();
     void addColumn(QString& str, const QString& column);
 
     QString m_error;
+    // Rows not yet written to the device, reused for the whole export
+    QString m_pending;
 };
 
 #endif // KEEPASSX_CSVEXPORTER_H
@@ -19,28 +19,34 @@
 #include "CsvParser.h"
 
 #include <QFile>
+#include <QHash>
 #include <QTextCodec>
 
-#include "core/Tools.h"
+#include "core/Global.h"
+
+namespace
+{
+    // Size of the chunks read from the device
+    constexpr qint64 ChunkSize = 64 * 1024;
+} // namespace
 
 CsvParser::CsvParser()
-    : m_comment('#')
+    : m_fileSize(0)
+    , m_device(nullptr)
+    , m_codec(QTextCodec::codecForName("UTF-8"))
+    , m_comment('#')
     , m_isBackslashSyntax(false)
     , m_isFileLoaded(false)
+    , m_maxTableRows(-1)
     , m_qualifier('"')
     , m_separator(',')
+    , m_stopWhenTableFull(false)
+    , m_parseCache(16)
 {
     reset();
-    m_csv.setBuffer(&m_array);
-    m_ts.setDevice(&m_csv);
-    m_csv.open(QIODevice::ReadOnly);
-    m_ts.setCodec("UTF-8");
 }
 
-CsvParser::~CsvParser()
-{
-    m_csv.close();
-}
+CsvParser::~CsvParser() = default;
 
 bool CsvParser::isFileLoaded()
 {
@@ -49,8 +55,23 @@ bool CsvParser::isFileLoaded()
 
 bool CsvParser::reparse()
 {
+    // Full tables are not cached, they can be as large as the file
+    const bool isCacheable = m_maxTableRows >= 0;
+    const QString key = optionsKey();
+    if (isCacheable) {
+        const ParseResult* cached = m_parseCache.object(key);
+        if (cached) {
+            restore(*cached);
+            return m_isGood;
+        }
+    }
+
     reset();
-    return parseFile();
+    const bool good = readFile();
+    if (isCacheable && m_isFileLoaded) {
+        m_parseCache.insert(key, new ParseResult(result()));
+    }
+    return good;
 }
 
 bool CsvParser::parse(QFile* device)
@@ -60,33 +81,225 @@ bool CsvParser::parse(QFile* device)
         appendStatusMsg(QObject::tr("NULL device"), true);
         return false;
     }
-    if (!readFile(device)) {
+
+    // Closing the device also flushes streams that are still writing to it
+    if (device->isOpen()) {
+        device->close();
+    }
+    m_fileName = device->fileName();
+    return reparse();
+}
+
+/**
+ * Read all rows of the file again and pass them to handler instead of the
+ * table, so they are not held in memory at once. The table, e.g. a preview
+ * of the first rows, is left unchanged.
+ *
+ * @param handler receives each row padded to the column count of the last parse
+ * @return true if the file was parsed without critical errors
+ */
+bool CsvParser::forEachRow(const RowHandler& handler)
+{
+    const ParseResult preview = result();
+    const int columns = m_maxCols;
+
+    reset();
+    m_rowHandler = [&handler, columns](CsvRow row) {
+        while (row.size() < columns) {
+            row.append(QString(""));
+        }
+        return handler(row);
+    };
+    const bool good = readFile();
+    m_rowHandler = {};
+
+    restore(preview);
+    return good;
+}
+
+/**
+ * Guess the dialect from the first lines of the file. The separator is the
+ * candidate that occurs the same number of times on most lines, the qualifier
+ * the candidate that encloses most fields.
+ *
+ * @param separators candidate field separators, in order of preference
+ * @param qualifiers candidate text qualifiers, in order of preference
+ * @return true if a separator was found, the qualifier is only set if one was found
+ */
+bool CsvParser::detectDialect(const QString& separators,
+                              const QString& qualifiers,
+                              QChar& separator,
+                              QChar& qualifier) const
+{
+    QFile file(m_fileName);
+    if (m_fileName.isEmpty() || !file.open(QIODevice::ReadOnly)) {
         return false;
     }
-    return parseFile();
+
+    const QByteArray bytes = file.read(ChunkSize);
+    QScopedPointer<QTextDecoder> decoder(QTextCodec::codecForUtfText(bytes, m_codec)->makeDecoder());
+    QString sample = decoder->toUnicode(bytes);
+    sample.replace("\r\n", "\n");
+    sample.replace('\r', '\n');
+
+    QStringList lines;
+    const auto sampleLines = sample.split('\n', QString::SkipEmptyParts);
+    // The last line may be cut off
+    const int lineCount = file.atEnd() ? sampleLines.size() : sampleLines.size() - 1;
+    for (int i = 0; i < lineCount && lines.size() < 50; ++i) {
+        if (!sampleLines.at(i).trimmed().startsWith(m_comment)) {
+            lines << sampleLines.at(i);
+        }
+    }
+    if (lines.isEmpty()) {
+        return false;
+    }
+
+    int bestScore = 0;
+    for (const QChar candidate : separators) {
+        QHash<int, int> linesPerCount;
+        for (const QString& line : asConst(lines)) {
+            const int count = line.count(candidate);
+            if (count > 0) {
+                ++linesPerCount[count];
+            }
+        }
+        int score = 0;
+        for (const int matchingLines : asConst(linesPerCount)) {
+            score = qMax(score, matchingLines);
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            separator = candidate;
+        }
+    }
+    if (bestScore == 0) {
+        return false;
+    }
+
+    bestScore = 0;
+    for (const QChar candidate : qualifiers) {
+        int score = 0;
+        for (const QString& line : asConst(lines)) {
+            const auto fields = line.split(separator);
+            for (const QString& field : fields) {
+                if (field.size() > 1 && field.startsWith(candidate) && field.endsWith(candidate)) {
+                    ++score;
+                }
+            }
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            qualifier = candidate;
+        }
+    }
+    return true;
 }
 
-bool CsvParser::readFile(QFile* device)
+QString CsvParser::optionsKey() const
 {
-    if (device->isOpen()) {
-        device->close();
+    return QString("%1|%2|%3|%4|%5|%6|%7")
+        .arg(QString::fromLatin1(m_codec->name()),
+             m_separator,
+             m_qualifier,
+             m_comment,
+             QString::number(m_isBackslashSyntax),
+             QString::number(m_maxTableRows),
+             QString::number(m_stopWhenTableFull));
+}
+
+CsvParser::ParseResult CsvParser::result() const
+{
+    return {m_table, m_rowCount, m_maxCols, m_isComplete, m_isGood, m_statusMsg};
+}
+
+void CsvParser::restore(const ParseResult& result)
+{
+    m_table = result.table;
+    m_rowCount = result.rowCount;
+    m_maxCols = result.maxCols;
+    m_isComplete = result.isComplete;
+    m_isGood = result.isGood;
+    m_statusMsg = result.statusMsg;
+}
+
+bool CsvParser::readFile()
+{
+    if (m_fileName.isEmpty()) {
+        // Nothing loaded, same as parsing an empty file
+        return m_isGood;
     }
 
-    device->open(QIODevice::ReadOnly);
-    if (!Tools::readAllFromDevice(device, m_array)) {
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
         appendStatusMsg(QObject::tr("error reading from device"), true);
         m_isFileLoaded = false;
-    } else {
-        device->close();
+        return false;
+    }
+
+    m_isFileLoaded = true;
+    m_fileSize = file.size();
+    if (m_fileSize == 0) {
+        appendStatusMsg(QObject::tr("file empty").append("\n"));
+    }
+
+    m_device = &file;
+    const bool good = parseFile();
+    m_isComplete = !m_isStopped;
+    m_device = nullptr;
+    m_decoder.reset();
+    m_buffer.clear();
+    m_buffer.squeeze();
+    return good;
+}
+
+/**
+ * Make sure there is unread text in the buffer, decoding the next chunk of
+ * the device if needed. Text before the last read character and the mark is
+ * dropped, so the buffer stays bounded by the chunk size and the longest field.
+ *
+ * @return false at the end of the device
+ */
+bool CsvParser::fillBuffer()
+{
+    while (m_pos >= m_buffer.size()) {
+        const QByteArray bytes = m_device ? m_device->read(ChunkSize) : QByteArray();
+        if (bytes.isEmpty() && !m_pendingCR) {
+            return false;
+        }
+
+        int keep = m_mark >= 0 ? qMin(m_mark, m_lastPos) : m_lastPos;
+        keep = qBound(0, keep, m_buffer.size());
+        m_buffer.remove(0, keep);
+        m_pos -= keep;
+        m_lastPos = m_lastPos >= 0 ? m_lastPos - keep : -1;
+        if (m_mark >= 0) {
+            m_mark -= keep;
+        }
 
-        m_array.replace("\r\n", "\n");
-        m_array.replace("\r", "\n");
-        if (m_array.isEmpty()) {
-            appendStatusMsg(QObject::tr("file empty").append("\n"));
+        if (!m_decoder) {
+            // Byte order marks override the selected codec, like QTextStream does
+            m_decoder.reset(QTextCodec::codecForUtfText(bytes, m_codec)->makeDecoder());
         }
-        m_isFileLoaded = true;
+        appendText(m_decoder->toUnicode(bytes), bytes.isEmpty());
     }
-    return m_isFileLoaded;
+    return true;
+}
+
+void CsvParser::appendText(QString text, bool atEnd)
+{
+    // Line endings are normalized to \n, a \r at the end of a chunk may be followed by \n
+    if (m_pendingCR) {
+        text.prepend('\r');
+        m_pendingCR = false;
+    }
+    if (!atEnd && text.endsWith('\r')) {
+        text.chop(1);
+        m_pendingCR = true;
+    }
+    text.replace("\r\n", "\n");
+    text.replace('\r', '\n');
+    m_buffer.append(text);
 }
 
 void CsvParser::reset()
@@ -96,10 +309,17 @@ void CsvParser::reset()
     m_currRow = 1;
     m_isEof = false;
     m_isGood = true;
+    m_isStopped = false;
+    m_isComplete = true;
     m_lastPos = -1;
     m_maxCols = 0;
+    m_rowCount = 0;
     m_statusMsg.clear();
-    m_ts.seek(0);
+    m_buffer.clear();
+    m_pos = 0;
+    m_mark = -1;
+    m_pendingCR = false;
+    m_decoder.reset();
     m_table.clear();
     // the following can be overridden by the user
     // m_comment = '#';
@@ -113,13 +333,15 @@ void CsvParser::clear()
 {
     reset();
     m_isFileLoaded = false;
-    m_array.clear();
+    m_fileName.clear();
+    m_fileSize = 0;
+    m_parseCache.clear();
 }
 
 bool CsvParser::parseFile()
 {
     parseRecord();
-    while (!m_isEof) {
+    while (!m_isEof && !m_isStopped) {
         if (!skipEndline()) {
             appendStatusMsg(QObject::tr("malformed string"), true);
         }
@@ -150,10 +372,18 @@ void CsvParser::parseRecord()
         row.clear();
         return;
     }
-    m_table.push_back(row);
+    ++m_rowCount;
     if (m_maxCols < row.size()) {
         m_maxCols = row.size();
     }
+    if (m_rowHandler) {
+        m_isStopped = !m_rowHandler(row);
+    } else if (m_maxTableRows < 0 || m_table.size() < m_maxTableRows) {
+        m_table.push_back(row);
+    } else {
+        // The table is full, the remaining rows are only counted
+        m_isStopped = m_stopWhenTableFull;
+    }
     m_currCol++;
 }
 
@@ -173,14 +403,28 @@ void CsvParser::parseField(CsvRow& row)
 
 void CsvParser::parseSimple(QString& s)
 {
-    QChar c;
-    getChar(c);
-    while (c != '\n' && c != m_separator && !m_isEof) {
-        s.append(c);
-        getChar(c);
-    }
-    if (!m_isEof) {
-        ungetChar();
+    // Append whole runs of plain characters instead of one character at a time
+    while (true) {
+        const QChar* data = m_buffer.constData();
+        const int size = m_buffer.size();
+        int end = m_pos;
+        while (end < size && data[end] != '\n' && data[end] != m_separator) {
+            ++end;
+        }
+        s.append(data + m_pos, end - m_pos);
+        m_pos = end;
+
+        if (end < size) {
+            // Leave the separator or end of line to the caller
+            m_lastPos = end;
+            m_isEof = false;
+            return;
+        }
+        m_lastPos = m_pos - 1;
+        if (!fillBuffer()) {
+            m_isEof = true;
+            return;
+        }
     }
 }
 
@@ -207,10 +451,29 @@ void CsvParser::parseEscaped(QString& s)
 
 void CsvParser::parseEscapedText(QString& s)
 {
-    getChar(m_ch);
-    while (!isQualifier(m_ch) && !m_isEof) {
-        s.append(m_ch);
-        getChar(m_ch);
+    // Append whole runs up to the next qualifier, which is read into m_ch
+    while (true) {
+        const QChar* data = m_buffer.constData();
+        const int size = m_buffer.size();
+        int end = m_pos;
+        while (end < size && !isQualifier(data[end])) {
+            ++end;
+        }
+        if (end > m_pos) {
+            m_ch = data[end - 1];
+            s.append(data + m_pos, end - m_pos);
+        }
+        m_pos = end;
+
+        if (end < size) {
+            getChar(m_ch);
+            return;
+        }
+        m_lastPos = m_pos - 1;
+        if (!fillBuffer()) {
+            m_isEof = true;
+            return;
+        }
     }
 }
 
@@ -266,8 +529,22 @@ void CsvParser::fillColumns()
 
 void CsvParser::skipLine()
 {
-    m_ts.readLine();
-    m_ts.seek(m_ts.pos() - 1);
+    // Stop at the end of line, it is consumed by skipEndline()
+    while (true) {
+        const int end = m_buffer.indexOf('\n', m_pos);
+        if (end >= 0) {
+            m_pos = end;
+            m_lastPos = end;
+            m_isEof = false;
+            return;
+        }
+        m_pos = m_buffer.size();
+        m_lastPos = m_pos - 1;
+        if (!fillBuffer()) {
+            m_isEof = true;
+            return;
+        }
+    }
 }
 
 bool CsvParser::skipEndline()
@@ -278,19 +555,21 @@ bool CsvParser::skipEndline()
 
 void CsvParser::getChar(QChar& c)
 {
-    m_isEof = m_ts.atEnd();
+    m_isEof = !fillBuffer();
     if (!m_isEof) {
-        m_lastPos = m_ts.pos();
-        m_ts >> c;
+        m_lastPos = m_pos;
+        c = m_buffer.at(m_pos++);
     }
 }
 
 void CsvParser::ungetChar()
 {
-    if (!m_ts.seek(m_lastPos)) {
+    if (m_lastPos < 0) {
         qWarning("CSV Parser: unget lower bound exceeded");
         m_isGood = false;
+        return;
     }
+    m_pos = m_lastPos;
 }
 
 void CsvParser::peek(QChar& c)
@@ -313,7 +592,8 @@ bool CsvParser::isComment()
 {
     bool result = false;
     QChar c2;
-    qint64 pos = m_ts.pos();
+    // Keep the leading whitespace in the buffer to go back to it
+    m_mark = m_pos;
 
     do {
         getChar(c2);
@@ -322,7 +602,8 @@ bool CsvParser::isComment()
     if (c2 == m_comment) {
         result = true;
     }
-    m_ts.seek(pos);
+    m_pos = m_mark;
+    m_mark = -1;
     return result;
 }
 
@@ -348,7 +629,10 @@ void CsvParser::setComment(const QChar& c)
 
 void CsvParser::setCodec(const QString& s)
 {
-    m_ts.setCodec(QTextCodec::codecForName(s.toLocal8Bit()));
+    m_codec = QTextCodec::codecForName(s.toLocal8Bit());
+    if (!m_codec) {
+        m_codec = QTextCodec::codecForName("UTF-8");
+    }
 }
 
 void CsvParser::setFieldSeparator(const QChar& c)
@@ -361,9 +645,24 @@ void CsvParser::setTextQualifier(const QChar& c)
     m_qualifier = c.unicode();
 }
 
-int CsvParser::getFileSize() const
+void CsvParser::setMaxTableRows(int rows)
 {
-    return m_csv.size();
+    m_maxTableRows = rows;
+}
+
+void CsvParser::setStopWhenTableFull(bool stop)
+{
+    m_stopWhenTableFull = stop;
+}
+
+bool CsvParser::isComplete() const
+{
+    return m_isComplete;
+}
+
+qint64 CsvParser::getFileSize() const
+{
+    return m_fileSize;
 }
 
 CsvTable CsvParser::getCsvTable() const
@@ -378,15 +677,12 @@ QString CsvParser::getStatus() const
 
 int CsvParser::getCsvCols() const
 {
-    if (!m_table.isEmpty() && !m_table.at(0).isEmpty()) {
-        return m_table.at(0).size();
-    }
-    return 0;
+    return m_maxCols;
 }
 
 int CsvParser::getCsvRows() const
 {
-    return m_table.size();
+    return m_rowCount;
 }
 
 void CsvParser::appendStatusMsg(const QString& s, bool isCritical)
@@ -19,31 +19,58 @@
 #ifndef KEEPASSX_CSVPARSER_H
 #define KEEPASSX_CSVPARSER_H
 
-#include <QBuffer>
-#include <QTextStream>
+#include <QCache>
+#include <QScopedPointer>
+#include <QStringList>
+
+#include <functional>
 
 class QFile;
+class QIODevice;
+class QTextCodec;
+class QTextDecoder;
 
 typedef QStringList CsvRow;
 typedef QList<CsvRow> CsvTable;
 
+/**
+ * CSV parser that streams the file through a bounded window of decoded text.
+ * The rows are kept in a table, optionally limited to the first rows for a
+ * preview, or passed one by one to a handler without being kept.
+ *
+ * Results of a limited table are cached per set of options, so switching
+ * options back and forth does not read the file again.
+ */
 class CsvParser
 {
 
 public:
+    // Receives each row padded to the column count, returning false stops reading
+    using RowHandler = std::function<bool(const CsvRow& row)>;
+
     CsvParser();
     ~CsvParser();
     // read data from device and parse it
     bool parse(QFile* device);
     bool isFileLoaded();
-    // reparse the same buffer (device is not opened again)
+    // reparse the same file with the current settings
     bool reparse();
+    // guess the field separator and text qualifier from the start of the file
+    bool detectDialect(const QString& separators, const QString& qualifiers, QChar& separator, QChar& qualifier) const;
+    // read all rows of the file again without keeping them in the table
+    bool forEachRow(const RowHandler& handler);
     void setCodec(const QString& s);
     void setComment(const QChar& c);
     void setFieldSeparator(const QChar& c);
     void setTextQualifier(const QChar& c);
     void setBackslashSyntax(bool set);
-    int getFileSize() const;
+    // keep at most this many rows in the table, the others are only counted
+    void setMaxTableRows(int rows);
+    // stop reading once the table is full, e.g. for a preview
+    void setStopWhenTableFull(bool stop);
+    // false if reading stopped early, the row count is then a lower bound
+    bool isComplete() const;
+    qint64 getFileSize() const;
     int getCsvRows() const;
     int getCsvCols() const;
     QString getStatus() const;
@@ -53,8 +80,31 @@ protected:
     CsvTable m_table;
 
 private:
-    QByteArray m_array;
-    QBuffer m_csv;
+    struct ParseResult
+    {
+        CsvTable table;
+        int rowCount;
+        int maxCols;
+        bool isComplete;
+        bool isGood;
+        QString statusMsg;
+    };
+
+    QString m_fileName;
+    qint64 m_fileSize;
+    QIODevice* m_device;
+    QTextCodec* m_codec;
+    QScopedPointer<QTextDecoder> m_decoder;
+    // decoded text of the device, the consumed part is dropped on refill
+    QString m_buffer;
+    int m_pos;
+    int m_mark;
+    bool m_pendingCR;
+    RowHandler m_rowHandler;
+    bool m_isStopped;
+    bool m_isComplete;
+    bool m_stopWhenTableFull;
+    QCache<QString, ParseResult> m_parseCache;
     QChar m_ch;
     QChar m_comment;
     unsigned int m_currCol;
@@ -63,13 +113,19 @@ private:
     bool m_isEof;
     bool m_isFileLoaded;
     bool m_isGood;
-    qint64 m_lastPos;
+    int m_lastPos;
     int m_maxCols;
+    int m_maxTableRows;
+    int m_rowCount;
     QChar m_qualifier;
     QChar m_separator;
     QString m_statusMsg;
-    QTextStream m_ts;
 
+    QString optionsKey() const;
+    ParseResult result() const;
+    void restore(const ParseResult& result);
+    bool fillBuffer();
+    void appendText(QString text, bool atEnd);
     void getChar(QChar& c);
     void ungetChar();
     void peek(QChar& c);
@@ -85,7 +141,7 @@ private:
     void parseQuoted(QString& s);
     void parseEscaped(QString& s);
     void parseEscapedText(QString& s);
-    bool readFile(QFile* device);
+    bool readFile();
     void reset();
     void clear();
     bool skipEndline();
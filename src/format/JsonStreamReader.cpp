@@ -0,0 +1,296 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "JsonStreamReader.h"
+
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace
+{
+    const int CHUNK_SIZE = 64 * 1024;
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+} // namespace
+
+JsonStreamReader::JsonStreamReader(QIODevice* device)
+    : m_device(device)
+{
+}
+
+/**
+ * Enter the object at the current position. Its members are then read
+ * with nextKey() followed by readValue() or skipValue().
+ */
+bool JsonStreamReader::enterObject()
+{
+    return enter('{');
+}
+
+/**
+ * Advance to the next member of the current object.
+ *
+ * @param key set to the name of the member
+ * @return false at the end of the object or on error
+ */
+bool JsonStreamReader::nextKey(QString& key)
+{
+    if (!next('}')) {
+        return false;
+    }
+
+    const qint64 offset = m_bufferOffset + m_pos;
+    const auto value = readValue();
+    if (!value.isString()) {
+        return hasError() ? false : raiseError(tr("Expected a member name"), offset);
+    }
+    key = value.toString();
+
+    char c;
+    if (!peek(c) || c != ':') {
+        return raiseError(tr("Expected ':' after a member name"), m_bufferOffset + m_pos);
+    }
+    ++m_pos;
+    return true;
+}
+
+/**
+ * Enter the array at the current position. Its elements are then read
+ * with nextElement() followed by readValue() or skipValue().
+ */
+bool JsonStreamReader::enterArray()
+{
+    return enter('[');
+}
+
+/**
+ * Advance to the next element of the current array.
+ *
+ * @return false at the end of the array or on error
+ */
+bool JsonStreamReader::nextElement()
+{
+    return next(']');
+}
+
+/**
+ * Read the complete value at the current position.
+ */
+QJsonValue JsonStreamReader::readValue()
+{
+    char c;
+    if (!peek(c)) {
+        raiseError(tr("Unexpected end of data"), m_bufferOffset + m_pos);
+        return {};
+    }
+
+    // Wrap the value in an array, QJsonDocument only parses objects and arrays
+    const qint64 offset = m_bufferOffset + m_pos;
+    QByteArray raw("[");
+    if (!scanValue(&raw)) {
+        return {};
+    }
+    raw.append(']');
+
+    QJsonParseError error;
+    const auto document = QJsonDocument::fromJson(raw, &error);
+    if (error.error != QJsonParseError::NoError) {
+        raiseError(error.errorString(), offset + qMax(0, error.offset - 1));
+        return {};
+    }
+    return document.array().first();
+}
+
+/**
+ * Skip the value at the current position without parsing it.
+ */
+bool JsonStreamReader::skipValue()
+{
+    return scanValue(nullptr);
+}
+
+bool JsonStreamReader::hasError() const
+{
+    return !m_error.isEmpty();
+}
+
+QString JsonStreamReader::errorString() const
+{
+    return m_error;
+}
+
+/**
+ * @return byte offset of the error in the input, or -1 without an error
+ */
+qint64 JsonStreamReader::errorOffset() const
+{
+    return m_errorOffset;
+}
+
+/**
+ * Read the next chunk of the input once the buffer is used up.
+ */
+bool JsonStreamReader::fill()
+{
+    Q_ASSERT(m_pos >= m_buffer.size());
+
+    m_bufferOffset += m_buffer.size();
+    m_pos = 0;
+    m_buffer.resize(CHUNK_SIZE);
+    const qint64 bytes = m_device->read(m_buffer.data(), CHUNK_SIZE);
+    m_buffer.resize(static_cast<int>(qMax<qint64>(0, bytes)));
+    return bytes > 0;
+}
+
+/**
+ * Skip whitespace and return the next character without consuming it.
+ */
+bool JsonStreamReader::peek(char& c)
+{
+    while (true) {
+        while (m_pos < m_buffer.size() && isSpace(m_buffer.at(m_pos))) {
+            ++m_pos;
+        }
+        if (m_pos < m_buffer.size()) {
+            c = m_buffer.at(m_pos);
+            return true;
+        }
+        if (!fill()) {
+            return false;
+        }
+    }
+}
+
+bool JsonStreamReader::enter(char open)
+{
+    if (hasError()) {
+        return false;
+    }
+
+    char c;
+    if (!peek(c) || c != open) {
+        return raiseError(open == '{' ? tr("Expected an object") : tr("Expected an array"), m_bufferOffset + m_pos);
+    }
+    ++m_pos;
+    m_first.append(true);
+    return true;
+}
+
+bool JsonStreamReader::next(char close)
+{
+    if (hasError() || m_first.isEmpty()) {
+        return false;
+    }
+
+    char c;
+    if (!peek(c)) {
+        return raiseError(tr("Unexpected end of data"), m_bufferOffset + m_pos);
+    }
+    if (c == close) {
+        ++m_pos;
+        m_first.removeLast();
+        return false;
+    }
+    if (!m_first.last()) {
+        if (c != ',') {
+            return raiseError(tr("Expected ',' or '%1'").arg(QLatin1Char(close)), m_bufferOffset + m_pos);
+        }
+        ++m_pos;
+    }
+    m_first.last() = false;
+    return true;
+}
+
+/**
+ * Consume the value at the current position, copying its raw bytes to out
+ * if given. Nested values are only matched by their brackets here; they
+ * are validated when the copied bytes are parsed.
+ */
+bool JsonStreamReader::scanValue(QByteArray* out)
+{
+    if (hasError()) {
+        return false;
+    }
+
+    char c;
+    if (!peek(c)) {
+        return raiseError(tr("Unexpected end of data"), m_bufferOffset + m_pos);
+    }
+
+    const bool isScalar = c != '{' && c != '[' && c != '"';
+    int depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    bool done = false;
+    int start = m_pos;
+
+    while (!done) {
+        if (m_pos >= m_buffer.size()) {
+            if (out) {
+                out->append(m_buffer.constData() + start, m_pos - start);
+            }
+            if (!fill()) {
+                if (isScalar) {
+                    return true;
+                }
+                return raiseError(tr("Unexpected end of data"), m_bufferOffset + m_pos);
+            }
+            start = 0;
+        }
+
+        const char ch = m_buffer.at(m_pos);
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (ch == '\\') {
+                escaped = true;
+            } else if (ch == '"') {
+                inString = false;
+                done = depth == 0;
+            }
+        } else if (isScalar) {
+            if (ch == ',' || ch == '}' || ch == ']' || isSpace(ch)) {
+                break;
+            }
+        } else if (ch == '"') {
+            inString = true;
+        } else if (ch == '{' || ch == '[') {
+            ++depth;
+        } else if (ch == '}' || ch == ']') {
+            done = --depth == 0;
+        }
+        ++m_pos;
+    }
+
+    if (out) {
+        out->append(m_buffer.constData() + start, m_pos - start);
+    }
+    return true;
+}
+
+bool JsonStreamReader::raiseError(const QString& message, qint64 offset)
+{
+    if (!hasError()) {
+        m_error = message;
+        m_errorOffset = offset;
+    }
+    return false;
+}
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_JSONSTREAMREADER_H
+#define KEEPASSXC_JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QJsonValue>
+#include <QVector>
+
+class QIODevice;
+
+/*!
+ * Reads a JSON document from a device one value at a time.
+ *
+ * The caller walks the outer objects and arrays with enterObject(),
+ * nextKey(), enterArray() and nextElement(), and reads the values it is
+ * interested in with readValue(). Only the value being read is kept in
+ * memory, so large exports can be converted item by item.
+ */
+class JsonStreamReader
+{
+    Q_DECLARE_TR_FUNCTIONS(JsonStreamReader)
+
+public:
+    explicit JsonStreamReader(QIODevice* device);
+
+    bool enterObject();
+    bool nextKey(QString& key);
+    bool enterArray();
+    bool nextElement();
+
+    QJsonValue readValue();
+    bool skipValue();
+
+    bool hasError() const;
+    QString errorString() const;
+    qint64 errorOffset() const;
+
+private:
+    bool fill();
+    bool peek(char& c);
+    bool enter(char open);
+    bool next(char close);
+    bool scanValue(QByteArray* out);
+    bool raiseError(const QString& message, qint64 offset);
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    int m_pos = 0;
+    // Offset of m_buffer in the input
+    qint64 m_bufferOffset = 0;
+    // Whether the next key or element of each open container is its first one
+    QVector<bool> m_first;
+
+    QString m_error;
+    qint64 m_errorOffset = -1;
+};
+
+#endif // KEEPASSXC_JSONSTREAMREADER_H
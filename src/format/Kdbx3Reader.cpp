@@ -18,7 +18,6 @@
 
 #include "Kdbx3Reader.h"
 
-#include "core/AsyncTask.h"
 #include "core/Endian.h"
 #include "core/Group.h"
 #include "crypto/CryptoHash.h"
@@ -47,8 +46,7 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
         return false;
     }
 
-    bool ok = AsyncTask::runAndWaitForFuture([&] { return db->setKey(key, false); });
-    if (!ok) {
+    if (!transformKey(device, key, db)) {
         raiseError(tr("Unable to calculate database key"));
         return false;
     }
@@ -57,6 +55,7 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
         raiseError(tr("Unable to issue challenge-response: %1").arg(db->keyError()));
         return false;
     }
+    m_timings.lap("kdf");
 
     CryptoHash hash(CryptoHash::Sha256);
     hash.addData(m_masterSeed);
@@ -84,6 +83,7 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
     }
 
     HashedBlockStream hashedStream(&cipherStream);
+    hashedStream.setParallelBlocks(HashedBlockStream::suggestedParallelBlocks());
     if (!hashedStream.open(QIODevice::ReadOnly)) {
         raiseError(hashedStream.errorString());
         return false;
@@ -114,6 +114,7 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
 
     KdbxXmlReader xmlReader(KeePass2::FILE_VERSION_3_1);
     xmlReader.readDatabase(xmlDevice, db, &randomStream);
+    m_timings.lap("xml");
 
     if (xmlReader.hasError()) {
         raiseError(xmlReader.errorString());
@@ -32,6 +32,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
 {
     m_error = false;
     m_errorStr.clear();
+    m_timings.start();
 
     auto mode = SymmetricCipher::cipherUuidToMode(db->cipher());
     int ivSize = SymmetricCipher::defaultIvSize(mode);
@@ -55,6 +56,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
         raiseError(tr("Unable to calculate database key"));
         return false;
     }
+    m_timings.lap("kdf");
 
     // generate transformed database key
     CryptoHash hash(CryptoHash::Sha256);
@@ -95,6 +97,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
 
     // write header data
     CHECK_RETURN_FALSE(writeData(device, header.data()));
+    m_timings.lap("header");
 
     // hash header
     const QByteArray headerHash = CryptoHash::hash(header.data(), CryptoHash::Sha256);
@@ -109,6 +112,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
     CHECK_RETURN_FALSE(writeData(&cipherStream, startBytes));
 
     HashedBlockStream hashedStream(&cipherStream);
+    hashedStream.setParallelBlocks(HashedBlockStream::suggestedParallelBlocks());
     if (!hashedStream.open(QIODevice::WriteOnly)) {
         raiseError(hashedStream.errorString());
         return false;
@@ -120,7 +124,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
     if (db->compressionAlgorithm() == Database::CompressionNone) {
         outputDevice = &hashedStream;
     } else {
-        ioCompressor.reset(new QtIOCompressor(&hashedStream));
+        ioCompressor.reset(new QtIOCompressor(&hashedStream, db->compressionLevel()));
         ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
         if (!ioCompressor->open(QIODevice::WriteOnly)) {
             raiseError(ioCompressor->errorString());
@@ -139,6 +143,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
 
     KdbxXmlWriter xmlWriter(db->formatVersion());
     xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
+    m_timings.lap("xml");
 
     // Explicitly close/reset streams so they are flushed and we can detect
     // errors. QIODevice::close() resets errorString() etc.
@@ -153,6 +158,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
         raiseError(cipherStream.errorString());
         return false;
     }
+    m_timings.lap("flush");
 
     if (xmlWriter.hasError()) {
         raiseError(xmlWriter.errorString());
@@ -20,7 +20,6 @@
 #include <QBuffer>
 #include <QJsonObject>
 
-#include "core/AsyncTask.h"
 #include "core/Endian.h"
 #include "core/Group.h"
 #include "crypto/CryptoHash.h"
@@ -29,6 +28,7 @@
 #include "streams/HmacBlockStream.h"
 #include "streams/StoreDataStream.h"
 #include "streams/SymmetricCipherStream.h"
+#include "streams/ThreadedReadStream.h"
 #include "streams/qtiocompressor.h"
 
 bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
@@ -50,11 +50,11 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
         return false;
     }
 
-    bool ok = AsyncTask::runAndWaitForFuture([&] { return db->setKey(key, false, false); });
-    if (!ok) {
+    if (!transformKey(device, key, db)) {
         raiseError(tr("Unable to calculate database key: %1").arg(db->keyError()));
         return false;
     }
+    m_timings.lap("kdf");
 
     CryptoHash hash(CryptoHash::Sha256);
     hash.addData(m_masterSeed);
@@ -80,6 +80,7 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
         return false;
     }
     HmacBlockStream hmacStream(device, hmacKey);
+    hmacStream.setParallelBlocks(HmacBlockStream::suggestedParallelBlocks());
     if (!hmacStream.open(QIODevice::ReadOnly)) {
         raiseError(hmacStream.errorString());
         return false;
@@ -101,23 +102,38 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     }
     // clang-format on
 
+    // Decrypting (including HMAC verification) and decompressing run on worker
+    // threads, each feeding a bounded queue, so they overlap with XML parsing.
+    ThreadedReadStream decryptStage(&cipherStream);
+    if (!decryptStage.open(QIODevice::ReadOnly)) {
+        raiseError(decryptStage.errorString());
+        return false;
+    }
+
     QIODevice* xmlDevice = nullptr;
     QScopedPointer<QtIOCompressor> ioCompressor;
+    QScopedPointer<ThreadedReadStream> inflateStage;
 
     if (db->compressionAlgorithm() == Database::CompressionNone) {
-        xmlDevice = &cipherStream;
+        xmlDevice = &decryptStage;
     } else {
-        ioCompressor.reset(new QtIOCompressor(&cipherStream));
+        ioCompressor.reset(new QtIOCompressor(&decryptStage));
         ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
         if (!ioCompressor->open(QIODevice::ReadOnly)) {
             raiseError(ioCompressor->errorString());
             return false;
         }
-        xmlDevice = ioCompressor.data();
+        inflateStage.reset(new ThreadedReadStream(ioCompressor.data()));
+        if (!inflateStage->open(QIODevice::ReadOnly)) {
+            raiseError(inflateStage->errorString());
+            return false;
+        }
+        xmlDevice = inflateStage.data();
     }
 
     while (readInnerHeaderField(xmlDevice) && !hasError()) {
     }
+    m_timings.lap("attachments");
 
     if (hasError()) {
         return false;
@@ -144,7 +160,10 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     Q_ASSERT(xmlDevice);
 
     KdbxXmlReader xmlReader(KeePass2::FILE_VERSION_4, binaryPool());
+    // Decryption, HMAC verification and decompression overlap with parsing,
+    // so the time waiting on them is part of this stage
     xmlReader.readDatabase(xmlDevice, db, &randomStream);
+    m_timings.lap("xml");
 
     if (xmlReader.hasError()) {
         raiseError(xmlReader.errorString());
@@ -265,6 +284,16 @@ bool Kdbx4Reader::readInnerHeaderField(QIODevice* device)
         return false;
     }
 
+    // Binaries start with a flags byte, read it separately so the
+    // attachment data does not have to be copied out of the field
+    if (fieldID == KeePass2::InnerHeaderFieldID::Binary) {
+        if (fieldLen < 1 || device->read(1).size() != 1) {
+            raiseError(tr("Invalid inner header binary size"));
+            return false;
+        }
+        --fieldLen;
+    }
+
     QByteArray fieldData;
     if (fieldLen != 0) {
         fieldData = device->read(fieldLen);
@@ -289,16 +318,10 @@ bool Kdbx4Reader::readInnerHeaderField(QIODevice* device)
         setProtectedStreamKey(fieldData);
         break;
 
-    case KeePass2::InnerHeaderFieldID::Binary: {
-        if (fieldLen < 1) {
-            raiseError(tr("Invalid inner header binary size"));
-            return false;
-        }
-        auto data = fieldData.mid(1);
-        m_binaryPool.insert(QString::number(m_binaryPool.size()), data);
+    case KeePass2::InnerHeaderFieldID::Binary:
+        m_binaryPool.insert(QString::number(m_binaryPool.size()), fieldData);
         break;
     }
-    }
 
     return true;
 }
@@ -22,19 +22,21 @@
 #include "config-keepassx.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/Random.h"
+#include "format/KdbxXmlHistory.h"
 #include "format/KeePass2RandomStream.h"
 #ifdef WITH_XC_KEESHARE
 #include "keeshare/KeeShare.h"
 #include "keeshare/KeeShareSettings.h"
 #endif
 #include "streams/HmacBlockStream.h"
+#include "streams/ParallelGzipStream.h"
 #include "streams/SymmetricCipherStream.h"
-#include "streams/qtiocompressor.h"
 
 bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
 {
     m_error = false;
     m_errorStr.clear();
+    m_timings.start();
 
     auto mode = SymmetricCipher::cipherUuidToMode(db->cipher());
     if (mode == SymmetricCipher::InvalidMode) {
@@ -56,6 +58,7 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
         raiseError(tr("Unable to calculate database key: %1").arg(db->keyError()));
         return false;
     }
+    m_timings.lap("kdf");
 
     // generate transformed database key
     CryptoHash hash(CryptoHash::Sha256);
@@ -114,11 +117,13 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
         CryptoHash::hmac(headerData, HmacBlockStream::getHmacKey(UINT64_MAX, hmacKey), CryptoHash::Sha256);
     CHECK_RETURN_FALSE(writeData(device, headerHash));
     CHECK_RETURN_FALSE(writeData(device, headerHmac));
+    m_timings.lap("header");
 
     QScopedPointer<HmacBlockStream> hmacBlockStream;
     QScopedPointer<SymmetricCipherStream> cipherStream;
 
     hmacBlockStream.reset(new HmacBlockStream(device, hmacKey));
+    hmacBlockStream->setParallelBlocks(HmacBlockStream::suggestedParallelBlocks());
     if (!hmacBlockStream->open(QIODevice::WriteOnly)) {
         raiseError(hmacBlockStream->errorString());
         return false;
@@ -136,13 +141,12 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     QIODevice* outputDevice = nullptr;
-    QScopedPointer<QtIOCompressor> ioCompressor;
+    QScopedPointer<ParallelGzipStream> ioCompressor;
 
     if (db->compressionAlgorithm() == Database::CompressionNone) {
         outputDevice = cipherStream.data();
     } else {
-        ioCompressor.reset(new QtIOCompressor(cipherStream.data()));
-        ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
+        ioCompressor.reset(new ParallelGzipStream(cipherStream.data(), db->compressionLevel()));
         if (!ioCompressor->open(QIODevice::WriteOnly)) {
             raiseError(ioCompressor->errorString());
             return false;
@@ -163,6 +167,7 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     auto idxMap = writeAttachments(outputDevice, db);
 
     CHECK_RETURN_FALSE(writeInnerHeaderField(outputDevice, KeePass2::InnerHeaderFieldID::End, QByteArray()));
+    m_timings.lap("attachments");
 
     KeePass2RandomStream randomStream;
     if (!randomStream.init(SymmetricCipher::ChaCha20, protectedStreamKey)) {
@@ -171,7 +176,10 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     KdbxXmlWriter xmlWriter(db->formatVersion(), idxMap);
+    // Compression, encryption and HMAC run in worker threads alongside the
+    // XML generation, so the time waiting on them is part of this stage
     xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
+    m_timings.lap("xml");
 
     // Explicitly close/reset streams so they are flushed and we can detect
     // errors. QIODevice::close() resets errorString() etc.
@@ -186,6 +194,7 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
         raiseError(hmacBlockStream->errorString());
         return false;
     }
+    m_timings.lap("flush");
 
     if (xmlWriter.hasError()) {
         raiseError(xmlWriter.errorString());
@@ -215,9 +224,31 @@ bool Kdbx4Writer::writeInnerHeaderField(QIODevice* device, KeePass2::InnerHeader
     return true;
 }
 
+/**
+ * Write an attachment to the inner header. The flags byte and the
+ * data are written separately so the attachment is never copied.
+ */
+bool Kdbx4Writer::writeBinary(QIODevice* device, const QByteArray& data)
+{
+    QByteArray fieldHeader;
+    fieldHeader.append(static_cast<char>(KeePass2::InnerHeaderFieldID::Binary));
+    fieldHeader.append(Endian::sizedIntToBytes(static_cast<quint32>(data.size() + 1), KeePass2::BYTEORDER));
+    // flags: memory protection
+    fieldHeader.append('\x01');
+    CHECK_RETURN_FALSE(writeData(device, fieldHeader));
+    CHECK_RETURN_FALSE(writeData(device, data));
+
+    return true;
+}
+
 KdbxXmlWriter::BinaryIdxMap Kdbx4Writer::writeAttachments(QIODevice* device, Database* db)
 {
-    const QList<Entry*> allEntries = db->rootGroup()->entriesRecursive(true);
+    // Larger attachments get chunks of their own, so that they are stored
+    // instead of deflated when they are compressed already
+    static const int SeparateChunkSize = 16 * 1024;
+    auto compressor = qobject_cast<ParallelGzipStream*>(device);
+
+    const QList<Entry*> allEntries = KdbxXmlHistory::entriesWithAttachments(db->rootGroup());
     QHash<QByteArray, qint64> writtenAttachments;
     KdbxXmlWriter::BinaryIdxMap idxMap;
     qint64 nextIdx = 0;
@@ -225,25 +256,30 @@ KdbxXmlWriter::BinaryIdxMap Kdbx4Writer::writeAttachments(QIODevice* device, Dat
     for (const Entry* entry : allEntries) {
         const QList<QString> attachmentKeys = entry->attachments()->keys();
         for (const QString& key : attachmentKeys) {
-            QByteArray data("\x01");
-            data.append(entry->attachments()->value(key));
-
-            CryptoHash hash(CryptoHash::Sha256);
+            // Reuse the cached content hash of the attachment
+            QByteArray hashResult;
 #ifdef WITH_XC_KEESHARE
             // Namespace KeeShare attachments so they don't get deduplicated together with attachments
             // from other databases. Prevents potential filesize side channels.
             if (auto shared = KeeShare::resolveSharedGroup(entry->group())) {
-                hash.addData(KeeShare::referenceOf(shared).uuid.toByteArray());
+                hashResult.append(KeeShare::referenceOf(shared).uuid.toByteArray());
             } else {
-                hash.addData(db->uuid().toByteArray());
+                hashResult.append(db->uuid().toByteArray());
             }
 #endif
-            hash.addData(data);
+            hashResult.append(entry->attachments()->hash(key));
 
             // Deduplicate attachments with the same hash
-            const auto hashResult = hash.result();
             if (!writtenAttachments.contains(hashResult)) {
-                writeInnerHeaderField(device, KeePass2::InnerHeaderFieldID::Binary, data);
+                const QByteArray data = entry->attachments()->value(key);
+                const bool separate = compressor && data.size() >= SeparateChunkSize;
+                if (separate) {
+                    compressor->endChunk();
+                }
+                writeBinary(device, data);
+                if (separate) {
+                    compressor->endChunk();
+                }
                 writtenAttachments.insert(hashResult, nextIdx++);
             }
             idxMap.insert(qMakePair(entry, key), writtenAttachments[hashResult]);
@@ -19,6 +19,7 @@
 #define KEEPASSXC_KDBXREADER_H
 
 #include "KeePass2.h"
+#include "core/StageTimings.h"
 
 #include <QCoreApplication>
 #include <QPointer>
@@ -47,6 +48,8 @@ public:
 
     KeePass2::ProtectedStreamAlgo protectedStreamAlgo() const;
 
+    const StageTimings& timings() const;
+
 protected:
     /**
      * Concrete reader implementation for reading database from device.
@@ -81,6 +84,8 @@ protected:
     virtual void setStreamStartBytes(const QByteArray& data);
     virtual void setInnerRandomStreamID(const QByteArray& data);
 
+    bool transformKey(QIODevice* device, const QSharedPointer<const CompositeKey>& key, Database* db);
+
     void raiseError(const QString& errorMessage);
 
     QByteArray m_masterSeed;
@@ -88,6 +93,7 @@ protected:
     QByteArray m_streamStartBytes;
     QByteArray m_protectedStreamKey;
     KeePass2::ProtectedStreamAlgo m_irsAlgo = KeePass2::ProtectedStreamAlgo::InvalidProtectedStreamAlgo;
+    StageTimings m_timings;
 
 private:
     QPair<quint32, quint32> m_kdbxSignature;
@@ -31,6 +31,14 @@ QString KdbxWriter::errorString() const
     return m_errorStr;
 }
 
+/**
+ * @return durations of the stages of the last write
+ */
+const StageTimings& KdbxWriter::timings() const
+{
+    return m_timings;
+}
+
 /**
  * Write KDBX magic header numbers to a device.
  *
@@ -71,9 +79,24 @@ void KdbxWriter::extractDatabase(QByteArray& xmlOutput, Database* db)
     QBuffer buffer;
     buffer.setBuffer(&xmlOutput);
     buffer.open(QIODevice::WriteOnly);
+    extractDatabase(&buffer, db);
+}
+
+/**
+ * Write the unencrypted XML of a database straight to a device,
+ * without building the whole document in memory first.
+ *
+ * @param device output device
+ * @param db source database
+ */
+void KdbxWriter::extractDatabase(QIODevice* device, Database* db)
+{
     KdbxXmlWriter writer(db->formatVersion());
     writer.disableInnerStreamProtection(true);
-    writer.writeDatabase(&buffer, db);
+    writer.writeDatabase(device, db);
+    if (writer.hasError()) {
+        raiseError(writer.errorString());
+    }
 }
 
 /**
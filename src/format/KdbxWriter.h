@@ -20,6 +20,7 @@
 
 #include "KeePass2.h"
 #include "core/Endian.h"
+#include "core/StageTimings.h"
 
 #include <QCoreApplication>
 
@@ -53,10 +54,13 @@ public:
     virtual bool writeDatabase(QIODevice* device, Database* db) = 0;
 
     void extractDatabase(QByteArray& xmlOutput, Database* db);
+    void extractDatabase(QIODevice* device, Database* db);
 
     bool hasError() const;
     QString errorString() const;
 
+    const StageTimings& timings() const;
+
 protected:
     /**
      * Helper method for writing a KDBX header field to a device.
@@ -86,6 +90,8 @@ protected:
 
     bool m_error = false;
     QString m_errorStr = "";
+
+    StageTimings m_timings;
 };
 
 #endif // KEEPASSXC_KDBXWRITER_H
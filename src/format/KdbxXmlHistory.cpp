@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KdbxXmlHistory.h"
+
+#include "core/MemoryUsage.h"
+#include "format/KdbxXmlReader.h"
+
+#include <QAtomicInteger>
+
+namespace
+{
+    QAtomicInteger<quint64> s_nextSerial(1);
+} // namespace
+
+KdbxXmlHistory::KdbxXmlHistory(quint32 kdbxVersion, QSharedPointer<const ProtectedValue::KeyStream> keyStream)
+    : kdbxVersion(kdbxVersion)
+    , keyStream(std::move(keyStream))
+    , m_serial(s_nextSerial.fetchAndAddRelaxed(1))
+{
+}
+
+QList<Entry*> KdbxXmlHistory::load() const
+{
+    KdbxXmlReader reader(kdbxVersion, binaries);
+    QList<Entry*> items = reader.readHistory(*this);
+    if (reader.hasError()) {
+        qWarning("KdbxXmlHistory: failed to load history items: %s", qPrintable(reader.errorString()));
+    }
+    return items;
+}
+
+int KdbxXmlHistory::count() const
+{
+    return modificationTimes.size();
+}
+
+qint64 KdbxXmlHistory::memoryUsage() const
+{
+    qint64 size = MemoryUsage::heapSize(pieces) + MemoryUsage::heapSize(binaries)
+                  + MemoryUsage::heapSize(modificationTimes) + MemoryUsage::heapSize(memoryProtection);
+    size += protectedPieces.capacity() * qint64(sizeof(ProtectedPiece));
+    for (const auto& piece : protectedPieces) {
+        size += MemoryUsage::heapSize(piece.ciphertext);
+    }
+    return size;
+}
+
+QList<QDateTime> KdbxXmlHistory::lastModificationTimes() const
+{
+    return modificationTimes;
+}
+
+/**
+ * Number that identifies these items in the entry cache of the writer,
+ * unlike an address it is never reused.
+ */
+quint64 KdbxXmlHistory::serial() const
+{
+    return m_serial;
+}
+
+/**
+ * @return the History element with the protected values as they were in the file
+ */
+QByteArray KdbxXmlHistory::xml() const
+{
+    QByteArray xml("<History>");
+    for (int i = 0; i < pieces.size(); ++i) {
+        if (i > 0) {
+            xml.append(protectedPieces.at(i - 1).ciphertext.toBase64());
+        }
+        xml.append(pieces.at(i));
+    }
+    xml.append("</History>");
+    return xml;
+}
+
+/**
+ * @return the decrypted protected values in the order of the XML
+ */
+QStringList KdbxXmlHistory::protectedValues() const
+{
+    QStringList values;
+    values.reserve(protectedPieces.size());
+    for (const ProtectedPiece& piece : protectedPieces) {
+        values.append(ProtectedValue(keyStream, piece.offset, piece.ciphertext).decrypt());
+    }
+    return values;
+}
+
+/**
+ * Entries and history items of a group and its subgroups whose attachments
+ * are written to a file. Serialized history items without attachments are
+ * left out, so they are not loaded.
+ */
+QList<Entry*> KdbxXmlHistory::entriesWithAttachments(const Group* group)
+{
+    QList<Entry*> entries = group->entriesRecursive();
+    const int count = entries.size();
+    for (int i = 0; i < count; ++i) {
+        const auto history = entries.at(i)->serializedHistory().dynamicCast<const KdbxXmlHistory>();
+        if (!history || history->hasAttachments) {
+            entries.append(entries.at(i)->historyItems());
+        }
+    }
+    return entries;
+}
@@ -0,0 +1,73 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_KDBXXMLHISTORY_H
+#define KEEPASSXC_KDBXXMLHISTORY_H
+
+#include "core/Entry.h"
+#include "core/Group.h"
+#include "core/ProtectedValue.h"
+
+/**
+ * History items of an entry kept as the XML they were read from.
+ *
+ * The XML is stored without indentation and split at the protected values,
+ * which stay encrypted with the inner stream of the file they were read
+ * from. Until the items are loaded, the writer copies the XML into the file
+ * and only encrypts the protected values again.
+ */
+class KdbxXmlHistory : public Entry::SerializedHistory
+{
+public:
+    struct ProtectedPiece
+    {
+        qint64 offset;
+        QByteArray ciphertext;
+    };
+
+    KdbxXmlHistory(quint32 kdbxVersion, QSharedPointer<const ProtectedValue::KeyStream> keyStream);
+
+    QList<Entry*> load() const override;
+    int count() const override;
+    QList<QDateTime> lastModificationTimes() const override;
+    qint64 memoryUsage() const override;
+
+    quint64 serial() const;
+    QByteArray xml() const;
+    QStringList protectedValues() const;
+
+    static QList<Entry*> entriesWithAttachments(const Group* group);
+
+    const quint32 kdbxVersion;
+    const QSharedPointer<const ProtectedValue::KeyStream> keyStream;
+    // XML of the items, a protected value goes between each two pieces
+    QList<QByteArray> pieces;
+    QVector<ProtectedPiece> protectedPieces;
+    // Attachment data referenced by the items, by their index in the binary pool
+    QHash<QString, QByteArray> binaries;
+    // One for each item, in the order of the items
+    QList<QDateTime> modificationTimes;
+    // Memory protection settings of the file the items were read from
+    QVector<bool> memoryProtection;
+    bool hasAttachments = false;
+    bool hasCustomData = false;
+
+private:
+    const quint64 m_serial;
+};
+
+#endif // KEEPASSXC_KDBXXMLHISTORY_H
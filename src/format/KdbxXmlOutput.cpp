@@ -0,0 +1,338 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KdbxXmlOutput.h"
+
+#include <QIODevice>
+#include <QUuid>
+
+namespace
+{
+    const int BufferSize = 64 * 1024;
+
+    const char Base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    // Characters that are written as they are: printable ASCII except markup, and whitespace
+    bool isPlainChar(ushort uc)
+    {
+        if (uc >= 0x20 && uc < 0x7F) {
+            return uc != '<' && uc != '>' && uc != '&' && uc != '"';
+        }
+        return uc == '\t' || uc == '\n' || uc == '\r';
+    }
+} // namespace
+
+KdbxXmlOutput::KdbxXmlOutput()
+{
+    // Reserved capacity is kept when the buffer is emptied by flush()
+    m_buffer.reserve(BufferSize);
+}
+
+void KdbxXmlOutput::setDevice(QIODevice* device)
+{
+    m_device = device;
+}
+
+void KdbxXmlOutput::writeStartDocument()
+{
+    finishStartElement(false);
+    m_buffer.append(R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)");
+}
+
+void KdbxXmlOutput::writeEndDocument()
+{
+    while (!m_tags.isEmpty()) {
+        writeEndElement();
+    }
+    m_buffer.append('\n');
+    flush();
+}
+
+void KdbxXmlOutput::writeStartElement(QLatin1String name)
+{
+    if (!finishStartElement(false)) {
+        writeIndent(m_tags.size());
+    }
+    m_buffer.append('<');
+    m_buffer.append(name.data(), name.size());
+    m_tags.append(name);
+    m_inStartElement = true;
+    m_lastWasStartElement = true;
+}
+
+void KdbxXmlOutput::writeEndElement()
+{
+    if (m_tags.isEmpty()) {
+        return;
+    }
+
+    // Elements without content are closed as empty elements
+    if (m_inStartElement && !m_inEmptyElement) {
+        m_buffer.append("/>");
+        m_tags.removeLast();
+        m_inStartElement = false;
+        m_lastWasStartElement = false;
+        return;
+    }
+
+    if (!finishStartElement(false) && !m_lastWasStartElement) {
+        writeIndent(m_tags.size() - 1);
+    }
+    if (m_tags.isEmpty()) {
+        return;
+    }
+
+    const QLatin1String name = m_tags.takeLast();
+    m_lastWasStartElement = false;
+    m_buffer.append("</");
+    m_buffer.append(name.data(), name.size());
+    m_buffer.append('>');
+    maybeFlush();
+}
+
+void KdbxXmlOutput::writeEmptyElement(QLatin1String name)
+{
+    writeStartElement(name);
+    m_inEmptyElement = true;
+}
+
+/**
+ * Add an attribute to the element that was just started.
+ * The value is written as it is and must not need escaping.
+ */
+void KdbxXmlOutput::writeAttribute(QLatin1String name, QLatin1String value)
+{
+    Q_ASSERT(m_inStartElement);
+
+    m_buffer.append(' ');
+    m_buffer.append(name.data(), name.size());
+    m_buffer.append("=\"");
+    m_buffer.append(value.data(), value.size());
+    m_buffer.append('"');
+}
+
+void KdbxXmlOutput::writeCharacters(const QString& text)
+{
+    finishStartElement();
+
+    const QChar* chars = text.constData();
+    const int size = text.size();
+    for (int i = 0; i < size; ++i) {
+        if (!isPlainChar(chars[i].unicode())) {
+            writeEscaped(text);
+            return;
+        }
+    }
+
+    // Plain ASCII is its own UTF-8 encoding
+    const int offset = m_buffer.size();
+    m_buffer.resize(offset + size);
+    char* out = m_buffer.data() + offset;
+    for (int i = 0; i < size; ++i) {
+        out[i] = static_cast<char>(chars[i].unicode());
+    }
+    maybeFlush();
+}
+
+/**
+ * Write text that is known to need no escaping, such as base64 or numbers.
+ */
+void KdbxXmlOutput::writeLatin1Characters(const char* data, int size)
+{
+    finishStartElement();
+    m_buffer.append(data, size);
+    maybeFlush();
+}
+
+/**
+ * Base64-encode binary data straight into the text of the current element.
+ */
+void KdbxXmlOutput::writeBase64Characters(const char* data, int size)
+{
+    finishStartElement();
+
+    const auto* in = reinterpret_cast<const uchar*>(data);
+    const int offset = m_buffer.size();
+    m_buffer.resize(offset + (size + 2) / 3 * 4);
+    char* out = m_buffer.data() + offset;
+
+    int i = 0;
+    for (; i + 2 < size; i += 3) {
+        const uint chunk = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+        *out++ = Base64Alphabet[(chunk >> 18) & 0x3F];
+        *out++ = Base64Alphabet[(chunk >> 12) & 0x3F];
+        *out++ = Base64Alphabet[(chunk >> 6) & 0x3F];
+        *out++ = Base64Alphabet[chunk & 0x3F];
+    }
+    if (i < size) {
+        const bool hasSecond = i + 1 < size;
+        const uint chunk = (in[i] << 16) | (hasSecond ? in[i + 1] << 8 : 0);
+        *out++ = Base64Alphabet[(chunk >> 18) & 0x3F];
+        *out++ = Base64Alphabet[(chunk >> 12) & 0x3F];
+        *out++ = hasSecond ? Base64Alphabet[(chunk >> 6) & 0x3F] : '=';
+        *out++ = '=';
+    }
+    maybeFlush();
+}
+
+void KdbxXmlOutput::writeNumberCharacters(qint64 number)
+{
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+
+    // Negate digit by digit, -INT64_MIN does not fit
+    const bool negative = number < 0;
+    do {
+        const int digit = static_cast<int>(number % 10);
+        *--begin = static_cast<char>('0' + (negative ? -digit : digit));
+        number /= 10;
+    } while (number != 0);
+    if (negative) {
+        *--begin = '-';
+    }
+
+    writeLatin1Characters(begin, static_cast<int>(end - begin));
+}
+
+/**
+ * Write the base64 encoding of the RFC 4122 bytes of a UUID.
+ */
+void KdbxXmlOutput::writeUuidCharacters(const QUuid& uuid)
+{
+    const char bytes[16] = {static_cast<char>(uuid.data1 >> 24),
+                            static_cast<char>(uuid.data1 >> 16),
+                            static_cast<char>(uuid.data1 >> 8),
+                            static_cast<char>(uuid.data1),
+                            static_cast<char>(uuid.data2 >> 8),
+                            static_cast<char>(uuid.data2),
+                            static_cast<char>(uuid.data3 >> 8),
+                            static_cast<char>(uuid.data3),
+                            static_cast<char>(uuid.data4[0]),
+                            static_cast<char>(uuid.data4[1]),
+                            static_cast<char>(uuid.data4[2]),
+                            static_cast<char>(uuid.data4[3]),
+                            static_cast<char>(uuid.data4[4]),
+                            static_cast<char>(uuid.data4[5]),
+                            static_cast<char>(uuid.data4[6]),
+                            static_cast<char>(uuid.data4[7])};
+    writeBase64Characters(bytes, sizeof(bytes));
+}
+
+/**
+ * Write output that was produced by this class before, such as the pieces of
+ * a cached entry. The current element must not be in its start tag.
+ */
+void KdbxXmlOutput::writeRaw(const QByteArray& data)
+{
+    Q_ASSERT(!m_inStartElement);
+
+    m_buffer.append(data);
+    m_wroteSomething = false;
+    m_lastWasStartElement = false;
+    maybeFlush();
+}
+
+/**
+ * Write the buffered output to the device.
+ *
+ * @return false if the device failed, the output is dropped from then on
+ */
+bool KdbxXmlOutput::flush()
+{
+    if (!m_error && !m_buffer.isEmpty()) {
+        Q_ASSERT(m_device);
+        if (m_device->write(m_buffer) != m_buffer.size()) {
+            m_error = true;
+        }
+    }
+    m_buffer.resize(0);
+    return !m_error;
+}
+
+bool KdbxXmlOutput::hasError() const
+{
+    return m_error;
+}
+
+bool KdbxXmlOutput::finishStartElement(bool contents)
+{
+    const bool hadSomethingWritten = m_wroteSomething;
+    m_wroteSomething = contents;
+    if (!m_inStartElement) {
+        return hadSomethingWritten;
+    }
+
+    if (m_inEmptyElement) {
+        m_buffer.append("/>");
+        m_tags.removeLast();
+        m_lastWasStartElement = false;
+    } else {
+        m_buffer.append('>');
+    }
+    m_inStartElement = false;
+    m_inEmptyElement = false;
+    return hadSomethingWritten;
+}
+
+void KdbxXmlOutput::writeIndent(int level)
+{
+    const int offset = m_buffer.size();
+    m_buffer.resize(offset + 1 + level);
+    char* out = m_buffer.data() + offset;
+    *out++ = '\n';
+    for (int i = 0; i < level; ++i) {
+        *out++ = '\t';
+    }
+}
+
+void KdbxXmlOutput::writeEscaped(const QString& text)
+{
+    int plainBegin = 0;
+    for (int i = 0; i < text.size(); ++i) {
+        const char* entity;
+        switch (text.at(i).unicode()) {
+        case '<':
+            entity = "&lt;";
+            break;
+        case '>':
+            entity = "&gt;";
+            break;
+        case '&':
+            entity = "&amp;";
+            break;
+        case '"':
+            entity = "&quot;";
+            break;
+        default:
+            continue;
+        }
+
+        m_buffer.append(text.midRef(plainBegin, i - plainBegin).toUtf8());
+        m_buffer.append(entity);
+        plainBegin = i + 1;
+    }
+    m_buffer.append(text.midRef(plainBegin).toUtf8());
+    maybeFlush();
+}
+
+void KdbxXmlOutput::maybeFlush()
+{
+    if (m_buffer.size() >= BufferSize) {
+        flush();
+    }
+}
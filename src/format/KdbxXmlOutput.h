@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_KDBXXMLOUTPUT_H
+#define KEEPASSXC_KDBXXMLOUTPUT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+class QUuid;
+
+/**
+ * UTF-8 XML emitter for KDBX files.
+ *
+ * Writes the same bytes as an auto-formatting QXmlStreamWriter indenting
+ * with tabs, so files and cached entry fragments do not change, but into a
+ * reusable buffer that is flushed to the device in large blocks. Element
+ * names are Latin-1 literals that are copied as they are, and values that
+ * need no escaping are copied without being converted to UTF-8 first.
+ */
+class KdbxXmlOutput
+{
+public:
+    KdbxXmlOutput();
+    Q_DISABLE_COPY(KdbxXmlOutput)
+
+    void setDevice(QIODevice* device);
+
+    void writeStartDocument();
+    void writeEndDocument();
+    void writeStartElement(QLatin1String name);
+    void writeEndElement();
+    void writeEmptyElement(QLatin1String name);
+    void writeAttribute(QLatin1String name, QLatin1String value);
+    void writeCharacters(const QString& text);
+    void writeLatin1Characters(const char* data, int size);
+    void writeBase64Characters(const char* data, int size);
+    void writeNumberCharacters(qint64 number);
+    void writeUuidCharacters(const QUuid& uuid);
+    void writeRaw(const QByteArray& data);
+
+    bool flush();
+    bool hasError() const;
+
+private:
+    bool finishStartElement(bool contents = true);
+    void writeIndent(int level);
+    void writeEscaped(const QString& text);
+    void maybeFlush();
+
+    QIODevice* m_device = nullptr;
+    QByteArray m_buffer;
+    QVector<QLatin1String> m_tags;
+    bool m_inStartElement = false;
+    bool m_inEmptyElement = false;
+    bool m_lastWasStartElement = false;
+    bool m_wroteSomething = false;
+    bool m_error = false;
+};
+
+#endif // KEEPASSXC_KDBXXMLOUTPUT_H
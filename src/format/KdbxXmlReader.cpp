@@ -21,13 +21,291 @@
 #include "core/Endian.h"
 #include "core/Group.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
+#include "format/KdbxXmlHistory.h"
 #include "streams/qtiocompressor.h"
 
 #include <QBuffer>
 #include <QFile>
+#include <QXmlStreamWriter>
 
 #define UUID_LENGTH 16
 
+namespace
+{
+    // Rough size of one entry in an XML export, used to pre-size the lookup tables
+    constexpr qint64 ESTIMATED_ENTRY_XML_SIZE = 2048;
+    // Report progress at most this many times while reading
+    constexpr qint64 PROGRESS_STEPS = 100;
+
+    int base64Value(ushort c)
+    {
+        if (c >= 'A' && c <= 'Z') {
+            return c - 'A';
+        } else if (c >= 'a' && c <= 'z') {
+            return c - 'a' + 26;
+        } else if (c >= '0' && c <= '9') {
+            return c - '0' + 52;
+        } else if (c == '+') {
+            return 62;
+        } else if (c == '/') {
+            return 63;
+        }
+        return -1;
+    }
+
+    /**
+     * Decode padded base64 text, as accepted by Tools::isBase64(), without
+     * any intermediate allocations.
+     *
+     * @return number of bytes written to out, or -1 if text is not valid
+     *         base64 or decodes to more than maxSize bytes
+     */
+    int decodeBase64(const QString& text, char* out, int maxSize)
+    {
+        const int length = text.size();
+        if (length % 4 != 0) {
+            return -1;
+        }
+
+        const QChar* in = text.constData();
+        int outSize = 0;
+        for (int i = 0; i < length; i += 4) {
+            quint32 triple = 0;
+            int padding = 0;
+            for (int j = 0; j < 4; ++j) {
+                const ushort c = in[i + j].unicode();
+                int value;
+                if (c == '=' && j >= 2 && i + 4 == length) {
+                    value = 0;
+                    ++padding;
+                } else if (padding > 0 || (value = base64Value(c)) < 0) {
+                    return -1;
+                }
+                triple = (triple << 6) | static_cast<quint32>(value);
+            }
+
+            const int bytes = 3 - padding;
+            if (outSize + bytes > maxSize) {
+                return -1;
+            }
+            out[outSize++] = static_cast<char>(triple >> 16);
+            if (bytes > 1) {
+                out[outSize++] = static_cast<char>((triple >> 8) & 0xFF);
+            }
+            if (bytes > 2) {
+                out[outSize++] = static_cast<char>(triple & 0xFF);
+            }
+        }
+        return outSize;
+    }
+
+    // Elements of groups and entries, which are read for every item of the database
+    enum class Element
+    {
+        Unknown,
+        UUID,
+        Name,
+        Notes,
+        Tags,
+        IconID,
+        CustomIconUUID,
+        Times,
+        IsExpanded,
+        DefaultAutoTypeSequence,
+        EnableAutoType,
+        EnableSearching,
+        LastTopVisibleEntry,
+        Group,
+        Entry,
+        CustomData,
+        PreviousParentGroup,
+        ForegroundColor,
+        BackgroundColor,
+        OverrideURL,
+        String,
+        QualityCheck,
+        Binary,
+        AutoType,
+        History,
+        Key,
+        Value,
+        Enabled,
+        DataTransferObfuscation,
+        DefaultSequence,
+        Association,
+        Window,
+        KeystrokeSequence,
+        LastModificationTime,
+        CreationTime,
+        LastAccessTime,
+        ExpiryTime,
+        Expires,
+        UsageCount,
+        LocationChanged
+    };
+
+    /**
+     * Look up a group or entry element by name. The names are dispatched on
+     * their length first, so only a few of them are ever compared.
+     */
+    Element elementName(const QStringRef& name)
+    {
+        switch (name.size()) {
+        case 3:
+            if (name == QLatin1String("Key")) {
+                return Element::Key;
+            }
+            break;
+        case 4:
+            if (name == QLatin1String("UUID")) {
+                return Element::UUID;
+            }
+            if (name == QLatin1String("Name")) {
+                return Element::Name;
+            }
+            if (name == QLatin1String("Tags")) {
+                return Element::Tags;
+            }
+            break;
+        case 5:
+            if (name == QLatin1String("Notes")) {
+                return Element::Notes;
+            }
+            if (name == QLatin1String("Times")) {
+                return Element::Times;
+            }
+            if (name == QLatin1String("Group")) {
+                return Element::Group;
+            }
+            if (name == QLatin1String("Entry")) {
+                return Element::Entry;
+            }
+            if (name == QLatin1String("Value")) {
+                return Element::Value;
+            }
+            break;
+        case 6:
+            if (name == QLatin1String("IconID")) {
+                return Element::IconID;
+            }
+            if (name == QLatin1String("String")) {
+                return Element::String;
+            }
+            if (name == QLatin1String("Binary")) {
+                return Element::Binary;
+            }
+            if (name == QLatin1String("Window")) {
+                return Element::Window;
+            }
+            break;
+        case 7:
+            if (name == QLatin1String("History")) {
+                return Element::History;
+            }
+            if (name == QLatin1String("Enabled")) {
+                return Element::Enabled;
+            }
+            if (name == QLatin1String("Expires")) {
+                return Element::Expires;
+            }
+            break;
+        case 8:
+            if (name == QLatin1String("AutoType")) {
+                return Element::AutoType;
+            }
+            break;
+        case 10:
+            if (name == QLatin1String("IsExpanded")) {
+                return Element::IsExpanded;
+            }
+            if (name == QLatin1String("CustomData")) {
+                return Element::CustomData;
+            }
+            if (name == QLatin1String("ExpiryTime")) {
+                return Element::ExpiryTime;
+            }
+            if (name == QLatin1String("UsageCount")) {
+                return Element::UsageCount;
+            }
+            break;
+        case 11:
+            if (name == QLatin1String("OverrideURL")) {
+                return Element::OverrideURL;
+            }
+            if (name == QLatin1String("Association")) {
+                return Element::Association;
+            }
+            break;
+        case 12:
+            if (name == QLatin1String("QualityCheck")) {
+                return Element::QualityCheck;
+            }
+            if (name == QLatin1String("CreationTime")) {
+                return Element::CreationTime;
+            }
+            break;
+        case 14:
+            if (name == QLatin1String("CustomIconUUID")) {
+                return Element::CustomIconUUID;
+            }
+            if (name == QLatin1String("EnableAutoType")) {
+                return Element::EnableAutoType;
+            }
+            if (name == QLatin1String("LastAccessTime")) {
+                return Element::LastAccessTime;
+            }
+            break;
+        case 15:
+            if (name == QLatin1String("EnableSearching")) {
+                return Element::EnableSearching;
+            }
+            if (name == QLatin1String("ForegroundColor")) {
+                return Element::ForegroundColor;
+            }
+            if (name == QLatin1String("BackgroundColor")) {
+                return Element::BackgroundColor;
+            }
+            if (name == QLatin1String("DefaultSequence")) {
+                return Element::DefaultSequence;
+            }
+            if (name == QLatin1String("LocationChanged")) {
+                return Element::LocationChanged;
+            }
+            break;
+        case 17:
+            if (name == QLatin1String("KeystrokeSequence")) {
+                return Element::KeystrokeSequence;
+            }
+            break;
+        case 19:
+            if (name == QLatin1String("LastTopVisibleEntry")) {
+                return Element::LastTopVisibleEntry;
+            }
+            if (name == QLatin1String("PreviousParentGroup")) {
+                return Element::PreviousParentGroup;
+            }
+            break;
+        case 20:
+            if (name == QLatin1String("LastModificationTime")) {
+                return Element::LastModificationTime;
+            }
+            break;
+        case 23:
+            if (name == QLatin1String("DefaultAutoTypeSequence")) {
+                return Element::DefaultAutoTypeSequence;
+            }
+            if (name == QLatin1String("DataTransferObfuscation")) {
+                return Element::DataTransferObfuscation;
+            }
+            break;
+        default:
+            break;
+        }
+        return Element::Unknown;
+    }
+} // namespace
+
 /**
  * @param version KDBX version
  */
@@ -81,6 +359,7 @@ QSharedPointer<Database> KdbxXmlReader::readDatabase(QIODevice* device)
  */
 void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2RandomStream* randomStream)
 {
+    TRACE_SCOPE("KdbxXmlReader::readDatabase");
     m_error = false;
     m_errorStr.clear();
 
@@ -92,10 +371,23 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
     m_meta->setUpdateDatetime(false);
 
     m_randomStream = randomStream;
+    m_keyStream = randomStream ? randomStream->keyStream() : nullptr;
+    m_lazyHistory = m_keyStream && db->lazyHistoryLoading();
+    m_serializedBinaryRefs.clear();
     m_headerHash.clear();
 
     m_tmpParent.reset(new Group());
 
+    m_device = device;
+    m_progressTotal = device->isSequential() ? 0 : device->size();
+    m_progressReported = 0;
+    if (m_progressTotal > 0) {
+        const auto estimatedEntries =
+            static_cast<int>(qMin<qint64>(m_progressTotal / ESTIMATED_ENTRY_XML_SIZE, 1 << 20));
+        m_entries.reserve(estimatedEntries);
+        m_groups.reserve(estimatedEntries / 16);
+    }
+
     bool rootGroupParsed = false;
 
     if (m_xml.hasError()) {
@@ -123,7 +415,8 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
     const QSet<QString> poolKeys = asConst(m_binaryPool).keys().toSet();
     const QSet<QString> entryKeys = asConst(m_binaryMap).keys().toSet();
     const QSet<QString> unmappedKeys = entryKeys - poolKeys;
-    const QSet<QString> unusedKeys = poolKeys - entryKeys;
+    // Serialized history items keep their attachments until they are loaded
+    const QSet<QString> unusedKeys = poolKeys - entryKeys - m_serializedBinaryRefs;
 
     if (!unmappedKeys.isEmpty()) {
         qWarning("Unmapped keys left.");
@@ -136,8 +429,11 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
     QHash<QString, QPair<Entry*, QString>>::const_iterator i;
     for (i = m_binaryMap.constBegin(); i != m_binaryMap.constEnd(); ++i) {
         const QPair<Entry*, QString>& target = i.value();
-        target.first->attachments()->set(target.second, m_binaryPool[i.key()]);
+        target.first->attachments()->set(target.second, m_binaryPool.value(i.key()));
     }
+    // The attachments share the data, the pool would only keep it alive
+    m_binaryPool.clear();
+    m_binaryMap.clear();
 
     m_meta->setUpdateDatetime(true);
 
@@ -150,11 +446,38 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
     for (iEntry = m_entries.constBegin(); iEntry != m_entries.constEnd(); ++iEntry) {
         iEntry.value()->setUpdateTimeinfo(true);
 
+        // Serialized history items are set up when they are loaded
+        if (iEntry.value()->serializedHistory()) {
+            continue;
+        }
         const QList<Entry*> historyItems = iEntry.value()->historyItems();
         for (Entry* histEntry : historyItems) {
             histEntry->setUpdateTimeinfo(true);
         }
     }
+    TRACE_COUNTER("read entries", m_entries.size());
+}
+
+/**
+ * Set a function to call with the number of bytes read while parsing.
+ * Progress is only reported for devices with a known size.
+ */
+void KdbxXmlReader::setProgressCallback(ProgressFunction progress)
+{
+    m_progress = std::move(progress);
+}
+
+void KdbxXmlReader::reportProgress()
+{
+    if (!m_progress || m_progressTotal <= 0) {
+        return;
+    }
+
+    const qint64 done = m_device->pos();
+    if (done - m_progressReported >= m_progressTotal / PROGRESS_STEPS) {
+        m_progressReported = done;
+        m_progress(done, m_progressTotal);
+    }
 }
 
 bool KdbxXmlReader::strictMode() const
@@ -425,16 +748,21 @@ void KdbxXmlReader::parseCustomDataItem(CustomData* customData)
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        switch (elementName(m_xml.name())) {
+        case Element::Key:
             key = readString();
             keySet = true;
-        } else if (m_xml.name() == "Value") {
+            break;
+        case Element::Value:
             item.value = readString();
             valueSet = true;
-        } else if (m_xml.name() == "LastModificationTime") {
+            break;
+        case Element::LastModificationTime:
             item.lastModified = readDateTime();
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -488,7 +816,8 @@ Group* KdbxXmlReader::parseGroup()
     QList<Group*> children;
     QList<Entry*> entries;
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        switch (elementName(m_xml.name())) {
+        case Element::UUID: {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -501,19 +830,19 @@ Group* KdbxXmlReader::parseGroup()
             }
             continue;
         }
-        if (m_xml.name() == "Name") {
+        case Element::Name: {
             group->setName(readString());
             continue;
         }
-        if (m_xml.name() == "Notes") {
+        case Element::Notes: {
             group->setNotes(readString());
             continue;
         }
-        if (m_xml.name() == "Tags") {
+        case Element::Tags: {
             group->setTags(readString());
             continue;
         }
-        if (m_xml.name() == "IconID") {
+        case Element::IconID: {
             int iconId = readNumber();
             if (iconId < 0) {
                 if (m_strictMode) {
@@ -525,26 +854,26 @@ Group* KdbxXmlReader::parseGroup()
             group->setIcon(iconId);
             continue;
         }
-        if (m_xml.name() == "CustomIconUUID") {
+        case Element::CustomIconUUID: {
             QUuid uuid = readUuid();
             if (!uuid.isNull()) {
                 group->setIcon(uuid);
             }
             continue;
         }
-        if (m_xml.name() == "Times") {
+        case Element::Times: {
             group->setTimeInfo(parseTimes());
             continue;
         }
-        if (m_xml.name() == "IsExpanded") {
+        case Element::IsExpanded: {
             group->setExpanded(readBool());
             continue;
         }
-        if (m_xml.name() == "DefaultAutoTypeSequence") {
+        case Element::DefaultAutoTypeSequence: {
             group->setDefaultAutoTypeSequence(readString());
             continue;
         }
-        if (m_xml.name() == "EnableAutoType") {
+        case Element::EnableAutoType: {
             QString str = readString();
 
             if (str.compare("null", Qt::CaseInsensitive) == 0) {
@@ -558,7 +887,7 @@ Group* KdbxXmlReader::parseGroup()
             }
             continue;
         }
-        if (m_xml.name() == "EnableSearching") {
+        case Element::EnableSearching: {
             QString str = readString();
 
             if (str.compare("null", Qt::CaseInsensitive) == 0) {
@@ -572,32 +901,35 @@ Group* KdbxXmlReader::parseGroup()
             }
             continue;
         }
-        if (m_xml.name() == "LastTopVisibleEntry") {
+        case Element::LastTopVisibleEntry: {
             group->setLastTopVisibleEntry(getEntry(readUuid()));
             continue;
         }
-        if (m_xml.name() == "Group") {
+        case Element::Group: {
             Group* newGroup = parseGroup();
             if (newGroup) {
                 children.append(newGroup);
             }
             continue;
         }
-        if (m_xml.name() == "Entry") {
+        case Element::Entry: {
             Entry* newEntry = parseEntry(false);
             if (newEntry) {
                 entries.append(newEntry);
             }
             continue;
         }
-        if (m_xml.name() == "CustomData") {
+        case Element::CustomData: {
             parseCustomData(group->customData());
             continue;
         }
-        if (m_xml.name() == "PreviousParentGroup") {
+        case Element::PreviousParentGroup: {
             group->setPreviousParentGroupUuid(readUuid());
             continue;
         }
+        default:
+            break;
+        }
 
         skipCurrentElement();
     }
@@ -607,11 +939,17 @@ Group* KdbxXmlReader::parseGroup()
     }
 
     if (!group->uuid().isNull()) {
-        Group* tmpGroup = group;
-        group = getGroup(tmpGroup->uuid());
-        group->copyDataFrom(tmpGroup);
-        group->setUpdateTimeinfo(false);
-        delete tmpGroup;
+        if (!m_groups.contains(group->uuid())) {
+            // No forward reference to this group yet, keep the parsed object
+            // instead of going through a placeholder in m_tmpParent
+            m_groups.insert(group->uuid(), group);
+        } else {
+            Group* tmpGroup = group;
+            group = getGroup(tmpGroup->uuid());
+            group->copyDataFrom(tmpGroup);
+            group->setUpdateTimeinfo(false);
+            delete tmpGroup;
+        }
     } else if (!hasError()) {
         raiseError(tr("No group uuid found"));
     }
@@ -683,10 +1021,12 @@ Entry* KdbxXmlReader::parseEntry(bool history)
     auto entry = new Entry();
     entry->setUpdateTimeinfo(false);
     QList<Entry*> historyItems;
+    QSharedPointer<KdbxXmlHistory> serializedHistory;
     QList<StringPair> binaryRefs;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        switch (elementName(m_xml.name())) {
+        case Element::UUID: {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -699,7 +1039,7 @@ Entry* KdbxXmlReader::parseEntry(bool history)
             }
             continue;
         }
-        if (m_xml.name() == "IconID") {
+        case Element::IconID: {
             int iconId = readNumber();
             if (iconId < 0) {
                 if (m_strictMode) {
@@ -710,61 +1050,63 @@ Entry* KdbxXmlReader::parseEntry(bool history)
             entry->setIcon(iconId);
             continue;
         }
-        if (m_xml.name() == "CustomIconUUID") {
+        case Element::CustomIconUUID: {
             QUuid uuid = readUuid();
             if (!uuid.isNull()) {
                 entry->setIcon(uuid);
             }
             continue;
         }
-        if (m_xml.name() == "ForegroundColor") {
+        case Element::ForegroundColor: {
             entry->setForegroundColor(readColor());
             continue;
         }
-        if (m_xml.name() == "BackgroundColor") {
+        case Element::BackgroundColor: {
             entry->setBackgroundColor(readColor());
             continue;
         }
-        if (m_xml.name() == "OverrideURL") {
+        case Element::OverrideURL: {
             entry->setOverrideUrl(readString());
             continue;
         }
-        if (m_xml.name() == "Tags") {
+        case Element::Tags: {
             entry->setTags(readString());
             continue;
         }
-        if (m_xml.name() == "Times") {
+        case Element::Times: {
             entry->setTimeInfo(parseTimes());
             continue;
         }
-        if (m_xml.name() == "String") {
-            parseEntryString(entry);
+        case Element::String: {
+            parseEntryString(entry, history);
             continue;
         }
-        if (m_xml.name() == "QualityCheck") {
+        case Element::QualityCheck: {
             entry->setExcludeFromReports(!readBool());
             continue;
         }
-        if (m_xml.name() == "Binary") {
+        case Element::Binary: {
             QPair<QString, QString> ref = parseEntryBinary(entry);
             if (!ref.first.isEmpty() && !ref.second.isEmpty()) {
                 binaryRefs.append(ref);
             }
             continue;
         }
-        if (m_xml.name() == "AutoType") {
+        case Element::AutoType: {
             parseAutoType(entry);
             continue;
         }
-        if (m_xml.name() == "History") {
+        case Element::History: {
             if (history) {
                 raiseError(tr("History element in history entry"));
+            } else if (m_lazyHistory) {
+                serializedHistory = captureEntryHistory();
             } else {
                 historyItems = parseEntryHistory();
             }
             continue;
         }
-        if (m_xml.name() == "CustomData") {
+        case Element::CustomData: {
             parseCustomData(entry->customData());
 
             // Upgrade pre-KDBX-4.1 password report exclude flag
@@ -775,10 +1117,14 @@ Entry* KdbxXmlReader::parseEntry(bool history)
             }
             continue;
         }
-        if (m_xml.name() == "PreviousParentGroup") {
+        case Element::PreviousParentGroup: {
             entry->setPreviousParentGroupUuid(readUuid());
             continue;
         }
+        default:
+            break;
+        }
+
         skipCurrentElement();
     }
 
@@ -789,6 +1135,8 @@ Entry* KdbxXmlReader::parseEntry(bool history)
     if (!entry->uuid().isNull()) {
         if (history) {
             entry->setUpdateTimeinfo(false);
+        } else if (!m_entries.contains(entry->uuid())) {
+            m_entries.insert(entry->uuid(), entry);
         } else {
             Entry* tmpEntry = entry;
 
@@ -812,33 +1160,51 @@ Entry* KdbxXmlReader::parseEntry(bool history)
         }
         entry->addHistoryItem(historyItem);
     }
+    if (serializedHistory && serializedHistory->count() > 0) {
+        entry->setSerializedHistory(serializedHistory);
+    }
 
     for (const StringPair& ref : asConst(binaryRefs)) {
         m_binaryMap.insertMulti(ref.first, qMakePair(entry, ref.second));
     }
 
+    if (!history) {
+        reportProgress();
+    }
+
     return entry;
 }
 
-void KdbxXmlReader::parseEntryString(Entry* entry)
+void KdbxXmlReader::parseEntryString(Entry* entry, bool history)
 {
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "String");
 
     QString key;
     QString value;
+    ProtectedValue encryptedValue;
     bool protect = false;
     bool keySet = false;
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        switch (elementName(m_xml.name())) {
+        case Element::Key: {
             key = readString();
             keySet = true;
             continue;
         }
 
-        if (m_xml.name() == "Value") {
-            QXmlStreamAttributes attr = m_xml.attributes();
+        case Element::Value: {
+            // History items and custom attributes are rarely looked at, their protected values are
+            // decrypted on access. The default attributes of entries are indexed and read right away.
+            if (m_keyStream && keySet && (history || !EntryAttributes::isDefaultAttribute(key))
+                && isTrueValue(m_xml.attributes().value("Protected"))) {
+                encryptedValue = readProtectedValue();
+                protect = true;
+                valueSet = true;
+                continue;
+            }
+
             bool isProtected;
             bool protectInMemory;
             value = readString(isProtected, protectInMemory);
@@ -846,6 +1212,9 @@ void KdbxXmlReader::parseEntryString(Entry* entry)
             valueSet = true;
             continue;
         }
+        default:
+            break;
+        }
 
         skipCurrentElement();
     }
@@ -856,7 +1225,11 @@ void KdbxXmlReader::parseEntryString(Entry* entry)
             raiseError(tr("Duplicate custom attribute found"));
             return;
         }
-        entry->attributes()->set(key, value, protect);
+        if (encryptedValue.size() > 0) {
+            entry->attributes()->setEncrypted(key, encryptedValue);
+        } else {
+            entry->attributes()->set(key, value, protect);
+        }
         return;
     }
 
@@ -875,12 +1248,13 @@ QPair<QString, QString> KdbxXmlReader::parseEntryBinary(Entry* entry)
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        switch (elementName(m_xml.name())) {
+        case Element::Key: {
             key = readString();
             keySet = true;
             continue;
         }
-        if (m_xml.name() == "Value") {
+        case Element::Value: {
             QXmlStreamAttributes attr = m_xml.attributes();
 
             if (attr.hasAttribute("Ref")) {
@@ -894,6 +1268,10 @@ QPair<QString, QString> KdbxXmlReader::parseEntryBinary(Entry* entry)
             valueSet = true;
             continue;
         }
+        default:
+            break;
+        }
+
         skipCurrentElement();
     }
 
@@ -917,16 +1295,22 @@ void KdbxXmlReader::parseAutoType(Entry* entry)
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "AutoType");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Enabled") {
+        switch (elementName(m_xml.name())) {
+        case Element::Enabled:
             entry->setAutoTypeEnabled(readBool());
-        } else if (m_xml.name() == "DataTransferObfuscation") {
+            break;
+        case Element::DataTransferObfuscation:
             entry->setAutoTypeObfuscation(readNumber());
-        } else if (m_xml.name() == "DefaultSequence") {
+            break;
+        case Element::DefaultSequence:
             entry->setDefaultAutoTypeSequence(readString());
-        } else if (m_xml.name() == "Association") {
+            break;
+        case Element::Association:
             parseAutoTypeAssoc(entry);
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 }
@@ -940,14 +1324,18 @@ void KdbxXmlReader::parseAutoTypeAssoc(Entry* entry)
     bool sequenceSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Window") {
+        switch (elementName(m_xml.name())) {
+        case Element::Window:
             assoc.window = readString();
             windowSet = true;
-        } else if (m_xml.name() == "KeystrokeSequence") {
+            break;
+        case Element::KeystrokeSequence:
             assoc.sequence = readString();
             sequenceSet = true;
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -975,28 +1363,187 @@ QList<Entry*> KdbxXmlReader::parseEntryHistory()
     return historyItems;
 }
 
+/**
+ * Keep the items of a History element as XML instead of parsing them,
+ * see KdbxXmlHistory. Protected values are left encrypted.
+ */
+QSharedPointer<KdbxXmlHistory> KdbxXmlReader::captureEntryHistory()
+{
+    Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "History");
+
+    auto history = QSharedPointer<KdbxXmlHistory>::create(m_kdbxVersion, m_keyStream);
+    history->memoryProtection = {m_meta->protectTitle(),
+                                 m_meta->protectUsername(),
+                                 m_meta->protectPassword(),
+                                 m_meta->protectUrl(),
+                                 m_meta->protectNotes()};
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter writer(&buffer);
+    auto cutPiece = [&] {
+        history->pieces.append(buffer.data());
+        buffer.buffer().clear();
+        buffer.seek(0);
+    };
+
+    // Indentation between elements is dropped, text of leaf elements is kept as it is
+    QString text;
+    auto flushText = [&] {
+        for (const QChar c : asConst(text)) {
+            if (!c.isSpace()) {
+                writer.writeCharacters(text);
+                break;
+            }
+        }
+        text.clear();
+    };
+
+    QStringList path;
+    while (!m_xml.hasError()) {
+        switch (m_xml.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            flushText();
+            const QString name = m_xml.name().toString();
+            const QXmlStreamAttributes attributes = m_xml.attributes();
+            writer.writeStartElement(name);
+            writer.writeAttributes(attributes);
+
+            if (path.isEmpty() && name == "Entry") {
+                history->modificationTimes.append(QDateTime());
+            } else if (path.size() == 1 && name == "Binary") {
+                history->hasAttachments = true;
+            } else if (path.size() == 1 && name == "CustomData") {
+                history->hasCustomData = true;
+            } else if (path.size() == 2 && path.at(1) == "Binary" && name == "Value"
+                       && attributes.hasAttribute("Ref")) {
+                const QString ref = attributes.value("Ref").toString();
+                history->binaries.insert(ref, m_binaryPool.value(ref));
+                m_serializedBinaryRefs.insert(ref);
+            }
+
+            if (isTrueValue(attributes.value("Protected"))) {
+                const QString& value = readElementTextBuffered();
+                const QByteArray ciphertext = QByteArray::fromBase64(value.toLatin1());
+                if (ciphertext.isEmpty()) {
+                    writer.writeCharacters(value);
+                } else {
+                    const qint64 offset = takeProtectedOffset(ciphertext.size());
+                    writer.writeCharacters({});
+                    cutPiece();
+                    history->protectedPieces.append({offset, ciphertext});
+                }
+                writer.writeEndElement();
+                continue;
+            }
+            if (path.size() == 2 && path.at(1) == "Times" && name == "LastModificationTime") {
+                const QString& value = readElementTextBuffered();
+                writer.writeCharacters(value);
+                writer.writeEndElement();
+                history->modificationTimes.last() = parseDateTime(value);
+                continue;
+            }
+            path.append(name);
+            continue;
+        }
+        case QXmlStreamReader::Characters:
+        case QXmlStreamReader::EntityReference:
+            text.append(m_xml.text());
+            continue;
+        case QXmlStreamReader::EndElement:
+            if (path.isEmpty()) {
+                history->pieces.append(buffer.data());
+                return history;
+            }
+            if (!text.isEmpty()) {
+                writer.writeCharacters(text);
+                text.clear();
+            }
+            writer.writeEndElement();
+            path.removeLast();
+            continue;
+        default:
+            continue;
+        }
+    }
+
+    return history;
+}
+
+/**
+ * Load the items of a serialized entry history.
+ *
+ * @return history items, owned by the caller
+ */
+QList<Entry*> KdbxXmlReader::readHistory(const KdbxXmlHistory& history)
+{
+    TRACE_SCOPE("KdbxXmlReader::readHistory");
+    m_error = false;
+    m_errorStr.clear();
+
+    // Protected values are decrypted at the offsets they had in the file
+    m_randomStream = nullptr;
+    m_keyStream = history.keyStream;
+    m_protectedOffsets.clear();
+    for (const auto& piece : history.protectedPieces) {
+        m_protectedOffsets.append(piece.offset);
+    }
+    m_nextProtectedOffset = 0;
+    m_binaryPool = history.binaries;
+
+    m_xml.clear();
+    m_xml.addData(history.xml());
+
+    QList<Entry*> historyItems;
+    if (m_xml.readNextStartElement() && m_xml.name() == "History") {
+        historyItems = parseEntryHistory();
+    }
+
+    QHash<QString, QPair<Entry*, QString>>::const_iterator i;
+    for (i = m_binaryMap.constBegin(); i != m_binaryMap.constEnd(); ++i) {
+        const QPair<Entry*, QString>& target = i.value();
+        target.first->attachments()->set(target.second, m_binaryPool.value(i.key()));
+    }
+    m_binaryPool.clear();
+    m_binaryMap.clear();
+
+    for (Entry* historyItem : asConst(historyItems)) {
+        historyItem->setUpdateTimeinfo(true);
+    }
+    return historyItems;
+}
+
 TimeInfo KdbxXmlReader::parseTimes()
 {
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Times");
 
     TimeInfo timeInfo;
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "LastModificationTime") {
+        switch (elementName(m_xml.name())) {
+        case Element::LastModificationTime:
             timeInfo.setLastModificationTime(readDateTime());
-        } else if (m_xml.name() == "CreationTime") {
+            break;
+        case Element::CreationTime:
             timeInfo.setCreationTime(readDateTime());
-        } else if (m_xml.name() == "LastAccessTime") {
+            break;
+        case Element::LastAccessTime:
             timeInfo.setLastAccessTime(readDateTime());
-        } else if (m_xml.name() == "ExpiryTime") {
+            break;
+        case Element::ExpiryTime:
             timeInfo.setExpiryTime(readDateTime());
-        } else if (m_xml.name() == "Expires") {
+            break;
+        case Element::Expires:
             timeInfo.setExpires(readBool());
-        } else if (m_xml.name() == "UsageCount") {
+            break;
+        case Element::UsageCount:
             timeInfo.setUsageCount(readNumber());
-        } else if (m_xml.name() == "LocationChanged") {
+            break;
+        case Element::LocationChanged:
             timeInfo.setLocationChanged(readDateTime());
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -1020,6 +1567,17 @@ QString KdbxXmlReader::readString(bool& isProtected, bool& protectInMemory)
 
     if (isProtected && !value.isEmpty()) {
         QByteArray ciphertext = QByteArray::fromBase64(value.toLatin1());
+        if (!m_randomStream) {
+            // Serialized history items are read without the inner stream, see readHistory()
+            if (ciphertext.isEmpty()) {
+                return {};
+            }
+            const qint64 offset = takeProtectedOffset(ciphertext.size());
+            if (m_error) {
+                return {};
+            }
+            return ProtectedValue(m_keyStream, offset, ciphertext).decrypt();
+        }
         bool ok;
         QByteArray plaintext = m_randomStream->process(ciphertext, &ok);
         if (!ok) {
@@ -1034,9 +1592,51 @@ QString KdbxXmlReader::readString(bool& isProtected, bool& protectInMemory)
     return value;
 }
 
+/**
+ * Read a protected value without decrypting it. The inner stream moves past
+ * the value as if it had been decrypted.
+ */
+ProtectedValue KdbxXmlReader::readProtectedValue()
+{
+    const QByteArray ciphertext = QByteArray::fromBase64(readElementTextBuffered().toLatin1());
+    if (ciphertext.isEmpty()) {
+        return {};
+    }
+
+    const qint64 offset = takeProtectedOffset(ciphertext.size());
+    if (m_error) {
+        return {};
+    }
+    return {m_keyStream, offset, ciphertext};
+}
+
+/**
+ * Move past a protected value in the inner stream.
+ *
+ * @param size size of the encrypted value
+ * @return offset of the value in the inner stream
+ */
+qint64 KdbxXmlReader::takeProtectedOffset(int size)
+{
+    if (m_randomStream) {
+        const qint64 offset = m_randomStream->position();
+        if (!m_randomStream->skip(size)) {
+            raiseError(m_randomStream->errorString());
+        }
+        return offset;
+    }
+
+    // The offsets of serialized history items were recorded when they were read from the file
+    if (m_nextProtectedOffset >= m_protectedOffsets.size()) {
+        raiseError(tr("Invalid protected value"));
+        return 0;
+    }
+    return m_protectedOffsets.at(m_nextProtectedOffset++);
+}
+
 bool KdbxXmlReader::readBool()
 {
-    QString str = readString();
+    const QString& str = readValueText();
 
     if (str.compare("true", Qt::CaseInsensitive) == 0) {
         return true;
@@ -1053,7 +1653,24 @@ bool KdbxXmlReader::readBool()
 
 QDateTime KdbxXmlReader::readDateTime()
 {
-    QString str = readString();
+    return parseDateTime(readValueText());
+}
+
+QDateTime KdbxXmlReader::parseDateTime(const QString& str)
+{
+    static const QDateTime epoch(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC);
+
+    // Fast path for KDBX 4 timestamps: base64 encoded 64 bit seconds
+    char secsBuffer[8] = {};
+    if (decodeBase64(str, secsBuffer, sizeof(secsBuffer)) >= 0) {
+        Q_STATIC_ASSERT(KeePass2::BYTEORDER == QSysInfo::LittleEndian);
+        quint64 secs = 0;
+        for (int i = sizeof(secsBuffer) - 1; i >= 0; --i) {
+            secs = (secs << 8) | static_cast<uchar>(secsBuffer[i]);
+        }
+        return epoch.addSecs(static_cast<qint64>(secs));
+    }
+
     if (Tools::isBase64(str.toLatin1())) {
         QByteArray secsBytes = QByteArray::fromBase64(str.toUtf8()).leftJustified(8, '\0', true).left(8);
         qint64 secs = Endian::bytesToSizedInt<quint64>(secsBytes, KeePass2::BYTEORDER);
@@ -1105,7 +1722,7 @@ QString KdbxXmlReader::readColor()
 int KdbxXmlReader::readNumber()
 {
     bool ok;
-    int result = readString().toInt(&ok);
+    int result = readValueText().toInt(&ok);
     if (!ok) {
         raiseError(tr("Invalid number value"));
     }
@@ -1114,6 +1731,34 @@ int KdbxXmlReader::readNumber()
 
 QUuid KdbxXmlReader::readUuid()
 {
+    if (!isTrueValue(m_xml.attributes().value(QLatin1String("Protected")))) {
+        char uuidBuffer[UUID_LENGTH];
+        const QString& text = readElementTextBuffered();
+        int length = decodeBase64(text, uuidBuffer, UUID_LENGTH);
+        if (length == 0) {
+            return {};
+        } else if (length == UUID_LENGTH) {
+            const auto* bytes = reinterpret_cast<const uchar*>(uuidBuffer);
+            return QUuid((static_cast<uint>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3],
+                         static_cast<ushort>((bytes[4] << 8) | bytes[5]),
+                         static_cast<ushort>((bytes[6] << 8) | bytes[7]),
+                         bytes[8], bytes[9], bytes[10], bytes[11], bytes[12], bytes[13], bytes[14], bytes[15]);
+        }
+
+        // not plain base64 of a uuid, decode leniently like readBinary()
+        QByteArray uuidBin = QByteArray::fromBase64(text.toLatin1());
+        if (uuidBin.isEmpty()) {
+            return {};
+        }
+        if (uuidBin.length() != UUID_LENGTH) {
+            if (m_strictMode) {
+                raiseError(tr("Invalid uuid value"));
+            }
+            return {};
+        }
+        return QUuid::fromRfc4122(uuidBin);
+    }
+
     QByteArray uuidBin = readBinary();
     if (uuidBin.isEmpty()) {
         return {};
@@ -1131,10 +1776,25 @@ QByteArray KdbxXmlReader::readBinary()
 {
     QXmlStreamAttributes attr = m_xml.attributes();
     bool isProtected = isTrueValue(attr.value("Protected"));
-    QString value = m_xml.readElementText();
-    QByteArray data = QByteArray::fromBase64(value.toLatin1());
+    const QString& value = readElementTextBuffered();
+    QByteArray data(value.size() / 4 * 3, Qt::Uninitialized);
+    int length = decodeBase64(value, data.data(), data.size());
+    if (length >= 0) {
+        data.resize(length);
+    } else {
+        data = QByteArray::fromBase64(value.toLatin1());
+    }
 
     if (isProtected && !data.isEmpty()) {
+        if (!m_randomStream) {
+            // Serialized history items are read without the inner stream, see readHistory()
+            const qint64 offset = takeProtectedOffset(data.size());
+            if (m_error || !m_keyStream->apply(offset, data.data(), data.size())) {
+                data.clear();
+                raiseError(tr("Invalid protected value"));
+            }
+            return data;
+        }
         bool ok;
         QByteArray plaintext = m_randomStream->process(data, &ok);
         if (!ok) {
@@ -1168,6 +1828,48 @@ QByteArray KdbxXmlReader::readCompressedBinary()
     return result;
 }
 
+/**
+ * Read the text of a non-string value element, reusing a buffer
+ * instead of allocating a new QString for every value.
+ * The result is only valid until the next value is read.
+ */
+const QString& KdbxXmlReader::readValueText()
+{
+    if (isTrueValue(m_xml.attributes().value(QLatin1String("Protected")))) {
+        m_textBuffer = readString();
+        return m_textBuffer;
+    }
+    return readElementTextBuffered();
+}
+
+/**
+ * Equivalent of QXmlStreamReader::readElementText() that
+ * collects the text into m_textBuffer.
+ */
+const QString& KdbxXmlReader::readElementTextBuffered()
+{
+    // resize() keeps the allocation, unlike clear()
+    m_textBuffer.resize(0);
+
+    while (!m_xml.atEnd()) {
+        switch (m_xml.readNext()) {
+        case QXmlStreamReader::Characters:
+        case QXmlStreamReader::EntityReference:
+            m_textBuffer.append(m_xml.text());
+            break;
+        case QXmlStreamReader::EndElement:
+            return m_textBuffer;
+        case QXmlStreamReader::StartElement:
+            m_xml.raiseError(QObject::tr("Expected character data."));
+            return m_textBuffer;
+        default:
+            break;
+        }
+    }
+
+    return m_textBuffer;
+}
+
 Group* KdbxXmlReader::getGroup(const QUuid& uuid)
 {
     if (uuid.isNull()) {
@@ -20,13 +20,18 @@
 
 #include "core/Database.h"
 #include "core/Metadata.h"
+#include "core/ProtectedValue.h"
 
 #include <QCoreApplication>
+#include <QSet>
 #include <QXmlStreamReader>
 
+#include <functional>
+
 class QIODevice;
 class Group;
 class Entry;
+class KdbxXmlHistory;
 class KeePass2RandomStream;
 class TimeInfo;
 
@@ -45,6 +50,7 @@ public:
     virtual QSharedPointer<Database> readDatabase(const QString& filename);
     virtual QSharedPointer<Database> readDatabase(QIODevice* device);
     virtual void readDatabase(QIODevice* device, Database* db, KeePass2RandomStream* randomStream = nullptr);
+    QList<Entry*> readHistory(const KdbxXmlHistory& history);
 
     bool hasError() const;
     QString errorString() const;
@@ -54,6 +60,9 @@ public:
     bool strictMode() const;
     void setStrictMode(bool strictMode);
 
+    using ProgressFunction = std::function<void(qint64 done, qint64 total)>;
+    void setProgressCallback(ProgressFunction progress);
+
 protected:
     typedef QPair<QString, QString> StringPair;
 
@@ -70,28 +79,36 @@ protected:
     virtual void parseDeletedObjects();
     virtual void parseDeletedObject();
     virtual Entry* parseEntry(bool history);
-    virtual void parseEntryString(Entry* entry);
+    virtual void parseEntryString(Entry* entry, bool history);
     virtual QPair<QString, QString> parseEntryBinary(Entry* entry);
     virtual void parseAutoType(Entry* entry);
     virtual void parseAutoTypeAssoc(Entry* entry);
     virtual QList<Entry*> parseEntryHistory();
+    virtual QSharedPointer<KdbxXmlHistory> captureEntryHistory();
     virtual TimeInfo parseTimes();
 
     virtual QString readString();
     virtual QString readString(bool& isProtected, bool& protectInMemory);
+    virtual ProtectedValue readProtectedValue();
+    qint64 takeProtectedOffset(int size);
     virtual bool readBool();
     virtual QDateTime readDateTime();
+    QDateTime parseDateTime(const QString& str);
     virtual QString readColor();
     virtual int readNumber();
     virtual QUuid readUuid();
     virtual QByteArray readBinary();
     virtual QByteArray readCompressedBinary();
+    const QString& readValueText();
+    const QString& readElementTextBuffered();
 
     virtual void skipCurrentElement();
 
     virtual Group* getGroup(const QUuid& uuid);
     virtual Entry* getEntry(const QUuid& uuid);
 
+    void reportProgress();
+
     virtual bool isTrueValue(const QStringRef& value);
     virtual void raiseError(const QString& errorMessage);
 
@@ -102,7 +119,15 @@ protected:
     QPointer<Database> m_db;
     QPointer<Metadata> m_meta;
     KeePass2RandomStream* m_randomStream = nullptr;
+    // Decrypts protected values that are left encrypted until they are accessed
+    QSharedPointer<const ProtectedValue::KeyStream> m_keyStream;
+    // Keep entry histories serialized, see KdbxXmlHistory
+    bool m_lazyHistory = false;
+    // Offsets of the protected values of a serialized history, which is read without the inner stream
+    QVector<qint64> m_protectedOffsets;
+    int m_nextProtectedOffset = 0;
     QXmlStreamReader m_xml;
+    QString m_textBuffer;
 
     QScopedPointer<Group> m_tmpParent;
     QHash<QUuid, Group*> m_groups;
@@ -110,8 +135,14 @@ protected:
 
     QHash<QString, QByteArray> m_binaryPool;
     QHash<QString, QPair<Entry*, QString>> m_binaryMap;
+    QSet<QString> m_serializedBinaryRefs;
     QByteArray m_headerHash;
 
+    ProgressFunction m_progress;
+    QIODevice* m_device = nullptr;
+    qint64 m_progressTotal = 0;
+    qint64 m_progressReported = 0;
+
     bool m_error = false;
     QString m_errorStr = "";
 };
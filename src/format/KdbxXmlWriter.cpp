@@ -17,17 +17,137 @@
 
 #include "KdbxXmlWriter.h"
 
-#include <QBuffer>
+#include <QDataStream>
 #include <QFile>
 #include <QMap>
+#include <QtEndian>
 
-#include "core/Endian.h"
-#include "crypto/CryptoHash.h"
+#include "core/Clock.h"
+#include "format/KdbxXmlHistory.h"
 #include "format/KeePass2RandomStream.h"
 #include "keeshare/KeeShare.h"
 #include "keeshare/KeeShareSettings.h"
 #include "streams/qtiocompressor.h"
 
+#include <botan/mem_ops.h>
+
+namespace
+{
+    /**
+     * Write-only device that base64-encodes everything written to it into the
+     * text of the current XML element, a bounded chunk at a time.
+     */
+    class Base64TextDevice : public QIODevice
+    {
+    public:
+        explicit Base64TextDevice(KdbxXmlOutput& xml)
+            : m_xml(xml)
+        {
+            open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+        }
+
+        void finish()
+        {
+            if (!m_pending.isEmpty()) {
+                m_xml.writeBase64Characters(m_pending.constData(), m_pending.size());
+                m_pending.clear();
+            }
+        }
+
+    protected:
+        qint64 readData(char* data, qint64 maxSize) override
+        {
+            Q_UNUSED(data);
+            Q_UNUSED(maxSize);
+            return -1;
+        }
+
+        qint64 writeData(const char* data, qint64 maxSize) override
+        {
+            qint64 offset = 0;
+            while (offset < maxSize) {
+                // chunks are a multiple of 3 bytes so they encode without padding
+                int bytesToCopy = static_cast<int>(qMin<qint64>(maxSize - offset, ChunkSize - m_pending.size()));
+                m_pending.append(data + offset, bytesToCopy);
+                offset += bytesToCopy;
+
+                if (m_pending.size() == ChunkSize) {
+                    m_xml.writeBase64Characters(m_pending.constData(), m_pending.size());
+                    m_pending.clear();
+                }
+            }
+            return maxSize;
+        }
+
+    private:
+        static const int ChunkSize = 3 * 16 * 1024;
+        KdbxXmlOutput& m_xml;
+        QByteArray m_pending;
+    };
+} // namespace
+
+/**
+ * Passes everything written to it on to the output device and records
+ * what is written while an entry is serialized for the entry cache.
+ */
+class KdbxXmlWriter::EntryRecorder : public QIODevice
+{
+public:
+    explicit EntryRecorder(QIODevice* device)
+        : m_device(device)
+    {
+        open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    }
+
+    void start()
+    {
+        m_pieces = {QByteArray()};
+        m_recording = true;
+    }
+
+    // Leave a gap in the recording, e.g. for a protected value
+    void pause()
+    {
+        m_recording = false;
+    }
+
+    void resume()
+    {
+        m_pieces.append(QByteArray());
+        m_recording = true;
+    }
+
+    QList<QByteArray> finish()
+    {
+        m_recording = false;
+        return std::move(m_pieces);
+    }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override
+    {
+        Q_UNUSED(data);
+        Q_UNUSED(maxSize);
+        return -1;
+    }
+
+    qint64 writeData(const char* data, qint64 maxSize) override
+    {
+        qint64 bytesWritten = m_device->write(data, maxSize);
+        if (bytesWritten < 0) {
+            setErrorString(m_device->errorString());
+        } else if (m_recording) {
+            m_pieces.last().append(data, static_cast<int>(bytesWritten));
+        }
+        return bytesWritten;
+    }
+
+private:
+    QIODevice* m_device;
+    QList<QByteArray> m_pieces;
+    bool m_recording = false;
+};
+
 /**
  * @param version KDBX version
  */
@@ -45,6 +165,29 @@ KdbxXmlWriter::KdbxXmlWriter(quint32 version, KdbxXmlWriter::BinaryIdxMap binary
 {
 }
 
+KdbxXmlWriter::~KdbxXmlWriter() = default;
+
+KdbxXmlEntryCache::~KdbxXmlEntryCache()
+{
+    clear();
+}
+
+/**
+ * Drop all fragments, overwriting those that are not shared with another cache.
+ */
+void KdbxXmlEntryCache::clear()
+{
+    for (auto& fragment : fragments) {
+        for (auto& piece : fragment.pieces) {
+            // Shared pieces are still in use and scrubbed by their last owner
+            if (piece.isDetached()) {
+                Botan::secure_scrub_memory(piece.data(), piece.size());
+            }
+        }
+    }
+    fragments.clear();
+}
+
 void KdbxXmlWriter::writeDatabase(QIODevice* device,
                                   const Database* db,
                                   KeePass2RandomStream* randomStream,
@@ -55,17 +198,22 @@ void KdbxXmlWriter::writeDatabase(QIODevice* device,
     m_randomStream = randomStream;
     m_headerHash = headerHash;
 
-    m_xml.setAutoFormatting(true);
-    m_xml.setAutoFormattingIndent(-1); // 1 tab
-    m_xml.setCodec("UTF-8");
-
     if (m_kdbxVersion < KeePass2::FILE_VERSION_4) {
         fillBinaryIdxMap();
     }
 
-    m_xml.setDevice(device);
-    m_xml.writeStartDocument("1.0", true);
-    m_xml.writeStartElement("KeePassFile");
+    // Only saves use the cache, exports would keep unprotected values around
+    m_entryCache = m_randomStream && !m_innerStreamProtectionDisabled ? db->xmlEntryCache() : nullptr;
+    m_entryCacheLookups = {};
+    if (m_entryCache) {
+        m_recorder.reset(new EntryRecorder(device));
+        m_xml.setDevice(m_recorder.data());
+    } else {
+        m_xml.setDevice(device);
+    }
+
+    m_xml.writeStartDocument();
+    m_xml.writeStartElement(QLatin1String("KeePassFile"));
 
     writeMetadata();
     writeRoot();
@@ -76,6 +224,16 @@ void KdbxXmlWriter::writeDatabase(QIODevice* device,
     if (m_xml.hasError()) {
         raiseError(device->errorString());
     }
+
+    if (m_entryCache) {
+        // Entries that were not written anymore are dropped from the cache
+        m_entryCache->clear();
+        if (!m_error) {
+            m_entryCache->fragments = m_writtenFragments;
+        }
+        m_writtenFragments.clear();
+        db->counters().setEntryCacheLookups(m_entryCacheLookups);
+    }
 }
 
 void KdbxXmlWriter::writeDatabase(const QString& filename, Database* db)
@@ -102,27 +260,26 @@ QString KdbxXmlWriter::errorString()
  */
 void KdbxXmlWriter::fillBinaryIdxMap()
 {
-    const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(true);
+    const QList<Entry*> allEntries = KdbxXmlHistory::entriesWithAttachments(m_db->rootGroup());
     QHash<QByteArray, qint64> writtenAttachments;
     qint64 nextIdx = 0;
 
     for (Entry* entry : allEntries) {
         const QList<QString> attachmentKeys = entry->attachments()->keys();
         for (const QString& key : attachmentKeys) {
-            QByteArray data = entry->attachments()->value(key);
-            CryptoHash hash(CryptoHash::Sha256);
+            // Reuse the cached content hash of the attachment
+            QByteArray hashResult;
 #ifdef WITH_XC_KEESHARE
             // Namespace KeeShare attachments so they don't get deduplicated together with attachments
             // from other databases. Prevents potential filesize side channels.
             if (auto shared = KeeShare::resolveSharedGroup(entry->group())) {
-                hash.addData(KeeShare::referenceOf(shared).uuid.toByteArray());
+                hashResult.append(KeeShare::referenceOf(shared).uuid.toByteArray());
             } else {
-                hash.addData(m_db->uuid().toByteArray());
+                hashResult.append(m_db->uuid().toByteArray());
             }
 #endif
-            hash.addData(data);
+            hashResult.append(entry->attachments()->hash(key));
 
-            const auto hashResult = hash.result();
             if (!writtenAttachments.contains(hashResult)) {
                 writtenAttachments.insert(hashResult, nextIdx++);
             }
@@ -133,7 +290,7 @@ void KdbxXmlWriter::fillBinaryIdxMap()
 
 void KdbxXmlWriter::writeMetadata()
 {
-    m_xml.writeStartElement("Meta");
+    m_xml.writeStartElement(QLatin1String("Meta"));
     writeString("Generator", m_meta->generator());
     if (m_kdbxVersion < KeePass2::FILE_VERSION_4 && !m_headerHash.isEmpty()) {
         writeBinary("HeaderHash", m_headerHash);
@@ -173,7 +330,7 @@ void KdbxXmlWriter::writeMetadata()
 
 void KdbxXmlWriter::writeMemoryProtection()
 {
-    m_xml.writeStartElement("MemoryProtection");
+    m_xml.writeStartElement(QLatin1String("MemoryProtection"));
 
     writeBool("ProtectTitle", m_meta->protectTitle());
     writeBool("ProtectUserName", m_meta->protectUsername());
@@ -186,7 +343,7 @@ void KdbxXmlWriter::writeMemoryProtection()
 
 void KdbxXmlWriter::writeCustomIcons()
 {
-    m_xml.writeStartElement("CustomIcons");
+    m_xml.writeStartElement(QLatin1String("CustomIcons"));
 
     const QList<QUuid> customIconsOrder = m_meta->customIconsOrder();
     for (const QUuid& uuid : customIconsOrder) {
@@ -198,7 +355,7 @@ void KdbxXmlWriter::writeCustomIcons()
 
 void KdbxXmlWriter::writeIcon(const QUuid& uuid, const Metadata::CustomIconData& iconData)
 {
-    m_xml.writeStartElement("Icon");
+    m_xml.writeStartElement(QLatin1String("Icon"));
 
     writeUuid("UUID", uuid);
     if (m_kdbxVersion >= KeePass2::FILE_VERSION_4_1) {
@@ -224,36 +381,33 @@ void KdbxXmlWriter::writeBinaries()
         }
     }
 
-    m_xml.writeStartElement("Binaries");
+    m_xml.writeStartElement(QLatin1String("Binaries"));
 
     for (auto i = binaries.constBegin(); i != binaries.constEnd(); ++i) {
-        m_xml.writeStartElement("Binary");
-        m_xml.writeAttribute("ID", QString::number(i.key()));
+        m_xml.writeStartElement(QLatin1String("Binary"));
+        const QByteArray id = QByteArray::number(i.key());
+        m_xml.writeAttribute(QLatin1String("ID"), QLatin1String(id));
 
-        QByteArray data;
+        // Encode straight into the XML output instead of materializing
+        // the compressed and base64-encoded copies of the attachment
+        const QByteArray& data = i.value();
         if (m_db->compressionAlgorithm() == Database::CompressionGZip) {
-            m_xml.writeAttribute("Compressed", "True");
-
-            QBuffer buffer;
-            buffer.open(QIODevice::ReadWrite);
+            m_xml.writeAttribute(QLatin1String("Compressed"), QLatin1String("True"));
 
-            QtIOCompressor compressor(&buffer);
+            Base64TextDevice text(m_xml);
+            QtIOCompressor compressor(&text, m_db->compressionLevel());
             compressor.setStreamFormat(QtIOCompressor::GzipFormat);
             compressor.open(QIODevice::WriteOnly);
 
-            qint64 bytesWritten = compressor.write(i.value());
-            Q_ASSERT(bytesWritten == i.value().size());
+            qint64 bytesWritten = compressor.write(data);
+            Q_ASSERT(bytesWritten == data.size());
             Q_UNUSED(bytesWritten);
             compressor.close();
-
-            buffer.seek(0);
-            data = buffer.readAll();
-        } else {
-            data = i.value();
-        }
-
-        if (!data.isEmpty()) {
-            m_xml.writeCharacters(QString::fromLatin1(data.toBase64()));
+            text.finish();
+        } else if (!data.isEmpty()) {
+            Base64TextDevice text(m_xml);
+            text.write(data);
+            text.finish();
         }
         m_xml.writeEndElement();
     }
@@ -266,7 +420,7 @@ void KdbxXmlWriter::writeCustomData(const CustomData* customData, bool writeItem
     if (customData->isEmpty()) {
         return;
     }
-    m_xml.writeStartElement("CustomData");
+    m_xml.writeStartElement(QLatin1String("CustomData"));
 
     const QList<QString> keyList = customData->keys();
     for (const QString& key : keyList) {
@@ -280,7 +434,7 @@ void KdbxXmlWriter::writeCustomDataItem(const QString& key,
                                         const CustomData::CustomDataItem& item,
                                         bool writeLastModified)
 {
-    m_xml.writeStartElement("Item");
+    m_xml.writeStartElement(QLatin1String("Item"));
 
     writeString("Key", key);
     writeString("Value", item.value);
@@ -295,7 +449,7 @@ void KdbxXmlWriter::writeRoot()
 {
     Q_ASSERT(m_db->rootGroup());
 
-    m_xml.writeStartElement("Root");
+    m_xml.writeStartElement(QLatin1String("Root"));
 
     writeGroup(m_db->rootGroup());
     writeDeletedObjects();
@@ -307,7 +461,8 @@ void KdbxXmlWriter::writeGroup(const Group* group)
 {
     Q_ASSERT(!group->uuid().isNull());
 
-    m_xml.writeStartElement("Group");
+    m_xml.writeStartElement(QLatin1String("Group"));
+    ++m_groupDepth;
 
     writeUuid("UUID", group->uuid());
     writeString("Name", group->name());
@@ -347,12 +502,13 @@ void KdbxXmlWriter::writeGroup(const Group* group)
         writeGroup(child);
     }
 
+    --m_groupDepth;
     m_xml.writeEndElement();
 }
 
 void KdbxXmlWriter::writeTimes(const TimeInfo& ti)
 {
-    m_xml.writeStartElement("Times");
+    m_xml.writeStartElement(QLatin1String("Times"));
 
     writeDateTime("LastModificationTime", ti.lastModificationTime());
     writeDateTime("CreationTime", ti.creationTime());
@@ -367,7 +523,7 @@ void KdbxXmlWriter::writeTimes(const TimeInfo& ti)
 
 void KdbxXmlWriter::writeDeletedObjects()
 {
-    m_xml.writeStartElement("DeletedObjects");
+    m_xml.writeStartElement(QLatin1String("DeletedObjects"));
 
     const QList<DeletedObject> delObjList = m_db->deletedObjects();
     for (const DeletedObject& delObj : delObjList) {
@@ -379,7 +535,7 @@ void KdbxXmlWriter::writeDeletedObjects()
 
 void KdbxXmlWriter::writeDeletedObject(const DeletedObject& delObj)
 {
-    m_xml.writeStartElement("DeletedObject");
+    m_xml.writeStartElement(QLatin1String("DeletedObject"));
 
     writeUuid("UUID", delObj.uuid);
     writeDateTime("DeletionTime", delObj.deletionTime);
@@ -388,10 +544,152 @@ void KdbxXmlWriter::writeDeletedObject(const DeletedObject& delObj)
 }
 
 void KdbxXmlWriter::writeEntry(const Entry* entry)
+{
+    // Serialized history items that cannot be copied as they are are loaded first
+    if (entry->parent() && entry->serializedHistory() && !writableHistory(entry)) {
+        entry->historyItems();
+    }
+
+    // Entries are cached together with their history items
+    if (!m_entryCache || !entry->parent()) {
+        serializeEntry(entry);
+        return;
+    }
+
+    KdbxXmlEntryCache::Fragment fragment = m_entryCache->fragments.value(entry->uuid());
+    const QByteArray key = entryCacheKey(entry);
+    if (fragment.key == key && writeCachedEntry(entry, fragment.pieces)) {
+        ++m_entryCacheLookups.hits;
+    } else {
+        ++m_entryCacheLookups.misses;
+        m_xml.flush();
+        m_recorder->start();
+        serializeEntry(entry);
+        m_xml.flush();
+        fragment.key = key;
+        fragment.pieces = m_recorder->finish();
+    }
+    m_writtenFragments.insert(entry->uuid(), fragment);
+}
+
+/**
+ * Write an entry from the cache, encrypting its protected values into the gaps.
+ *
+ * @return false if the cached entry does not fit, nothing is written then
+ */
+bool KdbxXmlWriter::writeCachedEntry(const Entry* entry, const QList<QByteArray>& pieces)
+{
+    QStringList values;
+    collectProtectedValues(entry, values);
+    if (pieces.isEmpty() || values.size() != pieces.size() - 1) {
+        return false;
+    }
+
+    for (int i = 0; i < pieces.size(); ++i) {
+        if (i > 0) {
+            bool ok;
+            QByteArray rawData = m_randomStream->process(values[i - 1].toUtf8(), &ok);
+            if (!ok) {
+                raiseError(m_randomStream->errorString());
+            }
+            // Base64 needs no escaping, so this is what the XML writer would write
+            m_xml.writeRaw(rawData.toBase64());
+        }
+        m_xml.writeRaw(pieces[i]);
+    }
+    return true;
+}
+
+/**
+ * Everything a serialized entry depends on, including its position in the
+ * tree which determines the indentation.
+ */
+QByteArray KdbxXmlWriter::entryCacheKey(const Entry* entry) const
+{
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+    stream << m_kdbxVersion << m_groupDepth << m_meta->protectTitle() << m_meta->protectUsername()
+           << m_meta->protectPassword() << m_meta->protectUrl() << m_meta->protectNotes();
+
+    QList<const Entry*> items{entry};
+    if (const KdbxXmlHistory* history = writableHistory(entry)) {
+        stream << history->serial();
+    } else {
+        for (const Entry* item : entry->historyItems()) {
+            items.append(item);
+        }
+    }
+    for (const Entry* item : asConst(items)) {
+        // The fingerprint leaves out the location, which is written to the file nonetheless
+        stream << item->fingerprint() << item->previousParentGroupUuid()
+               << Clock::serialized(item->timeInfo().locationChanged()).toMSecsSinceEpoch();
+        const QList<QString> attachmentKeys = item->attachments()->keys();
+        for (const QString& attachmentKey : attachmentKeys) {
+            stream << m_binaryIdxMap.value(qMakePair(item, attachmentKey));
+        }
+    }
+    return key;
+}
+
+void KdbxXmlWriter::collectProtectedValues(const Entry* entry, QStringList& values) const
+{
+    const QList<QString> keys = entry->attributes()->keys();
+    for (const QString& key : keys) {
+        if (isProtected(entry, key)) {
+            values.append(entry->attributes()->value(key));
+        }
+    }
+
+    if (!entry->parent()) {
+        return;
+    }
+    if (const KdbxXmlHistory* history = writableHistory(entry)) {
+        values.append(history->protectedValues());
+        return;
+    }
+    for (const Entry* item : entry->historyItems()) {
+        collectProtectedValues(item, values);
+    }
+}
+
+/**
+ * @return the serialized history of an entry if it can be copied into the
+ * file as it is, otherwise nullptr
+ */
+const KdbxXmlHistory* KdbxXmlWriter::writableHistory(const Entry* entry) const
+{
+    const auto* history = dynamic_cast<const KdbxXmlHistory*>(entry->serializedHistory().data());
+    if (!history || !m_randomStream || m_innerStreamProtectionDisabled) {
+        return nullptr;
+    }
+    // Attachment references and the format of the items depend on the file
+    if (history->hasAttachments || history->kdbxVersion != m_kdbxVersion) {
+        return nullptr;
+    }
+    const QVector<bool> memoryProtection = {m_meta->protectTitle(),
+                                            m_meta->protectUsername(),
+                                            m_meta->protectPassword(),
+                                            m_meta->protectUrl(),
+                                            m_meta->protectNotes()};
+    return history->memoryProtection == memoryProtection ? history : nullptr;
+}
+
+bool KdbxXmlWriter::isProtected(const Entry* entry, const QString& key) const
+{
+    // clang-format off
+    return ((key == "Title") && m_meta->protectTitle()) || ((key == "UserName") && m_meta->protectUsername())
+        || ((key == "Password") && m_meta->protectPassword())
+        || ((key == "URL") && m_meta->protectUrl())
+        || ((key == "Notes") && m_meta->protectNotes())
+        || entry->attributes()->isProtected(key);
+    // clang-format on
+}
+
+void KdbxXmlWriter::serializeEntry(const Entry* entry)
 {
     Q_ASSERT(!entry->uuid().isNull());
 
-    m_xml.writeStartElement("Entry");
+    m_xml.writeStartElement(QLatin1String("Entry"));
 
     writeUuid("UUID", entry->uuid());
     writeNumber("IconID", entry->iconNumber());
@@ -415,41 +713,25 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
 
     const QList<QString> attributesKeyList = entry->attributes()->keys();
     for (const QString& key : attributesKeyList) {
-        m_xml.writeStartElement("String");
+        m_xml.writeStartElement(QLatin1String("String"));
 
-        // clang-format off
-        bool protect =
-            (((key == "Title") && m_meta->protectTitle()) || ((key == "UserName") && m_meta->protectUsername())
-            || ((key == "Password") && m_meta->protectPassword())
-            || ((key == "URL") && m_meta->protectUrl())
-            || ((key == "Notes") && m_meta->protectNotes())
-            || entry->attributes()->isProtected(key));
-        // clang-format on
+        bool protect = isProtected(entry, key);
 
         writeString("Key", key);
 
-        m_xml.writeStartElement("Value");
-        QString value;
+        m_xml.writeStartElement(QLatin1String("Value"));
+        const QString value = entry->attributes()->value(key);
 
-        if (protect) {
-            if (!m_innerStreamProtectionDisabled && m_randomStream) {
-                m_xml.writeAttribute("Protected", "True");
-                bool ok;
-                QByteArray rawData = m_randomStream->process(entry->attributes()->value(key).toUtf8(), &ok);
-                if (!ok) {
-                    raiseError(m_randomStream->errorString());
-                }
-                value = QString::fromLatin1(rawData.toBase64());
-            } else {
-                m_xml.writeAttribute("ProtectInMemory", "True");
-                value = entry->attributes()->value(key);
-            }
+        if (protect && !m_innerStreamProtectionDisabled && m_randomStream) {
+            m_xml.writeAttribute(QLatin1String("Protected"), QLatin1String("True"));
+            writeProtectedCharacters(value);
         } else {
-            value = entry->attributes()->value(key);
-        }
-
-        if (!value.isEmpty()) {
-            m_xml.writeCharacters(stripInvalidXml10Chars(value));
+            if (protect) {
+                m_xml.writeAttribute(QLatin1String("ProtectInMemory"), QLatin1String("True"));
+            }
+            if (!value.isEmpty()) {
+                m_xml.writeCharacters(stripInvalidXml10Chars(value));
+            }
         }
         m_xml.writeEndElement();
 
@@ -458,12 +740,13 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
 
     const QList<QString> attachmentsKeyList = entry->attachments()->keys();
     for (const QString& key : attachmentsKeyList) {
-        m_xml.writeStartElement("Binary");
+        m_xml.writeStartElement(QLatin1String("Binary"));
 
         writeString("Key", key);
 
-        m_xml.writeStartElement("Value");
-        m_xml.writeAttribute("Ref", QString::number(m_binaryIdxMap[qMakePair(entry, key)]));
+        m_xml.writeStartElement(QLatin1String("Value"));
+        const QByteArray ref = QByteArray::number(m_binaryIdxMap[qMakePair(entry, key)]);
+        m_xml.writeAttribute(QLatin1String("Ref"), QLatin1String(ref));
         m_xml.writeEndElement();
 
         m_xml.writeEndElement();
@@ -483,9 +766,34 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
     m_xml.writeEndElement();
 }
 
+/**
+ * Encrypt a protected value into the text of the current element.
+ */
+void KdbxXmlWriter::writeProtectedCharacters(const QString& value)
+{
+    if (m_recorder) {
+        // Cached entries have a gap here, see writeCachedEntry()
+        m_xml.writeCharacters({});
+        m_xml.flush();
+        m_recorder->pause();
+    }
+    bool ok;
+    QByteArray rawData = m_randomStream->process(value.toUtf8(), &ok);
+    if (!ok) {
+        raiseError(m_randomStream->errorString());
+    }
+    if (!rawData.isEmpty()) {
+        m_xml.writeBase64Characters(rawData.constData(), rawData.size());
+    }
+    if (m_recorder) {
+        m_xml.flush();
+        m_recorder->resume();
+    }
+}
+
 void KdbxXmlWriter::writeAutoType(const Entry* entry)
 {
-    m_xml.writeStartElement("AutoType");
+    m_xml.writeStartElement(QLatin1String("AutoType"));
 
     writeBool("Enabled", entry->autoTypeEnabled());
     writeNumber("DataTransferObfuscation", entry->autoTypeObfuscation());
@@ -501,7 +809,7 @@ void KdbxXmlWriter::writeAutoType(const Entry* entry)
 
 void KdbxXmlWriter::writeAutoTypeAssoc(const AutoTypeAssociations::Association& assoc)
 {
-    m_xml.writeStartElement("Association");
+    m_xml.writeStartElement(QLatin1String("Association"));
 
     writeString("Window", assoc.window);
     writeString("KeystrokeSequence", assoc.sequence);
@@ -511,101 +819,135 @@ void KdbxXmlWriter::writeAutoTypeAssoc(const AutoTypeAssociations::Association&
 
 void KdbxXmlWriter::writeEntryHistory(const Entry* entry)
 {
-    m_xml.writeStartElement("History");
+    m_xml.writeStartElement(QLatin1String("History"));
 
-    const QList<Entry*>& historyItems = entry->historyItems();
-    for (const Entry* item : historyItems) {
-        writeEntry(item);
+    if (const KdbxXmlHistory* history = writableHistory(entry)) {
+        // Copied as it was read, only the protected values are encrypted again
+        m_xml.writeCharacters({});
+        const QStringList values = history->protectedValues();
+        for (int i = 0; i < history->pieces.size(); ++i) {
+            if (i > 0) {
+                writeProtectedCharacters(values.at(i - 1));
+            }
+            m_xml.writeRaw(history->pieces.at(i));
+        }
+    } else {
+        const QList<Entry*>& historyItems = entry->historyItems();
+        for (const Entry* item : historyItems) {
+            writeEntry(item);
+        }
     }
 
     m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeString(const QString& qualifiedName, const QString& string)
+void KdbxXmlWriter::writeString(const char* name, const QString& string)
 {
     if (string.isEmpty()) {
-        m_xml.writeEmptyElement(qualifiedName);
+        m_xml.writeEmptyElement(QLatin1String(name));
     } else {
-        m_xml.writeTextElement(qualifiedName, stripInvalidXml10Chars(string));
+        m_xml.writeStartElement(QLatin1String(name));
+        m_xml.writeCharacters(stripInvalidXml10Chars(string));
+        m_xml.writeEndElement();
     }
 }
 
-void KdbxXmlWriter::writeNumber(const QString& qualifiedName, int number)
+void KdbxXmlWriter::writeLatin1(const char* name, QLatin1String string)
 {
-    writeString(qualifiedName, QString::number(number));
+    m_xml.writeStartElement(QLatin1String(name));
+    m_xml.writeLatin1Characters(string.data(), string.size());
+    m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeBool(const QString& qualifiedName, bool b)
+void KdbxXmlWriter::writeNumber(const char* name, int number)
+{
+    m_xml.writeStartElement(QLatin1String(name));
+    m_xml.writeNumberCharacters(number);
+    m_xml.writeEndElement();
+}
+
+void KdbxXmlWriter::writeBool(const char* name, bool b)
 {
     if (b) {
-        writeString(qualifiedName, "True");
+        writeLatin1(name, QLatin1String("True"));
     } else {
-        writeString(qualifiedName, "False");
+        writeLatin1(name, QLatin1String("False"));
     }
 }
 
-void KdbxXmlWriter::writeDateTime(const QString& qualifiedName, const QDateTime& dateTime)
+void KdbxXmlWriter::writeDateTime(const char* name, const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.isValid());
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
 
-    QString dateTimeStr;
     if (m_kdbxVersion < KeePass2::FILE_VERSION_4) {
-        dateTimeStr = dateTime.toString(Qt::ISODate);
+        QString dateTimeStr = dateTime.toString(Qt::ISODate);
 
         // Qt < 4.8 doesn't append a 'Z' at the end
         if (!dateTimeStr.isEmpty() && dateTimeStr[dateTimeStr.size() - 1] != 'Z') {
             dateTimeStr.append('Z');
         }
-    } else {
-        qint64 secs = QDateTime(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC).secsTo(dateTime);
-        QByteArray secsBytes = Endian::sizedIntToBytes(secs, KeePass2::BYTEORDER);
-        dateTimeStr = QString::fromLatin1(secsBytes.toBase64());
+        writeString(name, dateTimeStr);
+        return;
     }
-    writeString(qualifiedName, dateTimeStr);
+
+    // Seconds since 0001-01-01T00:00:00Z, same as QDateTime::secsTo() from there
+    const qint64 msecsTo1970 = Q_INT64_C(62135596800000);
+    const qint64 secs = (dateTime.toMSecsSinceEpoch() + msecsTo1970) / 1000;
+    static_assert(KeePass2::BYTEORDER == QSysInfo::LittleEndian, "KDBX 4 timestamps are little endian");
+    char secsBytes[sizeof(secs)];
+    qToLittleEndian<qint64>(secs, secsBytes);
+
+    m_xml.writeStartElement(QLatin1String(name));
+    m_xml.writeBase64Characters(secsBytes, sizeof(secsBytes));
+    m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const QUuid& uuid)
+void KdbxXmlWriter::writeUuid(const char* name, const QUuid& uuid)
 {
-    writeString(qualifiedName, uuid.toRfc4122().toBase64());
+    m_xml.writeStartElement(QLatin1String(name));
+    m_xml.writeUuidCharacters(uuid);
+    m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Group* group)
+void KdbxXmlWriter::writeUuid(const char* name, const Group* group)
 {
     if (group) {
-        writeUuid(qualifiedName, group->uuid());
+        writeUuid(name, group->uuid());
     } else {
-        writeUuid(qualifiedName, QUuid());
+        writeUuid(name, QUuid());
     }
 }
 
-void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Entry* entry)
+void KdbxXmlWriter::writeUuid(const char* name, const Entry* entry)
 {
     if (entry) {
-        writeUuid(qualifiedName, entry->uuid());
+        writeUuid(name, entry->uuid());
     } else {
-        writeUuid(qualifiedName, QUuid());
+        writeUuid(name, QUuid());
     }
 }
 
-void KdbxXmlWriter::writeBinary(const QString& qualifiedName, const QByteArray& ba)
+void KdbxXmlWriter::writeBinary(const char* name, const QByteArray& ba)
 {
-    writeString(qualifiedName, QString::fromLatin1(ba.toBase64()));
+    if (ba.isEmpty()) {
+        m_xml.writeEmptyElement(QLatin1String(name));
+    } else {
+        m_xml.writeStartElement(QLatin1String(name));
+        m_xml.writeBase64Characters(ba.constData(), ba.size());
+        m_xml.writeEndElement();
+    }
 }
 
-void KdbxXmlWriter::writeTriState(const QString& qualifiedName, Group::TriState triState)
+void KdbxXmlWriter::writeTriState(const char* name, Group::TriState triState)
 {
-    QString value;
-
     if (triState == Group::Inherit) {
-        value = "null";
+        writeLatin1(name, QLatin1String("null"));
     } else if (triState == Group::Enable) {
-        value = "true";
+        writeLatin1(name, QLatin1String("true"));
     } else {
-        value = "false";
+        writeLatin1(name, QLatin1String("false"));
     }
-
-    writeString(qualifiedName, value);
 }
 
 QString KdbxXmlWriter::colorPartToString(int value)
@@ -19,14 +19,40 @@
 #define KEEPASSX_KDBXXMLWRITER_H
 
 #include <QDateTime>
-#include <QXmlStreamWriter>
 
 #include "core/CustomData.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "format/KdbxXmlOutput.h"
 
+class KdbxXmlHistory;
 class KeePass2RandomStream;
 
+/**
+ * Serialized entries of the last save of a database. Entries that did not change
+ * since are copied from here instead of being serialized again.
+ *
+ * The fragments hold entry fields in plain text, so they are overwritten once
+ * no longer used by any cache.
+ */
+struct KdbxXmlEntryCache
+{
+    struct Fragment
+    {
+        QByteArray key;
+        // Protected values are left out, their encryption differs on every save
+        QList<QByteArray> pieces;
+    };
+
+    KdbxXmlEntryCache() = default;
+    ~KdbxXmlEntryCache();
+    Q_DISABLE_COPY(KdbxXmlEntryCache)
+
+    void clear();
+
+    QHash<QUuid, Fragment> fragments;
+};
+
 class KdbxXmlWriter
 {
 public:
@@ -37,6 +63,7 @@ public:
 
     explicit KdbxXmlWriter(quint32 version);
     explicit KdbxXmlWriter(quint32 version, KdbxXmlWriter::BinaryIdxMap binaryIdxMap);
+    ~KdbxXmlWriter();
 
     void writeDatabase(QIODevice* device,
                        const Database* db,
@@ -65,19 +92,27 @@ private:
     void writeDeletedObjects();
     void writeDeletedObject(const DeletedObject& delObj);
     void writeEntry(const Entry* entry);
+    void serializeEntry(const Entry* entry);
+    bool writeCachedEntry(const Entry* entry, const QList<QByteArray>& pieces);
+    QByteArray entryCacheKey(const Entry* entry) const;
+    void collectProtectedValues(const Entry* entry, QStringList& values) const;
+    const KdbxXmlHistory* writableHistory(const Entry* entry) const;
+    bool isProtected(const Entry* entry, const QString& key) const;
     void writeAutoType(const Entry* entry);
     void writeAutoTypeAssoc(const AutoTypeAssociations::Association& assoc);
     void writeEntryHistory(const Entry* entry);
-
-    void writeString(const QString& qualifiedName, const QString& string);
-    void writeNumber(const QString& qualifiedName, int number);
-    void writeBool(const QString& qualifiedName, bool b);
-    void writeDateTime(const QString& qualifiedName, const QDateTime& dateTime);
-    void writeUuid(const QString& qualifiedName, const QUuid& uuid);
-    void writeUuid(const QString& qualifiedName, const Group* group);
-    void writeUuid(const QString& qualifiedName, const Entry* entry);
-    void writeBinary(const QString& qualifiedName, const QByteArray& ba);
-    void writeTriState(const QString& qualifiedName, Group::TriState triState);
+    void writeProtectedCharacters(const QString& value);
+
+    void writeString(const char* name, const QString& string);
+    void writeLatin1(const char* name, QLatin1String string);
+    void writeNumber(const char* name, int number);
+    void writeBool(const char* name, bool b);
+    void writeDateTime(const char* name, const QDateTime& dateTime);
+    void writeUuid(const char* name, const QUuid& uuid);
+    void writeUuid(const char* name, const Group* group);
+    void writeUuid(const char* name, const Entry* entry);
+    void writeBinary(const char* name, const QByteArray& ba);
+    void writeTriState(const char* name, Group::TriState triState);
     QString colorPartToString(int value);
     QString stripInvalidXml10Chars(QString str);
 
@@ -87,13 +122,20 @@ private:
 
     bool m_innerStreamProtectionDisabled = false;
 
-    QXmlStreamWriter m_xml;
+    KdbxXmlOutput m_xml;
     QPointer<const Database> m_db;
     QPointer<const Metadata> m_meta;
     KeePass2RandomStream* m_randomStream = nullptr;
     BinaryIdxMap m_binaryIdxMap;
     QByteArray m_headerHash;
 
+    KdbxXmlEntryCache* m_entryCache = nullptr;
+    QHash<QUuid, KdbxXmlEntryCache::Fragment> m_writtenFragments;
+    DatabaseCounters::CacheLookups m_entryCacheLookups;
+    class EntryRecorder;
+    QScopedPointer<EntryRecorder> m_recorder;
+    int m_groupDepth = 0;
+
     bool m_error = false;
 
     QString m_errorStr = "";
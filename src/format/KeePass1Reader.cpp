@@ -21,14 +21,31 @@
 #include <QFileInfo>
 #include <QTextCodec>
 
+#include <cstring>
+
 #include "core/Endian.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "crypto/CryptoHash.h"
 #include "format/KeePass1.h"
+#include "crypto/SymmetricCipher.h"
 #include "keys/FileKey.h"
-#include "streams/SymmetricCipherStream.h"
+
+namespace
+{
+    // Size of a field header: the type and the size of its data
+    const int FIELD_HEADER_SIZE = 6;
+
+    /**
+     * Decode a zero terminated string field.
+     */
+    QString fieldString(const char* data, quint32 size)
+    {
+        const auto* terminator = static_cast<const char*>(std::memchr(data, '\0', size));
+        return QString::fromUtf8(data, static_cast<int>(terminator ? terminator - data : size));
+    }
+} // namespace
 
 class KeePass1Key : public CompositeKey
 {
@@ -159,17 +176,32 @@ KeePass1Reader::readDatabase(QIODevice* device, const QString& password, QIODevi
     kdf->setSeed(m_transformSeed);
     db->setKdf(kdf);
 
-    qint64 contentPos = m_device->pos();
-
-    QScopedPointer<SymmetricCipherStream> cipherStream(testKeys(password, keyfileData, contentPos));
-
-    if (!cipherStream) {
+    // The content is decrypted once and parsed straight from memory
+    QByteArray content;
+    if (!decryptContent(password, keyfileData, content)) {
         return {};
     }
 
+    // Every group and entry has at least an end of record field, which bounds the counts of damaged headers
+    const int maxRecords = content.size() / FIELD_HEADER_SIZE;
+    const int groupCount = static_cast<int>(qMin<quint32>(numGroups, maxRecords));
+    const int entryCount = static_cast<int>(qMin<quint32>(numEntries, maxRecords));
+    m_groupIds.clear();
+    m_groupIds.reserve(groupCount);
+    m_groupLevels.clear();
+    m_groupLevels.reserve(groupCount);
+    m_entryUuids.clear();
+    m_entryUuids.reserve(entryCount);
+    m_entryGroupIds.clear();
+    m_entryGroupIds.reserve(entryCount);
+
+    const char* pos = content.constData();
+    const char* const end = pos + content.size();
+
     QList<Group*> groups;
+    groups.reserve(groupCount);
     for (quint32 i = 0; i < numGroups; i++) {
-        Group* group = readGroup(cipherStream.data());
+        Group* group = readGroup(pos, end);
         if (!group) {
             return {};
         }
@@ -177,14 +209,17 @@ KeePass1Reader::readDatabase(QIODevice* device, const QString& password, QIODevi
     }
 
     QList<Entry*> entries;
+    entries.reserve(entryCount);
     for (quint32 i = 0; i < numEntries; i++) {
-        Entry* entry = readEntry(cipherStream.data());
+        Entry* entry = readEntry(pos, end);
         if (!entry) {
             return {};
         }
         entries.append(entry);
     }
 
+    content.fill('\0');
+
     if (!constructGroupTree(groups)) {
         raiseError(tr("Unable to construct group tree"));
         return {};
@@ -293,12 +328,18 @@ QString KeePass1Reader::errorString()
     return m_errorStr;
 }
 
-SymmetricCipherStream*
-KeePass1Reader::testKeys(const QString& password, const QByteArray& keyfileData, qint64 contentPos)
+/**
+ * Decrypt the content following the header, trying the password in the
+ * encodings used by the different KeePass 1 and KeePassX versions.
+ *
+ * @param content set to the decrypted content on success
+ */
+bool KeePass1Reader::decryptContent(const QString& password, const QByteArray& keyfileData, QByteArray& content)
 {
     const QList<PasswordEncoding> encodings = {Windows1252, Latin1, UTF8};
 
-    QScopedPointer<SymmetricCipherStream> cipherStream;
+    const QByteArray encrypted = m_device->readAll();
+
     QByteArray passwordData;
     QTextCodec* codec = QTextCodec::codecForName("Windows-1252");
     QByteArray passwordDataCorrect = codec->fromUnicode(password);
@@ -330,56 +371,63 @@ KeePass1Reader::testKeys(const QString& password, const QByteArray& keyfileData,
 
         QByteArray finalKey = key(passwordData, keyfileData);
         if (finalKey.isEmpty()) {
-            return nullptr;
+            return false;
         }
 
-        cipherStream.reset(new SymmetricCipherStream(m_device));
-
-        auto mode = SymmetricCipher::Aes256_CBC;
-        if (m_encryptionFlags & KeePass1::Twofish) {
-            mode = SymmetricCipher::Twofish_CBC;
+        if (decryptWithKey(finalKey, encrypted, content)) {
+            return true;
         }
-        if (!cipherStream->init(mode, SymmetricCipher::Decrypt, finalKey, m_encryptionIV)) {
-            raiseError(cipherStream->errorString());
-            return nullptr;
-        }
-        if (!cipherStream->open(QIODevice::ReadOnly)) {
-            raiseError(cipherStream->errorString());
-            return nullptr;
+        if (m_error) {
+            return false;
         }
+    }
 
-        bool success = verifyKey(cipherStream.data());
+    raiseError(tr("Invalid credentials were provided, please try again.\n"
+                  "If this reoccurs, then your database file may be corrupt."));
+    return false;
+}
 
-        cipherStream->reset();
-        cipherStream->close();
-        if (!m_device->seek(contentPos)) {
-            QString msg = tr("unable to seek to content position");
-            if (!m_device->errorString().isEmpty()) {
-                msg.append("\n").append(m_device->errorString());
-            }
-            raiseError(msg);
+/**
+ * Decrypt the content with one candidate key.
+ *
+ * @return true if the key matches the content hash of the header
+ */
+bool KeePass1Reader::decryptWithKey(const QByteArray& finalKey, const QByteArray& encrypted, QByteArray& content)
+{
+    auto mode = SymmetricCipher::Aes256_CBC;
+    if (m_encryptionFlags & KeePass1::Twofish) {
+        mode = SymmetricCipher::Twofish_CBC;
+    }
 
-            return nullptr;
-        }
+    const int blockSize = SymmetricCipher::blockSize(mode);
+    if (encrypted.isEmpty() || encrypted.size() % blockSize != 0) {
+        return false;
+    }
 
-        if (success) {
-            if (!cipherStream->init(mode, SymmetricCipher::Decrypt, finalKey, m_encryptionIV)) {
-                raiseError(cipherStream->errorString());
-                return nullptr;
-            }
-            cipherStream->open(QIODevice::ReadOnly);
-            break;
-        } else {
-            cipherStream.reset();
-        }
+    SymmetricCipher cipher;
+    if (!cipher.init(mode, SymmetricCipher::Decrypt, finalKey, m_encryptionIV)) {
+        raiseError(cipher.errorString());
+        return false;
     }
 
-    if (!cipherStream) {
-        raiseError(tr("Invalid credentials were provided, please try again.\n"
-                      "If this reoccurs, then your database file may be corrupt."));
+    // Decrypt all but the last block in place, only the padded last block goes through finish()
+    content = encrypted;
+    const int bulkSize = content.size() - blockSize;
+    QByteArray lastBlock = content.mid(bulkSize);
+    if (!cipher.process(content.data(), bulkSize) || !cipher.finish(lastBlock)) {
+        content.fill('\0');
+        content.clear();
+        return false;
     }
+    content.resize(bulkSize);
+    content.append(lastBlock);
 
-    return cipherStream.take();
+    if (CryptoHash::hash(content, CryptoHash::Sha256) != m_contentHashHeader) {
+        content.fill('\0');
+        content.clear();
+        return false;
+    }
+    return true;
 }
 
 QByteArray KeePass1Reader::key(const QByteArray& password, const QByteArray& keyfileData)
@@ -405,22 +453,7 @@ QByteArray KeePass1Reader::key(const QByteArray& password, const QByteArray& key
     return hash.result();
 }
 
-bool KeePass1Reader::verifyKey(SymmetricCipherStream* cipherStream)
-{
-    CryptoHash contentHash(CryptoHash::Sha256);
-    QByteArray buffer;
-
-    do {
-        if (!Tools::readFromDevice(cipherStream, buffer)) {
-            return false;
-        }
-        contentHash.addData(buffer);
-    } while (!buffer.isEmpty());
-
-    return contentHash.result() == m_contentHashHeader;
-}
-
-Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
+Group* KeePass1Reader::readGroup(const char*& pos, const char* end)
 {
     QScopedPointer<Group> group(new Group());
     group->setUpdateTimeinfo(false);
@@ -433,27 +466,29 @@ Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
     bool groupIdSet = false;
     bool groupLevelSet = false;
 
-    bool ok;
     bool reachedEnd = false;
 
     do {
-        auto fieldType = Endian::readSizedInt<quint16>(cipherStream, KeePass1::BYTEORDER, &ok);
-        if (!ok) {
+        if (end - pos < 2) {
             raiseError(tr("Invalid group field type number"));
             return nullptr;
         }
+        auto fieldType = Endian::bytesToSizedInt<quint16>(pos, KeePass1::BYTEORDER);
+        pos += 2;
 
-        auto fieldSize = static_cast<int>(Endian::readSizedInt<quint32>(cipherStream, KeePass1::BYTEORDER, &ok));
-        if (!ok) {
+        if (end - pos < 4) {
             raiseError(tr("Invalid group field size"));
             return nullptr;
         }
+        auto fieldSize = Endian::bytesToSizedInt<quint32>(pos, KeePass1::BYTEORDER);
+        pos += 4;
 
-        QByteArray fieldData = cipherStream->read(fieldSize);
-        if (fieldData.size() != fieldSize) {
+        if (static_cast<quint64>(end - pos) < fieldSize) {
             raiseError(tr("Read group field data doesn't match size"));
             return nullptr;
         }
+        const char* fieldData = pos;
+        pos += fieldSize;
 
         switch (fieldType) {
         case 0x0000:
@@ -468,7 +503,7 @@ Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
             groupIdSet = true;
             break;
         case 0x0002:
-            group->setName(QString::fromUtf8(fieldData.constData()));
+            group->setName(fieldString(fieldData, fieldSize));
             break;
         case 0x0003: {
             if (fieldSize != 5) {
@@ -495,6 +530,7 @@ Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
         case 0x0005: {
             if (fieldSize != 5) {
                 raiseError(tr("Incorrect group access time field size"));
+                break;
             }
             QDateTime dateTime = dateFromPackedStruct(fieldData);
             if (dateTime.isValid()) {
@@ -505,6 +541,7 @@ Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
         case 0x0006: {
             if (fieldSize != 5) {
                 raiseError(tr("Incorrect group expiry time field size"));
+                break;
             }
             QDateTime dateTime = dateFromPackedStruct(fieldData);
             if (dateTime.isValid()) {
@@ -557,7 +594,7 @@ Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
     return group.take();
 }
 
-Entry* KeePass1Reader::readEntry(QIODevice* cipherStream)
+Entry* KeePass1Reader::readEntry(const char*& pos, const char* end)
 {
     QScopedPointer<Entry> entry(new Entry());
     entry->setUpdateTimeinfo(false);
@@ -565,27 +602,29 @@ Entry* KeePass1Reader::readEntry(QIODevice* cipherStream)
 
     TimeInfo timeInfo;
     QString binaryName;
-    bool ok;
     bool reachedEnd = false;
 
     do {
-        auto fieldType = Endian::readSizedInt<quint16>(cipherStream, KeePass1::BYTEORDER, &ok);
-        if (!ok) {
+        if (end - pos < 2) {
             raiseError(tr("Missing entry field type number"));
             return nullptr;
         }
+        auto fieldType = Endian::bytesToSizedInt<quint16>(pos, KeePass1::BYTEORDER);
+        pos += 2;
 
-        auto fieldSize = static_cast<int>(Endian::readSizedInt<quint32>(cipherStream, KeePass1::BYTEORDER, &ok));
-        if (!ok) {
+        if (end - pos < 4) {
             raiseError(tr("Invalid entry field size"));
             return nullptr;
         }
+        auto fieldSize = Endian::bytesToSizedInt<quint32>(pos, KeePass1::BYTEORDER);
+        pos += 4;
 
-        QByteArray fieldData = cipherStream->read(fieldSize);
-        if (fieldData.size() != fieldSize) {
+        if (static_cast<quint64>(end - pos) < fieldSize) {
             raiseError(tr("Read entry field data doesn't match size"));
             return nullptr;
         }
+        const char* fieldData = pos;
+        pos += fieldSize;
 
         switch (fieldType) {
         case 0x0000:
@@ -596,7 +635,7 @@ Entry* KeePass1Reader::readEntry(QIODevice* cipherStream)
                 raiseError(tr("Invalid entry UUID field size"));
                 return nullptr;
             }
-            m_entryUuids.insert(fieldData, entry.data());
+            m_entryUuids.insert(QByteArray(fieldData, 16), entry.data());
             break;
         case 0x0002: {
             if (fieldSize != 4) {
@@ -617,19 +656,19 @@ Entry* KeePass1Reader::readEntry(QIODevice* cipherStream)
             break;
         }
         case 0x0004:
-            entry->setTitle(QString::fromUtf8(fieldData.constData()));
+            entry->setTitle(fieldString(fieldData, fieldSize));
             break;
         case 0x0005:
-            entry->setUrl(QString::fromUtf8(fieldData.constData()));
+            entry->setUrl(fieldString(fieldData, fieldSize));
             break;
         case 0x0006:
-            entry->setUsername(QString::fromUtf8(fieldData.constData()));
+            entry->setUsername(fieldString(fieldData, fieldSize));
             break;
         case 0x0007:
-            entry->setPassword(QString::fromUtf8(fieldData.constData()));
+            entry->setPassword(fieldString(fieldData, fieldSize));
             break;
         case 0x0008:
-            parseNotes(QString::fromUtf8(fieldData.constData()), entry.data());
+            parseNotes(fieldString(fieldData, fieldSize), entry.data());
             break;
         case 0x0009: {
             if (fieldSize != 5) {
@@ -677,11 +716,11 @@ Entry* KeePass1Reader::readEntry(QIODevice* cipherStream)
             break;
         }
         case 0x000D:
-            binaryName = QString::fromUtf8(fieldData.constData());
+            binaryName = fieldString(fieldData, fieldSize);
             break;
         case 0x000E:
             if (fieldSize != 0) {
-                entry->attachments()->set(binaryName, fieldData);
+                entry->attachments()->set(binaryName, QByteArray(fieldData, static_cast<int>(fieldSize)));
             }
             break;
         case 0xFFFF:
@@ -811,7 +850,7 @@ bool KeePass1Reader::parseGroupTreeState(const QByteArray& data)
     }
 
     int pos = 0;
-    auto num = Endian::bytesToSizedInt<quint32>(data.mid(pos, 4), KeePass1::BYTEORDER);
+    auto num = Endian::bytesToSizedInt<quint32>(data.constData() + pos, KeePass1::BYTEORDER);
     pos += 4;
 
     if (static_cast<quint32>(data.size() - 4) != (num * 5)) {
@@ -819,7 +858,7 @@ bool KeePass1Reader::parseGroupTreeState(const QByteArray& data)
     }
 
     for (quint32 i = 0; i < num; i++) {
-        auto groupId = Endian::bytesToSizedInt<quint32>(data.mid(pos, 4), KeePass1::BYTEORDER);
+        auto groupId = Endian::bytesToSizedInt<quint32>(data.constData() + pos, KeePass1::BYTEORDER);
         pos += 4;
 
         bool expanded = data.at(pos);
@@ -841,13 +880,13 @@ bool KeePass1Reader::parseCustomIcons4(const QByteArray& data)
 
     int pos = 0;
 
-    auto numIcons = Endian::bytesToSizedInt<quint32>(data.mid(pos, 4), KeePass1::BYTEORDER);
+    auto numIcons = Endian::bytesToSizedInt<quint32>(data.constData() + pos, KeePass1::BYTEORDER);
     pos += 4;
 
-    auto numEntries = Endian::bytesToSizedInt<quint32>(data.mid(pos, 4), KeePass1::BYTEORDER);
+    auto numEntries = Endian::bytesToSizedInt<quint32>(data.constData() + pos, KeePass1::BYTEORDER);
     pos += 4;
 
-    auto numGroups = Endian::bytesToSizedInt<quint32>(data.mid(pos, 4), KeePass1::BYTEORDER);
+    auto numGroups = Endian::bytesToSizedInt<quint32>(data.constData() + pos, KeePass1::BYTEORDER);
     pos += 4;
 
     QList<QUuid> iconUuids;
@@ -856,7 +895,7 @@ bool KeePass1Reader::parseCustomIcons4(const QByteArray& data)
         if (data.size() < (pos + 4)) {
             return false;
         }
-        auto iconSize = Endian::bytesToSizedInt<quint32>(data.mid(pos, 4), KeePass1::BYTEORDER);
+        auto iconSize = Endian::bytesToSizedInt<quint32>(data.constData() + pos, KeePass1::BYTEORDER);
         pos += 4;
 
         if (static_cast<quint32>(data.size()) < (pos + iconSize)) {
@@ -865,9 +904,13 @@ bool KeePass1Reader::parseCustomIcons4(const QByteArray& data)
         QByteArray icon = data.mid(pos, iconSize);
         pos += iconSize;
 
-        QUuid uuid = QUuid::createUuid();
+        // Reuse identical icons, entries refer to them by their position
+        QUuid uuid = m_db->metadata()->findCustomIcon(icon);
+        if (uuid.isNull()) {
+            uuid = QUuid::createUuid();
+            m_db->metadata()->addCustomIcon(uuid, icon);
+        }
         iconUuids.append(uuid);
-        m_db->metadata()->addCustomIcon(uuid, icon);
     }
 
     if (static_cast<quint32>(data.size()) < (pos + numEntries * 20)) {
@@ -878,7 +921,7 @@ bool KeePass1Reader::parseCustomIcons4(const QByteArray& data)
         QByteArray entryUuid = data.mid(pos, 16);
         pos += 16;
 
-        auto iconId = Endian::bytesToSizedInt<quint32>(data.mid(pos, 4), KeePass1::BYTEORDER);
+        auto iconId = Endian::bytesToSizedInt<quint32>(data.constData() + pos, KeePass1::BYTEORDER);
         pos += 4;
 
         if (m_entryUuids.contains(entryUuid) && (iconId < static_cast<quint32>(iconUuids.size()))) {
@@ -891,10 +934,10 @@ bool KeePass1Reader::parseCustomIcons4(const QByteArray& data)
     }
 
     for (quint32 i = 0; i < numGroups; i++) {
-        auto groupId = Endian::bytesToSizedInt<quint32>(data.mid(pos, 4), KeePass1::BYTEORDER);
+        auto groupId = Endian::bytesToSizedInt<quint32>(data.constData() + pos, KeePass1::BYTEORDER);
         pos += 4;
 
-        auto iconId = Endian::bytesToSizedInt<quint32>(data.mid(pos, 4), KeePass1::BYTEORDER);
+        auto iconId = Endian::bytesToSizedInt<quint32>(data.constData() + pos, KeePass1::BYTEORDER);
         pos += 4;
 
         if (m_groupIds.contains(groupId) && (iconId < static_cast<quint32>(iconUuids.size()))) {
@@ -911,15 +954,13 @@ void KeePass1Reader::raiseError(const QString& errorMessage)
     m_errorStr = errorMessage;
 }
 
-QDateTime KeePass1Reader::dateFromPackedStruct(const QByteArray& data)
+QDateTime KeePass1Reader::dateFromPackedStruct(const char* data)
 {
-    Q_ASSERT(data.size() == 5);
-
-    quint32 dw1 = static_cast<uchar>(data.at(0));
-    quint32 dw2 = static_cast<uchar>(data.at(1));
-    quint32 dw3 = static_cast<uchar>(data.at(2));
-    quint32 dw4 = static_cast<uchar>(data.at(3));
-    quint32 dw5 = static_cast<uchar>(data.at(4));
+    quint32 dw1 = static_cast<uchar>(data[0]);
+    quint32 dw2 = static_cast<uchar>(data[1]);
+    quint32 dw3 = static_cast<uchar>(data[2]);
+    quint32 dw4 = static_cast<uchar>(data[3]);
+    quint32 dw5 = static_cast<uchar>(data[4]);
 
     int y = (dw1 << 6) | (dw2 >> 2);
     int mon = ((dw2 & 0x00000003) << 2) | (dw3 >> 6);
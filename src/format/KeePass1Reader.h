@@ -24,7 +24,6 @@
 class Database;
 class Entry;
 class Group;
-class SymmetricCipherStream;
 class QIODevice;
 
 class KeePass1Reader
@@ -47,11 +46,11 @@ private:
         UTF8
     };
 
-    SymmetricCipherStream* testKeys(const QString& password, const QByteArray& keyfileData, qint64 contentPos);
+    bool decryptContent(const QString& password, const QByteArray& keyfileData, QByteArray& content);
     QByteArray key(const QByteArray& password, const QByteArray& keyfileData);
-    bool verifyKey(SymmetricCipherStream* cipherStream);
-    Group* readGroup(QIODevice* cipherStream);
-    Entry* readEntry(QIODevice* cipherStream);
+    bool decryptWithKey(const QByteArray& finalKey, const QByteArray& encrypted, QByteArray& content);
+    Group* readGroup(const char*& pos, const char* end);
+    Entry* readEntry(const char*& pos, const char* end);
     void parseNotes(const QString& rawNotes, Entry* entry);
     bool constructGroupTree(const QList<Group*>& groups);
     void parseMetaStream(const Entry* entry);
@@ -59,7 +58,7 @@ private:
     bool parseCustomIcons4(const QByteArray& data);
     void raiseError(const QString& errorMessage);
     static QByteArray readKeyfile(QIODevice* device);
-    static QDateTime dateFromPackedStruct(const QByteArray& data);
+    static QDateTime dateFromPackedStruct(const char* data);
     static bool isMetaStream(const Entry* entry);
 
     QSharedPointer<Database> m_db;
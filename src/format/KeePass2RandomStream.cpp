@@ -20,84 +20,138 @@
 #include "crypto/CryptoHash.h"
 #include "format/KeePass2.h"
 
+#include <QMutex>
+
+#include <botan/stream_cipher.h>
+
+namespace
+{
+    /**
+     * Seekable copy of the inner stream, used to decrypt protected values
+     * long after the stream itself has moved on.
+     */
+    class SeekableKeyStream : public ProtectedValue::KeyStream
+    {
+    public:
+        explicit SeekableKeyStream(std::unique_ptr<Botan::StreamCipher> cipher)
+            : m_cipher(std::move(cipher))
+        {
+        }
+
+        bool apply(qint64 offset, char* data, int size) const override
+        {
+            QMutexLocker locker(&m_mutex);
+            try {
+                m_cipher->seek(static_cast<uint64_t>(offset));
+                m_cipher->cipher1(reinterpret_cast<uint8_t*>(data), static_cast<size_t>(size));
+            } catch (std::exception& e) {
+                qWarning("Failed to seek the inner stream: %s", e.what());
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        mutable QMutex m_mutex;
+        std::unique_ptr<Botan::StreamCipher> m_cipher;
+    };
+} // namespace
+
 bool KeePass2RandomStream::init(SymmetricCipher::Mode mode, const QByteArray& key)
 {
+    // Drop any key stream generated by a previous initialization
+    m_buffer.clear();
+    m_offset = 0;
+    m_position = 0;
+    m_keyStream.reset();
+
     switch (mode) {
     case SymmetricCipher::Salsa20: {
-        return m_cipher.init(mode,
-                             SymmetricCipher::Encrypt,
-                             CryptoHash::hash(key, CryptoHash::Sha256),
-                             KeePass2::INNER_STREAM_SALSA20_IV);
+        m_key = CryptoHash::hash(key, CryptoHash::Sha256);
+        m_iv = KeePass2::INNER_STREAM_SALSA20_IV;
+        break;
     }
     case SymmetricCipher::ChaCha20: {
         QByteArray keyIv = CryptoHash::hash(key, CryptoHash::Sha512);
-        return m_cipher.init(mode, SymmetricCipher::Encrypt, keyIv.left(32), keyIv.mid(32, 12));
+        m_key = keyIv.left(32);
+        m_iv = keyIv.mid(32, 12);
+        break;
     }
     default:
         qWarning("Invalid stream cipher mode (%d)", mode);
-        break;
+        m_mode = SymmetricCipher::InvalidMode;
+        return false;
     }
-    return false;
+
+    m_mode = mode;
+    return m_cipher.init(mode, SymmetricCipher::Encrypt, m_key, m_iv);
 }
 
 QByteArray KeePass2RandomStream::randomBytes(int size, bool* ok)
 {
-    QByteArray result;
-
-    int bytesRemaining = size;
-
-    while (bytesRemaining > 0) {
-        if (m_buffer.size() == m_offset) {
-            if (!loadBlock()) {
-                *ok = false;
-                return {};
-            }
-        }
-
-        int bytesToCopy = qMin(bytesRemaining, m_buffer.size() - m_offset);
-        result.append(m_buffer.mid(m_offset, bytesToCopy));
-        m_offset += bytesToCopy;
-        bytesRemaining -= bytesToCopy;
+    // XOR onto zeros yields the key stream itself
+    QByteArray result(size, '\0');
+    *ok = applyKeyStream(result.data(), size);
+    if (!*ok) {
+        return {};
     }
-
-    *ok = true;
     return result;
 }
 
 QByteArray KeePass2RandomStream::process(const QByteArray& data, bool* ok)
 {
-    bool randomBytesOk;
-
-    QByteArray randomData = randomBytes(data.size(), &randomBytesOk);
-    if (!randomBytesOk) {
-        *ok = false;
+    QByteArray result = data;
+    *ok = applyKeyStream(result.data(), result.size());
+    if (!*ok) {
         return {};
     }
+    return result;
+}
 
-    QByteArray result;
-    result.resize(data.size());
+bool KeePass2RandomStream::processInPlace(QByteArray& data)
+{
+    return applyKeyStream(data.data(), data.size());
+}
 
-    for (int i = 0; i < data.size(); i++) {
-        result[i] = data[i] ^ randomData[i];
-    }
+/**
+ * Move past size bytes of the key stream, e.g. for a value that is
+ * decrypted later through keyStream().
+ */
+bool KeePass2RandomStream::skip(int size)
+{
+    return applyKeyStream(nullptr, size);
+}
 
-    *ok = true;
-    return result;
+/**
+ * @return offset of the next byte of the key stream
+ */
+qint64 KeePass2RandomStream::position() const
+{
+    return m_position;
 }
 
-bool KeePass2RandomStream::processInPlace(QByteArray& data)
+/**
+ * Seekable copy of the key stream. It holds the key until the last value
+ * that uses it is gone.
+ *
+ * @return the key stream, or null if it is not available
+ */
+QSharedPointer<const ProtectedValue::KeyStream> KeePass2RandomStream::keyStream()
 {
-    bool ok;
-    QByteArray randomData = randomBytes(data.size(), &ok);
-    if (!ok) {
-        return false;
+    if (m_keyStream || m_mode == SymmetricCipher::InvalidMode) {
+        return m_keyStream;
     }
 
-    for (int i = 0; i < data.size(); i++) {
-        data[i] = data[i] ^ randomData[i];
+    try {
+        auto cipher = Botan::StreamCipher::create_or_throw(m_mode == SymmetricCipher::ChaCha20 ? "ChaCha(20)"
+                                                                                                : "Salsa20");
+        cipher->set_key(reinterpret_cast<const uint8_t*>(m_key.constData()), m_key.size());
+        cipher->set_iv(reinterpret_cast<const uint8_t*>(m_iv.constData()), m_iv.size());
+        m_keyStream.reset(new SeekableKeyStream(std::move(cipher)));
+    } catch (std::exception& e) {
+        qWarning("Failed to create a seekable inner stream: %s", e.what());
     }
-
-    return true;
+    return m_keyStream;
 }
 
 QString KeePass2RandomStream::errorString() const
@@ -105,11 +159,38 @@ QString KeePass2RandomStream::errorString() const
     return m_cipher.errorString();
 }
 
+bool KeePass2RandomStream::applyKeyStream(char* data, int size)
+{
+    while (size > 0) {
+        if (m_buffer.size() == m_offset) {
+            if (!loadBlock()) {
+                return false;
+            }
+        }
+
+        const int bytesToXor = qMin(size, m_buffer.size() - m_offset);
+        if (data) {
+            const char* keyStream = m_buffer.constData() + m_offset;
+            for (int i = 0; i < bytesToXor; ++i) {
+                data[i] ^= keyStream[i];
+            }
+            data += bytesToXor;
+        }
+        m_offset += bytesToXor;
+        m_position += bytesToXor;
+        size -= bytesToXor;
+    }
+
+    return true;
+}
+
 bool KeePass2RandomStream::loadBlock()
 {
     Q_ASSERT(m_offset == m_buffer.size());
 
-    m_buffer.fill('\0', m_cipher.blockSize(m_cipher.mode()));
+    // Salsa20 and ChaCha20 have a "block size" of one byte, generating the key stream
+    // in large batches lets the cipher use its SIMD code paths and avoids a call per byte
+    m_buffer.fill('\0', qMax(KeyStreamBatchSize, m_cipher.blockSize(m_cipher.mode())));
     if (!m_cipher.process(m_buffer)) {
         return false;
     }
@@ -18,6 +18,7 @@
 #ifndef KEEPASSX_KEEPASS2RANDOMSTREAM_H
 #define KEEPASSX_KEEPASS2RANDOMSTREAM_H
 
+#include "core/ProtectedValue.h"
 #include "crypto/SymmetricCipher.h"
 
 class KeePass2RandomStream
@@ -29,14 +30,27 @@ public:
     QByteArray randomBytes(int size, bool* ok);
     QByteArray process(const QByteArray& data, bool* ok);
     Q_REQUIRED_RESULT bool processInPlace(QByteArray& data);
+    Q_REQUIRED_RESULT bool skip(int size);
+    qint64 position() const;
+    QSharedPointer<const ProtectedValue::KeyStream> keyStream();
     QString errorString() const;
 
 private:
+    static constexpr int KeyStreamBatchSize = 4096;
+
+    bool applyKeyStream(char* data, int size);
     bool loadBlock();
 
     SymmetricCipher m_cipher;
     QByteArray m_buffer;
     int m_offset = 0;
+    // Bytes of the key stream used since the initialization
+    qint64 m_position = 0;
+
+    SymmetricCipher::Mode m_mode = SymmetricCipher::InvalidMode;
+    QByteArray m_key;
+    QByteArray m_iv;
+    QSharedPointer<const ProtectedValue::KeyStream> m_keyStream;
 };
 
 #endif // KEEPASSX_KEEPASS2RANDOMSTREAM_H
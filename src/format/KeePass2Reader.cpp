@@ -123,6 +123,14 @@ QSharedPointer<KdbxReader> KeePass2Reader::reader() const
     return m_reader;
 }
 
+/**
+ * @return durations of the stages of reading the input file
+ */
+StageTimings KeePass2Reader::timings() const
+{
+    return m_reader ? m_reader->timings() : StageTimings();
+}
+
 /**
  * Raise an error. Use in case of an unexpected read error.
  *
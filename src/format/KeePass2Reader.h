@@ -35,6 +35,7 @@ public:
 
     QSharedPointer<KdbxReader> reader() const;
     quint32 version() const;
+    StageTimings timings() const;
 
 private:
     void raiseError(const QString& errorMessage);
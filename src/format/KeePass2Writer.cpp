@@ -15,12 +15,14 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QBuffer>
 #include <QFile>
 
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "format/Kdbx3Writer.h"
 #include "format/Kdbx4Writer.h"
+#include "format/KdbxXmlHistory.h"
 #include "format/KeePass2Writer.h"
 
 /**
@@ -88,6 +90,13 @@ quint32 KeePass2Writer::kdbxVersionRequired(Database const* db, bool ignoreCurre
                 VERSION_MAX(version, KeePass2::FILE_VERSION_4_1)
             }
 
+            const auto serialized = entry->serializedHistory().dynamicCast<const KdbxXmlHistory>();
+            if (serialized) {
+                if (serialized->hasCustomData) {
+                    VERSION_MAX(version, KeePass2::FILE_VERSION_4)
+                }
+                continue;
+            }
             for (const auto* historyItem : entry->historyItems()) {
                 if (historyItem->customData() && !historyItem->customData()->isEmpty()) {
                     VERSION_MAX(version, KeePass2::FILE_VERSION_4)
@@ -141,6 +150,14 @@ bool KeePass2Writer::writeDatabase(QIODevice* device, Database* db)
 }
 
 void KeePass2Writer::extractDatabase(Database* db, QByteArray& xmlOutput)
+{
+    QBuffer buffer;
+    buffer.setBuffer(&xmlOutput);
+    buffer.open(QIODevice::WriteOnly);
+    extractDatabase(db, &buffer);
+}
+
+void KeePass2Writer::extractDatabase(Database* db, QIODevice* device)
 {
     m_error = false;
     m_errorStr.clear();
@@ -155,7 +172,7 @@ void KeePass2Writer::extractDatabase(Database* db, QByteArray& xmlOutput)
         m_writer.reset(new Kdbx4Writer());
     }
 
-    m_writer->extractDatabase(xmlOutput, db);
+    m_writer->extractDatabase(device, db);
 }
 
 bool KeePass2Writer::hasError() const
@@ -194,3 +211,11 @@ quint32 KeePass2Writer::version() const
 {
     return m_version;
 }
+
+/**
+ * @return durations of the stages of writing the output file
+ */
+StageTimings KeePass2Writer::timings() const
+{
+    return m_writer ? m_writer->timings() : StageTimings();
+}
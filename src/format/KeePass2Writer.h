@@ -33,10 +33,12 @@ public:
     bool writeDatabase(const QString& filename, Database* db);
     bool writeDatabase(QIODevice* device, Database* db);
     void extractDatabase(Database* db, QByteArray& xmlOutput);
+    void extractDatabase(Database* db, QIODevice* device);
     static quint32 kdbxVersionRequired(Database const* db, bool ignoreCurrent = false, bool ignoreKdf = false);
 
     QSharedPointer<KdbxWriter> writer() const;
     quint32 version() const;
+    StageTimings timings() const;
 
     bool hasError() const;
     QString errorString() const;
@@ -16,6 +16,7 @@
  */
 
 #include "OPUXReader.h"
+#include "JsonStreamReader.h"
 
 #include "core/Database.h"
 #include "core/Entry.h"
@@ -24,8 +25,8 @@
 #include "core/Totp.h"
 
 #include <QFileInfo>
+#include <QIODevice>
 #include <QJsonArray>
-#include <QJsonDocument>
 #include <QJsonObject>
 #include <QScopedPointer>
 #include <QUrl>
@@ -34,6 +35,38 @@
 
 namespace
 {
+    /**
+     * Sequential device reading the current file of a zip archive.
+     */
+    class UnzipDevice : public QIODevice
+    {
+    public:
+        explicit UnzipDevice(unzFile uf)
+            : m_uf(uf)
+        {
+        }
+
+        bool isSequential() const override
+        {
+            return true;
+        }
+
+    protected:
+        qint64 readData(char* data, qint64 maxSize) override
+        {
+            const int bytes = unzReadCurrentFile(m_uf, data, static_cast<unsigned>(qMin<qint64>(maxSize, 1 << 20)));
+            return bytes < 0 ? -1 : bytes;
+        }
+
+        qint64 writeData(const char*, qint64) override
+        {
+            return -1;
+        }
+
+    private:
+        unzFile m_uf;
+    };
+
     QByteArray extractFile(unzFile uf, QString filename)
     {
         if (unzLocateFile(uf, filename.toLatin1(), 2) != UNZ_OK) {
@@ -201,39 +234,125 @@ namespace
         return entry.take();
     }
 
-    void writeVaultToDatabase(const QJsonObject& vault, QSharedPointer<Database> db, unzFile uf = nullptr)
+    /**
+     * Read a vault and convert each item as it is parsed.
+     *
+     * @param files archive handle used to extract attachments and icons
+     */
+    bool readVault(JsonStreamReader& reader, const QSharedPointer<Database>& db, unzFile files)
     {
-        if (!vault.contains("attrs") || !vault.contains("items")) {
-            // Early out if the vault is missing critical items
-            return;
+        if (!reader.enterObject()) {
+            return false;
         }
 
-        const auto attr = vault.value("attrs").toObject().toVariantMap();
-
-        // Create group and assign basic values
-        auto group = new Group();
+        // Create the group up front, the items are added to it while they are read
+        QScopedPointer<Group> group(new Group());
         group->setUuid(QUuid::createUuid());
-        group->setName(attr.value("name").toString());
-        group->setParent(db->rootGroup());
-
-        const auto items = vault.value("items").toArray();
-        for (const auto& item : items) {
-            auto entry = readItem(item.toObject(), uf);
-            if (entry) {
-                entry->setGroup(group, false);
+        bool hasAttrs = false;
+        bool hasItems = false;
+        QString icon;
+
+        QString key;
+        while (reader.nextKey(key)) {
+            if (key == "attrs") {
+                hasAttrs = true;
+                const auto attr = reader.readValue().toObject().toVariantMap();
+                group->setName(attr.value("name").toString());
+                icon = attr.value("avatar").toString();
+            } else if (key == "items") {
+                hasItems = true;
+                if (!reader.enterArray()) {
+                    break;
+                }
+                while (reader.nextElement()) {
+                    auto entry = readItem(reader.readValue().toObject(), files);
+                    if (entry) {
+                        entry->setGroup(group.data(), false);
+                    }
+                }
+            } else {
+                reader.skipValue();
             }
         }
 
+        if (reader.hasError() || !hasAttrs || !hasItems) {
+            // Early out if the vault is missing critical items
+            return !reader.hasError();
+        }
+
+        group->setParent(db->rootGroup());
+
         // Add the group icon if present
-        const auto icon = attr.value("avatar").toString();
         if (!icon.isEmpty()) {
-            auto data = extractFile(uf, QString("files/%1").arg(icon));
+            auto data = extractFile(files, QString("files/%1").arg(icon));
             if (!data.isNull()) {
-                const auto uuid = QUuid::createUuid();
-                db->metadata()->addCustomIcon(uuid, data);
+                // Vaults often share the same avatar
+                auto uuid = db->metadata()->findCustomIcon(data);
+                if (uuid.isNull()) {
+                    uuid = QUuid::createUuid();
+                    db->metadata()->addCustomIcon(uuid, data);
+                }
                 group->setIcon(uuid);
             }
         }
+
+        group.take();
+        return true;
+    }
+
+    bool readAccount(JsonStreamReader& reader, const QSharedPointer<Database>& db, unzFile files)
+    {
+        if (!reader.enterObject()) {
+            return false;
+        }
+
+        QString key;
+        while (reader.nextKey(key)) {
+            if (key != "vaults") {
+                reader.skipValue();
+                continue;
+            }
+            if (!reader.enterArray()) {
+                return false;
+            }
+            while (reader.nextElement()) {
+                if (!readVault(reader, db, files)) {
+                    return false;
+                }
+            }
+        }
+
+        return !reader.hasError();
+    }
+
+    /**
+     * Read the vaults of the first account in export.data.
+     */
+    bool readExport(JsonStreamReader& reader, const QSharedPointer<Database>& db, unzFile files)
+    {
+        if (!reader.enterObject()) {
+            return false;
+        }
+
+        QString key;
+        while (reader.nextKey(key)) {
+            if (key != "accounts") {
+                reader.skipValue();
+                continue;
+            }
+            if (!reader.enterArray()) {
+                return false;
+            }
+            for (bool first = true; reader.nextElement(); first = false) {
+                if (!first) {
+                    reader.skipValue();
+                } else if (!readAccount(reader, db, files)) {
+                    return false;
+                }
+            }
+        }
+
+        return !reader.hasError();
     }
 } // namespace
 
@@ -257,7 +376,7 @@ QSharedPointer<Database> OPUXReader::convert(const QString& path)
         return {};
     }
 
-    // 1PUX is a zip file format, open it and process the contents in memory
+    // 1PUX is a zip file format, its contents are read straight from the archive
     auto uf = unzOpen64(fileinfo.absoluteFilePath().toLatin1().constData());
     if (!uf) {
         m_error = QObject::tr("Invalid 1PUX file format: Not a valid ZIP file.");
@@ -265,24 +384,29 @@ QSharedPointer<Database> OPUXReader::convert(const QString& path)
     }
 
     // Find the export.data file, if not found this isn't a 1PUX file
-    auto data = extractFile(uf, "export.data");
-    if (data.isNull()) {
+    if (unzLocateFile(uf, "export.data", 2) != UNZ_OK || unzOpenCurrentFile(uf) != UNZ_OK) {
         m_error = QObject::tr("Invalid 1PUX file format: Missing export.data");
         unzClose(uf);
         return {};
     }
 
+    // export.data is parsed while it is decompressed, attachments are extracted through a second handle
+    auto files = unzOpen64(fileinfo.absoluteFilePath().toLatin1().constData());
+
     auto db = QSharedPointer<Database>::create();
     db->rootGroup()->setName(QObject::tr("1Password Import"));
-    const auto json = QJsonDocument::fromJson(data);
-
-    const auto account = json.object().value("accounts").toArray().first().toObject();
-    const auto vaults = account.value("vaults").toArray();
 
-    for (const auto& vault : vaults) {
-        writeVaultToDatabase(vault.toObject(), db, uf);
+    UnzipDevice device(uf);
+    device.open(QIODevice::ReadOnly);
+    JsonStreamReader reader(&device);
+    if (!readExport(reader, db, files)) {
+        m_error = QObject::tr("Cannot parse file: %1 at position %2")
+                      .arg(reader.errorString(), QString::number(reader.errorOffset()));
+        db.reset();
     }
 
+    unzCloseCurrentFile(uf);
+    unzClose(files);
     unzClose(uf);
     return db;
 }
@@ -22,6 +22,7 @@
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "crypto/CryptoHash.h"
+#include "format/BulkImport.h"
 
 #include <QDebug>
 #include <QJsonDocument>
@@ -85,6 +86,8 @@ QSharedPointer<Database> OpVaultReader::convert(QDir& opdataDir, const QString&
         }
     }
 
+    // Collect the items of all bands first, they are decrypted in parallel below
+    QList<QJsonObject> bandEntries;
     const QString bandChars("0123456789ABCDEF");
     QString bandPattern("band_%1.js");
     for (QChar ch : bandChars) {
@@ -115,11 +118,30 @@ QSharedPointer<Database> OpVaultReader::convert(QDir& opdataDir, const QString&
             if (!ok) {
                 continue;
             }
-            // https://support.1password.com/opvault-design/#items
-            auto entry = processBandEntry(bandEnt, defaultDir, rootGroup);
-            if (!entry) {
-                qWarning() << "Unable to process Band Entry " << uuid;
-            }
+            bandEntries.append(bandEnt);
+        }
+    }
+
+    // https://support.1password.com/opvault-design/#items
+    // Every item and its attachments have their own keys, only the tree is assembled on this thread
+    const auto entries = BulkImport::buildEntries(bandEntries.size(), [&](int i) {
+        auto entry = processBandEntry(bandEntries.at(i), defaultDir);
+        if (!entry) {
+            qWarning() << "Unable to process Band Entry " << bandEntries.at(i).value("uuid").toString();
+        }
+        return entry;
+    });
+
+    QList<Group*> groups;
+    for (const auto& bandEntry : asConst(bandEntries)) {
+        groups.append(bandEntryGroup(bandEntry, rootGroup));
+    }
+    BulkImport::attachEntries(db.data(), entries, groups);
+
+    // Send trashed entries to the recycle bin
+    for (int i = 0; i < entries.size(); ++i) {
+        if (entries[i] && bandEntries.at(i).value("trashed").toBool()) {
+            db->recycleEntry(entries[i]);
         }
     }
 
@@ -78,28 +78,34 @@ private:
      * which are used to decrypt the attachments, also.
      * @returns \c nullptr if unable to do the decryption, otherwise the interior object and its keys
      */
-    bool decryptBandEntry(const QJsonObject& bandEntry, QJsonObject& data, QByteArray& key, QByteArray& hmacKey);
-    Entry* processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup);
+    bool decryptBandEntry(const QJsonObject& bandEntry, QJsonObject& data, QByteArray& key, QByteArray& hmacKey) const;
+    /*!
+     * Decrypts a band item into a new entry that is not part of any group yet.
+     * Items are decrypted on worker threads, so this and the functions
+     * it calls must only read the keys of the reader.
+     */
+    Entry* processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir) const;
+    Group* bandEntryGroup(const QJsonObject& bandEntry, Group* rootGroup) const;
 
     bool readAttachment(const QString& filePath,
                         const QByteArray& itemKey,
                         const QByteArray& itemHmacKey,
                         QJsonObject& metadata,
-                        QByteArray& payload);
+                        QByteArray& payload) const;
     void fillAttachment(Entry* entry,
                         const QFileInfo& attachmentFileInfo,
                         const QByteArray& entryKey,
-                        const QByteArray& entryHmacKey);
+                        const QByteArray& entryHmacKey) const;
     void fillAttachments(Entry* entry,
                          const QDir& attachmentDir,
                          const QByteArray& entryKey,
-                         const QByteArray& entryHmacKey);
+                         const QByteArray& entryHmacKey) const;
 
-    bool fillAttributes(Entry* entry, const QJsonObject& bandEntry);
+    bool fillAttributes(Entry* entry, const QJsonObject& bandEntry) const;
 
-    void fillFromSection(Entry* entry, const QJsonObject& section);
-    void fillFromSectionField(Entry* entry, const QString& sectionName, const QJsonObject& field);
-    QString resolveAttributeName(const QString& section, const QString& name, const QString& text);
+    void fillFromSection(Entry* entry, const QJsonObject& section) const;
+    void fillFromSectionField(Entry* entry, const QString& sectionName, const QJsonObject& field) const;
+    QString resolveAttributeName(const QString& section, const QString& name, const QString& text) const;
 
     void populateCategoryGroups(Group* rootGroup);
     /*! Used to blank the memory after the keys have been used. */
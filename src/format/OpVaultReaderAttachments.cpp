@@ -34,7 +34,7 @@ bool OpVaultReader::readAttachment(const QString& filePath,
                                    const QByteArray& itemKey,
                                    const QByteArray& itemHmacKey,
                                    QJsonObject& metadata,
-                                   QByteArray& payload)
+                                   QByteArray& payload) const
 {
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -140,7 +140,7 @@ bool OpVaultReader::readAttachment(const QString& filePath,
 void OpVaultReader::fillAttachments(Entry* entry,
                                     const QDir& attachmentDir,
                                     const QByteArray& entryKey,
-                                    const QByteArray& entryHmacKey)
+                                    const QByteArray& entryHmacKey) const
 {
     /*!
      * Attachment files are named with the UUID of the item that they are attached to followed by an underscore
@@ -165,7 +165,7 @@ void OpVaultReader::fillAttachments(Entry* entry,
 void OpVaultReader::fillAttachment(Entry* entry,
                                    const QFileInfo& info,
                                    const QByteArray& entryKey,
-                                   const QByteArray& entryHmacKey)
+                                   const QByteArray& entryHmacKey) const
 {
     QJsonObject attachMetadata;
     QByteArray attachPayload;
@@ -31,7 +31,7 @@
 bool OpVaultReader::decryptBandEntry(const QJsonObject& bandEntry,
                                      QJsonObject& data,
                                      QByteArray& key,
-                                     QByteArray& hmacKey)
+                                     QByteArray& hmacKey) const
 {
     if (!bandEntry.contains("d")) {
         qWarning() << "Band entries must contain a \"d\" key: " << bandEntry.keys();
@@ -103,7 +103,7 @@ bool OpVaultReader::decryptBandEntry(const QJsonObject& bandEntry,
     return true;
 }
 
-Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup)
+Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir) const
 {
     const QString uuid = bandEntry.value("uuid").toString();
     if (!(uuid.size() == 32 || uuid.size() == 36)) {
@@ -113,38 +113,6 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
 
     QScopedPointer<Entry> entry(new Entry());
 
-    if (bandEntry.contains("trashed") && bandEntry["trashed"].toBool()) {
-        // Send this entry to the recycle bin
-        rootGroup->database()->recycleEntry(entry.data());
-    } else if (bandEntry.contains("category")) {
-        const QJsonValue& categoryValue = bandEntry["category"];
-        if (categoryValue.isString()) {
-            bool found = false;
-            const QString category = categoryValue.toString();
-            for (Group* group : rootGroup->children()) {
-                const QVariant& groupCode = group->property("code");
-                if (category == groupCode.toString()) {
-                    entry->setGroup(group);
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                qWarning() << QString("Unable to place Entry.Category \"%1\" so using the Root instead").arg(category);
-                entry->setGroup(rootGroup);
-            }
-        } else {
-            qWarning() << QString(R"(Skipping non-String Category type "%1" in UUID "%2")")
-                              .arg(categoryValue.type())
-                              .arg(uuid);
-            entry->setGroup(rootGroup);
-        }
-    } else {
-        qWarning() << "Using the root group because the entry is category-less: <<\n"
-                   << bandEntry << "\n>> in UUID " << uuid;
-        entry->setGroup(rootGroup);
-    }
-
     entry->setUpdateTimeinfo(false);
     TimeInfo ti;
     bool timeInfoOk = false;
@@ -216,7 +184,43 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
     return entry.take();
 }
 
-bool OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& bandEntry)
+/*!
+ * Finds the category group of a band item. Trashed items are placed in the
+ * root group until they are recycled.
+ */
+Group* OpVaultReader::bandEntryGroup(const QJsonObject& bandEntry, Group* rootGroup) const
+{
+    if (bandEntry.contains("trashed") && bandEntry["trashed"].toBool()) {
+        return rootGroup;
+    }
+
+    const QString uuid = bandEntry.value("uuid").toString();
+    if (!bandEntry.contains("category")) {
+        qWarning() << "Using the root group because the entry is category-less: <<\n"
+                   << bandEntry << "\n>> in UUID " << uuid;
+        return rootGroup;
+    }
+
+    const QJsonValue& categoryValue = bandEntry["category"];
+    if (!categoryValue.isString()) {
+        qWarning() << QString(R"(Skipping non-String Category type "%1" in UUID "%2")")
+                          .arg(categoryValue.type())
+                          .arg(uuid);
+        return rootGroup;
+    }
+
+    const QString category = categoryValue.toString();
+    for (Group* group : rootGroup->children()) {
+        const QVariant& groupCode = group->property("code");
+        if (category == groupCode.toString()) {
+            return group;
+        }
+    }
+    qWarning() << QString("Unable to place Entry.Category \"%1\" so using the Root instead").arg(category);
+    return rootGroup;
+}
+
+bool OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& bandEntry) const
 {
     const QString overviewStr = bandEntry.value("o").toString();
     OpData01 entOver01;
@@ -44,7 +44,7 @@ namespace
     }
 } // namespace
 
-void OpVaultReader::fillFromSection(Entry* entry, const QJsonObject& section)
+void OpVaultReader::fillFromSection(Entry* entry, const QJsonObject& section) const
 {
     const auto uuid = entry->uuid();
     auto sectionTitle = section["title"].toString();
@@ -70,7 +70,7 @@ void OpVaultReader::fillFromSection(Entry* entry, const QJsonObject& section)
     }
 }
 
-void OpVaultReader::fillFromSectionField(Entry* entry, const QString& sectionName, const QJsonObject& field)
+void OpVaultReader::fillFromSectionField(Entry* entry, const QString& sectionName, const QJsonObject& field) const
 {
     if (!field.contains("v")) {
         // for our purposes, we don't care if there isn't a value in the field
@@ -141,7 +141,7 @@ void OpVaultReader::fillFromSectionField(Entry* entry, const QString& sectionNam
     }
 }
 
-QString OpVaultReader::resolveAttributeName(const QString& section, const QString& name, const QString& text)
+QString OpVaultReader::resolveAttributeName(const QString& section, const QString& name, const QString& text) const
 {
     // Special case for TOTP
     if (name.startsWith("TOTP_")) {
@@ -21,7 +21,9 @@
 #include "ui_ApplicationSettingsWidgetSecurity.h"
 #include <QDesktopServices>
 #include <QDir>
+#include <QPointer>
 #include <QToolTip>
+#include <QVBoxLayout>
 
 #include "config-keepassx.h"
 
@@ -35,28 +37,70 @@
 #include "FileDialog.h"
 #include "MessageBox.h"
 
+/**
+ * Placeholder for a settings page that creates the actual page widget when
+ * it is first shown, so the pages of optional features cost nothing when
+ * the application starts.
+ */
+class LazySettingsPage : public QWidget
+{
+public:
+    LazySettingsPage(QSharedPointer<ISettingsPage> page, QWidget* parent)
+        : QWidget(parent)
+        , m_page(std::move(page))
+    {
+        auto* layout = new QVBoxLayout(this);
+        layout->setContentsMargins(0, 0, 0, 0);
+    }
+
+    QWidget* pageWidget() const
+    {
+        return m_widget;
+    }
+
+protected:
+    void showEvent(QShowEvent* event) override
+    {
+        if (!m_widget) {
+            m_widget = m_page->createWidget();
+            layout()->addWidget(m_widget);
+            m_page->loadSettings(m_widget);
+        }
+        QWidget::showEvent(event);
+    }
+
+private:
+    QSharedPointer<ISettingsPage> m_page;
+    QPointer<QWidget> m_widget;
+};
+
 class ApplicationSettingsWidget::ExtraPage
 {
 public:
-    ExtraPage(ISettingsPage* page, QWidget* widget)
-        : settingsPage(page)
-        , widget(widget)
+    ExtraPage(QSharedPointer<ISettingsPage> page, LazySettingsPage* container)
+        : settingsPage(std::move(page))
+        , container(container)
     {
     }
 
+    // Pages that were never shown have nothing to load or save
     void loadSettings() const
     {
-        settingsPage->loadSettings(widget);
+        if (container && container->pageWidget()) {
+            settingsPage->loadSettings(container->pageWidget());
+        }
     }
 
     void saveSettings() const
     {
-        settingsPage->saveSettings(widget);
+        if (container && container->pageWidget()) {
+            settingsPage->saveSettings(container->pageWidget());
+        }
     }
 
 private:
     QSharedPointer<ISettingsPage> settingsPage;
-    QWidget* widget;
+    QPointer<LazySettingsPage> container;
 };
 
 /**
@@ -182,10 +226,10 @@ ApplicationSettingsWidget::~ApplicationSettingsWidget() = default;
 
 void ApplicationSettingsWidget::addSettingsPage(ISettingsPage* page)
 {
-    QWidget* widget = page->createWidget();
-    widget->setParent(this);
-    m_extraPages.append(ExtraPage(page, widget));
-    addPage(page->name(), page->icon(), widget);
+    QSharedPointer<ISettingsPage> settingsPage(page);
+    auto* container = new LazySettingsPage(settingsPage, this);
+    m_extraPages.append(ExtraPage(settingsPage, container));
+    addPage(page->name(), page->icon(), container);
 }
 
 void ApplicationSettingsWidget::loadSettings()
@@ -214,6 +258,8 @@ void ApplicationSettingsWidget::loadSettings()
 
     m_generalUi->useAlternativeSaveCheckBox->setChecked(!config()->get(Config::UseAtomicSaves).toBool());
     m_generalUi->alternativeSaveComboBox->setCurrentIndex(config()->get(Config::UseDirectWriteSaves).toBool() ? 1 : 0);
+    m_generalUi->cacheNetworkDatabasesCheckBox->setChecked(config()->get(Config::CacheNetworkDatabases).toBool());
+    m_generalUi->lazyHistoryLoadingCheckBox->setChecked(config()->get(Config::LazyHistoryLoading).toBool());
     m_generalUi->autoReloadOnChangeCheckBox->setChecked(config()->get(Config::AutoReloadOnChange).toBool());
     m_generalUi->minimizeAfterUnlockCheckBox->setChecked(config()->get(Config::MinimizeAfterUnlock).toBool());
     m_generalUi->minimizeOnOpenUrlCheckBox->setChecked(config()->get(Config::MinimizeOnOpenUrl).toBool());
@@ -325,6 +371,7 @@ void ApplicationSettingsWidget::loadSettings()
         config()->get(Config::Security_NoConfirmMoveEntryToRecycleBin).toBool());
     m_secUi->EnableCopyOnDoubleClickCheckBox->setChecked(
         config()->get(Config::Security_EnableCopyOnDoubleClick).toBool());
+    m_secUi->storePasswordHealthCheckBox->setChecked(config()->get(Config::Security_StorePasswordHealth).toBool());
 
     m_secUi->quickUnlockCheckBox->setEnabled(getQuickUnlock()->isAvailable());
     m_secUi->quickUnlockCheckBox->setChecked(config()->get(Config::Security_QuickUnlock).toBool());
@@ -364,6 +411,8 @@ void ApplicationSettingsWidget::saveSettings()
 
     config()->set(Config::UseAtomicSaves, !m_generalUi->useAlternativeSaveCheckBox->isChecked());
     config()->set(Config::UseDirectWriteSaves, m_generalUi->alternativeSaveComboBox->currentIndex() == 1);
+    config()->set(Config::CacheNetworkDatabases, m_generalUi->cacheNetworkDatabasesCheckBox->isChecked());
+    config()->set(Config::LazyHistoryLoading, m_generalUi->lazyHistoryLoadingCheckBox->isChecked());
     config()->set(Config::AutoReloadOnChange, m_generalUi->autoReloadOnChangeCheckBox->isChecked());
     config()->set(Config::MinimizeAfterUnlock, m_generalUi->minimizeAfterUnlockCheckBox->isChecked());
     config()->set(Config::MinimizeOnOpenUrl, m_generalUi->minimizeOnOpenUrlCheckBox->isChecked());
@@ -438,6 +487,7 @@ void ApplicationSettingsWidget::saveSettings()
     config()->set(Config::Security_NoConfirmMoveEntryToRecycleBin,
                   m_secUi->NoConfirmMoveEntryToRecycleBinCheckBox->isChecked());
     config()->set(Config::Security_EnableCopyOnDoubleClick, m_secUi->EnableCopyOnDoubleClickCheckBox->isChecked());
+    config()->set(Config::Security_StorePasswordHealth, m_secUi->storePasswordHealthCheckBox->isChecked());
 
     if (m_secUi->quickUnlockCheckBox->isEnabled()) {
         config()->set(Config::Security_QuickUnlock, m_secUi->quickUnlockCheckBox->isChecked());
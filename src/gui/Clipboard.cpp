@@ -66,8 +66,10 @@ void Clipboard::setText(const QString& text, bool clear)
     }
     clipboard->setMimeData(mime, QClipboard::Clipboard);
 
+    ++m_generation;
     if (clear) {
         m_lastCopied = text;
+        m_copiedGeneration = m_generation;
         if (config()->get(Config::Security_ClearClipboard).toBool()) {
             int timeout = config()->get(Config::Security_ClearClipboardTimeout).toInt();
             if (timeout > 0) {
@@ -91,14 +93,19 @@ void Clipboard::clearCopiedText()
     m_timer->stop();
     emit updateCountdown(-1, "");
 
+    // Nothing to clear, don't touch the clipboard at all
+    if (m_lastCopied.isEmpty()) {
+        return;
+    }
+
     auto* clipboard = QApplication::clipboard();
     if (!clipboard) {
         qWarning("Unable to access the clipboard.");
         return;
     }
 
-    if (m_lastCopied == clipboard->text(QClipboard::Clipboard)
-        || m_lastCopied == clipboard->text(QClipboard::Selection)) {
+    if (isCopiedText(clipboard, QClipboard::Clipboard)
+        || (clipboard->supportsSelection() && isCopiedText(clipboard, QClipboard::Selection))) {
         clipboard->clear(QClipboard::Clipboard);
         clipboard->clear(QClipboard::Selection);
     }
@@ -106,6 +113,23 @@ void Clipboard::clearCopiedText()
     m_lastCopied.clear();
 }
 
+/**
+ * Check if the clipboard still holds the text that has to be cleared.
+ *
+ * Reading the clipboard content of another application waits for it to
+ * answer, which can stall the GUI with some clipboard managers. As long as
+ * we own the clipboard its content is what we set last, so the generation
+ * of the copied text tells whether it was replaced in the meantime.
+ */
+bool Clipboard::isCopiedText(QClipboard* clipboard, QClipboard::Mode mode) const
+{
+    const bool owned = mode == QClipboard::Selection ? clipboard->ownsSelection() : clipboard->ownsClipboard();
+    if (owned) {
+        return m_copiedGeneration == m_generation;
+    }
+    return m_lastCopied == clipboard->text(mode);
+}
+
 void Clipboard::countdownTick()
 {
     if (--m_secondsToClear <= 0) {
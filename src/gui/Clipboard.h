@@ -19,6 +19,7 @@
 #ifndef KEEPASSX_CLIPBOARD_H
 #define KEEPASSX_CLIPBOARD_H
 
+#include <QClipboard>
 #include <QElapsedTimer>
 #include <QObject>
 #ifdef Q_OS_MACOS
@@ -53,6 +54,7 @@ private:
     static Clipboard* m_instance;
 
     void sendCountdownStatus();
+    bool isCopiedText(QClipboard* clipboard, QClipboard::Mode mode) const;
 
     QTimer* m_timer;
     int m_secondsToClear = 0;
@@ -63,6 +65,9 @@ private:
     static QPointer<MacPasteboard> m_pasteboard;
 #endif
     QString m_lastCopied;
+    // Incremented whenever text is copied, to tell if the text to clear was replaced
+    quint64 m_generation = 0;
+    quint64 m_copiedGeneration = 0;
 };
 
 inline Clipboard* clipboard()
@@ -21,6 +21,7 @@
 #include "core/Global.h"
 
 #include <QDir>
+#include <QGuiApplication>
 #include <QImageReader>
 #include <QPainter>
 #include <QPixmapCache>
@@ -62,6 +63,14 @@ QPixmap DatabaseIcons::icon(int index, IconSize size)
         Q_ASSERT_X(false, "DatabaseIcons::icon", "invalid icon index %d");
     }
 
+    // Reuse the scaled pixmap so badges applied to it are found in the cache as well
+    const auto pixmapCacheKey =
+        QStringLiteral("databaseicon-%1-%2-%3").arg(index).arg(size).arg(qApp->devicePixelRatio());
+    QPixmap pixmap;
+    if (QPixmapCache::find(pixmapCacheKey, &pixmap)) {
+        return pixmap;
+    }
+
     auto cacheKey = QString::number(index);
     auto icon = m_iconCache.value(cacheKey);
     if (icon.isNull()) {
@@ -70,7 +79,9 @@ QPixmap DatabaseIcons::icon(int index, IconSize size)
         m_iconCache.insert(cacheKey, icon);
     }
 
-    return icon.pixmap(iconSize(size));
+    pixmap = icon.pixmap(iconSize(size));
+    QPixmapCache::insert(pixmapCacheKey, pixmap);
+    return pixmap;
 }
 
 QPixmap DatabaseIcons::applyBadge(const QPixmap& basePixmap, Badges badgeIndex)
@@ -19,6 +19,7 @@
 #include "DatabaseOpenWidget.h"
 #include "ui_DatabaseOpenWidget.h"
 
+#include "core/AsyncTask.h"
 #include "gui/FileDialog.h"
 #include "gui/Icons.h"
 #include "gui/MainWindow.h"
@@ -59,6 +60,7 @@ DatabaseOpenWidget::DatabaseOpenWidget(QWidget* parent)
     m_ui->setupUi(this);
 
     m_ui->messageWidget->setHidden(true);
+    m_ui->unlockAllCheckBox->setVisible(false);
 
     m_hideTimer.setInterval(clearFormsDelay);
     m_hideTimer.setSingleShot(true);
@@ -287,10 +289,45 @@ void DatabaseOpenWidget::enterKey(const QString& pw, const QString& keyFile)
     openDatabase();
 }
 
+/**
+ * Unlock with a key that was prepared elsewhere, such as the credentials of
+ * another database with the transformed key for this one already computed.
+ * The form is left as it is if the key does not fit.
+ */
+void DatabaseOpenWidget::unlockWithKey(const QSharedPointer<CompositeKey>& key)
+{
+    setUserInteractionLock(true);
+
+    QString error;
+    m_db.reset(new Database());
+    m_db->setLazyHistoryLoading(config()->get(Config::LazyHistoryLoading).toBool());
+    if (m_db->open(m_filename, key, &error) && !m_db->hasMinorVersionMismatch()) {
+        emit dialogFinished(true);
+        clearForms();
+        return;
+    }
+
+    // Back to the public headers, the database is unlocked manually instead
+    m_db.reset(new Database());
+    m_db->open(m_filename, nullptr, &error);
+    setUserInteractionLock(false);
+}
+
+/**
+ * Offer to unlock the other locked databases with the same credentials.
+ */
+void DatabaseOpenWidget::setUnlockAllAvailable(bool available)
+{
+    m_ui->unlockAllCheckBox->setVisible(available);
+}
+
 void DatabaseOpenWidget::openDatabase()
 {
     // Cache this variable for future use then reset
-    bool blockQuickUnlock = m_blockQuickUnlock || isOnQuickUnlockScreen();
+    const bool quickUnlocking = isOnQuickUnlockScreen();
+    bool blockQuickUnlock = m_blockQuickUnlock || quickUnlocking;
+    const bool unlockAll = !isOnQuickUnlockScreen() && !m_ui->unlockAllCheckBox->isHidden()
+                           && m_ui->unlockAllCheckBox->isChecked();
     m_blockQuickUnlock = false;
 
     setUserInteractionLock(true);
@@ -306,6 +343,7 @@ void DatabaseOpenWidget::openDatabase()
 
     QString error;
     m_db.reset(new Database());
+    m_db->setLazyHistoryLoading(config()->get(Config::LazyHistoryLoading).toBool());
     bool ok = m_db->open(m_filename, databaseKey, &error);
 
     if (ok) {
@@ -336,12 +374,26 @@ void DatabaseOpenWidget::openDatabase()
 
         // Save Quick Unlock credentials if available
         if (!blockQuickUnlock && isQuickUnlockAvailable()) {
+            // Seal the transformed key along with the credentials so re-unlocking skips the KDF
+            if (m_db->kdf()) {
+                databaseKey->setTransformedKey(*m_db->kdf(), m_db->transformedDatabaseKey());
+            }
             auto keyData = databaseKey->serialize();
             getQuickUnlock()->setKey(m_db->publicUuid(), keyData);
             m_ui->messageWidget->hideMessage();
+        } else if (quickUnlocking && m_db->kdf() && databaseKey->challengeResponseKeys().isEmpty()
+                   && !databaseKey->hasTransformedKey(*m_db->kdf())) {
+            // The sealed transformed key is outdated, e.g. a save rotated the KDF seed. Seal the
+            // one just computed so the next Quick Unlock skips the KDF again.
+            databaseKey->setTransformedKey(*m_db->kdf(), m_db->transformedDatabaseKey());
+            getQuickUnlock()->setKey(m_db->publicUuid(), databaseKey->serialize());
         }
 
         emit dialogFinished(true);
+        // Hardware keys would have to be asked once for every database
+        if (unlockAll && databaseKey->challengeResponseKeys().isEmpty()) {
+            emit unlockAllRequested(databaseKey);
+        }
         clearForms();
     } else {
         if (!isOnQuickUnlockScreen() && m_ui->editPassword->text().isEmpty() && !m_retryUnlockWithEmptyPassword) {
@@ -406,7 +458,9 @@ QSharedPointer<CompositeKey> DatabaseOpenWidget::buildDatabaseKey()
     QString keyFilename = m_ui->keyFileLineEdit->text();
     if (!keyFilename.isEmpty()) {
         QString errorMsg;
-        if (!key->load(keyFilename, &errorMsg)) {
+        // Large key files are hashed off the GUI thread
+        bool loaded = AsyncTask::runAndWaitForFuture([&] { return key->load(keyFilename, &errorMsg); });
+        if (!loaded) {
             m_ui->messageWidget->showMessage(tr("Failed to open key file: %1").arg(errorMsg), MessageWidget::Error);
             return {};
         }
@@ -49,6 +49,8 @@ public:
     QString filename();
     void clearForms();
     void enterKey(const QString& pw, const QString& keyFile);
+    void unlockWithKey(const QSharedPointer<CompositeKey>& key);
+    void setUnlockAllAvailable(bool available);
     QSharedPointer<Database> database();
     bool unlockingDatabase();
 
@@ -61,6 +63,7 @@ public:
 
 signals:
     void dialogFinished(bool accepted);
+    void unlockAllRequested(const QSharedPointer<CompositeKey>& key);
 
 protected:
     bool event(QEvent* event) override;
@@ -21,8 +21,10 @@
 #include <QTabBar>
 
 #include "autotype/AutoType.h"
+#include "core/AsyncTask.h"
 #include "core/Merger.h"
 #include "core/Tools.h"
+#include "crypto/kdf/Argon2Kdf.h"
 #include "format/CsvExporter.h"
 #include "gui/Clipboard.h"
 #include "gui/DatabaseOpenDialog.h"
@@ -36,6 +38,25 @@
 #endif
 #include "gui/wizard/NewDatabaseWizard.h"
 #include "wizard/ImportWizard.h"
+#ifdef WITH_XC_KEESHARE
+#include "keeshare/KeeShare.h"
+#endif
+
+namespace
+{
+    // Memory the key transformations of databases unlocked together may use at once, in MiB
+    constexpr int ConcurrentUnlockMemory = 2048;
+
+    int transformMemory(const Kdf& kdf)
+    {
+        if (kdf.uuid() != KeePass2::KDF_ARGON2D && kdf.uuid() != KeePass2::KDF_ARGON2ID) {
+            return 0;
+        }
+        // A transformation that needs more than all of it runs on its own
+        const quint64 memory = static_cast<const Argon2Kdf&>(kdf).memory() / 1024;
+        return static_cast<int>(qBound<quint64>(1, memory, ConcurrentUnlockMemory));
+    }
+} // namespace
 
 DatabaseTabWidget::DatabaseTabWidget(QWidget* parent)
     : QTabWidget(parent)
@@ -43,6 +64,7 @@ DatabaseTabWidget::DatabaseTabWidget(QWidget* parent)
     , m_dbWidgetPendingLock(nullptr)
     , m_databaseOpenDialog(new DatabaseOpenDialog(this))
     , m_databaseOpenInProgress(false)
+    , m_unlockMemoryAvailable(ConcurrentUnlockMemory)
 {
     auto* tabBar = new QTabBar(this);
     tabBar->setAcceptDrops(true);
@@ -249,6 +271,8 @@ void DatabaseTabWidget::addDatabaseTab(DatabaseWidget* dbWidget, bool inBackgrou
     connect(dbWidget, SIGNAL(databaseUnlocked()), SLOT(emitDatabaseLockChanged()));
     connect(dbWidget, SIGNAL(databaseLocked()), SLOT(updateTabName()));
     connect(dbWidget, SIGNAL(databaseLocked()), SLOT(emitDatabaseLockChanged()));
+    connect(dbWidget, &DatabaseWidget::requestUnlockAll, this, &DatabaseTabWidget::unlockDatabasesWithKey);
+    updateUnlockAllAvailable();
 }
 
 DatabaseWidget* DatabaseTabWidget::importFile()
@@ -372,6 +396,7 @@ bool DatabaseTabWidget::closeDatabaseTab(DatabaseWidget* dbWidget)
     removeTab(tabIndex);
     dbWidget->deleteLater();
     toggleTabbar();
+    updateUnlockAllAvailable();
     emit databaseClosed(filePath);
     return true;
 }
@@ -506,20 +531,34 @@ void DatabaseTabWidget::exportToXML()
 
     FileDialog::saveLastDir("xml", fileName, true);
 
-    QByteArray xmlData;
-    QString err;
-    if (!db->extract(xmlData, &err)) {
-        emit messageGlobal(tr("Writing the XML file failed").append("\n").append(err), MessageWidget::Error);
-    }
-
     QFile file(fileName);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
         emit messageGlobal(tr("Writing the XML file failed").append("\n").append(file.errorString()),
                            MessageWidget::Error);
+        return;
+    }
+
+    QString err;
+    if (!db->extract(&file, &err)) {
+        emit messageGlobal(tr("Writing the XML file failed").append("\n").append(err), MessageWidget::Error);
     }
-    file.write(xmlData);
 }
 
+#ifdef WITH_XC_KEESHARE
+/**
+ * Write every KeeShare export container of the current database, including
+ * those a save skips because their shared group did not change.
+ */
+void DatabaseTabWidget::exportKeeShareContainers()
+{
+    auto dbWidget = currentDatabaseWidget();
+    if (!dbWidget || dbWidget->isLocked()) {
+        return;
+    }
+    KeeShare::instance()->forceExport(dbWidget->database());
+}
+#endif
+
 bool DatabaseTabWidget::warnOnExport()
 {
     auto ans =
@@ -844,6 +883,90 @@ void DatabaseTabWidget::emitDatabaseLockChanged()
         emit databaseUnlocked(dbWidget);
         m_databaseOpenInProgress = false;
     }
+    updateUnlockAllAvailable();
+}
+
+/**
+ * Offer to unlock all locked databases at once while there is more than one.
+ */
+void DatabaseTabWidget::updateUnlockAllAvailable()
+{
+    int lockedCount = 0;
+    for (int i = 0, c = count(); i < c; ++i) {
+        if (databaseWidgetFromIndex(i)->isLocked()) {
+            ++lockedCount;
+        }
+    }
+    for (int i = 0, c = count(); i < c; ++i) {
+        databaseWidgetFromIndex(i)->setUnlockAllAvailable(lockedCount > 1);
+    }
+}
+
+/**
+ * Unlock all locked databases with the credentials that just unlocked one of them.
+ *
+ * The KDFs of the databases run concurrently, as many at once as fit into
+ * ConcurrentUnlockMemory, and each database is unlocked as soon as its
+ * transformed key is ready. Databases that use other credentials stay locked.
+ *
+ * @param key credentials entered for another database
+ */
+void DatabaseTabWidget::unlockDatabasesWithKey(const QSharedPointer<CompositeKey>& key)
+{
+    const QByteArray keyData = key->serialize();
+
+    for (int i = 0, c = count(); i < c; ++i) {
+        QPointer<DatabaseWidget> dbWidget = databaseWidgetFromIndex(i);
+        const auto headerKdf = dbWidget->lockedDatabaseKdf();
+        if (!headerKdf) {
+            continue;
+        }
+
+        // Every database caches its own transformed key in its copy of the key
+        PendingUnlock unlock;
+        unlock.dbWidget = dbWidget;
+        unlock.key = QSharedPointer<CompositeKey>::create();
+        unlock.key->setRawKey(keyData);
+        unlock.kdf = headerKdf->clone();
+        unlock.memory = transformMemory(*unlock.kdf);
+        m_pendingUnlocks.append(unlock);
+    }
+
+    startPendingUnlocks();
+}
+
+/**
+ * Start the key transformations of pending unlocks in order while their memory
+ * fits into what is left of ConcurrentUnlockMemory. Tasks never wait for memory
+ * on the thread pool, the next ones are started when a running one finishes.
+ */
+void DatabaseTabWidget::startPendingUnlocks()
+{
+    while (!m_pendingUnlocks.isEmpty() && m_pendingUnlocks.first().memory <= m_unlockMemoryAvailable) {
+        const PendingUnlock unlock = m_pendingUnlocks.takeFirst();
+        m_unlockMemoryAvailable -= unlock.memory;
+
+        const auto key = unlock.key;
+        const auto kdf = unlock.kdf;
+        AsyncTask::runThenCallback(
+            [key, kdf] {
+                QByteArray transformedKey;
+                if (!key->transform(*kdf, transformedKey)) {
+                    transformedKey.clear();
+                }
+                return transformedKey;
+            },
+            this,
+            [this, unlock](const QByteArray& transformedKey) {
+                m_unlockMemoryAvailable += unlock.memory;
+                if (unlock.dbWidget && !transformedKey.isEmpty()) {
+                    unlock.key->setTransformedKey(*unlock.kdf, transformedKey);
+                    unlock.dbWidget->unlockWithKey(unlock.key);
+                }
+                startPendingUnlocks();
+            },
+            AsyncTask::Priority::Interactive);
+    }
 }
 
 void DatabaseTabWidget::performGlobalAutoType(const QString& search)
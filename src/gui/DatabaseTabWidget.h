@@ -25,10 +25,12 @@
 #include <QTabWidget>
 #include <QTimer>
 
+class CompositeKey;
 class Database;
 class DatabaseWidget;
 class DatabaseWidgetStateSync;
 class DatabaseOpenWidget;
+class Kdf;
 
 class DatabaseTabWidget : public QTabWidget
 {
@@ -71,6 +73,9 @@ public slots:
     void exportToCsv();
     void exportToHtml();
     void exportToXML();
+#ifdef WITH_XC_KEESHARE
+    void exportKeeShareContainers();
+#endif
 
     bool lockDatabases();
     void lockDatabasesDelayed();
@@ -78,6 +83,7 @@ public slots:
     void unlockDatabaseInDialog(DatabaseWidget* dbWidget, DatabaseOpenDialog::Intent intent);
     void unlockDatabaseInDialog(DatabaseWidget* dbWidget, DatabaseOpenDialog::Intent intent, const QString& filePath);
     void unlockAnyDatabaseInDialog(DatabaseOpenDialog::Intent intent);
+    void unlockDatabasesWithKey(const QSharedPointer<CompositeKey>& key);
     void relockPendingDatabase();
 
     void showDatabaseSecurity();
@@ -107,6 +113,7 @@ private slots:
     void toggleTabbar();
     void emitActiveDatabaseChanged();
     void emitDatabaseLockChanged();
+    void updateUnlockAllAvailable();
     void handleDatabaseUnlockDialogFinished(bool accepted, DatabaseWidget* dbWidget);
     void handleExportError(const QString& reason);
     void updateLastDatabases();
@@ -116,12 +123,24 @@ private:
     void updateLastDatabases(const QString& filename);
     bool warnOnExport();
     void displayUnlockDialog();
+    void startPendingUnlocks();
+
+    struct PendingUnlock
+    {
+        QPointer<DatabaseWidget> dbWidget;
+        QSharedPointer<CompositeKey> key;
+        QSharedPointer<Kdf> kdf;
+        int memory = 0;
+    };
 
     QPointer<DatabaseWidgetStateSync> m_dbWidgetStateSync;
     QPointer<DatabaseWidget> m_dbWidgetPendingLock;
     QPointer<DatabaseOpenDialog> m_databaseOpenDialog;
     QTimer m_lockDelayTimer;
     bool m_databaseOpenInProgress;
+    QList<PendingUnlock> m_pendingUnlocks;
+    // Memory in MiB left for the key transformations of pending unlocks
+    int m_unlockMemoryAvailable;
 };
 
 #endif // KEEPASSX_DATABASETABWIDGET_H
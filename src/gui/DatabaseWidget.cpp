@@ -22,18 +22,23 @@
 #include <QBoxLayout>
 #include <QCheckBox>
 #include <QDesktopServices>
+#include <QElapsedTimer>
 #include <QHostInfo>
 #include <QInputDialog>
 #include <QKeyEvent>
 #include <QPlainTextEdit>
 #include <QProcess>
+#include <QScopedValueRollback>
 #include <QSplitter>
 #include <QTextDocumentFragment>
 #include <QTextEdit>
 
 #include "autotype/AutoType.h"
+#include "core/AttachmentTextIndex.h"
+#include "core/AutoSaveScheduler.h"
 #include "core/EntrySearcher.h"
 #include "core/Merger.h"
+#include "core/PasswordHealth.h"
 #include "core/Tools.h"
 #include "gui/Clipboard.h"
 #include "gui/CloneDialog.h"
@@ -55,6 +60,8 @@
 #include "gui/tag/TagView.h"
 #include "gui/widgets/ElidedLabel.h"
 #include "keeshare/KeeShare.h"
+#include "keys/CompositeKey.h"
+#include "quickunlock/QuickUnlockInterface.h"
 
 #ifdef WITH_XC_NETWORKING
 #include "gui/IconDownloaderDialog.h"
@@ -207,6 +214,7 @@ DatabaseWidget::DatabaseWidget(QSharedPointer<Database> db, QWidget* parent)
     connect(m_reportsDialog, SIGNAL(editFinished(bool)), SLOT(switchToMainView(bool)));
     connect(m_databaseSettingDialog, SIGNAL(editFinished(bool)), SLOT(switchToMainView(bool)));
     connect(m_databaseOpenWidget, SIGNAL(dialogFinished(bool)), SLOT(loadDatabase(bool)));
+    connect(m_databaseOpenWidget, &DatabaseOpenWidget::unlockAllRequested, this, &DatabaseWidget::requestUnlockAll);
     connect(this, SIGNAL(currentChanged(int)), SLOT(emitCurrentModeChanged()));
     connect(this, SIGNAL(requestGlobalAutoType(const QString&)), parent, SLOT(performGlobalAutoType(const QString&)));
     // clang-format on
@@ -214,12 +222,21 @@ DatabaseWidget::DatabaseWidget(QSharedPointer<Database> db, QWidget* parent)
     connectDatabaseSignals();
 
     m_blockAutoSave = false;
+    m_autosavePending = false;
+    m_saving = false;
 
-    m_autosaveTimer = new QTimer(this);
-    m_autosaveTimer->setSingleShot(true);
-    connect(m_autosaveTimer, SIGNAL(timeout()), this, SLOT(onAutosaveDelayTimeout()));
+    m_autosaveScheduler = new AutoSaveScheduler(this);
+    connect(m_autosaveScheduler, &AutoSaveScheduler::saveRequested, this, &DatabaseWidget::onAutosaveRequested);
+
+    m_postUnlockTasks = new DeferredTaskQueue(this);
+
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    connect(m_searchTimer, SIGNAL(timeout()), this, SLOT(continueSearch()));
 
     m_searchLimitGroup = config()->get(Config::SearchLimitGroup).toBool();
+    m_searchAttachmentContents = config()->get(Config::SearchAttachmentContents).toBool();
+    m_db->attachmentTextIndex()->setEnabled(m_searchAttachmentContents);
 
 #ifdef WITH_XC_KEESHARE
     // We need to reregister the database to allow exports
@@ -450,6 +467,8 @@ void DatabaseWidget::replaceDatabase(QSharedPointer<Database> db)
     connectDatabaseSignals();
     m_groupView->changeDatabase(m_db);
     m_tagView->setDatabase(m_db);
+    m_entrySearcher->clearCachedSearches();
+    m_db->attachmentTextIndex()->setEnabled(m_searchAttachmentContents);
 
     // Restore the new parent group pointer, if not found default to the root group
     // this prevents data loss when merging a database while creating a new entry
@@ -462,14 +481,40 @@ void DatabaseWidget::replaceDatabase(QSharedPointer<Database> db)
 
     emit databaseReplaced(oldDb, m_db);
 
+    // Work queued for the old database must not run against the new one
+    m_postUnlockTasks->clear();
+
 #if defined(WITH_XC_KEESHARE)
-    KeeShare::instance()->connectDatabase(m_db, oldDb);
-#else
-    // Keep the instance active till the end of this function
-    Q_UNUSED(oldDb);
+    KeeShare::instance()->connectDatabase({}, oldDb);
+    schedulePostUnlockTask(DeferredTaskQueue::Normal, "KeeShare", [](QSharedPointer<Database> db) {
+        KeeShare::instance()->connectDatabase(db, {});
+    });
 #endif
+    schedulePostUnlockTask(DeferredTaskQueue::Low, "statistics", [](QSharedPointer<Database> db) {
+        db->updateTagList();
+        db->updateCommonUsernames();
+    });
 
-    oldDb->releaseData();
+    // The old tree is no longer shown, do not hold up the switch with freeing it
+    oldDb->releaseData(true);
+}
+
+/**
+ * Run work that the entry list does not depend on once the event loop is
+ * idle, so a freshly unlocked database is shown right away. The task is
+ * dropped if the database is replaced or locked before it runs.
+ */
+void DatabaseWidget::schedulePostUnlockTask(DeferredTaskQueue::Priority priority,
+                                            const QString& name,
+                                            std::function<void(QSharedPointer<Database>)> task)
+{
+    QWeakPointer<Database> weakDb = m_db;
+    m_postUnlockTasks->schedule(priority, name, [this, weakDb, task] {
+        auto db = weakDb.toStrongRef();
+        if (db && db == m_db) {
+            task(db);
+        }
+    });
 }
 
 void DatabaseWidget::cloneEntry()
@@ -728,13 +773,15 @@ void DatabaseWidget::filterByTag()
     for (const auto& index : selections) {
         searchTerms << index.data(Qt::UserRole).toString();
     }
-    emit requestSearch(searchTerms.join(" "));
+    m_sidebarSearchText = searchTerms.join(" ");
+    emit requestSearch(m_sidebarSearchText);
 }
 
 void DatabaseWidget::setTag(QAction* action)
 {
     auto tag = action->text();
     auto state = action->isChecked();
+    Database::BatchUpdate batch(m_db.data());
     for (auto entry : m_entryView->selectedEntries()) {
         state ? entry->addTag(tag) : entry->removeTag(tag);
     }
@@ -1144,6 +1191,8 @@ void DatabaseWidget::connectDatabaseSignals()
     connect(m_db.data(), &Database::modified, this, &DatabaseWidget::databaseModified);
     connect(m_db.data(), &Database::modified, this, &DatabaseWidget::onDatabaseModified);
     connect(m_db.data(), &Database::databaseSaved, this, &DatabaseWidget::databaseSaved);
+    connect(m_db.data(), &Database::databaseSaved, this, &DatabaseWidget::onDatabaseSaved);
+    connect(m_db.data(), &Database::backgroundSaveFinished, this, &DatabaseWidget::onBackgroundSaveFinished);
     connect(m_db.data(), &Database::databaseFileChanged, this, &DatabaseWidget::reloadDatabaseFile);
     connect(m_db.data(), &Database::databaseNonDataChanged, this, &DatabaseWidget::databaseNonDataChanged);
     connect(m_db.data(), &Database::databaseNonDataChanged, this, &DatabaseWidget::onDatabaseNonDataChanged);
@@ -1181,7 +1230,9 @@ void DatabaseWidget::loadDatabase(bool accepted)
         m_saveAttempts = 0;
         emit databaseUnlocked();
 #ifdef WITH_XC_SSHAGENT
-        sshAgent()->databaseUnlocked(m_db);
+        schedulePostUnlockTask(DeferredTaskQueue::High, "SSH agent", [](QSharedPointer<Database> db) {
+            sshAgent()->databaseUnlocked(db);
+        });
 #endif
         if (config()->get(Config::MinimizeAfterUnlock).toBool()) {
             getMainWindow()->minimizeOrHide();
@@ -1216,6 +1267,7 @@ void DatabaseWidget::mergeDatabase(bool accepted)
         }
 
         Merger merger(srcDb.data(), m_db.data());
+        merger.setParallel(true);
         QStringList changeList = merger.merge();
 
         if (!changeList.isEmpty()) {
@@ -1267,7 +1319,9 @@ void DatabaseWidget::unlockDatabase(bool accepted)
     emit databaseUnlocked();
 
 #ifdef WITH_XC_SSHAGENT
-    sshAgent()->databaseUnlocked(m_db);
+    schedulePostUnlockTask(DeferredTaskQueue::High, "SSH agent", [](QSharedPointer<Database> db) {
+        sshAgent()->databaseUnlocked(db);
+    });
 #endif
 
     if (config()->get(Config::MinimizeAfterUnlock).toBool()) {
@@ -1366,6 +1420,33 @@ void DatabaseWidget::switchToOpenDatabase(const QString& filePath, const QString
     m_databaseOpenWidget->enterKey(password, keyFile);
 }
 
+/**
+ * @return KDF from the header of the locked database file, null if the database is not locked
+ */
+QSharedPointer<Kdf> DatabaseWidget::lockedDatabaseKdf() const
+{
+    const auto headerDb = m_databaseOpenWidget->database();
+    if (!isLocked() || !headerDb) {
+        return {};
+    }
+    return headerDb->kdf();
+}
+
+/**
+ * Unlock the database with a key prepared for it, see DatabaseTabWidget::unlockDatabasesWithKey().
+ */
+void DatabaseWidget::unlockWithKey(const QSharedPointer<CompositeKey>& key)
+{
+    if (isLocked()) {
+        m_databaseOpenWidget->unlockWithKey(key);
+    }
+}
+
+void DatabaseWidget::setUnlockAllAvailable(bool available)
+{
+    m_databaseOpenWidget->setUnlockAllAvailable(available);
+}
+
 void DatabaseWidget::switchToEntryEdit()
 {
     auto entry = m_entryView->currentEntry();
@@ -1442,7 +1523,8 @@ void DatabaseWidget::refreshSearch()
 {
     if (isSearchActive()) {
         auto selectedEntry = m_entryView->currentEntry();
-        search(m_lastSearchText);
+        // Search in one go, the previous entry has to be in the results to re-select it
+        performSearch(m_lastSearchText, false);
         // Re-select the previous entry if it is still in the search
         m_entryView->setCurrentEntry(selectedEntry);
     }
@@ -1450,6 +1532,23 @@ void DatabaseWidget::refreshSearch()
 
 void DatabaseWidget::search(const QString& searchtext)
 {
+    performSearch(searchtext, true);
+}
+
+/**
+ * Run a search and display its results. Incremental searches only check
+ * entries for a short time slice before returning to the event loop, the
+ * remaining results are appended by continueSearch() and a new search
+ * cancels the one still running. Searches selected in the tag view are
+ * kept up to date by the entry searcher and are always complete.
+ *
+ * @param searchtext search string
+ * @param incremental allow the search to continue in the background
+ */
+void DatabaseWidget::performSearch(const QString& searchtext, bool incremental)
+{
+    cancelSearch();
+
     if (searchtext.isEmpty()) {
         endSearch();
         return;
@@ -1460,7 +1559,24 @@ void DatabaseWidget::search(const QString& searchtext)
         searchGroup = currentGroup();
     }
 
-    auto results = m_entrySearcher->search(searchtext, searchGroup);
+    QList<Entry*> results;
+    bool finished = true;
+    QElapsedTimer timer;
+    timer.start();
+    if (searchtext == m_sidebarSearchText) {
+        // Only the entries changed since the last time have to be checked
+        results = m_entrySearcher->searchCached(searchtext, searchGroup);
+        m_db->counters().recordSearch(timer.nsecsElapsed());
+    } else {
+        m_pendingSearch.db = m_db.data();
+        m_pendingSearch.revision = m_db->contentRevision();
+        m_pendingSearch.searchText = searchtext;
+        m_pendingSearch.entries = m_entrySearcher->beginSearch(searchtext, searchGroup);
+        m_pendingSearch.nsecs = timer.nsecsElapsed();
+
+        // Custom searches need all results to decide whether to show up at all
+        finished = searchNextChunk(results, incremental && m_nextSearchLabelText.isEmpty());
+    }
 
     // Display a label detailing our search results
     if (!m_nextSearchLabelText.isEmpty()) {
@@ -1471,10 +1587,8 @@ void DatabaseWidget::search(const QString& searchtext)
         }
         m_searchingLabel->setText(m_nextSearchLabelText);
         m_nextSearchLabelText.clear();
-    } else if (!results.isEmpty()) {
-        m_searchingLabel->setText(tr("Search Results (%1)").arg(results.size()));
     } else {
-        m_searchingLabel->setText(tr("No Results"));
+        updateSearchLabel(results.size(), finished);
     }
 
     emit searchModeAboutToActivate();
@@ -1488,6 +1602,92 @@ void DatabaseWidget::search(const QString& searchtext)
 #endif
 
     emit searchModeActivated();
+
+    if (!finished) {
+        m_searchTimer->start(0);
+    }
+}
+
+void DatabaseWidget::continueSearch()
+{
+    if (!m_pendingSearch.db) {
+        return;
+    }
+
+    // The remaining entries may be gone, start over
+    if (m_pendingSearch.db != m_db.data() || m_pendingSearch.revision != m_db->contentRevision()) {
+        performSearch(m_pendingSearch.searchText, true);
+        return;
+    }
+
+    const int previousResults = m_pendingSearch.results.size();
+    QList<Entry*> results;
+    const bool finished = searchNextChunk(results, true);
+    m_entryView->appendSearch(results);
+    updateSearchLabel(previousResults + results.size(), finished);
+
+    if (!finished) {
+        m_searchTimer->start(0);
+    }
+}
+
+/**
+ * Check the next pending entries of the running search.
+ *
+ * @param results receives the matching entries of this chunk
+ * @param incremental stop after a short time slice instead of checking all entries
+ * @return true if the search is complete
+ */
+bool DatabaseWidget::searchNextChunk(QList<Entry*>& results, bool incremental)
+{
+    static const int ChunkSize = 64;
+    static const int SliceMsecs = 20;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto& pending = m_pendingSearch;
+    while (pending.position < pending.entries.size()) {
+        const auto chunk = pending.entries.mid(pending.position, ChunkSize);
+        pending.position += chunk.size();
+        results.append(m_entrySearcher->repeatEntries(chunk));
+
+        if (incremental && timer.elapsed() >= SliceMsecs) {
+            break;
+        }
+    }
+    pending.results.append(results);
+    pending.nsecs += timer.nsecsElapsed();
+
+    if (pending.position < pending.entries.size()) {
+        return false;
+    }
+
+    m_entrySearcher->finishSearch(pending.results);
+    m_db->counters().recordSearch(pending.nsecs);
+    cancelSearch();
+    return true;
+}
+
+void DatabaseWidget::cancelSearch()
+{
+    m_searchTimer->stop();
+    m_pendingSearch.db = nullptr;
+    m_pendingSearch.entries.clear();
+    m_pendingSearch.position = 0;
+    m_pendingSearch.results.clear();
+    m_pendingSearch.nsecs = 0;
+}
+
+void DatabaseWidget::updateSearchLabel(int results, bool finished)
+{
+    if (!finished) {
+        m_searchingLabel->setText(tr("Searching… (%1)").arg(results));
+    } else if (results > 0) {
+        m_searchingLabel->setText(tr("Search Results (%1)").arg(results));
+    } else {
+        m_searchingLabel->setText(tr("No Results"));
+    }
 }
 
 void DatabaseWidget::saveSearch(const QString& searchtext)
@@ -1536,6 +1736,12 @@ void DatabaseWidget::setSearchLimitGroup(bool state)
     refreshSearch();
 }
 
+void DatabaseWidget::setSearchAttachmentContents(bool state)
+{
+    m_searchAttachmentContents = state;
+    m_db->attachmentTextIndex()->setEnabled(state);
+}
+
 void DatabaseWidget::onGroupChanged()
 {
     auto group = m_groupView->currentGroup();
@@ -1566,41 +1772,126 @@ void DatabaseWidget::onGroupChanged()
 void DatabaseWidget::onDatabaseModified()
 {
     refreshSearch();
-    int autosaveDelayMs = m_db->metadata()->autosaveDelayMin() * 60 * 1000; // min to msec for QTimer
-    bool autosaveAfterEveryChangeConfig = config()->get(Config::AutoSaveAfterEveryChange).toBool();
-    if (autosaveDelayMs > 0 && autosaveAfterEveryChangeConfig) {
-        // reset delay when modified
-        m_autosaveTimer->start(autosaveDelayMs);
-        return;
-    }
-    if (!m_blockAutoSave && autosaveAfterEveryChangeConfig) {
-        save();
+    if (!m_blockAutoSave && config()->get(Config::AutoSaveAfterEveryChange).toBool()) {
+        // Bursts of changes are saved at once, the delay of the database replaces the quiet period
+        int autosaveDelayMs = m_db->metadata()->autosaveDelayMin() * 60 * 1000; // min to msec for QTimer
+        if (autosaveDelayMs <= 0) {
+            autosaveDelayMs = config()->get(Config::AutoSaveQuietPeriod).toInt();
+        }
+        m_autosaveScheduler->setQuietPeriod(autosaveDelayMs);
+        m_autosaveScheduler->setMaxDelay(config()->get(Config::AutoSaveMaxDelay).toInt());
+        m_autosaveScheduler->schedule();
     } else {
         // Only block once, then reset
         m_blockAutoSave = false;
     }
 }
 
-void DatabaseWidget::onAutosaveDelayTimeout()
+void DatabaseWidget::onAutosaveRequested()
 {
-    const bool isAutosaveDelayEnabled = m_db->metadata()->autosaveDelayMin() > 0;
-    const bool autosaveAfterEveryChangeConfig = config()->get(Config::AutoSaveAfterEveryChange).toBool();
-    if (!(isAutosaveDelayEnabled && autosaveAfterEveryChangeConfig)) {
-        // User might disable the delay/autosave while the timer is running
+    // User might disable autosave while a save is pending
+    if (config()->get(Config::AutoSaveAfterEveryChange).toBool()) {
+        autosave();
+    }
+}
+
+/**
+ * Keep the password strength results in the database if enabled, so they
+ * are known right after unlocking it. Removes them otherwise.
+ */
+void DatabaseWidget::storePasswordHealth()
+{
+    if (config()->get(Config::Security_StorePasswordHealth).toBool()) {
+        PasswordHealthCache::instance()->store(m_db.data());
+    } else {
+        PasswordHealthCache::remove(m_db.data());
+    }
+}
+
+/**
+ * Save the database without blocking the user interface. New databases
+ * have no file yet and are saved interactively instead.
+ */
+void DatabaseWidget::autosave()
+{
+    if (m_saving) {
         return;
     }
-    if (!m_blockAutoSave) {
+
+    if (isLocked() || m_db->filePath().isEmpty()) {
         save();
-    } else {
-        // Only block once, then reset
-        m_blockAutoSave = false;
+        return;
+    }
+
+    if (m_db->isSaving()) {
+        m_autosavePending = true;
+        return;
+    }
+
+    // Auto-saves happen often and may trade file size for speed
+    m_db->setCompressionLevel(config()->get(Config::AutoSaveCompressionLevel).toInt());
+    m_db->setBackupGenerations(config()->get(Config::BackupGenerations).toInt());
+    storePasswordHealth();
+
+    QString errorMessage;
+    if (!m_db->saveInBackground(saveAction(), backupFilePath(), &errorMessage)) {
+        showMessage(tr("Writing the database failed: %1").arg(errorMessage),
+                    MessageWidget::Error,
+                    true,
+                    MessageWidget::LongAutoHideTimeout);
+    }
+}
+
+void DatabaseWidget::onBackgroundSaveFinished(bool ok, const QString& errorMessage)
+{
+    if (!ok) {
+        m_autosavePending = false;
+        // Repeated failures get the same recovery as interactive saves, unless one is running already
+        if (++m_saveAttempts > 2 && !m_saving && config()->get(Config::UseAtomicSaves).toBool()) {
+            save();
+            return;
+        }
+        showMessage(tr("Writing the database failed: %1").arg(errorMessage),
+                    MessageWidget::Error,
+                    true,
+                    MessageWidget::LongAutoHideTimeout);
+        return;
+    }
+
+    m_saveAttempts = 0;
+    // Reported while a synchronous save supersedes the background save, which saves all changes
+    if (m_autosavePending && !m_saving) {
+        m_autosavePending = false;
+        if (m_db->isModified()) {
+            autosave();
+        }
     }
 }
 
 void DatabaseWidget::triggerAutosaveTimer()
 {
-    m_autosaveTimer->stop();
-    QMetaObject::invokeMethod(m_autosaveTimer, "timeout");
+    m_autosaveScheduler->flush();
+}
+
+/**
+ * Saving rotates the KDF seed, which outdates the transformed key sealed for
+ * Quick Unlock. Seal the key computed for the save in its place.
+ */
+void DatabaseWidget::onDatabaseSaved()
+{
+    if (!config()->get(Config::Security_QuickUnlock).toBool() || !getQuickUnlock()->hasKey(m_db->publicUuid())) {
+        return;
+    }
+
+    auto key = m_db->key();
+    if (!key || !m_db->kdf() || !key->challengeResponseKeys().isEmpty() || key->hasTransformedKey(*m_db->kdf())) {
+        return;
+    }
+
+    auto sealedKey = QSharedPointer<CompositeKey>::create();
+    sealedKey->setRawKey(key->serialize());
+    sealedKey->setTransformedKey(*m_db->kdf(), m_db->transformedDatabaseKey());
+    getQuickUnlock()->setKey(m_db->publicUuid(), sealedKey->serialize());
 }
 
 void DatabaseWidget::onDatabaseNonDataChanged()
@@ -1618,6 +1909,8 @@ QString DatabaseWidget::getCurrentSearch()
 
 void DatabaseWidget::endSearch()
 {
+    cancelSearch();
+
     if (isSearchActive()) {
         // Show the normal entry view of the current group
         emit listModeAboutToActivate();
@@ -1769,6 +2062,10 @@ bool DatabaseWidget::lock()
         }
     }
 
+    // Pending changes are saved or discarded right here
+    m_autosaveScheduler->cancel();
+    m_autosavePending = false;
+
     if (m_db->isModified()) {
         bool saved = false;
         // Attempt to save on exit, but don't block locking if it fails
@@ -1861,6 +2158,9 @@ void DatabaseWidget::reloadDatabaseFile()
 
     QString error;
     auto db = QSharedPointer<Database>::create(m_db->filePath());
+    // Skip the key derivation if the KDF parameters of the file are unchanged
+    db->reuseTransformedKey(m_db.data());
+    db->setLazyHistoryLoading(m_db->lazyHistoryLoading());
     if (db->open(database()->key(), &error)) {
         if (m_db->isModified() || db->hasNonDataChanges()) {
             // Ask if we want to merge changes into new database
@@ -1874,23 +2174,29 @@ void DatabaseWidget::reloadDatabaseFile()
             if (result == MessageBox::Merge) {
                 // Merge the old database into the new one
                 Merger merger(m_db.data(), db.data());
+                merger.setParallel(true);
                 merger.merge();
             }
         }
 
-        QUuid groupBeforeReload = m_db->rootGroup()->uuid();
-        if (m_groupView && m_groupView->currentGroup()) {
-            groupBeforeReload = m_groupView->currentGroup()->uuid();
-        }
+        // Only update what changed, the views keep their state then
+        if (!m_db->reloadFrom(db.data())) {
+            QUuid groupBeforeReload = m_db->rootGroup()->uuid();
+            if (m_groupView && m_groupView->currentGroup()) {
+                groupBeforeReload = m_groupView->currentGroup()->uuid();
+            }
 
-        QUuid entryBeforeReload;
-        if (m_entryView && m_entryView->currentEntry()) {
-            entryBeforeReload = m_entryView->currentEntry()->uuid();
-        }
+            QUuid entryBeforeReload;
+            if (m_entryView && m_entryView->currentEntry()) {
+                entryBeforeReload = m_entryView->currentEntry()->uuid();
+            }
 
-        replaceDatabase(db);
-        processAutoOpen();
-        restoreGroupEntryFocus(groupBeforeReload, entryBeforeReload);
+            replaceDatabase(db);
+            processAutoOpen();
+            restoreGroupEntryFocus(groupBeforeReload, entryBeforeReload);
+        } else {
+            processAutoOpen();
+        }
         m_blockAutoSave = false;
     } else {
         showMessage(tr("Could not open the new database file while attempting to autoreload.\nError: %1").arg(error),
@@ -2070,7 +2376,7 @@ bool DatabaseWidget::save()
     if (performSave(errorMessage)) {
         m_saveAttempts = 0;
         m_blockAutoSave = false;
-        m_autosaveTimer->stop(); // stop autosave delay to avoid triggering another save
+        m_autosaveScheduler->cancel(); // stop autosave delay to avoid triggering another save
         return true;
     }
 
@@ -2140,46 +2446,25 @@ bool DatabaseWidget::performSave(QString& errorMessage, const QString& fileName)
 {
     QPointer<QWidget> focusWidget(qApp->focusWidget());
 
+    // Changes waiting for an autosave are part of this save
+    m_autosavePending = false;
+    QScopedValueRollback<bool> saving(m_saving, true);
+
     // Lock out interactions
     m_entryView->setDisabled(true);
     m_groupView->setDisabled(true);
     m_tagView->setDisabled(true);
     QApplication::processEvents();
 
-    Database::SaveAction saveAction = Database::Atomic;
-    if (!config()->get(Config::UseAtomicSaves).toBool()) {
-        if (config()->get(Config::UseDirectWriteSaves).toBool()) {
-            saveAction = Database::DirectWrite;
-        } else {
-            saveAction = Database::TempFile;
-        }
-    }
-
-    QString backupFilePath;
-    if (config()->get(Config::BackupBeforeSave).toBool()) {
-        backupFilePath = config()->get(Config::BackupFilePathPattern).toString();
-        // Fall back to default
-        if (backupFilePath.isEmpty()) {
-            backupFilePath = config()->getDefault(Config::BackupFilePathPattern).toString();
-        }
-
-        QFileInfo dbFileInfo(m_db->filePath());
-        backupFilePath = Tools::substituteBackupFilePath(backupFilePath, dbFileInfo.canonicalFilePath());
-        if (!backupFilePath.isNull()) {
-            // Note that we cannot guarantee that backupFilePath is actually a valid filename. QT currently provides
-            // no function for this. Moreover, we don't check if backupFilePath is a file and not a directory.
-            // If this isn't the case, just let the backup fail.
-            if (QDir::isRelativePath(backupFilePath)) {
-                backupFilePath = QDir::cleanPath(dbFileInfo.absolutePath() + QDir::separator() + backupFilePath);
-            }
-        }
-    }
+    m_db->setCompressionLevel(config()->get(Config::CompressionLevel).toInt());
+    m_db->setBackupGenerations(config()->get(Config::BackupGenerations).toInt());
+    storePasswordHealth();
 
     bool ok;
     if (fileName.isEmpty()) {
-        ok = m_db->save(saveAction, backupFilePath, &errorMessage);
+        ok = m_db->save(saveAction(), backupFilePath(), &errorMessage);
     } else {
-        ok = m_db->saveAs(fileName, saveAction, backupFilePath, &errorMessage);
+        ok = m_db->saveAs(fileName, saveAction(), backupFilePath(), &errorMessage);
     }
 
     // Return control
@@ -2194,6 +2479,42 @@ bool DatabaseWidget::performSave(QString& errorMessage, const QString& fileName)
     return ok;
 }
 
+Database::SaveAction DatabaseWidget::saveAction() const
+{
+    if (config()->get(Config::UseAtomicSaves).toBool()) {
+        return Database::Atomic;
+    }
+    if (config()->get(Config::UseDirectWriteSaves).toBool()) {
+        return Database::DirectWrite;
+    }
+    return Database::TempFile;
+}
+
+QString DatabaseWidget::backupFilePath() const
+{
+    if (!config()->get(Config::BackupBeforeSave).toBool()) {
+        return {};
+    }
+
+    QString backupPath = config()->get(Config::BackupFilePathPattern).toString();
+    // Fall back to default
+    if (backupPath.isEmpty()) {
+        backupPath = config()->getDefault(Config::BackupFilePathPattern).toString();
+    }
+
+    QFileInfo dbFileInfo(m_db->filePath());
+    backupPath = Tools::substituteBackupFilePath(backupPath, dbFileInfo.canonicalFilePath());
+    if (!backupPath.isNull()) {
+        // Note that we cannot guarantee that backupPath is actually a valid filename. QT currently provides
+        // no function for this. Moreover, we don't check if backupPath is a file and not a directory.
+        // If this isn't the case, just let the backup fail.
+        if (QDir::isRelativePath(backupPath)) {
+            backupPath = QDir::cleanPath(dbFileInfo.absolutePath() + QDir::separator() + backupPath);
+        }
+    }
+    return backupPath;
+}
+
 /**
  * Save copy of database under a new user-selected filename.
  *
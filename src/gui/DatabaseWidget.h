@@ -23,11 +23,13 @@
 #include <QStackedWidget>
 
 #include "core/Database.h"
+#include "core/DeferredTaskQueue.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "gui/MessageWidget.h"
 #include "gui/entry/EntryModel.h"
 
+class AutoSaveScheduler;
 class DatabaseOpenDialog;
 class DatabaseOpenWidget;
 class DatabaseSettingsDialog;
@@ -122,6 +124,10 @@ public:
     void setSplitterSizes(const QHash<Config::ConfigKey, QList<int>>& sizes);
     void setSearchStringForAutoType(const QString& search);
 
+    QSharedPointer<Kdf> lockedDatabaseKdf() const;
+    void unlockWithKey(const QSharedPointer<CompositeKey>& key);
+    void setUnlockAllAvailable(bool available);
+
 signals:
     // relayed Database signals
     void databaseFilePathChanged(const QString& oldPath, const QString& newPath);
@@ -141,6 +147,7 @@ signals:
     void entrySelectionChanged();
     void
     requestOpenDatabase(const QString& filePath, bool inBackground, const QString& password, const QString& keyFile);
+    void requestUnlockAll(const QSharedPointer<CompositeKey>& key);
     void databaseMerged(QSharedPointer<Database> mergedDb);
     void groupContextMenuRequested(const QPoint& globalPos);
     void entryContextMenuRequested(const QPoint& globalPos);
@@ -225,6 +232,7 @@ public slots:
     void deleteSearch(const QString& name);
     void setSearchCaseSensitive(bool state);
     void setSearchLimitGroup(bool state);
+    void setSearchAttachmentContents(bool state);
     void endSearch();
 
     void showMessage(const QString& text,
@@ -252,8 +260,10 @@ private slots:
     void onEntryChanged(Entry* entry);
     void onGroupChanged();
     void onDatabaseModified();
+    void onDatabaseSaved();
     void onDatabaseNonDataChanged();
-    void onAutosaveDelayTimeout();
+    void onAutosaveRequested();
+    void onBackgroundSaveFinished(bool ok, const QString& errorMessage);
     void connectDatabaseSignals();
     void loadDatabase(bool accepted);
     void unlockDatabase(bool accepted);
@@ -262,14 +272,27 @@ private slots:
     // Database autoreload slots
     void reloadDatabaseFile();
     void restoreGroupEntryFocus(const QUuid& groupUuid, const QUuid& EntryUuid);
+    void continueSearch();
 
 private:
+    void performSearch(const QString& searchtext, bool incremental);
+    bool searchNextChunk(QList<Entry*>& results, bool incremental);
+    void cancelSearch();
+    void updateSearchLabel(int results, bool finished);
+
     int addChildWidget(QWidget* w);
     void setClipboardTextAndMinimize(const QString& text);
     void processAutoOpen();
     void openDatabaseFromEntry(const Entry* entry, bool inBackground = true);
     void performIconDownloads(const QList<Entry*>& entries, bool force = false, bool downloadInBackground = false);
     bool performSave(QString& errorMessage, const QString& fileName = {});
+    void autosave();
+    Database::SaveAction saveAction() const;
+    QString backupFilePath() const;
+    void storePasswordHealth();
+    void schedulePostUnlockTask(DeferredTaskQueue::Priority priority,
+                                const QString& name,
+                                std::function<void(QSharedPointer<Database>)> task);
 
     QSharedPointer<Database> m_db;
 
@@ -304,13 +327,34 @@ private:
     QScopedPointer<EntrySearcher> m_entrySearcher;
     QString m_lastSearchText;
     QString m_nextSearchLabelText;
+    // Search selected in the tag view, its results are cached by m_entrySearcher
+    QString m_sidebarSearchText;
     bool m_searchLimitGroup;
+    bool m_searchAttachmentContents;
+    // Search running in chunks on the event loop
+    struct
+    {
+        QPointer<Database> db;
+        quint64 revision = 0;
+        QString searchText;
+        QList<Entry*> entries;
+        int position = 0;
+        QList<Entry*> results;
+        // Time spent searching, without the time in between chunks
+        qint64 nsecs = 0;
+    } m_pendingSearch;
+    QPointer<QTimer> m_searchTimer;
 
     // Autoreload
     bool m_blockAutoSave;
 
     // Autosave delay
-    QPointer<QTimer> m_autosaveTimer;
+    QPointer<AutoSaveScheduler> m_autosaveScheduler;
+    QPointer<DeferredTaskQueue> m_postUnlockTasks;
+    // Changes made during a background save are saved once it finishes
+    bool m_autosavePending;
+    // A synchronous save includes all changes, autosaves are not needed meanwhile
+    bool m_saving;
 
     // Auto-Type related
     QString m_searchStringForAutoType;
@@ -42,6 +42,15 @@ DatabaseWidgetStateSync::~DatabaseWidgetStateSync() = default;
  * Sync state with persistent storage.
  */
 void DatabaseWidgetStateSync::sync()
+{
+    storeState();
+    config()->sync();
+}
+
+/**
+ * Store the state in the config, which writes it to disk after a delay.
+ */
+void DatabaseWidgetStateSync::storeState()
 {
     config()->set(Config::GUI_SplitterState, intListToVariant(m_splitterSizes.value(Config::GUI_SplitterState)));
     config()->set(Config::GUI_PreviewSplitterState,
@@ -50,7 +59,6 @@ void DatabaseWidgetStateSync::sync()
                   intListToVariant(m_splitterSizes.value(Config::GUI_GroupSplitterState)));
     config()->set(Config::GUI_ListViewState, m_listViewState);
     config()->set(Config::GUI_SearchViewState, m_searchViewState);
-    config()->sync();
 }
 
 void DatabaseWidgetStateSync::setActive(DatabaseWidget* dbWidget)
@@ -158,7 +166,7 @@ void DatabaseWidgetStateSync::updateViewState()
         m_listViewState = m_activeDbWidget->entryViewState();
     }
 
-    sync();
+    storeState();
 }
 
 QList<int> DatabaseWidgetStateSync::variantToIntList(const QVariant& variant)
@@ -42,6 +42,7 @@ private slots:
     void sync();
 
 private:
+    void storeState();
     static QList<int> variantToIntList(const QVariant& variant);
     static QVariant intListToVariant(const QList<int>& list);
 
@@ -35,6 +35,8 @@
 namespace
 {
     constexpr int GeneralTabIndex = 0;
+    // Minimum time between two renders caused by selection changes
+    constexpr int RefreshThrottleMs = 100;
 }
 
 EntryPreviewWidget::EntryPreviewWidget(QWidget* parent)
@@ -84,6 +86,16 @@ EntryPreviewWidget::EntryPreviewWidget(QWidget* parent)
         m_ui->entryTabWidget->setFocus();
     });
     connect(&m_totpTimer, SIGNAL(timeout()), SLOT(updateTotpLabel()));
+    connect(m_ui->entryTabWidget, &QTabWidget::currentChanged, this, &EntryPreviewWidget::updateEntryCurrentTab);
+
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(RefreshThrottleMs);
+    connect(&m_refreshTimer, &QTimer::timeout, this, [this] {
+        if (m_refreshPending) {
+            refresh();
+            m_refreshTimer.start();
+        }
+    });
 
     connect(m_ui->entryAttributesTable, &QTableWidget::itemDoubleClicked, this, [](QTableWidgetItem* item) {
         auto userData = item->data(Qt::UserRole);
@@ -130,6 +142,8 @@ void EntryPreviewWidget::clear()
     hide();
     m_currentEntry = nullptr;
     m_currentGroup = nullptr;
+    m_refreshPending = false;
+    m_refreshTimer.stop();
     m_ui->entryAttachmentsWidget->unlinkAttachments();
 }
 
@@ -155,7 +169,7 @@ void EntryPreviewWidget::setEntry(Entry* selectedEntry)
     }
 
     connect(m_currentEntry, &Entry::modified, this, &EntryPreviewWidget::refresh);
-    refresh();
+    scheduleRefresh();
 
     if (m_currentEntry->hasTotp()) {
         m_ui->entryTotpButton->setChecked(!config()->get(Config::Security_HideTotpPreviewPanel).toBool());
@@ -184,17 +198,34 @@ void EntryPreviewWidget::setGroup(Group* selectedGroup)
     }
 
     connect(m_currentGroup, &Group::modified, this, &EntryPreviewWidget::refresh);
+    scheduleRefresh();
+}
+
+/**
+ * Refresh right away unless the previous refresh was less than the throttle
+ * interval ago, in which case a single refresh runs at the end of it. Holding
+ * an arrow key in the entry list then only renders every few entries.
+ */
+void EntryPreviewWidget::scheduleRefresh()
+{
+    if (m_refreshTimer.isActive()) {
+        m_refreshPending = true;
+        return;
+    }
+
     refresh();
+    m_refreshTimer.start();
 }
 
 void EntryPreviewWidget::refresh()
 {
+    m_refreshPending = false;
+
     if (m_currentEntry) {
         updateEntryHeaderLine();
         updateEntryTotp();
         updateEntryGeneralTab();
-        updateEntryAdvancedTab();
-        updateEntryAutotypeTab();
+        updateEntryTabs();
 
         setVisible(!config()->get(Config::GUI_HidePreviewPanel).toBool());
 
@@ -203,6 +234,7 @@ void EntryPreviewWidget::refresh()
             m_ui->entryTabWidget->isTabEnabled(m_selectedTabEntry) ? m_selectedTabEntry : GeneralTabIndex;
         Q_ASSERT(m_ui->entryTabWidget->isTabEnabled(GeneralTabIndex));
         m_ui->entryTabWidget->setCurrentIndex(tabIndex);
+        updateEntryCurrentTab();
     } else if (m_currentGroup) {
         updateGroupHeaderLine();
         updateGroupGeneralTab();
@@ -333,16 +365,22 @@ void EntryPreviewWidget::setGroupNotesVisible(bool state)
 
 void EntryPreviewWidget::setNotesVisible(QTextEdit* notesWidget, const QString& notes, bool state)
 {
+    QString text;
+    if (state) {
+        text = notes;
+    } else if (!notes.isEmpty()) {
+        text = QString("\u25cf").repeated(6);
+    }
+
+    // Laying out long notes is expensive, keep the document if nothing changed
+    if (notesWidget->document()->isEmpty() ? text.isEmpty() : notesWidget->toPlainText() == text) {
+        return;
+    }
+
+    notesWidget->setPlainText(text);
     if (state) {
-        notesWidget->setPlainText(notes);
         notesWidget->moveCursor(QTextCursor::Start);
         notesWidget->ensureCursorVisible();
-    } else {
-        if (!notes.isEmpty()) {
-            notesWidget->setPlainText(QString("\u25cf").repeated(6));
-        } else {
-            notesWidget->setPlainText("");
-        }
     }
 }
 
@@ -406,19 +444,51 @@ void EntryPreviewWidget::updateEntryGeneralTab()
     m_ui->entryTagsList->setReadOnly(true);
 }
 
+/**
+ * Enable the tabs that have content for the current entry. The advanced and
+ * Auto-Type tabs are only filled in once they are shown.
+ */
+void EntryPreviewWidget::updateEntryTabs()
+{
+    Q_ASSERT(m_currentEntry);
+    const bool hasAttributes = !m_currentEntry->attributes()->customKeys().isEmpty();
+    const bool hasAttachments = !m_currentEntry->attachments()->isEmpty();
+    setTabEnabled(m_ui->entryTabWidget, m_ui->entryAdvancedTab, hasAttributes || hasAttachments);
+    setTabEnabled(m_ui->entryTabWidget,
+                  m_ui->entryAutotypeTab,
+                  m_currentEntry->autoTypeEnabled() && m_currentEntry->groupAutoTypeEnabled());
+
+    m_advancedTabStale = true;
+    m_autotypeTabStale = true;
+    m_ui->entryAttachmentsWidget->unlinkAttachments();
+}
+
+void EntryPreviewWidget::updateEntryCurrentTab()
+{
+    if (!m_currentEntry) {
+        return;
+    }
+
+    const QWidget* tab = m_ui->entryTabWidget->currentWidget();
+    if (tab == m_ui->entryAdvancedTab && m_advancedTabStale) {
+        updateEntryAdvancedTab();
+    } else if (tab == m_ui->entryAutotypeTab && m_autotypeTabStale) {
+        updateEntryAutotypeTab();
+    }
+}
+
 void EntryPreviewWidget::updateEntryAdvancedTab()
 {
     Q_ASSERT(m_currentEntry);
+    m_advancedTabStale = false;
     m_ui->entryAttributesTable->clear();
 
     const EntryAttributes* attributes = m_currentEntry->attributes();
     const QStringList customAttributes = attributes->customKeys();
     const bool hasAttributes = !customAttributes.isEmpty();
-    const bool hasAttachments = !m_currentEntry->attachments()->isEmpty();
     m_ui->entryAttributesTable->setRowCount(customAttributes.size());
     m_ui->entryAttributesTable->setColumnCount(3);
 
-    setTabEnabled(m_ui->entryTabWidget, m_ui->entryAdvancedTab, hasAttributes || hasAttachments);
     if (hasAttributes) {
         auto i = 0;
         QFont font;
@@ -474,6 +544,7 @@ void EntryPreviewWidget::updateEntryAdvancedTab()
 void EntryPreviewWidget::updateEntryAutotypeTab()
 {
     Q_ASSERT(m_currentEntry);
+    m_autotypeTabStale = false;
 
     m_ui->entrySequenceLabel->setText(m_currentEntry->effectiveAutoTypeSequence());
     m_ui->entryAutotypeTree->clear();
@@ -487,9 +558,6 @@ void EntryPreviewWidget::updateEntryAutotypeTab()
     }
 
     m_ui->entryAutotypeTree->addTopLevelItems(items);
-    setTabEnabled(m_ui->entryTabWidget,
-                  m_ui->entryAutotypeTab,
-                  m_currentEntry->autoTypeEnabled() && m_currentEntry->groupAutoTypeEnabled());
 }
 
 void EntryPreviewWidget::updateGroupHeaderLine()
@@ -545,12 +613,14 @@ void EntryPreviewWidget::updateTotpLabel()
     if (!m_locked && m_currentEntry && m_currentEntry->hasTotp()) {
         auto totpCode = m_currentEntry->totp();
         totpCode.insert(totpCode.size() / 2, " ");
-        m_ui->entryTotpLabel->setText(totpCode);
+        // The code only changes once per step, avoid relayouting the label every second
+        if (m_ui->entryTotpLabel->text() != totpCode) {
+            m_ui->entryTotpLabel->setText(totpCode);
+        }
 
         auto step = m_currentEntry->totpSettings()->step;
         auto timeleft = step - (Clock::currentSecondsSinceEpoch() % step);
         m_ui->entryTotpProgress->setValue(timeleft);
-        m_ui->entryTotpProgress->update();
     } else {
         m_ui->entryTotpLabel->clear();
         m_totpTimer.stop();
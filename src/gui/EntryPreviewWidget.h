@@ -54,6 +54,8 @@ private slots:
     void updateEntryHeaderLine();
     void updateEntryTotp();
     void updateEntryGeneralTab();
+    void updateEntryTabs();
+    void updateEntryCurrentTab();
     void updateEntryAdvancedTab();
     void updateEntryAutotypeTab();
     void setUsernameVisible(bool state);
@@ -73,6 +75,7 @@ private slots:
     void openEntryUrl();
 
 private:
+    void scheduleRefresh();
     void removeTab(QTabWidget* tabWidget, QWidget* widget);
     void setTabEnabled(QTabWidget* tabWidget, QWidget* widget, bool enabled);
 
@@ -83,6 +86,10 @@ private:
     QPointer<Entry> m_currentEntry;
     QPointer<Group> m_currentGroup;
     QTimer m_totpTimer;
+    QTimer m_refreshTimer;
+    bool m_refreshPending = false;
+    bool m_advancedTabStale = false;
+    bool m_autotypeTabStale = false;
     quint8 m_selectedTabEntry;
     quint8 m_selectedTabGroup;
 };
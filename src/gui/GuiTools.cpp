@@ -109,6 +109,11 @@ namespace GuiTools
             selectedEntries << entry;
         }
 
+        if (selectedEntries.isEmpty()) {
+            return 0;
+        }
+
+        Database::BatchUpdate batch(selectedEntries.first()->database());
         for (auto entry : asConst(selectedEntries)) {
             if (permanent) {
                 delete entry;
@@ -26,6 +26,9 @@
 
 namespace
 {
+    // Number of characters collected before they are written to the device
+    constexpr int BufferSize = 64 * 1024;
+
     QString PixmapToHTML(const QPixmap& pixmap)
     {
         if (pixmap.isNull()) {
@@ -176,25 +179,52 @@ bool HtmlExporter::exportDatabase(QIODevice* device,
     const auto footer = QString("</body>"
                                 "</html>");
 
-    if (device->write(header.toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
+    m_pending.clear();
+    m_pending.reserve(BufferSize + BufferSize / 4);
+    m_pending.append(header);
+
+    bool ok = !db->rootGroup() || writeGroup(*device, *db->rootGroup(), QString(), sorted, ascending);
+    if (ok) {
+        m_pending.append(footer);
+        ok = flush(*device);
     }
 
-    if (db->rootGroup()) {
-        if (!writeGroup(*device, *db->rootGroup(), QString(), sorted, ascending)) {
-            return false;
-        }
+    m_pending.clear();
+    m_iconCache.clear();
+    return ok;
+}
+
+/**
+ * Write the pending output to the device once it reaches the given number
+ * of characters. The pending buffer keeps its capacity for the next entries.
+ */
+bool HtmlExporter::flush(QIODevice& device, int threshold)
+{
+    if (m_pending.isEmpty() || m_pending.size() < threshold) {
+        return true;
     }
 
-    if (device->write(footer.toUtf8()) == -1) {
-        m_error = device->errorString();
+    if (device.write(m_pending.toUtf8()) == -1) {
+        m_error = device.errorString();
         return false;
     }
-
+    m_pending.resize(0);
     return true;
 }
 
+/**
+ * Inline an icon as a PNG data URI. Entries and groups mostly share a few
+ * icons, so each one is only encoded once per export.
+ */
+QString HtmlExporter::iconToHtml(const QPixmap& pixmap)
+{
+    auto it = m_iconCache.constFind(pixmap.cacheKey());
+    if (it == m_iconCache.constEnd()) {
+        it = m_iconCache.insert(pixmap.cacheKey(), PixmapToHTML(pixmap));
+    }
+    return it.value();
+}
+
 bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString path, bool sorted, bool ascending)
 {
     // Don't output the recycle bin
@@ -213,28 +243,22 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
     const auto notes = group.notes();
     if (!group.entries().empty() || !notes.isEmpty()) {
         // Header line
-        auto header = QString("<hr><h2>");
-        header.append(PixmapToHTML(Icons::groupIconPixmap(&group, IconSize::Medium)));
-        header.append("&nbsp;");
-        header.append(path);
-        header.append("</h2>\n");
+        m_pending.append("<hr><h2>");
+        m_pending.append(iconToHtml(Icons::groupIconPixmap(&group, IconSize::Medium)));
+        m_pending.append("&nbsp;");
+        m_pending.append(path);
+        m_pending.append("</h2>\n");
 
         // Group notes
         if (!notes.isEmpty()) {
-            header.append("<p>");
-            header.append(notes.toHtmlEscaped().replace("\n", "<br>"));
-            header.append("</p>");
-        }
-
-        // Output it
-        if (device.write(header.toUtf8()) == -1) {
-            m_error = device.errorString();
-            return false;
+            m_pending.append("<p>");
+            m_pending.append(notes.toHtmlEscaped().replace("\n", "<br>"));
+            m_pending.append("</p>");
         }
     }
 
     // Begin the table for the entries in this group
-    auto table = QString("<table width=\"95%\">");
+    m_pending.append("<table width=\"95%\">");
 
     auto entries = group.entries();
     if (sorted) {
@@ -253,20 +277,27 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
 
         // Output it into our table. First the left side with
         // icon and entry title ...
-        table += "<tr>";
-        table += "<td width=\"1%\">" + PixmapToHTML(Icons::entryIconPixmap(entry, IconSize::Medium)) + "</td>";
-        auto caption = "<caption>" + entry->title().toHtmlEscaped() + "</caption>";
+        m_pending.append("<tr>");
+        m_pending.append("<td width=\"1%\">");
+        m_pending.append(iconToHtml(Icons::entryIconPixmap(entry, IconSize::Medium)));
+        m_pending.append("</td>");
 
         // ... then the right side with the data fields
-        table +=
-            "<td style=\"padding-bottom: 0.5em;\"><table width=\"100%\">" + caption + formatted_entry + "</table></td>";
-        table += "</tr>";
+        m_pending.append("<td style=\"padding-bottom: 0.5em;\"><table width=\"100%\"><caption>");
+        m_pending.append(entry->title().toHtmlEscaped());
+        m_pending.append("</caption>");
+        m_pending.append(formatted_entry);
+        m_pending.append("</table></td>");
+        m_pending.append("</tr>");
+
+        if (!flush(device, BufferSize)) {
+            return false;
+        }
     }
 
-    // Output the complete table of this group
-    table.append("</table>\n");
-    if (device.write(table.toUtf8()) == -1) {
-        m_error = device.errorString();
+    // Close the table of this group
+    m_pending.append("</table>\n");
+    if (!flush(device, BufferSize)) {
         return false;
     }
 
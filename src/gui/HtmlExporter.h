@@ -18,12 +18,14 @@
 #ifndef KEEPASSX_HTMLEXPORTER_H
 #define KEEPASSX_HTMLEXPORTER_H
 
+#include <QHash>
 #include <QSharedPointer>
 #include <QString>
 
 class Database;
 class Group;
 class QIODevice;
+class QPixmap;
 
 class HtmlExporter
 {
@@ -44,8 +46,14 @@ private:
                     QString path = QString(),
                     bool sorted = true,
                     bool ascending = true);
+    bool flush(QIODevice& device, int threshold = 0);
+    QString iconToHtml(const QPixmap& pixmap);
 
     QString m_error;
+    // Output not yet written to the device, reused for the whole export
+    QString m_pending;
+    // Inlined <img> tags by pixmap cache key
+    QHash<qint64, QString> m_iconCache;
 };
 
 #endif // KEEPASSX_HTMLEXPORTER_H
@@ -21,12 +21,33 @@
 #include "core/UrlTools.h"
 
 #include <QBuffer>
-#include <QHostInfo>
+#include <QCache>
+#include <QDateTime>
+#include <QHostAddress>
 #include <QImageReader>
 #include <QNetworkReply>
 
 #define MAX_REDIRECTS 5
 
+namespace
+{
+    // Favicons found during this session, shared by all downloaders
+    struct CachedFavicon
+    {
+        QImage image;
+        QDateTime expires;
+    };
+
+    constexpr int FaviconCacheSize = 1024;
+    constexpr int FaviconCacheSecs = 24 * 60 * 60;
+
+    struct FaviconCache
+    {
+        QCache<QString, CachedFavicon> favicons{FaviconCacheSize};
+    };
+    Q_GLOBAL_STATIC(FaviconCache, s_cache)
+} // namespace
+
 IconDownloader::IconDownloader(QObject* parent)
     : QObject(parent)
     , m_reply(nullptr)
@@ -44,14 +65,15 @@ IconDownloader::~IconDownloader()
 void IconDownloader::setUrl(const QString& entryUrl)
 {
     m_url = entryUrl;
+    m_host.clear();
+    m_redirects = 0;
+    m_urlsToTry.clear();
+
     QUrl url = QUrl::fromUserInput(m_url);
     if (!url.isValid() || url.host().isEmpty()) {
         return;
     }
 
-    m_redirects = 0;
-    m_urlsToTry.clear();
-
     // Fall back to https if no scheme is specified
     // fromUserInput defaults to http. Hence, we need to replace the default scheme should we detect that it has
     // been added by fromUserInput
@@ -71,15 +93,11 @@ void IconDownloader::setUrl(const QString& entryUrl)
     }
 
     QString fullyQualifiedDomain = url.host();
+    m_host = fullyQualifiedDomain;
 
-    // Determine if host portion of URL is an IP address by resolving it and
-    // searching for a match with the returned address(es).
-    bool hostIsIp = false;
-    QList<QHostAddress> hostAddressess = QHostInfo::fromName(fullyQualifiedDomain).addresses();
-    hostIsIp =
-        std::any_of(hostAddressess.begin(), hostAddressess.end(), [&fullyQualifiedDomain](const QHostAddress& addr) {
-            return addr.toString() == fullyQualifiedDomain;
-        });
+    // Determine if host portion of URL is an IP address. This is checked
+    // without a blocking name lookup, which stalled bulk downloads.
+    const bool hostIsIp = !QHostAddress(fullyQualifiedDomain).isNull();
 
     // Determine the second-level domain, if available
     QString secondLevelDomain;
@@ -126,9 +144,36 @@ void IconDownloader::setUrl(const QString& entryUrl)
     }
 }
 
+/**
+ * Get the key under which favicons of a URL are shared, i.e. its host.
+ * Entries whose URLs have the same key only need a single download.
+ */
+QString IconDownloader::hostKey(const QString& entryUrl)
+{
+    const auto host = QUrl::fromUserInput(entryUrl).host();
+    return host.isEmpty() ? entryUrl : host;
+}
+
+/**
+ * Start downloading the favicon of the URL. The finished() signal is always
+ * emitted, with a null image if the URL is invalid or no icon was found.
+ */
 void IconDownloader::download()
 {
     if (m_urlsToTry.isEmpty()) {
+        if (!m_timeout.isActive() && !m_reply) {
+            const auto url = m_url;
+            QTimer::singleShot(0, this, [this, url] { emit finished(url, {}); });
+        }
+        return;
+    }
+
+    const auto* cached = s_cache->favicons.object(m_host);
+    if (cached && cached->expires > QDateTime::currentDateTimeUtc()) {
+        const auto url = m_url;
+        const auto image = cached->image;
+        m_urlsToTry.clear();
+        QTimer::singleShot(0, this, [this, url, image] { emit finished(url, image); });
         return;
     }
 
@@ -144,6 +189,8 @@ void IconDownloader::download()
 
 void IconDownloader::abortDownload()
 {
+    // Don't continue with the remaining URLs after a timeout
+    m_urlsToTry.clear();
     if (m_reply) {
         m_reply->abort();
     }
@@ -197,6 +244,10 @@ void IconDownloader::fetchFinished()
     if (!image.isNull()) {
         // Valid icon received
         m_timeout.stop();
+        if (!m_host.isEmpty()) {
+            s_cache->favicons.insert(
+                m_host, new CachedFavicon{image, QDateTime::currentDateTimeUtc().addSecs(FaviconCacheSecs)});
+        }
         emit finished(url, image);
     } else if (!m_urlsToTry.empty()) {
         // Try the next url
@@ -35,6 +35,8 @@ public:
     void setUrl(const QString& entryUrl);
     void download();
 
+    static QString hostKey(const QString& entryUrl);
+
 signals:
     void finished(const QString& entryUrl, const QImage& image);
 
@@ -50,6 +52,7 @@ private:
     QImage parseImage(QByteArray& imageBytes) const;
 
     QString m_url;
+    QString m_host;
     QUrl m_fetchUrl;
     QList<QUrl> m_urlsToTry;
     QByteArray m_bytesReceived;
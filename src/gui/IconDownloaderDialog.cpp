@@ -65,6 +65,7 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
 {
     m_db = database;
     m_urlToEntries.clear();
+    m_hostToUrls.clear();
     abortDownloads();
     for (const auto& e : entries) {
         // Only consider entries with a valid URL and without a custom icon
@@ -84,21 +85,37 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
         open();
         QApplication::processEvents();
 
+        // Entries sharing a host share a single download
         for (const auto& url : m_urlToEntries.uniqueKeys()) {
             m_dataModel->appendRow(QList<QStandardItem*>()
                                    << new QStandardItem(url) << new QStandardItem(tr("Downloading…")));
-            m_activeDownloaders.append(createDownloader(url));
+            const auto host = IconDownloader::hostKey(url);
+            if (!m_hostToUrls.contains(host)) {
+                m_queuedDownloaders.append(createDownloader(url));
+            }
+            m_hostToUrls.insert(host, url);
         }
+        m_downloadCount = m_queuedDownloaders.size();
 
         // Setup the dialog
         updateProgressBar();
         updateCancelButton();
         QApplication::processEvents();
 
-        // Start the downloads
-        for (auto downloader : m_activeDownloaders) {
-            downloader->download();
-        }
+        startQueuedDownloads();
+    }
+}
+
+/**
+ * Start queued downloads while fewer than MaxParallelDownloads are running.
+ * All downloads share the connections of the application network manager.
+ */
+void IconDownloaderDialog::startQueuedDownloads()
+{
+    while (m_activeDownloaders.size() < MaxParallelDownloads && !m_queuedDownloaders.isEmpty()) {
+        auto downloader = m_queuedDownloaders.takeFirst();
+        m_activeDownloaders.append(downloader);
+        downloader->download();
     }
 }
 
@@ -106,6 +123,7 @@ void IconDownloaderDialog::downloadFaviconInBackground(const QSharedPointer<Data
 {
     m_db = database;
     m_urlToEntries.clear();
+    m_hostToUrls.clear();
     abortDownloads();
 
     auto webUrl = entry->webUrl();
@@ -114,8 +132,10 @@ void IconDownloaderDialog::downloadFaviconInBackground(const QSharedPointer<Data
     }
 
     if (m_urlToEntries.count() > 0) {
-        m_activeDownloaders.append(createDownloader(webUrl));
-        m_activeDownloaders.first()->download();
+        m_hostToUrls.insert(IconDownloader::hostKey(webUrl), webUrl);
+        m_queuedDownloaders.append(createDownloader(webUrl));
+        m_downloadCount = 1;
+        startQueuedDownloads();
     }
 }
 
@@ -143,9 +163,15 @@ void IconDownloaderDialog::downloadFinished(const QString& url, const QImage& ic
         m_activeDownloaders.removeAll(downloader);
     }
 
+    startQueuedDownloads();
     updateProgressBar();
     updateCancelButton();
 
+    auto urls = m_hostToUrls.values(IconDownloader::hostKey(url));
+    if (urls.isEmpty()) {
+        urls << url;
+    }
+
     if (m_db && !icon.isNull()) {
         // Don't add an icon larger than 128x128, but retain original size if smaller
         constexpr auto maxIconSize = 128;
@@ -156,21 +182,24 @@ void IconDownloaderDialog::downloadFinished(const QString& url, const QImage& ic
 
         QByteArray serializedIcon = Icons::saveToBytes(scaledIcon);
         QUuid uuid = m_db->metadata()->findCustomIcon(serializedIcon);
-        if (uuid.isNull()) {
+        const bool exists = !uuid.isNull();
+        if (!exists) {
             uuid = QUuid::createUuid();
             m_db->metadata()->addCustomIcon(uuid, serializedIcon);
-            updateTable(url, tr("Ok"));
-        } else {
-            updateTable(url, tr("Already Exists"));
         }
 
-        // Set the icon on all the entries associated with this url
-        for (const auto entry : m_urlToEntries.values(url)) {
-            entry->setIcon(uuid);
+        // Set the icon on all the entries associated with the urls of this host
+        for (const auto& hostUrl : asConst(urls)) {
+            updateTable(hostUrl, exists ? tr("Already Exists") : tr("Ok"));
+            for (const auto entry : m_urlToEntries.values(hostUrl)) {
+                entry->setIcon(uuid);
+            }
         }
     } else {
         showFallbackMessage(true);
-        updateTable(url, tr("Download Failed"));
+        for (const auto& hostUrl : asConst(urls)) {
+            updateTable(hostUrl, tr("Download Failed"));
+        }
         return;
     }
 }
@@ -184,8 +213,8 @@ void IconDownloaderDialog::showFallbackMessage(bool state)
 
 void IconDownloaderDialog::updateProgressBar()
 {
-    int total = m_urlToEntries.uniqueKeys().count();
-    int value = total - m_activeDownloaders.count();
+    int total = m_downloadCount;
+    int value = total - m_activeDownloaders.count() - m_queuedDownloaders.count();
     m_ui->progressBar->setValue(value);
     m_ui->progressBar->setMaximum(total);
     m_ui->progressLabel->setText(
@@ -194,7 +223,7 @@ void IconDownloaderDialog::updateProgressBar()
 
 void IconDownloaderDialog::updateCancelButton()
 {
-    m_ui->cancelButton->setEnabled(!m_activeDownloaders.isEmpty());
+    m_ui->cancelButton->setEnabled(!m_activeDownloaders.isEmpty() || !m_queuedDownloaders.isEmpty());
 }
 
 void IconDownloaderDialog::updateTable(const QString& url, const QString& message)
@@ -208,6 +237,11 @@ void IconDownloaderDialog::updateTable(const QString& url, const QString& messag
 
 void IconDownloaderDialog::abortDownloads()
 {
+    // Queued downloads would be started by the aborted ones finishing
+    for (auto* downloader : m_queuedDownloaders) {
+        downloader->deleteLater();
+    }
+    m_queuedDownloaders.clear();
     for (auto* downloader : m_activeDownloaders) {
         downloader->deleteLater();
     }
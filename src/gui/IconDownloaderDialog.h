@@ -49,7 +49,11 @@ private slots:
     void abortDownloads();
 
 private:
+    // Downloads running at the same time, the rest wait in a queue
+    static constexpr int MaxParallelDownloads = 8;
+
     IconDownloader* createDownloader(const QString& url);
+    void startQueuedDownloads();
 
     void showFallbackMessage(bool state);
     void updateTable(const QString& url, const QString& message);
@@ -60,7 +64,11 @@ private:
     QStandardItemModel* m_dataModel;
     QSharedPointer<Database> m_db;
     QMultiMap<QString, Entry*> m_urlToEntries;
+    // URLs of the entries by the host their favicon is downloaded for
+    QMultiMap<QString, QString> m_hostToUrls;
     QList<IconDownloader*> m_activeDownloaders;
+    QList<IconDownloader*> m_queuedDownloaders;
+    int m_downloadCount = 0;
     QMutex m_mutex;
 
     Q_DISABLE_COPY(IconDownloaderDialog)
@@ -19,7 +19,9 @@
 
 #include <QUuid>
 
-#include "gui/DatabaseIcons.h"
+#include "core/Database.h"
+#include "core/Metadata.h"
+#include "gui/Icons.h"
 
 DefaultIconModel::DefaultIconModel(QObject* parent)
     : QAbstractListModel(parent)
@@ -55,13 +57,14 @@ CustomIconModel::CustomIconModel(QObject* parent)
 {
 }
 
-void CustomIconModel::setIcons(const QHash<QUuid, QPixmap>& icons, const QList<QUuid>& iconsOrder)
+void CustomIconModel::setIcons(const Database* db, IconSize size)
 {
     beginResetModel();
 
-    m_icons = icons;
-    m_iconsOrder = iconsOrder;
-    Q_ASSERT(m_icons.count() == m_iconsOrder.count());
+    m_db = db;
+    m_size = size;
+    m_iconsOrder = db ? db->metadata()->customIconsOrder() : QList<QUuid>();
+    m_fetchedCount = qMin(m_iconsOrder.size(), PageSize);
 
     endResetModel();
 }
@@ -69,7 +72,7 @@ void CustomIconModel::setIcons(const QHash<QUuid, QPixmap>& icons, const QList<Q
 int CustomIconModel::rowCount(const QModelIndex& parent) const
 {
     if (!parent.isValid()) {
-        return m_icons.size();
+        return m_fetchedCount;
     } else {
         return 0;
     }
@@ -77,18 +80,42 @@ int CustomIconModel::rowCount(const QModelIndex& parent) const
 
 QVariant CustomIconModel::data(const QModelIndex& index, int role) const
 {
-    if (!index.isValid()) {
+    if (!index.isValid() || !m_db) {
         return {};
     }
 
     if (role == Qt::DecorationRole) {
         QUuid uuid = uuidFromIndex(index);
-        return m_icons.value(uuid);
+        return Icons::customIconPixmap(m_db, uuid, m_size);
     }
 
     return {};
 }
 
+bool CustomIconModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && m_fetchedCount < m_iconsOrder.size();
+}
+
+void CustomIconModel::fetchMore(const QModelIndex& parent)
+{
+    if (!parent.isValid()) {
+        fetchUpTo(m_fetchedCount + PageSize);
+    }
+}
+
+void CustomIconModel::fetchUpTo(int count)
+{
+    count = qMin(count, m_iconsOrder.size());
+    if (count <= m_fetchedCount) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_fetchedCount, count - 1);
+    m_fetchedCount = count;
+    endInsertRows();
+}
+
 QUuid CustomIconModel::uuidFromIndex(const QModelIndex& index) const
 {
     Q_ASSERT(index.isValid());
@@ -96,10 +123,14 @@ QUuid CustomIconModel::uuidFromIndex(const QModelIndex& index) const
     return m_iconsOrder.value(index.row());
 }
 
-QModelIndex CustomIconModel::indexFromUuid(const QUuid& uuid) const
+/**
+ * Get the index of an icon, fetching the pages up to it if necessary.
+ */
+QModelIndex CustomIconModel::indexFromUuid(const QUuid& uuid)
 {
     int idx = m_iconsOrder.indexOf(uuid);
     if (idx > -1) {
+        fetchUpTo(idx + 1);
         return index(idx, 0);
     }
     return {};
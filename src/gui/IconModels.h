@@ -20,6 +20,11 @@
 
 #include <QAbstractListModel>
 #include <QPixmap>
+#include <QPointer>
+
+#include "gui/DatabaseIcons.h"
+
+class Database;
 
 class DefaultIconModel : public QAbstractListModel
 {
@@ -32,22 +37,37 @@ public:
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
 };
 
+/**
+ * Custom icons of a database.
+ *
+ * Icons are decoded when they are first shown, and rows are added a page at
+ * a time as the view scrolls, so databases with thousands of icons open the
+ * icon picker without decoding all of them.
+ */
 class CustomIconModel : public QAbstractListModel
 {
     Q_OBJECT
 
 public:
+    static constexpr int PageSize = 256;
+
     explicit CustomIconModel(QObject* parent = nullptr);
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
-    void setIcons(const QHash<QUuid, QPixmap>& icons, const QList<QUuid>& iconsOrder);
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    void setIcons(const Database* db, IconSize size = IconSize::Default);
     QUuid uuidFromIndex(const QModelIndex& index) const;
-    QModelIndex indexFromUuid(const QUuid& uuid) const;
+    QModelIndex indexFromUuid(const QUuid& uuid);
 
 private:
-    QHash<QUuid, QPixmap> m_icons;
+    void fetchUpTo(int count);
+
+    QPointer<const Database> m_db;
+    IconSize m_size = IconSize::Default;
     QList<QUuid> m_iconsOrder;
+    int m_fetchedCount = 0;
 };
 
 #endif // KEEPASSX_ICONMODELS_H
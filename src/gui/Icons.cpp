@@ -19,10 +19,12 @@
 #include "Icons.h"
 
 #include <QBuffer>
+#include <QGuiApplication>
 #include <QIconEngine>
 #include <QImageReader>
 #include <QPaintDevice>
 #include <QPainter>
+#include <QPixmapCache>
 
 #include "config-keepassx.h"
 #include "core/Config.h"
@@ -164,31 +166,75 @@ QPixmap AdaptiveIconEngine::pixmap(const QSize& size, QIcon::Mode mode, QIcon::S
 
 QIconEngine* AdaptiveIconEngine::clone() const
 {
-    return new AdaptiveIconEngine(m_baseIcon);
+    return new AdaptiveIconEngine(m_baseIcon, m_overrideColor);
+}
+
+/**
+ * Get the id of an icon name, which can be kept by callers to skip hashing
+ * the name on each lookup.
+ */
+int Icons::iconId(const QString& name)
+{
+    auto it = m_iconIds.constFind(name);
+    if (it != m_iconIds.constEnd()) {
+        return it.value();
+    }
+
+    const int id = m_iconNames.size();
+    m_iconNames.append(name);
+    m_iconIds.insert(name, id);
+    return id;
+}
+
+quint64 Icons::cacheKey(int id, bool recolor, const QColor& overrideColor)
+{
+    // Id, flags and the ARGB value of the override color packed into one integer
+    quint64 key = static_cast<quint64>(id) << 34;
+    if (recolor) {
+        key |= Q_UINT64_C(1) << 33;
+    }
+    if (overrideColor.isValid()) {
+        key |= (Q_UINT64_C(1) << 32) | overrideColor.rgba();
+    }
+    return key;
 }
 
 QIcon Icons::icon(const QString& name, bool recolor, const QColor& overrideColor)
 {
+    return icon(iconId(name), recolor, overrideColor);
+}
+
+/**
+ * Get an icon by its id. Recolored variants are cached per override color,
+ * the colors of the palette are applied when the icon is painted.
+ */
+QIcon Icons::icon(int id, bool recolor, const QColor& overrideColor)
+{
+    if (id < 0 || id >= m_iconNames.size()) {
+        return {};
+    }
+
+    const quint64 key = cacheKey(id, recolor, overrideColor);
+    auto it = m_iconCache.constFind(key);
+    if (it != m_iconCache.constEnd()) {
+        return it.value();
+    }
+
 #ifdef Q_OS_LINUX
     // Resetting the application theme name before calling QIcon::fromTheme() is required for hacky
     // QPA platform themes such as qt5ct, which randomly mess with the configured icon theme.
     // If we do not reset the theme name here, it will become empty at some point, causing
     // Qt to look for icons at the user-level and global default locations.
+    // Cached icons keep their engine, so this is only needed when loading one.
     //
     // See issue #4963: https://github.com/keepassxreboot/keepassxc/issues/4963
     // and qt5ct issue #80: https://sourceforge.net/p/qt5ct/tickets/80/
-    QIcon::setThemeName("application");
-#endif
-
-    QString cacheName =
-        QString("%1:%2:%3").arg(recolor ? "1" : "0", overrideColor.isValid() ? overrideColor.name() : "#", name);
-    QIcon icon = m_iconCache.value(cacheName);
-
-    if (!icon.isNull() && !overrideColor.isValid()) {
-        return icon;
+    if (QIcon::themeName() != QLatin1String("application")) {
+        QIcon::setThemeName("application");
     }
+#endif
 
-    icon = QIcon::fromTheme(name);
+    QIcon icon = QIcon::fromTheme(m_iconNames.at(id));
     if (recolor) {
         icon = QIcon(new AdaptiveIconEngine(icon, overrideColor));
 #if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
@@ -196,7 +242,7 @@ QIcon Icons::icon(const QString& name, bool recolor, const QColor& overrideColor
 #endif
     }
 
-    m_iconCache.insert(cacheName, icon);
+    m_iconCache.insert(key, icon);
     return icon;
 }
 
@@ -218,26 +264,36 @@ Icons* Icons::instance()
     return m_instance;
 }
 
+/**
+ * Get the pixmap of a custom icon.
+ *
+ * Decoded pixmaps are kept in the QPixmapCache, which evicts the least
+ * recently used ones. The key includes a hash of the image data so icons
+ * replaced under the same UUID are decoded again.
+ */
 QPixmap Icons::customIconPixmap(const Database* db, const QUuid& uuid, IconSize size)
 {
     if (!db->metadata()->hasCustomIcon(uuid)) {
         return {};
     }
-    // Generate QIcon with pre-baked resolutions
-    auto icon = QImage::fromData(db->metadata()->customIcon(uuid).data);
-    auto basePixmap = QPixmap::fromImage(icon.scaled(64, 64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-    return QIcon(basePixmap).pixmap(databaseIcons()->iconSize(size));
-}
 
-QHash<QUuid, QPixmap> Icons::customIconsPixmaps(const Database* db, IconSize size)
-{
-    QHash<QUuid, QPixmap> result;
-
-    for (const QUuid& uuid : db->metadata()->customIconsOrder()) {
-        result.insert(uuid, Icons::customIconPixmap(db, uuid, size));
+    const auto& data = db->metadata()->customIcon(uuid).data;
+    const auto cacheKey = QStringLiteral("customicon-%1-%2-%3-%4")
+                              .arg(uuid.toString(QUuid::WithoutBraces))
+                              .arg(qHash(data))
+                              .arg(size)
+                              .arg(qApp->devicePixelRatio());
+    QPixmap pixmap;
+    if (QPixmapCache::find(cacheKey, &pixmap)) {
+        return pixmap;
     }
 
-    return result;
+    // Generate QIcon with pre-baked resolutions
+    auto icon = QImage::fromData(data);
+    auto basePixmap = QPixmap::fromImage(icon.scaled(64, 64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    pixmap = QIcon(basePixmap).pixmap(databaseIcons()->iconSize(size));
+    QPixmapCache::insert(cacheKey, pixmap);
+    return pixmap;
 }
 
 QPixmap Icons::entryIconPixmap(const Entry* entry, IconSize size)
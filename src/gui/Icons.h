@@ -32,10 +32,11 @@ public:
     QIcon trayIcon(bool unlocked = true);
     QString trayIconAppearance() const;
     QIcon icon(const QString& name, bool recolor = true, const QColor& overrideColor = QColor::Invalid);
+    QIcon icon(int id, bool recolor = true, const QColor& overrideColor = QColor::Invalid);
+    int iconId(const QString& name);
     QIcon onOffIcon(const QString& name, bool on, bool recolor = true);
 
     static QPixmap customIconPixmap(const Database* db, const QUuid& uuid, IconSize size = IconSize::Default);
-    static QHash<QUuid, QPixmap> customIconsPixmaps(const Database* db, IconSize size = IconSize::Default);
     static QPixmap entryIconPixmap(const Entry* entry, IconSize size = IconSize::Default);
     static QPixmap groupIconPixmap(const Group* group, IconSize size = IconSize::Default);
 
@@ -49,7 +50,12 @@ private:
 
     static Icons* m_instance;
 
-    QHash<QString, QIcon> m_iconCache;
+    static quint64 cacheKey(int id, bool recolor, const QColor& overrideColor);
+
+    // Icon names are interned once, later lookups use the id
+    QHash<QString, int> m_iconIds;
+    QStringList m_iconNames;
+    QHash<quint64, QIcon> m_iconCache;
 
     Q_DISABLE_COPY(Icons)
 };
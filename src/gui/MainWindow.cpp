@@ -26,6 +26,7 @@
 #include <QList>
 #include <QMimeData>
 #include <QShortcut>
+#include <QStandardPaths>
 #include <QStatusBar>
 #include <QTimer>
 #include <QToolButton>
@@ -37,6 +38,7 @@
 #include "Clipboard.h"
 #include "autotype/AutoType.h"
 #include "core/InactivityTimer.h"
+#include "core/NetworkFile.h"
 #include "core/Resources.h"
 #include "core/Tools.h"
 #include "gui/AboutDialog.h"
@@ -214,6 +216,7 @@ MainWindow::MainWindow()
     connect(KeeShare::instance(),
             SIGNAL(sharingMessage(QString, MessageWidget::MessageType)),
             SLOT(displayGlobalMessage(QString, MessageWidget::MessageType)));
+    connect(KeeShare::instance(), SIGNAL(activeChanged()), SLOT(setMenuActionState()));
 #endif
 
 #ifdef WITH_XC_FDOSECRETS
@@ -468,6 +471,11 @@ MainWindow::MainWindow()
     connect(m_ui->actionExportCsv, SIGNAL(triggered()), m_ui->tabWidget, SLOT(exportToCsv()));
     connect(m_ui->actionExportHtml, SIGNAL(triggered()), m_ui->tabWidget, SLOT(exportToHtml()));
     connect(m_ui->actionExportXML, SIGNAL(triggered()), m_ui->tabWidget, SLOT(exportToXML()));
+#ifdef WITH_XC_KEESHARE
+    connect(m_ui->actionExportKeeShare, SIGNAL(triggered()), m_ui->tabWidget, SLOT(exportKeeShareContainers()));
+#else
+    m_ui->actionExportKeeShare->setVisible(false);
+#endif
     connect(
         m_ui->actionLockDatabase, SIGNAL(triggered()), m_ui->tabWidget, SLOT(lockAndSwitchToFirstUnlockedDatabase()));
     connect(m_ui->actionLockDatabaseToolbar, SIGNAL(triggered()), m_ui->actionLockDatabase, SIGNAL(triggered()));
@@ -953,6 +961,9 @@ void MainWindow::setMenuActionState(DatabaseWidget::Mode mode)
             m_ui->actionExportCsv->setEnabled(true);
             m_ui->actionExportHtml->setEnabled(true);
             m_ui->actionExportXML->setEnabled(true);
+#ifdef WITH_XC_KEESHARE
+            m_ui->actionExportKeeShare->setEnabled(KeeShare::active().out);
+#endif
             m_ui->actionDatabaseMerge->setEnabled(m_ui->tabWidget->currentIndex() != -1);
 #ifdef WITH_XC_BROWSER_PASSKEYS
             m_ui->actionPasskeys->setEnabled(true);
@@ -1013,6 +1024,7 @@ void MainWindow::setMenuActionState(DatabaseWidget::Mode mode)
             m_ui->menuExport->setEnabled(false);
             m_ui->actionExportCsv->setEnabled(false);
             m_ui->actionExportHtml->setEnabled(false);
+            m_ui->actionExportKeeShare->setEnabled(false);
             m_ui->actionDatabaseMerge->setEnabled(false);
             // Only disable the action in the database menu so that the
             // menu remains active in the toolbar, if necessary
@@ -1062,6 +1074,7 @@ void MainWindow::setMenuActionState(DatabaseWidget::Mode mode)
         m_ui->menuExport->setEnabled(false);
         m_ui->actionExportCsv->setEnabled(false);
         m_ui->actionExportHtml->setEnabled(false);
+        m_ui->actionExportKeeShare->setEnabled(false);
         m_ui->actionDatabaseMerge->setEnabled(false);
         // Hide entry-specific actions
         m_ui->actionEntryMoveUp->setVisible(false);
@@ -1647,6 +1660,15 @@ void MainWindow::applySettingsChanges()
         m_ui->toolBar->setToolButtonStyle(toolButtonStyle);
     }
 
+    // Local copies are removed as soon as they are no longer wanted
+    const QString networkCacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/databases";
+    if (config()->get(Config::CacheNetworkDatabases).toBool()) {
+        NetworkFile::setCacheDirectory(networkCacheDir);
+    } else {
+        NetworkFile::setCacheDirectory({});
+        QDir(networkCacheDir).removeRecursively();
+    }
+
     updateTrayIcon();
 }
 
@@ -2052,6 +2074,7 @@ void MainWindow::initActionCollection()
                     m_ui->actionExportCsv,
                     m_ui->actionExportHtml,
                     m_ui->actionExportXML,
+                    m_ui->actionExportKeeShare,
                     m_ui->actionQuit,
                     // Entry Menu
                     m_ui->actionEntryNew,
@@ -21,6 +21,7 @@
 
 #include "core/Config.h"
 #include "core/PasswordHealth.h"
+#include "core/PasswordStrengthEstimator.h"
 #include "gui/Font.h"
 #include "gui/Icons.h"
 #include "gui/PasswordGeneratorWidget.h"
@@ -35,6 +36,7 @@
 PasswordWidget::PasswordWidget(QWidget* parent)
     : QWidget(parent)
     , m_ui(new Ui::PasswordWidget())
+    , m_strengthEstimator(new PasswordStrengthEstimator(this))
 {
     m_ui->setupUi(this);
     setFocusProxy(m_ui->passwordEdit);
@@ -90,6 +92,7 @@ PasswordWidget::PasswordWidget(QWidget* parent)
     m_capslockAction->setVisible(false);
 
     // Reset the password strength bar, hidden by default
+    connect(m_strengthEstimator, &PasswordStrengthEstimator::estimated, this, &PasswordWidget::showPasswordStrength);
     updatePasswordStrength("");
     m_ui->qualityProgressBar->setVisible(false);
 
@@ -106,6 +109,7 @@ PasswordWidget::~PasswordWidget()
 void PasswordWidget::setQualityVisible(bool state)
 {
     m_ui->qualityProgressBar->setVisible(state);
+    updatePasswordStrength(text());
 }
 
 QString PasswordWidget::text()
@@ -274,13 +278,25 @@ void PasswordWidget::checkCapslockState()
 
 void PasswordWidget::updatePasswordStrength(const QString& password)
 {
-    if (password.isEmpty()) {
+    // Nothing to analyse while the meter is hidden
+    if (m_ui->qualityProgressBar->isHidden()) {
+        m_strengthEstimator->cancel();
+        return;
+    }
+
+    // Long passwords are analysed in the background, the meter is updated when they are done
+    m_strengthEstimator->estimate(password);
+}
+
+void PasswordWidget::showPasswordStrength(double entropy, bool provisional)
+{
+    if (m_ui->passwordEdit->text().isEmpty()) {
         m_ui->qualityProgressBar->setValue(0);
         m_ui->qualityProgressBar->setToolTip((tr("")));
         return;
     }
 
-    PasswordHealth health(password);
+    PasswordHealth health(entropy);
 
     m_ui->qualityProgressBar->setValue(std::min(int(health.entropy()), m_ui->qualityProgressBar->maximum()));
 
@@ -322,4 +338,8 @@ void PasswordWidget::updatePasswordStrength(const QString& password)
 
         break;
     }
+
+    if (provisional) {
+        m_ui->qualityProgressBar->setToolTip(tr("Quality: estimating…"));
+    }
 }
\ No newline at end of file
@@ -29,6 +29,8 @@ namespace Ui
     class PasswordWidget;
 }
 
+class PasswordStrengthEstimator;
+
 class PasswordWidget : public QWidget
 {
     Q_OBJECT
@@ -65,6 +67,7 @@ private slots:
     void popupPasswordGenerator();
     void updateRepeatStatus();
     void updatePasswordStrength(const QString& password);
+    void showPasswordStrength(double entropy, bool provisional);
 
 private:
     void checkCapslockState();
@@ -79,6 +82,7 @@ private:
     QPointer<QAction> m_capslockAction;
     QPointer<PasswordWidget> m_repeatPasswordWidget;
     QPointer<PasswordWidget> m_parentPasswordWidget;
+    PasswordStrengthEstimator* m_strengthEstimator;
 
     bool m_capslockState = false;
 };
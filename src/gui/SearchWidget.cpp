@@ -65,6 +65,13 @@ SearchWidget::SearchWidget(QWidget* parent)
     m_actionLimitGroup->setCheckable(true);
     m_actionLimitGroup->setChecked(config()->get(Config::SearchLimitGroup).toBool());
 
+    m_actionAttachmentContents =
+        m_searchMenu->addAction(tr("Index attachment contents"), this, SLOT(updateAttachmentContents()));
+    m_actionAttachmentContents->setObjectName("actionSearchAttachmentContents");
+    m_actionAttachmentContents->setToolTip(tr("Speeds up searching attachments with content:"));
+    m_actionAttachmentContents->setCheckable(true);
+    m_actionAttachmentContents->setChecked(config()->get(Config::SearchAttachmentContents).toBool());
+
     m_ui->searchIcon->setIcon(icons()->icon("system-search"));
     m_ui->searchEdit->addAction(m_ui->searchIcon, QLineEdit::LeadingPosition);
 
@@ -132,6 +139,7 @@ void SearchWidget::connectSignals(SignalMultiplexer& mx)
     mx.connect(this, SIGNAL(saveSearch(QString)), SLOT(saveSearch(QString)));
     mx.connect(this, SIGNAL(caseSensitiveChanged(bool)), SLOT(setSearchCaseSensitive(bool)));
     mx.connect(this, SIGNAL(limitGroupChanged(bool)), SLOT(setSearchLimitGroup(bool)));
+    mx.connect(this, SIGNAL(attachmentContentsChanged(bool)), SLOT(setSearchAttachmentContents(bool)));
     mx.connect(this, SIGNAL(copyPressed()), SLOT(copyPassword()));
     mx.connect(this, SIGNAL(downPressed()), SLOT(focusOnEntries()));
     mx.connect(SIGNAL(requestSearch(QString)), m_ui->searchEdit, SLOT(setText(QString)));
@@ -150,6 +158,7 @@ void SearchWidget::databaseChanged(DatabaseWidget* dbWidget)
         // Enforce search policy
         emit caseSensitiveChanged(m_actionCaseSensitive->isChecked());
         emit limitGroupChanged(m_actionLimitGroup->isChecked());
+        emit attachmentContentsChanged(m_actionAttachmentContents->isChecked());
     } else {
         clearSearch();
     }
@@ -198,6 +207,12 @@ void SearchWidget::updateLimitGroup()
     emit limitGroupChanged(m_actionLimitGroup->isChecked());
 }
 
+void SearchWidget::updateAttachmentContents()
+{
+    config()->set(Config::SearchAttachmentContents, m_actionAttachmentContents->isChecked());
+    emit attachmentContentsChanged(m_actionAttachmentContents->isChecked());
+}
+
 void SearchWidget::setLimitGroup(bool state)
 {
     m_actionLimitGroup->setChecked(state);
@@ -56,6 +56,7 @@ signals:
     void searchCanceled();
     void caseSensitiveChanged(bool state);
     void limitGroupChanged(bool state);
+    void attachmentContentsChanged(bool state);
     void escapePressed();
     void copyPressed();
     void downPressed();
@@ -73,6 +74,7 @@ private slots:
     void startSearch();
     void updateCaseSensitive();
     void updateLimitGroup();
+    void updateAttachmentContents();
     void toggleHelp();
     void showSearchMenu();
     void resetSearchClearTimer();
@@ -84,6 +86,7 @@ private:
     QTimer* m_clearSearchTimer;
     QAction* m_actionCaseSensitive;
     QAction* m_actionLimitGroup;
+    QAction* m_actionAttachmentContents;
     QMenu* m_searchMenu;
 };
 
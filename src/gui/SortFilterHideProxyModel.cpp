@@ -36,6 +36,37 @@ void SortFilterHideProxyModel::hideColumn(int column, bool hide)
     invalidateFilter();
 }
 
+void SortFilterHideProxyModel::setSourceModel(QAbstractItemModel* model)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, SLOT(clearSortKeys()));
+        disconnect(sourceModel(), nullptr, this, SLOT(removeSortKeys(QModelIndex, QModelIndex)));
+    }
+    clearSortKeys();
+
+    // Connect before the base class so the keys are dropped before it sorts again
+    if (model) {
+        connect(model, &QAbstractItemModel::dataChanged, this, &SortFilterHideProxyModel::removeSortKeys);
+        connect(model, &QAbstractItemModel::rowsAboutToBeInserted, this, &SortFilterHideProxyModel::clearSortKeys);
+        connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &SortFilterHideProxyModel::clearSortKeys);
+        connect(model, &QAbstractItemModel::rowsAboutToBeMoved, this, &SortFilterHideProxyModel::clearSortKeys);
+        connect(model, &QAbstractItemModel::columnsAboutToBeInserted, this, &SortFilterHideProxyModel::clearSortKeys);
+        connect(model, &QAbstractItemModel::columnsAboutToBeRemoved, this, &SortFilterHideProxyModel::clearSortKeys);
+        connect(model, &QAbstractItemModel::columnsAboutToBeMoved, this, &SortFilterHideProxyModel::clearSortKeys);
+        connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this, &SortFilterHideProxyModel::clearSortKeys);
+        connect(model, &QAbstractItemModel::modelAboutToBeReset, this, &SortFilterHideProxyModel::clearSortKeys);
+    }
+
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
+void SortFilterHideProxyModel::sort(int column, Qt::SortOrder order)
+{
+    // The sort role may have changed since the keys were built
+    clearSortKeys();
+    QSortFilterProxyModel::sort(column, order);
+}
+
 bool SortFilterHideProxyModel::filterAcceptsColumn(int sourceColumn, const QModelIndex& sourceParent) const
 {
     Q_UNUSED(sourceParent)
@@ -45,11 +76,61 @@ bool SortFilterHideProxyModel::filterAcceptsColumn(int sourceColumn, const QMode
 
 bool SortFilterHideProxyModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
 {
-    auto leftData = sourceModel()->data(left, sortRole());
-    auto rightData = sourceModel()->data(right, sortRole());
-    if (leftData.type() == QVariant::String) {
-        return m_collator.compare(leftData.toString(), rightData.toString()) < 0;
+    const auto* leftKey = sortKey(left);
+    const auto* rightKey = sortKey(right);
+    if (leftKey && rightKey) {
+        return leftKey->compare(*rightKey) < 0;
     }
 
     return QSortFilterProxyModel::lessThan(left, right);
 }
+
+/**
+ * Get the collation key of the sort data of a source index.
+ *
+ * Sorting compares every row O(n log n) times, and the data of an entry
+ * model index resolves placeholders each time it is read. The key is
+ * therefore built once and kept until the data or the layout of the
+ * source model changes.
+ *
+ * @return the collation key, or nullptr if the sort data is not a string
+ */
+const QCollatorSortKey* SortFilterHideProxyModel::sortKey(const QModelIndex& index) const
+{
+    auto key = m_sortKeys.constFind(index);
+    if (key != m_sortKeys.constEnd()) {
+        return &key.value();
+    }
+    if (m_sortTypes.contains(index)) {
+        return nullptr;
+    }
+
+    const auto data = sourceModel()->data(index, sortRole());
+    m_sortTypes.insert(index, data.type());
+    if (data.type() != QVariant::String) {
+        return nullptr;
+    }
+    return &m_sortKeys.insert(index, m_collator.sortKey(data.toString())).value();
+}
+
+void SortFilterHideProxyModel::clearSortKeys()
+{
+    m_sortKeys.clear();
+    m_sortTypes.clear();
+}
+
+void SortFilterHideProxyModel::removeSortKeys(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid()) {
+        clearSortKeys();
+        return;
+    }
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        for (int column = topLeft.column(); column <= bottomRight.column(); ++column) {
+            const auto index = topLeft.sibling(row, column);
+            m_sortKeys.remove(index);
+            m_sortTypes.remove(index);
+        }
+    }
+}
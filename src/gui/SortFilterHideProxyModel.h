@@ -20,6 +20,7 @@
 
 #include <QBitArray>
 #include <QCollator>
+#include <QHash>
 #include <QSortFilterProxyModel>
 
 class SortFilterHideProxyModel : public QSortFilterProxyModel
@@ -30,14 +31,25 @@ public:
     explicit SortFilterHideProxyModel(QObject* parent = nullptr);
     Qt::DropActions supportedDragActions() const override;
     void hideColumn(int column, bool hide);
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
 protected:
     bool filterAcceptsColumn(int sourceColumn, const QModelIndex& sourceParent) const override;
     bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
 
+private slots:
+    void clearSortKeys();
+    void removeSortKeys(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+
 private:
+    const QCollatorSortKey* sortKey(const QModelIndex& index) const;
+
     QBitArray m_hiddenColumns;
     QCollator m_collator;
+    // Collation keys of the string data of source indexes, see lessThan()
+    mutable QHash<QModelIndex, QCollatorSortKey> m_sortKeys;
+    mutable QHash<QModelIndex, QVariant::Type> m_sortTypes;
 };
 
 #endif // KEEPASSX_SORTFILTERHIDEPROXYMODEL_H
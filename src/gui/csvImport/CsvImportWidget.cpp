@@ -23,10 +23,13 @@
 #include "core/Database.h"
 #include "core/Group.h"
 #include "core/Totp.h"
+#include "format/BulkImport.h"
 #include "format/CsvParser.h"
 #include "format/KeePass2Writer.h"
 #include "gui/csvImport/CsvParserModel.h"
 
+#include <QProgressDialog>
+#include <QSignalBlocker>
 #include <QStringListModel>
 
 namespace
@@ -146,7 +149,7 @@ void CsvImportWidget::updatePreview()
 
     int minSkip = m_ui->checkBoxFieldNames->isChecked() ? 1 : 0;
     m_ui->labelSizeRowsCols->setText(m_parserModel->getFileInfo());
-    m_ui->spinBoxSkip->setRange(minSkip, qMax(minSkip, m_parserModel->rowCount() - 1));
+    m_ui->spinBoxSkip->setRange(minSkip, qMax(minSkip, m_parserModel->parser()->getCsvRows() - 1));
     m_ui->spinBoxSkip->setValue(minSkip);
 
     QStringList csvColumns(tr("Not Present"));
@@ -196,6 +199,39 @@ void CsvImportWidget::load(const QString& filename)
     m_filename = filename;
     m_parserModel->setFilename(filename);
     parse();
+    detectDialect();
+}
+
+void CsvImportWidget::detectDialect()
+{
+    QString qualifiers;
+    for (int i = 0; i < m_ui->comboBoxTextQualifier->count(); ++i) {
+        qualifiers.append(m_ui->comboBoxTextQualifier->itemText(i).at(0));
+    }
+
+    QChar separator;
+    QChar qualifier;
+    if (!m_parserModel->parser()->detectDialect(m_fieldSeparatorList.join(""), qualifiers, separator, qualifier)) {
+        return;
+    }
+
+    const int separatorIndex = m_fieldSeparatorList.indexOf(separator);
+    const int qualifierIndex = qualifier.isNull() ? -1 : m_ui->comboBoxTextQualifier->findText(qualifier);
+    bool changed = false;
+    if (separatorIndex >= 0 && separatorIndex != m_ui->comboBoxFieldSeparator->currentIndex()) {
+        QSignalBlocker blocker(m_ui->comboBoxFieldSeparator);
+        m_ui->comboBoxFieldSeparator->setCurrentIndex(separatorIndex);
+        changed = true;
+    }
+    if (qualifierIndex >= 0 && qualifierIndex != m_ui->comboBoxTextQualifier->currentIndex()) {
+        QSignalBlocker blocker(m_ui->comboBoxTextQualifier);
+        m_ui->comboBoxTextQualifier->setCurrentIndex(qualifierIndex);
+        changed = true;
+    }
+
+    if (changed) {
+        parse();
+    }
 }
 
 void CsvImportWidget::parse()
@@ -216,77 +252,95 @@ QSharedPointer<Database> CsvImportWidget::buildDatabase()
     auto db = QSharedPointer<Database>::create();
     db->rootGroup()->setNotes(tr("Imported from CSV file: %1").arg(m_filename));
 
-    for (int r = 0; r < m_parserModel->rowCount(); ++r) {
+    // Stream the rows from the file and create the groups, entries are then built in parallel
+    QVector<QVector<QVariant>> rows;
+    QList<Group*> groups;
+    m_parserModel->forEachRow([&](const QVector<QVariant>& row) {
         // use validity of second column as a GO/NOGO for all others fields
-        if (!m_parserModel->data(m_parserModel->index(r, 1)).isValid()) {
-            continue;
+        if (!row.at(1).isValid()) {
+            return;
         }
-        auto group = createGroupStructure(db.data(), m_parserModel->data(m_parserModel->index(r, 0)).toString());
+        auto group = createGroupStructure(db.data(), row.at(0).toString());
         if (!group) {
-            continue;
+            return;
         }
 
-        auto entry = new Entry();
-        entry->setUuid(QUuid::createUuid());
-        entry->setGroup(group);
-        entry->setTitle(m_parserModel->data(m_parserModel->index(r, 1)).toString());
-        entry->setUsername(m_parserModel->data(m_parserModel->index(r, 2)).toString());
-        entry->setPassword(m_parserModel->data(m_parserModel->index(r, 3)).toString());
-        entry->setUrl(m_parserModel->data(m_parserModel->index(r, 4)).toString());
-        entry->setNotes(m_parserModel->data(m_parserModel->index(r, 5)).toString());
-
-        auto otpString = m_parserModel->data(m_parserModel->index(r, 6));
-        if (otpString.isValid() && !otpString.toString().isEmpty()) {
-            auto totp = Totp::parseSettings(otpString.toString());
-            if (!totp || totp->key.isEmpty()) {
-                // Bare secret, use default TOTP settings
-                totp = Totp::parseSettings({}, otpString.toString());
+        rows.append(row);
+        groups.append(group);
+    });
+
+    QProgressDialog progress(tr("Importing entries…"), QString(), 0, rows.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+
+    const auto entries = BulkImport::buildEntries(
+        rows.size(),
+        [&rows](int i) {
+            const auto& row = rows.at(i);
+
+            auto entry = new Entry();
+            entry->setUuid(QUuid::createUuid());
+            entry->setTitle(row[1].toString());
+            entry->setUsername(row[2].toString());
+            entry->setPassword(row[3].toString());
+            entry->setUrl(row[4].toString());
+            entry->setNotes(row[5].toString());
+
+            auto otpString = row[6];
+            if (otpString.isValid() && !otpString.toString().isEmpty()) {
+                auto totp = Totp::parseSettings(otpString.toString());
+                if (!totp || totp->key.isEmpty()) {
+                    // Bare secret, use default TOTP settings
+                    totp = Totp::parseSettings({}, otpString.toString());
+                }
+                entry->setTotp(totp);
             }
-            entry->setTotp(totp);
-        }
 
-        bool ok;
-        int icon = m_parserModel->data(m_parserModel->index(r, 7)).toInt(&ok);
-        if (ok) {
-            entry->setIcon(icon);
-        }
+            bool ok;
+            int icon = row[7].toInt(&ok);
+            if (ok) {
+                entry->setIcon(icon);
+            }
 
-        TimeInfo timeInfo;
-        if (m_parserModel->data(m_parserModel->index(r, 8)).isValid()) {
-            auto datetime = m_parserModel->data(m_parserModel->index(r, 8)).toString();
-            if (datetime.contains(QRegularExpression("^\\d+$"))) {
-                auto t = datetime.toLongLong();
-                if (t <= INT32_MAX) {
-                    t *= 1000;
-                }
-                auto lastModified = Clock::datetimeUtc(t);
-                timeInfo.setLastModificationTime(lastModified);
-                timeInfo.setLastAccessTime(lastModified);
-            } else {
-                auto lastModified = QDateTime::fromString(datetime, Qt::ISODate);
-                if (lastModified.isValid()) {
+            TimeInfo timeInfo;
+            if (row[8].isValid()) {
+                auto datetime = row[8].toString();
+                if (datetime.contains(QRegularExpression("^\\d+$"))) {
+                    auto t = datetime.toLongLong();
+                    if (t <= INT32_MAX) {
+                        t *= 1000;
+                    }
+                    auto lastModified = Clock::datetimeUtc(t);
                     timeInfo.setLastModificationTime(lastModified);
                     timeInfo.setLastAccessTime(lastModified);
+                } else {
+                    auto lastModified = QDateTime::fromString(datetime, Qt::ISODate);
+                    if (lastModified.isValid()) {
+                        timeInfo.setLastModificationTime(lastModified);
+                        timeInfo.setLastAccessTime(lastModified);
+                    }
                 }
             }
-        }
-        if (m_parserModel->data(m_parserModel->index(r, 9)).isValid()) {
-            auto datetime = m_parserModel->data(m_parserModel->index(r, 9)).toString();
-            if (datetime.contains(QRegularExpression("^\\d+$"))) {
-                auto t = datetime.toLongLong();
-                if (t <= INT32_MAX) {
-                    t *= 1000;
-                }
-                timeInfo.setCreationTime(Clock::datetimeUtc(t));
-            } else {
-                auto created = QDateTime::fromString(datetime, Qt::ISODate);
-                if (created.isValid()) {
-                    timeInfo.setCreationTime(created);
+            if (row[9].isValid()) {
+                auto datetime = row[9].toString();
+                if (datetime.contains(QRegularExpression("^\\d+$"))) {
+                    auto t = datetime.toLongLong();
+                    if (t <= INT32_MAX) {
+                        t *= 1000;
+                    }
+                    timeInfo.setCreationTime(Clock::datetimeUtc(t));
+                } else {
+                    auto created = QDateTime::fromString(datetime, Qt::ISODate);
+                    if (created.isValid()) {
+                        timeInfo.setCreationTime(created);
+                    }
                 }
             }
-        }
-        entry->setTimeInfo(timeInfo);
-    }
+            entry->setTimeInfo(timeInfo);
+            return entry;
+        },
+        [&progress](int done, int) { progress.setValue(done); });
+
+    BulkImport::attachEntries(db.data(), entries, groups);
 
     return db;
 }
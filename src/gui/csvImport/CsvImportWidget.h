@@ -54,6 +54,7 @@ private slots:
 
 private:
     void configParser();
+    void detectDialect();
     void updateTableview();
     QString formatStatusText() const;
 
@@ -23,11 +23,19 @@
 
 #include <QFile>
 
+namespace
+{
+    // Rows parsed for the preview, the import streams all of them from the file
+    constexpr int PreviewRows = 100;
+} // namespace
+
 CsvParserModel::CsvParserModel(QObject* parent)
     : QAbstractTableModel(parent)
     , m_parser(new CsvParser())
     , m_skipped(0)
 {
+    m_parser->setMaxTableRows(PreviewRows);
+    m_parser->setStopWhenTableFull(true);
 }
 
 CsvParserModel::~CsvParserModel() = default;
@@ -46,7 +54,8 @@ QString CsvParserModel::getFileInfo()
 {
     return QString("%1, %2, %3")
         .arg(Tools::humanReadableFileSize(m_parser->getFileSize()),
-             tr("%n row(s)", "CSV row count", m_parser->getCsvRows()),
+             m_parser->isComplete() ? tr("%n row(s)", "CSV row count", m_parser->getCsvRows())
+                                    : tr("more than %n row(s)", "CSV row count", PreviewRows),
              tr("%n column(s)", "CSV column count", qMax(0, m_parser->getCsvCols() - 1)));
 }
 
@@ -68,6 +77,30 @@ bool CsvParserModel::parse()
     return r;
 }
 
+/**
+ * Read all rows of the file after the skipped ones, mapped to the model
+ * columns like data() does. Unlike the model, this is not limited to the preview.
+ */
+bool CsvParserModel::forEachRow(const std::function<void(const QVector<QVariant>& row)>& handler)
+{
+    int csvRow = 0;
+    return m_parser->forEachRow([&](const CsvRow& fields) {
+        if (csvRow++ < m_skipped) {
+            return true;
+        }
+
+        QVector<QVariant> row(m_columnHeader.size());
+        for (int c = 0; c < row.size(); ++c) {
+            auto column = m_columnMap.value(c);
+            if (column >= 0 && column < fields.size()) {
+                row[c] = fields.at(column);
+            }
+        }
+        handler(row);
+        return true;
+    });
+}
+
 void CsvParserModel::mapColumns(int csvColumn, int dbColumn)
 {
     if (dbColumn < 0 || dbColumn >= m_columnMap.size()) {
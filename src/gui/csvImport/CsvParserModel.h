@@ -21,6 +21,8 @@
 
 #include <QAbstractTableModel>
 
+#include <functional>
+
 class CsvParser;
 
 class CsvParserModel : public QAbstractTableModel
@@ -34,6 +36,7 @@ public:
     void setFilename(const QString& filename);
     QString getFileInfo();
     bool parse();
+    bool forEachRow(const std::function<void(const QVector<QVariant>& row)>& handler);
 
     CsvParser* parser();
 
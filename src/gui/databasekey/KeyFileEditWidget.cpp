@@ -19,6 +19,7 @@
 #include "ui_KeyComponentWidget.h"
 #include "ui_KeyFileEditWidget.h"
 
+#include "core/AsyncTask.h"
 #include "gui/FileDialog.h"
 #include "gui/MainWindow.h"
 #include "gui/MessageBox.h"
@@ -39,7 +40,7 @@ bool KeyFileEditWidget::addToCompositeKey(QSharedPointer<CompositeKey> key)
 {
     auto fileKey = QSharedPointer<FileKey>::create();
     QString fileKeyName = m_compUi->keyFileLineEdit->text();
-    if (!fileKey->load(fileKeyName, nullptr)) {
+    if (!AsyncTask::runAndWaitForFuture([&] { return fileKey->load(fileKeyName, nullptr); })) {
         return false;
     }
 
@@ -61,7 +62,7 @@ bool KeyFileEditWidget::validate(QString& errorMessage) const
     FileKey fileKey;
     QString fileKeyError;
     QString fileKeyName = m_compUi->keyFileLineEdit->text();
-    if (!fileKey.load(fileKeyName, &fileKeyError)) {
+    if (!AsyncTask::runAndWaitForFuture([&] { return fileKey.load(fileKeyName, &fileKeyError); })) {
         errorMessage = tr("Error loading the key file '%1'\nMessage: %2").arg(fileKeyName, fileKeyError);
         return false;
     }
@@ -18,10 +18,12 @@
 #include "DatabaseSettingsWidgetMaintenance.h"
 #include "ui_DatabaseSettingsWidgetMaintenance.h"
 
+#include "core/DatabaseDiagnostics.h"
+#include "core/DatabaseOptimizer.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/Tools.h"
 #include "gui/IconModels.h"
-#include "gui/Icons.h"
 #include "gui/MessageBox.h"
 
 DatabaseSettingsWidgetMaintenance::DatabaseSettingsWidgetMaintenance(QWidget* parent)
@@ -36,6 +38,7 @@ DatabaseSettingsWidgetMaintenance::DatabaseSettingsWidgetMaintenance(QWidget* pa
 
     connect(m_ui->deleteButton, SIGNAL(clicked()), SLOT(removeCustomIcon()));
     connect(m_ui->purgeButton, SIGNAL(clicked()), SLOT(purgeUnusedCustomIcons()));
+    connect(m_ui->optimizeButton, SIGNAL(clicked()), SLOT(optimizeDatabase()));
     connect(m_ui->customIconsView->selectionModel(),
             SIGNAL(selectionChanged(QItemSelection, QItemSelection)),
             this,
@@ -46,8 +49,7 @@ DatabaseSettingsWidgetMaintenance::~DatabaseSettingsWidgetMaintenance() = defaul
 
 void DatabaseSettingsWidgetMaintenance::populateIcons(QSharedPointer<Database> db)
 {
-    m_customIconModel->setIcons(Icons::customIconsPixmaps(db.data(), IconSize::Default),
-                                db->metadata()->customIconsOrder());
+    m_customIconModel->setIcons(db.data(), IconSize::Default);
     m_ui->deleteButton->setEnabled(false);
 }
 
@@ -162,50 +164,7 @@ void DatabaseSettingsWidgetMaintenance::purgeUnusedCustomIcons()
         return;
     }
 
-    QList<Entry*> historyEntries;
-    QSet<QUuid> historicIcons;
-    QSet<QUuid> iconsInUse;
-
-    const QList<Entry*> allEntries = database->rootGroup()->entriesRecursive(true);
-    for (Entry* entry : allEntries) {
-        if (!entry->group()) {
-            // Icons exclusively in use by historic entries (no
-            // group assigned) are also purged from the database
-            historyEntries << entry;
-            historicIcons << entry->iconUuid();
-        } else {
-            iconsInUse << entry->iconUuid();
-        }
-    }
-
-    const QList<Group*> allGroups = database->rootGroup()->groupsRecursive(true);
-    for (Group* group : allGroups) {
-        iconsInUse.insert(group->iconUuid());
-    }
-
-    int purgeCounter = 0;
-    QList<QUuid> customIcons = database->metadata()->customIconsOrder();
-    for (QUuid iconUuid : customIcons) {
-        if (iconsInUse.contains(iconUuid)) {
-            continue;
-        }
-
-        if (historicIcons.contains(iconUuid)) {
-            // Remove the icon from history entries using this icon
-            for (Entry* historicEntry : asConst(historyEntries)) {
-                if (historicEntry->iconUuid() != iconUuid) {
-                    continue;
-                }
-                historicEntry->setUpdateTimeinfo(false);
-                historicEntry->setIcon(0);
-                historicEntry->setUpdateTimeinfo(true);
-            }
-        }
-
-        ++purgeCounter;
-        database->metadata()->removeCustomIcon(iconUuid);
-    }
-
+    const int purgeCounter = DatabaseOptimizer(database.data()).purgeUnusedIcons();
     if (0 == purgeCounter) {
         MessageBox::information(this,
                                 tr("Custom Icons Are In Use"),
@@ -219,3 +178,41 @@ void DatabaseSettingsWidgetMaintenance::purgeUnusedCustomIcons()
     MessageBox::information(
         this, tr("Purged Unused Icons"), tr("Purged %n icon(s) from the database.", "", purgeCounter), MessageBox::Ok);
 }
+
+void DatabaseSettingsWidgetMaintenance::optimizeDatabase()
+{
+    auto database = DatabaseSettingsWidget::getDatabase();
+    if (!database) {
+        return;
+    }
+
+    auto answer = MessageBox::question(this,
+                                       tr("Optimize Database"),
+                                       tr("History items beyond the history limits, unused custom icons and old "
+                                          "records of deleted objects will be removed. Are you sure you want to "
+                                          "continue?"),
+                                       MessageBox::Yes | MessageBox::Cancel,
+                                       MessageBox::Cancel);
+    if (answer != MessageBox::Yes) {
+        return;
+    }
+
+    const qint64 memoryBefore = DatabaseDiagnostics(database).totalBytes();
+    const auto result = DatabaseOptimizer(database.data()).optimize();
+    const qint64 memoryAfter = DatabaseDiagnostics(database).totalBytes();
+    populateIcons(database);
+
+    if (!result.isModified() && result.sharedAttachments == 0) {
+        MessageBox::information(
+            this, tr("Database Optimized"), tr("The database is already optimized."), MessageBox::Ok);
+        return;
+    }
+
+    QStringList lines = result.changes();
+    lines << tr("Memory used by the database: %1 before, %2 after.")
+                 .arg(Tools::humanReadableFileSize(memoryBefore), Tools::humanReadableFileSize(memoryAfter));
+    if (result.isModified()) {
+        lines << tr("Save the database to make it smaller on disk.");
+    }
+    MessageBox::information(this, tr("Database Optimized"), lines.join("\n"), MessageBox::Ok);
+}
@@ -49,6 +49,7 @@ private slots:
     void selectionChanged();
     void removeCustomIcon();
     void purgeUnusedCustomIcons();
+    void optimizeDatabase();
 
 private:
     void populateIcons(QSharedPointer<Database> db);
@@ -41,6 +41,7 @@
 #include "core/TimeDelta.h"
 #ifdef WITH_XC_SSHAGENT
 #include "sshagent/OpenSSHKey.h"
+#include "sshagent/OpenSSHKeyGen.h"
 #include "sshagent/OpenSSHKeyGenDialog.h"
 #include "sshagent/SSHAgent.h"
 #endif
@@ -226,6 +227,7 @@ void EditEntryWidget::setupAutoType()
 {
     m_autoTypeUi->setupUi(m_autoTypeWidget);
     addPage(tr("Auto-Type"), icons()->icon("auto-type"), m_autoTypeWidget);
+    m_autoTypeWidget->installEventFilter(this);
 
     m_autoTypeUi->openHelpButton->setIcon(icons()->icon("system-help"));
 
@@ -574,6 +576,7 @@ void EditEntryWidget::setupSSHAgent()
     // clang-format on
 
     addPage(tr("SSH Agent"), icons()->icon("utilities-terminal"), m_sshAgentWidget);
+    m_sshAgentWidget->installEventFilter(this);
 }
 
 void EditEntryWidget::setSSHAgentSettings()
@@ -652,6 +655,12 @@ void EditEntryWidget::updateSSHAgentKeyInfo()
     m_sshAgentUi->decryptButton->setEnabled(false);
     m_sshAgentUi->publicKeyEdit->document()->setPlainText("");
 
+    // Reading the key can be slow, wait until the page is shown
+    m_sshAgentKeyInfoStale = !m_sshAgentWidget->isVisible();
+    if (m_sshAgentKeyInfoStale) {
+        return;
+    }
+
     OpenSSHKey key;
 
     if (!getOpenSSHKey(key)) {
@@ -819,26 +828,10 @@ void EditEntryWidget::generatePrivateKey()
     dialog->setKey(&key);
 
     if (dialog->exec()) {
-        // derive openssh naming from type
-        QString keyPrefix = key.type();
-        if (keyPrefix.startsWith("ecdsa")) {
-            keyPrefix = "id_ecdsa";
-        } else {
-            keyPrefix.replace("ssh-", "id_");
-        }
-
-        for (int i = 0; i < 10; i++) {
-            QString keyName = keyPrefix;
-
-            if (i > 0) {
-                keyName += "." + QString::number(i);
-            }
-
-            if (!m_entry->attachments()->hasKey(keyName)) {
-                m_pendingPrivateKey = keyName;
-                m_entry->attachments()->set(m_pendingPrivateKey, key.privateKey().toUtf8());
-                break;
-            }
+        const auto keyName = OpenSSHKeyGen::attachmentName(m_entry->attachments(), key.type());
+        if (!keyName.isEmpty()) {
+            m_pendingPrivateKey = keyName;
+            m_entry->attachments()->set(m_pendingPrivateKey, key.privateKey().toUtf8());
         }
     }
 }
@@ -864,6 +857,23 @@ Entry* EditEntryWidget::currentEntry() const
     return m_entry;
 }
 
+bool EditEntryWidget::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::Show) {
+        if (watched == m_autoTypeWidget && m_windowListStale) {
+            m_autoTypeUi->windowTitleCombo->refreshWindowList();
+            m_windowListStale = false;
+        }
+#ifdef WITH_XC_SSHAGENT
+        if (watched == m_sshAgentWidget && m_sshAgentKeyInfoStale) {
+            updateSSHAgentKeyInfo();
+        }
+#endif
+    }
+
+    return EditWidget::eventFilter(watched, event);
+}
+
 void EditEntryWidget::loadEntry(Entry* entry,
                                 bool create,
                                 bool history,
@@ -891,7 +901,7 @@ void EditEntryWidget::loadEntry(Entry* entry,
     setReadOnly(m_history);
 
     setCurrentPage(0);
-    setPageHidden(m_historyWidget, m_history || m_entry->historyItems().count() < 1);
+    setPageHidden(m_historyWidget, m_history || m_entry->historyCount() < 1);
 #ifdef WITH_XC_SSHAGENT
     setPageHidden(m_sshAgentWidget, !sshAgent()->isEnabled());
 #endif
@@ -1002,8 +1012,11 @@ void EditEntryWidget::setForms(Entry* entry, bool restore)
     if (m_autoTypeAssoc->size() != 0) {
         m_autoTypeUi->assocView->setCurrentIndex(m_autoTypeAssocModel->index(0, 0));
     }
-    if (!m_history) {
+    // Listing the open windows can be slow, wait until the page is shown
+    m_windowListStale = !m_history;
+    if (m_windowListStale && m_autoTypeWidget->isVisible()) {
         m_autoTypeUi->windowTitleCombo->refreshWindowList();
+        m_windowListStale = false;
     }
     updateAutoTypeEnabled();
 
@@ -1190,7 +1203,7 @@ bool EditEntryWidget::commitEntry()
     }
 
     m_historyModel->setEntries(m_entry->historyItems(), m_entry);
-    setPageHidden(m_historyWidget, m_history || m_entry->historyItems().count() < 1);
+    setPageHidden(m_historyWidget, m_history || m_entry->historyCount() < 1);
     m_advancedUi->attachmentsWidget->linkAttachments(m_entry->attachments());
 
     showMessage(tr("Entry updated successfully."), MessageWidget::Positive);
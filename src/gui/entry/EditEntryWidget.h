@@ -81,6 +81,9 @@ signals:
     void editFinished(bool accepted);
     void historyEntryActivated(Entry* entry);
 
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
 private slots:
     void acceptEntry();
     bool commitEntry();
@@ -167,9 +170,13 @@ private:
 
     bool m_create;
     bool m_history;
+    // Set while the Auto-Type page has not been shown since the entry was loaded
+    bool m_windowListStale = false;
 #ifdef WITH_XC_SSHAGENT
     KeeAgentSettings m_sshAgentSettings;
     QString m_pendingPrivateKey;
+    // Set while the key info has not been updated because the SSH Agent page is hidden
+    bool m_sshAgentKeyInfoStale = false;
 #endif
     const QScopedPointer<Ui::EditEntryWidgetMain> m_mainUi;
     const QScopedPointer<Ui::EditEntryWidgetAdvanced> m_advancedUi;
@@ -21,16 +21,34 @@
 #include <QDir>
 #include <QDropEvent>
 #include <QMimeData>
+#include <QProgressDialog>
 #include <QStandardPaths>
 #include <QTemporaryFile>
 
 #include "EntryAttachmentsModel.h"
 #include "core/Config.h"
 #include "core/EntryAttachments.h"
-#include "core/Tools.h"
 #include "gui/FileDialog.h"
 #include "gui/MessageBox.h"
 
+namespace
+{
+    /**
+     * Show the progress of streaming an attachment in a dialog that only
+     * shows up if it takes a while. The range is in KiB to fit into an int.
+     */
+    EntryAttachments::ProgressCallback progressCallback(QProgressDialog& dialog)
+    {
+        dialog.setWindowModality(Qt::WindowModal);
+        dialog.setMinimumDuration(500);
+        return [&dialog](qint64 done, qint64 total) {
+            dialog.setMaximum(total > 0 ? static_cast<int>(total / 1024) : 0);
+            dialog.setValue(static_cast<int>(done / 1024));
+            return !dialog.wasCanceled();
+        };
+    }
+} // namespace
+
 EntryAttachmentsWidget::EntryAttachmentsWidget(QWidget* parent)
     : QWidget(parent)
     , m_ui(new Ui::EntryAttachmentsWidget)
@@ -248,9 +266,13 @@ void EntryAttachmentsWidget::saveSelectedAttachments()
         }
 
         QFile file(attachmentPath);
-        const QByteArray attachmentData = m_entryAttachments->value(filename);
+        QProgressDialog progress(tr("Saving attachment %1…").arg(filename), tr("Cancel"), 0, 0, this);
         const bool saveOk = file.open(QIODevice::WriteOnly) && file.setPermissions(QFile::ReadUser | QFile::WriteUser)
-                            && file.write(attachmentData) == attachmentData.size();
+                            && m_entryAttachments->exportToDevice(filename, &file, nullptr, progressCallback(progress));
+        if (progress.wasCanceled()) {
+            file.remove();
+            break;
+        }
         if (!saveOk) {
             errors.append(QString("%1 - %2").arg(filename, file.errorString()));
         }
@@ -323,14 +345,20 @@ bool EntryAttachmentsWidget::insertAttachments(const QStringList& filenames, QSt
 
     QStringList errors;
     for (const QString& filename : filenames) {
-        QByteArray data;
         QFile file(filename);
         const QFileInfo fInfo(filename);
-        const bool readOk = file.open(QIODevice::ReadOnly) && Tools::readAllFromDevice(&file, data);
-        if (readOk) {
-            m_entryAttachments->set(fInfo.fileName(), data);
-        } else {
+        if (!file.open(QIODevice::ReadOnly)) {
             errors.append(QString("%1 - %2").arg(fInfo.fileName(), file.errorString()));
+            continue;
+        }
+
+        QProgressDialog progress(tr("Adding attachment %1…").arg(fInfo.fileName()), tr("Cancel"), 0, 0, this);
+        QString error;
+        if (!m_entryAttachments->importFromDevice(fInfo.fileName(), &file, &error, progressCallback(progress))) {
+            if (progress.wasCanceled()) {
+                break;
+            }
+            errors.append(QString("%1 - %2").arg(fInfo.fileName(), error));
         }
     }
 
@@ -439,14 +467,17 @@ void EntryAttachmentsWidget::attachmentModifiedExternally(const QString& key, co
 
     if (result == MessageBox::Save) {
         QFile f(filePath);
-        if (f.open(QFile::ReadOnly)) {
-            m_entryAttachments->set(key, f.readAll());
-            f.close();
+        QProgressDialog progress(tr("Saving attachment %1…").arg(key), tr("Cancel"), 0, 0, this);
+        QString error;
+        if (!f.open(QFile::ReadOnly)) {
+            error = f.errorString();
+        } else if (m_entryAttachments->importFromDevice(key, &f, &error, progressCallback(progress))) {
             emit widgetUpdated();
-        } else {
-            MessageBox::critical(this,
-                                 tr("Saving attachment failed"),
-                                 tr("Saving updated attachment failed.\nError: %1").arg(f.errorString()));
+        }
+
+        if (!error.isEmpty()) {
+            MessageBox::critical(
+                this, tr("Saving attachment failed"), tr("Saving updated attachment failed.\nError: %1").arg(error));
         }
     }
 
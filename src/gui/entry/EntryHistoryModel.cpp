@@ -21,9 +21,38 @@
 #include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Tools.h"
+#include "core/Totp.h"
 
 #include <QFont>
 
+namespace
+{
+    // Fields that can differ between two versions of an entry
+    namespace ModifiedField
+    {
+        enum
+        {
+            Title = 1 << 0,
+            Username = 1 << 1,
+            Password = 1 << 2,
+            Url = 1 << 3,
+            Notes = 1 << 4,
+            CustomAttributes = 1 << 5,
+            Icon = 1 << 6,
+            Color = 1 << 7,
+            Expiration = 1 << 8,
+            Totp = 1 << 9,
+            CustomData = 1 << 10,
+            Attachments = 1 << 11,
+            AutoType = 1 << 12,
+            Tags = 1 << 13
+        };
+    } // namespace ModifiedField
+
+    // Not computed yet
+    constexpr int Unknown = -1;
+} // namespace
+
 EntryHistoryModel::EntryHistoryModel(QObject* parent)
     : QAbstractTableModel(parent)
 {
@@ -82,15 +111,15 @@ QVariant EntryHistoryModel::data(const QModelIndex& index, int role) const
             return seconds;
         }
         case 2:
-            if (index.row() < m_historyModifications.size()) {
-                return m_historyModifications[index.row()];
+            if (index.row() < m_historyEntries.size() - 1) {
+                return modificationsText(modifiedFields(index.row()));
             }
             return {};
         case 3:
             if (role == Qt::DisplayRole) {
-                return Tools::humanReadableFileSize(entry->size(), 0);
+                return Tools::humanReadableFileSize(entrySize(index.row()), 0);
             }
-            return entry->size();
+            return entrySize(index.row());
         }
     } else if (role == Qt::FontRole && entry == m_parentEntry) {
         QFont font;
@@ -130,7 +159,9 @@ void EntryHistoryModel::setEntries(const QList<Entry*>& entries, Entry* parentEn
         return lhs->timeInfo().lastModificationTime() > rhs->timeInfo().lastModificationTime();
     });
     m_deletedHistoryEntries.clear();
-    calculateHistoryModifications();
+    // Differences and sizes are computed when a row is shown
+    m_modifiedFields.fill(Unknown, m_historyEntries.size());
+    m_sizes.fill(Unknown, m_historyEntries.size());
     endResetModel();
 }
 
@@ -140,6 +171,8 @@ void EntryHistoryModel::clear()
 
     m_historyEntries.clear();
     m_deletedHistoryEntries.clear();
+    m_modifiedFields.clear();
+    m_sizes.clear();
 
     endResetModel();
 }
@@ -158,11 +191,20 @@ void EntryHistoryModel::deleteIndex(QModelIndex index)
 {
     auto entry = entryFromIndex(index);
     if (entry) {
-        beginRemoveRows(QModelIndex(), index.row(), index.row());
-        m_historyEntries.removeAll(entry);
+        const int row = index.row();
+        beginRemoveRows(QModelIndex(), row, row);
+        m_historyEntries.removeAt(row);
         m_deletedHistoryEntries << entry;
-        m_historyModifications.erase(m_historyModifications.begin() + index.row());
+        m_modifiedFields.remove(row);
+        m_sizes.remove(row);
+        // The newer row is now compared to the next older one
+        if (row > 0) {
+            m_modifiedFields[row - 1] = Unknown;
+        }
         endRemoveRows();
+        if (row > 0) {
+            emit dataChanged(this->index(row - 1, 2), this->index(row - 1, 2));
+        }
     }
 }
 
@@ -178,81 +220,131 @@ void EntryHistoryModel::deleteAll()
         }
     }
     m_historyEntries.clear();
+    m_modifiedFields.clear();
+    m_sizes.clear();
     endRemoveRows();
 }
 
-void EntryHistoryModel::calculateHistoryModifications()
+int EntryHistoryModel::entrySize(int row) const
 {
-    m_historyModifications.clear();
-
-    Entry* compare = nullptr;
-    for (const auto curr : m_historyEntries) {
-        if (!compare) {
-            compare = curr;
-            continue;
-        }
-
-        QStringList modifiedFields;
+    if (m_sizes[row] == Unknown) {
+        m_sizes[row] = m_historyEntries[row]->size();
+    }
+    return m_sizes[row];
+}
 
-        if (*curr->attributes() != *compare->attributes()) {
-            bool foundAttribute = false;
+/**
+ * Fields changed between the entry at the given row and the next older one.
+ */
+int EntryHistoryModel::modifiedFields(int row) const
+{
+    if (m_modifiedFields[row] != Unknown) {
+        return m_modifiedFields[row];
+    }
 
-            if (curr->title() != compare->title()) {
-                modifiedFields << tr("Title");
-                foundAttribute = true;
-            }
-            if (curr->username() != compare->username()) {
-                modifiedFields << tr("Username");
-                foundAttribute = true;
-            }
-            if (curr->password() != compare->password()) {
-                modifiedFields << tr("Password");
-                foundAttribute = true;
-            }
-            if (curr->url() != compare->url()) {
-                modifiedFields << tr("URL");
-                foundAttribute = true;
-            }
-            if (curr->notes() != compare->notes()) {
-                modifiedFields << tr("Notes");
-                foundAttribute = true;
-            }
+    const auto compare = m_historyEntries[row];
+    const auto curr = m_historyEntries[row + 1];
+    int fields = 0;
 
-            if (!foundAttribute) {
-                modifiedFields << tr("Custom Attributes");
-            }
-        }
-        if (curr->iconNumber() != compare->iconNumber() || curr->iconUuid() != compare->iconUuid()) {
-            modifiedFields << tr("Icon");
-        }
-        if (curr->foregroundColor() != compare->foregroundColor()
-            || curr->backgroundColor() != compare->backgroundColor()) {
-            modifiedFields << tr("Color");
+    if (*curr->attributes() != *compare->attributes()) {
+        if (curr->title() != compare->title()) {
+            fields |= ModifiedField::Title;
         }
-        if (curr->timeInfo().expires() != compare->timeInfo().expires()
-            || curr->timeInfo().expiryTime() != compare->timeInfo().expiryTime()) {
-            modifiedFields << tr("Expiration");
+        if (curr->username() != compare->username()) {
+            fields |= ModifiedField::Username;
         }
-        if (curr->totp() != compare->totp()) {
-            modifiedFields << tr("TOTP");
+        if (curr->password() != compare->password()) {
+            fields |= ModifiedField::Password;
         }
-        if (*curr->customData() != *compare->customData()) {
-            modifiedFields << tr("Custom Data");
+        if (curr->url() != compare->url()) {
+            fields |= ModifiedField::Url;
         }
-        if (*curr->attachments() != *compare->attachments()) {
-            modifiedFields << tr("Attachments");
+        if (curr->notes() != compare->notes()) {
+            fields |= ModifiedField::Notes;
         }
-        if (*curr->autoTypeAssociations() != *compare->autoTypeAssociations()
-            || curr->autoTypeEnabled() != compare->autoTypeEnabled()
-            || curr->defaultAutoTypeSequence() != compare->defaultAutoTypeSequence()) {
-            modifiedFields << tr("Auto-Type");
-        }
-        if (curr->tags() != compare->tags()) {
-            modifiedFields << tr("Tags");
+        if (fields == 0) {
+            fields |= ModifiedField::CustomAttributes;
         }
+    }
+    if (curr->iconNumber() != compare->iconNumber() || curr->iconUuid() != compare->iconUuid()) {
+        fields |= ModifiedField::Icon;
+    }
+    if (curr->foregroundColor() != compare->foregroundColor()
+        || curr->backgroundColor() != compare->backgroundColor()) {
+        fields |= ModifiedField::Color;
+    }
+    if (curr->timeInfo().expires() != compare->timeInfo().expires()
+        || curr->timeInfo().expiryTime() != compare->timeInfo().expiryTime()) {
+        fields |= ModifiedField::Expiration;
+    }
+    // Compare the settings, generating the codes is much slower
+    if (Totp::writeSettings(curr->totpSettings(), {}, {}, true)
+        != Totp::writeSettings(compare->totpSettings(), {}, {}, true)) {
+        fields |= ModifiedField::Totp;
+    }
+    if (*curr->customData() != *compare->customData()) {
+        fields |= ModifiedField::CustomData;
+    }
+    if (*curr->attachments() != *compare->attachments()) {
+        fields |= ModifiedField::Attachments;
+    }
+    if (*curr->autoTypeAssociations() != *compare->autoTypeAssociations()
+        || curr->autoTypeEnabled() != compare->autoTypeEnabled()
+        || curr->defaultAutoTypeSequence() != compare->defaultAutoTypeSequence()) {
+        fields |= ModifiedField::AutoType;
+    }
+    if (curr->tags() != compare->tags()) {
+        fields |= ModifiedField::Tags;
+    }
 
-        m_historyModifications << modifiedFields.join(", ");
+    m_modifiedFields[row] = fields;
+    return fields;
+}
 
-        compare = curr;
+QString EntryHistoryModel::modificationsText(int fields) const
+{
+    QStringList modifiedFields;
+    if (fields & ModifiedField::Title) {
+        modifiedFields << tr("Title");
+    }
+    if (fields & ModifiedField::Username) {
+        modifiedFields << tr("Username");
+    }
+    if (fields & ModifiedField::Password) {
+        modifiedFields << tr("Password");
+    }
+    if (fields & ModifiedField::Url) {
+        modifiedFields << tr("URL");
+    }
+    if (fields & ModifiedField::Notes) {
+        modifiedFields << tr("Notes");
+    }
+    if (fields & ModifiedField::CustomAttributes) {
+        modifiedFields << tr("Custom Attributes");
+    }
+    if (fields & ModifiedField::Icon) {
+        modifiedFields << tr("Icon");
+    }
+    if (fields & ModifiedField::Color) {
+        modifiedFields << tr("Color");
+    }
+    if (fields & ModifiedField::Expiration) {
+        modifiedFields << tr("Expiration");
+    }
+    if (fields & ModifiedField::Totp) {
+        modifiedFields << tr("TOTP");
+    }
+    if (fields & ModifiedField::CustomData) {
+        modifiedFields << tr("Custom Data");
+    }
+    if (fields & ModifiedField::Attachments) {
+        modifiedFields << tr("Attachments");
+    }
+    if (fields & ModifiedField::AutoType) {
+        modifiedFields << tr("Auto-Type");
+    }
+    if (fields & ModifiedField::Tags) {
+        modifiedFields << tr("Tags");
     }
+    return modifiedFields.join(", ");
 }
@@ -19,6 +19,7 @@
 #define KEEPASSX_ENTRYHISTORYMODEL_H
 
 #include <QAbstractTableModel>
+#include <QVector>
 
 class Entry;
 
@@ -43,11 +44,15 @@ public:
     void deleteAll();
 
 private:
-    void calculateHistoryModifications();
+    int entrySize(int row) const;
+    int modifiedFields(int row) const;
+    QString modificationsText(int fields) const;
 
     QList<Entry*> m_historyEntries;
     QList<Entry*> m_deletedHistoryEntries;
-    QStringList m_historyModifications;
+    // Per row, computed on first use
+    mutable QVector<int> m_modifiedFields;
+    mutable QVector<int> m_sizes;
     const Entry* m_parentEntry;
 };
 
@@ -21,6 +21,7 @@
 #include <QMimeData>
 #include <QPalette>
 
+#include "core/Database.h"
 #include "core/Entry.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
@@ -34,11 +35,14 @@
 
 EntryModel::EntryModel(QObject* parent)
     : QAbstractTableModel(parent)
-    , m_group(nullptr)
     , HiddenContentDisplay(QString("\u25cf").repeated(6))
     , DateFormat(Qt::DefaultLocaleShortDate)
 {
     connect(config(), &Config::changed, this, &EntryModel::onConfigChanged);
+
+    m_populateTimer.setSingleShot(true);
+    m_populateTimer.setInterval(0);
+    connect(&m_populateTimer, &QTimer::timeout, this, &EntryModel::populateNextBatch);
 }
 
 Entry* EntryModel::entryFromIndex(const QModelIndex& index) const
@@ -62,42 +66,127 @@ void EntryModel::setGroup(Group* group)
         return;
     }
 
-    beginResetModel();
+    // Complete a reset started by a running batch update instead of starting another one
+    if (m_batchReset) {
+        m_batchReset = false;
+    } else {
+        beginResetModel();
+    }
 
     severConnections();
 
     m_group = group;
-    m_allGroups.clear();
     m_entries = group->entries();
     m_orgEntries.clear();
+    m_pendingEntries.clear();
+    m_populateTimer.stop();
 
     makeConnections(group);
 
     endResetModel();
 }
 
+/**
+ * Show a list of entries, e.g. search results.
+ *
+ * Only the first PopulateBatchSize entries are shown right away, the
+ * remaining ones are added in batches from the event loop so that the
+ * view is usable immediately even for very long lists.
+ */
 void EntryModel::setEntries(const QList<Entry*>& entries)
 {
-    beginResetModel();
+    // Complete a reset started by a running batch update instead of starting another one
+    if (m_batchReset) {
+        m_batchReset = false;
+    } else {
+        beginResetModel();
+    }
 
     severConnections();
 
     m_group = nullptr;
-    m_allGroups.clear();
-    m_entries = entries;
-    m_orgEntries = entries;
+    m_entries = entries.mid(0, PopulateBatchSize);
+    m_pendingEntries = entries.mid(PopulateBatchSize);
+    m_orgEntries.clear();
+    m_orgEntries.reserve(entries.size());
+
+    Database* lastDb = nullptr;
+    for (const auto entry : entries) {
+        m_orgEntries.insert(entry);
+        // Lists usually hold the entries of a single database
+        auto db = entry->group() ? entry->group()->database() : nullptr;
+        if (db && db != lastDb && !m_allDatabases.contains(db)) {
+            makeConnections(db);
+        }
+        lastDb = db;
+    }
+
+    endResetModel();
 
-    for (const auto entry : asConst(m_entries)) {
-        if (entry->group()) {
-            m_allGroups.insert(entry->group());
+    if (m_pendingEntries.isEmpty()) {
+        m_populateTimer.stop();
+    } else {
+        m_populateTimer.start();
+    }
+}
+
+/**
+ * Append entries to a list set with setEntries(), e.g. when search
+ * results arrive in chunks.
+ */
+void EntryModel::appendEntries(const QList<Entry*>& entries)
+{
+    Q_ASSERT(!m_group);
+    if (m_group || entries.isEmpty()) {
+        return;
+    }
+
+    for (const auto entry : entries) {
+        m_orgEntries.insert(entry);
+        auto db = entry->group() ? entry->group()->database() : nullptr;
+        if (db && !m_allDatabases.contains(db)) {
+            makeConnections(db);
         }
     }
 
-    for (const auto group : m_allGroups) {
-        makeConnections(group);
+    // Keep the order of the list if earlier entries are not shown yet
+    if (!m_pendingEntries.isEmpty() || entries.size() > PopulateBatchSize) {
+        m_pendingEntries.append(entries);
+        if (!m_populateTimer.isActive()) {
+            m_populateTimer.start();
+        }
+        return;
     }
 
-    endResetModel();
+    insertEntries(entries);
+}
+
+void EntryModel::populateNextBatch()
+{
+    if (m_group || m_pendingEntries.isEmpty()) {
+        return;
+    }
+
+    const auto batch = m_pendingEntries.mid(0, PopulateBatchSize);
+    m_pendingEntries.erase(m_pendingEntries.begin(), m_pendingEntries.begin() + batch.size());
+    insertEntries(batch);
+
+    if (!m_pendingEntries.isEmpty()) {
+        m_populateTimer.start();
+    }
+}
+
+void EntryModel::insertEntries(const QList<Entry*>& entries)
+{
+    // A pending batch reset already covers the new rows
+    const bool notify = !m_batchReset;
+    if (notify) {
+        beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size() + entries.size() - 1);
+    }
+    m_entries.append(entries);
+    if (notify) {
+        endInsertRows();
+    }
 }
 
 int EntryModel::rowCount(const QModelIndex& parent) const
@@ -507,6 +596,13 @@ void EntryModel::entryAboutToAdd(Entry* entry)
         return;
     }
 
+    if (deferToBatchReset()) {
+        if (!m_group) {
+            m_entries.append(entry);
+        }
+        return;
+    }
+
     beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size());
     if (!m_group) {
         m_entries.append(entry);
@@ -519,6 +615,10 @@ void EntryModel::entryAdded(Entry* entry)
         return;
     }
 
+    if (m_batchReset) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -527,14 +627,41 @@ void EntryModel::entryAdded(Entry* entry)
 
 void EntryModel::entryAboutToRemove(Entry* entry)
 {
-    beginRemoveRows(QModelIndex(), m_entries.indexOf(entry), m_entries.indexOf(entry));
     if (!m_group) {
-        m_entries.removeAll(entry);
+        if (!m_orgEntries.contains(entry)) {
+            return;
+        }
+        if (m_pendingEntries.removeOne(entry)) {
+            return;
+        }
+    }
+
+    if (deferToBatchReset()) {
+        if (!m_group) {
+            m_entries.removeAll(entry);
+        }
+        return;
+    }
+
+    const int row = m_entries.indexOf(entry);
+    if (row < 0) {
+        return;
+    }
+
+    m_removingEntry = true;
+    beginRemoveRows(QModelIndex(), row, row);
+    if (!m_group) {
+        m_entries.removeAt(row);
     }
 }
 
 void EntryModel::entryRemoved()
 {
+    if (m_batchReset || !m_removingEntry) {
+        return;
+    }
+
+    m_removingEntry = false;
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -543,6 +670,10 @@ void EntryModel::entryRemoved()
 
 void EntryModel::entryAboutToMoveUp(int row)
 {
+    if (deferToBatchReset()) {
+        return;
+    }
+
     beginMoveRows(QModelIndex(), row, row, QModelIndex(), row - 1);
     if (m_group) {
         m_entries.move(row, row - 1);
@@ -551,6 +682,10 @@ void EntryModel::entryAboutToMoveUp(int row)
 
 void EntryModel::entryMovedUp()
 {
+    if (m_batchReset) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -559,6 +694,10 @@ void EntryModel::entryMovedUp()
 
 void EntryModel::entryAboutToMoveDown(int row)
 {
+    if (deferToBatchReset()) {
+        return;
+    }
+
     beginMoveRows(QModelIndex(), row, row, QModelIndex(), row + 2);
     if (m_group) {
         m_entries.move(row, row + 1);
@@ -567,6 +706,10 @@ void EntryModel::entryAboutToMoveDown(int row)
 
 void EntryModel::entryMovedDown()
 {
+    if (m_batchReset) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -575,10 +718,63 @@ void EntryModel::entryMovedDown()
 
 void EntryModel::entryDataChanged(Entry* entry)
 {
+    if (!m_group && !m_orgEntries.contains(entry)) {
+        return;
+    }
+
+    if (deferToBatchReset()) {
+        return;
+    }
+
     int row = m_entries.indexOf(entry);
+    if (row < 0) {
+        return;
+    }
     emit dataChanged(index(row, 0), index(row, columnCount() - 1));
 }
 
+void EntryModel::batchUpdateStarted()
+{
+    m_batchUpdating = true;
+}
+
+void EntryModel::batchUpdateFinished()
+{
+    m_batchUpdating = false;
+    finishBatchReset();
+}
+
+/**
+ * During a database batch update the first change to the shown entries starts a model
+ * reset, all further per entry notifications are skipped until the batch is finished.
+ */
+bool EntryModel::deferToBatchReset()
+{
+    if (!m_batchUpdating) {
+        return false;
+    }
+
+    if (!m_batchReset) {
+        m_batchReset = true;
+        m_batchShowsGroup = !m_group.isNull();
+        beginResetModel();
+    }
+    return true;
+}
+
+void EntryModel::finishBatchReset()
+{
+    if (!m_batchReset) {
+        return;
+    }
+
+    m_batchReset = false;
+    if (m_batchShowsGroup) {
+        m_entries = m_group ? m_group->entries() : QList<Entry*>();
+    }
+    endResetModel();
+}
+
 void EntryModel::onConfigChanged(Config::ConfigKey key)
 {
     switch (key) {
@@ -598,10 +794,19 @@ void EntryModel::severConnections()
     if (m_group) {
         disconnect(m_group, nullptr, this, nullptr);
     }
+    if (m_groupDatabase) {
+        disconnect(m_groupDatabase, nullptr, this, nullptr);
+    }
+    m_groupDatabase = nullptr;
 
-    for (const Group* group : asConst(m_allGroups)) {
-        disconnect(group, nullptr, this, nullptr);
+    for (const auto& db : asConst(m_allDatabases)) {
+        if (db) {
+            disconnect(db, nullptr, this, nullptr);
+        }
     }
+    m_allDatabases.clear();
+    m_removingEntry = false;
+    m_batchUpdating = false;
 }
 
 void EntryModel::makeConnections(const Group* group)
@@ -615,7 +820,38 @@ void EntryModel::makeConnections(const Group* group)
     connect(group, SIGNAL(entryAboutToMoveDown(int)), SLOT(entryAboutToMoveDown(int)));
     connect(group, SIGNAL(entryMovedDown()), SLOT(entryMovedDown()));
     connect(group, SIGNAL(entryDataChanged(Entry*)), SLOT(entryDataChanged(Entry*)));
+
+    auto db = group->database();
+    if (db) {
+        connectBatchUpdates(db);
+        m_groupDatabase = db;
+    }
+}
+
+/**
+ * Follow the entries of a list through a single connection to their database
+ * instead of connecting to every group they are in. Moving entries within
+ * their group doesn't change the order of a list.
+ */
+void EntryModel::makeConnections(Database* db)
+{
+    connect(db, SIGNAL(entryAboutToAdd(Entry*)), SLOT(entryAboutToAdd(Entry*)));
+    connect(db, SIGNAL(entryAdded(Entry*)), SLOT(entryAdded(Entry*)));
+    connect(db, SIGNAL(entryAboutToRemove(Entry*)), SLOT(entryAboutToRemove(Entry*)));
+    connect(db, SIGNAL(entryRemoved(Entry*)), SLOT(entryRemoved()));
+    connect(db, SIGNAL(entryDataChanged(Entry*)), SLOT(entryDataChanged(Entry*)));
+
+    connectBatchUpdates(db);
+    m_allDatabases.append(db);
 }
+
+void EntryModel::connectBatchUpdates(const Database* db)
+{
+    connect(db, SIGNAL(batchUpdateStarted()), SLOT(batchUpdateStarted()), Qt::UniqueConnection);
+    connect(db, SIGNAL(batchUpdateFinished()), SLOT(batchUpdateFinished()), Qt::UniqueConnection);
+    m_batchUpdating = db->isBatchUpdating();
+}
+
 void EntryModel::setBackgroundColorVisible(bool visible)
 {
     m_backgroundColorVisible = visible;
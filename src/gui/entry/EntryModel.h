@@ -20,10 +20,13 @@
 
 #include <QAbstractTableModel>
 #include <QPixmap>
+#include <QPointer>
 #include <QSet>
+#include <QTimer>
 
 #include "core/Config.h"
 
+class Database;
 class Entry;
 class Group;
 
@@ -52,6 +55,9 @@ public:
         Color = 15
     };
 
+    // Number of rows added at a time when a list of entries is shown
+    static constexpr int PopulateBatchSize = 1000;
+
     explicit EntryModel(QObject* parent = nullptr);
     Entry* entryFromIndex(const QModelIndex& index) const;
     QModelIndex indexFromEntry(Entry* entry) const;
@@ -68,6 +74,7 @@ public:
 
     void setGroup(Group* group);
     void setEntries(const QList<Entry*>& entries);
+    void appendEntries(const QList<Entry*>& entries);
     void setBackgroundColorVisible(bool visible);
 
 private slots:
@@ -75,23 +82,41 @@ private slots:
     void entryAdded(Entry* entry);
     void entryAboutToRemove(Entry* entry);
     void entryRemoved();
+    void populateNextBatch();
     void entryAboutToMoveUp(int row);
     void entryMovedUp();
     void entryAboutToMoveDown(int row);
     void entryMovedDown();
     void entryDataChanged(Entry* entry);
+    void batchUpdateStarted();
+    void batchUpdateFinished();
 
     void onConfigChanged(Config::ConfigKey key);
 
 private:
     void severConnections();
     void makeConnections(const Group* group);
+    void makeConnections(Database* db);
+    void connectBatchUpdates(const Database* db);
+    void insertEntries(const QList<Entry*>& entries);
+    bool deferToBatchReset();
+    void finishBatchReset();
 
     bool m_backgroundColorVisible = true;
-    Group* m_group;
+    QPointer<Group> m_group;
     QList<Entry*> m_entries;
-    QList<Entry*> m_orgEntries;
-    QSet<const Group*> m_allGroups;
+    QSet<const Entry*> m_orgEntries;
+    // Entries of the list that are not shown yet, see populateNextBatch()
+    QList<Entry*> m_pendingEntries;
+    QTimer m_populateTimer;
+    QList<QPointer<Database>> m_allDatabases;
+    bool m_removingEntry = false;
+    bool m_batchUpdating = false;
+    bool m_batchReset = false;
+    // Whether a group was shown when the pending batch reset started, it may be deleted since
+    bool m_batchShowsGroup = false;
+    // Database of the shown group, connected for its batch updates
+    QPointer<const Database> m_groupDatabase;
 
     const QString HiddenContentDisplay;
     const Qt::DateFormat DateFormat;
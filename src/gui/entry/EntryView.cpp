@@ -228,6 +228,19 @@ void EntryView::displaySearch(const QList<Entry*>& entries)
     m_inSearchMode = true;
 }
 
+/**
+ * Add more results to the search currently displayed.
+ */
+void EntryView::appendSearch(const QList<Entry*>& entries)
+{
+    Q_ASSERT(m_inSearchMode);
+    const bool hadEntries = m_model->rowCount() > 0;
+    m_model->appendEntries(entries);
+    if (!hadEntries) {
+        setFirstEntryActive();
+    }
+}
+
 void EntryView::setFirstEntryActive()
 {
     if (m_model->rowCount() > 0) {
@@ -39,6 +39,7 @@ void GroupModel::changeDatabase(Database* newDb)
     beginResetModel();
 
     m_db = newDb;
+    m_rows.clear();
 
     // clang-format off
     connect(m_db, SIGNAL(groupDataChanged(Group*)), SLOT(groupDataChanged(Group*)));
@@ -110,7 +111,7 @@ QModelIndex GroupModel::parent(Group* group) const
             // parent is the root group
             return createIndex(0, 0, parentGroup);
         } else {
-            return createIndex(grandParentGroup->children().indexOf(parentGroup), 0, parentGroup);
+            return createIndex(row(parentGroup), 0, parentGroup);
         }
     }
 }
@@ -160,15 +161,34 @@ QVariant GroupModel::headerData(int section, Qt::Orientation orientation, int ro
 
 QModelIndex GroupModel::index(Group* group) const
 {
-    int row;
+    return createIndex(row(group), 0, group);
+}
 
-    if (!group->parentGroup()) {
-        row = 0;
-    } else {
-        row = group->parentGroup()->children().indexOf(group);
+/**
+ * Get the row of a group within its parent.
+ *
+ * Rows are cached for all children of a parent at once, so looking up
+ * every group of the tree takes linear time instead of one linear search
+ * per group.
+ */
+int GroupModel::row(const Group* group) const
+{
+    const Group* parentGroup = group->parentGroup();
+    if (!parentGroup) {
+        return 0;
+    }
+
+    const QList<Group*>& children = parentGroup->children();
+    const int cachedRow = m_rows.value(group, -1);
+    // Verify the cached row in case the children were reordered behind our back
+    if (cachedRow >= 0 && cachedRow < children.size() && children.at(cachedRow) == group) {
+        return cachedRow;
     }
 
-    return createIndex(row, 0, group);
+    for (int i = 0; i < children.size(); ++i) {
+        m_rows.insert(children.at(i), i);
+    }
+    return m_rows.value(group, -1);
 }
 
 Group* GroupModel::groupFromIndex(const QModelIndex& index) const
@@ -277,6 +297,7 @@ bool GroupModel::dropMimeData(const QMimeData* data,
             return false;
         }
 
+        Database::BatchUpdate batch(parentGroup->database());
         while (!stream.atEnd()) {
             QUuid dbUuid;
             QUuid entryUuid;
@@ -374,7 +395,7 @@ void GroupModel::groupAboutToRemove(Group* group)
 
     QModelIndex parentIndex = parent(group);
     Q_ASSERT(parentIndex.isValid());
-    int pos = group->parentGroup()->children().indexOf(group);
+    int pos = row(group);
     Q_ASSERT(pos != -1);
 
     beginRemoveRows(parentIndex, pos, pos);
@@ -382,6 +403,7 @@ void GroupModel::groupAboutToRemove(Group* group)
 
 void GroupModel::groupRemoved()
 {
+    m_rows.clear();
     endRemoveRows();
 }
 
@@ -396,6 +418,7 @@ void GroupModel::groupAboutToAdd(Group* group, int index)
 
 void GroupModel::groupAdded()
 {
+    m_rows.clear();
     endInsertRows();
 }
 
@@ -405,7 +428,7 @@ void GroupModel::groupAboutToMove(Group* group, Group* toGroup, int pos)
 
     QModelIndex oldParentIndex = parent(group);
     QModelIndex newParentIndex = index(toGroup);
-    int oldPos = group->parentGroup()->children().indexOf(group);
+    int oldPos = row(group);
     if (group->parentGroup() == toGroup && pos > oldPos) {
         // beginMoveRows() has a bit different semantics than Group::setParent() and
         // QList::move() when the new position is greater than the old
@@ -419,6 +442,7 @@ void GroupModel::groupAboutToMove(Group* group, Group* toGroup, int pos)
 
 void GroupModel::groupMoved()
 {
+    m_rows.clear();
     endMoveRows();
 }
 
@@ -430,6 +454,7 @@ void GroupModel::sortChildren(Group* rootGroup, bool reverse)
     collectIndexesRecursively(oldIndexes, rootGroup->children());
 
     rootGroup->sortChildrenRecursively(reverse);
+    m_rows.clear();
 
     QList<QModelIndex> newIndexes;
     collectIndexesRecursively(newIndexes, rootGroup->children());
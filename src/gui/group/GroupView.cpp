@@ -117,13 +117,22 @@ void GroupView::expandedChanged(const QModelIndex& index)
 
 void GroupView::recInitExpanded(Group* group)
 {
+    // With a layout pending, expanding only records the state and the tree
+    // is laid out once afterwards instead of after every expanded group
+    scheduleDelayedItemsLayout();
+
     m_updatingExpanded = true;
-    expandGroup(group, group->isExpanded());
+    recInitExpanded(m_model->index(group));
     m_updatingExpanded = false;
+}
+
+void GroupView::recInitExpanded(const QModelIndex& index)
+{
+    setExpanded(index, m_model->groupFromIndex(index)->isExpanded());
 
-    const QList<Group*> children = group->children();
-    for (Group* child : children) {
-        recInitExpanded(child);
+    const int rows = m_model->rowCount(index);
+    for (int row = 0; row < rows; ++row) {
+        recInitExpanded(m_model->index(row, 0, index));
     }
 }
 
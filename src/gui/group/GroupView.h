@@ -53,6 +53,7 @@ protected:
 
 private:
     void recInitExpanded(Group* group);
+    void recInitExpanded(const QModelIndex& index);
 
     GroupModel* const m_model;
     bool m_updatingExpanded;
@@ -26,6 +26,7 @@
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSet>
 
 void PasskeyExporter::showExportDialog(const QList<Entry*>& items)
 {
@@ -45,9 +46,49 @@ void PasskeyExporter::showExportDialog(const QList<Entry*>& items)
         }
 
         const auto selectedItems = passkeyExportDialog.getSelectedItems();
+        QList<QPair<const Entry*, QString>> exports;
+        QStringList existingFiles;
+        QSet<QString> usedNames;
         for (const auto& item : selectedItems) {
-            auto entry = items[item->row()];
-            exportSelectedEntry(entry, folder);
+            const auto* entry = items[item->row()];
+            // Entries sharing a title must not overwrite each other's file
+            const auto baseName = Tools::cleanFilename(entry->title());
+            auto fileName = QString("%1.passkey").arg(baseName);
+            for (int i = 2; usedNames.contains(fileName); ++i) {
+                fileName = QString("%1 (%2).passkey").arg(baseName).arg(i);
+            }
+            usedNames.insert(fileName);
+            const auto fullPath = QString("%1/%2").arg(folder, fileName);
+            if (QFile::exists(fullPath)) {
+                existingFiles << fileName;
+            }
+            exports.append({entry, fullPath});
+        }
+
+        // Ask once for all files that would be overwritten
+        if (!existingFiles.isEmpty()) {
+            auto dialogResult = MessageBox::warning(nullptr,
+                                                    tr("KeePassXC: Passkey Export"),
+                                                    tr("The following files already exist:\n%1\n\n"
+                                                       "Do you want to overwrite them?\n")
+                                                        .arg(existingFiles.join("\n")),
+                                                    MessageBox::Yes | MessageBox::No);
+
+            if (dialogResult != MessageBox::Yes) {
+                return;
+            }
+        }
+
+        QStringList errors;
+        for (const auto& exportItem : exports) {
+            QString error;
+            if (!exportSelectedEntry(exportItem.first, exportItem.second, error)) {
+                errors << error;
+            }
+        }
+
+        if (!errors.isEmpty()) {
+            MessageBox::information(nullptr, tr("Passkey Export"), errors.join("\n"));
         }
     }
 }
@@ -65,27 +106,12 @@ void PasskeyExporter::showExportDialog(const QList<Entry*>& items)
  *      "username:" <username>
  * }
  */
-void PasskeyExporter::exportSelectedEntry(const Entry* entry, const QString& folder)
+bool PasskeyExporter::exportSelectedEntry(const Entry* entry, const QString& fullPath, QString& error)
 {
-    const auto fullPath = QString("%1/%2.passkey").arg(folder, Tools::cleanFilename(entry->title()));
-    if (QFile::exists(fullPath)) {
-        auto dialogResult = MessageBox::warning(nullptr,
-                                                tr("KeePassXC: Passkey Export"),
-                                                tr("File \"%1.passkey\" already exists.\n"
-                                                   "Do you want to overwrite it?\n")
-                                                    .arg(entry->title()),
-                                                MessageBox::Yes | MessageBox::No);
-
-        if (dialogResult != MessageBox::Yes) {
-            return;
-        }
-    }
-
     QFile passkeyFile(fullPath);
     if (!passkeyFile.open(QIODevice::WriteOnly)) {
-        MessageBox::information(
-            nullptr, tr("Cannot open file"), tr("Cannot open file \"%1\" for writing.").arg(fullPath));
-        return;
+        error = tr("Cannot open file \"%1\" for writing.").arg(fullPath);
+        return false;
     }
 
     QJsonObject passkeyObject;
@@ -98,9 +124,9 @@ void PasskeyExporter::exportSelectedEntry(const Entry* entry, const QString& fol
 
     QJsonDocument document(passkeyObject);
     if (passkeyFile.write(document.toJson()) < 0) {
-        MessageBox::information(
-            nullptr, tr("Cannot write to file"), tr("Cannot open file \"%1\" for writing.").arg(fullPath));
+        error = tr("Cannot write to file \"%1\".").arg(fullPath);
+        return false;
     }
 
-    passkeyFile.close();
+    return true;
 }
@@ -20,6 +20,7 @@
 
 #include <QList>
 #include <QObject>
+#include <QStringList>
 
 class Entry;
 
@@ -33,7 +34,7 @@ public:
     void showExportDialog(const QList<Entry*>& items);
 
 private:
-    void exportSelectedEntry(const Entry* entry, const QString& folder);
+    bool exportSelectedEntry(const Entry* entry, const QString& fullPath, QString& error);
 };
 
 #endif // KEEPASSXC_PASSKEYEXPORTER_H
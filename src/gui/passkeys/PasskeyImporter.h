@@ -33,8 +33,20 @@ public:
     explicit PasskeyImporter() = default;
 
     void importPasskey(QSharedPointer<Database>& database, Entry* entry = nullptr);
+    void importPasskeyFolder(QSharedPointer<Database>& database);
 
 private:
+    struct Passkey
+    {
+        QString relyingParty;
+        QString url;
+        QString username;
+        QString credentialId;
+        QString userHandle;
+        QString privateKey;
+    };
+
+    bool readPasskeyFile(QFile& file, Passkey& passkey, QString& error) const;
     void importSelectedFile(QFile& file, QSharedPointer<Database>& database, Entry* entry);
     void showImportDialog(QSharedPointer<Database>& database,
                           const QString& url,
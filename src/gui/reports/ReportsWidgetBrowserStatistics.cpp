@@ -18,7 +18,7 @@
 #include "ReportsWidgetBrowserStatistics.h"
 #include "ui_ReportsWidgetBrowserStatistics.h"
 
-#include "browser/BrowserService.h"
+#include "browser/BrowserEntryConfig.h"
 #include "core/AsyncTask.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
@@ -26,52 +26,17 @@
 #include "gui/Icons.h"
 #include "gui/styles/StateColorPalette.h"
 
-#include <QJsonDocument>
-#include <QJsonObject>
 #include <QMenu>
 #include <QShortcut>
 #include <QSortFilterProxyModel>
 #include <QStandardItemModel>
 
-namespace
-{
-    class BrowserStatistics
-    {
-    public:
-        struct Item
-        {
-            QPointer<Group> group;
-            QPointer<Entry> entry;
-            bool hasUrls;
-            bool hasSettings;
-            bool exclude = false;
-
-            Item(Group* g, Entry* e, bool hU, bool hS)
-                : group(g)
-                , entry(e)
-                , hasUrls(hU)
-                , hasSettings(hS)
-                , exclude(e->excludeFromReports())
-            {
-            }
-        };
-
-        explicit BrowserStatistics(QSharedPointer<Database>);
-
-        const QList<QSharedPointer<Item>>& items() const
-        {
-            return m_items;
-        }
-
-    private:
-        QSharedPointer<Database> m_db;
-        QList<QSharedPointer<Item>> m_items;
-    };
-} // namespace
-
-BrowserStatistics::BrowserStatistics(QSharedPointer<Database> db)
-    : m_db(db)
+/**
+ * Collect the URLs and the allowed and denied sites of all entries outside the recycle bin.
+ */
+QList<ReportsWidgetBrowserStatistics::Item> ReportsWidgetBrowserStatistics::collectItems(QSharedPointer<Database> db)
 {
+    QList<Item> items;
     for (auto group : db->rootGroup()->groupsRecursive(true)) {
         // Skip recycle bin
         if (group->isRecycled()) {
@@ -83,13 +48,24 @@ BrowserStatistics::BrowserStatistics(QSharedPointer<Database> db)
                 continue;
             }
 
-            auto hasUrls = !entry->getAllUrls().isEmpty();
-            auto hasSettings = entry->customData()->contains(BrowserService::KEEPASSXCBROWSER_NAME);
-
-            const auto item = QSharedPointer<Item>(new Item(group, entry, hasUrls, hasSettings));
-            m_items.append(item);
+            Item item;
+            item.group = group;
+            item.entry = entry;
+            item.urls = entry->getAllUrls();
+
+            // Parsed settings are cached by BrowserEntryConfig
+            BrowserEntryConfig config;
+            item.hasSettings = config.load(entry);
+            if (item.hasSettings) {
+                item.allowedUrls = config.allowedHosts();
+                item.allowedUrls.sort();
+                item.deniedUrls = config.deniedHosts();
+                item.deniedUrls.sort();
+            }
+            items.append(item);
         }
     }
+    return items;
 }
 
 ReportsWidgetBrowserStatistics::ReportsWidgetBrowserStatistics(QWidget* parent)
@@ -122,23 +98,15 @@ ReportsWidgetBrowserStatistics::~ReportsWidgetBrowserStatistics()
 {
 }
 
-void ReportsWidgetBrowserStatistics::addStatisticsRow(bool hasUrls,
-                                                      bool hasSettings,
-                                                      Group* group,
-                                                      Entry* entry,
-                                                      bool excluded)
+void ReportsWidgetBrowserStatistics::addStatisticsRow(const Item& item)
 {
-    StateColorPalette statePalette;
+    auto* group = item.group.data();
+    auto* entry = item.entry.data();
+    const bool excluded = entry->excludeFromReports();
 
-    auto urlList = entry->getAllUrls();
-    auto urlToolTip = hasUrls ? tr("List of entry URLs") : tr("Entry has no URLs set");
-
-    auto browserConfig = getBrowserConfigFromEntry(entry);
-    auto allowedUrlsList = browserConfig["Allow"];
-    auto deniedUrlsList = browserConfig["Deny"];
-
-    auto allowedUrlsToolTip = hasSettings ? tr("Allowed URLs") : tr("Entry has no Browser Integration settings");
-    auto deniedUrlsToolTip = hasSettings ? tr("Denied URLs") : tr("Entry has no Browser Integration settings");
+    auto urlToolTip = !item.urls.isEmpty() ? tr("List of entry URLs") : tr("Entry has no URLs set");
+    auto allowedUrlsToolTip = item.hasSettings ? tr("Allowed URLs") : tr("Entry has no Browser Integration settings");
+    auto deniedUrlsToolTip = item.hasSettings ? tr("Denied URLs") : tr("Entry has no Browser Integration settings");
 
     auto title = entry->title();
     if (excluded) {
@@ -151,9 +119,9 @@ void ReportsWidgetBrowserStatistics::addStatisticsRow(bool hasUrls,
     auto row = QList<QStandardItem*>();
     row << new QStandardItem(Icons::entryIconPixmap(entry), title);
     row << new QStandardItem(Icons::groupIconPixmap(group), group->hierarchy().join("/"));
-    row << new QStandardItem(urlList.join('\n'));
-    row << new QStandardItem(allowedUrlsList.join('\n'));
-    row << new QStandardItem(deniedUrlsList.join('\n'));
+    row << new QStandardItem(item.urls.join('\n'));
+    row << new QStandardItem(item.allowedUrls.join('\n'));
+    row << new QStandardItem(item.deniedUrls.join('\n'));
 
     // Set tooltips
     row[2]->setToolTip(urlToolTip);
@@ -172,6 +140,8 @@ void ReportsWidgetBrowserStatistics::loadSettings(QSharedPointer<Database> db)
 {
     m_db = std::move(db);
     m_statisticsCalculated = false;
+    m_itemsValid = false;
+    m_items.clear();
     m_referencesModel->clear();
     m_rowToEntry.clear();
 
@@ -195,9 +165,13 @@ void ReportsWidgetBrowserStatistics::calculateBrowserStatistics()
 {
     m_referencesModel->clear();
 
-    // Perform the statistics check
-    const QScopedPointer<BrowserStatistics> browserStatistics(
-        AsyncTask::runAndWaitForFuture([this] { return new BrowserStatistics(m_db); }));
+    // Only collect the entries again if the database changed, toggling the filters just redisplays them
+    if (!m_itemsValid || m_itemsRevision != m_db->contentRevision()) {
+        m_itemsRevision = m_db->contentRevision();
+        m_items = AsyncTask::runAndWaitForFuture([db = m_db] { return collectItems(db); },
+                                                 AsyncTask::Priority::Visible);
+        m_itemsValid = true;
+    }
 
     const auto showExpired = m_ui->showExpired->isChecked();
     const auto showEntriesWithUrlOnly = m_ui->showEntriesWithUrlOnlyCheckBox->isChecked();
@@ -205,25 +179,28 @@ void ReportsWidgetBrowserStatistics::calculateBrowserStatistics()
 
     // Display the entries
     m_rowToEntry.clear();
-    for (const auto& item : browserStatistics->items()) {
+    for (const auto& item : asConst(m_items)) {
+        if (!item.group || !item.entry) {
+            continue;
+        }
+
         // Check if the entry should be displayed
-        if (!showExpired && item->entry->isExpired()) {
+        if (!showExpired && item.entry->isExpired()) {
             continue;
         }
 
         // Exclude this entry if URL are not set
-        if (showEntriesWithUrlOnly && !item->hasUrls) {
+        if (showEntriesWithUrlOnly && item.urls.isEmpty()) {
             continue;
         }
 
         // Exclude this entry if it doesn't have any Browser Integration settings
-        if (showOnlyEntriesWithSettings
-            && !item->entry->customData()->contains(BrowserService::KEEPASSXCBROWSER_NAME)) {
+        if (showOnlyEntriesWithSettings && !item.hasSettings) {
             continue;
         }
 
         // Show the entry in the report
-        addStatisticsRow(item->hasUrls, item->hasSettings, item->group, item->entry, item->exclude);
+        addStatisticsRow(item);
     }
 
     // Set the table header
@@ -336,39 +313,3 @@ void ReportsWidgetBrowserStatistics::deleteSelectedEntries()
 
     calculateBrowserStatistics();
 }
-
-QMap<QString, QStringList> ReportsWidgetBrowserStatistics::getBrowserConfigFromEntry(Entry* entry) const
-{
-    QMap<QString, QStringList> configList;
-
-    auto config = entry->customData()->value(BrowserService::KEEPASSXCBROWSER_NAME);
-    if (!config.isEmpty()) {
-        QJsonDocument doc = QJsonDocument::fromJson(config.toUtf8());
-        if (!doc.isNull()) {
-            auto jsonObject = doc.object();
-            auto allowedSites = jsonObject["Allow"].toArray();
-            auto deniedSites = jsonObject["Deny"].toArray();
-
-            QStringList allowed;
-            foreach (const auto& value, allowedSites) {
-                auto url = value.toString();
-                if (!url.isEmpty()) {
-                    allowed << url;
-                }
-            }
-
-            QStringList denied;
-            foreach (const auto& value, deniedSites) {
-                auto url = value.toString();
-                if (!url.isEmpty()) {
-                    denied << url;
-                }
-            }
-
-            configList.insert("Allow", allowed);
-            configList.insert("Deny", denied);
-        }
-    }
-
-    return configList;
-}
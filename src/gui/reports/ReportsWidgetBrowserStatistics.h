@@ -19,6 +19,7 @@
 #define KEEPASSXC_REPORTSWIDGETBROWSERSTATISTICS_H
 
 #include "gui/entry/EntryModel.h"
+#include <QPointer>
 #include <QWidget>
 
 class Database;
@@ -56,8 +57,18 @@ public slots:
     void deleteSelectedEntries();
 
 private:
-    void addStatisticsRow(bool hasUrls, bool hasSettings, Group*, Entry*, bool);
-    QMap<QString, QStringList> getBrowserConfigFromEntry(Entry* entry) const;
+    struct Item
+    {
+        QPointer<Group> group;
+        QPointer<Entry> entry;
+        QStringList urls;
+        QStringList allowedUrls;
+        QStringList deniedUrls;
+        bool hasSettings = false;
+    };
+
+    static QList<Item> collectItems(QSharedPointer<Database> db);
+    void addStatisticsRow(const Item& item);
 
     QScopedPointer<Ui::ReportsWidgetBrowserStatistics> m_ui;
 
@@ -66,6 +77,10 @@ private:
     QScopedPointer<QSortFilterProxyModel> m_modelProxy;
     QSharedPointer<Database> m_db;
     QList<QPair<Group*, Entry*>> m_rowToEntry;
+    // Entries of the database as of m_itemsRevision
+    QList<Item> m_items;
+    quint64 m_itemsRevision = 0;
+    bool m_itemsValid = false;
 };
 
 #endif // KEEPASSXC_REPORTSWIDGETBROWSERSTATISTICS_H
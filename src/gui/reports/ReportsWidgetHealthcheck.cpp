@@ -18,7 +18,6 @@
 #include "ReportsWidgetHealthcheck.h"
 #include "ui_ReportsWidgetHealthcheck.h"
 
-#include "core/AsyncTask.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/PasswordHealth.h"
@@ -30,50 +29,46 @@
 #include <QShortcut>
 #include <QSortFilterProxyModel>
 #include <QStandardItemModel>
+#include <QtConcurrent>
 
 namespace
 {
-    class Health
+    QSharedPointer<PasswordHealth> analysePassword(const QString& password)
     {
-    public:
-        struct Item
-        {
-            QPointer<Group> group;
-            QPointer<Entry> entry;
-            QSharedPointer<PasswordHealth> health;
-            bool exclude = false;
-
-            Item(Group* g, Entry* e, QSharedPointer<PasswordHealth> h)
-                : group(g)
-                , entry(e)
-                , health(h)
-                , exclude(e->excludeFromReports())
-            {
-            }
-
-            bool operator<(const Item& rhs) const
-            {
-                return health->score() < rhs.health->score();
-            }
-        };
-
-        explicit Health(QSharedPointer<Database>);
+        return QSharedPointer<PasswordHealth>(new PasswordHealth(password));
+    }
 
-        const QList<QSharedPointer<Item>>& items() const
+    /**
+     * Table cell with the reasons of a health status, whose tooltip lists
+     * the details. These name every entry sharing the password, so they
+     * are only put together once the tooltip is actually shown.
+     */
+    class HealthReasonItem : public QStandardItem
+    {
+    public:
+        HealthReasonItem(const QString& reason, QSharedPointer<HealthChecker> checker, Entry* entry)
+            : QStandardItem(reason)
+            , m_checker(std::move(checker))
+            , m_entry(entry)
         {
-            return m_items;
         }
 
-        bool anyExcludedEntries() const
+        QVariant data(int role) const override
         {
-            return m_anyExcludedEntries;
+            if (role == Qt::ToolTipRole) {
+                if (m_checker && m_entry) {
+                    m_details = m_checker->evaluate(m_entry)->scoreDetails();
+                }
+                m_checker.reset();
+                return m_details;
+            }
+            return QStandardItem::data(role);
         }
 
     private:
-        QSharedPointer<Database> m_db;
-        HealthChecker m_checker;
-        QList<QSharedPointer<Item>> m_items;
-        bool m_anyExcludedEntries = false;
+        mutable QSharedPointer<HealthChecker> m_checker;
+        QPointer<Entry> m_entry;
+        mutable QString m_details;
     };
 
     class ReportSortProxyModel : public QSortFilterProxyModel
@@ -98,44 +93,6 @@ namespace
     };
 } // namespace
 
-Health::Health(QSharedPointer<Database> db)
-    : m_db(db)
-    , m_checker(db)
-{
-    for (auto group : db->rootGroup()->groupsRecursive(true)) {
-        // Skip recycle bin
-        if (group->isRecycled()) {
-            continue;
-        }
-
-        for (auto entry : group->entries()) {
-            if (entry->isRecycled()) {
-                continue;
-            }
-
-            // Skip entries with empty password
-            if (entry->password().isEmpty()) {
-                continue;
-            }
-
-            // Evaluate this entry
-            const auto item = QSharedPointer<Item>(new Item(group, entry, m_checker.evaluate(entry)));
-            if (item->exclude) {
-                m_anyExcludedEntries = true;
-            }
-
-            // Add entry if its password isn't at least "good"
-            if (item->health->quality() < PasswordHealth::Quality::Good) {
-                m_items.append(item);
-            }
-        }
-    }
-
-    // Sort the result so that the worst passwords (least score)
-    // are at the top
-    std::sort(m_items.begin(), m_items.end(), [](QSharedPointer<Item> x, QSharedPointer<Item> y) { return *x < *y; });
-}
-
 ReportsWidgetHealthcheck::ReportsWidgetHealthcheck(QWidget* parent)
     : QWidget(parent)
     , m_ui(new Ui::ReportsWidgetHealthcheck())
@@ -154,11 +111,18 @@ ReportsWidgetHealthcheck::ReportsWidgetHealthcheck(QWidget* parent)
     connect(m_ui->healthcheckTableView, SIGNAL(doubleClicked(QModelIndex)), SLOT(emitEntryActivated(QModelIndex)));
     connect(m_ui->showExcluded, SIGNAL(stateChanged(int)), this, SLOT(calculateHealth()));
     connect(m_ui->showExpired, SIGNAL(stateChanged(int)), this, SLOT(calculateHealth()));
+    connect(&m_healthWatcher, SIGNAL(resultsReadyAt(int, int)), SLOT(addHealthResults(int, int)));
+    connect(&m_healthWatcher, SIGNAL(finished()), SLOT(finishHealthCheck()));
+
+    m_ui->progressBar->hide();
 
     new QShortcut(Qt::Key_Delete, this, SLOT(deleteSelectedEntries()));
 }
 
-ReportsWidgetHealthcheck::~ReportsWidgetHealthcheck() = default;
+ReportsWidgetHealthcheck::~ReportsWidgetHealthcheck()
+{
+    cancelHealthCheck();
+}
 
 void ReportsWidgetHealthcheck::addHealthRow(QSharedPointer<PasswordHealth> health,
                                             Group* group,
@@ -207,7 +171,7 @@ void ReportsWidgetHealthcheck::addHealthRow(QSharedPointer<PasswordHealth> healt
     row << new QStandardItem(Icons::entryIconPixmap(entry), title);
     row << new QStandardItem(Icons::groupIconPixmap(group), group->hierarchy().join("/"));
     row << new QStandardItem(QString::number(health->score()));
-    row << new QStandardItem(health->scoreReason());
+    row << new HealthReasonItem(health->scoreReason(), m_checker, entry);
 
     // Set background color of first column according to password quality.
     // Set the same as foreground color so the description is usually
@@ -221,7 +185,6 @@ void ReportsWidgetHealthcheck::addHealthRow(QSharedPointer<PasswordHealth> healt
     if (excluded) {
         row[1]->setToolTip(tr("This entry is being excluded from reports"));
     }
-    row[4]->setToolTip(health->scoreDetails());
 
     // Store entry pointer per table row (used in double click handler)
     m_referencesModel->appendRow(row);
@@ -230,6 +193,12 @@ void ReportsWidgetHealthcheck::addHealthRow(QSharedPointer<PasswordHealth> healt
 
 void ReportsWidgetHealthcheck::loadSettings(QSharedPointer<Database> db)
 {
+    // Keep the results if nothing changed since they were calculated
+    if (m_healthComplete && db == m_db && db->contentRevision() == m_healthRevision) {
+        return;
+    }
+
+    cancelHealthCheck();
     m_db = std::move(db);
     m_healthCalculated = false;
     m_referencesModel->clear();
@@ -251,40 +220,118 @@ void ReportsWidgetHealthcheck::showEvent(QShowEvent* event)
     }
 }
 
-void ReportsWidgetHealthcheck::calculateHealth()
+void ReportsWidgetHealthcheck::hideEvent(QHideEvent* event)
 {
-    m_referencesModel->clear();
+    QWidget::hideEvent(event);
 
-    // Perform the health check
-    const QScopedPointer<Health> health(AsyncTask::runAndWaitForFuture([this] { return new Health(m_db); }));
+    // Don't keep the thread pool busy for a report nobody looks at
+    if (m_healthWatcher.isRunning()) {
+        cancelHealthCheck();
+        m_healthCalculated = false;
+    }
+}
 
-    // Display the entries
+void ReportsWidgetHealthcheck::calculateHealth()
+{
+    cancelHealthCheck();
+    m_referencesModel->clear();
     m_rowToEntry.clear();
-    for (const auto& item : health->items()) {
-        // Check if the entry should be displayed
-        if ((!m_ui->showExcluded->isChecked() && item->exclude)
-            || (!m_ui->showExpired->isChecked() && item->entry->isExpired())) {
+    m_healthRevision = m_db->contentRevision();
+
+    // Collect the entries to check, grouped by password
+    m_checker.reset(new HealthChecker(m_db));
+    bool anyExcludedEntries = false;
+    for (auto group : m_db->rootGroup()->groupsRecursive(true)) {
+        // Skip recycle bin
+        if (group->isRecycled()) {
             continue;
         }
 
-        // Show the entry in the report
-        addHealthRow(item->health, item->group, item->entry, item->exclude);
+        for (auto entry : group->entries()) {
+            // Skip entries with empty password
+            if (entry->isRecycled() || entry->password().isEmpty()) {
+                continue;
+            }
+
+            const bool excluded = entry->excludeFromReports();
+            anyExcludedEntries |= excluded;
+
+            // Check if the entry should be displayed
+            if ((!m_ui->showExcluded->isChecked() && excluded)
+                || (!m_ui->showExpired->isChecked() && entry->isExpired())) {
+                continue;
+            }
+            m_entriesByPassword[entry->password()].append({group, entry});
+        }
+    }
+    m_passwords = m_entriesByPassword.keys();
+
+    // Only show the "show excluded" checkbox if there are any excluded entries in the database
+    m_ui->showExcluded->setVisible(anyExcludedEntries);
+
+    m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("") << tr("Title") << tr("Path") << tr("Score")
+                                                               << tr("Reason"));
+    // Keep the worst passwords (least score) at the top while rows come in
+    m_ui->healthcheckTableView->sortByColumn(3, Qt::AscendingOrder);
+
+    // Rows are added as the passwords are analysed on the thread pool
+    m_evaluatedPasswords = 0;
+    m_ui->progressBar->setMaximum(m_passwords.size());
+    m_ui->progressBar->setValue(0);
+    m_ui->progressBar->show();
+    m_healthWatcher.setFuture(QtConcurrent::mapped(m_passwords, analysePassword));
+}
+
+void ReportsWidgetHealthcheck::addHealthResults(int begin, int end)
+{
+    for (int i = begin; i < end; ++i) {
+        const auto passwordHealth = m_healthWatcher.resultAt(i);
+        for (const auto& ref : m_entriesByPassword.value(m_passwords.at(i))) {
+            // The entry may have been deleted in the meantime
+            if (!ref.first || !ref.second) {
+                continue;
+            }
+
+            // Add entry if its password isn't at least "good"
+            const auto health = m_checker->evaluate(ref.second, *passwordHealth, HealthChecker::Description::Reasons);
+            if (health->quality() < PasswordHealth::Quality::Good) {
+                addHealthRow(health, ref.first, ref.second, ref.second->excludeFromReports());
+            }
+        }
+    }
+
+    m_evaluatedPasswords += end - begin;
+    m_ui->progressBar->setValue(m_evaluatedPasswords);
+}
+
+void ReportsWidgetHealthcheck::finishHealthCheck()
+{
+    if (m_healthWatcher.isCanceled()) {
+        return;
     }
 
+    m_ui->progressBar->hide();
+    m_entriesByPassword.clear();
+    m_healthComplete = true;
+
     // Set the table header
     if (m_referencesModel->rowCount() == 0) {
         m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("Congratulations, everything is healthy!"));
-    } else {
-        m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("") << tr("Title") << tr("Path") << tr("Score")
-                                                                   << tr("Reason"));
-        m_ui->healthcheckTableView->sortByColumn(0, Qt::AscendingOrder);
     }
 
     m_ui->healthcheckTableView->resizeColumnsToContents();
     m_ui->healthcheckTableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Fixed);
+}
 
-    // Only show the "show excluded" checkbox if there are any excluded entries in the database
-    m_ui->showExcluded->setVisible(health->anyExcludedEntries());
+void ReportsWidgetHealthcheck::cancelHealthCheck()
+{
+    // Passwords already being analysed finish, their results are dropped
+    m_healthWatcher.cancel();
+    m_healthWatcher.setFuture({});
+    m_healthComplete = false;
+    m_entriesByPassword.clear();
+    m_passwords.clear();
+    m_ui->progressBar->hide();
 }
 
 void ReportsWidgetHealthcheck::emitEntryActivated(const QModelIndex& index)
@@ -19,11 +19,14 @@
 #define KEEPASSXC_REPORTSWIDGETHEALTHCHECK_H
 
 #include "gui/entry/EntryModel.h"
+#include <QFutureWatcher>
+#include <QPointer>
 #include <QWidget>
 
 class Database;
 class Entry;
 class Group;
+class HealthChecker;
 class PasswordHealth;
 class QSortFilterProxyModel;
 class QStandardItemModel;
@@ -45,6 +48,7 @@ public:
 
 protected:
     void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
 
 signals:
     void entryActivated(Entry*);
@@ -55,16 +59,31 @@ public slots:
     void customMenuRequested(QPoint);
     void deleteSelectedEntries();
 
+private slots:
+    void addHealthResults(int begin, int end);
+    void finishHealthCheck();
+
 private:
     void addHealthRow(QSharedPointer<PasswordHealth>, Group*, Entry*, bool excluded);
+    void cancelHealthCheck();
 
     QScopedPointer<Ui::ReportsWidgetHealthcheck> m_ui;
 
     bool m_healthCalculated = false;
+    // Content revision of the database the complete results were calculated for
+    quint64 m_healthRevision = 0;
+    bool m_healthComplete = false;
     QScopedPointer<QStandardItemModel> m_referencesModel;
     QScopedPointer<QSortFilterProxyModel> m_modelProxy;
     QSharedPointer<Database> m_db;
     QList<QPair<Group*, Entry*>> m_rowToEntry;
+
+    // Passwords are analysed on the thread pool, each distinct one once
+    QSharedPointer<HealthChecker> m_checker;
+    QFutureWatcher<QSharedPointer<PasswordHealth>> m_healthWatcher;
+    QStringList m_passwords;
+    QHash<QString, QList<QPair<QPointer<Group>, QPointer<Entry>>>> m_entriesByPassword;
+    int m_evaluatedPasswords = 0;
 };
 
 #endif // KEEPASSXC_REPORTSWIDGETHEALTHCHECK_H
@@ -107,6 +107,7 @@ ReportsWidgetPasskeys::ReportsWidgetPasskeys(QWidget* parent)
     connect(m_ui->showExpired, SIGNAL(stateChanged(int)), this, SLOT(updateEntries()));
     connect(m_ui->exportButton, SIGNAL(clicked(bool)), this, SLOT(exportPasskey()));
     connect(m_ui->importButton, SIGNAL(clicked(bool)), this, SLOT(importPasskey()));
+    connect(m_ui->importFolderButton, SIGNAL(clicked(bool)), this, SLOT(importPasskeyFolder()));
 
     m_ui->exportButton->setEnabled(false);
 
@@ -173,7 +174,7 @@ void ReportsWidgetPasskeys::updateEntries()
 
     // Perform the statistics check
     const QScopedPointer<PasskeyList> browserStatistics(
-        AsyncTask::runAndWaitForFuture([this] { return new PasskeyList(m_db); }));
+        AsyncTask::runAndWaitForFuture([this] { return new PasskeyList(m_db); }, AsyncTask::Priority::Visible));
 
     // Display the entries
     m_rowToEntry.clear();
@@ -288,6 +289,14 @@ void ReportsWidgetPasskeys::importPasskey()
     updateEntries();
 }
 
+void ReportsWidgetPasskeys::importPasskeyFolder()
+{
+    PasskeyImporter passkeyImporter;
+    passkeyImporter.importPasskeyFolder(m_db);
+
+    updateEntries();
+}
+
 void ReportsWidgetPasskeys::exportPasskey()
 {
     auto answer = MessageBox::question(this,
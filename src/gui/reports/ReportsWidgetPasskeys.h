@@ -58,6 +58,7 @@ public slots:
 private slots:
     void selectionChanged();
     void importPasskey();
+    void importPasskeyFolder();
     void exportPasskey();
 
 private:
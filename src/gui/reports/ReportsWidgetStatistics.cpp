@@ -19,6 +19,7 @@
 #include "ui_ReportsWidgetStatistics.h"
 
 #include "core/AsyncTask.h"
+#include "core/DatabaseDiagnostics.h"
 #include "core/DatabaseStats.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
@@ -79,8 +80,10 @@ void ReportsWidgetStatistics::showEvent(QShowEvent* event)
 
 void ReportsWidgetStatistics::calculateStats()
 {
+    // The password index is built on first use, do it here rather than in the worker thread
+    m_db->passwordIndex();
     const QScopedPointer<DatabaseStats> stats(
-        AsyncTask::runAndWaitForFuture([this] { return new DatabaseStats(m_db); }));
+        AsyncTask::runAndWaitForFuture([this] { return new DatabaseStats(m_db); }, AsyncTask::Priority::Visible));
 
     m_referencesModel->clear();
     addStatsRow(tr("Database name"), m_db->metadata()->name());
@@ -125,6 +128,17 @@ void ReportsWidgetStatistics::calculateStats()
                 tr("%1 characters").arg(stats->averagePwdLength()),
                 stats->isAvgPwdTooShort(),
                 tr("Average password length is less than ten characters. Longer passwords provide more security."));
+    addStatsRow(tr("Password lengths"),
+                DatabaseStats::formatHistogram(stats->passwordLengthHistogram, DatabaseStats::PasswordLengthBounds));
+    addStatsRow(tr("Days since passwords were modified"),
+                DatabaseStats::formatHistogram(stats->passwordAgeHistogram, DatabaseStats::PasswordAgeBounds));
+    addStatsRow(tr("Reused passwords"), DatabaseStats::formatReuseClusters(stats->reuseClusters));
+
+    // Resource usage, computed here as the indexes and caches belong to this thread
+    const DatabaseDiagnostics diagnostics(m_db);
+    for (const auto& row : diagnostics.rows()) {
+        addStatsRow(row.first, row.second);
+    }
 }
 
 void ReportsWidgetStatistics::saveSettings()
@@ -641,6 +641,80 @@ namespace Phantom
             return deep_getCachedSwatchOfQPalette(cache, cacheCount, qpalette);
         }
 
+        // Rendered primitives are kept up to this many KiB
+        constexpr int PrimitiveCacheMaxCost = 4096;
+        // Larger primitives are painted directly
+        constexpr int PrimitiveCacheMaxExtent = 64;
+
+        // Everything a cached primitive depends on. The palette is included by
+        // its accurate hash, so changing the palette or the theme misses the
+        // cache instead of drawing stale colors.
+        struct PrimitiveCacheKey
+        {
+            int element;
+            int state;
+            int extra;
+            int direction;
+            QSize size;
+            qreal devicePixelRatio;
+            uint palette;
+
+            bool operator==(const PrimitiveCacheKey& other) const
+            {
+                return element == other.element && state == other.state && extra == other.extra
+                       && direction == other.direction && size == other.size
+                       && devicePixelRatio == other.devicePixelRatio && palette == other.palette;
+            }
+        };
+
+        uint qHash(const PrimitiveCacheKey& key, uint seed = 0)
+        {
+            QtPrivate::QHashCombine c;
+            seed = c(seed, key.element);
+            seed = c(seed, key.state);
+            seed = c(seed, key.extra);
+            seed = c(seed, key.direction);
+            seed = c(seed, key.size.width());
+            seed = c(seed, key.size.height());
+            seed = c(seed, key.devicePixelRatio);
+            return c(seed, key.palette);
+        }
+
+        using PrimitiveCache = QCache<PrimitiveCacheKey, QPixmap>;
+
+        // Small primitives that are drawn many times with the same size, such as
+        // the check boxes and branch arrows in every row of an item view. They
+        // must only depend on the option fields in PrimitiveCacheKey.
+        bool isCachedPrimitive(QStyle::PrimitiveElement elem, const QStyleOption* option, const QWidget* widget)
+        {
+            switch (static_cast<int>(elem)) {
+            case QStyle::PE_IndicatorCheckBox:
+            case QStyle::PE_IndicatorRadioButton:
+                return true;
+            case QStyle::PE_IndicatorBranch:
+                // Drawn at the left edge of the view instead of the option rect
+                return !BranchesOnEdge && (option->state & QStyle::State_Children);
+            case QStyle::PE_IndicatorArrowUp:
+            case QStyle::PE_IndicatorArrowDown:
+            case QStyle::PE_IndicatorArrowRight:
+            case QStyle::PE_IndicatorArrowLeft:
+                // Tool buttons with a menu shrink the arrow depending on the widget
+                return !qobject_cast<const QToolButton*>(widget);
+            default:
+                return false;
+            }
+        }
+
+        int primitiveCacheExtra(const QStyleOption* option)
+        {
+            if (auto button = qstyleoption_cast<const QStyleOptionButton*>(option)) {
+                return button->features;
+            }
+            if (auto item = qstyleoption_cast<const QStyleOptionViewItem*>(option)) {
+                return item->showDecorationSelected ? 1 : 0;
+            }
+            return 0;
+        }
     } // namespace
 } // namespace Phantom
 
@@ -682,6 +756,11 @@ public:
 
     Phantom::PhSwatchCache swatchCache;
     QPen checkBox_pen_scratch;
+
+    // Pixmaps of primitives drawn before, cost in KiB
+    Phantom::PrimitiveCache primitiveCache;
+    // Set while a primitive is rendered into the cache
+    bool renderingPrimitive;
 };
 
 namespace Phantom
@@ -1392,6 +1471,8 @@ namespace Phantom
 
 BaseStylePrivate::BaseStylePrivate()
     : headSwatchFastKey(0)
+    , primitiveCache(Phantom::PrimitiveCacheMaxCost)
+    , renderingPrimitive(false)
 {
 }
 
@@ -1439,6 +1520,77 @@ void BaseStyle::drawItemText(QPainter* painter,
     }
 }
 
+// Draw a primitive from a pixmap of it rendered before, rendering it into the
+// cache first if needed. Returns false if the primitive has to be painted
+// directly, which is the case while printing or with a scaled painter.
+bool BaseStyle::drawCachedPrimitive(PrimitiveElement elem,
+                                    const QStyleOption* option,
+                                    QPainter* painter,
+                                    const QWidget* widget) const
+{
+    namespace Ph = Phantom;
+    if (d->renderingPrimitive || !Ph::isCachedPrimitive(elem, option, widget)) {
+        return false;
+    }
+    const QSize size = option->rect.size();
+    if (size.isEmpty() || size.width() > Ph::PrimitiveCacheMaxExtent || size.height() > Ph::PrimitiveCacheMaxExtent
+        || painter->transform().type() > QTransform::TxTranslate) {
+        return false;
+    }
+    auto device = painter->device();
+    if (!device || device->devType() == QInternal::Printer || device->devType() == QInternal::Picture) {
+        return false;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    const qreal dpr = device->devicePixelRatioF();
+#else
+    const qreal dpr = device->devicePixelRatio();
+#endif
+    const Ph::PrimitiveCacheKey key{elem,
+                                    static_cast<int>(option->state),
+                                    Ph::primitiveCacheExtra(option),
+                                    option->direction,
+                                    size,
+                                    dpr,
+                                    Ph::accurate_hash_qpalette(option->palette)};
+
+    if (auto cached = d->primitiveCache.object(key)) {
+        painter->drawPixmap(option->rect.topLeft(), *cached);
+        return true;
+    }
+
+    // Render with the option moved to the origin of the pixmap
+    QStyleOptionButton button;
+    QStyleOptionViewItem item;
+    QStyleOption plain;
+    QStyleOption* copy = &plain;
+    if (auto opt = qstyleoption_cast<const QStyleOptionButton*>(option)) {
+        button = *opt;
+        copy = &button;
+    } else if (auto opt = qstyleoption_cast<const QStyleOptionViewItem*>(option)) {
+        item = *opt;
+        copy = &item;
+    } else {
+        plain = *option;
+    }
+    copy->rect.moveTopLeft(QPoint(0, 0));
+
+    QPixmap pixmap(size * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+    QPainter pixmapPainter(&pixmap);
+    d->renderingPrimitive = true;
+    proxy()->drawPrimitive(elem, copy, &pixmapPainter, widget);
+    d->renderingPrimitive = false;
+    pixmapPainter.end();
+
+    painter->drawPixmap(option->rect.topLeft(), pixmap);
+    const int cost = qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024);
+    d->primitiveCache.insert(key, new QPixmap(pixmap), cost);
+    return true;
+}
+
 void BaseStyle::drawPrimitive(PrimitiveElement elem,
                               const QStyleOption* option,
                               QPainter* painter,
@@ -1447,6 +1599,8 @@ void BaseStyle::drawPrimitive(PrimitiveElement elem,
     Q_ASSERT(option);
     if (!option)
         return;
+    if (drawCachedPrimitive(elem, option, painter, widget))
+        return;
 #ifdef BUILD_WITH_EASY_PROFILER
     EASY_BLOCK("drawPrimitive");
     const char* elemCString = QMetaEnum::fromType<QStyle::PrimitiveElement>().valueToKey(elem);
@@ -4249,6 +4403,8 @@ void BaseStyle::polish(QApplication* app)
 
     stylesheet.append(getAppStyleSheet());
     app->setStyleSheet(stylesheet);
+    // The application palette may change with the style
+    d->primitiveCache.clear();
     QCommonStyle::polish(app);
 }
 
@@ -106,6 +106,12 @@ protected:
 #endif
 
     BaseStylePrivate* d;
+
+private:
+    bool drawCachedPrimitive(PrimitiveElement elem,
+                             const QStyleOption* option,
+                             QPainter* painter,
+                             const QWidget* widget) const;
 };
 
 #endif
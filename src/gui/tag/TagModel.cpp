@@ -41,38 +41,102 @@ void TagModel::setDatabase(QSharedPointer<Database> db)
         disconnect(m_db.data());
     }
 
+    beginResetModel();
     m_db = db;
-    if (!m_db) {
-        m_tagList.clear();
-        return;
-    }
-
-    connect(m_db.data(), SIGNAL(tagListUpdated()), SLOT(updateTagList()));
-    connect(m_db->metadata()->customData(), SIGNAL(modified()), SLOT(updateTagList()));
+    m_tagList.clear();
+    m_tagListStart = 0;
+    if (m_db) {
+        connect(m_db.data(), SIGNAL(tagListUpdated()), SLOT(updateTagList()));
+        connect(m_db->metadata()->customData(), SIGNAL(modified()), SLOT(updateTagList()));
 
-    updateTagList();
+        m_tagList << m_defaultSearches << savedSearchItems();
+        m_tagListStart = m_tagList.size();
+        m_tagList << tagItems();
+    }
+    endResetModel();
 }
 
+/**
+ * Update the saved searches and tags in place, so views keep their state.
+ * Both sections are sorted by name.
+ */
 void TagModel::updateTagList()
 {
-    beginResetModel();
-    m_tagList.clear();
+    if (!m_db) {
+        return;
+    }
 
-    m_tagList << m_defaultSearches;
+    updateSection(m_defaultSearches.size(), m_tagListStart, savedSearchItems());
+    int tagListEnd = m_tagList.size();
+    updateSection(m_tagListStart, tagListEnd, tagItems());
+}
 
-    auto savedSearches = m_db->metadata()->savedSearches();
-    for (auto search : savedSearches.keys()) {
-        m_tagList << qMakePair(search, savedSearches[search].toString());
+QList<QPair<QString, QString>> TagModel::savedSearchItems() const
+{
+    QList<QPair<QString, QString>> items;
+    const auto savedSearches = m_db->metadata()->savedSearches();
+    for (auto it = savedSearches.constBegin(); it != savedSearches.constEnd(); ++it) {
+        items << qMakePair(it.key(), it.value().toString());
     }
+    return items;
+}
 
-    m_tagListStart = m_tagList.size();
-    for (auto tag : m_db->tagList()) {
+QList<QPair<QString, QString>> TagModel::tagItems() const
+{
+    QList<QPair<QString, QString>> items;
+    for (const auto& tag : m_db->tagList()) {
         auto escapedTag = tag;
         escapedTag.replace("\"", "\\\"");
-        m_tagList << qMakePair(tag, QString("tag:\"%1\"").arg(escapedTag));
+        items << qMakePair(tag, QString("tag:\"%1\"").arg(escapedTag));
     }
+    return items;
+}
 
-    endResetModel();
+/**
+ * Turn the rows [start, end) into the given items by removing and inserting
+ * rows where they differ. Both have to be sorted by name.
+ *
+ * @param end end of the section, kept up to date while rows change
+ */
+void TagModel::updateSection(int start, int& end, const QList<QPair<QString, QString>>& items)
+{
+    int row = start;
+    int i = 0;
+    while (row < end || i < items.size()) {
+        if (i == items.size() || (row < end && m_tagList.at(row).first < items.at(i).first)) {
+            // Rows no longer present
+            int last = row;
+            while (last + 1 < end && (i == items.size() || m_tagList.at(last + 1).first < items.at(i).first)) {
+                ++last;
+            }
+            beginRemoveRows({}, row, last);
+            m_tagList.erase(m_tagList.begin() + row, m_tagList.begin() + last + 1);
+            end -= last - row + 1;
+            endRemoveRows();
+        } else if (row == end || items.at(i).first < m_tagList.at(row).first) {
+            // New rows
+            int last = i;
+            while (last + 1 < items.size() && (row == end || items.at(last + 1).first < m_tagList.at(row).first)) {
+                ++last;
+            }
+            const int count = last - i + 1;
+            beginInsertRows({}, row, row + count - 1);
+            for (int n = 0; n < count; ++n) {
+                m_tagList.insert(row + n, items.at(i + n));
+            }
+            end += count;
+            endInsertRows();
+            row += count;
+            i += count;
+        } else {
+            if (m_tagList.at(row).second != items.at(i).second) {
+                m_tagList[row].second = items.at(i).second;
+                emit dataChanged(index(row), index(row));
+            }
+            ++row;
+            ++i;
+        }
+    }
 }
 
 TagModel::TagType TagModel::itemType(const QModelIndex& index)
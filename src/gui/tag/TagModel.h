@@ -48,6 +48,10 @@ private slots:
     void updateTagList();
 
 private:
+    QList<QPair<QString, QString>> savedSearchItems() const;
+    QList<QPair<QString, QString>> tagItems() const;
+    void updateSection(int start, int& end, const QList<QPair<QString, QString>>& items);
+
     QSharedPointer<Database> m_db;
     QList<QPair<QString, QString>> m_defaultSearches;
     QList<QPair<QString, QString>> m_tagList;
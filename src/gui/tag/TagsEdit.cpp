@@ -67,6 +67,10 @@ namespace
         QString text;
         QRect rect;
         size_t row;
+        // Width of `measured_text`, reused by the layout while the text and font don't change
+        QString measured_text;
+        int text_width = 0;
+        int measured_generation = -1;
     };
 
     /// Non empty string filtering iterator
@@ -171,11 +175,15 @@ struct TagsEdit::Impl
                    : false;
     }
 
-    template <class It> void drawTags(QPainter& p, std::pair<It, It> range) const
+    /// Draws the tags in `range` that intersect `clip`, in viewport coordinates
+    template <class It> void drawTags(QPainter& p, std::pair<It, It> range, QRect const& clip) const
     {
         for (auto it = range.first; it != range.second; ++it) {
             QRect const& i_r =
                 it->rect.translated(-ifce->horizontalScrollBar()->value(), -ifce->verticalScrollBar()->value());
+            if (!i_r.intersects(clip)) {
+                continue;
+            }
             auto const text_pos =
                 i_r.topLeft()
                 + QPointF(tag_inner.left(),
@@ -231,6 +239,11 @@ struct TagsEdit::Impl
 
     QRect calcRects(QList<Tag>& tags, QRect r) const
     {
+        if (ifce->font() != measured_font) {
+            measured_font = ifce->font();
+            ++metrics_generation;
+        }
+
         size_t row = 0;
         auto lt = r.topLeft();
         QFontMetrics fm = ifce->fontMetrics();
@@ -255,7 +268,7 @@ struct TagsEdit::Impl
     {
         for (auto it = range.first; it != range.second; ++it) {
             // calc text rect
-            const auto text_w = FONT_METRICS_WIDTH(fm, it->text);
+            const auto text_w = textWidth(*it, fm);
             auto const text_h = fm.height() + fm.leading();
             auto const w = cross_deleter
                                ? tag_inner.left() + tag_inner.right() + tag_cross_padding * 2 + tag_cross_width
@@ -278,6 +291,16 @@ struct TagsEdit::Impl
         }
     }
 
+    int textWidth(Tag& tag, QFontMetrics const& fm) const
+    {
+        if (tag.measured_generation != metrics_generation || tag.measured_text != tag.text) {
+            tag.text_width = FONT_METRICS_WIDTH(fm, tag.text);
+            tag.measured_text = tag.text;
+            tag.measured_generation = metrics_generation;
+        }
+        return tag.text_width;
+    }
+
     template <class It> void calcEditorRect(QPoint& lt, size_t& row, QRect r, QFontMetrics const& fm, It it) const
     {
         auto const text_w = FONT_METRICS_WIDTH(fm, text_layout.text());
@@ -487,6 +510,15 @@ struct TagsEdit::Impl
         return text_layout.lineAt(0).cursorToX(cursor);
     }
 
+    /// Area covered by the text cursor, in viewport coordinates
+    QRect cursorRect() const
+    {
+        auto const& r = currentRect();
+        auto const x = r.left() + tag_inner.left() + qRound(text_layout.lineAt(0).cursorToX(cursor));
+        return QRect(x - 2, r.top(), 5, r.height())
+            .translated(-ifce->horizontalScrollBar()->value(), -ifce->verticalScrollBar()->value());
+    }
+
     void editPreviousTag()
     {
         if (editing_index > 0) {
@@ -581,6 +613,8 @@ struct TagsEdit::Impl
     bool cross_deleter;
     std::unique_ptr<QCompleter> completer;
     int hscroll{0};
+    mutable QFont measured_font;
+    mutable int metrics_generation{0};
 };
 
 TagsEdit::TagsEdit(QWidget* parent)
@@ -654,9 +688,10 @@ void TagsEdit::hideEvent(QHideEvent* event)
     impl->completer->popup()->hide();
 }
 
-void TagsEdit::paintEvent(QPaintEvent*)
+void TagsEdit::paintEvent(QPaintEvent* event)
 {
     QPainter p(viewport());
+    auto const& clip = event->rect();
 
     // clip
     auto const rect = impl->contentsRect();
@@ -668,7 +703,9 @@ void TagsEdit::paintEvent(QPaintEvent*)
 
         // tags
         impl->drawTags(
-            p, std::pair(impl->tags.cbegin(), std::next(impl->tags.cbegin(), std::ptrdiff_t(impl->editing_index))));
+            p,
+            std::pair(impl->tags.cbegin(), std::next(impl->tags.cbegin(), std::ptrdiff_t(impl->editing_index))),
+            clip);
 
         // draw not terminated tag
         auto const formatting = impl->formatting();
@@ -683,10 +720,14 @@ void TagsEdit::paintEvent(QPaintEvent*)
 
         // tags
         impl->drawTags(
-            p, std::pair(std::next(impl->tags.cbegin(), std::ptrdiff_t(impl->editing_index + 1)), impl->tags.cend()));
+            p,
+            std::pair(std::next(impl->tags.cbegin(), std::ptrdiff_t(impl->editing_index + 1)), impl->tags.cend()),
+            clip);
     } else {
         impl->drawTags(
-            p, std::pair(EmptySkipIterator(impl->tags.begin(), impl->tags.end()), EmptySkipIterator(impl->tags.end())));
+            p,
+            std::pair(EmptySkipIterator(impl->tags.begin(), impl->tags.end()), EmptySkipIterator(impl->tags.end())),
+            clip);
     }
 }
 
@@ -694,7 +735,8 @@ void TagsEdit::timerEvent(QTimerEvent* event)
 {
     if (event->timerId() == impl->blink_timer) {
         impl->blink_status = !impl->blink_status;
-        viewport()->update();
+        // Only the cursor changes, don't repaint all tags
+        viewport()->update(impl->cursorRect());
     }
 }
 
@@ -904,11 +946,11 @@ void TagsEdit::keyPressEvent(QKeyEvent* event)
 
 void TagsEdit::completion(QStringList const& completions)
 {
-    impl->completer = std::make_unique<QCompleter>([&] {
-        QStringList ret;
-        std::copy(completions.begin(), completions.end(), std::back_inserter(ret));
-        return ret;
-    }());
+    // A sorted model lets the completer look up prefixes by binary search instead of filtering all tags
+    auto sorted = completions;
+    sorted.sort();
+    impl->completer = std::make_unique<QCompleter>(sorted);
+    impl->completer->setModelSorting(QCompleter::CaseSensitivelySortedModel);
     impl->setupCompleter();
 }
 
@@ -83,13 +83,25 @@ bool KeeShare::isShared(const Group* group)
 }
 
 KeeShareSettings::Reference KeeShare::referenceOf(const Group* group)
+{
+    return decodeReference(encodedReferenceOf(group));
+}
+
+/**
+ * The sharing reference of a group as it is stored in its custom data.
+ * Comparing it is much cheaper than decoding it with referenceOf().
+ */
+QString KeeShare::encodedReferenceOf(const Group* group)
+{
+    return group->customData()->value(KeeShare_Reference);
+}
+
+KeeShareSettings::Reference KeeShare::decodeReference(const QString& encoded)
 {
     static const KeeShareSettings::Reference s_emptyReference;
-    const CustomData* customData = group->customData();
-    if (!customData->contains(KeeShare_Reference)) {
+    if (encoded.isEmpty()) {
         return s_emptyReference;
     }
-    const auto encoded = customData->value(KeeShare_Reference);
     const auto serialized = QString::fromUtf8(QByteArray::fromBase64(encoded.toLatin1()));
     KeeShareSettings::Reference reference = KeeShareSettings::Reference::deserialize(serialized);
     if (reference.isNull()) {
@@ -217,6 +229,15 @@ void KeeShare::connectDatabase(QSharedPointer<Database> newDb, QSharedPointer<Da
     }
 }
 
+void KeeShare::forceExport(QSharedPointer<Database> db)
+{
+    // Saving only exports changed shares, this writes all of them
+    QPointer<ShareObserver> observer = db ? m_observersByDatabase.value(db->uuid()) : nullptr;
+    if (observer) {
+        observer->forceExport();
+    }
+}
+
 const QString KeeShare::signedContainerFileType()
 {
     static const QString filetype("kdbx.share");
@@ -61,10 +61,13 @@ public:
     static void setActive(const KeeShareSettings::Active& active);
 
     static KeeShareSettings::Reference referenceOf(const Group* group);
+    static QString encodedReferenceOf(const Group* group);
+    static KeeShareSettings::Reference decodeReference(const QString& encoded);
     static void setReferenceTo(Group* group, const KeeShareSettings::Reference& reference);
     static QString referenceTypeLabel(const KeeShareSettings::Reference& reference);
 
     void connectDatabase(QSharedPointer<Database> newDb, QSharedPointer<Database> oldDb);
+    void forceExport(QSharedPointer<Database> db);
 
     static const QString signedContainerFileType();
     static const QString unsignedContainerFileType();
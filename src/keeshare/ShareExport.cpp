@@ -26,6 +26,8 @@
 #include "keys/PasswordKey.h"
 
 #include <QBuffer>
+#include <QCryptographicHash>
+#include <QSaveFile>
 #include <botan/pubkey.h>
 #include <minizip/zip.h>
 
@@ -62,10 +64,12 @@ namespace
         }
     }
 
-    Database* extractIntoDatabase(const KeeShareSettings::Reference& reference, const Group* sourceRoot)
+    Database* extractIntoDatabase(const Group* sourceRoot)
     {
         const auto* sourceDb = sourceRoot->database();
         auto* targetDb = new Database();
+        // The container may be written on another thread, it must not start the modified timer
+        targetDb->setEmitModified(false);
         auto* targetMetadata = targetDb->metadata();
         targetMetadata->setRecycleBinEnabled(false);
 
@@ -88,10 +92,6 @@ namespace
             }
         }
 
-        auto key = QSharedPointer<CompositeKey>::create();
-        key->addKey(QSharedPointer<PasswordKey>::create(reference.password));
-        targetDb->setKey(key);
-
         auto obsoleteRoot = targetDb->setRootGroup(targetRoot);
         delete obsoleteRoot;
 
@@ -161,7 +161,37 @@ ShareObserver::Result ShareExport::intoContainer(const QString& resolvedPath,
                                                  const KeeShareSettings::Reference& reference,
                                                  const Group* group)
 {
-    QScopedPointer<Database> targetDb(extractIntoDatabase(reference, group));
+    const bool sign = resolvedPath.endsWith(".kdbx.share");
+    return writeContainer(
+        resolvedPath, reference, extractContainer(group), sign ? KeeShare::own() : KeeShareSettings::Own());
+}
+
+/**
+ * Copy the shared group into a new database, ready to be written by writeContainer().
+ * Reads the live database, so it has to be called on the thread owning it.
+ */
+QSharedPointer<Database> ShareExport::extractContainer(const Group* group)
+{
+    return QSharedPointer<Database>(extractIntoDatabase(group));
+}
+
+/**
+ * Encrypt the extracted database and write it to the container. Only touches its
+ * arguments and can be run on a worker thread, several containers concurrently.
+ *
+ * @param own certificate to sign the container with, only used for signed containers
+ */
+ShareObserver::Result ShareExport::writeContainer(const QString& resolvedPath,
+                                                  const KeeShareSettings::Reference& reference,
+                                                  QSharedPointer<Database> targetDb,
+                                                  const KeeShareSettings::Own& own)
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create(reference.password));
+    if (!targetDb->setKey(key)) {
+        return {reference.path, ShareObserver::Result::Error, targetDb->keyError()};
+    }
+
     if (resolvedPath.endsWith(".kdbx.share")) {
         // Write database to memory and sign it
         QByteArray dbData, signatureData;
@@ -178,11 +208,8 @@ ShareObserver::Result ShareExport::intoContainer(const QString& resolvedPath,
 
         buffer.close();
 
-        // Get Own Certificate for signing
-        const auto own = KeeShare::own();
-        Q_ASSERT(!own.isNull());
-
         // Sign the database data
+        Q_ASSERT(!own.isNull());
         KeeShareSettings::Sign sign;
         sign.certificate = own.certificate;
         signData(dbData, own.key, sign.signature);
@@ -199,8 +226,14 @@ ShareObserver::Result ShareExport::intoContainer(const QString& resolvedPath,
 
         zipClose(zf, nullptr);
     } else {
-        QString error;
-        if (!targetDb->saveAs(resolvedPath, Database::Atomic, {}, &error)) {
+        // Database::saveAs() would watch the written file, write it directly instead
+        int length = Random::instance()->randomUIntRange(64, 512);
+        targetDb->metadata()->customData()->set("KPXC_RANDOM_SLUG", Random::instance()->randomArray(length).toHex());
+
+        QSaveFile file(resolvedPath);
+        KeePass2Writer writer;
+        if (!file.open(QIODevice::WriteOnly) || !writer.writeDatabase(&file, targetDb.data()) || !file.commit()) {
+            const auto error = writer.hasError() ? writer.errorString() : file.errorString();
             qWarning("Exporting database failed: %s.", error.toLatin1().data());
             return {resolvedPath, ShareObserver::Result::Error, error};
         }
@@ -208,3 +241,41 @@ ShareObserver::Result ShareExport::intoContainer(const QString& resolvedPath,
 
     return {resolvedPath};
 }
+
+/**
+ * Digest of everything intoContainer() writes for the given share, changes whenever
+ * the exported container would. Much cheaper than an export as no KDF is involved.
+ */
+QByteArray ShareExport::fingerprint(const KeeShareSettings::Reference& reference, const Group* group)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(KeeShareSettings::Reference::serialize(reference).toUtf8());
+
+    auto addTimes = [&hash](const QUuid& uuid, const TimeInfo& timeInfo) {
+        hash.addData(uuid.toRfc4122());
+        hash.addData(QByteArray::number(timeInfo.lastModificationTime().toMSecsSinceEpoch()));
+        hash.addData(QByteArray::number(timeInfo.locationChanged().toMSecsSinceEpoch()));
+    };
+    for (const auto* child : group->groupsRecursive(true)) {
+        addTimes(child->uuid(), child->timeInfo());
+        hash.addData(child->name().toUtf8());
+    }
+    for (const auto* entry : group->entriesRecursive(false)) {
+        addTimes(entry->uuid(), entry->timeInfo());
+        hash.addData(QByteArray::number(entry->historyCount()));
+        if (!entry->hasReferences()) {
+            continue;
+        }
+        // References leaving the share are resolved on export, their targets may have changed
+        for (const auto& attribute : EntryAttributes::DefaultAttributes) {
+            hash.addData(entry->resolveMultiplePlaceholders(entry->attributes()->value(attribute)).toUtf8());
+        }
+    }
+
+    // Deletions of the whole database are pushed to every export
+    for (const auto& object : group->database()->deletedObjects()) {
+        hash.addData(object.uuid.toRfc4122());
+        hash.addData(QByteArray::number(object.deletionTime.toMSecsSinceEpoch()));
+    }
+    return hash.result();
+}
@@ -29,6 +29,12 @@ class ShareExport
 public:
     static ShareObserver::Result
     intoContainer(const QString& resolvedPath, const KeeShareSettings::Reference& reference, const Group* group);
+    static QSharedPointer<Database> extractContainer(const Group* group);
+    static ShareObserver::Result writeContainer(const QString& resolvedPath,
+                                                const KeeShareSettings::Reference& reference,
+                                                QSharedPointer<Database> targetDb,
+                                                const KeeShareSettings::Own& own);
+    static QByteArray fingerprint(const KeeShareSettings::Reference& reference, const Group* group);
 
 private:
     ShareExport() = delete;
@@ -46,6 +46,25 @@ namespace
 ShareObserver::Result ShareImport::containerInto(const QString& resolvedPath,
                                                  const KeeShareSettings::Reference& reference,
                                                  Group* targetGroup)
+{
+    ShareObserver::Result result;
+    const auto sourceDb = readContainer(resolvedPath, reference, result);
+    if (!sourceDb) {
+        return result;
+    }
+    return mergeInto(reference, sourceDb, targetGroup);
+}
+
+/**
+ * Read and decrypt the container. Does not touch any open database and can be run
+ * on a worker thread, several containers concurrently.
+ *
+ * @param result set to the error if reading fails
+ * @return the container's database or nullptr on error
+ */
+QSharedPointer<Database> ShareImport::readContainer(const QString& resolvedPath,
+                                                    const KeeShareSettings::Reference& reference,
+                                                    ShareObserver::Result& result)
 {
     QByteArray dbData;
 
@@ -67,7 +86,8 @@ ShareObserver::Result ShareImport::containerInto(const QString& resolvedPath,
         QFile file(resolvedPath);
         if (!file.open(QIODevice::ReadOnly)) {
             qCritical("Unable to open file %s.", qPrintable(reference.path));
-            return {reference.path, ShareObserver::Result::Error, file.errorString()};
+            result = {reference.path, ShareObserver::Result::Error, file.errorString()};
+            return {};
         }
         dbData = file.readAll();
         file.close();
@@ -82,9 +102,21 @@ ShareObserver::Result ShareImport::containerInto(const QString& resolvedPath,
     auto sourceDb = QSharedPointer<Database>::create();
     if (!reader.readDatabase(&buffer, key, sourceDb.data())) {
         qCritical("Error while parsing the database: %s", qPrintable(reader.errorString()));
-        return {reference.path, ShareObserver::Result::Error, reader.errorString()};
+        result = {reference.path, ShareObserver::Result::Error, reader.errorString()};
+        return {};
     }
+    // Nothing may be left pending on this thread once the database is handed over
+    sourceDb->markAsClean();
+    return sourceDb;
+}
 
+/**
+ * Merge a container read by readContainer() into the target group of the open database.
+ */
+ShareObserver::Result ShareImport::mergeInto(const KeeShareSettings::Reference& reference,
+                                             const QSharedPointer<Database>& sourceDb,
+                                             Group* targetGroup)
+{
     qDebug("Synchronize %s %s with %s",
            qPrintable(reference.path),
            qPrintable(targetGroup->name()),
@@ -27,6 +27,12 @@ class ShareImport
 public:
     static ShareObserver::Result
     containerInto(const QString& resolvedPath, const KeeShareSettings::Reference& reference, Group* targetGroup);
+    static QSharedPointer<Database> readContainer(const QString& resolvedPath,
+                                                  const KeeShareSettings::Reference& reference,
+                                                  ShareObserver::Result& result);
+    static ShareObserver::Result mergeInto(const KeeShareSettings::Reference& reference,
+                                           const QSharedPointer<Database>& sourceDb,
+                                           Group* targetGroup);
 
 public:
     ShareImport() = delete;
@@ -16,12 +16,14 @@
  */
 
 #include "ShareObserver.h"
+#include "core/AsyncTask.h"
 #include "core/FileWatcher.h"
 #include "core/Group.h"
 #include "keeshare/KeeShare.h"
 #include "keeshare/ShareExport.h"
 #include "keeshare/ShareImport.h"
 
+#include <QCryptographicHash>
 #include <QDir>
 
 namespace
@@ -34,17 +36,31 @@ namespace
 
     constexpr int FileWatchPeriod = 30;
     constexpr int FileWatchSize = 5;
+
+    struct ExportJob
+    {
+        QString resolvedPath;
+        KeeShareSettings::Reference reference;
+        QSharedPointer<Database> database;
+        KeeShareSettings::Own own;
+        QByteArray fingerprint;
+    };
+
+    // Runs on the thread pool, the extracted database is not shared with anything else
+    ShareObserver::Result runExport(const ExportJob& job)
+    {
+        return ShareExport::writeContainer(job.resolvedPath, job.reference, job.database, job.own);
+    }
 } // End Namespace
 
 ShareObserver::ShareObserver(QSharedPointer<Database> db, QObject* parent)
     : QObject(parent)
     , m_db(std::move(db))
 {
-    connect(KeeShare::instance(), &KeeShare::activeChanged, this, &ShareObserver::handleDatabaseChanged);
+    connect(KeeShare::instance(), &KeeShare::activeChanged, this, &ShareObserver::handleGroupsChanged);
 
-    connect(m_db.data(), &Database::groupDataChanged, this, &ShareObserver::handleDatabaseChanged);
-    connect(m_db.data(), &Database::groupAdded, this, &ShareObserver::handleDatabaseChanged);
-    connect(m_db.data(), &Database::groupRemoved, this, &ShareObserver::handleDatabaseChanged);
+    connect(m_db.data(), &Database::groupAdded, this, &ShareObserver::handleGroupsChanged);
+    connect(m_db.data(), &Database::groupRemoved, this, &ShareObserver::handleGroupsChanged);
 
     connect(m_db.data(), &Database::modified, this, &ShareObserver::handleDatabaseChanged);
     connect(m_db.data(), &Database::databaseSaved, this, &ShareObserver::handleDatabaseSaved);
@@ -62,14 +78,30 @@ void ShareObserver::deinitialize()
     m_groupToReference.clear();
     m_shareToGroup.clear();
     m_fileWatchers.clear();
+    m_exportStates.clear();
+    m_pendingImports.clear();
+    m_decodedReferences.clear();
+    m_initialized = false;
 }
 
 void ShareObserver::reinitialize()
 {
     QList<QPair<QPointer<Group>, KeeShareSettings::Reference>> shares;
+    // Only decode references that are new since the last scan, keep the ones still in use
+    QHash<QString, KeeShareSettings::Reference> decodedReferences;
     for (Group* group : m_db->rootGroup()->groupsRecursive(true)) {
+        const auto encoded = KeeShare::encodedReferenceOf(group);
+        auto decoded = decodedReferences.constFind(encoded);
+        if (decoded == decodedReferences.constEnd()) {
+            auto cached = m_decodedReferences.constFind(encoded);
+            decoded = decodedReferences.insert(encoded,
+                                               cached != m_decodedReferences.constEnd()
+                                                   ? cached.value()
+                                                   : KeeShare::decodeReference(encoded));
+        }
+
         auto oldReference = m_groupToReference.value(group);
-        auto newReference = KeeShare::referenceOf(group);
+        const auto& newReference = decoded.value();
         if (oldReference == newReference) {
             continue;
         }
@@ -87,8 +119,8 @@ void ShareObserver::reinitialize()
 
         shares.append({group, newReference});
     }
+    m_decodedReferences.swap(decodedReferences);
 
-    QStringList success;
     QStringList warning;
     QStringList error;
     QMap<QString, QStringList> imported;
@@ -116,24 +148,11 @@ void ShareObserver::reinitialize()
 
         if (reference.isImporting()) {
             imported[reference.path] << group->name();
-            // import has to occur immediately
-            const auto result = this->importShare(reference.path);
-            if (!result.isValid()) {
-                // tolerable result - blocked import or missing source
-                continue;
-            }
-
-            if (result.isError()) {
-                error << tr("Import from %1 failed (%2)").arg(result.path).arg(result.message);
-            } else if (result.isWarning()) {
-                warning << tr("Import from %1 failed (%2)").arg(result.path).arg(result.message);
-            } else if (result.isInfo()) {
-                success << tr("Import from %1 successful (%2)").arg(result.path).arg(result.message);
-            } else {
-                success << tr("Imported from %1").arg(result.path);
-            }
+            // import has to occur immediately, the container is read in the background
+            m_pendingImports.insert(reference.path);
         }
     }
+    startImports();
 
     for (auto it = imported.cbegin(); it != imported.cend(); ++it) {
         if (it.value().count() > 1) {
@@ -147,7 +166,7 @@ void ShareObserver::reinitialize()
         }
     }
 
-    notifyAbout(success, warning, error);
+    notifyAbout({}, warning, error);
 }
 
 void ShareObserver::notifyAbout(const QStringList& success, const QStringList& warning, const QStringList& error)
@@ -179,50 +198,55 @@ void ShareObserver::handleDatabaseChanged()
     const auto active = KeeShare::active();
     if (!active.out && !active.in) {
         deinitialize();
-    } else {
-        reinitialize();
+        return;
     }
+
+    // Most changes are edits of entries, references can only change with the custom data of a group
+    const auto revision = m_db->groupCustomDataRevision();
+    if (m_initialized && !m_groupsChanged && revision == m_scannedRevision) {
+        return;
+    }
+    m_initialized = true;
+    m_groupsChanged = false;
+    m_scannedRevision = revision;
+    reinitialize();
+}
+
+void ShareObserver::handleGroupsChanged()
+{
+    m_groupsChanged = true;
+    handleDatabaseChanged();
+}
+
+KeeShareSettings::Reference ShareObserver::referenceOf(const Group* group) const
+{
+    const auto encoded = KeeShare::encodedReferenceOf(group);
+    auto cached = m_decodedReferences.constFind(encoded);
+    return cached != m_decodedReferences.constEnd() ? cached.value() : KeeShare::decodeReference(encoded);
 }
 
 void ShareObserver::handleFileUpdated(const QString& path)
 {
+    m_pendingImports.insert(path);
     if (!m_inFileUpdate) {
-        QTimer::singleShot(100, this, [this, path] {
-            const Result result = importShare(path);
+        // Collect a burst of changes across shares before reading them
+        QTimer::singleShot(100, this, [this] {
             m_inFileUpdate = false;
-            if (!result.isValid()) {
-                return;
-            }
-            QStringList success;
-            QStringList warning;
-            QStringList error;
-            if (result.isError()) {
-                error << tr("Import from %1 failed (%2)").arg(result.path, result.message);
-            } else if (result.isWarning()) {
-                warning << tr("Import from %1 failed (%2)").arg(result.path, result.message);
-            } else if (result.isInfo()) {
-                success << tr("Import from %1 successful (%2)").arg(result.path, result.message);
-            } else {
-                success << tr("Imported from %1").arg(result.path);
-            }
-            notifyAbout(success, warning, error);
+            startImports();
         });
         m_inFileUpdate = true;
     }
 }
 
-ShareObserver::Result ShareObserver::importShare(const QString& path)
+QPointer<Group> ShareObserver::importTarget(const QString& path, KeeShareSettings::Reference& reference) const
 {
-    if (!KeeShare::active().in) {
-        return {};
-    }
     const auto changePath = resolvePath(path, m_db);
     auto shareGroup = m_shareToGroup.value(changePath);
     if (!shareGroup) {
         qWarning("Group for %s does not exist", qPrintable(path));
         return {};
     }
-    const auto reference = KeeShare::referenceOf(shareGroup);
+    reference = referenceOf(shareGroup);
     if (reference.type == KeeShareSettings::Inactive) {
         // changes of inactive references are ignored
         return {};
@@ -234,8 +258,78 @@ ShareObserver::Result ShareObserver::importShare(const QString& path)
 
     Q_ASSERT(shareGroup->database() == m_db);
     Q_ASSERT(shareGroup == m_db->rootGroup()->findGroupByUuid(shareGroup->uuid()));
-    const auto resolvedPath = resolvePath(reference.path, m_db);
-    return ShareImport::containerInto(resolvedPath, reference, shareGroup);
+    return shareGroup;
+}
+
+/**
+ * Import all pending shares. The containers are read and decrypted concurrently on
+ * worker threads, only merging them into the database happens on this thread.
+ */
+void ShareObserver::startImports()
+{
+    if (!KeeShare::active().in) {
+        m_pendingImports.clear();
+        return;
+    }
+
+    QSet<QString> paths;
+    paths.swap(m_pendingImports);
+    for (const auto& path : asConst(paths)) {
+        KeeShareSettings::Reference reference;
+        const auto shareGroup = importTarget(path, reference);
+        if (!shareGroup) {
+            continue;
+        }
+        const auto resolvedPath = resolvePath(reference.path, m_db);
+        if (m_runningImports.contains(resolvedPath)) {
+            // Read again once the running import is done
+            m_pendingImports.insert(path);
+            continue;
+        }
+        m_runningImports.insert(resolvedPath);
+
+        AsyncTask::runThenCallback(
+            [resolvedPath, reference] {
+                Result result;
+                auto sourceDb = ShareImport::readContainer(resolvedPath, reference, result);
+                return qMakePair(sourceDb, result);
+            },
+            this,
+            [this, path, resolvedPath, reference, shareGroup](QPair<QSharedPointer<Database>, Result> read) {
+                m_runningImports.remove(resolvedPath);
+                auto result = read.second;
+                // The group or its settings may have changed while the container was read
+                if (read.first && shareGroup && referenceOf(shareGroup) == reference) {
+                    result = ShareImport::mergeInto(reference, read.first, shareGroup);
+                }
+                notifyAboutImport(result);
+                if (m_pendingImports.contains(path)) {
+                    startImports();
+                }
+            },
+            AsyncTask::Priority::Background);
+    }
+}
+
+void ShareObserver::notifyAboutImport(const Result& result)
+{
+    if (!result.isValid()) {
+        // tolerable result - blocked import or missing source
+        return;
+    }
+    QStringList success;
+    QStringList warning;
+    QStringList error;
+    if (result.isError()) {
+        error << tr("Import from %1 failed (%2)").arg(result.path, result.message);
+    } else if (result.isWarning()) {
+        warning << tr("Import from %1 failed (%2)").arg(result.path, result.message);
+    } else if (result.isInfo()) {
+        success << tr("Import from %1 successful (%2)").arg(result.path, result.message);
+    } else {
+        success << tr("Imported from %1").arg(result.path);
+    }
+    notifyAbout(success, warning, error);
 }
 
 QSharedPointer<Database> ShareObserver::database()
@@ -243,8 +337,18 @@ QSharedPointer<Database> ShareObserver::database()
     return m_db;
 }
 
-QList<ShareObserver::Result> ShareObserver::exportShares()
+/**
+ * Export the changed shares, or all shares if forced. The containers are extracted
+ * here and encrypted and written concurrently on worker threads.
+ */
+void ShareObserver::exportShares(bool force)
 {
+    if (m_exportRunning) {
+        m_exportPending = true;
+        m_forceExportPending |= force;
+        return;
+    }
+
     QList<Result> results;
     struct Reference
     {
@@ -255,7 +359,7 @@ QList<ShareObserver::Result> ShareObserver::exportShares()
     QMap<QString, QList<Reference>> references;
     const auto groups = m_db->rootGroup()->groupsRecursive(true);
     for (const auto* group : groups) {
-        const auto reference = KeeShare::referenceOf(group);
+        const auto reference = referenceOf(group);
         if (!reference.isExporting()) {
             continue;
         }
@@ -275,25 +379,79 @@ QList<ShareObserver::Result> ShareObserver::exportShares()
     }
     if (!results.isEmpty()) {
         // We need to block export due to config
-        return results;
+        notifyAboutExport(results);
+        return;
     }
 
+    // Signed containers also change with the own certificate
+    const auto ownConfig = config()->get(Config::KeeShare_Own).toByteArray();
+    KeeShareSettings::Own own;
+
+    QList<ExportJob> jobs;
     for (auto it = references.cbegin(); it != references.cend(); ++it) {
         auto reference = it.value().first();
         const QString resolvedPath = resolvePath(reference.config.path, m_db);
+
+        const bool sign = resolvedPath.endsWith(".kdbx.share");
+        auto fingerprint = ShareExport::fingerprint(reference.config, reference.group);
+        if (sign) {
+            fingerprint = QCryptographicHash::hash(fingerprint + ownConfig, QCryptographicHash::Sha256);
+        }
+        const QFileInfo info(resolvedPath);
+        const auto state = m_exportStates.value(resolvedPath);
+        if (!force && state.fingerprint == fingerprint && info.exists() && info.lastModified() == state.lastModified) {
+            // Neither the share nor the container changed since the last export
+            continue;
+        }
+        m_exportStates.remove(resolvedPath);
+
+        if (sign && own.isNull()) {
+            own = KeeShare::own();
+        }
+
         auto watcher = m_fileWatchers.value(resolvedPath);
         if (watcher) {
             watcher->stop();
         }
 
         // TODO: save new path into group settings if not saving to signed container anymore
-        results << ShareExport::intoContainer(resolvedPath, reference.config, reference.group);
+        jobs << ExportJob{resolvedPath,
+                          reference.config,
+                          ShareExport::extractContainer(reference.group),
+                          sign ? own : KeeShareSettings::Own(),
+                          fingerprint};
+    }
+    if (jobs.isEmpty()) {
+        return;
+    }
 
-        if (watcher) {
-            watcher->start(resolvedPath, FileWatchPeriod, FileWatchSize);
+    m_exportRunning = true;
+    auto future = QtConcurrent::mapped(jobs, runExport);
+    auto watcher = new QFutureWatcher<Result>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, future, jobs] {
+        watcher->deleteLater();
+        const auto results = future.results();
+        for (int i = 0; i < jobs.size(); ++i) {
+            const auto& job = jobs[i];
+            if (!results[i].isError()) {
+                m_exportStates.insert(job.resolvedPath, {job.fingerprint, QFileInfo(job.resolvedPath).lastModified()});
+            }
+            auto fileWatcher = m_fileWatchers.value(job.resolvedPath);
+            if (fileWatcher) {
+                fileWatcher->start(job.resolvedPath, FileWatchPeriod, FileWatchSize);
+            }
         }
-    }
-    return results;
+        m_exportRunning = false;
+        notifyAboutExport(results);
+
+        if (m_exportPending) {
+            const bool force = m_forceExportPending;
+            m_exportPending = false;
+            m_forceExportPending = false;
+            exportShares(force);
+        }
+    });
+    watcher->setFuture(future);
 }
 
 void ShareObserver::handleDatabaseSaved()
@@ -301,11 +459,27 @@ void ShareObserver::handleDatabaseSaved()
     if (!KeeShare::active().out) {
         return;
     }
+    exportShares(false);
+}
+
+/**
+ * Export all shares of the database, even those which did not change since
+ * their last export.
+ */
+void ShareObserver::forceExport()
+{
+    if (!KeeShare::active().out) {
+        return;
+    }
+    exportShares(true);
+}
+
+void ShareObserver::notifyAboutExport(const QList<Result>& results)
+{
     QStringList error;
     QStringList warning;
     QStringList success;
 
-    const auto results = exportShares();
     for (const Result& result : results) {
         if (!result.isValid()) {
             Q_ASSERT(result.isValid());
@@ -18,8 +18,12 @@
 #ifndef KEEPASSXC_SHAREOBSERVER_H
 #define KEEPASSXC_SHAREOBSERVER_H
 
+#include <QDateTime>
+#include <QHash>
 #include <QMap>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
 
 #include "gui/MessageWidget.h"
 #include "keeshare/KeeShareSettings.h"
@@ -38,6 +42,8 @@ public:
 
     QSharedPointer<Database> database();
 
+    void forceExport();
+
     struct Result
     {
         enum Type
@@ -65,12 +71,17 @@ signals:
 
 private slots:
     void handleDatabaseChanged();
+    void handleGroupsChanged();
     void handleDatabaseSaved();
     void handleFileUpdated(const QString& path);
 
 private:
-    Result importShare(const QString& path);
-    QList<Result> exportShares();
+    KeeShareSettings::Reference referenceOf(const Group* group) const;
+    QPointer<Group> importTarget(const QString& path, KeeShareSettings::Reference& reference) const;
+    void startImports();
+    void notifyAboutImport(const Result& result);
+    void exportShares(bool force);
+    void notifyAboutExport(const QList<Result>& results);
 
     void deinitialize();
     void reinitialize();
@@ -80,8 +91,28 @@ private:
     QSharedPointer<Database> m_db;
     QMap<QPointer<Group>, KeeShareSettings::Reference> m_groupToReference;
     QMap<QString, QPointer<Group>> m_shareToGroup;
+    // Decoded references of the last scan by their encoded custom data value
+    QHash<QString, KeeShareSettings::Reference> m_decodedReferences;
+    // Groups are only scanned again once their custom data or structure changed
+    quint64 m_scannedRevision = 0;
+    bool m_groupsChanged = false;
+    bool m_initialized = false;
     QMap<QString, QSharedPointer<FileWatcher>> m_fileWatchers;
+    struct ExportState
+    {
+        QByteArray fingerprint;
+        QDateTime lastModified;
+    };
+    // Last successful export per resolved path, unchanged shares are not written again
+    QMap<QString, ExportState> m_exportStates;
     bool m_inFileUpdate = false;
+    // Share paths waiting to be imported and resolved paths being read in the background
+    QSet<QString> m_pendingImports;
+    QSet<QString> m_runningImports;
+    // Exports run in the background, a save meanwhile exports again once they are done
+    bool m_exportRunning = false;
+    bool m_exportPending = false;
+    bool m_forceExportPending = false;
 };
 
 #endif // KEEPASSXC_SHAREOBSERVER_H
@@ -30,6 +30,12 @@
 
 QUuid CompositeKey::UUID("76a7ae25-a542-4add-9849-7c06be945b94");
 
+namespace
+{
+    // Marks the cached transformed key in serialized composite key data
+    const QUuid TransformedKeyUuid("0d8b4a51-6c2e-4f1c-9b8e-2f6f3a7c5e14");
+} // namespace
+
 CompositeKey::CompositeKey()
     : Key(UUID)
 {
@@ -44,6 +50,8 @@ void CompositeKey::clear()
 {
     m_keys.clear();
     m_challengeResponseKeys.clear();
+    m_transformedKeyTag.clear();
+    m_transformedKey.reset();
 }
 
 bool CompositeKey::isEmpty() const
@@ -120,6 +128,11 @@ QByteArray CompositeKey::rawKey(const QByteArray* transformSeed, bool* ok, QStri
  */
 bool CompositeKey::transform(const Kdf& kdf, QByteArray& result, QString* error) const
 {
+    if (hasTransformedKey(kdf)) {
+        result = m_transformedKey->rawKey();
+        return true;
+    }
+
     if (kdf.uuid() == KeePass2::KDF_AES_KDBX3) {
         // legacy KDBX3 AES-KDF, challenge response is added later to the hash
         return kdf.transform(rawKey(), result);
@@ -127,10 +140,60 @@ bool CompositeKey::transform(const Kdf& kdf, QByteArray& result, QString* error)
 
     QByteArray seed = kdf.seed();
     Q_ASSERT(!seed.isEmpty());
+
     bool ok = false;
     return kdf.transform(rawKey(&seed, &ok, error), result) && ok;
 }
 
+/**
+ * Remember the result of transforming this key with the given KDF.
+ *
+ * Subsequent calls to \link CompositeKey::transform with identical KDF
+ * parameters (including the seed) return the stored key instead of running
+ * the KDF again. The transformed key is included in serialize(), which lets
+ * Quick Unlock skip the KDF on re-unlock. Keys with challenge-response
+ * components are never served from the cache so the hardware key is still
+ * required.
+ *
+ * @param kdf KDF the key was transformed with
+ * @param transformedKey transformed key or an empty array to clear the cache
+ */
+void CompositeKey::setTransformedKey(const Kdf& kdf, const QByteArray& transformedKey)
+{
+    if (transformedKey.isEmpty() || !m_challengeResponseKeys.isEmpty()) {
+        m_transformedKeyTag.clear();
+        m_transformedKey.reset();
+        return;
+    }
+
+    m_transformedKeyTag = transformTag(kdf);
+    m_transformedKey = PasswordKey::fromRawKey(transformedKey);
+}
+
+/**
+ * @return true if transform() returns a stored key for the given KDF
+ */
+bool CompositeKey::hasTransformedKey(const Kdf& kdf) const
+{
+    return m_transformedKey && m_challengeResponseKeys.isEmpty() && m_transformedKeyTag == transformTag(kdf);
+}
+
+/**
+ * Identify the inputs of a transformation: the KDF, its parameters
+ * and the static key components.
+ */
+QByteArray CompositeKey::transformTag(const Kdf& kdf) const
+{
+    QByteArray params;
+    QDataStream stream(&params, QIODevice::WriteOnly);
+    stream << kdf.uuid().toRfc4122() << kdf.clone()->writeParameters();
+
+    CryptoHash cryptoHash(CryptoHash::Sha256);
+    cryptoHash.addData(params);
+    cryptoHash.addData(rawKey());
+    return cryptoHash.result();
+}
+
 bool CompositeKey::challenge(const QByteArray& seed, QByteArray& result, QString* error) const
 {
     // if no challenge response was requested, return nothing to
@@ -239,6 +302,12 @@ QByteArray CompositeKey::serialize() const
     for (auto const& key : m_challengeResponseKeys) {
         stream << key->uuid().toRfc4122() << key->serialize();
     }
+    if (m_transformedKey) {
+        QByteArray cacheData;
+        QDataStream cacheStream(&cacheData, QIODevice::WriteOnly);
+        cacheStream << m_transformedKeyTag << m_transformedKey->rawKey();
+        stream << TransformedKeyUuid.toRfc4122() << cacheData;
+    }
     return data;
 }
 
@@ -255,8 +324,7 @@ void CompositeKey::deserialize(const QByteArray& data)
     }
 
     // Clear existing keys
-    m_keys.clear();
-    m_challengeResponseKeys.clear();
+    clear();
 
     while (!stream.atEnd()) {
         // Read the UUID first to construct the key
@@ -278,6 +346,16 @@ void CompositeKey::deserialize(const QByteArray& data)
             auto key = QSharedPointer<FileKey>::create();
             key->deserialize(keyData);
             m_keys << key;
+        } else if (uuid == TransformedKeyUuid) {
+            stream >> keyData;
+            QByteArray tag;
+            QByteArray transformedKey;
+            QDataStream cacheStream(keyData);
+            cacheStream >> tag >> transformedKey;
+            if (cacheStream.status() == QDataStream::Ok && !transformedKey.isEmpty()) {
+                m_transformedKeyTag = tag;
+                m_transformedKey = PasswordKey::fromRawKey(transformedKey);
+            }
         } else {
             // Unsupported key type, discard key data
             stream >> keyData;
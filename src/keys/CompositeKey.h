@@ -25,6 +25,7 @@
 
 class Kdf;
 class ChallengeResponseKey;
+class PasswordKey;
 
 class CompositeKey : public Key
 {
@@ -40,6 +41,8 @@ public:
     void setRawKey(const QByteArray& data) override;
 
     Q_REQUIRED_RESULT bool transform(const Kdf& kdf, QByteArray& result, QString* error = nullptr) const;
+    void setTransformedKey(const Kdf& kdf, const QByteArray& transformedKey);
+    bool hasTransformedKey(const Kdf& kdf) const;
     bool challenge(const QByteArray& seed, QByteArray& result, QString* error = nullptr) const;
 
     void addKey(const QSharedPointer<Key>& key);
@@ -55,9 +58,14 @@ public:
 
 private:
     QByteArray rawKey(const QByteArray* transformSeed, bool* ok = nullptr, QString* error = nullptr) const;
+    QByteArray transformTag(const Kdf& kdf) const;
 
     QList<QSharedPointer<Key>> m_keys;
     QList<QSharedPointer<ChallengeResponseKey>> m_challengeResponseKeys;
+
+    // Result of a previous transform() and the KDF parameters it was computed with
+    QByteArray m_transformedKeyTag;
+    QSharedPointer<PasswordKey> m_transformedKey;
 };
 
 #endif // KEEPASSX_COMPOSITEKEY_H
@@ -29,6 +29,7 @@
 QUuid FileKey::UUID("a584cbc4-c9b4-437e-81bb-362ca9709273");
 
 constexpr int FileKey::SHA256_SIZE;
+constexpr int FileKey::HASH_CHUNK_SIZE;
 
 FileKey::FileKey()
     : Key(UUID)
@@ -438,15 +439,17 @@ bool FileKey::loadHashed(QIODevice* device)
 {
     CryptoHash cryptoHash(CryptoHash::Sha256);
 
-    QByteArray buffer;
-    do {
-        if (!Tools::readFromDevice(device, buffer)) {
-            return false;
-        }
-        cryptoHash.addData(buffer);
-    } while (!buffer.isEmpty());
+    // Hash in fixed-size chunks so large key files are never held in memory at once
+    Botan::secure_vector<char> chunk(HASH_CHUNK_SIZE);
+    qint64 bytesRead;
+    while ((bytesRead = device->read(chunk.data(), HASH_CHUNK_SIZE)) > 0) {
+        cryptoHash.addData(QByteArray::fromRawData(chunk.data(), static_cast<int>(bytesRead)));
+    }
+    if (bytesRead < 0) {
+        return false;
+    }
 
-    buffer = cryptoHash.result();
+    QByteArray buffer = cryptoHash.result();
     std::memcpy(m_key.data(), buffer.data(), std::min(SHA256_SIZE, buffer.size()));
     Botan::secure_scrub_memory(buffer.data(), static_cast<std::size_t>(buffer.capacity()));
 
@@ -57,6 +57,7 @@ public:
 
 private:
     static constexpr int SHA256_SIZE = 32;
+    static constexpr int HASH_CHUNK_SIZE = 1024 * 1024;
 
     bool loadXml(QIODevice* device, QString* errorMsg = nullptr);
     bool loadBinary(QIODevice* device);
@@ -75,8 +75,10 @@ bool YubiKey::findValidKeys()
 {
     QMutexLocker lock(&s_interfaceMutex);
 
+    // The USB and PCSC interfaces share no state, scan both buses at the same time
+    auto pcscKeys = QtConcurrent::run([] { return YubiKeyInterfacePCSC::instance()->findValidKeys(); });
     m_usbKeys = YubiKeyInterfaceUSB::instance()->findValidKeys();
-    m_pcscKeys = YubiKeyInterfacePCSC::instance()->findValidKeys();
+    m_pcscKeys = pcscKeys.result();
 
     return !m_usbKeys.isEmpty() || !m_pcscKeys.isEmpty();
 }
@@ -57,9 +57,23 @@ namespace
         return serial;
     }
 
-    YK_KEY* openKeySerial(unsigned int serial)
+    YK_KEY* openKeySerial(unsigned int serial, int indexHint = -1)
     {
+        // Try the index the key was found at during the last scan before enumerating the bus
+        if (indexHint >= 0 && serial != 0) {
+            auto* yk_key = openKey(indexHint);
+            if (yk_key) {
+                if (getSerial(yk_key) == serial) {
+                    return yk_key;
+                }
+                closeKey(yk_key);
+            }
+        }
+
         for (int i = 0; i < MAX_KEYS; ++i) {
+            if (i == indexHint) {
+                continue;
+            }
             auto* yk_key = openKey(i);
             if (yk_key) {
                 // If the provided serial number is 0, or the key matches the serial, return it
@@ -113,6 +127,7 @@ YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys()
     }
 
     YubiKey::KeyMap keyMap;
+    m_keyIndexes.clear();
 
     // Try to detect up to 4 connected hardware keys
     for (int i = 0; i < MAX_KEYS; ++i) {
@@ -123,6 +138,7 @@ YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys()
                 closeKey(yk_key);
                 continue;
             }
+            m_keyIndexes.insert(serial, i);
 
             auto st = ykds_alloc();
             yk_get_status(yk_key, st);
@@ -188,7 +204,7 @@ YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys()
 bool YubiKeyInterfaceUSB::testChallenge(YubiKeySlot slot, bool* wouldBlock)
 {
     bool ret = false;
-    auto* yk_key = openKeySerial(slot.first);
+    auto* yk_key = openKeySerial(slot.first, m_keyIndexes.value(slot.first, -1));
     if (yk_key) {
         ret = performTestChallenge(yk_key, slot.second, wouldBlock);
     }
@@ -228,7 +244,7 @@ YubiKeyInterfaceUSB::challenge(YubiKeySlot slot, const QByteArray& challenge, Bo
         return YubiKey::ChallengeResult::YCR_ERROR;
     }
 
-    auto* yk_key = openKeySerial(slot.first);
+    auto* yk_key = openKeySerial(slot.first, m_keyIndexes.value(slot.first, -1));
     if (!yk_key) {
         // Key with specified serial number is not connected
         m_error =
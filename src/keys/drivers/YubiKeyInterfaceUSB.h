@@ -54,6 +54,9 @@ private:
                                               Botan::secure_vector<char>& response) override;
     bool performTestChallenge(void* key, int slot, bool* wouldBlock) override;
 
+    // Device index of each serial number seen during the last scan
+    QHash<unsigned int, int> m_keyIndexes;
+
     // This map provides display names for the various USB PIDs of the Yubikeys
     const QHash<int, QString> m_pid_names = {{YUBIKEY_PID, "YubiKey %ver"},
                                              {NEO_OTP_PID, "YubiKey NEO - OTP"},
@@ -19,11 +19,14 @@
 #include <QCommandLineParser>
 #include <QDir>
 #include <QFile>
+#include <QTimer>
 #include <QWindow>
 
 #include "cli/Utils.h"
 #include "config-keepassx.h"
+#include "core/Bootstrap.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 #include "crypto/Crypto.h"
 #include "gui/Application.h"
 #include "gui/MainWindow.h"
@@ -51,6 +54,7 @@ Q_IMPORT_PLUGIN(QXcbIntegrationPlugin)
 int main(int argc, char** argv)
 {
     QT_REQUIRE_VERSION(argc, argv, QT_VERSION_STR)
+    Bootstrap::logStartupPhase("main");
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
@@ -65,6 +69,7 @@ int main(int argc, char** argv)
     Application::setApplicationName("KeePassXC");
     Application::setApplicationVersion(KEEPASSXC_VERSION);
     app.setProperty("KPXC_QUALIFIED_APPNAME", "org.keepassxc.KeePassXC");
+    Bootstrap::logStartupPhase("application");
 
     QCommandLineParser parser;
     parser.setApplicationDescription(QObject::tr("KeePassXC - cross-platform password manager"));
@@ -90,6 +95,11 @@ int main(int argc, char** argv)
     parser.addOption(pwstdinOption);
     parser.addOption(debugInfoOption);
     parser.addOption(allowScreenCaptureOption);
+#ifdef WITH_XC_TRACING
+    QCommandLineOption traceOption(
+        "trace", QObject::tr("write a trace of where time goes to a Chrome trace JSON file"), "file");
+    parser.addOption(traceOption);
+#endif
 
     parser.process(app);
 
@@ -161,6 +171,12 @@ int main(int argc, char** argv)
         return EXIT_SUCCESS;
     }
 
+#ifdef WITH_XC_TRACING
+    if (parser.isSet(traceOption)) {
+        Trace::start(parser.value(traceOption));
+    }
+#endif
+
     if (!Crypto::init()) {
         QString error = QObject::tr("Fatal error while testing the cryptographic functions.");
         error.append("\n");
@@ -168,17 +184,21 @@ int main(int argc, char** argv)
         MessageBox::critical(nullptr, QObject::tr("KeePassXC - Error"), error);
         return EXIT_FAILURE;
     }
+    Bootstrap::logStartupPhase("crypto");
 
     // Apply the configured theme before creating any GUI elements
     app.applyTheme();
+    Bootstrap::logStartupPhase("theme");
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
     QGuiApplication::setDesktopFileName(app.property("KPXC_QUALIFIED_APPNAME").toString() + QStringLiteral(".desktop"));
 #endif
 
     Application::bootstrap(config()->get(Config::GUI_Language).toString());
+    Bootstrap::logStartupPhase("bootstrap");
 
     MainWindow mainWindow;
+    Bootstrap::logStartupPhase("main window");
 #ifdef Q_OS_WIN
     // Qt Hack - Prevent white flicker when showing window
     mainWindow.setProperty("windowOpacity", 0.0);
@@ -203,6 +223,7 @@ int main(int argc, char** argv)
         }
         mainWindow.openDatabase(filename, password, parser.value(keyfileOption));
     }
+    Bootstrap::logStartupPhase("databases");
 
     // start minimized if configured
     if (config()->get(Config::GUI_MinimizeOnStartup).toBool()) {
@@ -212,8 +233,16 @@ int main(int argc, char** argv)
         Application::processEvents();
     }
 
+    QTimer::singleShot(0, [] { Bootstrap::logStartupPhase("event loop"); });
     int exitCode = Application::exec();
 
+#ifdef WITH_XC_TRACING
+    QString traceError;
+    if (!Trace::stop(&traceError)) {
+        qWarning("Could not write the trace: %s", qPrintable(traceError));
+    }
+#endif
+
     // Check if restart was requested
     if (exitCode == RESTART_EXITCODE) {
         QProcess::startDetached(QCoreApplication::applicationFilePath(), {});
@@ -81,6 +81,11 @@ void NativeMessagingProxy::setupStandardInput()
     });
 }
 
+/**
+ * Relay a browser message to KeePassXC as it is. The browser only speaks JSON and the
+ * payload is already encrypted and base64 encoded by the extension, so a binary encoding
+ * on the socket would add a conversion here without making the messages smaller.
+ */
 void NativeMessagingProxy::transferStdinMessage(const QString& msg)
 {
     if (m_localSocket && m_localSocket->state() == QLocalSocket::ConnectedState) {
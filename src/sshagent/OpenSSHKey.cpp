@@ -65,6 +65,22 @@ OpenSSHKey::OpenSSHKey(const OpenSSHKey& other)
 {
 }
 
+OpenSSHKey& OpenSSHKey::operator=(const OpenSSHKey& other)
+{
+    m_check = other.m_check;
+    m_type = other.m_type;
+    m_cipherName = other.m_cipherName;
+    m_kdfName = other.m_kdfName;
+    m_kdfOptions = other.m_kdfOptions;
+    m_rawType = other.m_rawType;
+    m_rawData = other.m_rawData;
+    m_rawPublicData = other.m_rawPublicData;
+    m_rawPrivateData = other.m_rawPrivateData;
+    m_comment = other.m_comment;
+    m_error = other.m_error;
+    return *this;
+}
+
 bool OpenSSHKey::operator==(const OpenSSHKey& other) const
 {
     // close enough for now
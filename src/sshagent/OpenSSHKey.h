@@ -30,6 +30,7 @@ class OpenSSHKey : public QObject
 public:
     explicit OpenSSHKey(QObject* parent = nullptr);
     OpenSSHKey(const OpenSSHKey& other);
+    OpenSSHKey& operator=(const OpenSSHKey& other);
     bool operator==(const OpenSSHKey& other) const;
 
     bool parsePKCS1PEM(const QByteArray& in);
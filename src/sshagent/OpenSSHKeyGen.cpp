@@ -17,7 +17,11 @@
 
 #include "OpenSSHKeyGen.h"
 #include "BinaryStream.h"
+#include "KeeAgentSettings.h"
 #include "OpenSSHKey.h"
+#include "core/AsyncTask.h"
+#include "core/Database.h"
+#include "core/Entry.h"
 #include "crypto/Random.h"
 
 #include <botan/ecdsa.h>
@@ -46,6 +50,24 @@ namespace OpenSSHKeyGen
             QByteArray ba(reinterpret_cast<const char*>(v.data()), v.size());
             stream.writeString(ba);
         }
+
+        struct KeyRequest
+        {
+            QString type;
+            int bits;
+            QString comment;
+        };
+
+        // Runs on the thread pool
+        QSharedPointer<OpenSSHKey> generateKey(const KeyRequest& request)
+        {
+            auto key = QSharedPointer<OpenSSHKey>::create();
+            if (!generate(*key, request.type, request.bits)) {
+                return {};
+            }
+            key->setComment(request.comment);
+            return key;
+        }
     } // namespace
 
     bool generateRSA(OpenSSHKey& key, int bits)
@@ -138,4 +160,108 @@ namespace OpenSSHKeyGen
             return false;
         }
     }
+
+    /**
+     * Generate a key of the given type, as named in the key generation dialog.
+     *
+     * @param key key to generate into
+     * @param type "Ed25519", "RSA" or "ECDSA"
+     * @param bits key size, ignored for Ed25519
+     * @return true on success
+     */
+    bool generate(OpenSSHKey& key, const QString& type, int bits)
+    {
+        if (type == QStringLiteral("Ed25519")) {
+            return generateEd25519(key);
+        } else if (type == QStringLiteral("RSA")) {
+            return generateRSA(key, bits);
+        } else if (type == QStringLiteral("ECDSA")) {
+            return generateECDSA(key, bits);
+        }
+        return false;
+    }
+
+    /**
+     * Find a free attachment name for a private key, following the OpenSSH
+     * file naming of the key type (id_rsa, id_rsa.1, ...).
+     *
+     * @return attachment name, or an empty string if all names are taken
+     */
+    QString attachmentName(const EntryAttachments* attachments, const QString& keyType)
+    {
+        QString keyPrefix = keyType;
+        if (keyPrefix.startsWith("ecdsa")) {
+            keyPrefix = "id_ecdsa";
+        } else {
+            keyPrefix.replace("ssh-", "id_");
+        }
+
+        for (int i = 0; i < 10; i++) {
+            QString keyName = keyPrefix;
+
+            if (i > 0) {
+                keyName += "." + QString::number(i);
+            }
+
+            if (!attachments->hasKey(keyName)) {
+                return keyName;
+            }
+        }
+
+        return {};
+    }
+
+    /**
+     * Generate a private key for each of the given entries.
+     *
+     * The keys are generated in parallel. Each key is stored as an attachment
+     * of its entry, and the KeeAgent settings of the entry are pointed to it.
+     * All entries are updated in one batch update of their database.
+     *
+     * @param entries entries to provision
+     * @param type "Ed25519", "RSA" or "ECDSA"
+     * @param bits key size, ignored for Ed25519
+     * @param comment key comment
+     * @return number of entries that received a key
+     */
+    int generateForEntries(const QList<Entry*>& entries, const QString& type, int bits, const QString& comment)
+    {
+        if (entries.isEmpty()) {
+            return 0;
+        }
+
+        QList<KeyRequest> requests;
+        for (int i = 0; i < entries.size(); ++i) {
+            requests.append({type, bits, comment});
+        }
+
+        // RSA keys take seconds each, generate them all in parallel while the event loop keeps running
+        const auto keys = AsyncTask::waitForResults(QtConcurrent::mapped(requests, generateKey));
+
+        int generated = 0;
+        Database::BatchUpdate batchUpdate(entries.first()->database());
+        for (int i = 0; i < entries.size(); ++i) {
+            auto* entry = entries.at(i);
+            const auto& key = keys.at(i);
+            if (!key) {
+                continue;
+            }
+
+            const auto name = attachmentName(entry->attachments(), key->type());
+            if (name.isEmpty()) {
+                continue;
+            }
+
+            entry->attachments()->set(name, key->privateKey().toUtf8());
+
+            KeeAgentSettings settings;
+            settings.fromEntry(entry);
+            settings.setSelectedType("attachment");
+            settings.setAttachmentName(name);
+            settings.toEntry(entry);
+            ++generated;
+        }
+
+        return generated;
+    }
 } // namespace OpenSSHKeyGen
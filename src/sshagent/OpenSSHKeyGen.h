@@ -18,6 +18,11 @@
 #ifndef KEEPASSXC_OPENSSHKEYGEN_H
 #define KEEPASSXC_OPENSSHKEYGEN_H
 
+#include <QList>
+#include <QString>
+
+class Entry;
+class EntryAttachments;
 class OpenSSHKey;
 
 namespace OpenSSHKeyGen
@@ -25,6 +30,10 @@ namespace OpenSSHKeyGen
     bool generateRSA(OpenSSHKey& key, int bits);
     bool generateECDSA(OpenSSHKey& key, int bits);
     bool generateEd25519(OpenSSHKey& key);
+    bool generate(OpenSSHKey& key, const QString& type, int bits);
+
+    QString attachmentName(const EntryAttachments* attachments, const QString& keyType);
+    int generateForEntries(const QList<Entry*>& entries, const QString& type, int bits, const QString& comment);
 } // namespace OpenSSHKeyGen
 
 #endif
@@ -18,9 +18,11 @@
 #include "OpenSSHKeyGenDialog.h"
 #include "OpenSSHKey.h"
 #include "OpenSSHKeyGen.h"
+#include "core/AsyncTask.h"
 #include "gui/Icons.h"
 #include "ui_OpenSSHKeyGenDialog.h"
 #include <QHostInfo>
+#include <QPushButton>
 #include <QProcessEnvironment>
 
 OpenSSHKeyGenDialog::OpenSSHKeyGenDialog(QWidget* parent)
@@ -72,25 +74,50 @@ void OpenSSHKeyGenDialog::typeChanged()
 
 void OpenSSHKeyGenDialog::accept()
 {
-    // disable form and try to process this update before blocking in key generation
-    setEnabled(false);
-    QCoreApplication::processEvents();
-
-    int bits = m_ui->bitsComboBox->currentText().toInt();
-
-    if (m_ui->typeComboBox->currentText() == QString("Ed25519")) {
-        OpenSSHKeyGen::generateEd25519(*m_key);
-    } else if (m_ui->typeComboBox->currentText() == QString("RSA")) {
-        OpenSSHKeyGen::generateRSA(*m_key, bits);
-    } else if (m_ui->typeComboBox->currentText() == QString("ECDSA")) {
-        OpenSSHKeyGen::generateECDSA(*m_key, bits);
-    } else {
-        reject();
+    if (m_generating) {
         return;
     }
 
-    m_key->setComment(m_ui->commentLineEdit->text());
-    QDialog::accept();
+    // Generating a large RSA key takes seconds, keep the dialog responsive and cancelable meanwhile
+    m_generating = true;
+    m_generateToken = {};
+    m_ui->typeComboBox->setEnabled(false);
+    m_ui->bitsComboBox->setEnabled(false);
+    m_ui->commentLineEdit->setEnabled(false);
+    m_ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
+
+    const auto type = m_ui->typeComboBox->currentText();
+    const auto bits = m_ui->bitsComboBox->currentText().toInt();
+    const auto comment = m_ui->commentLineEdit->text();
+
+    AsyncTask::runThenCallback(
+        [type, bits] {
+            auto key = QSharedPointer<OpenSSHKey>::create();
+            return OpenSSHKeyGen::generate(*key, type, bits) ? key : QSharedPointer<OpenSSHKey>();
+        },
+        this,
+        [this, comment](const QSharedPointer<OpenSSHKey>& key) {
+            m_generating = false;
+
+            if (!key) {
+                reject();
+                return;
+            }
+
+            *m_key = *key;
+            m_key->setComment(comment);
+            QDialog::accept();
+        },
+        AsyncTask::Priority::Visible,
+        m_generateToken);
+}
+
+void OpenSSHKeyGenDialog::reject()
+{
+    // Key generation cannot be interrupted, its result is discarded
+    m_generating = false;
+    m_generateToken.cancel();
+    QDialog::reject();
 }
 
 void OpenSSHKeyGenDialog::setKey(OpenSSHKey* key)
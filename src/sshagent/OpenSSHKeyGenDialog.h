@@ -19,6 +19,9 @@
 #define KEEPASSXC_OPENSSHKEYGENDIALOG_H
 
 #include <QDialog>
+
+#include "core/AsyncTask.h"
+
 class OpenSSHKey;
 
 namespace Ui
@@ -35,6 +38,7 @@ public:
     ~OpenSSHKeyGenDialog() override;
 
     void accept() override;
+    void reject() override;
     void setKey(OpenSSHKey* key);
 
 private slots:
@@ -43,6 +47,8 @@ private slots:
 private:
     QScopedPointer<Ui::OpenSSHKeyGenDialog> m_ui;
     OpenSSHKey* m_key;
+    bool m_generating = false;
+    AsyncTask::CancelToken m_generateToken;
 };
 
 #endif // KEEPASSXC_OPENSSHKEYGENDIALOG_H
@@ -18,9 +18,12 @@
 
 #include "SSHAgent.h"
 
+#include "core/AsyncTask.h"
 #include "core/Config.h"
+#include "core/EntryAttachments.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/Trace.h"
 #include "sshagent/BinaryStream.h"
 #include "sshagent/KeeAgentSettings.h"
 
@@ -28,6 +31,8 @@
 #include <QLocalSocket>
 #include <QThread>
 
+#include <algorithm>
+
 #ifdef Q_OS_WIN
 #include <QtEndian>
 #include <windows.h>
@@ -35,11 +40,61 @@
 
 Q_GLOBAL_STATIC(SSHAgent, s_sshAgent);
 
+namespace
+{
+    struct KeyToLoad
+    {
+        KeeAgentSettings settings;
+        QString username;
+        QString password;
+        QString databasePath;
+        QSharedPointer<EntryAttachments> attachments;
+    };
+
+    struct LoadedKey
+    {
+        bool loaded = false;
+        OpenSSHKey key;
+        KeeAgentSettings settings;
+    };
+
+    // Runs on the thread pool, only touches the snapshot taken in databaseUnlocked()
+    LoadedKey loadKey(const KeyToLoad& keyToLoad)
+    {
+        LoadedKey result;
+        result.settings = keyToLoad.settings;
+        result.loaded = result.settings.toOpenSSHKey(keyToLoad.username,
+                                                     keyToLoad.password,
+                                                     keyToLoad.databasePath,
+                                                     keyToLoad.attachments.data(),
+                                                     result.key,
+                                                     true);
+        return result;
+    }
+
+    /**
+     * Sort key giving the order of Group::entriesRecursive(): the entries of a
+     * group come before those of its child groups.
+     */
+    QList<int> treePosition(const Entry* entry)
+    {
+        const Group* group = entry->group();
+        QList<int> position{-1, group->entries().indexOf(const_cast<Entry*>(entry))};
+        while (group->parentGroup()) {
+            position.prepend(group->parentGroup()->children().indexOf(const_cast<Group*>(group)));
+            group = group->parentGroup();
+        }
+        return position;
+    }
+} // namespace
+
 SSHAgent* SSHAgent::instance()
 {
     return s_sshAgent;
 }
 
+SSHAgent::~SSHAgent() = default;
+
 bool SSHAgent::isEnabled() const
 {
     return config()->get(Config::SSHAgent_Enabled).toBool();
@@ -159,40 +214,99 @@ bool SSHAgent::isAgentRunning() const
 
 bool SSHAgent::sendMessage(const QByteArray& in, QByteArray& out)
 {
-#ifdef Q_OS_WIN
-    if (usePageant() && !sendMessagePageant(in, out)) {
+    QList<QByteArray> responses;
+    if (!sendMessages({in}, responses)) {
         return false;
     }
-    if (useOpenSSH() && !sendMessageOpenSSH(in, out)) {
-        return false;
+    out = responses.first();
+    return true;
+}
+
+/**
+ * Send several requests to the agent and collect the responses in order.
+ * Over an OpenSSH connection all requests are written before reading the responses.
+ */
+bool SSHAgent::sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out)
+{
+    TRACE_SCOPE("SSHAgent::sendMessages");
+    TRACE_COUNTER("SSH agent requests", in.size());
+#ifdef Q_OS_WIN
+    QList<QByteArray> responses;
+    if (usePageant()) {
+        for (const auto& message : in) {
+            QByteArray response;
+            if (!sendMessagePageant(message, response)) {
+                return false;
+            }
+            responses << response;
+        }
     }
+    if (useOpenSSH()) {
+        responses.clear();
+        if (!sendMessagesOpenSSH(in, responses)) {
+            return false;
+        }
+    }
+    out = responses;
     return true;
 #else
-    return sendMessageOpenSSH(in, out);
+    return sendMessagesOpenSSH(in, out);
 #endif
 }
 
-bool SSHAgent::sendMessageOpenSSH(const QByteArray& in, QByteArray& out)
+bool SSHAgent::connectAgent()
 {
-    QLocalSocket socket;
-    BinaryStream stream(&socket);
+    if (m_socket && m_socket->state() == QLocalSocket::ConnectedState && m_socket->serverName() == socketPath()) {
+        return true;
+    }
 
-    socket.connectToServer(socketPath());
-    if (!socket.waitForConnected(500)) {
+    m_socket.reset(new QLocalSocket());
+    m_socket->connectToServer(socketPath());
+    if (!m_socket->waitForConnected(500)) {
         m_error = tr("Agent connection failed.");
+        m_socket.reset();
         return false;
     }
+    return true;
+}
 
-    stream.writeString(in);
-    stream.flush();
+bool SSHAgent::sendMessagesOpenSSH(const QList<QByteArray>& in, QList<QByteArray>& out)
+{
+    // The agent may have closed a connection we kept open, so retry once on a fresh one
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = m_socket && m_socket->state() == QLocalSocket::ConnectedState;
+        if (!connectAgent()) {
+            return false;
+        }
 
-    if (!stream.readString(out)) {
-        m_error = tr("Agent protocol error.");
-        return false;
+        BinaryStream stream(m_socket.data());
+        bool ok = true;
+        for (const auto& message : in) {
+            ok = ok && stream.writeString(message);
+        }
+        ok = ok && stream.flush();
+
+        QList<QByteArray> responses;
+        for (int i = 0; ok && i < in.size(); ++i) {
+            QByteArray response;
+            ok = stream.readString(response);
+            responses << response;
+        }
+
+        if (ok) {
+            out = responses;
+            return true;
+        }
+
+        // never reuse a connection that may still hold part of a response
+        m_socket.reset();
+        if (!reused) {
+            break;
+        }
     }
 
-    socket.close();
-    return true;
+    m_error = tr("Agent protocol error.");
+    return false;
 }
 
 #ifdef Q_OS_WIN
@@ -280,6 +394,16 @@ bool SSHAgent::addIdentity(OpenSSHKey& key, const KeeAgentSettings& settings, co
         return false;
     }
 
+    QByteArray responseData;
+    if (!sendMessage(addIdentityRequest(key, settings), responseData)) {
+        return false;
+    }
+
+    return addIdentityResponse(responseData, key, settings, databaseUuid);
+}
+
+QByteArray SSHAgent::addIdentityRequest(OpenSSHKey& key, const KeeAgentSettings& settings) const
+{
     QByteArray requestData;
     BinaryStream request(&requestData);
     bool isSecurityKey = key.type().startsWith("sk-");
@@ -305,10 +429,15 @@ bool SSHAgent::addIdentity(OpenSSHKey& key, const KeeAgentSettings& settings, co
         request.writeString(securityKeyProvider());
     }
 
-    QByteArray responseData;
-    if (!sendMessage(requestData, responseData)) {
-        return false;
-    }
+    return requestData;
+}
+
+bool SSHAgent::addIdentityResponse(const QByteArray& responseData,
+                                   const OpenSSHKey& key,
+                                   const KeeAgentSettings& settings,
+                                   const QUuid& databaseUuid)
+{
+    bool isSecurityKey = key.type().startsWith("sk-");
 
     if (responseData.length() < 1 || static_cast<quint8>(responseData[0]) != SSH_AGENT_SUCCESS) {
         m_error =
@@ -349,6 +478,12 @@ bool SSHAgent::removeIdentity(OpenSSHKey& key)
         return false;
     }
 
+    QByteArray responseData;
+    return sendMessage(removeIdentityRequest(key), responseData);
+}
+
+QByteArray SSHAgent::removeIdentityRequest(OpenSSHKey& key) const
+{
     QByteArray requestData;
     BinaryStream request(&requestData);
 
@@ -359,8 +494,7 @@ bool SSHAgent::removeIdentity(OpenSSHKey& key)
     request.write(SSH_AGENTC_REMOVE_IDENTITY);
     request.writeString(keyData);
 
-    QByteArray responseData;
-    return sendMessage(requestData, responseData);
+    return requestData;
 }
 
 /**
@@ -492,6 +626,9 @@ void SSHAgent::databaseLocked(QSharedPointer<Database> db)
         return;
     }
 
+    m_unlockingDatabases.remove(db->uuid());
+
+    QList<QByteArray> requests;
     auto it = m_addedKeys.begin();
     while (it != m_addedKeys.end()) {
         if (it.value().first != db->uuid()) {
@@ -500,12 +637,21 @@ void SSHAgent::databaseLocked(QSharedPointer<Database> db)
         }
         OpenSSHKey key = it.key();
         if (it.value().second) {
-            if (!removeIdentity(key)) {
-                emit error(m_error);
-            }
+            requests << removeIdentityRequest(key);
         }
         it = m_addedKeys.erase(it);
     }
+
+    if (requests.isEmpty()) {
+        return;
+    }
+    QList<QByteArray> responses;
+    if (!isAgentRunning()) {
+        m_error = tr("No agent running, cannot remove identity.");
+        emit error(m_error);
+    } else if (!sendMessages(requests, responses)) {
+        emit error(m_error);
+    }
 }
 
 void SSHAgent::databaseUnlocked(QSharedPointer<Database> db)
@@ -514,30 +660,128 @@ void SSHAgent::databaseUnlocked(QSharedPointer<Database> db)
         return;
     }
 
-    for (Entry* e : db->rootGroup()->entriesRecursive()) {
+    struct PendingIdentity
+    {
+        OpenSSHKey key;
+        KeeAgentSettings settings;
+        bool known;
+    };
+    QList<PendingIdentity> pending;
+    QList<QByteArray> requests;
+
+    // List the agent's identities once instead of asking about every key
+    bool listed = false;
+    QSet<OpenSSHKey> agentKeys;
+
+    // Only entries with KeeAgent settings can hold a key, visit them in tree order
+    // as the agent offers keys in the order they were added
+    QList<QPair<QList<int>, const Entry*>> sshKeyEntries;
+    for (const auto* e : db->sshKeyEntries()) {
+        sshKeyEntries.append(qMakePair(treePosition(e), e));
+    }
+    std::sort(sshKeyEntries.begin(), sshKeyEntries.end());
+
+    QList<KeyToLoad> keysToLoad;
+    for (const auto& sshKeyEntry : asConst(sshKeyEntries)) {
+        const Entry* e = sshKeyEntry.second;
         if (db->metadata()->recycleBinEnabled() && e->group() == db->metadata()->recycleBin()) {
             continue;
         }
 
-        KeeAgentSettings settings;
+        KeyToLoad keyToLoad;
 
-        if (!settings.fromEntry(e)) {
+        if (!keyToLoad.settings.fromEntry(e)) {
             continue;
         }
 
-        if (!settings.allowUseOfSshKey() || !settings.addAtDatabaseOpen()) {
+        if (!keyToLoad.settings.allowUseOfSshKey() || !keyToLoad.settings.addAtDatabaseOpen()) {
             continue;
         }
 
-        OpenSSHKey key;
+        // Take what the key is read from now, the entry may change while the keys are decrypted
+        keyToLoad.username = e->username();
+        keyToLoad.password = e->password();
+        keyToLoad.databasePath = db->filePath();
+        keyToLoad.attachments.reset(new EntryAttachments());
+        const auto attachmentName = keyToLoad.settings.attachmentName();
+        if (e->attachments()->hasKey(attachmentName)) {
+            keyToLoad.attachments->set(attachmentName, e->attachments()->value(attachmentName));
+        }
+        keysToLoad << keyToLoad;
+    }
+
+    if (keysToLoad.isEmpty()) {
+        return;
+    }
 
-        if (!settings.toOpenSSHKey(e, key, true)) {
+    // Decrypting a key runs its KDF, do them all in parallel while the event loop keeps running
+    const auto databaseUuid = db->uuid();
+    m_unlockingDatabases.insert(databaseUuid);
+    const auto loadedKeys = AsyncTask::waitForResults(QtConcurrent::mapped(keysToLoad, loadKey));
+    if (!m_unlockingDatabases.remove(databaseUuid)) {
+        // locked again while we were waiting
+        return;
+    }
+
+    for (const auto& loadedKey : loadedKeys) {
+        if (!loadedKey.loaded) {
             continue;
         }
+        const auto& key = loadedKey.key;
+        const auto& settings = loadedKey.settings;
 
         // Add key to agent; ignore errors if we have previously added the key
         bool known_key = m_addedKeys.contains(key);
-        if (!addIdentity(key, settings, db->uuid()) && !known_key) {
+        if (known_key && m_addedKeys[key].first != db->uuid()) {
+            // ownership conflict, addIdentity refuses these as well
+            continue;
+        }
+
+        if (!listed) {
+            listed = true;
+            QList<QSharedPointer<OpenSSHKey>> list;
+            if (!isAgentRunning()) {
+                m_error = tr("No agent running, cannot add identity.");
+                emit error(m_error);
+                return;
+            }
+            if (!listIdentities(list)) {
+                emit error(m_error);
+                return;
+            }
+            for (const auto& loaded : asConst(list)) {
+                agentKeys.insert(*loaded);
+            }
+        }
+
+        // Constraints only apply when adding, so only plain keys already in the agent can be skipped
+        bool constrained = settings.useLifetimeConstraintWhenAdding() || settings.useConfirmConstraintWhenAdding()
+                           || key.type().startsWith("sk-");
+        if (!constrained && agentKeys.contains(key)) {
+            OpenSSHKey keyCopy = key;
+            keyCopy.clearPrivate();
+            m_addedKeys[keyCopy] = qMakePair(db->uuid(), settings.removeAtDatabaseClose());
+            continue;
+        }
+
+        OpenSSHKey keyCopy = key;
+        requests << addIdentityRequest(keyCopy, settings);
+        pending.append({key, settings, known_key});
+    }
+
+    if (requests.isEmpty()) {
+        return;
+    }
+
+    // Pipeline all additions over the agent connection
+    QList<QByteArray> responses;
+    if (!sendMessages(requests, responses)) {
+        emit error(m_error);
+        return;
+    }
+    for (int i = 0; i < pending.size(); ++i) {
+        const auto& identity = pending.at(i);
+        if (!addIdentityResponse(responses.at(i), identity.key, identity.settings, db->uuid()) && !identity.known) {
             emit error(m_error);
         }
     }
@@ -20,18 +20,21 @@
 #define KEEPASSXC_SSHAGENT_H
 
 #include <QHash>
+#include <QScopedPointer>
+#include <QSet>
 
 #include "OpenSSHKey.h"
 
 class KeeAgentSettings;
 class Database;
+class QLocalSocket;
 
 class SSHAgent : public QObject
 {
     Q_OBJECT
 
 public:
-    ~SSHAgent() override = default;
+    ~SSHAgent() override;
     static SSHAgent* instance();
 
     bool isEnabled() const;
@@ -79,8 +82,17 @@ private:
     const quint8 SSH_AGENT_CONSTRAIN_CONFIRM = 2;
     const quint8 SSH_AGENT_CONSTRAIN_EXTENSION = 255;
 
+    QByteArray addIdentityRequest(OpenSSHKey& key, const KeeAgentSettings& settings) const;
+    bool addIdentityResponse(const QByteArray& responseData,
+                             const OpenSSHKey& key,
+                             const KeeAgentSettings& settings,
+                             const QUuid& databaseUuid);
+    QByteArray removeIdentityRequest(OpenSSHKey& key) const;
+
     bool sendMessage(const QByteArray& in, QByteArray& out);
-    bool sendMessageOpenSSH(const QByteArray& in, QByteArray& out);
+    bool sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out);
+    bool sendMessagesOpenSSH(const QList<QByteArray>& in, QList<QByteArray>& out);
+    bool connectAgent();
 #ifdef Q_OS_WIN
     bool sendMessagePageant(const QByteArray& in, QByteArray& out);
 
@@ -90,6 +102,10 @@ private:
 
     QHash<OpenSSHKey, QPair<QUuid, bool>> m_addedKeys;
     QString m_error;
+    // Kept open between messages, the agent serves any number of requests per connection
+    QScopedPointer<QLocalSocket> m_socket;
+    // Databases whose keys are being decrypted by databaseUnlocked()
+    QSet<QUuid> m_unlockingDatabases;
 };
 
 static inline SSHAgent* sshAgent()
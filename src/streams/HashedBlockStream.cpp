@@ -17,7 +17,11 @@
 
 #include "HashedBlockStream.h"
 
+#include <QThread>
+#include <QtConcurrent>
+
 #include "core/Endian.h"
+#include "core/Global.h"
 #include "crypto/CryptoHash.h"
 
 const QSysInfo::Endian HashedBlockStream::ByteOrder = QSysInfo::LittleEndian;
@@ -48,6 +52,30 @@ void HashedBlockStream::init()
     m_blockIndex = 0;
     m_eof = false;
     m_error = false;
+    m_readAhead.clear();
+    m_readAheadError.clear();
+    m_pendingBlocks.clear();
+}
+
+/**
+ * Set how many blocks are read ahead (or buffered for writing) and
+ * have their hashes computed concurrently. A count of 1 processes
+ * blocks one at a time. Each pending block keeps up to one full
+ * block of data in memory.
+ */
+void HashedBlockStream::setParallelBlocks(int count)
+{
+    m_parallelBlocks = qMax(1, count);
+}
+
+int HashedBlockStream::parallelBlocks() const
+{
+    return m_parallelBlocks;
+}
+
+int HashedBlockStream::suggestedParallelBlocks()
+{
+    return qBound(1, QThread::idealThreadCount(), 4);
 }
 
 bool HashedBlockStream::reset()
@@ -122,61 +150,120 @@ qint64 HashedBlockStream::readData(char* data, qint64 maxSize)
     return maxSize;
 }
 
-bool HashedBlockStream::readHashedBlock()
+bool HashedBlockStream::readChunk(QByteArray& chunk)
 {
-    bool ok;
-
-    auto index = Endian::readSizedInt<quint32>(m_baseDevice, ByteOrder, &ok);
-    if (!ok || index != m_blockIndex) {
-        m_error = true;
-        setErrorString("Invalid block index.");
+    chunk.clear();
+    if (m_error) {
         return false;
+    } else if (m_eof) {
+        return true;
     }
 
-    QByteArray hash = m_baseDevice->read(32);
-    if (hash.size() != 32) {
-        m_error = true;
-        setErrorString("Invalid hash size.");
-        return false;
+    if (m_bufferPos == m_buffer.size() && !readHashedBlock()) {
+        return !m_error;
     }
 
-    m_blockSize = Endian::readSizedInt<qint32>(m_baseDevice, ByteOrder, &ok);
-    if (!ok || m_blockSize < 0) {
-        m_error = true;
-        setErrorString("Invalid block size.");
-        return false;
+    if (m_bufferPos == 0) {
+        chunk.swap(m_buffer);
+    } else {
+        chunk = m_buffer.mid(m_bufferPos);
+        m_buffer.clear();
     }
+    m_bufferPos = 0;
+    return true;
+}
 
-    if (m_blockSize == 0) {
-        if (hash.count('\0') != 32) {
-            m_error = true;
-            setErrorString("Invalid hash of final block.");
-            return false;
-        }
-
-        m_eof = true;
+bool HashedBlockStream::readHashedBlock()
+{
+    if (m_eof) {
         return false;
     }
 
-    m_buffer = m_baseDevice->read(m_blockSize);
-    if (m_buffer.size() != m_blockSize) {
-        m_error = true;
-        setErrorString("Block too short.");
-        return false;
+    if (m_readAhead.isEmpty() && m_readAheadError.isEmpty()) {
+        readAheadBlocks();
     }
 
-    if (hash != CryptoHash::hash(m_buffer, CryptoHash::Sha256)) {
+    if (m_readAhead.isEmpty()) {
         m_error = true;
-        setErrorString("Mismatch between hash and data.");
+        setErrorString(m_readAheadError);
         return false;
     }
 
+    m_buffer = m_readAhead.dequeue();
     m_bufferPos = 0;
     m_blockIndex++;
 
+    if (m_buffer.isEmpty()) {
+        m_eof = true;
+        return false;
+    }
+
     return true;
 }
 
+/**
+ * Read up to parallelBlocks() blocks from the base device and verify them.
+ * Blocks preceding the first invalid one are queued for reading; the
+ * error for the invalid block is raised once they have been consumed.
+ */
+void HashedBlockStream::readAheadBlocks()
+{
+    QVector<Block> blocks;
+    quint32 blockIndex = m_blockIndex + static_cast<quint32>(m_readAhead.size());
+
+    while (blocks.size() < m_parallelBlocks) {
+        bool ok;
+
+        Block block;
+        block.index = Endian::readSizedInt<quint32>(m_baseDevice, ByteOrder, &ok);
+        if (!ok || block.index != blockIndex++) {
+            m_readAheadError = "Invalid block index.";
+            break;
+        }
+
+        block.hash = m_baseDevice->read(32);
+        if (block.hash.size() != 32) {
+            m_readAheadError = "Invalid hash size.";
+            break;
+        }
+
+        auto blockSize = Endian::readSizedInt<qint32>(m_baseDevice, ByteOrder, &ok);
+        if (!ok || blockSize < 0) {
+            m_readAheadError = "Invalid block size.";
+            break;
+        }
+
+        if (blockSize == 0) {
+            if (block.hash.count('\0') != 32) {
+                m_readAheadError = "Invalid hash of final block.";
+                break;
+            }
+
+            blocks.append(block);
+            break;
+        }
+
+        block.data = m_baseDevice->read(blockSize);
+        if (block.data.size() != blockSize) {
+            m_readAheadError = "Block too short.";
+            break;
+        }
+
+        blocks.append(block);
+    }
+
+    QVector<Block> expected = blocks;
+    hashBlocks(expected);
+
+    for (int i = 0; i < blocks.size(); ++i) {
+        if (blocks[i].hash != expected[i].hash) {
+            m_readAheadError = "Mismatch between hash and data.";
+            break;
+        }
+        m_readAhead.enqueue(blocks[i].data);
+    }
+}
+
 qint64 HashedBlockStream::writeData(const char* data, qint64 maxSize)
 {
     Q_ASSERT(maxSize >= 0);
@@ -212,45 +299,82 @@ qint64 HashedBlockStream::writeData(const char* data, qint64 maxSize)
 
 bool HashedBlockStream::writeHashedBlock()
 {
-    if (!Endian::writeSizedInt<qint32>(m_blockIndex, m_baseDevice, ByteOrder)) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
+    if (m_error) {
         return false;
     }
-    m_blockIndex++;
 
-    QByteArray hash;
-    if (!m_buffer.isEmpty()) {
-        hash = CryptoHash::hash(m_buffer, CryptoHash::Sha256);
-    } else {
-        hash.fill(0, 32);
-    }
+    Block block;
+    block.index = m_blockIndex++;
+    block.data = m_buffer;
+    m_pendingBlocks.append(block);
+    m_buffer.clear();
 
-    if (m_baseDevice->write(hash) != hash.size()) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
-        return false;
+    // the empty final block always flushes everything before it
+    if (m_pendingBlocks.size() < m_parallelBlocks && !block.data.isEmpty()) {
+        return true;
     }
+    return flushPendingBlocks();
+}
 
-    if (!Endian::writeSizedInt<qint32>(m_buffer.size(), m_baseDevice, ByteOrder)) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
-        return false;
-    }
+bool HashedBlockStream::flushPendingBlocks()
+{
+    hashBlocks(m_pendingBlocks);
 
-    if (!m_buffer.isEmpty()) {
-        if (m_baseDevice->write(m_buffer) != m_buffer.size()) {
+    for (const Block& block : asConst(m_pendingBlocks)) {
+        if (!Endian::writeSizedInt<qint32>(block.index, m_baseDevice, ByteOrder)) {
             m_error = true;
             setErrorString(m_baseDevice->errorString());
+            m_pendingBlocks.clear();
             return false;
         }
 
-        m_buffer.clear();
+        if (m_baseDevice->write(block.hash) != block.hash.size()) {
+            m_error = true;
+            setErrorString(m_baseDevice->errorString());
+            m_pendingBlocks.clear();
+            return false;
+        }
+
+        if (!Endian::writeSizedInt<qint32>(block.data.size(), m_baseDevice, ByteOrder)) {
+            m_error = true;
+            setErrorString(m_baseDevice->errorString());
+            m_pendingBlocks.clear();
+            return false;
+        }
+
+        if (!block.data.isEmpty() && m_baseDevice->write(block.data) != block.data.size()) {
+            m_error = true;
+            setErrorString(m_baseDevice->errorString());
+            m_pendingBlocks.clear();
+            return false;
+        }
     }
 
+    m_pendingBlocks.clear();
     return true;
 }
 
+/**
+ * Compute the SHA-256 of each block, in parallel when there is more than one.
+ * The empty final block has an all-zero hash.
+ */
+void HashedBlockStream::hashBlocks(QVector<Block>& blocks) const
+{
+    auto hashBlock = [](Block& block) {
+        if (block.data.isEmpty()) {
+            block.hash.fill(0, 32);
+        } else {
+            block.hash = CryptoHash::hash(block.data, CryptoHash::Sha256);
+        }
+    };
+
+    if (blocks.size() > 1) {
+        QtConcurrent::blockingMap(blocks, hashBlock);
+    } else if (!blocks.isEmpty()) {
+        hashBlock(blocks.first());
+    }
+}
+
 bool HashedBlockStream::atEnd() const
 {
     return m_eof;
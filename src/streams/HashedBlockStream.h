@@ -18,7 +18,9 @@
 #ifndef KEEPASSX_HASHEDBLOCKSTREAM_H
 #define KEEPASSX_HASHEDBLOCKSTREAM_H
 
+#include <QQueue>
 #include <QSysInfo>
+#include <QVector>
 
 #include "streams/LayeredStream.h"
 
@@ -34,16 +36,32 @@ public:
     bool reset() override;
     void close() override;
 
+    static int suggestedParallelBlocks();
+
+    void setParallelBlocks(int count);
+    int parallelBlocks() const;
+
     bool atEnd() const override;
+    bool readChunk(QByteArray& chunk) override;
 
 protected:
     qint64 readData(char* data, qint64 maxSize) override;
     qint64 writeData(const char* data, qint64 maxSize) override;
 
 private:
+    struct Block
+    {
+        quint32 index;
+        QByteArray hash;
+        QByteArray data;
+    };
+
     void init();
     bool readHashedBlock();
+    void readAheadBlocks();
     bool writeHashedBlock();
+    bool flushPendingBlocks();
+    void hashBlocks(QVector<Block>& blocks) const;
 
     static const QSysInfo::Endian ByteOrder;
     qint32 m_blockSize;
@@ -52,6 +70,10 @@ private:
     quint32 m_blockIndex;
     bool m_eof;
     bool m_error;
+    int m_parallelBlocks = 1;
+    QQueue<QByteArray> m_readAhead;
+    QString m_readAheadError;
+    QVector<Block> m_pendingBlocks;
 };
 
 #endif // KEEPASSX_HASHEDBLOCKSTREAM_H
@@ -17,7 +17,11 @@
 
 #include "HmacBlockStream.h"
 
+#include <QThread>
+#include <QtConcurrent>
+
 #include "core/Endian.h"
+#include "core/Global.h"
 #include "crypto/CryptoHash.h"
 
 const QSysInfo::Endian HmacBlockStream::ByteOrder = QSysInfo::LittleEndian;
@@ -50,6 +54,30 @@ void HmacBlockStream::init()
     m_blockIndex = 0;
     m_eof = false;
     m_error = false;
+    m_readAhead.clear();
+    m_readAheadError.clear();
+    m_pendingBlocks.clear();
+}
+
+/**
+ * Set how many blocks are read ahead (or buffered for writing) and
+ * have their HMACs computed concurrently. A count of 1 processes
+ * blocks one at a time. Each pending block keeps up to one full
+ * block of data in memory.
+ */
+void HmacBlockStream::setParallelBlocks(int count)
+{
+    m_parallelBlocks = qMax(1, count);
+}
+
+int HmacBlockStream::parallelBlocks() const
+{
+    return m_parallelBlocks;
+}
+
+int HmacBlockStream::suggestedParallelBlocks()
+{
+    return qBound(1, QThread::idealThreadCount(), 4);
 }
 
 bool HmacBlockStream::reset()
@@ -121,54 +149,50 @@ qint64 HmacBlockStream::readData(char* data, qint64 maxSize)
     return maxSize;
 }
 
-bool HmacBlockStream::readHashedBlock()
+bool HmacBlockStream::readChunk(QByteArray& chunk)
 {
-    if (m_eof) {
-        return false;
-    }
-    QByteArray hmac = m_baseDevice->read(32);
-    if (hmac.size() != 32) {
-        m_error = true;
-        setErrorString("Invalid HMAC size.");
+    chunk.clear();
+    if (m_error) {
         return false;
+    } else if (m_eof) {
+        return true;
     }
 
-    QByteArray blockSizeBytes = m_baseDevice->read(4);
-    if (blockSizeBytes.size() != 4) {
-        m_error = true;
-        setErrorString("Invalid block size size.");
-        return false;
+    if (m_bufferPos == m_buffer.size() && !readHashedBlock()) {
+        return !m_error;
     }
-    auto blockSize = Endian::bytesToSizedInt<qint32>(blockSizeBytes, ByteOrder);
-    if (blockSize < 0) {
-        m_error = true;
-        setErrorString("Invalid block size.");
-        return false;
+
+    if (m_bufferPos == 0) {
+        chunk.swap(m_buffer);
+    } else {
+        chunk = m_buffer.mid(m_bufferPos);
+        m_buffer.clear();
     }
+    m_bufferPos = 0;
+    return true;
+}
 
-    m_buffer = m_baseDevice->read(blockSize);
-    if (m_buffer.size() != blockSize) {
-        m_error = true;
-        setErrorString("Block too short.");
+bool HmacBlockStream::readHashedBlock()
+{
+    if (m_eof) {
         return false;
     }
 
-    CryptoHash hasher(CryptoHash::Sha256, true);
-    hasher.setKey(getCurrentHmacKey());
-    hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
-    hasher.addData(blockSizeBytes);
-    hasher.addData(m_buffer);
+    if (m_readAhead.isEmpty() && m_readAheadError.isEmpty()) {
+        readAheadBlocks();
+    }
 
-    if (hmac != hasher.result()) {
+    if (m_readAhead.isEmpty()) {
         m_error = true;
-        setErrorString("Mismatch between hash and data.");
+        setErrorString(m_readAheadError);
         return false;
     }
 
+    m_buffer = m_readAhead.dequeue();
     m_bufferPos = 0;
     ++m_blockIndex;
 
-    if (blockSize == 0) {
+    if (m_buffer.isEmpty()) {
         m_eof = true;
         return false;
     }
@@ -176,6 +200,61 @@ bool HmacBlockStream::readHashedBlock()
     return true;
 }
 
+/**
+ * Read up to parallelBlocks() blocks from the base device and verify them.
+ * Blocks preceding the first invalid one are queued for reading; the
+ * error for the invalid block is raised once they have been consumed.
+ */
+void HmacBlockStream::readAheadBlocks()
+{
+    QVector<Block> blocks;
+    quint64 blockIndex = m_blockIndex + static_cast<quint64>(m_readAhead.size());
+
+    while (blocks.size() < m_parallelBlocks) {
+        Block block;
+        block.index = blockIndex++;
+
+        block.hmac = m_baseDevice->read(32);
+        if (block.hmac.size() != 32) {
+            m_readAheadError = "Invalid HMAC size.";
+            break;
+        }
+
+        QByteArray blockSizeBytes = m_baseDevice->read(4);
+        if (blockSizeBytes.size() != 4) {
+            m_readAheadError = "Invalid block size size.";
+            break;
+        }
+        auto blockSize = Endian::bytesToSizedInt<qint32>(blockSizeBytes, ByteOrder);
+        if (blockSize < 0) {
+            m_readAheadError = "Invalid block size.";
+            break;
+        }
+
+        block.data = m_baseDevice->read(blockSize);
+        if (block.data.size() != blockSize) {
+            m_readAheadError = "Block too short.";
+            break;
+        }
+
+        blocks.append(block);
+        if (blockSize == 0) {
+            break;
+        }
+    }
+
+    QVector<Block> expected = blocks;
+    hashBlocks(expected);
+
+    for (int i = 0; i < blocks.size(); ++i) {
+        if (blocks[i].hmac != expected[i].hmac) {
+            m_readAheadError = "Mismatch between hash and data.";
+            break;
+        }
+        m_readAhead.enqueue(blocks[i].data);
+    }
+}
+
 qint64 HmacBlockStream::writeData(const char* data, qint64 maxSize)
 {
     Q_ASSERT(maxSize >= 0);
@@ -208,48 +287,81 @@ qint64 HmacBlockStream::writeData(const char* data, qint64 maxSize)
 
 bool HmacBlockStream::writeHashedBlock()
 {
-    CryptoHash hasher(CryptoHash::Sha256, true);
-    hasher.setKey(getCurrentHmacKey());
-    hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
-    hasher.addData(Endian::sizedIntToBytes<qint32>(m_buffer.size(), ByteOrder));
-    hasher.addData(m_buffer);
-    QByteArray hash = hasher.result();
-
-    if (m_baseDevice->write(hash) != hash.size()) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
+    if (m_error) {
         return false;
     }
 
-    if (!Endian::writeSizedInt<qint32>(m_buffer.size(), m_baseDevice, ByteOrder)) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
-        return false;
+    Block block;
+    block.index = m_blockIndex++;
+    block.data = m_buffer;
+    m_pendingBlocks.append(block);
+    m_buffer.clear();
+
+    // the empty final block always flushes everything before it
+    if (m_pendingBlocks.size() < m_parallelBlocks && !block.data.isEmpty()) {
+        return true;
     }
+    return flushPendingBlocks();
+}
 
-    if (!m_buffer.isEmpty()) {
-        if (m_baseDevice->write(m_buffer) != m_buffer.size()) {
+bool HmacBlockStream::flushPendingBlocks()
+{
+    hashBlocks(m_pendingBlocks);
+
+    for (const Block& block : asConst(m_pendingBlocks)) {
+        if (m_baseDevice->write(block.hmac) != block.hmac.size()) {
             m_error = true;
             setErrorString(m_baseDevice->errorString());
+            m_pendingBlocks.clear();
             return false;
         }
 
-        m_buffer.clear();
+        if (!Endian::writeSizedInt<qint32>(block.data.size(), m_baseDevice, ByteOrder)) {
+            m_error = true;
+            setErrorString(m_baseDevice->errorString());
+            m_pendingBlocks.clear();
+            return false;
+        }
+
+        if (!block.data.isEmpty() && m_baseDevice->write(block.data) != block.data.size()) {
+            m_error = true;
+            setErrorString(m_baseDevice->errorString());
+            m_pendingBlocks.clear();
+            return false;
+        }
     }
-    ++m_blockIndex;
+
+    m_pendingBlocks.clear();
     return true;
 }
 
-QByteArray HmacBlockStream::getCurrentHmacKey() const
+/**
+ * Compute the HMAC of each block, in parallel when there is more than one.
+ */
+void HmacBlockStream::hashBlocks(QVector<Block>& blocks) const
 {
-    return getHmacKey(m_blockIndex, m_key);
+    auto hashBlock = [this](Block& block) {
+        auto& hasher = CryptoHash::threadInstance(CryptoHash::Sha256, true);
+        hasher.setKey(getHmacKey(block.index, m_key));
+        hasher.addData(Endian::sizedIntToBytes<quint64>(block.index, ByteOrder));
+        hasher.addData(Endian::sizedIntToBytes<qint32>(block.data.size(), ByteOrder));
+        hasher.addData(block.data);
+        block.hmac = hasher.result();
+        hasher.reset();
+    };
+
+    if (blocks.size() > 1) {
+        QtConcurrent::blockingMap(blocks, hashBlock);
+    } else if (!blocks.isEmpty()) {
+        hashBlock(blocks.first());
+    }
 }
 
 QByteArray HmacBlockStream::getHmacKey(quint64 blockIndex, const QByteArray& key)
 {
     Q_ASSERT(key.size() == 64);
     QByteArray indexBytes = Endian::sizedIntToBytes<quint64>(blockIndex, ByteOrder);
-    CryptoHash hasher(CryptoHash::Sha512);
+    auto& hasher = CryptoHash::threadInstance(CryptoHash::Sha512);
     hasher.addData(indexBytes);
     hasher.addData(key);
     return hasher.result();
@@ -18,7 +18,9 @@
 #ifndef KEEPASSX_HMACBLOCKSTREAM_H
 #define KEEPASSX_HMACBLOCKSTREAM_H
 
+#include <QQueue>
 #include <QSysInfo>
+#include <QVector>
 
 #include "streams/LayeredStream.h"
 
@@ -35,18 +37,32 @@ public:
     void close() override;
 
     static QByteArray getHmacKey(quint64 blockIndex, const QByteArray& key);
+    static int suggestedParallelBlocks();
+
+    void setParallelBlocks(int count);
+    int parallelBlocks() const;
 
     bool atEnd() const override;
+    bool readChunk(QByteArray& chunk) override;
 
 protected:
     qint64 readData(char* data, qint64 maxSize) override;
     qint64 writeData(const char* data, qint64 maxSize) override;
 
 private:
+    struct Block
+    {
+        quint64 index;
+        QByteArray hmac;
+        QByteArray data;
+    };
+
     void init();
     bool readHashedBlock();
+    void readAheadBlocks();
     bool writeHashedBlock();
-    QByteArray getCurrentHmacKey() const;
+    bool flushPendingBlocks();
+    void hashBlocks(QVector<Block>& blocks) const;
 
     static const QSysInfo::Endian ByteOrder;
     qint32 m_blockSize;
@@ -56,6 +72,10 @@ private:
     quint64 m_blockIndex;
     bool m_eof;
     bool m_error;
+    int m_parallelBlocks = 1;
+    QQueue<QByteArray> m_readAhead;
+    QString m_readAheadError;
+    QVector<Block> m_pendingBlocks;
 };
 
 #endif // KEEPASSX_HMACBLOCKSTREAM_H
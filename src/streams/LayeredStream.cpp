@@ -17,6 +17,23 @@
 
 #include "LayeredStream.h"
 
+const qint64 LayeredStream::DefaultChunkSize = 64 * 1024;
+
+namespace
+{
+    bool readInto(QIODevice* device, QByteArray& chunk, qint64 maxSize)
+    {
+        chunk.resize(static_cast<int>(maxSize));
+        qint64 readResult = device->read(chunk.data(), maxSize);
+        if (readResult < 0) {
+            chunk.clear();
+            return false;
+        }
+        chunk.resize(static_cast<int>(readResult));
+        return true;
+    }
+} // namespace
+
 LayeredStream::LayeredStream(QIODevice* baseDevice)
     : QIODevice(baseDevice)
     , m_baseDevice(baseDevice)
@@ -69,6 +86,32 @@ bool LayeredStream::open(QIODevice::OpenMode mode)
     }
 }
 
+/**
+ * Read the next chunk of data and hand it over to the caller. Layers that
+ * already hold their output in a buffer pass that buffer on instead of
+ * copying it, so data moves up a stack of streams without a memcpy per layer.
+ *
+ * @param chunk receives the data, empty at the end of the stream
+ * @return false on error, see errorString()
+ */
+bool LayeredStream::readChunk(QByteArray& chunk)
+{
+    return readInto(this, chunk, DefaultChunkSize);
+}
+
+/**
+ * Read the next chunk from any device, using readChunk() if it is a
+ * LayeredStream and reading up to maxSize bytes otherwise.
+ */
+bool LayeredStream::readChunkFrom(QIODevice* device, QByteArray& chunk, qint64 maxSize)
+{
+    auto stream = qobject_cast<LayeredStream*>(device);
+    if (stream) {
+        return stream->readChunk(chunk);
+    }
+    return readInto(device, chunk, maxSize);
+}
+
 qint64 LayeredStream::readData(char* data, qint64 maxSize)
 {
     return m_baseDevice->read(data, maxSize);
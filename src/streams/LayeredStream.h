@@ -31,6 +31,11 @@ public:
     bool isSequential() const override;
     bool open(QIODevice::OpenMode mode) override;
 
+    virtual bool readChunk(QByteArray& chunk);
+    static bool readChunkFrom(QIODevice* device, QByteArray& chunk, qint64 maxSize = DefaultChunkSize);
+
+    static const qint64 DefaultChunkSize;
+
 protected:
     qint64 readData(char* data, qint64 maxSize) override;
     qint64 writeData(const char* data, qint64 maxSize) override;
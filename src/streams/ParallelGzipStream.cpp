@@ -0,0 +1,291 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelGzipStream.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <zlib.h>
+
+#include <cmath>
+
+#include "core/Endian.h"
+#include "core/Global.h"
+
+namespace
+{
+    const int ChunkSize = 128 * 1024;
+    const int DictionarySize = 32 * 1024;
+    // Order-0 entropy in bits per byte above which deflate saves next to nothing,
+    // as for already compressed files like JPEG, PDF or ZIP
+    const double StoredEntropyThreshold = 7.8;
+    // Below this size the estimate is unreliable and compressing is cheap anyway
+    const int MinEntropySize = 4 * 1024;
+
+    bool isIncompressible(const QByteArray& data)
+    {
+        if (data.size() < MinEntropySize) {
+            return false;
+        }
+
+        quint32 counts[256] = {};
+        const auto* bytes = reinterpret_cast<const uchar*>(data.constData());
+        for (int i = 0; i < data.size(); ++i) {
+            ++counts[bytes[i]];
+        }
+
+        double entropy = 0.0;
+        for (const quint32 count : counts) {
+            if (count > 0) {
+                const double p = static_cast<double>(count) / data.size();
+                entropy -= p * std::log2(p);
+            }
+        }
+        return entropy > StoredEntropyThreshold;
+    }
+
+    struct Chunk
+    {
+        QByteArray input;
+        QByteArray dictionary;
+        QByteArray output;
+        quint32 crc = 0;
+        bool last = false;
+        bool stored = false;
+        bool ok = false;
+    };
+
+    void deflateChunk(Chunk& chunk, int level)
+    {
+        // High-entropy data is written as stored blocks, which any inflater reads
+        chunk.stored = level > 0 && isIncompressible(chunk.input);
+        if (chunk.stored) {
+            level = 0;
+        }
+
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        // raw deflate, the gzip framing is written by the stream itself
+        if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return;
+        }
+        if (level > 0 && !chunk.dictionary.isEmpty()) {
+            deflateSetDictionary(&zs,
+                                 reinterpret_cast<const Bytef*>(chunk.dictionary.constData()),
+                                 static_cast<uInt>(chunk.dictionary.size()));
+        }
+
+        // leave room for the sync flush marker on top of the bound
+        chunk.output.resize(static_cast<int>(deflateBound(&zs, static_cast<uLong>(chunk.input.size()))) + 16);
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(chunk.input.constData()));
+        zs.avail_in = static_cast<uInt>(chunk.input.size());
+        zs.next_out = reinterpret_cast<Bytef*>(chunk.output.data());
+        zs.avail_out = static_cast<uInt>(chunk.output.size());
+
+        int result = deflate(&zs, chunk.last ? Z_FINISH : Z_SYNC_FLUSH);
+        if (chunk.last) {
+            chunk.ok = result == Z_STREAM_END;
+        } else {
+            chunk.ok = result == Z_OK && zs.avail_in == 0 && zs.avail_out != 0;
+        }
+        chunk.output.resize(chunk.output.size() - static_cast<int>(zs.avail_out));
+        deflateEnd(&zs);
+
+        chunk.crc = static_cast<quint32>(crc32(crc32(0L, Z_NULL, 0),
+                                               reinterpret_cast<const Bytef*>(chunk.input.constData()),
+                                               static_cast<uInt>(chunk.input.size())));
+    }
+} // namespace
+
+ParallelGzipStream::ParallelGzipStream(QIODevice* baseDevice, int compressionLevel)
+    : LayeredStream(baseDevice)
+    , m_compressionLevel(qBound(0, compressionLevel, 9))
+    , m_maxPendingChunks(qMax(1, QThread::idealThreadCount()))
+    , m_crc(0)
+    , m_size(0)
+    , m_storedChunks(0)
+    , m_headerWritten(false)
+    , m_finished(false)
+    , m_error(false)
+{
+}
+
+ParallelGzipStream::~ParallelGzipStream()
+{
+    close();
+}
+
+bool ParallelGzipStream::open(QIODevice::OpenMode mode)
+{
+    if (mode & QIODevice::ReadOnly) {
+        qWarning("ParallelGzipStream::open: Reading is not supported.");
+        return false;
+    }
+
+    m_buffer.clear();
+    m_pendingChunks.clear();
+    m_dictionary.clear();
+    m_crc = static_cast<quint32>(crc32(0L, Z_NULL, 0));
+    m_size = 0;
+    m_storedChunks = 0;
+    m_headerWritten = false;
+    m_finished = false;
+    m_error = false;
+
+    return LayeredStream::open(mode);
+}
+
+void ParallelGzipStream::close()
+{
+    if (isWritable() && !m_finished) {
+        m_pendingChunks.append(m_buffer);
+        m_buffer.clear();
+        if (compressPending(true)) {
+            QByteArray trailer;
+            trailer.append(Endian::sizedIntToBytes<quint32>(m_crc, QSysInfo::LittleEndian));
+            trailer.append(Endian::sizedIntToBytes<quint32>(m_size, QSysInfo::LittleEndian));
+            writeToBase(trailer);
+        }
+        m_finished = true;
+    }
+
+    LayeredStream::close();
+}
+
+qint64 ParallelGzipStream::readData(char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+qint64 ParallelGzipStream::writeData(const char* data, qint64 maxSize)
+{
+    if (m_error) {
+        return -1;
+    }
+
+    qint64 offset = 0;
+    while (offset < maxSize) {
+        int bytesToCopy = static_cast<int>(qMin<qint64>(maxSize - offset, ChunkSize - m_buffer.size()));
+        m_buffer.append(data + offset, bytesToCopy);
+        offset += bytesToCopy;
+
+        if (m_buffer.size() == ChunkSize) {
+            m_pendingChunks.append(m_buffer);
+            m_buffer.clear();
+            if (m_pendingChunks.size() >= m_maxPendingChunks && !compressPending(false)) {
+                return -1;
+            }
+        }
+    }
+
+    return maxSize;
+}
+
+/**
+ * End the current chunk, the next input starts a new one. Chunks of high
+ * entropy are stored instead of deflated, so data of a different kind, like
+ * an attachment among text, should be put into chunks of its own.
+ */
+bool ParallelGzipStream::endChunk()
+{
+    if (m_error) {
+        return false;
+    }
+    if (m_buffer.isEmpty()) {
+        return true;
+    }
+
+    m_pendingChunks.append(m_buffer);
+    m_buffer.clear();
+    return m_pendingChunks.size() < m_maxPendingChunks || compressPending(false);
+}
+
+/**
+ * Number of chunks written as stored blocks because they were incompressible.
+ */
+int ParallelGzipStream::storedChunks() const
+{
+    return m_storedChunks;
+}
+
+/**
+ * Deflate all pending chunks concurrently and write them out in order.
+ *
+ * @param finish the last pending chunk ends the deflate stream
+ */
+bool ParallelGzipStream::compressPending(bool finish)
+{
+    if (m_error) {
+        return false;
+    }
+
+    if (!m_headerWritten) {
+        // magic, deflate, no flags, no mtime, no extra flags, unknown OS
+        static const char header[] = {'\x1f', '\x8b', '\x08', 0, 0, 0, 0, 0, 0, '\xff'};
+        if (!writeToBase(QByteArray(header, sizeof(header)))) {
+            return false;
+        }
+        m_headerWritten = true;
+    }
+
+    QVector<Chunk> chunks(m_pendingChunks.size());
+    for (int i = 0; i < chunks.size(); ++i) {
+        chunks[i].input = m_pendingChunks[i];
+        chunks[i].dictionary = i == 0 ? m_dictionary : m_pendingChunks[i - 1].right(DictionarySize);
+    }
+    if (finish && !chunks.isEmpty()) {
+        chunks.last().last = true;
+    }
+    m_pendingChunks.clear();
+
+    const int level = m_compressionLevel;
+    QtConcurrent::blockingMap(chunks, [level](Chunk& chunk) { deflateChunk(chunk, level); });
+
+    for (const Chunk& chunk : asConst(chunks)) {
+        if (!chunk.ok) {
+            m_error = true;
+            setErrorString("Compression failed.");
+            return false;
+        }
+        if (!writeToBase(chunk.output)) {
+            return false;
+        }
+        m_crc = static_cast<quint32>(crc32_combine(m_crc, chunk.crc, chunk.input.size()));
+        m_size += static_cast<quint32>(chunk.input.size());
+        if (chunk.stored) {
+            ++m_storedChunks;
+        }
+    }
+
+    if (!chunks.isEmpty()) {
+        m_dictionary = chunks.last().input.right(DictionarySize);
+    }
+    return true;
+}
+
+bool ParallelGzipStream::writeToBase(const QByteArray& data)
+{
+    if (m_baseDevice->write(data) != data.size()) {
+        m_error = true;
+        setErrorString(m_baseDevice->errorString());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_PARALLELGZIPSTREAM_H
+#define KEEPASSX_PARALLELGZIPSTREAM_H
+
+#include <QVector>
+
+#include "streams/LayeredStream.h"
+
+/**
+ * Write-only gzip compressor that deflates independent chunks of its input
+ * on a thread pool, like pigz. Chunks are byte-aligned with a sync flush and
+ * primed with the tail of the previous chunk as dictionary, so the result is
+ * one ordinary gzip member that any inflater can read.
+ *
+ * Chunks whose bytes are close to random, like already compressed files,
+ * are written as stored blocks rather than spending time deflating them.
+ */
+class ParallelGzipStream : public LayeredStream
+{
+    Q_OBJECT
+
+public:
+    explicit ParallelGzipStream(QIODevice* baseDevice, int compressionLevel = 6);
+    ~ParallelGzipStream() override;
+
+    bool open(QIODevice::OpenMode mode) override;
+    void close() override;
+
+    bool endChunk();
+    int storedChunks() const;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    bool compressPending(bool finish);
+    bool writeToBase(const QByteArray& data);
+
+    const int m_compressionLevel;
+    const int m_maxPendingChunks;
+    QByteArray m_buffer;
+    QVector<QByteArray> m_pendingChunks;
+    QByteArray m_dictionary;
+    quint32 m_crc;
+    quint32 m_size;
+    int m_storedChunks;
+    bool m_headerWritten;
+    bool m_finished;
+    bool m_error;
+};
+
+#endif // KEEPASSX_PARALLELGZIPSTREAM_H
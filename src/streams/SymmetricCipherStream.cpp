@@ -21,7 +21,7 @@ SymmetricCipherStream::SymmetricCipherStream(QIODevice* baseDevice)
     : LayeredStream(baseDevice)
     , m_cipher(new SymmetricCipher())
     , m_bufferPos(0)
-    , m_bufferFilling(false)
+    , m_eof(false)
     , m_error(false)
     , m_isInitialized(false)
     , m_dataWritten(false)
@@ -51,8 +51,9 @@ bool SymmetricCipherStream::init(SymmetricCipher::Mode mode,
 void SymmetricCipherStream::resetInternalState()
 {
     m_buffer.clear();
+    m_pending.clear();
     m_bufferPos = 0;
-    m_bufferFilling = false;
+    m_eof = false;
     m_error = false;
     m_dataWritten = false;
     m_cipher->reset();
@@ -99,7 +100,7 @@ qint64 SymmetricCipherStream::readData(char* data, qint64 maxSize)
     qint64 offset = 0;
 
     while (bytesRemaining > 0) {
-        if ((m_bufferPos == m_buffer.size()) || m_bufferFilling) {
+        if (m_bufferPos == m_buffer.size()) {
             if (!readBlock()) {
                 if (m_error) {
                     return -1;
@@ -121,49 +122,107 @@ qint64 SymmetricCipherStream::readData(char* data, qint64 maxSize)
     return maxSize;
 }
 
-bool SymmetricCipherStream::readBlock()
+bool SymmetricCipherStream::readChunk(QByteArray& chunk)
 {
-    QByteArray newData;
+    chunk.clear();
+    if (m_error) {
+        return false;
+    }
 
-    if (m_bufferFilling) {
-        newData.resize(blockSize() - m_buffer.size());
+    if (m_bufferPos == m_buffer.size() && !readBlock()) {
+        return !m_error;
+    }
+
+    if (m_bufferPos == 0) {
+        chunk.swap(m_buffer);
     } else {
+        chunk = m_buffer.mid(m_bufferPos);
         m_buffer.clear();
-        newData.resize(blockSize());
     }
+    m_bufferPos = 0;
+    return true;
+}
 
-    int readResult = m_baseDevice->read(newData.data(), newData.size());
+/**
+ * Decrypt the next chunk of the base device in place into m_buffer.
+ *
+ * Block ciphers always hold back the last block read, as only
+ * the final block of the stream is finished with its padding.
+ *
+ * @return false at the end of the stream or on error
+ */
+bool SymmetricCipherStream::readBlock()
+{
+    m_buffer.clear();
+    m_bufferPos = 0;
 
-    if (readResult == -1) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
-        return false;
-    } else {
-        m_buffer.append(newData.left(readResult));
-    }
+    while (!m_eof) {
+        if (!m_streamCipher && m_pending.size() > blockSize()) {
+            int tailSize = m_pending.size() % blockSize();
+            if (tailSize == 0) {
+                tailSize = blockSize();
+            }
+            QByteArray tail = m_pending.right(tailSize);
+            m_pending.truncate(m_pending.size() - tailSize);
+            if (!m_cipher->process(m_pending)) {
+                m_error = true;
+                setErrorString(m_cipher->errorString());
+                return false;
+            }
+            m_buffer.swap(m_pending);
+            m_pending = tail;
+            return true;
+        }
 
-    if (!m_streamCipher && m_buffer.size() != blockSize()) {
-        m_bufferFilling = true;
-        return false;
-    } else {
-        m_bufferPos = 0;
-        m_bufferFilling = false;
+        QByteArray chunk;
+        if (!readChunkFrom(m_baseDevice, chunk)) {
+            m_error = true;
+            setErrorString(m_baseDevice->errorString());
+            return false;
+        }
+
+        if (chunk.isEmpty()) {
+            m_eof = true;
+            if (m_streamCipher || m_pending.isEmpty()) {
+                return false;
+            }
+            if (!m_cipher->finish(m_pending)) {
+                m_error = true;
+                setErrorString(m_cipher->errorString());
+                return false;
+            }
+            m_buffer.swap(m_pending);
+            return !m_buffer.isEmpty();
+        }
 
-        if (!m_streamCipher && m_baseDevice->atEnd()) {
-            if (!m_cipher->finish(m_buffer)) {
+        if (m_streamCipher) {
+            if (!m_cipher->process(chunk)) {
                 m_error = true;
                 setErrorString(m_cipher->errorString());
                 return false;
             }
-        } else if (m_buffer.size() > 0) {
-            if (!m_cipher->process(m_buffer)) {
+            m_buffer.swap(chunk);
+            return true;
+        }
+
+        if (m_pending.isEmpty()) {
+            m_pending.swap(chunk);
+        } else if (m_pending.size() == blockSize()) {
+            // the held back block was not the last one after all
+            if (!m_cipher->process(m_pending)) {
                 m_error = true;
                 setErrorString(m_cipher->errorString());
                 return false;
             }
+            m_buffer.swap(m_pending);
+            m_pending.swap(chunk);
+            return true;
+        } else {
+            m_pending.append(chunk);
         }
-        return m_buffer.size() > 0;
     }
+
+    return false;
 }
 
 qint64 SymmetricCipherStream::writeData(const char* data, qint64 maxSize)
@@ -179,14 +238,14 @@ qint64 SymmetricCipherStream::writeData(const char* data, qint64 maxSize)
     qint64 offset = 0;
 
     while (bytesRemaining > 0) {
-        int bytesToCopy = qMin(bytesRemaining, static_cast<qint64>(blockSize() - m_buffer.size()));
+        int bytesToCopy = qMin(bytesRemaining, static_cast<qint64>(writeChunkSize() - m_buffer.size()));
 
         m_buffer.append(data + offset, bytesToCopy);
 
         offset += bytesToCopy;
         bytesRemaining -= bytesToCopy;
 
-        if (m_buffer.size() == blockSize()) {
+        if (m_buffer.size() == writeChunkSize()) {
             if (!writeBlock(false)) {
                 if (m_error) {
                     return -1;
@@ -202,10 +261,24 @@ qint64 SymmetricCipherStream::writeData(const char* data, qint64 maxSize)
 
 bool SymmetricCipherStream::writeBlock(bool lastBlock)
 {
-    Q_ASSERT(m_streamCipher || lastBlock || (m_buffer.size() == blockSize()));
+    Q_ASSERT(m_streamCipher || lastBlock || (m_buffer.size() % blockSize() == 0));
+
+    if (m_buffer.isEmpty() && m_streamCipher) {
+        return true;
+    }
 
     if (lastBlock && !m_streamCipher) {
-        QByteArray end;
+        // only the trailing partial block is finished, full blocks are processed as usual
+        int fullSize = m_buffer.size() - m_buffer.size() % blockSize();
+        if (fullSize > 0) {
+            QByteArray tail = m_buffer.mid(fullSize);
+            m_buffer.truncate(fullSize);
+            if (!writeBlock(false)) {
+                return false;
+            }
+            m_buffer = tail;
+        }
+
         if (!m_cipher->finish(m_buffer)) {
             m_error = true;
             setErrorString(m_cipher->errorString());
@@ -234,3 +307,13 @@ int SymmetricCipherStream::blockSize() const
     }
     return m_cipher->blockSize(m_cipher->mode());
 }
+
+/**
+ * Amount of plaintext collected before it is encrypted and passed
+ * on, always a multiple of the cipher block size. Stream ciphers
+ * get chunks large enough to be encrypted on several threads.
+ */
+int SymmetricCipherStream::writeChunkSize() const
+{
+    return blockSize() * (m_streamCipher ? 1024 : 4096);
+}
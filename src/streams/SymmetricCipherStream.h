@@ -36,6 +36,7 @@ public:
     bool open(QIODevice::OpenMode mode) override;
     bool reset() override;
     void close() override;
+    bool readChunk(QByteArray& chunk) override;
 
 protected:
     qint64 readData(char* data, qint64 maxSize) override;
@@ -46,11 +47,13 @@ private:
     bool readBlock();
     bool writeBlock(bool lastBlock);
     int blockSize() const;
+    int writeChunkSize() const;
 
     const QScopedPointer<SymmetricCipher> m_cipher;
     QByteArray m_buffer;
+    QByteArray m_pending;
     int m_bufferPos;
-    bool m_bufferFilling;
+    bool m_eof;
     bool m_error;
     bool m_isInitialized;
     bool m_dataWritten;
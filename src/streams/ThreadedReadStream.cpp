@@ -0,0 +1,230 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadedReadStream.h"
+
+#include <QThread>
+
+#include <cstring>
+#include <functional>
+
+const qint64 ThreadedReadStream::DefaultChunkSize = 256 * 1024;
+const int ThreadedReadStream::DefaultMaxQueuedChunks = 8;
+
+namespace
+{
+    class WorkerThread : public QThread
+    {
+    public:
+        explicit WorkerThread(std::function<void()> task)
+            : m_task(std::move(task))
+        {
+        }
+
+    protected:
+        void run() override
+        {
+            m_task();
+        }
+
+    private:
+        std::function<void()> m_task;
+    };
+} // namespace
+
+ThreadedReadStream::ThreadedReadStream(QIODevice* baseDevice, qint64 chunkSize, int maxQueuedChunks)
+    : LayeredStream(baseDevice)
+    , m_chunkSize(qMax<qint64>(1, chunkSize))
+    , m_maxQueuedChunks(qMax(1, maxQueuedChunks))
+{
+}
+
+ThreadedReadStream::~ThreadedReadStream()
+{
+    stopWorker();
+}
+
+bool ThreadedReadStream::open(QIODevice::OpenMode mode)
+{
+    if (mode & QIODevice::WriteOnly) {
+        qWarning("ThreadedReadStream::open: Writing is not supported.");
+        return false;
+    }
+
+    if (!LayeredStream::open(mode)) {
+        return false;
+    }
+
+    m_chunks.clear();
+    m_current.clear();
+    m_currentPos = 0;
+    m_finished = false;
+    m_failed = false;
+    m_abort = false;
+    m_workerError.clear();
+
+    m_worker.reset(new WorkerThread([this] { produce(); }));
+    m_worker->start();
+    return true;
+}
+
+void ThreadedReadStream::close()
+{
+    stopWorker();
+    LayeredStream::close();
+}
+
+bool ThreadedReadStream::atEnd() const
+{
+    if (m_currentPos < m_current.size()) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    return m_finished && m_chunks.isEmpty();
+}
+
+qint64 ThreadedReadStream::bytesAvailable() const
+{
+    qint64 available = m_current.size() - m_currentPos;
+
+    QMutexLocker locker(&m_mutex);
+    for (const QByteArray& chunk : m_chunks) {
+        available += chunk.size();
+    }
+    return available;
+}
+
+qint64 ThreadedReadStream::readData(char* data, qint64 maxSize)
+{
+    qint64 bytesRead = 0;
+
+    while (bytesRead < maxSize) {
+        if (m_currentPos >= m_current.size()) {
+            QMutexLocker locker(&m_mutex);
+            while (m_chunks.isEmpty() && !m_finished) {
+                m_chunkAvailable.wait(&m_mutex);
+            }
+
+            if (m_chunks.isEmpty()) {
+                if (m_failed && bytesRead == 0) {
+                    setErrorString(m_workerError);
+                    return -1;
+                }
+                break;
+            }
+
+            m_current = m_chunks.dequeue();
+            m_currentPos = 0;
+            m_spaceAvailable.wakeOne();
+        }
+
+        const qint64 bytesToCopy = qMin(maxSize - bytesRead, static_cast<qint64>(m_current.size() - m_currentPos));
+        memcpy(data + bytesRead, m_current.constData() + m_currentPos, static_cast<size_t>(bytesToCopy));
+        m_currentPos += static_cast<int>(bytesToCopy);
+        bytesRead += bytesToCopy;
+    }
+
+    return bytesRead;
+}
+
+bool ThreadedReadStream::readChunk(QByteArray& chunk)
+{
+    chunk.clear();
+
+    if (m_currentPos < m_current.size()) {
+        chunk = m_currentPos == 0 ? m_current : m_current.mid(m_currentPos);
+        m_current.clear();
+        m_currentPos = 0;
+        return true;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    while (m_chunks.isEmpty() && !m_finished) {
+        m_chunkAvailable.wait(&m_mutex);
+    }
+
+    if (m_chunks.isEmpty()) {
+        if (m_failed) {
+            setErrorString(m_workerError);
+            return false;
+        }
+        return true;
+    }
+
+    chunk = m_chunks.dequeue();
+    m_spaceAvailable.wakeOne();
+    return true;
+}
+
+qint64 ThreadedReadStream::writeData(const char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+/**
+ * Worker thread loop: read chunks from the base device until it
+ * reports the end of the data or an error, or the stream is closed.
+ */
+void ThreadedReadStream::produce()
+{
+    forever {
+        QByteArray chunk;
+        const bool ok = readChunkFrom(m_baseDevice, chunk, m_chunkSize);
+
+        QMutexLocker locker(&m_mutex);
+        if (m_abort) {
+            return;
+        }
+        if (!ok || chunk.isEmpty()) {
+            if (!ok) {
+                m_failed = true;
+                m_workerError = m_baseDevice->errorString();
+            }
+            m_finished = true;
+            m_chunkAvailable.wakeAll();
+            return;
+        }
+
+        while (m_chunks.size() >= m_maxQueuedChunks && !m_abort) {
+            m_spaceAvailable.wait(&m_mutex);
+        }
+        if (m_abort) {
+            return;
+        }
+
+        m_chunks.enqueue(chunk);
+        m_chunkAvailable.wakeOne();
+    }
+}
+
+void ThreadedReadStream::stopWorker()
+{
+    if (!m_worker) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_abort = true;
+        m_spaceAvailable.wakeAll();
+    }
+    m_worker->wait();
+    m_worker.reset();
+}
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_THREADEDREADSTREAM_H
+#define KEEPASSX_THREADEDREADSTREAM_H
+
+#include <QMutex>
+#include <QQueue>
+#include <QScopedPointer>
+#include <QWaitCondition>
+
+#include "streams/LayeredStream.h"
+
+class QThread;
+
+/**
+ * Read-only stream that pulls its base device on a worker thread into a bounded
+ * queue of chunks. Stacking it between expensive stream layers lets them run in
+ * parallel, so reading is limited by the slowest layer rather than their sum.
+ *
+ * The base device must not be accessed by anyone else while the stream is open.
+ */
+class ThreadedReadStream : public LayeredStream
+{
+    Q_OBJECT
+
+public:
+    static const qint64 DefaultChunkSize;
+    static const int DefaultMaxQueuedChunks;
+
+    explicit ThreadedReadStream(QIODevice* baseDevice,
+                                qint64 chunkSize = DefaultChunkSize,
+                                int maxQueuedChunks = DefaultMaxQueuedChunks);
+    ~ThreadedReadStream() override;
+
+    bool open(QIODevice::OpenMode mode) override;
+    void close() override;
+    bool atEnd() const override;
+    qint64 bytesAvailable() const override;
+    bool readChunk(QByteArray& chunk) override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    void produce();
+    void stopWorker();
+
+    const qint64 m_chunkSize;
+    const int m_maxQueuedChunks;
+    QScopedPointer<QThread> m_worker;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_chunkAvailable;
+    QWaitCondition m_spaceAvailable;
+    QQueue<QByteArray> m_chunks;
+    bool m_finished = false;
+    bool m_failed = false;
+    bool m_abort = false;
+    QString m_workerError;
+
+    // Only accessed by the reading thread
+    QByteArray m_current;
+    int m_currentPos = 0;
+};
+
+#endif // KEEPASSX_THREADEDREADSTREAM_H
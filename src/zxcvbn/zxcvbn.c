@@ -153,15 +153,93 @@ static int Cardinality(const uint8_t *Str, int Len)
 }
 
 /**********************************************************************************
- * Allocate a ZxcMatch_t struct, clear it to zero
+ * Pool of match structs. A password of a few dozen characters produces hundreds
+ * of candidate matches, most of them discarded again, so they are not taken from
+ * the heap one at a time. Matches are carved out of blocks, discarded ones are
+ * kept on a free list, and everything is released at once at the end of
+ * ZxcvbnMatch(). The first block lives on the stack of ZxcvbnMatch().
+ */
+#define MATCH_LOCAL_SIZE 128
+#define MATCH_BLOCK_SIZE 512
+
+typedef struct MatchBlock
+{
+    struct MatchBlock *Next;
+    ZxcMatch_t Items[MATCH_BLOCK_SIZE];
+} MatchBlock_t;
+
+typedef struct
+{
+    ZxcMatch_t   *FreeList;     /* Discarded matches, linked by their Next member */
+    ZxcMatch_t   *Cur;          /* Unused part of the newest block */
+    ZxcMatch_t   *End;
+    MatchBlock_t *Blocks;       /* Blocks taken from the heap */
+    ZxcMatch_t    Local[MATCH_LOCAL_SIZE];
+} MatchPool_t;
+
+/* The pool of the ZxcvbnMatch() call running on the current thread */
+#if defined(_MSC_VER)
+static __declspec(thread) MatchPool_t *Pool;
+#elif defined(__GNUC__) || defined(__clang__)
+static __thread MatchPool_t *Pool;
+#else
+static _Thread_local MatchPool_t *Pool;
+#endif
+
+static void InitPool(MatchPool_t *p)
+{
+    p->FreeList = 0;
+    p->Cur = p->Local;
+    p->End = p->Local + MATCH_LOCAL_SIZE;
+    p->Blocks = 0;
+}
+
+static void ReleasePool(MatchPool_t *p)
+{
+    while(p->Blocks)
+    {
+        MatchBlock_t *b = p->Blocks->Next;
+        FreeFn(p->Blocks);
+        p->Blocks = b;
+    }
+}
+
+/**********************************************************************************
+ * Allocate a ZxcMatch_t struct from the pool, clear it to zero
  */
 static ZxcMatch_t *AllocMatch()
 {
-    ZxcMatch_t *p = MallocFn(ZxcMatch_t, 1);
+    ZxcMatch_t *p;
+    if (Pool->FreeList)
+    {
+        p = Pool->FreeList;
+        Pool->FreeList = p->Next;
+    }
+    else
+    {
+        if (Pool->Cur == Pool->End)
+        {
+            MatchBlock_t *b = MallocFn(MatchBlock_t, 1);
+            b->Next = Pool->Blocks;
+            Pool->Blocks = b;
+            Pool->Cur = b->Items;
+            Pool->End = b->Items + MATCH_BLOCK_SIZE;
+        }
+        p = Pool->Cur++;
+    }
     memset(p, 0, sizeof *p);
     return p;
 }
 
+/**********************************************************************************
+ * Return a ZxcMatch_t struct to the pool
+ */
+static void FreeMatch(ZxcMatch_t *p)
+{
+    p->Next = Pool->FreeList;
+    Pool->FreeList = p;
+}
+
 /**********************************************************************************
  * Add new match struct to linked list of matches. List ordered with shortest at
  * head of list. Note: passed new match struct in parameter Nu may be de allocated.
@@ -192,13 +270,13 @@ static void AddResult(ZxcMatch_t **HeadRef, ZxcMatch_t *Nu, int MaxLen)
         if ((*HeadRef)->MltEnpy <= Nu->MltEnpy)
         {
             /* Existing entry has lower entropy - keep it, discard new entry */
-            FreeFn(Nu);
+            FreeMatch(Nu);
         }
         else
         {
             /* New entry has lower entropy - replace existing entry */
             Nu->Next = (*HeadRef)->Next;
-            FreeFn(*HeadRef);
+            FreeMatch(*HeadRef);
             *HeadRef = Nu;
         }
     }
@@ -482,12 +560,10 @@ typedef struct
     int     Begin;
     int     Caps;
     int     Lower;
-    int     NumPossChrs;
     uint8_t Leeted[sizeof L33TChr];
     uint8_t UnLeet[sizeof L33TChr];
     uint8_t LeetCnv[sizeof L33TCnv / LEET_NORM_MAP_SIZE + 1];
     uint8_t First;
-    uint8_t PossChars[CHARSET_SIZE];
 } DictWork_t;
 
 /**********************************************************************************
@@ -519,6 +595,46 @@ static int ListPossibleChars(uint8_t *List, const uint8_t *Map)
     return Len;
 }
 
+/* Number of characters in CharSet */
+#ifdef USE_DICT_FILE
+#define CHARSET_LEN SizeCharSet
+#else
+#define CHARSET_LEN (sizeof CharSet - 1)
+#endif
+
+/**********************************************************************************
+ * Number of bits set in the passed byte
+ */
+static int BitCount(unsigned int b)
+{
+    int n = 0;
+    for(; b; b &= b - 1)
+        ++n;
+    return n;
+}
+
+/**********************************************************************************
+ * Find the child node for a char from the map entry of its parent, without
+ * listing all possible chars first.
+ * Returns the position of the child among the children of the parent (the same
+ * as the char's position in the list made by ListPossibleChars()), or -1 if the
+ * char can't follow.
+ */
+static int ChildIndex(uint8_t c, const uint8_t *Map)
+{
+    const uint8_t *p = CharBinSearch(c, (const uint8_t *)CharSet, CHARSET_LEN, 1);
+    unsigned int i, k;
+    int x = 0;
+    if (!p)
+        return -1;
+    k = p - (const uint8_t *)CharSet;
+    if (!(Map[k >> 3] & (1 << (k & 7))))
+        return -1;
+    for(i = 0; i < (k >> 3); ++i)
+        x += BitCount(Map[i]);
+    return x + BitCount(Map[k >> 3] & ((1 << (k & 7)) - 1));
+}
+
 /**********************************************************************************
  * Increment count of each char that could be leeted.
  */
@@ -624,8 +740,6 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
     int Caps = Wrk->Caps;
     int Lower = Wrk->Lower;
     unsigned int NodeLoc = Wrk->StartLoc;
-    uint8_t *PossChars = Wrk->PossChars;
-    int NumPossChrs = Wrk->NumPossChrs;
     const uint8_t *Pwd = Passwd;
     uint32_t NodeData = DictNodes[NodeLoc];
     Passwd += Start;
@@ -634,6 +748,8 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
         uint8_t c;
         int w, x, y, z;
         const uint8_t *q;
+        /* Set of possible chars at current point in word. */
+        const uint8_t *Bmap = ChildMap + (NodeData & ((1<<BITS_CHILD_PATT_INDEX)-1)) * SizeChildMapEntry;
         z = 0;
         if (!Len && Wrk->First)
         {
@@ -641,11 +757,8 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
         }
         else
         {
-            /* Get char and set of possible chars at current point in word. */
-            const uint8_t *Bmap;
+            /* Get char at current point in word. */
             c = *Passwd;
-            Bmap = ChildMap + (NodeData & ((1<<BITS_CHILD_PATT_INDEX)-1)) * SizeChildMapEntry;
-            NumPossChrs = ListPossibleChars(PossChars, Bmap);
 
             /* Make it lowercase and update lowercase, uppercase counts */
             if (isupper(c))
@@ -664,6 +777,8 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
                 /* Found, see if used before */
                 unsigned int j;
                 unsigned int i = (q - L33TCnv ) / LEET_NORM_MAP_SIZE;
+                uint8_t PossChars[CHARSET_SIZE];
+                int NumPossChrs = ListPossibleChars(PossChars, Bmap);
                 if (Wrk->LeetCnv[i])
                 {
                     /* Used before, so limit characters to try */
@@ -686,8 +801,6 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
                         wrk.Caps = Caps;
                         wrk.Lower = Lower;
                         wrk.First = *r;
-                        wrk.NumPossChrs = NumPossChrs;
-                        memcpy(wrk.PossChars, PossChars, sizeof wrk.PossChars);
                         if (j)
                         {
                             wrk.LeetCnv[i] = *r;
@@ -699,23 +812,19 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
                 return;
             }
         }
-        q = CharBinSearch(c, PossChars, NumPossChrs, 1);
-        if (q)
-        {
-            /* Found the char as a normal char */
-            if (CharBinSearch(c, L33TChr, sizeof L33TChr - 1, 1))
-            {
-                /* Char matches, but also a normal equivalent to a leet char */
-                AddLeetChr(c, 0,  Wrk->Leeted, Wrk->UnLeet);
-            }
-        }
-        if (!q)
+        x = ChildIndex(c, Bmap);
+        if (x < 0)
         {
             /* No match for char - return */
             return;
         }
+        /* Found the char as a normal char */
+        if (CharBinSearch(c, L33TChr, sizeof L33TChr - 1, 1))
+        {
+            /* Char matches, but also a normal equivalent to a leet char */
+            AddLeetChr(c, 0,  Wrk->Leeted, Wrk->UnLeet);
+        }
         /* Add all the end counts of the child nodes before the one that matches */
-        x = (q - Wrk->PossChars);
         y = (NodeData >> BITS_CHILD_PATT_INDEX) & ((1 << BITS_CHILD_MAP_INDEX) - 1);
         NodeLoc = ChildLocs[x+y];
         for(w=0; w<x; ++w)
@@ -726,7 +835,6 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
                 z += EndCountLge[Cloc]*256;
             Ord += z;
         }
-
         /* Move to next node */
         NodeData = DictNodes[NodeLoc];
         if (WordEndBits[NodeLoc >> 3] & (1<<(NodeLoc & 7)))
@@ -1550,6 +1658,9 @@ static void SequenceMatch(ZxcMatch_t **Result, const uint8_t *Passwd, int Start,
  * of the password. 
  */
 
+/* Passwords up to this length are evaluated without any heap allocation for the nodes */
+#define LOCAL_NODES 64
+
 /* Struct to hold the data of a node (imaginary point between password characters) */
 typedef struct
 {
@@ -1571,8 +1682,16 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
     int Len = strlen(Pwd);
     const uint8_t *Passwd = (const uint8_t *)Pwd;
     uint8_t *RevPwd;
+    Node_t LocalNodes[LOCAL_NODES+1];
+    uint8_t LocalRevPwd[LOCAL_NODES+1];
+    Node_t *Nodes;
+    MatchPool_t MatchPool;
+
+    InitPool(&MatchPool);
+    Pool = &MatchPool;
+
     /* Create the paths */
-    Node_t *Nodes = MallocFn(Node_t, Len+1);
+    Nodes = (Len <= LOCAL_NODES) ? LocalNodes : MallocFn(Node_t, Len+1);
     memset(Nodes, 0, (Len+1) * sizeof *Nodes);
     i = Cardinality(Passwd, Len);
     e = log((double)i);
@@ -1594,7 +1713,7 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
     }
 
     /* Reverse dictionary words check */
-    RevPwd = MallocFn(uint8_t, Len+1);
+    RevPwd = (Len <= LOCAL_NODES) ? LocalRevPwd : MallocFn(uint8_t, Len+1);
     for(i = Len-1, j = 0; i >= 0; --i, ++j)
         RevPwd[j] = Pwd[i];
     RevPwd[j] = 0;
@@ -1652,7 +1771,8 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
             }
         }
     }
-    FreeFn(RevPwd);
+    if (RevPwd != LocalRevPwd)
+        FreeFn(RevPwd);
     /* End node has infinite distance/entropy, start node has 0 distance */
     Nodes[i].Dist = DBL_MAX;
     Nodes[0].Dist = 0.0;
@@ -1672,6 +1792,12 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
                 MinDist = Np->Dist;
             }
         }
+        /* Stop once no unvisited node is closer than the end node. Match entropies */
+        /* are never negative, so no path through those nodes can lower the result */
+        /* or change the path taken to the end node. */
+        if (MinDist >= Nodes[Len].Dist)
+            break;
+
         /* Mark the minimum distance node as visited */
         Np = Nodes + MinIdx;
         Np->Visit = 1;
@@ -1691,60 +1817,34 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
                 Ep->From = Zp;
             }
         }
-        /* If we got to the end node stop early */
-        /*if (Nodes[Len].Dist < DBL_MAX/2.0) */
-          /*  break; */
     }
     /* Make e hold entropy result and adjust to log base 2 */
     e = Nodes[Len].Dist / log(2.0);
 
     if (Info)
     {
-        /* Construct info on password parts */
+        /* Construct info on password parts. They are copied out of the match pool, */
+        /* so the caller can free them with ZxcvbnFreeInfo() */
         *Info = 0;
-        for(Zp = Nodes[Len].From; Zp; )
+        for(Zp = Nodes[Len].From; Zp; Zp = Nodes[Zp->Begin].From)
         {
-            ZxcMatch_t *Xp;
-            i = Zp->Begin;
+            ZxcMatch_t *Xp = MallocFn(ZxcMatch_t, 1);
+            *Xp = *Zp;
 
-            /* Remove all but required path */
-            Xp = Nodes[i].Paths;
-            Nodes[i].Paths = 0;
-            while(Xp)
-            {
-                ZxcMatch_t *p = Xp->Next;
-                if (Xp == Zp)
-                {
-                    /* Adjust the entropy to log to base 2 */
-                    Xp->Entrpy /= log(2.0);
-                    Xp->MltEnpy /= log(2.0);
+            /* Adjust the entropy to log to base 2 */
+            Xp->Entrpy /= log(2.0);
+            Xp->MltEnpy /= log(2.0);
 
-                    /* Put previous part at head of info list */
-                    Xp->Next = *Info;
-                    *Info = Xp;
-                }
-                else
-                {
-                    /* Not going on info list, so free it */
-                    FreeFn(Xp);
-                }
-                Xp = p;
-            }
-            Zp = Nodes[i].From;
-        }
-    }
-    /* Free all paths. Any being returned to caller have already been freed */
-    for(i = 0; i <= Len; ++i)
-    {
-        Zp = Nodes[i].Paths;
-        while(Zp)
-        {
-            ZxcMatch_t *p = Zp->Next;
-            FreeFn(Zp);
-            Zp = p;
+            /* Put previous part at head of info list */
+            Xp->Next = *Info;
+            *Info = Xp;
         }
     }
-    FreeFn(Nodes);
+    /* Free all paths at once */
+    Pool = 0;
+    ReleasePool(&MatchPool);
+    if (Nodes != LocalNodes)
+        FreeFn(Nodes);
     return e;
 }
 
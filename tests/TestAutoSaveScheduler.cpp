@@ -0,0 +1,159 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "TestAutoSaveScheduler.h"
+
+#include "core/AutoSaveScheduler.h"
+#include "mock/MockClock.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(TestAutoSaveScheduler)
+
+namespace
+{
+    MockClock* m_clock = nullptr;
+} // namespace
+
+void TestAutoSaveScheduler::init()
+{
+    Q_ASSERT(m_clock == nullptr);
+    m_clock = new MockClock(2010, 5, 5, 10, 30, 10);
+    MockClock::setup(m_clock);
+}
+
+void TestAutoSaveScheduler::cleanup()
+{
+    MockClock::teardown();
+    m_clock = nullptr;
+}
+
+void TestAutoSaveScheduler::testQuietPeriod()
+{
+    AutoSaveScheduler scheduler;
+    scheduler.setQuietPeriod(2000);
+    scheduler.setMaxDelay(10000);
+    QSignalSpy spySave(&scheduler, SIGNAL(saveRequested()));
+
+    scheduler.schedule();
+    QVERIFY(scheduler.isPending());
+    QVERIFY(scheduler.m_timer.isActive());
+    QCOMPARE(scheduler.m_timer.interval(), 2000);
+
+    // Every change restarts the quiet period
+    m_clock->advanceSecond(1);
+    scheduler.schedule();
+    QCOMPARE(scheduler.m_timer.interval(), 2000);
+
+    m_clock->advanceSecond(1);
+    scheduler.checkDeadline();
+    QCOMPARE(spySave.count(), 0);
+    QVERIFY(scheduler.m_timer.isActive());
+    QCOMPARE(scheduler.m_timer.interval(), 1000);
+
+    m_clock->advanceSecond(1);
+    scheduler.checkDeadline();
+    QCOMPARE(spySave.count(), 1);
+    QVERIFY(!scheduler.isPending());
+    QVERIFY(!scheduler.m_timer.isActive());
+}
+
+void TestAutoSaveScheduler::testMaxDelay()
+{
+    AutoSaveScheduler scheduler;
+    scheduler.setQuietPeriod(2000);
+    scheduler.setMaxDelay(5000);
+    QSignalSpy spySave(&scheduler, SIGNAL(saveRequested()));
+
+    // A steady stream of changes is saved after the maximum delay
+    for (int i = 0; i < 5; ++i) {
+        scheduler.schedule();
+        m_clock->advanceSecond(1);
+        scheduler.checkDeadline();
+    }
+    QCOMPARE(spySave.count(), 1);
+    QVERIFY(!scheduler.isPending());
+
+    // The maximum delay counts again from the next change
+    scheduler.schedule();
+    m_clock->advanceSecond(1);
+    scheduler.schedule();
+    QCOMPARE(scheduler.m_timer.interval(), 2000);
+    m_clock->advanceSecond(2);
+    scheduler.checkDeadline();
+    QCOMPARE(spySave.count(), 2);
+
+    // The quiet period is used if it is longer than the maximum delay
+    scheduler.setQuietPeriod(3000);
+    scheduler.setMaxDelay(1000);
+    scheduler.schedule();
+    m_clock->advanceSecond(2);
+    scheduler.checkDeadline();
+    QCOMPARE(spySave.count(), 2);
+    m_clock->advanceSecond(1);
+    scheduler.checkDeadline();
+    QCOMPARE(spySave.count(), 3);
+}
+
+void TestAutoSaveScheduler::testFlushAndCancel()
+{
+    AutoSaveScheduler scheduler;
+    scheduler.setQuietPeriod(2000);
+    scheduler.setMaxDelay(5000);
+    QSignalSpy spySave(&scheduler, SIGNAL(saveRequested()));
+
+    // Nothing to save
+    scheduler.flush();
+    QCOMPARE(spySave.count(), 0);
+
+    scheduler.schedule();
+    scheduler.flush();
+    QCOMPARE(spySave.count(), 1);
+    QVERIFY(!scheduler.isPending());
+    QVERIFY(!scheduler.m_timer.isActive());
+
+    scheduler.schedule();
+    scheduler.cancel();
+    QVERIFY(!scheduler.isPending());
+    QVERIFY(!scheduler.m_timer.isActive());
+    m_clock->advanceSecond(10);
+    scheduler.checkDeadline();
+    QCOMPARE(spySave.count(), 1);
+}
+
+void TestAutoSaveScheduler::testTimer()
+{
+    AutoSaveScheduler scheduler;
+    QSignalSpy spySave(&scheduler, SIGNAL(saveRequested()));
+
+    // The deadline already passed, the save is requested once the event loop runs
+    scheduler.schedule();
+    QCOMPARE(spySave.count(), 0);
+    QTRY_COMPARE(spySave.count(), 1);
+    QVERIFY(!scheduler.isPending());
+
+    // A clock turned back does not hold off the save for longer than the maximum delay
+    scheduler.setQuietPeriod(1000);
+    scheduler.setMaxDelay(1000);
+    scheduler.schedule();
+    m_clock->advanceHour(-1);
+    scheduler.checkDeadline();
+    QCOMPARE(scheduler.m_timer.interval(), 1000);
+    scheduler.cancel();
+}
@@ -19,11 +19,14 @@
 #include "TestAutoType.h"
 
 #include <QPluginLoader>
+#include <QSignalSpy>
 #include <QTest>
 
 #include "autotype/AutoType.h"
+#include "autotype/AutoTypeMatchModel.h"
 #include "autotype/AutoTypePlatformPlugin.h"
 #include "autotype/test/AutoTypeTestInterface.h"
+#include "core/AutoTypeAssociations.h"
 #include "core/Config.h"
 #include "core/Group.h"
 #include "core/Resources.h"
@@ -365,6 +368,9 @@ void TestAutoType::testAutoTypeSyntaxChecks()
     QVERIFY2(AutoType::verifyAutoTypeSyntax("{T-REPLACE-RX:/{USERNAME}/a/b/}", entry, error), error.toLatin1());
     QVERIFY2(!AutoType::verifyAutoTypeSyntax("{T-REPLACE-RX:/{USERNAME}/a/}", entry, error), error.toLatin1());
     QVERIFY2(!AutoType::verifyAutoTypeSyntax("{T-REPLACE-RX:}", entry, error), error.toLatin1());
+    QVERIFY2(!AutoType::verifyAutoTypeSyntax("{T-REPLACE-RX:/{USERNAME}/(/b/}", entry, error), error.toLatin1());
+    // TOTP is not generated when checking syntax
+    QVERIFY2(AutoType::verifyAutoTypeSyntax("{TOTP}{ENTER}", entry, error), error.toLatin1());
 }
 
 void TestAutoType::testAutoTypeEffectiveSequences()
@@ -444,3 +450,74 @@ void TestAutoType::testAutoTypeEffectiveSequences()
     QCOMPARE(entry6->defaultAutoTypeSequence(), sequenceOrphan);
     QCOMPARE(entry6->effectiveAutoTypeSequence(), QString());
 }
+
+void TestAutoType::testWindowMatches()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QString, windowTitle);
+    QFETCH(bool, expected);
+
+    QCOMPARE(AutoTypeAssociations::windowMatches(pattern, windowTitle), expected);
+    // The second lookup uses the cached pattern
+    QCOMPARE(AutoTypeAssociations::windowMatches(pattern, windowTitle), expected);
+}
+
+void TestAutoType::testWindowMatches_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QString>("windowTitle");
+    QTest::addColumn<bool>("expected");
+
+    QTest::newRow("Exact") << "Example" << "example" << true;
+    QTest::newRow("Exact with extra text") << "Example" << "Example - Browser" << false;
+    QTest::newRow("Leading wildcard") << "*Browser" << "Example - browser" << true;
+    QTest::newRow("Trailing wildcard") << "example*" << "Example - Browser" << true;
+    QTest::newRow("Inner wildcard") << "Ex*Br*er" << "Example - Browser" << true;
+    QTest::newRow("Inner wildcard out of order") << "Ex*er*Br" << "Example - Browser" << false;
+    QTest::newRow("Overlapping prefix and suffix") << "abc*cde" << "abcde" << false;
+    QTest::newRow("Only wildcard") << "*" << "Anything" << true;
+    QTest::newRow("Double wildcard") << "**Example**" << "My Example Window" << true;
+    QTest::newRow("Literal regex characters") << "a.c (1)?" << "a.c (1)?" << true;
+    QTest::newRow("Literal dot") << "a.c" << "abc" << false;
+    QTest::newRow("Regex substring") << "//ample - B//" << "Example - Browser" << true;
+    QTest::newRow("Regex anchored") << "//^Example$//" << "example" << true;
+    QTest::newRow("Regex no match") << "//^Browser//" << "Example - Browser" << false;
+    QTest::newRow("Invalid regex") << "//[a//" << "[a" << false;
+}
+
+void TestAutoType::testMatchModelUpdates()
+{
+    AutoTypeMatchModel model;
+    QSignalSpy resetSpy(&model, &AutoTypeMatchModel::modelReset);
+    QSignalSpy insertSpy(&model, &AutoTypeMatchModel::rowsInserted);
+    QSignalSpy removeSpy(&model, &AutoTypeMatchModel::rowsRemoved);
+
+    const AutoTypeMatch match1(m_entry1, "1");
+    const AutoTypeMatch match2(m_entry2, "2");
+    const AutoTypeMatch match3(m_entry3, "3");
+    const AutoTypeMatch match4(m_entry4, "4");
+
+    model.setMatchList({match1, match2, match3});
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(model.rowCount(), 3);
+
+    // Refined results update the rows in place
+    model.setMatchList({match1, match3, match4});
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(removeSpy.count(), 1);
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(model.matchFromIndex(model.index(0, 0)), match1);
+    QCOMPARE(model.matchFromIndex(model.index(1, 0)), match3);
+    QCOMPARE(model.matchFromIndex(model.index(2, 0)), match4);
+
+    // Reordered results reset the model
+    model.setMatchList({match4, match1});
+    QCOMPARE(resetSpy.count(), 2);
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.matchFromIndex(model.index(0, 0)), match4);
+
+    // Removed entries are dropped from the model
+    delete m_entry4;
+    QCOMPARE(model.rowCount(), 1);
+    QCOMPARE(model.matchFromIndex(model.index(0, 0)), match1);
+}
@@ -51,6 +51,9 @@ private slots:
     void testAutoTypeResults_data();
     void testAutoTypeSyntaxChecks();
     void testAutoTypeEffectiveSequences();
+    void testWindowMatches();
+    void testWindowMatches_data();
+    void testMatchModelUpdates();
 
 private:
     AutoTypePlatformInterface* m_platform;
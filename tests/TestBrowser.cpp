@@ -17,7 +17,9 @@
 
 #include "TestBrowser.h"
 
+#include "browser/BrowserEntryConfig.h"
 #include "browser/BrowserMessageBuilder.h"
+#include "browser/BrowserRequestTrace.h"
 #include "browser/BrowserSettings.h"
 #include "core/Group.h"
 #include "core/Tools.h"
@@ -91,6 +93,14 @@ void TestBrowser::testDecryptMessage()
     auto decrypted = browserMessageBuilder()->decryptMessage(message, NONCE, PUBLICKEY, SERVERSECRETKEY);
 
     QCOMPARE(decrypted["action"].toString(), QString("test-action"));
+
+    // The shared key is cached per key pair, another key pair must not decrypt the message
+    decrypted = browserMessageBuilder()->decryptMessage(message, NONCE, PUBLICKEY, SERVERSECRETKEY);
+    QCOMPARE(decrypted["action"].toString(), QString("test-action"));
+    decrypted = browserMessageBuilder()->decryptMessage(message, NONCE, SERVERPUBLICKEY, SERVERSECRETKEY);
+    QVERIFY(decrypted.isEmpty());
+    decrypted = browserMessageBuilder()->decryptMessage(message, NONCE, PUBLICKEY, "");
+    QVERIFY(decrypted.isEmpty());
 }
 
 void TestBrowser::testGetBase64FromKey()
@@ -144,6 +154,53 @@ void TestBrowser::testBuildResponse()
     QCOMPARE(firstArr["test"].toBool(), true);
 }
 
+void TestBrowser::testRequestTrace()
+{
+    m_browserAction->m_publicKey = SERVERPUBLICKEY;
+    m_browserAction->m_secretKey = SERVERSECRETKEY;
+    m_browserAction->m_clientPublicKey = PUBLICKEY;
+    const QString message = "+zjtntnk4rGWSl/Ph7Vqip/swvgeupk4lNgHEm2OO3ujNr0OMz6eQtGwjtsj+/rP";
+    BrowserRequestTrace::clearHistory();
+
+    // Nothing is recorded unless enabled
+    browserSettings()->setTraceRequests(false);
+    {
+        BrowserRequestTrace trace("test-action");
+        m_browserAction->decryptMessage(message, NONCE);
+    }
+    QVERIFY(BrowserRequestTrace::history().isEmpty());
+
+    browserSettings()->setTraceRequests(true);
+    {
+        BrowserRequestTrace trace("test-action");
+        m_browserAction->decryptMessage(message, NONCE);
+        {
+            // A request handled while another one waits gets its own trace
+            BrowserRequestTrace nested("nested-action");
+            m_browserAction->buildResponse("nested-action", INCREMENTEDNONCE);
+        }
+        m_browserAction->buildResponse("test-action", INCREMENTEDNONCE);
+    }
+    browserSettings()->setTraceRequests(false);
+
+    const auto history = BrowserRequestTrace::history();
+    QCOMPARE(history.size(), 2);
+    QCOMPARE(history[0].action, QString("nested-action"));
+    QCOMPARE(history[0].spans.size(), 1);
+    QCOMPARE(history[0].spans[0].first, QString("encrypt"));
+    QCOMPARE(history[1].action, QString("test-action"));
+    QCOMPARE(history[1].spans.size(), 2);
+    QCOMPARE(history[1].spans[0].first, QString("decrypt"));
+    QCOMPARE(history[1].spans[1].first, QString("encrypt"));
+    QVERIFY(history[1].totalUsec >= history[1].spans[0].second + history[1].spans[1].second);
+    QVERIFY(history[1].toString().startsWith("test-action: decrypt "));
+
+    // Spans outside of a request are ignored
+    m_browserAction->decryptMessage(message, NONCE);
+    QCOMPARE(BrowserRequestTrace::history().size(), 2);
+    BrowserRequestTrace::clearHistory();
+}
+
 void TestBrowser::testSortPriority()
 {
     QFETCH(QString, entryUrl);
@@ -400,6 +457,56 @@ void TestBrowser::testSearchEntriesWithAdditionalURLs()
     QCOMPARE(additionalResult[0]->url(), QString("https://github.com/"));
 }
 
+void TestBrowser::testSearchEntriesUrlIndex()
+{
+    auto db = QSharedPointer<Database>::create();
+    auto* root = db->rootGroup();
+
+    QStringList urls = {"https://github.com/", "https://www.example.com", "https://accounts.example.co.uk"};
+    auto entries = createEntries(urls, root);
+
+    QCOMPARE(db->urlIndex().candidates("github.com").size(), 1);
+    QCOMPARE(db->urlIndex().candidates("login.www.example.com").size(), 1);
+    QCOMPARE(db->urlIndex().candidates("another.co.uk").size(), 1);
+    QVERIFY(db->urlIndex().candidates("keepassxc.org").isEmpty());
+
+    // The index follows URL changes after it has been built
+    entries[0]->setUrl("https://keepassxc.org");
+    auto result = m_browserService->searchEntries(db, "https://github.com", "https://github.com");
+    QVERIFY(result.isEmpty());
+    result = m_browserService->searchEntries(db, "https://keepassxc.org", "https://keepassxc.org");
+    QCOMPARE(result.length(), 1);
+    QCOMPARE(result[0], entries[0]);
+
+    // Additional URLs as they are added, renamed and removed
+    entries[1]->attributes()->set(EntryAttributes::AdditionalUrlAttribute, "https://github.com");
+    result = m_browserService->searchEntries(db, "https://github.com", "https://github.com");
+    QCOMPARE(result.length(), 1);
+    QCOMPARE(result[0], entries[1]);
+    entries[1]->attributes()->rename(EntryAttributes::AdditionalUrlAttribute, "Notes URL");
+    QVERIFY(m_browserService->searchEntries(db, "https://github.com", "https://github.com").isEmpty());
+    entries[1]->attributes()->rename("Notes URL", EntryAttributes::AdditionalUrlAttribute + "_2");
+    QCOMPARE(m_browserService->searchEntries(db, "https://github.com", "https://github.com").length(), 1);
+    entries[1]->attributes()->remove(EntryAttributes::AdditionalUrlAttribute + "_2");
+    QVERIFY(m_browserService->searchEntries(db, "https://github.com", "https://github.com").isEmpty());
+
+    // Entries with placeholders in an URL are always checked
+    entries[2]->attributes()->set(EntryAttributes::AdditionalUrlAttribute, "https://{USERNAME}.github.com");
+    entries[2]->setUsername("login");
+    result = m_browserService->searchEntries(db, "https://login.github.com", "https://login.github.com");
+    QCOMPARE(result.length(), 1);
+    QCOMPARE(result[0], entries[2]);
+
+    // Entries leave the index with their database
+    auto otherDb = QSharedPointer<Database>::create();
+    entries[0]->setGroup(otherDb->rootGroup());
+    QVERIFY(m_browserService->searchEntries(db, "https://keepassxc.org", "https://keepassxc.org").isEmpty());
+    result = m_browserService->searchEntries(otherDb, "https://keepassxc.org", "https://keepassxc.org");
+    QCOMPARE(result.length(), 1);
+    delete entries[1];
+    QCOMPARE(db->urlIndex().candidates("example.com").size(), 1);
+}
+
 void TestBrowser::testInvalidEntries()
 {
     auto db = QSharedPointer<Database>::create();
@@ -740,3 +847,36 @@ void TestBrowser::testRestrictBrowserKey()
     QCOMPARE(sorted[2]->url(), QString("https://example.com/2"));
     QCOMPARE(sorted[3]->url(), QString("https://example.com/0"));
 }
+
+void TestBrowser::testEntryConfig()
+{
+    Entry entry;
+    BrowserEntryConfig config;
+    QVERIFY(!config.load(&entry));
+
+    config.allow("allowed.example.com");
+    config.deny("denied.example.com");
+    config.setRealm("realm");
+    config.save(&entry);
+
+    // Loaded twice, the second time from the cache of parsed settings
+    for (int i = 0; i < 2; ++i) {
+        BrowserEntryConfig loaded;
+        QVERIFY(loaded.load(&entry));
+        QCOMPARE(loaded.allowedHosts(), QStringList({"allowed.example.com"}));
+        QCOMPARE(loaded.deniedHosts(), QStringList({"denied.example.com"}));
+        QCOMPARE(loaded.realm(), QString("realm"));
+    }
+
+    // Changed settings are parsed again
+    config.allow("denied.example.com");
+    config.save(&entry);
+    BrowserEntryConfig changed;
+    QVERIFY(changed.load(&entry));
+    QVERIFY(changed.isAllowed("denied.example.com"));
+    QVERIFY(!changed.isDenied("denied.example.com"));
+    QCOMPARE(changed.deniedHosts(), QStringList());
+
+    entry.customData()->set(BrowserService::KEEPASSXCBROWSER_NAME, "not json");
+    QVERIFY(!BrowserEntryConfig().load(&entry));
+}
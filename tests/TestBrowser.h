@@ -37,6 +37,7 @@ private slots:
     void testGetBase64FromKey();
     void testIncrementNonce();
     void testBuildResponse();
+    void testRequestTrace();
     void testSortPriority();
     void testSortPriority_data();
     void testSearchEntries();
@@ -45,11 +46,13 @@ private slots:
     void testSearchEntriesByReference();
     void testSearchEntriesWithPort();
     void testSearchEntriesWithAdditionalURLs();
+    void testSearchEntriesUrlIndex();
     void testInvalidEntries();
     void testSubdomainsAndPaths();
     void testBestMatchingCredentials();
     void testBestMatchingWithAdditionalURLs();
     void testRestrictBrowserKey();
+    void testEntryConfig();
 
 private:
     QList<Entry*> createEntries(QStringList& urls, Group* root) const;
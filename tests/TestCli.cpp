@@ -19,6 +19,7 @@
 
 #include "config-keepassx-tests.h"
 #include "core/Bootstrap.h"
+#include "core/Clock.h"
 #include "core/Config.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
@@ -30,14 +31,17 @@
 
 #include "cli/Add.h"
 #include "cli/AddGroup.h"
+#include "cli/Agent.h"
 #include "cli/Analyze.h"
 #include "cli/AttachmentExport.h"
 #include "cli/AttachmentImport.h"
 #include "cli/AttachmentRemove.h"
+#include "cli/Batch.h"
 #include "cli/Clip.h"
 #include "cli/DatabaseCreate.h"
 #include "cli/DatabaseEdit.h"
 #include "cli/DatabaseInfo.h"
+#include "cli/DatabaseOptimize.h"
 #include "cli/Diceware.h"
 #include "cli/Edit.h"
 #include "cli/Estimate.h"
@@ -56,6 +60,10 @@
 #include "cli/Utils.h"
 
 #include <QClipboard>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QSignalSpy>
 #include <QTest>
 #include <QtConcurrent>
@@ -223,6 +231,8 @@ void TestCli::testBatchCommands()
 {
     Commands::setupCommands(false);
     QVERIFY(Commands::getCommand("add"));
+    QVERIFY(Commands::getCommand("agent"));
+    QVERIFY(Commands::getCommand("batch"));
     QVERIFY(Commands::getCommand("analyze"));
     QVERIFY(Commands::getCommand("attachment-export"));
     QVERIFY(Commands::getCommand("attachment-import"));
@@ -231,6 +241,7 @@ void TestCli::testBatchCommands()
     QVERIFY(Commands::getCommand("close"));
     QVERIFY(Commands::getCommand("db-create"));
     QVERIFY(Commands::getCommand("db-info"));
+    QVERIFY(Commands::getCommand("db-optimize"));
     QVERIFY(Commands::getCommand("diceware"));
     QVERIFY(Commands::getCommand("edit"));
     QVERIFY(Commands::getCommand("estimate"));
@@ -248,7 +259,7 @@ void TestCli::testBatchCommands()
     QVERIFY(Commands::getCommand("show"));
     QVERIFY(Commands::getCommand("search"));
     QVERIFY(!Commands::getCommand("doesnotexist"));
-    QCOMPARE(Commands::getCommands().size(), 26);
+    QCOMPARE(Commands::getCommands().size(), 29);
 }
 
 void TestCli::testInteractiveCommands()
@@ -263,6 +274,7 @@ void TestCli::testInteractiveCommands()
     QVERIFY(Commands::getCommand("close"));
     QVERIFY(Commands::getCommand("db-create"));
     QVERIFY(Commands::getCommand("db-info"));
+    QVERIFY(Commands::getCommand("db-optimize"));
     QVERIFY(Commands::getCommand("diceware"));
     QVERIFY(Commands::getCommand("edit"));
     QVERIFY(Commands::getCommand("estimate"));
@@ -279,8 +291,45 @@ void TestCli::testInteractiveCommands()
     QVERIFY(Commands::getCommand("rmdir"));
     QVERIFY(Commands::getCommand("show"));
     QVERIFY(Commands::getCommand("search"));
+    QVERIFY(!Commands::getCommand("agent"));
+    QVERIFY(!Commands::getCommand("batch"));
     QVERIFY(!Commands::getCommand("doesnotexist"));
-    QCOMPARE(Commands::getCommands().size(), 26);
+    QCOMPARE(Commands::getCommands().size(), 27);
+}
+
+void TestCli::testAgent()
+{
+    Agent agentCmd;
+    QVERIFY(!agentCmd.name.isEmpty());
+    QVERIFY(agentCmd.getDescriptionLine().contains(agentCmd.name));
+
+    // The socket only depends on the database file
+    const QFileInfo dbInfo(m_dbFile->fileName());
+    const auto relativePath = QDir::current().relativeFilePath(dbInfo.absoluteFilePath());
+    QCOMPARE(Agent::socketName(relativePath), Agent::socketName(m_dbFile->fileName()));
+    QVERIFY(Agent::socketName(m_dbFile->fileName()) != Agent::socketName(m_dbFile2->fileName()));
+
+    QVERIFY(Agent::isForwardable("show"));
+    QVERIFY(Agent::isForwardable("search"));
+    QVERIFY(!Agent::isForwardable("clip"));
+    QVERIFY(!Agent::isForwardable("edit"));
+    QVERIFY(!Agent::isForwardable("agent"));
+
+    // Without an agent commands unlock the database themselves
+    int exitCode = EXIT_SUCCESS;
+    QVERIFY(!Agent::forward(m_dbFile->fileName(), {"ls", m_dbFile->fileName()}, exitCode));
+    List listCmd;
+    setInput("a");
+    QCOMPARE(execCmd(listCmd, {"ls", m_dbFile->fileName()}), EXIT_SUCCESS);
+    QVERIFY(m_stdout->readAll().contains("Sample Entry"));
+
+    QCOMPARE(execCmd(agentCmd, {"agent", "--stop", m_dbFile->fileName()}), EXIT_FAILURE);
+    QVERIFY(m_stderr->readAll().contains("No agent is running"));
+
+    setInput("a");
+    QCOMPARE(execCmd(agentCmd, {"agent", "-t", "-1", m_dbFile->fileName()}), EXIT_FAILURE);
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray("Invalid timeout value -1.\n"));
 }
 
 void TestCli::testAdd()
@@ -448,6 +497,17 @@ void TestCli::testAnalyze()
     QVERIFY(output.contains("123"));
     m_stderr->readLine(); // Skip password prompt
     QCOMPARE(m_stderr->readAll(), QByteArray());
+
+    // Statistics don't need a HIBP file
+    setInput("a");
+    execCmd(analyzeCmd, {"analyze", "--stats", m_dbFile->fileName()});
+    output = m_stdout->readAll();
+    QVERIFY(output.contains("Number of entries: "));
+    QVERIFY(output.contains("Password lengths: <= 8: "));
+    QVERIFY(output.contains("Days since passwords were modified: <= 30: "));
+    QVERIFY(output.contains("Reused passwords: "));
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
 }
 
 void TestCli::testAttachmentExport()
@@ -586,6 +646,54 @@ void TestCli::testAttachmentImport()
                                   .arg(attachmentPath))));
 }
 
+void TestCli::testBatch()
+{
+    Batch batchCmd;
+    QVERIFY(!batchCmd.name.isEmpty());
+    QVERIFY(batchCmd.getDescriptionLine().contains(batchCmd.name));
+    Commands::setupCommands(false);
+
+    // Commands are read from standard input after the password
+    setInput({"a",
+              "# Comments and empty lines are skipped",
+              "",
+              "show -a username \"/Sample Entry\"",
+              "edit -t \"Renamed Entry\" \"/Sample Entry\"",
+              "mkdir /Batch",
+              "mv \"/Renamed Entry\" /Batch/"});
+    QCOMPARE(execCmd(batchCmd, {"batch", m_dbFile->fileName()}), EXIT_SUCCESS);
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    QCOMPARE(m_stdout->readLine(), QByteArray("User Name\n"));
+    QCOMPARE(m_stdout->readLine(), QByteArray("Successfully edited entry Renamed Entry.\n"));
+    QVERIFY(m_stdout->readAll().endsWith("Successfully saved the database.\n"));
+
+    auto db = readDatabase();
+    QVERIFY(db);
+    QVERIFY(!db->rootGroup()->findEntryByPath("/Sample Entry"));
+    QVERIFY(db->rootGroup()->findEntryByPath("/Batch/Renamed Entry"));
+
+    // A failing command stops the batch without saving earlier changes
+    TemporaryFile commands;
+    QVERIFY(commands.open());
+    commands.write("rm \"/Batch/Renamed Entry\"\nshow /DoesNotExist\nmkdir /NeverCreated\n");
+    commands.close();
+    setInput("a");
+    QCOMPARE(execCmd(batchCmd, {"batch", m_dbFile->fileName(), commands.fileName()}), EXIT_FAILURE);
+    QVERIFY(m_stderr->readAll().contains("Command on line 2 failed"));
+
+    db = readDatabase();
+    QVERIFY(db);
+    QVERIFY(db->rootGroup()->findEntryByPath("/Batch/Renamed Entry"));
+    QVERIFY(!db->rootGroup()->findGroupByPath("/NeverCreated"));
+
+    // Commands working on other databases are refused
+    setInput({"a", "open other.kdbx"});
+    QCOMPARE(execCmd(batchCmd, {"batch", m_dbFile->fileName()}), EXIT_FAILURE);
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray("Invalid command open on line 1.\n"));
+}
+
 void TestCli::testAttachmentRemove()
 {
     AttachmentRemove attachmentRemoveCmd;
@@ -1036,6 +1144,75 @@ void TestCli::testInfo()
     QCOMPARE(m_stdout->readLine(), QByteArray("Cipher: AES 256-bit\n"));
     QCOMPARE(m_stdout->readLine(), QByteArray("KDF: AES (6000 rounds)\n"));
     QCOMPARE(m_stdout->readLine(), QByteArray("Recycle bin is enabled.\n"));
+
+    // Test with timings option.
+    setInput("a");
+    execCmd(infoCmd, {"db-info", "-q", "--timings", m_dbFile->fileName()});
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    auto output = m_stdout->readAll();
+    QVERIFY(output.contains("\nOpen timings: "));
+    QVERIFY(output.contains("\n  header: "));
+    QVERIFY(output.contains("\n  kdf: "));
+    QVERIFY(output.contains("\n  xml: "));
+    QVERIFY(!output.contains("Save timings: "));
+}
+
+void TestCli::testOptimize()
+{
+    DatabaseOptimize optimizeCmd;
+    QVERIFY(!optimizeCmd.name.isEmpty());
+    QVERIFY(optimizeCmd.getDescriptionLine().contains(optimizeCmd.name));
+
+    auto db = readDatabase();
+    QVERIFY(db);
+    db->metadata()->setHistoryMaxItems(1);
+    auto* entry = db->rootGroup()->findEntryByPath("/Sample Entry");
+    QVERIFY(entry);
+    for (int i = 0; i < 3; ++i) {
+        entry->addHistoryItem(entry->clone(Entry::CloneNoFlags));
+    }
+    const int removedItems = entry->historyItems().size() - 1;
+    const QUuid iconUuid = QUuid::createUuid();
+    db->metadata()->addCustomIcon(iconUuid, QByteArray(1024, 'i'));
+    DeletedObject oldObject;
+    oldObject.uuid = QUuid::createUuid();
+    oldObject.deletionTime = Clock::currentDateTimeUtc().addDays(-400);
+    db->addDeletedObject(oldObject);
+    const QUuid recentUuid = QUuid::createUuid();
+    db->addDeletedObject(recentUuid);
+    QVERIFY(db->saveAs(m_dbFile->fileName()));
+
+    setInput("a");
+    execCmd(optimizeCmd, {"db-optimize", "--dry-run", m_dbFile->fileName()});
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    auto output = m_stdout->readAll();
+    QVERIFY(output.contains(
+        QString("Removed %1 history item(s) beyond the history limits.\n").arg(removedItems).toUtf8()));
+    QVERIFY(output.contains(" unused custom icon(s).\n"));
+    QVERIFY(output.contains(" deleted object record(s).\n"));
+    QVERIFY(!output.contains("File size: "));
+
+    setInput("a");
+    execCmd(optimizeCmd, {"db-optimize", m_dbFile->fileName()});
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    output = m_stdout->readAll();
+    QVERIFY(output.contains("\nFile size: "));
+    QVERIFY(output.contains("\nOpen time without key derivation: "));
+
+    db = readDatabase();
+    QVERIFY(db);
+    QCOMPARE(db->rootGroup()->findEntryByPath("/Sample Entry")->historyItems().size(), 1);
+    QVERIFY(!db->metadata()->customIconsOrder().contains(iconUuid));
+    QVERIFY(!db->containsDeletedObject(oldObject.uuid));
+    QVERIFY(db->containsDeletedObject(recentUuid));
+
+    // Keeping all deleted objects leaves nothing to do
+    setInput("a");
+    execCmd(optimizeCmd, {"db-optimize", "-q", "--deleted-objects-days", "-1", m_dbFile->fileName()});
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    QCOMPARE(m_stdout->readAll(), QByteArray());
 }
 
 void TestCli::testDiceware()
@@ -1056,6 +1233,16 @@ void TestCli::testDiceware()
     passphrase = m_stdout->readLine();
     QCOMPARE(passphrase.split(" ").size(), 10);
 
+    execCmd(dicewareCmd, {"diceware", "-W", "3", "--count", "1000"});
+    const auto passphrases = QString::fromUtf8(m_stdout->readAll()).split("\n", QString::SkipEmptyParts);
+    QCOMPARE(passphrases.size(), 1000);
+    for (const auto& line : passphrases) {
+        QCOMPARE(line.split(" ").size(), 3);
+    }
+
+    execCmd(dicewareCmd, {"diceware", "--count", "0"});
+    QCOMPARE(m_stderr->readLine(), QByteArray("Invalid count 0\n"));
+
     // Testing with invalid word count
     execCmd(dicewareCmd, {"diceware", "-W", "-10"});
     QCOMPARE(m_stderr->readLine(), QByteArray("Invalid word count -10\n"));
@@ -1383,6 +1570,46 @@ void TestCli::testGenerate()
     // Testing with invalid word count format
     execCmd(generateCmd, {"generate", "-L", "bleuh"});
     QCOMPARE(m_stderr->readLine(), QByteArray("Invalid password length bleuh\n"));
+
+    // Testing with invalid count
+    execCmd(generateCmd, {"generate", "--count", "-3"});
+    QCOMPARE(m_stderr->readLine(), QByteArray("Invalid count -3\n"));
+}
+
+void TestCli::testGenerateCount()
+{
+    Generate generateCmd;
+
+    execCmd(generateCmd, {"generate", "-L", "12", "-l", "--count", "1000"});
+    const auto passwords = QString::fromUtf8(m_stdout->readAll()).split("\n", QString::SkipEmptyParts);
+    QCOMPARE(passwords.size(), 1000);
+    QRegularExpression regex("^[a-z]{12}$");
+    for (const auto& password : passwords) {
+        QVERIFY2(regex.match(password).hasMatch(), qPrintable("Password " + password + " does not match pattern"));
+    }
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+}
+
+void TestCli::testLeanCommands()
+{
+    Commands::setupCommands(false);
+    for (const auto& name : {"diceware", "estimate", "generate"}) {
+        QVERIFY(Commands::getCommand(name)->lean);
+    }
+    for (const auto& name : {"add", "db-create", "export", "ls", "show"}) {
+        QVERIFY(!Commands::getCommand(name)->lean);
+    }
+}
+
+void TestCli::benchmarkLeanStartup()
+{
+    // What keepassxc-cli does before running generate
+    QBENCHMARK
+    {
+        QVERIFY(Crypto::init(false));
+        Commands::setupCommands(false);
+        execCmd(*Commands::getCommand("generate"), {"generate"});
+    }
 }
 
 void TestCli::testImport()
@@ -1614,6 +1841,54 @@ void TestCli::testList()
     QCOMPARE(m_stdout->readAll(), QByteArray());
 }
 
+void TestCli::testJsonOutput()
+{
+    List listCmd;
+    Search searchCmd;
+    Show showCmd;
+
+    setInput("a");
+    execCmd(listCmd, {"ls", "-R", "--format", "ndjson", "--fields", "path", m_dbFile->fileName()});
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    QCOMPARE(m_stdout->readAll(),
+             QByteArray("{\"path\":\"/Sample Entry\"}\n"
+                        "{\"path\":\"/Homebanking/Subgroup/Subgroup Entry\"}\n"));
+
+    // The summary leaves out protected attributes
+    setInput("a");
+    execCmd(showCmd, {"show", "--format", "ndjson", m_dbFile->fileName(), "/Sample Entry"});
+    auto object = QJsonDocument::fromJson(m_stdout->readLine()).object();
+    QCOMPARE(object.value("title").toString(), QString("Sample Entry"));
+    QCOMPARE(object.value("username").toString(), QString("User Name"));
+    QCOMPARE(object.value("url").toString(), QString("http://www.somesite.com/"));
+    QCOMPARE(object.value("uuid").toString(), QString("9f4544c2ab00c74a8a1a6eaf26cf57e9"));
+    QVERIFY(object.value("tags").isArray());
+    QVERIFY(!object.contains("password"));
+    QCOMPARE(m_stdout->readAll(), QByteArray());
+
+    setInput("a");
+    execCmd(showCmd, {"show", "-s", "--format", "ndjson", m_dbFile->fileName(), "/Sample Entry"});
+    object = QJsonDocument::fromJson(m_stdout->readAll()).object();
+    QCOMPARE(object.value("password").toString(), QString("Password"));
+
+    // Requested fields are always shown, unknown ones are null
+    setInput("a");
+    execCmd(showCmd,
+            {"show", "--format", "ndjson", "--fields", "Password,missing", m_dbFile->fileName(), "/Sample Entry"});
+    QCOMPARE(m_stdout->readAll(), QByteArray("{\"Password\":\"Password\",\"missing\":null}\n"));
+
+    setInput("a");
+    execCmd(searchCmd,
+            {"search", "--format", "ndjson", "--fields", "title,username", m_dbFile->fileName(), "Sample"});
+    QCOMPARE(m_stdout->readAll(), QByteArray("{\"title\":\"Sample Entry\",\"username\":\"User Name\"}\n"));
+
+    setInput("a");
+    QCOMPARE(execCmd(listCmd, {"ls", "--format", "xml", m_dbFile->fileName()}), EXIT_FAILURE);
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray("Invalid output format xml.\n"));
+}
+
 void TestCli::testMerge()
 {
     Merge mergeCmd;
@@ -2055,6 +2330,25 @@ void TestCli::testSearch()
     setInput("a");
     execCmd(searchCmd, {"search", tmpFile.fileName(), "u:User Name"});
     QCOMPARE(m_stdout->readAll(), QByteArray("/Sample Entry\n/Homebanking/Subgroup/Subgroup Entry\n"));
+
+    // Ranked search, ties keep the tree order
+    setInput("a");
+    execCmd(searchCmd, {"search", tmpFile.fileName(), "--limit", "1", "title:Entry"});
+    QCOMPARE(m_stdout->readAll(), QByteArray("/Sample Entry\n"));
+
+    setInput("a");
+    execCmd(searchCmd, {"search", tmpFile.fileName(), "-l", "2", "subgroup entry"});
+    QCOMPARE(m_stdout->readAll(), QByteArray("/Homebanking/Subgroup/Subgroup Entry\n"));
+
+    setInput("a");
+    execCmd(searchCmd, {"search", tmpFile.fileName(), "-l", "5", "Sammple"});
+    QCOMPARE(m_stdout->readAll(), QByteArray("/Sample Entry\n"));
+
+    setInput("a");
+    execCmd(searchCmd, {"search", tmpFile.fileName(), "-l", "none", "Sample"});
+    m_stderr->readLine(); // skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray("Invalid limit value none.\n"));
+    QCOMPARE(m_stdout->readAll(), QByteArray());
 }
 
 void TestCli::testShow()
@@ -44,12 +44,14 @@ private slots:
     void cleanupTestCase();
 
     void testBatchCommands();
+    void testAgent();
     void testAdd();
     void testAddGroup();
     void testAnalyze();
     void testAttachmentExport();
     void testAttachmentImport();
     void testAttachmentRemove();
+    void testBatch();
     void testClip();
     void testCommandParsing_data();
     void testCommandParsing();
@@ -62,13 +64,18 @@ private slots:
     void testExport();
     void testGenerate_data();
     void testGenerate();
+    void testGenerateCount();
+    void testLeanCommands();
+    void benchmarkLeanStartup();
     void testImport();
     void testInfo();
+    void testOptimize();
     void testKeyFileOption();
     void testNoPasswordOption();
     void testHelp();
     void testInteractiveCommands();
     void testList();
+    void testJsonOutput();
     void testMerge();
     void testMergeWithKeys();
     void testMove();
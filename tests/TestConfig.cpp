@@ -17,6 +17,7 @@
 
 #include "TestConfig.h"
 
+#include <QSettings>
 #include <QTest>
 
 #include "config-keepassx-tests.h"
@@ -41,3 +42,72 @@ void TestConfig::testUpgrade()
 
     tempFile.remove();
 }
+
+// values read through the snapshot must follow every write
+void TestConfig::testSnapshot()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.close();
+    Config::createConfigFromFile(tempFile.fileName());
+
+    const auto key = Config::Security_ClearClipboardTimeout;
+    const auto defaultValue = config()->getDefault(key);
+    QCOMPARE(config()->get(key), defaultValue);
+    QCOMPARE(config()->get(key), defaultValue);
+
+    int changedValue = -1;
+    connect(config(), &Config::changed, this, [&](Config::ConfigKey changedKey) {
+        if (changedKey == key) {
+            changedValue = config()->get(key).toInt();
+        }
+    });
+
+    config()->set(key, 42);
+    QCOMPARE(changedValue, 42);
+    QCOMPARE(config()->get(key).toInt(), 42);
+
+    config()->remove(key);
+    QCOMPARE(changedValue, defaultValue.toInt());
+    QCOMPARE(config()->get(key), defaultValue);
+
+    config()->set(key, 7);
+    QCOMPARE(config()->get(key).toInt(), 7);
+    config()->resetToDefaults();
+    QCOMPARE(config()->get(key), defaultValue);
+
+    tempFile.remove();
+}
+
+// changes are kept in memory until they are written together
+void TestConfig::testWriteBehind()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.close();
+    Config::createConfigFromFile(tempFile.fileName(), tempFile.fileName());
+
+    const auto key = Config::Security_ClearClipboardTimeout;
+    const auto name = QStringLiteral("Security/ClearClipboardTimeout");
+    config()->set(key, 42);
+    config()->set(key, 43);
+    QCOMPARE(config()->get(key).toInt(), 43);
+    QVERIFY(!QSettings(tempFile.fileName(), QSettings::IniFormat).contains(name));
+
+    config()->sync();
+    QCOMPARE(QSettings(tempFile.fileName(), QSettings::IniFormat).value(name).toInt(), 43);
+
+    config()->remove(key);
+    QCOMPARE(config()->get(key), config()->getDefault(key));
+    QVERIFY(QSettings(tempFile.fileName(), QSettings::IniFormat).contains(name));
+    config()->sync();
+    QVERIFY(!QSettings(tempFile.fileName(), QSettings::IniFormat).contains(name));
+
+    // Pending changes are written when the config is destroyed
+    config()->set(key, 44);
+    Config::createConfigFromFile(tempFile.fileName(), tempFile.fileName());
+    QCOMPARE(QSettings(tempFile.fileName(), QSettings::IniFormat).value(name).toInt(), 44);
+    QCOMPARE(config()->get(key).toInt(), 44);
+
+    tempFile.remove();
+}
@@ -25,6 +25,8 @@ class TestConfig : public QObject
     Q_OBJECT
 private slots:
     void testUpgrade();
+    void testSnapshot();
+    void testWriteBehind();
 };
 
 #endif // KEEPASSX_TESTCONFIG_H
@@ -62,3 +62,25 @@ void TestCryptoHash::test()
              QByteArray::fromHex("0d41b612584ed39ff72944c29494573e40f4bb95283455fae2e0be1e3565aa9f48057d59e6ffd777970e2"
                                  "82871c25a549a2763e5b724794f312c97021c42f91d"));
 }
+
+void TestCryptoHash::testReuse()
+{
+    // RFC 4231 test cases 1 and 2, computed back to back on the pooled HMAC object
+    QCOMPARE(CryptoHash::hmac("Hi There", QByteArray(20, '\x0b'), CryptoHash::Sha256),
+             QByteArray::fromHex("b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7"));
+    QCOMPARE(CryptoHash::hmac("what do ya want for nothing?", "Jefe", CryptoHash::Sha256),
+             QByteArray::fromHex("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+
+    // reset() drops pending data
+    CryptoHash cryptoHash(CryptoHash::Sha256);
+    cryptoHash.addData("garbage");
+    cryptoHash.reset();
+    cryptoHash.addData("KeePassX");
+    QCOMPARE(cryptoHash.result(),
+             QByteArray::fromHex("0b56e5f65263e747af4a833bd7dd7ad26a64d7a4de7c68e52364893dca0766b4"));
+
+    // result() leaves the object ready for the next message
+    cryptoHash.addData("KeePassX");
+    QCOMPARE(cryptoHash.result(),
+             QByteArray::fromHex("0b56e5f65263e747af4a833bd7dd7ad26a64d7a4de7c68e52364893dca0766b4"));
+}
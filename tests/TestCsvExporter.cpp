@@ -110,3 +110,26 @@ void TestCsvExporter::testNestedGroups()
             .append(ExpectedHeaderLine)
             .append("\"Passwords/Test Group Name/Test Sub Group Name\",\"Test Entry Title\",\"\",\"\",\"\",\"\"")));
 }
+
+void TestCsvExporter::testLargeExport()
+{
+    // Enough rows to be written out in several chunks
+    const int count = 5000;
+    for (int i = 0; i < count; ++i) {
+        auto* entry = new Entry();
+        entry->setGroup(m_db->rootGroup());
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setNotes("Quoted \"notes\" spanning\nmultiple lines");
+    }
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    QVERIFY(m_csvExporter->exportDatabase(&buffer, m_db));
+    auto exported = QString::fromUtf8(buffer.buffer());
+
+    QVERIFY(exported.startsWith(ExpectedHeaderLine));
+    QCOMPARE(exported.count("\"Quoted \"\"notes\"\" spanning\nmultiple lines\""), count);
+    QVERIFY(exported.contains("\"Entry 0\""));
+    QVERIFY(exported.contains(QString("\"Entry %1\"").arg(count - 1)));
+    QCOMPARE(m_csvExporter->exportDatabase(m_db), exported);
+}
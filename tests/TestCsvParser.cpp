@@ -19,6 +19,7 @@
 #include "TestCsvParser.h"
 
 #include <QTest>
+#include <QTextStream>
 
 QTEST_GUILESS_MAIN(TestCsvParser)
 
@@ -37,6 +38,8 @@ void TestCsvParser::init()
     parser->setComment('#');
     parser->setFieldSeparator(',');
     parser->setTextQualifier(QChar('"'));
+    parser->setMaxTableRows(-1);
+    parser->setStopWhenTableFull(false);
 }
 
 void TestCsvParser::cleanup()
@@ -344,3 +347,109 @@ void TestCsvParser::testUnicode()
     QVERIFY(t.at(0).at(2) == "3śAż");
     QVERIFY(t.at(0).at(3) == "żac");
 }
+
+void TestCsvParser::testStreaming()
+{
+    QByteArray data("a,");
+    data.append(QByteArray(65535 - data.size(), 'x'));
+    // The line break is split between two chunks
+    data.append("\r\n");
+    // The quoted field spans a chunk boundary
+    data.append("\"").append(QByteArray(100000, 'y')).append("\"\",b\",c\n");
+    for (int i = 0; i < 3000; ++i) {
+        data.append(QByteArray::number(i)).append(",").append(QByteArray::number(i)).append("\n");
+    }
+    QCOMPARE(file->write(data), qint64(data.size()));
+
+    parser->setMaxTableRows(10);
+    QVERIFY(parser->parse(file.data()));
+    t = parser->getCsvTable();
+    QCOMPARE(t.size(), 10);
+    QCOMPARE(parser->getCsvRows(), 3002);
+    QCOMPARE(parser->getCsvCols(), 2);
+    QCOMPARE(t.at(0).at(1), QString(65533, 'x'));
+    QCOMPARE(t.at(1).at(0), QString(100000, 'y') + "\",b");
+    QCOMPARE(t.at(1).at(1), QString("c"));
+    QCOMPARE(t.at(2).at(0), QString("0"));
+
+    int rows = 0;
+    CsvRow lastRow;
+    QVERIFY(parser->forEachRow([&](const CsvRow& row) {
+        ++rows;
+        lastRow = row;
+        return true;
+    }));
+    QCOMPARE(rows, 3002);
+    QCOMPARE(lastRow, CsvRow({"2999", "2999"}));
+    // The preview table is kept
+    QCOMPARE(parser->getCsvTable(), t);
+
+    // Returning false stops reading
+    rows = 0;
+    parser->forEachRow([&](const CsvRow&) { return ++rows < 5; });
+    QCOMPARE(rows, 5);
+}
+
+void TestCsvParser::testPreview()
+{
+    QTextStream out(file.data());
+    for (int i = 0; i < 100; ++i) {
+        out << i << ";" << i << "\n";
+    }
+
+    parser->setMaxTableRows(10);
+    parser->setStopWhenTableFull(true);
+    QVERIFY(parser->parse(file.data()));
+    QCOMPARE(parser->getCsvTable().size(), 10);
+    QCOMPARE(parser->getCsvCols(), 1);
+    QVERIFY(!parser->isComplete());
+
+    parser->setFieldSeparator(';');
+    QVERIFY(parser->reparse());
+    t = parser->getCsvTable();
+    QCOMPARE(t.size(), 10);
+    QCOMPARE(parser->getCsvCols(), 2);
+
+    // Reading all rows ignores the preview limit
+    int rows = 0;
+    QVERIFY(parser->forEachRow([&](const CsvRow&) {
+        ++rows;
+        return true;
+    }));
+    QCOMPARE(rows, 100);
+    QCOMPARE(parser->getCsvTable(), t);
+    QVERIFY(!parser->isComplete());
+
+    // Previews are cached per set of options and not read again
+    file->remove();
+    parser->setFieldSeparator(',');
+    QVERIFY(parser->reparse());
+    QCOMPARE(parser->getCsvCols(), 1);
+    parser->setFieldSeparator(';');
+    QVERIFY(parser->reparse());
+    QCOMPARE(parser->getCsvTable(), t);
+}
+
+void TestCsvParser::testDetectDialect()
+{
+    QTextStream out(file.data());
+    out << "# exported passwords\n"
+        << "'Title';'User, Name';'Password'\n"
+        << "'a';'b';'c, d'\n"
+        << "'e';'f';'g'\n";
+    QVERIFY(parser->parse(file.data()));
+
+    QChar separator;
+    QChar qualifier;
+    QVERIFY(parser->detectDialect(",;\t", "\"'", separator, qualifier));
+    QCOMPARE(separator, QChar(';'));
+    QCOMPARE(qualifier, QChar('\''));
+
+    parser->setFieldSeparator(separator);
+    parser->setTextQualifier(qualifier);
+    QVERIFY(parser->reparse());
+    t = parser->getCsvTable();
+    QCOMPARE(t.size(), 3);
+    QCOMPARE(t.at(0).at(1), QString("User, Name"));
+    QCOMPARE(t.at(1).at(2), QString("c, d"));
+}
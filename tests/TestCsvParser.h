@@ -56,6 +56,9 @@ private slots:
     void testQuoted();
     void testMultiline();
     void testColumns();
+    void testStreaming();
+    void testPreview();
+    void testDetectDialect();
 
 private:
     QScopedPointer<QTemporaryFile> file;
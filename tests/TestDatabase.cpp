@@ -18,15 +18,23 @@
 
 #include "TestDatabase.h"
 
+#include <QDir>
 #include <QRegularExpression>
 #include <QSignalSpy>
+#include <QTemporaryDir>
 #include <QTest>
+#include <QtConcurrent>
 
 #include "config-keepassx-tests.h"
+#include "core/DatabaseDiagnostics.h"
+#include "core/DatabaseStats.h"
+#include "core/EntrySearcher.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/NetworkFile.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
+#include "format/KdbxXmlWriter.h"
 #include "format/KeePass2Writer.h"
 #include "util/TemporaryFile.h"
 
@@ -102,6 +110,149 @@ void TestDatabase::testSave()
     QVERIFY(QFile::exists(backupFilePath));
     QFile::remove(backupFilePath);
     QVERIFY(!QFile::exists(backupFilePath));
+
+    // The stages of the last save add up in order
+    const auto stages = db->saveTimings().stages();
+    QVERIFY(stages.size() >= 4);
+    QCOMPARE(stages.first().first, QString("backup"));
+    QCOMPARE(stages.last().first, QString("commit"));
+    QVERIFY(db->saveTimings().nsecs("kdf") >= 0);
+    QVERIFY(db->saveTimings().nsecs("xml") >= 0);
+    QVERIFY(!db->loadTimings().isEmpty());
+
+    // Test backup rotation
+    QTemporaryDir backupDir;
+    QVERIFY(backupDir.isValid());
+    backupFilePath = backupDir.filePath("backup.kdbx");
+    db->setBackupGenerations(3);
+    for (int i = 0; i < 4; ++i) {
+        db->metadata()->setName(QString("rotation%1").arg(i));
+        QVERIFY2(db->save(Database::Atomic, backupFilePath, &error), error.toLatin1());
+    }
+    QVERIFY(QFile::exists(backupFilePath));
+    QVERIFY(QFile::exists(backupDir.filePath("backup.1.kdbx")));
+    QVERIFY(QFile::exists(backupDir.filePath("backup.2.kdbx")));
+    QVERIFY(!QFile::exists(backupDir.filePath("backup.3.kdbx")));
+
+    // Backups keep the previous content, also when they share the data of the saved file
+    auto backup = QSharedPointer<Database>::create();
+    QVERIFY(backup->open(backupFilePath, key, &error));
+    QCOMPARE(backup->metadata()->name(), QString("rotation2"));
+    backup = QSharedPointer<Database>::create();
+    QVERIFY(backup->open(backupDir.filePath("backup.2.kdbx"), key, &error));
+    QCOMPARE(backup->metadata()->name(), QString("rotation0"));
+}
+
+void TestDatabase::testSaveInBackground()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    QVERIFY(db->open(tempFile.fileName(), key, &error));
+
+    QSignalSpy spyFinished(db.data(), SIGNAL(backgroundSaveFinished(bool, const QString&)));
+    db->metadata()->setName("test");
+    QVERIFY2(db->saveInBackground(Database::Atomic, {}, &error), error.toLatin1());
+    QVERIFY(db->isSaving());
+    QVERIFY(!db->saveInBackground(Database::Atomic, {}, &error));
+    QVERIFY(spyFinished.wait());
+    QCOMPARE(spyFinished.takeFirst().at(0).toBool(), true);
+    QVERIFY(!db->isSaving());
+    QVERIFY(!db->isModified());
+
+    // Changes made while saving are not written and keep the database modified
+    db->metadata()->setName("test2");
+    QVERIFY2(db->saveInBackground(Database::Atomic, {}, &error), error.toLatin1());
+    db->metadata()->setName("test3");
+    QVERIFY(spyFinished.wait());
+    QCOMPARE(spyFinished.takeFirst().at(0).toBool(), true);
+    QVERIFY(db->isModified());
+
+    auto reloaded = QSharedPointer<Database>::create();
+    QVERIFY(reloaded->open(tempFile.fileName(), key, &error));
+    QCOMPARE(reloaded->metadata()->name(), QString("test2"));
+
+    // A synchronous save waits for the background save
+    QVERIFY2(db->saveInBackground(Database::Atomic, {}, &error), error.toLatin1());
+    QVERIFY2(db->save(Database::Atomic, {}, &error), error.toLatin1());
+    QVERIFY(!db->isSaving());
+    QVERIFY(!db->isModified());
+    reloaded = QSharedPointer<Database>::create();
+    QVERIFY(reloaded->open(tempFile.fileName(), key, &error));
+    QCOMPARE(reloaded->metadata()->name(), QString("test3"));
+
+    // Saves started while the superseded background save reports its outcome are refused
+    bool nestedStarted = true;
+    QString nestedError;
+    auto connection = connect(db.data(), &Database::backgroundSaveFinished, this, [&] {
+        nestedStarted = db->saveInBackground(Database::Atomic, {}, &nestedError);
+    });
+    db->metadata()->setName("test4");
+    QVERIFY2(db->saveInBackground(Database::Atomic, {}, &error), error.toLatin1());
+    QVERIFY2(db->save(Database::Atomic, {}, &error), error.toLatin1());
+    disconnect(connection);
+    QVERIFY(!nestedStarted);
+    QCOMPARE(nestedError, QString("Database save is already in progress."));
+    QVERIFY(!db->isSaving());
+    QVERIFY(!db->isModified());
+}
+
+void TestDatabase::testSaveWithEntryCache()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    QVERIFY(db->open(tempFile.fileName(), key, &error));
+
+    auto* unchanged = new Entry();
+    unchanged->setUuid(QUuid::createUuid());
+    unchanged->setTitle("unchanged");
+    unchanged->setPassword("password1");
+    unchanged->attributes()->set("secret", "secret1", true);
+    unchanged->setGroup(db->rootGroup());
+    auto* changed = new Entry();
+    changed->setUuid(QUuid::createUuid());
+    changed->setTitle("changed");
+    changed->setPassword("password2");
+    changed->setGroup(db->rootGroup());
+    QVERIFY2(db->save(Database::Atomic, {}, &error), error.toLatin1());
+    QCOMPARE(db->xmlEntryCache()->fragments.size(), db->rootGroup()->entriesRecursive().size());
+
+    // The unchanged entry is written from the cache, its protected values are encrypted again
+    changed->setPassword("password3");
+    QVERIFY2(db->save(Database::Atomic, {}, &error), error.toLatin1());
+    QVERIFY2(db->save(Database::Atomic, {}, &error), error.toLatin1());
+
+    auto reloaded = QSharedPointer<Database>::create();
+    QVERIFY(reloaded->open(tempFile.fileName(), key, &error));
+    const auto* reloadedUnchanged = reloaded->rootGroup()->findEntryByUuid(unchanged->uuid());
+    QVERIFY(reloadedUnchanged);
+    QCOMPARE(reloadedUnchanged->password(), QString("password1"));
+    QCOMPARE(reloadedUnchanged->attributes()->value("secret"), QString("secret1"));
+    const auto* reloadedChanged = reloaded->rootGroup()->findEntryByUuid(changed->uuid());
+    QVERIFY(reloadedChanged);
+    QCOMPARE(reloadedChanged->password(), QString("password3"));
+    QCOMPARE(reloadedChanged->historyItems().size(), changed->historyItems().size());
+
+    // Deleted entries are dropped from the cache
+    delete changed;
+    QVERIFY2(db->save(Database::Atomic, {}, &error), error.toLatin1());
+    QVERIFY(!db->xmlEntryCache()->fragments.contains(reloadedChanged->uuid()));
+
+    // The cache is dropped when the database is locked
+    QVERIFY(!db->xmlEntryCache()->fragments.isEmpty());
+    db->releaseData();
+    QVERIFY(db->xmlEntryCache()->fragments.isEmpty());
 }
 
 void TestDatabase::testSaveAs()
@@ -267,4 +418,519 @@ void TestDatabase::testCustomIcons()
     QCOMPARE(iconData.data, icon2);
     QCOMPARE(iconData.name, QString("Test"));
     QCOMPARE(iconData.lastModified, date);
+
+    // Icons are found by their data before and after the hashes are built
+    QCOMPARE(db.metadata()->findCustomIcon(icon1), uuid1);
+    QUuid uuid3 = QUuid::createUuid();
+    QByteArray icon3("icon 3");
+    db.metadata()->addCustomIcon(uuid3, icon3);
+    QCOMPARE(db.metadata()->findCustomIcon(icon3), uuid3);
+    db.metadata()->removeCustomIcon(uuid2);
+    QVERIFY(db.metadata()->findCustomIcon(icon2).isNull());
+    QCOMPARE(db.metadata()->customIconsOrder(), QList<QUuid>({uuid1, uuid3}));
+}
+
+void TestDatabase::testTagListAndCommonUsernames()
+{
+    Database db;
+    auto* root = db.rootGroup();
+    QSignalSpy spyTagListUpdated(&db, SIGNAL(tagListUpdated()));
+
+    auto* entry1 = new Entry();
+    entry1->setGroup(root);
+    entry1->setUsername("Name1");
+    entry1->setTags("tag1,tag2");
+
+    auto* group = new Group();
+    group->setParent(root);
+    auto* entry2 = new Entry();
+    entry2->setGroup(group);
+    entry2->setUsername("Name2");
+    entry2->setTags("tag2");
+    auto* entry3 = new Entry();
+    entry3->setGroup(group);
+    entry3->setUsername("Name2");
+
+    db.updateTagList();
+    db.updateCommonUsernames();
+    QCOMPARE(db.tagList(), QStringList({"tag1", "tag2"}));
+    QCOMPARE(db.commonUsernames(), QStringList({"Name2", "Name1"}));
+    QCOMPARE(spyTagListUpdated.count(), 1);
+
+    // Unchanged tag set does not trigger an update
+    entry2->setNotes("Notes");
+    db.updateTagList();
+    QCOMPARE(spyTagListUpdated.count(), 1);
+
+    entry2->addTag("tag3");
+    entry1->removeTag("tag1");
+    entry3->setUsername("Name3");
+    db.updateTagList();
+    db.updateCommonUsernames();
+    QCOMPARE(db.tagList(), QStringList({"tag2", "tag3"}));
+    QCOMPARE(db.commonUsernames(), QStringList({"Name1", "Name2", "Name3"}));
+    QCOMPARE(spyTagListUpdated.count(), 2);
+
+    // Tags of recycled entries are ignored
+    db.metadata()->setRecycleBinEnabled(true);
+    db.recycleGroup(group);
+    db.updateTagList();
+    QCOMPARE(db.tagList(), QStringList({"tag2"}));
+
+    group->setParent(root);
+    db.updateTagList();
+    QCOMPARE(db.tagList(), QStringList({"tag2", "tag3"}));
+
+    delete group;
+    db.updateTagList();
+    db.updateCommonUsernames();
+    QCOMPARE(db.tagList(), QStringList({"tag2"}));
+    QCOMPARE(db.commonUsernames(), QStringList({"Name1"}));
+}
+
+void TestDatabase::testSshKeyEntries()
+{
+    Database db;
+    auto* root = db.rootGroup();
+
+    auto* plain = new Entry();
+    plain->setGroup(root);
+    plain->attachments()->set("notes.txt", "text");
+
+    auto* group = new Group();
+    group->setParent(root);
+    auto* sshKey = new Entry();
+    sshKey->setGroup(group);
+    sshKey->attachments()->set("KeeAgent.settings", "<EntrySettings/>");
+
+    QCOMPARE(db.sshKeyEntries(), QSet<const Entry*>({sshKey}));
+
+    // Kept up to date once built
+    plain->attachments()->set("KeeAgent.settings", "<EntrySettings/>");
+    QCOMPARE(db.sshKeyEntries(), QSet<const Entry*>({plain, sshKey}));
+    sshKey->attachments()->remove("KeeAgent.settings");
+    QCOMPARE(db.sshKeyEntries(), QSet<const Entry*>({plain}));
+
+    // Entries leaving the database are dropped
+    plain->setGroup(nullptr);
+    QVERIFY(db.sshKeyEntries().isEmpty());
+    delete plain;
+}
+
+void TestDatabase::testPasswordIndex()
+{
+    Database db;
+    auto* root = db.rootGroup();
+
+    auto* first = new Entry();
+    first->setGroup(root);
+    first->setPassword("shared");
+    auto* second = new Entry();
+    second->setGroup(root);
+    second->setPassword("shared");
+    auto* empty = new Entry();
+    empty->setGroup(root);
+
+    const auto& index = db.passwordIndex();
+    QCOMPARE(index.entries().size(), 3);
+    QCOMPARE(index.passwordCount(), 2);
+    QCOMPARE(index.distinctPasswords(), 1);
+    QCOMPARE(index.reuseCount("shared"), 2);
+    QCOMPARE(index.maxReuse(), 2);
+    QCOMPARE(index.shortPasswords(), 2);
+    QCOMPARE(index.totalPasswordLength(), qint64(12));
+    QCOMPARE(index.reuseClusters(), (QMap<int, int>{{2, 1}}));
+
+    QCOMPARE(DatabaseStats::histogram({1, 8, 9, 12, 13}, {8, 12}), QVector<int>({2, 2, 1}));
+    QCOMPARE(DatabaseStats::formatHistogram({2, 2, 1}, {8, 12}), QString("<= 8: 2, 9-12: 2, > 12: 1"));
+
+    // Kept up to date once built
+    second->setPassword("a much longer password");
+    QCOMPARE(db.passwordIndex().reuseCount("shared"), 1);
+    QCOMPARE(db.passwordIndex().distinctPasswords(), 2);
+    QCOMPARE(db.passwordIndex().entriesWithPassword("a much longer password"), QList<const Entry*>({second}));
+
+    // References are counted, but they don't reuse the password
+    empty->setPassword(QString("{REF:P@I:%1}").arg(first->uuidToHex()));
+    QCOMPARE(db.passwordIndex().passwordCount(), 3);
+    QCOMPARE(db.passwordIndex().reuseCount(empty->password()), 0);
+
+    // Recycled and deleted entries are dropped
+    db.recycleEntry(second);
+    QCOMPARE(db.passwordIndex().entries().size(), 2);
+    QCOMPARE(db.passwordIndex().reuseCount("a much longer password"), 0);
+    delete first;
+    QCOMPARE(db.passwordIndex().entries().size(), 1);
+    QCOMPARE(db.passwordIndex().reuseCount("shared"), 0);
+}
+
+void TestDatabase::testReloadFrom()
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    Database db;
+    QVERIFY(db.open(dbFileName, key));
+    auto* root = db.rootGroup();
+    auto* group = new Group();
+    group->setUuid(QUuid::createUuid());
+    group->setName("group");
+    group->setParent(root);
+    auto* kept = new Entry();
+    kept->setUuid(QUuid::createUuid());
+    kept->setTitle("kept");
+    kept->setGroup(root);
+    auto* changed = new Entry();
+    changed->setUuid(QUuid::createUuid());
+    changed->setTitle("changed");
+    changed->setGroup(root);
+    auto* removed = new Entry();
+    removed->setUuid(QUuid::createUuid());
+    removed->setTitle("removed");
+    removed->setGroup(group);
+
+    // The reloaded copy reuses the transformed key, its KDF is the same
+    Database other;
+    other.reuseTransformedKey(&db);
+    QVERIFY(other.open(dbFileName, key));
+    QCOMPARE(other.transformedDatabaseKey(), db.transformedDatabaseKey());
+    delete other.setRootGroup(root->clone(Entry::CloneIncludeHistory, Group::CloneIncludeEntries));
+
+    auto* otherChanged = other.rootGroup()->findEntryByUuid(changed->uuid());
+    otherChanged->setPassword("changed");
+    otherChanged->setGroup(other.rootGroup()->findGroupByUuid(group->uuid()));
+    delete other.rootGroup()->findEntryByUuid(removed->uuid());
+    auto* added = new Entry();
+    added->setUuid(QUuid::createUuid());
+    added->setTitle("added");
+    added->setGroup(other.rootGroup());
+    other.metadata()->setName("reloaded");
+    other.markAsClean();
+
+    QVERIFY(db.reloadFrom(&other));
+    QVERIFY(!db.isModified());
+    QCOMPARE(db.metadata()->name(), QString("reloaded"));
+
+    // Entries are updated in place
+    QCOMPARE(db.rootGroup()->findEntryByUuid(kept->uuid()), kept);
+    QCOMPARE(db.rootGroup()->findEntryByUuid(changed->uuid()), changed);
+    QCOMPARE(changed->password(), QString("changed"));
+    QCOMPARE(changed->group(), group);
+    QVERIFY(!db.rootGroup()->findEntryByUuid(removed->uuid()));
+    QVERIFY(db.rootGroup()->findEntryByUuid(added->uuid()));
+
+    const auto entries = db.rootGroup()->entriesRecursive();
+    const auto otherEntries = other.rootGroup()->entriesRecursive();
+    QCOMPARE(entries.size(), otherEntries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        QVERIFY(entries[i]->equals(otherEntries[i]));
+    }
+
+    // Databases with another root group are not updated
+    Database unrelated;
+    QVERIFY(!db.reloadFrom(&unrelated));
+}
+
+void TestDatabase::testReleaseDataInBackground()
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    Database db;
+    QVERIFY(db.open(dbFileName, key));
+    QPointer<Group> group = new Group();
+    group->setUuid(QUuid::createUuid());
+    group->setParent(db.rootGroup());
+    QPointer<Entry> entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("entry");
+    entry->setTags("tag");
+    entry->setGroup(group);
+    const QUuid entryUuid = entry->uuid();
+    QPointer<Group> oldRoot = db.rootGroup();
+    db.updateTagList();
+    QVERIFY(db.tagList().contains("tag"));
+
+    // Nobody is notified about the removal of single entries and groups
+    QSignalSpy spyEntryRemoved(&db, SIGNAL(entryRemoved(Entry*)));
+    QSignalSpy spyGroupRemoved(&db, SIGNAL(groupRemoved()));
+
+    db.releaseData(true);
+    QVERIFY(db.rootGroup());
+    QVERIFY(db.rootGroup() != oldRoot);
+    QVERIFY(db.rootGroup()->entriesRecursive().isEmpty());
+    QVERIFY(!db.rootGroup()->findEntryByUuid(entryUuid));
+    QVERIFY(db.deletedObjects().isEmpty());
+    db.updateTagList();
+    QVERIFY(db.tagList().isEmpty());
+
+    QTRY_VERIFY(oldRoot.isNull());
+    QVERIFY(group.isNull());
+    QVERIFY(entry.isNull());
+    QCOMPARE(spyEntryRemoved.count(), 0);
+    QCOMPARE(spyGroupRemoved.count(), 0);
+}
+
+void TestDatabase::testReadSnapshot()
+{
+    Database db;
+    auto* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("entry");
+    entry->setUrl("https://www.example.com/login");
+    entry->setGroup(db.rootGroup());
+
+    auto snapshot = db.readSnapshot();
+    QVERIFY(snapshot);
+    QVERIFY(!snapshot->thread());
+    QVERIFY(snapshot->rootGroup() != db.rootGroup());
+    // The snapshot is shared until the database changes
+    QCOMPARE(db.readSnapshot(), snapshot);
+
+    QFuture<QStringList> future = QtConcurrent::run([snapshot] {
+        QStringList titles;
+        for (const Entry* snapshotEntry : snapshot->rootGroup()->entriesRecursive()) {
+            if (!snapshotEntry->fingerprint().isEmpty()) {
+                titles << snapshotEntry->title() + " " + snapshotEntry->parsedUrls().value(0).host;
+            }
+        }
+        return titles;
+    });
+    QCOMPARE(future.result(), QStringList() << "entry www.example.com");
+
+    entry->setTitle("changed");
+    auto changedSnapshot = db.readSnapshot();
+    QVERIFY(changedSnapshot != snapshot);
+    QCOMPARE(changedSnapshot->rootGroup()->entries().first()->title(), QString("changed"));
+    // Earlier snapshots are not affected by changes
+    QCOMPARE(snapshot->rootGroup()->entries().first()->title(), QString("entry"));
+}
+
+void TestDatabase::testNetworkFileCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filePath = dir.filePath("remote.kdbx");
+    const QString cacheDir = dir.filePath("cache");
+
+    auto writeFile = [&](const QByteArray& content, const QDateTime& modified) {
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(content);
+        QVERIFY(file.flush());
+        QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    };
+    const QDateTime modified = QDateTime::currentDateTime().addSecs(-60);
+    writeFile("first", modified);
+
+    QByteArray data;
+    QVERIFY(NetworkFile::read(filePath, data));
+    QCOMPARE(data, QByteArray("first"));
+    QVERIFY(QDir(cacheDir).isEmpty());
+
+    NetworkFile::setCacheDirectory(cacheDir);
+    QVERIFY(NetworkFile::read(filePath, data));
+    QCOMPARE(data, QByteArray("first"));
+    QCOMPARE(QDir(cacheDir).entryList(QDir::Files).size(), 1);
+
+    // The local copy is used while the size and modification time are unchanged
+    writeFile("other", modified);
+    QVERIFY(NetworkFile::read(filePath, data));
+    QCOMPARE(data, QByteArray("first"));
+
+    writeFile("other", modified.addSecs(1));
+    QVERIFY(NetworkFile::read(filePath, data));
+    QCOMPARE(data, QByteArray("other"));
+
+    // Written files replace the local copy
+    writeFile("second", modified.addSecs(2));
+    NetworkFile::updateCache(filePath, "second");
+    writeFile("secret", modified.addSecs(2));
+    QVERIFY(NetworkFile::read(filePath, data));
+    QCOMPARE(data, QByteArray("second"));
+
+    NetworkFile::setCacheDirectory({});
+    QVERIFY(NetworkFile::read(filePath, data));
+    QCOMPARE(data, QByteArray("secret"));
+    QVERIFY(!NetworkFile::read(dir.filePath("missing.kdbx"), data));
+}
+
+void TestDatabase::testLazyHistoryLoading()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    auto db = QSharedPointer<Database>::create();
+    QVERIFY(db->open(tempFile.fileName(), key, &error));
+    auto* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("title0");
+    entry->setPassword("password0");
+    entry->setGroup(db->rootGroup());
+    for (int i = 1; i < 3; ++i) {
+        entry->beginUpdate();
+        entry->setTitle(QString("title%1").arg(i));
+        entry->setPassword(QString("password%1").arg(i));
+        entry->endUpdate();
+    }
+    QCOMPARE(entry->historyItems().size(), 2);
+    QVERIFY2(db->save(Database::Atomic, {}, &error), error.toLatin1());
+
+    auto lazy = QSharedPointer<Database>::create();
+    lazy->setLazyHistoryLoading(true);
+    QVERIFY(lazy->open(tempFile.fileName(), key, &error));
+    auto* lazyEntry = lazy->rootGroup()->findEntryByUuid(entry->uuid());
+    QVERIFY(lazyEntry);
+    QVERIFY(lazyEntry->serializedHistory());
+    QCOMPARE(lazyEntry->historyCount(), 2);
+    QCOMPARE(lazyEntry->password(), QString("password2"));
+
+    // Untouched history items are copied into the file as they were read
+    QVERIFY2(lazy->save(Database::Atomic, {}, &error), error.toLatin1());
+    QVERIFY(lazyEntry->serializedHistory());
+    QVERIFY2(lazy->save(Database::Atomic, {}, &error), error.toLatin1());
+
+    // Items that cannot be copied are loaded into the snapshot of a background save
+    lazy->metadata()->setProtectTitle(!lazy->metadata()->protectTitle());
+    QSignalSpy spyFinished(lazy.data(), SIGNAL(backgroundSaveFinished(bool, const QString&)));
+    QVERIFY2(lazy->saveInBackground(Database::Atomic, {}, &error), error.toLatin1());
+    QVERIFY(spyFinished.wait());
+    QCOMPARE(spyFinished.takeFirst().at(0).toBool(), true);
+    QVERIFY(lazyEntry->serializedHistory());
+
+    // Read snapshots keep the history serialized, readers do not load it
+    auto snapshot = lazy->readSnapshot();
+    const auto* snapshotEntry = snapshot->rootGroup()->findEntryByUuid(entry->uuid());
+    QVERIFY(snapshotEntry);
+    QVERIFY(snapshotEntry->serializedHistory());
+    QFuture<int> future = QtConcurrent::run([snapshotEntry] { return snapshotEntry->historyItems().size(); });
+    QCOMPARE(future.result(), 0);
+    QVERIFY(snapshotEntry->serializedHistory());
+    QCOMPARE(snapshotEntry->historyCount(), 2);
+
+    auto reloaded = QSharedPointer<Database>::create();
+    QVERIFY(reloaded->open(tempFile.fileName(), key, &error));
+    const auto* reloadedEntry = reloaded->rootGroup()->findEntryByUuid(entry->uuid());
+    QVERIFY(reloadedEntry);
+    QVERIFY(!reloadedEntry->serializedHistory());
+    QCOMPARE(reloadedEntry->historyItems().size(), 2);
+    QCOMPARE(reloadedEntry->historyItems().at(0)->title(), QString("title0"));
+    QCOMPARE(reloadedEntry->historyItems().at(1)->password(), QString("password1"));
+
+    // The items are loaded when they are accessed
+    const QList<Entry*> items = lazyEntry->historyItems();
+    QVERIFY(!lazyEntry->serializedHistory());
+    QCOMPARE(items.size(), 2);
+    QCOMPARE(items.at(0)->uuid(), entry->uuid());
+    QCOMPARE(items.at(0)->password(), QString("password0"));
+    QCOMPARE(items.at(1)->title(), QString("title1"));
+    QVERIFY(items.at(1)->equals(reloadedEntry->historyItems().at(1), CompareItemIgnoreMilliseconds));
+}
+
+void TestDatabase::testDiagnostics()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    auto db = QSharedPointer<Database>::create();
+    QVERIFY(db->open(tempFile.fileName(), key, &error));
+    QVERIFY(!db->loadTimings().isEmpty());
+
+    const QByteArray attachment(64 * 1024, 'a');
+    auto* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("diagnostics");
+    entry->attachments()->set("file.bin", attachment);
+    entry->setGroup(db->rootGroup());
+    entry->beginUpdate();
+    entry->setTitle("diagnostics changed");
+    entry->endUpdate();
+    QCOMPARE(entry->historyItems().size(), 1);
+
+    // The attachment shared with the history item is counted once
+    DatabaseDiagnostics diagnostics(db);
+    QVERIFY(diagnostics.historyCount >= 1);
+    QVERIFY(diagnostics.attachmentBytes >= attachment.size());
+    QVERIFY(diagnostics.attachmentBytes < 2 * attachment.size());
+    QVERIFY(diagnostics.attributeBytes > 0);
+    QVERIFY(diagnostics.totalBytes() > diagnostics.attachmentBytes);
+    QCOMPARE(diagnostics.searchCount, quint64(0));
+    QCOMPARE(diagnostics.searchP50, qint64(-1));
+
+    // Unchanged entries are copied from the cache on the second save
+    QVERIFY2(db->save(Database::Atomic, {}, &error), error.toLatin1());
+    QCOMPARE(db->counters().entryCacheLookups().hits, quint64(0));
+    QVERIFY2(db->save(Database::Atomic, {}, &error), error.toLatin1());
+    const auto entryCache = db->counters().entryCacheLookups();
+    QVERIFY(entryCache.hits > 0);
+    QCOMPARE(entryCache.misses, quint64(0));
+
+    EntrySearcher searcher;
+    searcher.searchCached("diagnostics", db->rootGroup());
+    searcher.searchCached("diagnostics", db->rootGroup());
+    const auto searchCache = db->counters().searchCacheLookups();
+    QCOMPARE(searchCache.hits, quint64(1));
+    QCOMPARE(searchCache.misses, quint64(1));
+
+    for (int i = 1; i <= 100; ++i) {
+        db->counters().recordSearch(i * 1000);
+    }
+    diagnostics = DatabaseDiagnostics(db);
+    QCOMPARE(diagnostics.searchCount, quint64(100));
+    QCOMPARE(diagnostics.searchP50, qint64(50 * 1000));
+    QCOMPARE(diagnostics.searchP90, qint64(90 * 1000));
+    QCOMPARE(diagnostics.searchP99, qint64(99 * 1000));
+    QVERIFY(!diagnostics.saveTimings.isEmpty());
+
+    // Only the most recent searches are kept
+    for (int i = 0; i < DatabaseCounters::MaxRecentSearches; ++i) {
+        db->counters().recordSearch(1);
+    }
+    QCOMPARE(DatabaseCounters::percentile(db->counters().recentSearches(), 99), qint64(1));
+
+    db->releaseData();
+    QCOMPARE(db->counters().searchCount(), quint64(0));
+}
+
+void TestDatabase::testImport()
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    Database db;
+    QVERIFY(db.open(dbFileName, key));
+
+    TemporaryFile xmlExport;
+    QVERIFY(xmlExport.open());
+    QVERIFY(db.extract(&xmlExport));
+    xmlExport.close();
+
+    Database imported;
+    QSignalSpy spyModified(&imported, SIGNAL(modified()));
+    qint64 lastDone = 0;
+    qint64 lastTotal = 0;
+    QVERIFY(imported.import(xmlExport.fileName(), nullptr, [&](qint64 done, qint64 total) {
+        QVERIFY(done >= lastDone);
+        lastDone = done;
+        lastTotal = total;
+    }));
+
+    QCOMPARE(lastTotal, xmlExport.size());
+    QVERIFY(lastDone > 0);
+    // Imported groups and entries are added in one batch update
+    QVERIFY(spyModified.count() <= 1);
+    QCOMPARE(imported.rootGroup()->entriesRecursive().size(), db.rootGroup()->entriesRecursive().size());
+    QCOMPARE(imported.rootGroup()->groupsRecursive(true).size(), db.rootGroup()->groupsRecursive(true).size());
+
+    QString error;
+    QVERIFY(!imported.import(xmlExport.fileName() + ".missing", &error));
+    QVERIFY(!error.isEmpty());
 }
@@ -30,12 +30,24 @@ private slots:
     void testOpen();
     void testSave();
     void testSaveAs();
+    void testSaveInBackground();
+    void testSaveWithEntryCache();
     void testSignals();
     void testEmptyRecycleBinOnDisabled();
     void testEmptyRecycleBinOnNotCreated();
     void testEmptyRecycleBinOnEmpty();
     void testEmptyRecycleBinWithHierarchicalData();
     void testCustomIcons();
+    void testTagListAndCommonUsernames();
+    void testSshKeyEntries();
+    void testPasswordIndex();
+    void testReloadFrom();
+    void testReleaseDataInBackground();
+    void testReadSnapshot();
+    void testNetworkFileCache();
+    void testLazyHistoryLoading();
+    void testDiagnostics();
+    void testImport();
 };
 
 #endif // KEEPASSX_TESTDATABASE_H
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestDeferredTaskQueue.h"
+
+#include "core/DeferredTaskQueue.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(TestDeferredTaskQueue)
+
+void TestDeferredTaskQueue::testPriorityOrder()
+{
+    DeferredTaskQueue queue;
+    QSignalSpy spyFinished(&queue, SIGNAL(finished()));
+    QStringList order;
+
+    queue.schedule(DeferredTaskQueue::Low, "low1", [&] { order << "low1"; });
+    queue.schedule(DeferredTaskQueue::Normal, "normal1", [&] { order << "normal1"; });
+    queue.schedule(DeferredTaskQueue::High, "high1", [&] { order << "high1"; });
+    queue.schedule(DeferredTaskQueue::Low, "low2", [&] { order << "low2"; });
+    queue.schedule(DeferredTaskQueue::High, "high2", [&] { order << "high2"; });
+
+    // Nothing runs before the event loop is entered
+    QVERIFY(order.isEmpty());
+    QVERIFY(!queue.isEmpty());
+
+    QTRY_COMPARE(spyFinished.count(), 1);
+    QCOMPARE(order, QStringList({"high1", "high2", "normal1", "low1", "low2"}));
+    QVERIFY(queue.isEmpty());
+}
+
+void TestDeferredTaskQueue::testScheduleWhileRunning()
+{
+    DeferredTaskQueue queue;
+    QSignalSpy spyFinished(&queue, SIGNAL(finished()));
+    QStringList order;
+
+    queue.schedule(DeferredTaskQueue::Normal, "first", [&] {
+        order << "first";
+        // Scheduled from a running task, still ordered by priority
+        queue.schedule(DeferredTaskQueue::High, "nested", [&] { order << "nested"; });
+    });
+    queue.schedule(DeferredTaskQueue::Normal, "second", [&] { order << "second"; });
+
+    QTRY_COMPARE(spyFinished.count(), 1);
+    QCOMPARE(order, QStringList({"first", "nested", "second"}));
+}
+
+void TestDeferredTaskQueue::testClear()
+{
+    DeferredTaskQueue queue;
+    QSignalSpy spyFinished(&queue, SIGNAL(finished()));
+    bool ran = false;
+
+    queue.schedule(DeferredTaskQueue::High, "task", [&] { ran = true; });
+    queue.clear();
+    QVERIFY(queue.isEmpty());
+
+    QTest::qWait(50);
+    QVERIFY(!ran);
+    QCOMPARE(spyFinished.count(), 0);
+}
@@ -164,3 +164,42 @@ void TestDeletedObjects::testCustomIconDeletion()
     QCOMPARE(db.deletedObjects().size(), 1);
     QCOMPARE(db.deletedObjects().at(0).uuid, uuid);
 }
+
+void TestDeletedObjects::testDeletedObjectLookup()
+{
+    Database db;
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+
+    QList<QUuid> uuids;
+    for (int i = 0; i < 4; ++i) {
+        uuids << QUuid::createUuid();
+        db.addDeletedObject({uuids.last(), now.addDays(-100 * i)});
+    }
+    // A duplicate is only forgotten with its last copy
+    db.addDeletedObject({uuids.at(0), now.addDays(-1000)});
+
+    for (const auto& uuid : uuids) {
+        QVERIFY(db.containsDeletedObject(uuid));
+    }
+    QVERIFY(!db.containsDeletedObject(QUuid::createUuid()));
+
+    db.truncateDeletedObjects(4);
+    QCOMPARE(db.deletedObjects().size(), 4);
+    QVERIFY(db.containsDeletedObject(uuids.at(0)));
+
+    QCOMPARE(db.compactDeletedObjects(now.addDays(-150)), 2);
+    QCOMPARE(db.deletedObjects().size(), 2);
+    QVERIFY(db.containsDeletedObject(uuids.at(0)));
+    QVERIFY(db.containsDeletedObject(uuids.at(1)));
+    QVERIFY(!db.containsDeletedObject(uuids.at(2)));
+    QVERIFY(!db.containsDeletedObject(uuids.at(3)));
+    // Serialization order is kept
+    QCOMPARE(db.deletedObjects().at(0).uuid, uuids.at(0));
+    QCOMPARE(db.deletedObjects().at(1).uuid, uuids.at(1));
+
+    QCOMPARE(db.compactDeletedObjects(now.addDays(-150)), 0);
+
+    db.setDeletedObjects({{uuids.at(3), now}});
+    QVERIFY(!db.containsDeletedObject(uuids.at(0)));
+    QVERIFY(db.containsDeletedObject(uuids.at(3)));
+}
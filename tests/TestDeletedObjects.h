@@ -35,6 +35,7 @@ private slots:
     void testDeletedObjectsFromNewDb();
     void testDatabaseChange();
     void testCustomIconDeletion();
+    void testDeletedObjectLookup();
 };
 
 #endif // KEEPASSX_TESTDELETEDOBJECTS_H
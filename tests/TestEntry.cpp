@@ -16,14 +16,18 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QBuffer>
 #include <QTest>
 
 #include "TestEntry.h"
+#include "config-keepassx.h"
 #include "core/Clock.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/TimeInfo.h"
 #include "crypto/Crypto.h"
+#include "crypto/CryptoHash.h"
+#include "mock/MockClock.h"
 
 QTEST_GUILESS_MAIN(TestEntry)
 
@@ -589,6 +593,217 @@ void TestEntry::testResolveClonedEntry()
     QCOMPARE(cclone4->resolveMultiplePlaceholders(cclone4->password()), original->password());
 }
 
+void TestEntry::testResolveCachedPlaceholders()
+{
+    Database db;
+    auto* root = db.rootGroup();
+
+    auto* entry1 = new Entry();
+    entry1->setGroup(root);
+    entry1->setUuid(QUuid::createUuid());
+    entry1->setTitle("Title1");
+    entry1->setUsername("Username1");
+
+    auto* entry2 = new Entry();
+    entry2->setGroup(root);
+    entry2->setUuid(QUuid::createUuid());
+    entry2->setTitle("Title2");
+    entry2->attributes()->set("Attribute", "Value");
+    entry2->setNotes(QString("{TITLE} {S:Attribute} {REF:U@I:%1}").arg(entry1->uuidToHex()));
+
+    // Resolve twice to make sure the memoized result is identical
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->notes()), QString("Title2 Value Username1"));
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->notes()), QString("Title2 Value Username1"));
+
+    // Changes to the entry itself
+    entry2->setTitle("NewTitle2");
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->notes()), QString("NewTitle2 Value Username1"));
+    entry2->attributes()->set("Attribute", "NewValue");
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->notes()), QString("NewTitle2 NewValue Username1"));
+
+    // Changes to the referenced entry
+    entry1->setUsername("NewUsername1");
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->notes()), QString("NewTitle2 NewValue NewUsername1"));
+
+    // Removal of the referenced entry
+    delete entry1;
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->notes()), QString("NewTitle2 NewValue "));
+
+    // Time based placeholders are never memoized
+    entry2->setNotes("{DT_UTC_SIMPLE}");
+    MockClock::setup(new MockClock(2010, 5, 5, 10, 30, 10));
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->notes()), QString("20100505103010"));
+    MockClock::setup(new MockClock(2011, 6, 6, 11, 31, 11));
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->notes()), QString("20110606113111"));
+    MockClock::teardown();
+}
+
+void TestEntry::testAttributeKeysShared()
+{
+    Entry entry1;
+    Entry entry2;
+
+    // Build the key at runtime to make sure it does not come from a shared literal
+    const QString key = QString("Custom%1").arg("Key");
+    entry1.attributes()->set(key, "Value1");
+    entry2.attributes()->set(QString("Custom%1").arg("Key"), "Value2", true);
+    QCOMPARE(entry1.attributes()->value(key), QString("Value1"));
+    QCOMPARE(entry2.attributes()->value(key), QString("Value2"));
+    QVERIFY(entry2.attributes()->isProtected(key));
+
+    auto findKey = [](const Entry& entry, const QString& key) {
+        const auto keys = entry.attributes()->keys();
+        return keys.at(keys.indexOf(key));
+    };
+    QCOMPARE(findKey(entry1, key).constData(), findKey(entry2, key).constData());
+    QCOMPARE(findKey(entry1, EntryAttributes::TitleKey).constData(), EntryAttributes::TitleKey.constData());
+
+    entry2.attributes()->rename(key, QString("Renamed%1").arg("Key"));
+    entry1.attributes()->rename(key, QString("Renamed%1").arg("Key"));
+    QCOMPARE(findKey(entry1, "RenamedKey").constData(), findKey(entry2, "RenamedKey").constData());
+    QVERIFY(entry2.attributes()->isProtected("RenamedKey"));
+}
+
+void TestEntry::testHistoryItemDataShared()
+{
+    Entry entry;
+    entry.setTitle(QString("Title%1").arg(1));
+    entry.setNotes(QString("Notes%1").arg(1));
+    entry.attachments()->set("attachment", QByteArray("data").repeated(10));
+
+    // Simulate a history item read from a file with its own copies of the data
+    auto* historyItem = new Entry();
+    historyItem->setTitle(QString("Title%1").arg(1));
+    historyItem->setNotes(QString("Notes%1").arg(2));
+    historyItem->attachments()->set("attachment", QByteArray("data").repeated(10));
+    QVERIFY(historyItem->title().constData() != entry.title().constData());
+
+    entry.addHistoryItem(historyItem);
+    QCOMPARE(historyItem->title(), entry.title());
+    QCOMPARE(historyItem->title().constData(), entry.title().constData());
+    QCOMPARE(historyItem->notes(), QString("Notes2"));
+    QCOMPARE(historyItem->attachments()->value("attachment").constData(),
+             entry.attachments()->value("attachment").constData());
+
+    // A second item shares with the previous snapshot
+    auto* historyItem2 = new Entry();
+    historyItem2->setTitle(QString("Title%1").arg(1));
+    historyItem2->setNotes(QString("Notes%1").arg(2));
+    entry.addHistoryItem(historyItem2);
+    QCOMPARE(historyItem2->notes().constData(), historyItem->notes().constData());
+    QCOMPARE(historyItem2->title().constData(), entry.title().constData());
+}
+
+void TestEntry::testAttachmentHash()
+{
+    Entry entry;
+    auto* attachments = entry.attachments();
+    QVERIFY(attachments->hash("missing").isEmpty());
+
+    attachments->set("a", QByteArray("data1"));
+    QCOMPARE(attachments->hash("a"), CryptoHash::hash("data1", CryptoHash::Sha256));
+
+    attachments->set("a", QByteArray("data2"));
+    QCOMPARE(attachments->hash("a"), CryptoHash::hash("data2", CryptoHash::Sha256));
+
+    attachments->rename("a", "b");
+    QVERIFY(attachments->hash("a").isEmpty());
+    QCOMPARE(attachments->hash("b"), CryptoHash::hash("data2", CryptoHash::Sha256));
+
+    QScopedPointer<Entry> clone(entry.clone(Entry::CloneNoFlags));
+    QCOMPARE(clone->attachments()->hash("b"), CryptoHash::hash("data2", CryptoHash::Sha256));
+    clone->attachments()->set("b", QByteArray("data3"));
+    QCOMPARE(clone->attachments()->hash("b"), CryptoHash::hash("data3", CryptoHash::Sha256));
+    QCOMPARE(attachments->hash("b"), CryptoHash::hash("data2", CryptoHash::Sha256));
+
+    attachments->clear();
+    QVERIFY(attachments->hash("b").isEmpty());
+}
+
+void TestEntry::testAttachmentStreaming()
+{
+    Entry entry;
+    auto* attachments = entry.attachments();
+
+    // Spans several chunks and does not end on a chunk boundary
+    QByteArray data(3 * 1024 * 1024 + 17, '\0');
+    for (int i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i % 251);
+    }
+
+    QBuffer source(&data);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    qint64 lastDone = 0;
+    int progressCalls = 0;
+    QVERIFY(attachments->importFromDevice("file", &source, nullptr, [&](qint64 done, qint64 total) {
+        lastDone = done;
+        ++progressCalls;
+        return total == data.size();
+    }));
+    QCOMPARE(attachments->value("file"), data);
+    QCOMPARE(lastDone, qint64(data.size()));
+    QVERIFY(progressCalls > 1);
+
+    QByteArray exported;
+    QBuffer target(&exported);
+    QVERIFY(target.open(QIODevice::WriteOnly));
+    QVERIFY(attachments->exportToDevice("file", &target));
+    QCOMPARE(exported, data);
+
+    // Canceling keeps the attachment unchanged
+    source.seek(0);
+    QString errorMessage;
+    QVERIFY(!attachments->importFromDevice("other", &source, &errorMessage, [](qint64, qint64) { return false; }));
+    QVERIFY(!attachments->hasKey("other"));
+    QVERIFY(errorMessage.isEmpty());
+
+    exported.clear();
+    target.seek(0);
+    QVERIFY(!attachments->exportToDevice("file", &target, &errorMessage, [](qint64, qint64) { return false; }));
+    QCOMPARE(exported.size(), 1024 * 1024);
+    QVERIFY(errorMessage.isEmpty());
+
+    // Reading a device that is not open fails with its error
+    QBuffer closed;
+    QVERIFY(!attachments->importFromDevice("closed", &closed, &errorMessage));
+    QVERIFY(!attachments->hasKey("closed"));
+    QVERIFY(!errorMessage.isEmpty());
+}
+
+void TestEntry::testSize()
+{
+    Entry entry;
+    // Keys of the default attributes
+    const int baseSize = QString("TitleUserNamePasswordURLNotes").size();
+    QCOMPARE(entry.size(), baseSize);
+
+    entry.setTitle("title");
+    QCOMPARE(entry.size(), baseSize + 5);
+    entry.setTitle("üü");
+    QCOMPARE(entry.size(), baseSize + 4);
+
+    entry.attributes()->set("key", "value");
+    QCOMPARE(entry.size(), baseSize + 4 + 8);
+    entry.attributes()->rename("key", "k");
+    QCOMPARE(entry.size(), baseSize + 4 + 6);
+    entry.attributes()->remove("k");
+    QCOMPARE(entry.size(), baseSize + 4);
+
+    entry.setTags("tag1;tag2,a:b");
+    QCOMPARE(entry.size(), baseSize + 4 + 10);
+
+    entry.attachments()->set("file", QByteArray(100, 'x'));
+    QCOMPARE(entry.size(), baseSize + 4 + 10 + 104);
+
+    QScopedPointer<Entry> clone(entry.clone(Entry::CloneNoFlags));
+    QCOMPARE(clone->size(), entry.size());
+    clone->setNotes("notes");
+    QCOMPARE(clone->size(), entry.size() + 5);
+
+    entry.attributes()->clear();
+    QCOMPARE(entry.size(), baseSize + 10 + 104);
+}
+
 void TestEntry::testIsRecycled()
 {
     auto entry = new Entry();
@@ -768,3 +983,152 @@ void TestEntry::testPreviousParentGroup()
     QVERIFY(entry->previousParentGroupUuid() == group1->uuid());
     QVERIFY(entry->previousParentGroup() == group1);
 }
+
+void TestEntry::testParsedUrls()
+{
+    Database db;
+    auto* entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    entry->setUrl("https://login.example.com:8443/path");
+    entry->attributes()->set(EntryAttributes::AdditionalUrlAttribute, "example.org/login");
+
+    auto urls = entry->parsedUrls();
+    QCOMPARE(urls.size(), 2);
+    QCOMPARE(urls[0].url, QString("https://login.example.com:8443/path"));
+    QVERIFY(urls[0].hasScheme);
+    QCOMPARE(urls[0].scheme, QString("https"));
+    QCOMPARE(urls[0].host, QString("login.example.com"));
+    QCOMPARE(urls[0].port, 8443);
+    QCOMPARE(urls[0].path, QString("/path"));
+    QVERIFY(!urls[1].hasScheme);
+    QCOMPARE(urls[1].host, QString("example.org"));
+    QCOMPARE(urls[1].port, -1);
+#if defined(WITH_XC_NETWORKING) || defined(WITH_XC_BROWSER)
+    QCOMPARE(urls[0].baseDomain(), QString("example.com"));
+#endif
+
+    // Attribute changes are picked up
+    entry->setUrl("https://keepassxc.org");
+    QCOMPARE(entry->parsedUrls().size(), 2);
+    QCOMPARE(entry->parsedUrls().first().host, QString("keepassxc.org"));
+    entry->attributes()->remove(EntryAttributes::AdditionalUrlAttribute);
+    QCOMPARE(entry->parsedUrls().size(), 1);
+
+    // So are changes of referenced entries
+    auto* other = new Entry();
+    other->setGroup(db.rootGroup());
+    other->setUuid(QUuid::createUuid());
+    other->setUrl("https://first.example.com");
+    entry->setUrl(QString("{REF:A@I:%1}").arg(other->uuidToHex()));
+    QCOMPARE(entry->parsedUrls().first().host, QString("first.example.com"));
+    other->setUrl("https://second.example.com");
+    QCOMPARE(entry->parsedUrls().first().host, QString("second.example.com"));
+}
+
+void TestEntry::testFingerprint()
+{
+    Database db;
+    auto* entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("Title");
+    entry->setPassword("secret");
+    entry->attachments()->set("a.txt", "attachment");
+
+    QScopedPointer<Entry> clone(entry->clone(Entry::CloneIncludeHistory));
+    QCOMPARE(clone->fingerprint(), entry->fingerprint());
+
+    // The location is merged separately
+    auto* group = new Group();
+    group->setParent(db.rootGroup());
+    entry->setGroup(group);
+    QCOMPARE(clone->fingerprint(), entry->fingerprint());
+
+    const QByteArray fingerprint = entry->fingerprint();
+    entry->setPassword("other");
+    QVERIFY(entry->fingerprint() != fingerprint);
+    entry->setPassword("secret");
+
+    TimeInfo timeInfo = clone->timeInfo();
+    entry->setTimeInfo(timeInfo);
+    QCOMPARE(entry->fingerprint(), clone->fingerprint());
+
+    entry->attachments()->set("a.txt", "changed");
+    QVERIFY(entry->fingerprint() != clone->fingerprint());
+    entry->attachments()->set("a.txt", "attachment");
+    entry->setTimeInfo(timeInfo);
+    QCOMPARE(entry->fingerprint(), clone->fingerprint());
+
+    // History changes are seen even with blocked signals
+    const bool blocked = entry->blockSignals(true);
+    entry->addHistoryItem(clone->clone(Entry::CloneNoFlags));
+    entry->blockSignals(blocked);
+    QVERIFY(entry->fingerprint() != clone->fingerprint());
+}
+
+void TestEntry::testTimeInfo()
+{
+    const QDateTime time(QDate(2020, 5, 17), QTime(13, 42, 7, 512), Qt::UTC);
+
+    TimeInfo timeInfo;
+    timeInfo.setLastModificationTime(time);
+    QCOMPARE(timeInfo.lastModificationTime(), time);
+    QCOMPARE(timeInfo.lastModificationTime().timeSpec(), Qt::UTC);
+
+    // Invalid times are kept as they are
+    timeInfo.setLocationChanged(QDateTime());
+    QVERIFY(!timeInfo.locationChanged().isValid());
+
+    TimeInfo other = timeInfo;
+    QVERIFY(other == timeInfo);
+    other.setLastModificationTime(time.addMSecs(-500));
+    QVERIFY(other != timeInfo);
+    QVERIFY(other.equals(timeInfo, CompareItemIgnoreMilliseconds));
+    other.setLastModificationTime(time.addMSecs(-600));
+    QVERIFY(!other.equals(timeInfo, CompareItemIgnoreMilliseconds));
+
+    // The expiry time only counts when the item expires
+    other = timeInfo;
+    other.setExpiryTime(time);
+    QVERIFY(other != timeInfo);
+    QVERIFY(other.equals(timeInfo, CompareItemIgnoreDisabled));
+    other.setExpires(true);
+    QVERIFY(!other.equals(timeInfo, CompareItemIgnoreDisabled));
+
+    QVERIFY(other.isExpiredAt(time.addMSecs(1)));
+    QVERIFY(!other.isExpiredAt(time));
+    other.setExpires(false);
+    QVERIFY(!other.isExpiredAt(time.addDays(1)));
+}
+
+void TestEntry::testCustomData()
+{
+    Entry entry;
+    QVERIFY(entry.customData()->isEmpty());
+
+    entry.customData()->set("b", "2");
+    entry.customData()->set("c", "3");
+    entry.customData()->set("a", "1");
+    QCOMPARE(entry.customData()->keys(), QList<QString>({CustomData::LastModified, "a", "b", "c"}));
+    QCOMPARE(entry.customData()->value("b"), QString("2"));
+    QVERIFY(!entry.customData()->contains("d"));
+    QVERIFY(entry.customData()->value("d").isNull());
+
+    entry.customData()->set("b", "changed");
+    QCOMPARE(entry.customData()->value("b"), QString("changed"));
+    QCOMPARE(entry.customData()->size(), 4);
+
+    // Copies do not change with the original
+    QScopedPointer<Entry> clone(entry.clone(Entry::CloneNoFlags));
+    QCOMPARE(*clone->customData(), *entry.customData());
+    entry.customData()->rename("a", "d");
+    QCOMPARE(entry.customData()->keys(), QList<QString>({CustomData::LastModified, "b", "c", "d"}));
+    QCOMPARE(clone->customData()->keys(), QList<QString>({CustomData::LastModified, "a", "b", "c"}));
+    QVERIFY(*clone->customData() != *entry.customData());
+
+    entry.customData()->remove("b");
+    entry.customData()->remove("c");
+    entry.customData()->remove("d");
+    QVERIFY(entry.customData()->isEmpty());
+    QCOMPARE(clone->customData()->size(), 4);
+}
@@ -37,9 +37,19 @@ private slots:
     void testResolveReferencePlaceholders();
     void testResolveNonIdPlaceholdersToUuid();
     void testResolveClonedEntry();
+    void testResolveCachedPlaceholders();
+    void testAttributeKeysShared();
+    void testHistoryItemDataShared();
+    void testAttachmentHash();
+    void testAttachmentStreaming();
+    void testSize();
     void testIsRecycled();
     void testMoveUpDown();
     void testPreviousParentGroup();
+    void testParsedUrls();
+    void testFingerprint();
+    void testTimeInfo();
+    void testCustomData();
 };
 
 #endif // KEEPASSX_TESTENTRY_H
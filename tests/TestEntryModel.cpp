@@ -20,8 +20,10 @@
 #include <QSignalSpy>
 #include <QTest>
 
+#include "core/Database.h"
 #include "core/Entry.h"
 #include "core/Group.h"
+#include "core/Metadata.h"
 #include "crypto/Crypto.h"
 #include "gui/DatabaseIcons.h"
 #include "gui/IconModels.h"
@@ -29,7 +31,9 @@
 #include "gui/entry/AutoTypeAssociationsModel.h"
 #include "gui/entry/EntryAttachmentsModel.h"
 #include "gui/entry/EntryAttributesModel.h"
+#include "gui/entry/EntryHistoryModel.h"
 #include "gui/entry/EntryModel.h"
+#include "gui/tag/TagModel.h"
 #include "modeltest.h"
 
 QTEST_GUILESS_MAIN(TestEntryModel)
@@ -243,21 +247,36 @@ void TestEntryModel::testCustomIconModel()
 
     QCOMPARE(model->rowCount(), 0);
 
-    QHash<QUuid, QPixmap> icons;
-    QList<QUuid> iconsOrder;
-
+    Database db;
     QUuid iconUuid = QUuid::fromRfc4122(QByteArray(16, '2'));
-    icons.insert(iconUuid, QPixmap());
-    iconsOrder << iconUuid;
+    db.metadata()->addCustomIcon(iconUuid, QByteArray("icon2"));
 
     QUuid iconUuid2 = QUuid::fromRfc4122(QByteArray(16, '1'));
-    icons.insert(iconUuid2, QPixmap());
-    iconsOrder << iconUuid2;
+    db.metadata()->addCustomIcon(iconUuid2, QByteArray("icon1"));
 
-    model->setIcons(icons, iconsOrder);
+    model->setIcons(&db);
+    QCOMPARE(model->rowCount(), 2);
     QCOMPARE(model->uuidFromIndex(model->index(0, 0)), iconUuid);
     QCOMPARE(model->uuidFromIndex(model->index(1, 0)), iconUuid2);
 
+    // Icons are shown a page at a time
+    QList<QUuid> iconsOrder = db.metadata()->customIconsOrder();
+    for (int i = iconsOrder.size(); i < CustomIconModel::PageSize * 2 + 1; ++i) {
+        auto uuid = QUuid::createUuid();
+        db.metadata()->addCustomIcon(uuid, QByteArray::number(i));
+        iconsOrder << uuid;
+    }
+    model->setIcons(&db);
+    QCOMPARE(model->rowCount(), CustomIconModel::PageSize);
+    QVERIFY(model->canFetchMore({}));
+    model->fetchMore({});
+    QCOMPARE(model->rowCount(), CustomIconModel::PageSize * 2);
+
+    // Looking up an icon fetches the pages up to it
+    QCOMPARE(model->indexFromUuid(iconsOrder.last()).row(), iconsOrder.size() - 1);
+    QCOMPARE(model->rowCount(), iconsOrder.size());
+    QVERIFY(!model->canFetchMore({}));
+
     delete modelTest;
     delete model;
 }
@@ -346,6 +365,54 @@ void TestEntryModel::testProxyModel()
     delete db;
 }
 
+void TestEntryModel::testProxyModelSort()
+{
+    auto modelSource = new EntryModel(this);
+    auto modelProxy = new SortFilterHideProxyModel(this);
+    modelProxy->setSourceModel(modelSource);
+    modelProxy->setDynamicSortFilter(true);
+    modelProxy->setSortRole(Qt::UserRole);
+
+    auto db = new Database();
+    const QStringList usernames = {"user10", "user9", "user2"};
+    QList<Entry*> entries;
+    for (const auto& username : usernames) {
+        auto entry = new Entry();
+        entry->setUsername(username);
+        entry->setGroup(db->rootGroup());
+        entries << entry;
+    }
+    modelSource->setGroup(db->rootGroup());
+
+    auto sortedUsernames = [&]() {
+        QStringList result;
+        for (int row = 0; row < modelProxy->rowCount(); ++row) {
+            result << modelProxy->index(row, EntryModel::Username).data(Qt::UserRole).toString();
+        }
+        return result;
+    };
+
+    // Numbers are sorted by value
+    modelProxy->sort(EntryModel::Username, Qt::AscendingOrder);
+    QCOMPARE(sortedUsernames(), QStringList({"user2", "user9", "user10"}));
+
+    // Changed data is sorted by its new value
+    entries.at(2)->setUsername("user11");
+    QCOMPARE(sortedUsernames(), QStringList({"user9", "user10", "user11"}));
+
+    // Placeholders are sorted by their resolved value
+    entries.at(1)->setUsername("{TITLE}");
+    entries.at(1)->setTitle("user0");
+    QCOMPARE(sortedUsernames(), QStringList({"user0", "user10", "user11"}));
+
+    modelProxy->sort(EntryModel::Username, Qt::DescendingOrder);
+    QCOMPARE(sortedUsernames(), QStringList({"user11", "user10", "user0"}));
+
+    delete modelProxy;
+    delete modelSource;
+    delete db;
+}
+
 void TestEntryModel::testDatabaseDelete()
 {
     auto model = new EntryModel(this);
@@ -376,3 +443,218 @@ void TestEntryModel::testDatabaseDelete()
     delete modelTest;
     delete model;
 }
+
+void TestEntryModel::testBatchUpdate()
+{
+    Database db;
+    auto* group = new Group();
+    group->setParent(db.rootGroup());
+
+    auto* entry1 = new Entry();
+    entry1->setGroup(group);
+
+    auto* model = new EntryModel(this);
+    auto* modelTest = new ModelTest(model, this);
+    model->setGroup(group);
+    QCOMPARE(model->rowCount(), 1);
+
+    QSignalSpy spyReset(model, SIGNAL(modelReset()));
+    QSignalSpy spyAdded(model, SIGNAL(rowsInserted(QModelIndex, int, int)));
+    QSignalSpy spyRemoved(model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+    QSignalSpy spyDataChanged(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+
+    // Changes outside of the shown group don't reset the model
+    {
+        Database::BatchUpdate batch(&db);
+        auto* other = new Entry();
+        other->setGroup(db.rootGroup());
+    }
+    QCOMPARE(spyReset.count(), 0);
+
+    {
+        Database::BatchUpdate batch(&db);
+        Database::BatchUpdate nestedBatch(&db);
+        for (int i = 0; i < 10; ++i) {
+            auto* entry = new Entry();
+            entry->setGroup(group);
+            entry->setTitle(QString("Entry %1").arg(i));
+        }
+        delete entry1;
+        QCOMPARE(spyReset.count(), 0);
+    }
+
+    QCOMPARE(spyReset.count(), 1);
+    QCOMPARE(spyAdded.count(), 0);
+    QCOMPARE(spyRemoved.count(), 0);
+    QCOMPARE(spyDataChanged.count(), 0);
+    QCOMPARE(model->rowCount(), 10);
+    QCOMPARE(model->data(model->index(0, 1)).toString(), QString("Entry 0"));
+
+    // Deleting the shown group in a batch leaves an empty model
+    {
+        Database::BatchUpdate batch(&db);
+        delete group;
+    }
+    QCOMPARE(spyReset.count(), 2);
+    QCOMPARE(model->rowCount(), 0);
+
+    // Batches of the previously shown database don't end a reset of the current one
+    Database db2;
+    auto* entry2 = new Entry();
+    entry2->setGroup(db2.rootGroup());
+    model->setGroup(db2.rootGroup());
+    QCOMPARE(spyReset.count(), 3);
+    {
+        Database::BatchUpdate batch(&db2);
+        entry2->setTitle("Changed");
+        {
+            Database::BatchUpdate otherBatch(&db);
+        }
+        QCOMPARE(spyReset.count(), 3);
+    }
+    QCOMPARE(spyReset.count(), 4);
+    QCOMPARE(model->data(model->index(0, 1)).toString(), QString("Changed"));
+
+    delete modelTest;
+    delete model;
+}
+
+void TestEntryModel::testPopulateBatches()
+{
+    Database db;
+    auto* group = new Group();
+    group->setParent(db.rootGroup());
+
+    const int count = EntryModel::PopulateBatchSize * 2 + 10;
+    QList<Entry*> entries;
+    for (int i = 0; i < count; ++i) {
+        auto* entry = new Entry();
+        entry->setTitle(QString::number(i));
+        entry->setGroup(i % 2 ? group : db.rootGroup());
+        entries << entry;
+    }
+
+    auto* model = new EntryModel(this);
+    auto* modelTest = new ModelTest(model, this);
+
+    // Only the first batch is shown right away
+    model->setEntries(entries);
+    QCOMPARE(model->rowCount(), EntryModel::PopulateBatchSize);
+    QCOMPARE(model->entryFromIndex(model->index(0, EntryModel::Title)), entries.first());
+
+    // Entries that are not shown yet can be deleted
+    delete entries.takeLast();
+    // Entries appended meanwhile are shown after the pending ones
+    auto* appended = new Entry();
+    appended->setGroup(group);
+    model->appendEntries({appended});
+    entries << appended;
+
+    QTRY_COMPARE(model->rowCount(), entries.size());
+    for (int row = 0; row < entries.size(); ++row) {
+        QCOMPARE(model->entryFromIndex(model->index(row, EntryModel::Title)), entries.at(row));
+    }
+
+    // Changes are followed across all groups of the list
+    QSignalSpy spyDataChanged(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+    entries.at(1)->setTitle("changed");
+    QVERIFY(!spyDataChanged.isEmpty());
+    QCOMPARE(spyDataChanged.last().at(0).value<QModelIndex>().row(), 1);
+
+    delete entries.takeAt(0);
+    QCOMPARE(model->rowCount(), entries.size());
+    QCOMPARE(model->entryFromIndex(model->index(0, EntryModel::Title)), entries.first());
+
+    // Entries outside of the list are ignored
+    auto* other = new Entry();
+    other->setGroup(group);
+    other->setTitle("other");
+    delete other;
+    QCOMPARE(model->rowCount(), entries.size());
+
+    delete modelTest;
+    delete model;
+}
+
+void TestEntryModel::testTagModelUpdates()
+{
+    auto db = QSharedPointer<Database>::create();
+    auto entry1 = new Entry();
+    entry1->setGroup(db->rootGroup());
+    entry1->setTags("alpha;gamma");
+    auto entry2 = new Entry();
+    entry2->setGroup(db->rootGroup());
+    entry2->setTags("gamma");
+    db->updateTagList();
+
+    TagModel model;
+    model.setDatabase(db);
+    const int tagListStart = model.rowCount() - 2;
+    QCOMPARE(model.index(tagListStart).data().toString(), QString("alpha"));
+    QCOMPARE(model.index(tagListStart + 1).data().toString(), QString("gamma"));
+
+    QSignalSpy spyReset(&model, SIGNAL(modelReset()));
+    QSignalSpy spyInserted(&model, SIGNAL(rowsInserted(QModelIndex, int, int)));
+    QSignalSpy spyRemoved(&model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+
+    // Tags are inserted and removed in place
+    entry1->setTags("beta;gamma");
+    db->updateTagList();
+    QCOMPARE(spyReset.count(), 0);
+    QCOMPARE(spyInserted.count(), 1);
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(model.rowCount(), tagListStart + 2);
+    QCOMPARE(model.index(tagListStart).data().toString(), QString("beta"));
+    QCOMPARE(model.index(tagListStart + 1).data().toString(), QString("gamma"));
+    QCOMPARE(model.index(tagListStart).data(Qt::UserRole).toString(), QString("tag:\"beta\""));
+
+    // Saved searches are inserted before the tags
+    db->metadata()->addSavedSearch("search", "user:foo");
+    QCOMPARE(spyReset.count(), 0);
+    QCOMPARE(spyInserted.count(), 2);
+    QCOMPARE(model.rowCount(), tagListStart + 3);
+    QCOMPARE(model.index(tagListStart).data().toString(), QString("search"));
+    QCOMPARE(model.itemType(model.index(tagListStart)), TagModel::SAVED_SEARCH);
+    QCOMPARE(model.itemType(model.index(tagListStart + 1)), TagModel::TAG);
+
+    delete entry2;
+    delete entry1;
+    db->updateTagList();
+    QCOMPARE(spyReset.count(), 0);
+    QCOMPARE(model.rowCount(), tagListStart + 1);
+}
+
+void TestEntryModel::testHistoryModel()
+{
+    const auto now = QDateTime::currentDateTimeUtc();
+    QList<QSharedPointer<Entry>> versions;
+    for (int i = 0; i < 3; ++i) {
+        auto entry = QSharedPointer<Entry>::create();
+        entry->setUpdateTimeinfo(false);
+        entry->setTitle("title");
+        entry->setUsername(i > 0 ? "user2" : "user1");
+        entry->setPassword(i > 1 ? "pass2" : "pass1");
+        TimeInfo timeInfo;
+        timeInfo.setLastModificationTime(now.addSecs(i - 3));
+        entry->setTimeInfo(timeInfo);
+        versions << entry;
+    }
+
+    EntryHistoryModel model;
+    model.setEntries({versions[0].data(), versions[1].data()}, versions[2].data());
+    QCOMPARE(model.rowCount(), 3);
+
+    // Rows are ordered from newest to oldest, each compared to the next older one
+    QCOMPARE(model.index(0, 2).data().toString(), QString("Password"));
+    QCOMPARE(model.index(1, 2).data().toString(), QString("Username"));
+    QCOMPARE(model.index(2, 2).data().toString(), QString());
+    QCOMPARE(model.index(0, 3).data(Qt::UserRole).toInt(), versions[2]->size());
+
+    // Deleting a version compares its newer neighbor to the next older one
+    QSignalSpy spyDataChanged(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)));
+    model.deleteIndex(model.index(1, 0));
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(spyDataChanged.count(), 1);
+    QCOMPARE(model.index(0, 2).data().toString(), QString("Username, Password"));
+    QCOMPARE(model.deletedEntries(), QList<Entry*>() << versions[1].data());
+}
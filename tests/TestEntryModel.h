@@ -33,7 +33,12 @@ private slots:
     void testCustomIconModel();
     void testAutoTypeAssociationsModel();
     void testProxyModel();
+    void testProxyModelSort();
     void testDatabaseDelete();
+    void testBatchUpdate();
+    void testPopulateBatches();
+    void testTagModelUpdates();
+    void testHistoryModel();
 };
 
 #endif // KEEPASSX_TESTENTRYMODEL_H
@@ -39,6 +39,16 @@ private slots:
     void testGroup();
     void testSkipProtected();
     void testUUIDSearch();
+    void testSearchIndex();
+    void testRefineSearch();
+    void testChunkedSearch();
+    void testParallelSearch();
+    void testSearchPlan();
+    void testCaseFoldedFields();
+    void testCachedSearch();
+    void testRankedSearch();
+    void testRankedSearchDatabases();
+    void testAttachmentContentSearch();
 
 private:
     Group* m_rootGroup;
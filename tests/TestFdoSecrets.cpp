@@ -33,6 +33,38 @@ void TestFdoSecrets::testDhIetf1024Sha256Aes128CbcPkcs7()
     QVERIFY(cipher.isValid());
 }
 
+void TestFdoSecrets::testEncryptAll()
+{
+    FdoSecrets::DhIetf1024Sha256Aes128CbcPkcs7 server(randomGen()->randomArray(128));
+    QVERIFY(server.isValid());
+    FdoSecrets::DhIetf1024Sha256Aes128CbcPkcs7 client(server.negotiationOutput().toByteArray());
+    QVERIFY(client.isValid());
+    QVERIFY(server.updateClientPublicKey(client.negotiationOutput().toByteArray()));
+
+    QList<FdoSecrets::Secret> inputs;
+    for (int i = 0; i != 5; ++i) {
+        FdoSecrets::Secret secret;
+        secret.value = QByteArray("secret").repeated(i);
+        secret.contentType = QStringLiteral("text/plain");
+        inputs << secret;
+    }
+
+    const auto outputs = server.encryptAll(inputs);
+    QCOMPARE(outputs.size(), inputs.size());
+    QSet<QByteArray> IVs;
+    for (int i = 0; i != outputs.size(); ++i) {
+        IVs << outputs.at(i).parameters;
+        auto decrypted = client.decrypt(outputs.at(i));
+        QCOMPARE(decrypted.value, inputs.at(i).value);
+        QCOMPARE(decrypted.contentType, inputs.at(i).contentType);
+    }
+    // every secret still gets its own IV
+    QCOMPARE(IVs.size(), inputs.size());
+
+    FdoSecrets::PlainCipher plain;
+    QCOMPARE(plain.encryptAll(inputs).size(), inputs.size());
+}
+
 void TestFdoSecrets::testCrazyAttributeKey()
 {
     using FdoSecrets::Collection;
@@ -26,6 +26,7 @@ class TestFdoSecrets : public QObject
 
 private slots:
     void testDhIetf1024Sha256Aes128CbcPkcs7();
+    void testEncryptAll();
     void testCrazyAttributeKey();
     void testSpecialCharsInAttributeValue();
     void testDBusPathParse();
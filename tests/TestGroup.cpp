@@ -422,6 +422,54 @@ void TestGroup::testClone()
             != originalGroup->timeInfo().lastModificationTime());
 }
 
+void TestGroup::testCloneTree()
+{
+    Database db;
+    auto group1 = new Group();
+    group1->setUuid(QUuid::createUuid());
+    group1->setParent(db.rootGroup());
+    auto group2 = new Group();
+    group2->setUuid(QUuid::createUuid());
+    group2->setParent(group1);
+
+    auto entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setGroup(group2);
+    entry->setTitle("Title");
+    auto historyItem = entry->clone(Entry::CloneNoFlags);
+    entry->addHistoryItem(historyItem);
+    entry->setTitle("New title");
+
+    m_clock->advanceDay(1);
+
+    QScopedPointer<Group> clone(db.rootGroup()->clone(Entry::CloneIncludeHistory, Group::CloneIncludeEntries));
+    QCOMPARE(clone->children().size(), 1);
+    Group* clonedGroup1 = clone->children().first();
+    QCOMPARE(clonedGroup1->parentGroup(), clone.data());
+    QCOMPARE(clonedGroup1->parent(), clone.data());
+    QCOMPARE(clonedGroup1->uuid(), group1->uuid());
+    Group* clonedGroup2 = clonedGroup1->children().first();
+    QCOMPARE(clonedGroup2->parentGroup(), clonedGroup1);
+
+    Entry* clonedEntry = clonedGroup2->entries().first();
+    QCOMPARE(clonedEntry->group(), clonedGroup2);
+    QCOMPARE(clonedEntry->title(), QString("New title"));
+    QCOMPARE(clonedEntry->historyItems().size(), 1);
+    QCOMPARE(clonedEntry->historyItems().first()->uuid(), entry->uuid());
+    QCOMPARE(clonedEntry->historyItems().first()->title(), QString("Title"));
+
+    // An exact copy keeps the times of the original
+    QCOMPARE(clonedEntry->timeInfo(), entry->timeInfo());
+    QCOMPARE(clonedGroup2->timeInfo(), group2->timeInfo());
+
+    // The cloned tree works like any other once it is added to a database
+    Database other;
+    clonedGroup1->setParent(other.rootGroup());
+    QCOMPARE(other.rootGroup()->findEntryByUuid(entry->uuid()), clonedEntry);
+    QCOMPARE(other.rootGroup()->findGroupByUuid(group2->uuid()), clonedGroup2);
+    QCOMPARE(clonedEntry->database(), &other);
+}
+
 void TestGroup::testCopyCustomIcons()
 {
     QScopedPointer<Database> dbSource(new Database());
@@ -554,6 +602,108 @@ void TestGroup::testFindEntry()
     QVERIFY(!entry);
 }
 
+void TestGroup::testFindByUuidIndex()
+{
+    QScopedPointer<Database> db(new Database());
+    QScopedPointer<Database> db2(new Database());
+
+    auto group1 = new Group();
+    group1->setUuid(QUuid::createUuid());
+    group1->setParent(db->rootGroup());
+
+    auto group2 = new Group();
+    group2->setUuid(QUuid::createUuid());
+    group2->setParent(db->rootGroup());
+
+    auto entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setGroup(group1);
+
+    QCOMPARE(db->rootGroup()->findEntryByUuid(entry->uuid()), entry);
+    QCOMPARE(group1->findEntryByUuid(entry->uuid(), false), entry);
+    QVERIFY(!db->rootGroup()->findEntryByUuid(entry->uuid(), false));
+    QVERIFY(!group2->findEntryByUuid(entry->uuid()));
+    QCOMPARE(db->rootGroup()->findGroupByUuid(group1->uuid()), group1);
+    QVERIFY(!group2->findGroupByUuid(group1->uuid()));
+
+    // Changing the uuid updates the index
+    const QUuid oldUuid = entry->uuid();
+    entry->setUuid(QUuid::createUuid());
+    QVERIFY(!db->rootGroup()->findEntryByUuid(oldUuid));
+    QCOMPARE(db->rootGroup()->findEntryByUuid(entry->uuid()), entry);
+
+    const QUuid oldGroupUuid = group2->uuid();
+    group2->setUuid(QUuid::createUuid());
+    QVERIFY(!db->rootGroup()->findGroupByUuid(oldGroupUuid));
+    QCOMPARE(db->rootGroup()->findGroupByUuid(group2->uuid()), group2);
+
+    // Moving within the database
+    entry->setGroup(group2);
+    QVERIFY(!group1->findEntryByUuid(entry->uuid()));
+    QCOMPARE(group2->findEntryByUuid(entry->uuid()), entry);
+
+    // Moving to another database
+    group2->setParent(db2->rootGroup());
+    QVERIFY(!db->rootGroup()->findGroupByUuid(group2->uuid()));
+    QVERIFY(!db->rootGroup()->findEntryByUuid(entry->uuid()));
+    QCOMPARE(db2->rootGroup()->findGroupByUuid(group2->uuid()), group2);
+    QCOMPARE(db2->rootGroup()->findEntryByUuid(entry->uuid()), entry);
+
+    // Deleting removes from the index
+    const QUuid entryUuid = entry->uuid();
+    delete entry;
+    QVERIFY(!db2->rootGroup()->findEntryByUuid(entryUuid));
+
+    const QUuid group1Uuid = group1->uuid();
+    delete group1;
+    QVERIFY(!db->rootGroup()->findGroupByUuid(group1Uuid));
+}
+
+void TestGroup::testReferencesRecursive()
+{
+    Database db;
+    auto root = db.rootGroup();
+
+    auto target = new Entry();
+    target->setUuid(QUuid::createUuid());
+    target->setGroup(root);
+    target->setPassword("secret");
+
+    auto group = new Group();
+    group->setParent(root);
+
+    auto referrer = new Entry();
+    referrer->setUuid(QUuid::createUuid());
+    referrer->setGroup(group);
+    referrer->setPassword(QString("{REF:P@I:%1}").arg(target->uuidToHex()));
+
+    auto unrelated = new Entry();
+    unrelated->setUuid(QUuid::createUuid());
+    unrelated->setGroup(root);
+
+    QCOMPARE(root->referencesRecursive(target), QList<Entry*>({referrer}));
+    QCOMPARE(group->referencesRecursive(target), QList<Entry*>({referrer}));
+    QVERIFY(root->referencesRecursive(unrelated).isEmpty());
+
+    // Editing the attribute updates the reverse references
+    referrer->setPassword("plain");
+    QVERIFY(root->referencesRecursive(target).isEmpty());
+
+    referrer->setUsername(QString("{REF:U@I:%1}").arg(target->uuidToHex()));
+    QCOMPARE(root->referencesRecursive(target), QList<Entry*>({referrer}));
+
+    // Replacing the attributes wholesale is tracked as well
+    QScopedPointer<Entry> plainEntry(new Entry());
+    referrer->attributes()->copyDataFrom(plainEntry->attributes());
+    QVERIFY(root->referencesRecursive(target).isEmpty());
+
+    referrer->setNotes(QString("{REF:T@I:%1}").arg(target->uuidToHex()));
+    QCOMPARE(root->referencesRecursive(target), QList<Entry*>({referrer}));
+
+    delete referrer;
+    QVERIFY(root->referencesRecursive(target).isEmpty());
+}
+
 void TestGroup::testFindGroupByPath()
 {
     QScopedPointer<Database> db(new Database());
@@ -616,6 +766,62 @@ void TestGroup::testFindGroupByPath()
     QVERIFY(!group);
 }
 
+void TestGroup::testFindByPathIndex()
+{
+    QScopedPointer<Database> db(new Database());
+
+    // Two sibling groups with the same name, lookups below the second must not find the first
+    auto first = new Group();
+    first->setName("group");
+    first->setParent(db->rootGroup());
+    auto second = new Group();
+    second->setName("group");
+    second->setParent(db->rootGroup());
+
+    auto firstChild = new Group();
+    firstChild->setName("child");
+    firstChild->setParent(first);
+    auto secondChild = new Group();
+    secondChild->setName("child");
+    secondChild->setParent(second);
+
+    auto firstEntry = new Entry();
+    firstEntry->setTitle("entry");
+    firstEntry->setGroup(firstChild);
+    auto secondEntry = new Entry();
+    secondEntry->setTitle("entry");
+    secondEntry->setGroup(secondChild);
+
+    QCOMPARE(db->rootGroup()->findGroupByPath("/group/child/"), firstChild);
+    QCOMPARE(db->rootGroup()->findEntryByPath("/group/child/entry"), firstEntry);
+    QCOMPARE(db->rootGroup()->findEntryByPath("entry"), firstEntry);
+    QCOMPARE(second->findGroupByPath("/"), second);
+    QCOMPARE(second->findGroupByPath("child"), secondChild);
+    QCOMPARE(second->findEntryByPath("child/entry"), secondEntry);
+    QCOMPARE(second->findEntryByPath("entry"), secondEntry);
+    QCOMPARE(secondChild->findEntryByPath("/entry"), secondEntry);
+    QVERIFY(!secondChild->findEntryByPath("/child/entry"));
+
+    // Renaming, retitling, reordering and moving are picked up by the next lookup
+    firstEntry->setTitle("renamed");
+    QCOMPARE(db->rootGroup()->findEntryByPath("entry"), secondEntry);
+    QCOMPARE(db->rootGroup()->findEntryByPath("/group/child/renamed"), firstEntry);
+
+    firstChild->setName("other");
+    QCOMPARE(db->rootGroup()->findGroupByPath("/group/child/"), secondChild);
+    QCOMPARE(db->rootGroup()->findEntryByPath("/group/other/renamed"), firstEntry);
+
+    second->setParent(db->rootGroup(), 0);
+    QCOMPARE(db->rootGroup()->findGroupByPath("/group/"), second);
+
+    secondEntry->setGroup(db->rootGroup());
+    QCOMPARE(db->rootGroup()->findEntryByPath("/entry"), secondEntry);
+    QVERIFY(!second->findEntryByPath("entry"));
+
+    delete secondEntry;
+    QVERIFY(!db->rootGroup()->findEntryByPath("entry"));
+}
+
 void TestGroup::testPrint()
 {
     QScopedPointer<Database> db(new Database());
@@ -1023,6 +1229,53 @@ void TestGroup::testHierarchy()
     QVERIFY(hierarchy.contains("group3"));
 }
 
+void TestGroup::testHierarchyCache()
+{
+    Database db;
+    db.rootGroup()->setName("Root");
+
+    auto group1 = new Group();
+    group1->setName("group1");
+    group1->setParent(db.rootGroup());
+
+    auto group2 = new Group();
+    group2->setName("group2");
+    group2->setParent(group1);
+
+    auto group3 = new Group();
+    group3->setName("group3");
+    group3->setParent(db.rootGroup());
+
+    QCOMPARE(group2->hierarchy(), QStringList({"Root", "group1", "group2"}));
+    QCOMPARE(group2->hierarchy(2), QStringList({"group1", "group2"}));
+
+    // Renaming an ancestor changes the cached hierarchy of its descendants
+    group1->setName("renamed");
+    QCOMPARE(group2->hierarchy(), QStringList({"Root", "renamed", "group2"}));
+
+    // Moving an ancestor as well
+    group1->setParent(group3);
+    QCOMPARE(group2->hierarchy(), QStringList({"Root", "group3", "renamed", "group2"}));
+    QCOMPARE(group1->hierarchy(), QStringList({"Root", "group3", "renamed"}));
+
+    db.rootGroup()->setName("NewRoot");
+    QCOMPARE(group2->hierarchy(), QStringList({"NewRoot", "group3", "renamed", "group2"}));
+
+    // Renaming through copyDataFrom() as the group editor does
+    QScopedPointer<Group> edited(group1->clone(Entry::CloneNoFlags, Group::CloneNoFlags));
+    edited->setName("edited");
+    group1->copyDataFrom(edited.data());
+    QCOMPARE(group1->name(), QString("edited"));
+    QCOMPARE(group2->hierarchy(), QStringList({"NewRoot", "group3", "edited", "group2"}));
+
+    // Groups moved to another database are not tied to the old one
+    Database db2;
+    db2.rootGroup()->setName("Root2");
+    group1->setParent(db2.rootGroup());
+    QCOMPARE(group2->hierarchy(), QStringList({"Root2", "renamed", "group2"}));
+    QCOMPARE(group3->hierarchy(), QStringList({"NewRoot", "group3"}));
+}
+
 void TestGroup::testApplyGroupIconRecursively()
 {
     // Create a database with two nested groups with one entry each
@@ -1146,6 +1399,56 @@ void TestGroup::testUsernamesRecursive()
     QVERIFY(usernames.indexOf("Name2") < usernames.indexOf("Name1"));
 }
 
+void TestGroup::testForEachRecursive()
+{
+    Database db;
+    auto root = db.rootGroup();
+
+    auto entry1 = new Entry();
+    entry1->setGroup(root);
+    entry1->beginUpdate();
+    entry1->setTitle("entry1");
+    entry1->endUpdate();
+    QCOMPARE(entry1->historyItems().size(), 1);
+
+    auto group1 = new Group();
+    group1->setParent(root);
+    auto entry2 = new Entry();
+    entry2->setGroup(group1);
+
+    auto group2 = new Group();
+    group2->setParent(group1);
+    auto entry3 = new Entry();
+    entry3->setGroup(group2);
+
+    QList<Entry*> visitedEntries;
+    root->forEachEntryRecursive([&](Entry* entry) { visitedEntries.append(entry); });
+    QCOMPARE(visitedEntries, root->entriesRecursive());
+    QCOMPARE(visitedEntries, QList<Entry*>({entry1, entry2, entry3}));
+
+    visitedEntries.clear();
+    root->forEachEntryRecursive([&](Entry* entry) { visitedEntries.append(entry); }, true);
+    QCOMPARE(visitedEntries, root->entriesRecursive(true));
+    QCOMPARE(visitedEntries.size(), 4);
+
+    QList<const Group*> visitedGroups;
+    root->forEachGroupRecursive([&](const Group* group) { visitedGroups.append(group); });
+    QCOMPARE(visitedGroups, asConst(*root).groupsRecursive(true));
+
+    visitedGroups.clear();
+    root->forEachGroupRecursive([&](const Group* group) { visitedGroups.append(group); }, false);
+    QCOMPARE(visitedGroups, QList<const Group*>({group1, group2}));
+
+    // Returning false from the visitor stops the walk
+    visitedEntries.clear();
+    bool completed = root->forEachEntryRecursive([&](Entry* entry) {
+        visitedEntries.append(entry);
+        return entry != entry2;
+    });
+    QVERIFY(!completed);
+    QCOMPARE(visitedEntries, QList<Entry*>({entry1, entry2}));
+}
+
 void TestGroup::testMoveUpDown()
 {
     Database database;
@@ -1319,3 +1622,43 @@ void TestGroup::testAutoTypeState()
     QVERIFY(!entry1->groupAutoTypeEnabled());
     QVERIFY(entry2->groupAutoTypeEnabled());
 }
+
+void TestGroup::testResolveCustomData()
+{
+    Database db;
+    auto* root = db.rootGroup();
+    auto* group = new Group();
+    group->setParent(root);
+    auto* subGroup = new Group();
+    subGroup->setParent(group);
+    auto* other = new Group();
+    other->setParent(root);
+
+    const QString key("Option");
+    QCOMPARE(subGroup->resolveCustomDataTriState(key), Group::Inherit);
+    QVERIFY(subGroup->resolveCustomDataString(key).isEmpty());
+
+    // Cached results follow changes of any parent
+    root->setCustomDataTriState(key, Group::Enable);
+    QCOMPARE(subGroup->resolveCustomDataTriState(key), Group::Enable);
+    QCOMPARE(subGroup->resolveCustomDataString(key), TRUE_STR);
+    group->setCustomDataTriState(key, Group::Disable);
+    QCOMPARE(subGroup->resolveCustomDataTriState(key), Group::Disable);
+    QCOMPARE(subGroup->resolveCustomDataTriState(key, false), Group::Inherit);
+    group->customData()->set(key, "value");
+    QCOMPARE(subGroup->resolveCustomDataString(key), QString("value"));
+    QVERIFY(subGroup->resolveCustomDataString(key, false).isEmpty());
+
+    // And moves to another parent
+    subGroup->setParent(other);
+    QCOMPARE(subGroup->resolveCustomDataTriState(key), Group::Enable);
+    group->setCustomDataTriState(key, Group::Inherit);
+    root->setCustomDataTriState(key, Group::Inherit);
+    QCOMPARE(subGroup->resolveCustomDataTriState(key), Group::Inherit);
+
+    // And moves to another database
+    Database otherDb;
+    otherDb.rootGroup()->setCustomDataTriState(key, Group::Disable);
+    subGroup->setParent(otherDb.rootGroup());
+    QCOMPARE(subGroup->resolveCustomDataTriState(key), Group::Disable);
+}
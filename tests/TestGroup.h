@@ -35,9 +35,13 @@ private slots:
     void testDeleteSignals();
     void testCopyCustomIcon();
     void testClone();
+    void testCloneTree();
     void testCopyCustomIcons();
     void testFindEntry();
+    void testFindByUuidIndex();
+    void testReferencesRecursive();
     void testFindGroupByPath();
+    void testFindByPathIndex();
     void testPrint();
     void testAddEntryWithPath();
     void testIsRecycled();
@@ -45,11 +49,14 @@ private slots:
     void testEquals();
     void testChildrenSort();
     void testHierarchy();
+    void testHierarchyCache();
     void testApplyGroupIconRecursively();
     void testUsernamesRecursive();
+    void testForEachRecursive();
     void testMoveUpDown();
     void testPreviousParentGroup();
     void testAutoTypeState();
+    void testResolveCustomData();
 };
 
 #endif // KEEPASSX_TESTGROUP_H
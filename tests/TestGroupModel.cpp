@@ -149,3 +149,55 @@ void TestGroupModel::test()
     delete modelTest;
     delete model;
 }
+
+void TestGroupModel::testRowCache()
+{
+    Database db;
+    GroupModel model(&db);
+    auto modelTest = new ModelTest(&model, &model);
+    Q_UNUSED(modelTest);
+
+    QList<Group*> groups;
+    for (const QString& name : {"c", "a", "d", "b"}) {
+        auto* group = new Group();
+        group->setName(name);
+        group->setParent(db.rootGroup());
+        groups.append(group);
+    }
+
+    auto verifyRows = [&]() {
+        const QList<Group*> children = db.rootGroup()->children();
+        for (int i = 0; i < children.size(); ++i) {
+            QCOMPARE(model.index(children.at(i)).row(), i);
+            QCOMPARE(model.groupFromIndex(model.index(i, 0, model.index(db.rootGroup()))), children.at(i));
+        }
+    };
+
+    verifyRows();
+
+    // Moving within the parent
+    groups.at(3)->setParent(db.rootGroup(), 0);
+    verifyRows();
+
+    // Inserting in front of cached rows
+    auto* group = new Group();
+    group->setName("e");
+    group->setParent(db.rootGroup(), 0);
+    verifyRows();
+
+    // Removing
+    delete groups.at(1);
+    verifyRows();
+
+    // Moving into another parent
+    groups.at(0)->setParent(group);
+    QCOMPARE(model.index(groups.at(0)).row(), 0);
+    QCOMPARE(model.parent(model.index(groups.at(0))), model.index(group));
+    verifyRows();
+
+    // Sorting reorders the children without move signals
+    model.sortChildren(db.rootGroup());
+    verifyRows();
+    db.rootGroup()->sortChildrenRecursively(true);
+    verifyRows();
+}
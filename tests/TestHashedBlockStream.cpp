@@ -17,6 +17,7 @@
 
 #include "TestHashedBlockStream.h"
 
+#include <QBuffer>
 #include <QTest>
 
 #include "FailDevice.h"
@@ -25,6 +26,22 @@
 
 QTEST_GUILESS_MAIN(TestHashedBlockStream)
 
+namespace
+{
+    QByteArray writeBlocks(const QByteArray& data, int parallelBlocks)
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+
+        HashedBlockStream writer(&buffer, 100);
+        writer.setParallelBlocks(parallelBlocks);
+        writer.open(QIODevice::WriteOnly);
+        writer.write(data);
+        writer.reset();
+        return buffer.data();
+    }
+} // namespace
+
 void TestHashedBlockStream::initTestCase()
 {
     QVERIFY(Crypto::init());
@@ -101,3 +118,54 @@ void TestHashedBlockStream::testWriteFailure()
     QVERIFY(!writer.reset());
     QCOMPARE(writer.errorString(), QString("FAILDEVICE"));
 }
+
+void TestHashedBlockStream::testParallelWriteRead()
+{
+    QByteArray data;
+    for (int i = 0; i < 1050; ++i) {
+        data.append(static_cast<char>(i % 251));
+    }
+
+    // the output must not depend on how many blocks are hashed at once
+    QByteArray serial = writeBlocks(data, 1);
+    QCOMPARE(serial.size(), data.size() + (4 + 32 + 4) * 12);
+    QCOMPARE(writeBlocks(data, 4), serial);
+    QCOMPARE(writeBlocks(data, 11), serial);
+    QCOMPARE(writeBlocks(data, 20), serial);
+
+    for (int parallelBlocks : {1, 3, 11, 20}) {
+        QBuffer buffer(&serial);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+        HashedBlockStream reader(&buffer);
+        reader.setParallelBlocks(parallelBlocks);
+        QVERIFY(reader.open(QIODevice::ReadOnly));
+        QCOMPARE(reader.read(data.size() + 1), data);
+        QVERIFY(reader.atEnd());
+    }
+}
+
+void TestHashedBlockStream::testParallelReadMismatch()
+{
+    QByteArray data(1000, 'Z');
+    QByteArray stream = writeBlocks(data, 1);
+
+    // corrupt the data of the fourth block
+    stream[(4 + 32 + 4 + 100) * 3 + 4 + 32 + 4 + 50] = 'Y';
+
+    QBuffer buffer(&stream);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    HashedBlockStream reader(&buffer);
+    reader.setParallelBlocks(8);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+
+    // blocks read ahead of the corrupted one are still delivered
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(reader.read(100), data.left(100));
+    }
+
+    char c;
+    QCOMPARE(reader.read(&c, 1), qint64(-1));
+    QCOMPARE(reader.errorString(), QString("Mismatch between hash and data."));
+}
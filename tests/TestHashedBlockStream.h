@@ -29,6 +29,8 @@ private slots:
     void testWriteRead();
     void testReset();
     void testWriteFailure();
+    void testParallelWriteRead();
+    void testParallelReadMismatch();
 };
 
 #endif // KEEPASSX_TESTHASHEDBLOCKSTREAM_H
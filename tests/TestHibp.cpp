@@ -23,14 +23,33 @@
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QCryptographicHash>
+#include <QHash>
 #include <QList>
+#include <QTemporaryFile>
 #include <QTest>
 
+#include <algorithm>
+
 QTEST_GUILESS_MAIN(TestHibp)
 
 const char* TEST_HIBP_CONTENTS = "0BEEC7B5EA3F0FDBC95D0DD47F3C5BC275DA8A33:123\n" // SHA-1 of "foo"
                                  "62cdb7020ff920e5aa642c3d4066950dd1f01f4d:456\n"; // SHA-1 of "bar"
 
+// Ordered by hash with a mix of line endings
+const char* TEST_SORTED_HIBP_CONTENTS = "0000000000000000000000000000000000000001:1\r\n"
+                                        "0BEEC7B5EA3F0FDBC95D0DD47F3C5BC275DA8A33:123\r\n" // SHA-1 of "foo"
+                                        "1111111111111111111111111111111111111111:22\n"
+                                        "5555555555555555555555555555555555555555:3\n"
+                                        "62cdb7020ff920e5aa642c3d4066950dd1f01f4d:456\n" // SHA-1 of "bar"
+                                        "7777777777777777777777777777777777777777:4444\n"
+                                        "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF:5\n";
+
+// Ordered by prevalence like the other HIBP download
+const char* TEST_UNSORTED_HIBP_CONTENTS = "62cdb7020ff920e5aa642c3d4066950dd1f01f4d:456\n" // SHA-1 of "bar"
+                                          "0BEEC7B5EA3F0FDBC95D0DD47F3C5BC275DA8A33:123\n" // SHA-1 of "foo"
+                                          "1111111111111111111111111111111111111111:22\n";
+
 const char* TEST_BAD_HIBP_CONTENTS = "barf:nope\n";
 
 void TestHibp::initTestCase()
@@ -118,3 +137,222 @@ void TestHibp::testPwned()
     QCOMPARE(findings[1].first, entry4);
     QCOMPARE(findings[1].second, 456);
 }
+
+void TestHibp::testPwnedSorted()
+{
+    QByteArray hibpContents(TEST_SORTED_HIBP_CONTENTS);
+
+    Group* root = m_db->rootGroup();
+
+    auto entry1 = new Entry();
+    entry1->setPassword("foo");
+    entry1->setGroup(root);
+
+    auto entry2 = new Entry();
+    entry2->setPassword("xyz");
+    entry2->setGroup(root);
+
+    auto entry3 = new Entry();
+    entry3->setPassword("bar");
+    entry3->setGroup(root);
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY(HibpOffline::reportSorted(m_db, hibpContents.constData(), hibpContents.size(), findings, &error));
+    QCOMPARE(error, QString());
+    QCOMPARE(findings.size(), 2);
+    QCOMPARE(findings[0].first, entry1);
+    QCOMPARE(findings[0].second, 123);
+    QCOMPARE(findings[1].first, entry3);
+    QCOMPARE(findings[1].second, 456);
+}
+
+void TestHibp::testBadSortedFormat()
+{
+    QByteArray hibpContents(TEST_BAD_HIBP_CONTENTS);
+
+    auto entry = new Entry();
+    entry->setPassword("foo");
+    entry->setGroup(m_db->rootGroup());
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY(!HibpOffline::reportSorted(m_db, hibpContents.constData(), hibpContents.size(), findings, &error));
+    QVERIFY(!error.isEmpty());
+    QCOMPARE(findings.size(), 0);
+}
+
+void TestHibp::testSortedCrlf()
+{
+    // Large enough for the binary search to land on every byte of the line terminators
+    const int lineCount = 5000;
+    QList<QByteArray> lines;
+    QHash<QString, int> counts;
+    for (int i = 0; i < lineCount; ++i) {
+        const auto password = QString("password%1").arg(i);
+        const auto sha1 = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha1);
+        lines.append(sha1.toHex().toUpper() + ":" + QByteArray::number(i + 1));
+        counts.insert(password, i + 1);
+    }
+    std::sort(lines.begin(), lines.end());
+    const QByteArray hibpContents = lines.join("\r\n") + "\r\n";
+
+    QList<Entry*> entries;
+    for (int i = 0; i < lineCount; i += 25) {
+        auto entry = new Entry();
+        entry->setPassword(QString("password%1").arg(i));
+        entry->setGroup(m_db->rootGroup());
+        entries.append(entry);
+    }
+    auto unknown = new Entry();
+    unknown->setPassword("not in the file");
+    unknown->setGroup(m_db->rootGroup());
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY2(HibpOffline::reportSorted(m_db, hibpContents.constData(), hibpContents.size(), findings, &error),
+             qPrintable(error));
+    QCOMPARE(findings.size(), entries.size());
+    for (const auto& finding : findings) {
+        QCOMPARE(finding.second, counts.value(finding.first->password()));
+    }
+
+    // The same through the file, which has to be recognized as ordered
+    QTemporaryFile hibpFile;
+    QVERIFY(hibpFile.open());
+    QCOMPARE(hibpFile.write(hibpContents), static_cast<qint64>(hibpContents.size()));
+    QVERIFY(hibpFile.flush());
+    QVERIFY(hibpFile.seek(0));
+    findings.clear();
+    QVERIFY2(HibpOffline::reportFile(m_db, hibpFile, findings, &error), qPrintable(error));
+    QCOMPARE(findings.size(), entries.size());
+}
+
+void TestHibp::testReportFile()
+{
+    auto entry1 = new Entry();
+    entry1->setPassword("foo");
+    entry1->setGroup(m_db->rootGroup());
+
+    auto entry2 = new Entry();
+    entry2->setPassword("bar");
+    entry2->setGroup(m_db->rootGroup());
+
+    // A file ordered by hash is searched, any other is scanned in full
+    for (const char* contents : {TEST_SORTED_HIBP_CONTENTS, TEST_UNSORTED_HIBP_CONTENTS}) {
+        QTemporaryFile hibpFile;
+        QVERIFY(hibpFile.open());
+        QVERIFY(hibpFile.write(contents) > 0);
+        QVERIFY(hibpFile.flush());
+        QVERIFY(hibpFile.seek(0));
+
+        QList<QPair<const Entry*, int>> findings;
+        QString error;
+        QVERIFY(HibpOffline::reportFile(m_db, hibpFile, findings, &error));
+        QCOMPARE(error, QString());
+        QCOMPARE(findings.size(), 2);
+
+        QHash<const Entry*, int> counts;
+        for (const auto& finding : findings) {
+            counts.insert(finding.first, finding.second);
+        }
+        QCOMPARE(counts.value(entry1), 123);
+        QCOMPARE(counts.value(entry2), 456);
+    }
+}
+
+void TestHibp::testIndex()
+{
+    auto entry1 = new Entry();
+    entry1->setPassword("foo");
+    entry1->setGroup(m_db->rootGroup());
+
+    auto entry2 = new Entry();
+    entry2->setPassword("xyz");
+    entry2->setGroup(m_db->rootGroup());
+
+    auto entry3 = new Entry();
+    entry3->setPassword("bar");
+    entry3->setGroup(m_db->rootGroup());
+
+    QByteArray hibpContents(TEST_SORTED_HIBP_CONTENTS);
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    QByteArray index;
+    QBuffer indexBuffer(&index);
+    QVERIFY(indexBuffer.open(QIODevice::WriteOnly));
+
+    QString error;
+    QVERIFY(HibpOffline::writeIndex(hibpBuffer, indexBuffer, &error));
+    QCOMPARE(error, QString());
+    QVERIFY(HibpOffline::isIndex(index.constData(), index.size()));
+    // Header and one record of hash and count per line
+    QCOMPARE(index.size(), 16 + 7 * 24);
+
+    QList<QPair<const Entry*, int>> findings;
+    QVERIFY(HibpOffline::indexReport(m_db, index.constData(), index.size(), findings, &error));
+    QCOMPARE(error, QString());
+    QCOMPARE(findings.size(), 2);
+    QCOMPARE(findings[0].first, entry1);
+    QCOMPARE(findings[0].second, 123);
+    QCOMPARE(findings[1].first, entry3);
+    QCOMPARE(findings[1].second, 456);
+
+    // The index is picked up from a file as well
+    QTemporaryFile indexFile;
+    QVERIFY(indexFile.open());
+    QCOMPARE(indexFile.write(index), index.size());
+    QVERIFY(indexFile.flush());
+    QVERIFY(indexFile.seek(0));
+    findings.clear();
+    QVERIFY(HibpOffline::reportFile(m_db, indexFile, findings, &error));
+    QCOMPARE(findings.size(), 2);
+
+    // Truncated index
+    findings.clear();
+    QVERIFY(!HibpOffline::indexReport(m_db, index.constData(), index.size() - 1, findings, &error));
+    QVERIFY(!error.isEmpty());
+
+    // Building an index needs a list ordered by hash
+    QByteArray unsortedContents(TEST_UNSORTED_HIBP_CONTENTS);
+    QBuffer unsortedBuffer(&unsortedContents);
+    QVERIFY(unsortedBuffer.open(QIODevice::ReadOnly));
+    QByteArray unsortedIndex;
+    QBuffer unsortedIndexBuffer(&unsortedIndex);
+    QVERIFY(unsortedIndexBuffer.open(QIODevice::WriteOnly));
+    error.clear();
+    QVERIFY(!HibpOffline::writeIndex(unsortedBuffer, unsortedIndexBuffer, &error));
+    QVERIFY(!error.isEmpty());
+}
+
+void TestHibp::testHistory()
+{
+    auto entry = new Entry();
+    entry->setPassword("foo");
+    entry->setGroup(m_db->rootGroup());
+
+    auto historyItem = new Entry();
+    historyItem->setPassword("bar");
+    entry->addHistoryItem(historyItem);
+
+    QByteArray hibpContents(TEST_HIBP_CONTENTS);
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY(HibpOffline::report(m_db, hibpBuffer, findings, &error));
+    QCOMPARE(findings.size(), 1);
+    QCOMPARE(findings[0].first, entry);
+
+    QVERIFY(hibpBuffer.seek(0));
+    findings.clear();
+    QVERIFY(HibpOffline::report(m_db, hibpBuffer, findings, &error, true));
+    QCOMPARE(error, QString());
+    QCOMPARE(findings.size(), 2);
+    QCOMPARE(findings[0].first, entry);
+    QCOMPARE(findings[0].second, 123);
+    QCOMPARE(findings[1].first, historyItem);
+    QCOMPARE(findings[1].second, 456);
+}
@@ -34,6 +34,12 @@ private slots:
     void testEmpty();
     void testIoError();
     void testPwned();
+    void testPwnedSorted();
+    void testBadSortedFormat();
+    void testSortedCrlf();
+    void testReportFile();
+    void testIndex();
+    void testHistory();
 
 private:
     QSharedPointer<Database> m_db;
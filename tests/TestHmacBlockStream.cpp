@@ -0,0 +1,100 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestHmacBlockStream.h"
+
+#include <QBuffer>
+#include <QTest>
+
+#include "crypto/Crypto.h"
+#include "streams/HmacBlockStream.h"
+
+QTEST_GUILESS_MAIN(TestHmacBlockStream)
+
+namespace
+{
+    const QByteArray Key(64, 'K');
+
+    QByteArray writeBlocks(const QByteArray& data, int parallelBlocks)
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+
+        HmacBlockStream writer(&buffer, Key, 100);
+        writer.setParallelBlocks(parallelBlocks);
+        writer.open(QIODevice::WriteOnly);
+        writer.write(data);
+        writer.reset();
+        return buffer.data();
+    }
+} // namespace
+
+void TestHmacBlockStream::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void TestHmacBlockStream::testParallelWriteRead()
+{
+    QByteArray data;
+    for (int i = 0; i < 1050; ++i) {
+        data.append(static_cast<char>(i % 251));
+    }
+
+    // the output must not depend on how many blocks are hashed at once
+    QByteArray serial = writeBlocks(data, 1);
+    QCOMPARE(serial.size(), data.size() + (32 + 4) * 12);
+    QCOMPARE(writeBlocks(data, 4), serial);
+    QCOMPARE(writeBlocks(data, 11), serial);
+    QCOMPARE(writeBlocks(data, 20), serial);
+
+    for (int parallelBlocks : {1, 3, 11, 20}) {
+        QBuffer buffer(&serial);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+        HmacBlockStream reader(&buffer, Key);
+        reader.setParallelBlocks(parallelBlocks);
+        QVERIFY(reader.open(QIODevice::ReadOnly));
+        QCOMPARE(reader.read(data.size() + 1), data);
+        QVERIFY(reader.atEnd());
+    }
+}
+
+void TestHmacBlockStream::testParallelReadMismatch()
+{
+    QByteArray data(1000, 'Z');
+    QByteArray stream = writeBlocks(data, 1);
+
+    // corrupt the data of the fourth block
+    stream[(32 + 4 + 100) * 3 + 32 + 4 + 50] = 'Y';
+
+    QBuffer buffer(&stream);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    HmacBlockStream reader(&buffer, Key);
+    reader.setParallelBlocks(8);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+
+    // blocks read ahead of the corrupted one are still delivered
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(reader.read(100), data.left(100));
+    }
+
+    char c;
+    QCOMPARE(reader.read(&c, 1), qint64(-1));
+    QCOMPARE(reader.errorString(), QString("Mismatch between hash and data."));
+}
@@ -1,4 +1,5 @@
 #include "TestIconDownloader.h"
+#include <QSignalSpy>
 #include <QTest>
 #include <gui/IconDownloader.h>
 
@@ -77,3 +78,24 @@ void TestIconDownloader::testIconDownloader_data()
         << "https://test.com/rel-path/"
         << QStringList{"https://test.com/rel-path/favicon.ico", "https://test.com/favicon.ico"};
 }
+
+void TestIconDownloader::testHostKey()
+{
+    // URLs of the same host share a download
+    QCOMPARE(IconDownloader::hostKey("https://keepassxc.org/register"), QString("keepassxc.org"));
+    QCOMPARE(IconDownloader::hostKey("keepassxc.org"), QString("keepassxc.org"));
+    QCOMPARE(IconDownloader::hostKey("https://KeePassXC.org:8080/?a=b"), QString("keepassxc.org"));
+    QVERIFY(IconDownloader::hostKey("https://login.keepassxc.org") != IconDownloader::hostKey("keepassxc.org"));
+}
+
+void TestIconDownloader::testInvalidUrl()
+{
+    // Downloads that can't start still report that they are finished
+    IconDownloader downloader;
+    QSignalSpy spyFinished(&downloader, SIGNAL(finished(QString, QImage)));
+    downloader.setUrl("ftp://keepassxc.org");
+    downloader.download();
+    QTRY_COMPARE(spyFinished.count(), 1);
+    QCOMPARE(spyFinished.first().at(0).toString(), QString("ftp://keepassxc.org"));
+    QVERIFY(spyFinished.first().at(1).value<QImage>().isNull());
+}
@@ -29,6 +29,8 @@ class TestIconDownloader : public QObject
 private slots:
     void testIconDownloader();
     void testIconDownloader_data();
+    void testHostKey();
+    void testInvalidUrl();
 };
 
 #endif // KEEPASSXC_TESTICONDOWNLOADER_HPP
@@ -23,12 +23,16 @@
 #include "core/Totp.h"
 #include "crypto/Crypto.h"
 #include "format/BitwardenReader.h"
+#include "format/BulkImport.h"
+#include "format/JsonStreamReader.h"
 #include "format/OPUXReader.h"
 #include "format/OpVaultReader.h"
 
+#include <QBuffer>
 #include <QJsonObject>
 #include <QList>
 #include <QTest>
+#include <QThread>
 
 QTEST_GUILESS_MAIN(TestImports)
 
@@ -265,3 +269,100 @@ void TestImports::testBitwardenEncrypted()
     }
     QVERIFY(db);
 }
+
+void TestImports::testBulkImport()
+{
+    // Enough items for several chunks on worker threads
+    const int count = 5000;
+    int lastProgress = 0;
+    auto entries = BulkImport::buildEntries(
+        count,
+        [](int i) {
+            if (i % 10 == 9) {
+                return static_cast<Entry*>(nullptr);
+            }
+            auto entry = new Entry();
+            entry->setUuid(QUuid::createUuid());
+            entry->setTitle(QString("Entry %1").arg(i));
+            return entry;
+        },
+        [&](int done, int total) {
+            QCOMPARE(total, count);
+            QVERIFY(done > lastProgress);
+            lastProgress = done;
+        });
+    QCOMPARE(lastProgress, count);
+    QCOMPARE(entries.size(), count);
+
+    Database db;
+    auto group = new Group();
+    group->setParent(db.rootGroup());
+
+    QList<Group*> groups;
+    for (int i = 0; i < count; ++i) {
+        // Skipped items keep their position
+        QCOMPARE(entries[i] == nullptr, i % 10 == 9);
+        if (entries[i]) {
+            QCOMPARE(entries[i]->title(), QString("Entry %1").arg(i));
+            QCOMPARE(entries[i]->thread(), QThread::currentThread());
+        }
+        groups.append(i % 2 ? group : db.rootGroup());
+    }
+
+    BulkImport::attachEntries(&db, entries, groups);
+    QCOMPARE(db.rootGroup()->entriesRecursive().size(), count - count / 10);
+    QCOMPARE(group->entries().size(), count / 2 - count / 10);
+    QCOMPARE(group->entries().first()->title(), QString("Entry 1"));
+}
+
+void TestImports::testJsonStreamReader()
+{
+    QByteArray json(R"({"name": "vault", "skipped": {"a": [1, "]}"]}, "items": [ {"id": 1}, )"
+                    R"({"id": 2, "text": "line\n\"quoted\""}, true ], "count": 2})");
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    JsonStreamReader reader(&buffer);
+    QVERIFY(reader.enterObject());
+
+    QString key;
+    QVERIFY(reader.nextKey(key));
+    QCOMPARE(key, QStringLiteral("name"));
+    QCOMPARE(reader.readValue().toString(), QStringLiteral("vault"));
+
+    QVERIFY(reader.nextKey(key));
+    QCOMPARE(key, QStringLiteral("skipped"));
+    QVERIFY(reader.skipValue());
+
+    QVERIFY(reader.nextKey(key));
+    QCOMPARE(key, QStringLiteral("items"));
+    QVERIFY(reader.enterArray());
+    QVERIFY(reader.nextElement());
+    QCOMPARE(reader.readValue().toObject().value("id").toInt(), 1);
+    QVERIFY(reader.nextElement());
+    QCOMPARE(reader.readValue().toObject().value("text").toString(), QStringLiteral("line\n\"quoted\""));
+    QVERIFY(reader.nextElement());
+    QCOMPARE(reader.readValue().toBool(), true);
+    QVERIFY(!reader.nextElement());
+
+    QVERIFY(reader.nextKey(key));
+    QCOMPARE(key, QStringLiteral("count"));
+    QCOMPARE(reader.readValue().toInt(), 2);
+    QVERIFY(!reader.nextKey(key));
+    QVERIFY(!reader.hasError());
+
+    // Truncated input is reported with its position
+    QByteArray truncated(R"({"items": [{"id": 1}, {"id": )");
+    QBuffer truncatedBuffer(&truncated);
+    QVERIFY(truncatedBuffer.open(QIODevice::ReadOnly));
+    JsonStreamReader truncatedReader(&truncatedBuffer);
+    QVERIFY(truncatedReader.enterObject());
+    QVERIFY(truncatedReader.nextKey(key));
+    QVERIFY(truncatedReader.enterArray());
+    QVERIFY(truncatedReader.nextElement());
+    QVERIFY(truncatedReader.readValue().isObject());
+    QVERIFY(truncatedReader.nextElement());
+    QVERIFY(truncatedReader.readValue().isNull());
+    QVERIFY(truncatedReader.hasError());
+    QVERIFY(truncatedReader.errorOffset() > 0);
+}
@@ -30,6 +30,8 @@ private slots:
     void testOPVault();
     void testBitwarden();
     void testBitwardenEncrypted();
+    void testBulkImport();
+    void testJsonStreamReader();
 };
 
 #endif /* TEST_IMPORTS_H */
@@ -19,6 +19,7 @@
 
 #include "config-keepassx-tests.h"
 #include "core/Metadata.h"
+#include "format/KdbxXmlOutput.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KdbxXmlWriter.h"
 #include "format/KeePass2.h"
@@ -33,6 +34,7 @@
 #include "mock/MockChallengeResponseKey.h"
 #include "mock/MockClock.h"
 #include <QTest>
+#include <QXmlStreamWriter>
 
 int main(int argc, char* argv[])
 {
@@ -615,3 +617,187 @@ void TestKdbx4Format::testCustomData()
     QCOMPARE(newEntry->customData()->value(customDataKey1), customData1);
     QCOMPARE(newEntry->customData()->value(customDataKey2), customData2);
 }
+
+void TestKdbx4Format::testXmlOutput()
+{
+    // Saved files and cached entries must not change with the XML emitter
+    QBuffer expected;
+    expected.open(QIODevice::WriteOnly);
+    QXmlStreamWriter reference(&expected);
+    reference.setAutoFormatting(true);
+    reference.setAutoFormattingIndent(-1);
+    reference.setCodec("UTF-8");
+
+    QBuffer actual;
+    actual.open(QIODevice::WriteOnly);
+    KdbxXmlOutput output;
+    output.setDevice(&actual);
+
+    const QString plain("Plain text\twith\nwhitespace");
+    const QString markup = QString::fromUtf8("a <b> & \"c\" \xC3\xA4\xE2\x82\xAC\xF0\x9F\x94\x91");
+    const QByteArray binary1("\x00\x01\xFE\xFFxyz", 7);
+    const QByteArray binary2("\x00\x01\xFE\xFFxyzw", 8);
+    const QUuid uuid = QUuid::createUuid();
+
+    reference.writeStartDocument("1.0", true);
+    output.writeStartDocument();
+    reference.writeStartElement("KeePassFile");
+    output.writeStartElement(QLatin1String("KeePassFile"));
+    reference.writeStartElement("Meta");
+    output.writeStartElement(QLatin1String("Meta"));
+    reference.writeTextElement("Generator", plain);
+    output.writeStartElement(QLatin1String("Generator"));
+    output.writeCharacters(plain);
+    output.writeEndElement();
+    reference.writeEmptyElement("Name");
+    output.writeEmptyElement(QLatin1String("Name"));
+    reference.writeTextElement("Notes", markup);
+    output.writeStartElement(QLatin1String("Notes"));
+    output.writeCharacters(markup);
+    output.writeEndElement();
+    reference.writeEndElement();
+    output.writeEndElement();
+
+    reference.writeStartElement("Root");
+    output.writeStartElement(QLatin1String("Root"));
+    reference.writeTextElement("UUID", uuid.toRfc4122().toBase64());
+    output.writeStartElement(QLatin1String("UUID"));
+    output.writeUuidCharacters(uuid);
+    output.writeEndElement();
+    reference.writeTextElement("Number", QString::number(-1234567));
+    output.writeStartElement(QLatin1String("Number"));
+    output.writeNumberCharacters(-1234567);
+    output.writeEndElement();
+    reference.writeStartElement("Value");
+    reference.writeAttribute("Protected", "True");
+    reference.writeEndElement();
+    output.writeStartElement(QLatin1String("Value"));
+    output.writeAttribute(QLatin1String("Protected"), QLatin1String("True"));
+    output.writeEndElement();
+    reference.writeStartElement("Value");
+    reference.writeAttribute("Protected", "True");
+    reference.writeCharacters(binary1.toBase64());
+    reference.writeEndElement();
+    output.writeStartElement(QLatin1String("Value"));
+    output.writeAttribute(QLatin1String("Protected"), QLatin1String("True"));
+    output.writeBase64Characters(binary1.constData(), binary1.size());
+    output.writeEndElement();
+    reference.writeTextElement("Binary", binary2.toBase64());
+    output.writeStartElement(QLatin1String("Binary"));
+    output.writeBase64Characters(binary2.constData(), binary2.size());
+    output.writeEndElement();
+    reference.writeEmptyElement("Tags");
+    output.writeEmptyElement(QLatin1String("Tags"));
+
+    reference.writeEndDocument();
+    output.writeEndDocument();
+
+    QVERIFY(!output.hasError());
+    QCOMPARE(actual.data(), expected.data());
+}
+
+void TestKdbx4Format::testProtectedValuesOnAccess()
+{
+    Database db;
+    auto* entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("Entry");
+    entry->setPassword("password 1");
+    entry->attributes()->set("Secret", QString::fromUtf8("secret äöü"), true);
+    entry->attributes()->set("Plain", "plain");
+    for (int i = 2; i <= 3; ++i) {
+        entry->beginUpdate();
+        entry->setPassword(QString("password %1").arg(i));
+        entry->endUpdate();
+    }
+    QCOMPARE(entry->historyItems().size(), 2);
+
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    KeePass2Writer writer;
+    QVERIFY(writer.writeDatabase(&buffer, &db));
+
+    buffer.seek(0);
+    KeePass2Reader reader;
+    auto newDb = QSharedPointer<Database>::create();
+    QVERIFY(reader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), newDb.data()));
+
+    auto* newEntry = newDb->rootGroup()->entries().at(0);
+    QCOMPARE(newEntry->password(), QString("password 3"));
+    QCOMPARE(newEntry->attributes()->value("Secret"), QString::fromUtf8("secret äöü"));
+    QVERIFY(newEntry->attributes()->isProtected("Secret"));
+    QCOMPARE(newEntry->attributes()->value("Plain"), QString("plain"));
+    QCOMPARE(newEntry->historyItems().at(0)->password(), QString("password 1"));
+    QCOMPARE(newEntry->historyItems().at(1)->password(), QString("password 2"));
+    QCOMPARE(newEntry->attributes()->attributesSize(), entry->attributes()->attributesSize());
+    QCOMPARE(newEntry->historyItems().at(0)->size(), entry->historyItems().at(0)->size());
+    QVERIFY(*newEntry->attributes() == *entry->attributes());
+    QVERIFY(!(*newEntry->attributes() != *entry->attributes()));
+    QVERIFY(!(*newEntry->historyItems().at(0)->attributes() != *entry->historyItems().at(0)->attributes()));
+
+    // Encrypted values are compared by their plain value
+    EntryAttributes changed;
+    changed.copyDataFrom(entry->attributes());
+    changed.set("Secret", "other secret", true);
+    QVERIFY(*newEntry->attributes() != changed);
+    QVERIFY(!(*newEntry->attributes() == changed));
+    QVERIFY(*newEntry->historyItems().at(0)->attributes() != *newEntry->historyItems().at(1)->attributes());
+
+    // Copies keep the values and can be changed on their own
+    QScopedPointer<Entry> clone(newEntry->clone(Entry::CloneNoFlags));
+    QVERIFY(*clone->attributes() == *newEntry->attributes());
+    clone->attributes()->rename("Secret", "Renamed");
+    QCOMPARE(clone->attributes()->value("Renamed"), QString::fromUtf8("secret äöü"));
+    clone->attributes()->set("Renamed", "changed", true);
+    QCOMPARE(clone->attributes()->value("Renamed"), QString("changed"));
+    QCOMPARE(newEntry->attributes()->value("Secret"), QString::fromUtf8("secret äöü"));
+
+    // Values that are still encrypted are written with the new inner stream
+    QBuffer otherBuffer;
+    otherBuffer.open(QBuffer::ReadWrite);
+    QVERIFY(writer.writeDatabase(&otherBuffer, newDb.data()));
+    otherBuffer.seek(0);
+    auto otherDb = QSharedPointer<Database>::create();
+    QVERIFY(reader.readDatabase(&otherBuffer, QSharedPointer<CompositeKey>::create(), otherDb.data()));
+    auto* otherEntry = otherDb->rootGroup()->entries().at(0);
+    QCOMPARE(otherEntry->attributes()->value("Secret"), QString::fromUtf8("secret äöü"));
+    QCOMPARE(otherEntry->historyItems().at(0)->password(), QString("password 1"));
+}
+
+void TestKdbx4Format::benchmarkReadXml()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    Database db;
+    for (int i = 0; i < 2000; ++i) {
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setGroup(db.rootGroup());
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setUsername("user");
+        for (int j = 0; j < 10; ++j) {
+            entry->beginUpdate();
+            entry->setPassword(QString("password %1").arg(j));
+            entry->endUpdate();
+        }
+    }
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    KdbxXmlWriter writer(KeePass2::FILE_VERSION_4, {});
+    writer.writeDatabase(&buffer, &db);
+    QVERIFY(!writer.hasError());
+
+    QBENCHMARK
+    {
+        buffer.seek(0);
+        KdbxXmlReader reader(KeePass2::FILE_VERSION_4);
+        auto readDb = reader.readDatabase(&buffer);
+        QVERIFY(!reader.hasError());
+        QCOMPARE(readDb->rootGroup()->entries().size(), 2000);
+    }
+}
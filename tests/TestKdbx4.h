@@ -66,6 +66,9 @@ private slots:
     void testUpgradeMasterKeyIntegrity_data();
     void testAttachmentIndexStability();
     void testCustomData();
+    void testXmlOutput();
+    void testProtectedValuesOnAccess();
+    void benchmarkReadXml();
 };
 
 #endif // KEEPASSXC_TEST_KDBX4_H
@@ -796,6 +796,45 @@ void TestKeePass2Format::testDuplicateAttachments()
     QCOMPARE(db->rootGroup()->entries()[2]->attachments()->value("c3"), attachment3);
 }
 
+void TestKeePass2Format::testLargeAttachments()
+{
+    // larger than the chunks attachments are encoded in, and not a multiple of 3
+    QByteArray attachment;
+    for (int i = 0; i < 300001; ++i) {
+        attachment.append(static_cast<char>((i * 7) % 256));
+    }
+
+    for (auto compression : {Database::CompressionNone, Database::CompressionGZip}) {
+        auto db = QSharedPointer<Database>::create();
+        db->setKey(QSharedPointer<CompositeKey>::create());
+        db->setCompressionAlgorithm(compression);
+
+        auto entry = new Entry();
+        entry->setGroup(db->rootGroup());
+        entry->attachments()->set("large", attachment);
+        entry->attachments()->set("empty", QByteArray());
+
+        QBuffer buffer;
+        buffer.open(QBuffer::ReadWrite);
+
+        bool hasError = false;
+        QString errorString;
+        writeKdbx(&buffer, db.data(), hasError, errorString);
+        if (hasError) {
+            QFAIL(qPrintable(QString("Error while writing database: %1").arg(errorString)));
+        }
+
+        buffer.seek(0);
+        readKdbx(&buffer, QSharedPointer<CompositeKey>::create(), db, hasError, errorString);
+        if (hasError) {
+            QFAIL(qPrintable(QString("Error while reading database: %1").arg(errorString)));
+        }
+
+        QCOMPARE(db->rootGroup()->entries()[0]->attachments()->value("large"), attachment);
+        QCOMPARE(db->rootGroup()->entries()[0]->attachments()->value("empty"), QByteArray());
+    }
+}
+
 /**
  * Fast "dummy" KDF
  */
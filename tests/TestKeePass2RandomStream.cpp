@@ -87,3 +87,92 @@ void TestKeePass2RandomStream::test()
     QCOMPARE(cipherData, cipherDataEncrypt);
     QCOMPARE(randomStreamData, cipherData);
 }
+
+void TestKeePass2RandomStream::testChaCha20Batches()
+{
+    const QByteArray key = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+    const int Size = 10000;
+
+    QByteArray keyIv = CryptoHash::hash(key, CryptoHash::Sha512);
+    SymmetricCipher cipher;
+    QVERIFY(cipher.init(SymmetricCipher::ChaCha20, SymmetricCipher::Encrypt, keyIv.left(32), keyIv.mid(32, 12)));
+    QByteArray expected(Size, '\0');
+    QVERIFY(cipher.process(expected));
+
+    // Slices of varying size crossing several key stream batches
+    KeePass2RandomStream randomStream;
+    QVERIFY(randomStream.init(SymmetricCipher::ChaCha20, key));
+    QByteArray keyStream;
+    bool ok;
+    for (int i = 1; keyStream.size() < Size; ++i) {
+        QByteArray slice((i * 37) % 300, '\0');
+        slice.truncate(Size - keyStream.size());
+        QVERIFY(randomStream.processInPlace(slice));
+        keyStream.append(slice);
+    }
+    QCOMPARE(keyStream, expected);
+
+    // Re-initializing starts the key stream over
+    QVERIFY(randomStream.init(SymmetricCipher::ChaCha20, key));
+    QCOMPARE(randomStream.randomBytes(64, &ok), expected.left(64));
+    QVERIFY(ok);
+}
+
+void TestKeePass2RandomStream::testKeyStream()
+{
+    QFETCH(int, mode);
+
+    const QByteArray key = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+    const int Size = 10000;
+
+    KeePass2RandomStream randomStream;
+    QVERIFY(randomStream.init(static_cast<SymmetricCipher::Mode>(mode), key));
+    bool ok;
+    const QByteArray expected = randomStream.randomBytes(Size, &ok);
+    QVERIFY(ok);
+    QCOMPARE(randomStream.position(), qint64(Size));
+
+    // Skipping moves through the stream like processing does
+    QVERIFY(randomStream.init(static_cast<SymmetricCipher::Mode>(mode), key));
+    QVERIFY(randomStream.skip(4100));
+    QCOMPARE(randomStream.position(), qint64(4100));
+    QCOMPARE(randomStream.randomBytes(100, &ok), expected.mid(4100, 100));
+    QVERIFY(ok);
+
+    // The seekable copy yields the same key stream at any offset, in any order
+    auto keyStream = randomStream.keyStream();
+    QVERIFY(keyStream);
+    for (int offset : {9000, 0, 37, 4095, 64, 5000}) {
+        QByteArray slice(777, '\0');
+        slice.truncate(Size - offset);
+        QVERIFY(keyStream->apply(offset, slice.data(), slice.size()));
+        QCOMPARE(slice, expected.mid(offset, slice.size()));
+    }
+}
+
+void TestKeePass2RandomStream::testKeyStream_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::newRow("Salsa20") << static_cast<int>(SymmetricCipher::Salsa20);
+    QTest::newRow("ChaCha20") << static_cast<int>(SymmetricCipher::ChaCha20);
+}
+
+void TestKeePass2RandomStream::benchmarkProtectedValues()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    // Typical protected password lengths, processed one value at a time like KdbxXmlReader does
+    KeePass2RandomStream randomStream;
+    QVERIFY(randomStream.init(SymmetricCipher::ChaCha20, QByteArray(64, '\x42')));
+    QByteArray value(20, 'x');
+
+    QBENCHMARK
+    {
+        for (int i = 0; i < 100000; ++i) {
+            Q_UNUSED(randomStream.processInPlace(value));
+        }
+    }
+}
@@ -27,6 +27,10 @@ class TestKeePass2RandomStream : public QObject
 private slots:
     void initTestCase();
     void test();
+    void testChaCha20Batches();
+    void testKeyStream();
+    void testKeyStream_data();
+    void benchmarkProtectedValues();
 };
 
 #endif // KEEPASSX_TESTKEEPASS2RANDOMSTREAM_H
@@ -19,15 +19,23 @@
 #include "TestKeys.h"
 
 #include <QBuffer>
+#include <QTemporaryFile>
 #include <QTest>
 
+#include <argon2.h>
+
 #include "config-keepassx-tests.h"
 
 #include "core/Database.h"
 #include "core/Metadata.h"
+#include "crypto/AesKdfAccel.h"
+#include "crypto/Argon2Accel.h"
 #include "crypto/Crypto.h"
 #include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
+#include "crypto/SymmetricCipher.h"
 #include "crypto/kdf/AesKdf.h"
+#include "crypto/kdf/Argon2Kdf.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "keys/CompositeKey.h"
@@ -37,6 +45,7 @@
 
 QTEST_GUILESS_MAIN(TestKeys)
 Q_DECLARE_METATYPE(FileKey::Type);
+Q_DECLARE_METATYPE(Argon2Accel::Kernel);
 
 void TestKeys::initTestCase()
 {
@@ -202,6 +211,32 @@ void TestKeys::testFileKeyHash()
     QCOMPARE(fileKey.rawKey(), cryptoHash.result());
 }
 
+void TestKeys::testFileKeyReload()
+{
+    QTemporaryFile keyFile;
+    QVERIFY(keyFile.open());
+    // span several hash chunks
+    const QByteArray content = randomGen()->randomArray(3 * 1024 * 1024 + 17);
+    QCOMPARE(keyFile.write(content), qint64(content.size()));
+    keyFile.close();
+
+    FileKey fileKey;
+    QVERIFY(fileKey.load(keyFile.fileName()));
+    QCOMPARE(fileKey.type(), FileKey::Hashed);
+    QCOMPARE(fileKey.rawKey(), CryptoHash::hash(content, CryptoHash::Sha256));
+
+    // a replaced file is read again, even with the same size
+    const QByteArray newContent = randomGen()->randomArray(content.size());
+    QVERIFY(keyFile.open());
+    QVERIFY(keyFile.resize(0));
+    QCOMPARE(keyFile.write(newContent), qint64(newContent.size()));
+    keyFile.close();
+
+    FileKey changedKey;
+    QVERIFY(changedKey.load(keyFile.fileName()));
+    QCOMPARE(changedKey.rawKey(), CryptoHash::hash(newContent, CryptoHash::Sha256));
+}
+
 void TestKeys::testFileKeyError()
 {
     bool result;
@@ -220,6 +255,180 @@ void TestKeys::testFileKeyError()
     errorMsg = "";
 }
 
+void TestKeys::testTransformedKeyCache()
+{
+    auto compositeKey = QSharedPointer<CompositeKey>::create();
+    compositeKey->addKey(QSharedPointer<PasswordKey>::create("password"));
+
+    AesKdf kdf(true);
+    kdf.setRounds(1);
+    kdf.randomizeSeed();
+
+    QByteArray transformed;
+    QVERIFY(compositeKey->transform(kdf, transformed));
+    QVERIFY(!compositeKey->hasTransformedKey(kdf));
+
+    // A cached result is returned verbatim without running the KDF
+    QByteArray sealed(32, '\x5A');
+    compositeKey->setTransformedKey(kdf, sealed);
+    QVERIFY(compositeKey->hasTransformedKey(kdf));
+    QByteArray result;
+    QVERIFY(compositeKey->transform(kdf, result));
+    QCOMPARE(result, sealed);
+
+    // The cache survives serialization
+    auto restoredKey = QSharedPointer<CompositeKey>::create();
+    restoredKey->deserialize(compositeKey->serialize());
+    QCOMPARE(restoredKey->rawKey(), compositeKey->rawKey());
+    QVERIFY(restoredKey->hasTransformedKey(kdf));
+    QVERIFY(restoredKey->transform(kdf, result));
+    QCOMPARE(result, sealed);
+
+    // Different KDF parameters or key components invalidate the cache
+    auto reseeded = kdf.clone();
+    reseeded->randomizeSeed();
+    QVERIFY(!compositeKey->hasTransformedKey(*reseeded));
+    QVERIFY(compositeKey->transform(*reseeded, result));
+    QVERIFY(result != sealed);
+
+    restoredKey->addKey(QSharedPointer<PasswordKey>::create("other"));
+    QVERIFY(restoredKey->transform(kdf, result));
+    QVERIFY(result != sealed);
+
+    // Challenge-response keys always require the hardware key
+    auto challengeKey = QSharedPointer<CompositeKey>::create();
+    challengeKey->addKey(QSharedPointer<PasswordKey>::create("password"));
+    challengeKey->addChallengeResponseKey(QSharedPointer<MockChallengeResponseKey>::create(QByteArray(16, 0x10)));
+    challengeKey->setTransformedKey(kdf, sealed);
+    QVERIFY(!challengeKey->hasTransformedKey(kdf));
+
+    // A database opens with the sealed key of its current KDF parameters
+    auto db1 = QSharedPointer<Database>::create();
+    db1->setKey(compositeKey);
+    KeePass2Writer writer;
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    QVERIFY(writer.writeDatabase(&buffer, db1.data()));
+
+    auto unlockKey = QSharedPointer<CompositeKey>::create();
+    unlockKey->addKey(QSharedPointer<PasswordKey>::create("password"));
+    unlockKey->setTransformedKey(*db1->kdf(), db1->transformedDatabaseKey());
+    auto quickKey = QSharedPointer<CompositeKey>::create();
+    quickKey->deserialize(unlockKey->serialize());
+
+    buffer.seek(0);
+    auto db2 = QSharedPointer<Database>::create();
+    KeePass2Reader reader;
+    QVERIFY(reader.readDatabase(&buffer, quickKey, db2.data()));
+    QCOMPARE(db2->transformedDatabaseKey(), db1->transformedDatabaseKey());
+}
+
+void TestKeys::testKdfBenchmark()
+{
+    AesKdf aesKdf;
+    auto aesResult = aesKdf.benchmarkDetailed(100);
+    QVERIFY(aesResult.samples >= 2);
+    QVERIFY(aesResult.msecPerRound > 0);
+    QVERIFY(aesResult.rounds > 1);
+    QVERIFY(aesResult.deviation >= 0);
+
+    Argon2Kdf argon2Kdf(Argon2Kdf::Type::Argon2id);
+    argon2Kdf.setMemory(1 << 10);
+    argon2Kdf.setParallelism(2);
+    argon2Kdf.setRounds(7);
+    auto argon2Result = argon2Kdf.benchmarkDetailed(100);
+    QVERIFY(argon2Result.samples >= 2);
+    QVERIFY(argon2Result.rounds >= 1);
+    QVERIFY(!argon2Result.implementation.isEmpty());
+    QCOMPARE(argon2Kdf.benchmark(100) > 0, true);
+    // The benchmark works on a copy and leaves the configured rounds alone
+    QCOMPARE(argon2Kdf.rounds(), 7);
+}
+
+void TestKeys::testAesKdfRounds()
+{
+    QByteArray seed(32, '\0');
+    QByteArray key(32, '\0');
+    for (int i = 0; i < 32; ++i) {
+        seed[i] = static_cast<char>(i * 7 + 1);
+        key[i] = static_cast<char>(0xA0 ^ i);
+    }
+
+    // Known answer for three rounds
+    QByteArray data = key;
+    QVERIFY(SymmetricCipher::aesKdf(seed, 3, data));
+    QCOMPARE(data.toHex(), QByteArray("ef7accb4a0174bb1fdbfd83b905b8023eb3f0029a00dd18280c6a5bd0b124576"));
+
+    // Compare against AES-256 applied block by block (CBC with a zero IV is ECB for a single block)
+    const int rounds = 50;
+    QByteArray expected = key;
+    for (int r = 0; r < rounds; ++r) {
+        for (int half = 0; half < 2; ++half) {
+            SymmetricCipher cipher;
+            QVERIFY(cipher.init(SymmetricCipher::Aes256_CBC, SymmetricCipher::Encrypt, seed, QByteArray(16, '\0')));
+            QVERIFY(cipher.process(expected.data() + half * 16, 16));
+        }
+    }
+    data = key;
+    QVERIFY(SymmetricCipher::aesKdf(seed, rounds, data));
+    QCOMPARE(data, expected);
+}
+
+void TestKeys::testArgon2Kernels_data()
+{
+    QTest::addColumn<Argon2Accel::Kernel>("kernel");
+    QTest::newRow("portable") << Argon2Accel::Kernel::Portable;
+    QTest::newRow("SSE2") << Argon2Accel::Kernel::Sse2;
+    QTest::newRow("AVX2") << Argon2Accel::Kernel::Avx2;
+    QTest::newRow("AVX-512") << Argon2Accel::Kernel::Avx512;
+    QTest::newRow("NEON") << Argon2Accel::Kernel::Neon;
+}
+
+void TestKeys::testArgon2Kernels()
+{
+    QFETCH(Argon2Accel::Kernel, kernel);
+    if (!Argon2Accel::isSupported(kernel)) {
+        QSKIP("Kernel not supported by this CPU");
+    }
+
+    // Known answer from the reference implementation's test suite
+    QByteArray out(32, '\0');
+    QVERIFY(Argon2Accel::hash(
+        kernel, Argon2Accel::Type::Argon2id, 0x13, 2, 1 << 16, 1, QByteArray("password"), QByteArray("somesalt"), out));
+    QCOMPARE(out.toHex(), QByteArray("09316115d5cf24ed5a15a31a3ba326e5cf32edc24702987c02b6566f61913cf7"));
+
+    // Compare with libargon2 for both variants and versions, several lanes and odd memory sizes
+    const QByteArray password = QByteArray::fromHex("00112233445566778899aabbccddeeff");
+    const QByteArray salt(32, '\x5c');
+    for (auto type : {Argon2Accel::Type::Argon2d, Argon2Accel::Type::Argon2id}) {
+        for (quint32 version : {0x10u, 0x13u}) {
+            for (quint32 lanes : {1u, 3u}) {
+                const quint32 iterations = 3;
+                const quint32 memory = 100 * lanes + 13;
+                QByteArray expected(32, '\0');
+                QCOMPARE(argon2_hash(iterations,
+                                     memory,
+                                     lanes,
+                                     password.constData(),
+                                     password.size(),
+                                     salt.constData(),
+                                     salt.size(),
+                                     expected.data(),
+                                     expected.size(),
+                                     nullptr,
+                                     0,
+                                     type == Argon2Accel::Type::Argon2d ? Argon2_d : Argon2_id,
+                                     version),
+                         static_cast<int>(ARGON2_OK));
+
+                QByteArray result(32, '\0');
+                QVERIFY(Argon2Accel::hash(kernel, type, version, iterations, memory, lanes, password, salt, result));
+                QCOMPARE(result, expected);
+            }
+        }
+    }
+}
+
 void TestKeys::benchmarkTransformKey()
 {
     QByteArray env = qgetenv("BENCHMARK");
@@ -240,6 +449,7 @@ void TestKeys::benchmarkTransformKey()
     kdf.setSeed(seed);
     kdf.setRounds(1e6);
 
+    qInfo("AES-KDF hardware acceleration: %s", AesKdfAccel::isSupported() ? "yes" : "no");
     QBENCHMARK
     {
         Q_UNUSED(!compositeKey->transform(kdf, result));
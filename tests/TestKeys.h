@@ -33,8 +33,14 @@ private slots:
     void testCreateFileKey();
     void testCreateAndOpenFileKey();
     void testFileKeyHash();
+    void testFileKeyReload();
     void testFileKeyError();
     void testCompositeKeyComponents();
+    void testTransformedKeyCache();
+    void testKdfBenchmark();
+    void testAesKdfRounds();
+    void testArgon2Kernels_data();
+    void testArgon2Kernels();
     void benchmarkTransformKey();
 };
 
@@ -1348,6 +1348,177 @@ void TestMerge::testDeletedRevertedGroup()
     QVERIFY(group2DestinationMerged->notes() == "Updated");
 }
 
+/**
+ * An incremental merge stores a watermark in the destination
+ * database and still propagates entries changed after it.
+ */
+void TestMerge::testIncrementalMerge()
+{
+    QScopedPointer<Database> dbDestination(createTestDatabase());
+    QScopedPointer<Database> dbSource(
+        createTestDatabaseStructureClone(dbDestination.data(), Entry::CloneNoFlags, Group::CloneIncludeEntries));
+
+    const auto watermarkKey = Merger::watermarkKey(dbSource.data());
+    QVERIFY(!dbDestination->metadata()->customData()->contains(watermarkKey));
+
+    m_clock->advanceSecond(1);
+
+    Merger merger1(dbSource.data(), dbDestination.data());
+    merger1.setIncremental(true);
+    merger1.merge();
+    QVERIFY(dbDestination->metadata()->customData()->contains(watermarkKey));
+    const auto watermark = dbDestination->metadata()->customData()->value(watermarkKey);
+
+    m_clock->advanceSecond(1);
+
+    QPointer<Entry> entrySource = dbSource->rootGroup()->findEntryByPath("entry1");
+    QVERIFY(entrySource);
+    entrySource->beginUpdate();
+    entrySource->setPassword("updated");
+    entrySource->endUpdate();
+
+    m_clock->advanceSecond(1);
+
+    Merger merger2(dbSource.data(), dbDestination.data());
+    merger2.setIncremental(true);
+    QVERIFY(!merger2.merge().isEmpty());
+    QCOMPARE(dbDestination->rootGroup()->findEntryByPath("entry1")->password(), QString("updated"));
+    QVERIFY(dbDestination->metadata()->customData()->value(watermarkKey) != watermark);
+
+    m_clock->advanceSecond(1);
+
+    Merger merger3(dbSource.data(), dbDestination.data());
+    merger3.setIncremental(true);
+    QVERIFY(merger3.merge().isEmpty());
+    QCOMPARE(dbDestination->rootGroup()->entriesRecursive().size(), 2);
+}
+
+/**
+ * The watermark for a source is neither taken over from nor removed by the merge
+ * of a third database, and source entries the destination lost since are merged again.
+ */
+void TestMerge::testIncrementalMergeThreeDatabases()
+{
+    QScopedPointer<Database> dbDestination(createTestDatabase());
+    QScopedPointer<Database> dbSource(
+        createTestDatabaseStructureClone(dbDestination.data(), Entry::CloneNoFlags, Group::CloneIncludeEntries));
+    QScopedPointer<Database> dbThird(
+        createTestDatabaseStructureClone(dbDestination.data(), Entry::CloneNoFlags, Group::CloneIncludeEntries));
+    const auto watermarkKey = Merger::watermarkKey(dbSource.data());
+
+    QPointer<Entry> entryDestination = dbDestination->rootGroup()->findEntryByPath("entry1");
+    QVERIFY(entryDestination);
+    const QString oldPassword = entryDestination->password();
+    const TimeInfo oldTimeInfo = entryDestination->timeInfo();
+
+    m_clock->advanceSecond(1);
+
+    QPointer<Entry> entrySource = dbSource->rootGroup()->findEntryByPath("entry1");
+    QVERIFY(entrySource);
+    entrySource->beginUpdate();
+    entrySource->setPassword("source");
+    entrySource->endUpdate();
+
+    m_clock->advanceSecond(1);
+
+    Merger merger1(dbSource.data(), dbDestination.data());
+    merger1.setIncremental(true);
+    merger1.merge();
+    QCOMPARE(dbDestination->rootGroup()->findEntryByPath("entry1")->password(), QString("source"));
+    const auto watermark = dbDestination->metadata()->customData()->value(watermarkKey);
+    QVERIFY(!watermark.isEmpty());
+
+    // Newer custom data of a third database without the watermark keeps it
+    m_clock->advanceSecond(1);
+    dbThird->metadata()->customData()->set("third", "value");
+    m_clock->advanceSecond(1);
+    Merger merger2(dbThird.data(), dbDestination.data());
+    merger2.merge();
+    QCOMPARE(dbDestination->metadata()->customData()->value("third"), QString("value"));
+    QCOMPARE(dbDestination->metadata()->customData()->value(watermarkKey), watermark);
+
+    // Nor is the watermark of the third database for the same source taken over
+    m_clock->advanceSecond(1);
+    const auto future = m_clock->currentDateTimeUtc().addYears(1).toMSecsSinceEpoch();
+    dbThird->metadata()->customData()->set(watermarkKey, QString::number(future));
+    m_clock->advanceSecond(1);
+    Merger merger3(dbThird.data(), dbDestination.data());
+    merger3.merge();
+    QCOMPARE(dbDestination->metadata()->customData()->value(watermarkKey), watermark);
+
+    // The destination loses the merged state of the entry, e.g. restored from a backup
+    entryDestination = dbDestination->rootGroup()->findEntryByPath("entry1");
+    QVERIFY(entryDestination);
+    entryDestination->setUpdateTimeinfo(false);
+    entryDestination->setPassword(oldPassword);
+    entryDestination->setTimeInfo(oldTimeInfo);
+    entryDestination->setUpdateTimeinfo(true);
+
+    m_clock->advanceSecond(1);
+
+    Merger merger4(dbSource.data(), dbDestination.data());
+    merger4.setIncremental(true);
+    QVERIFY(!merger4.merge().isEmpty());
+    QCOMPARE(dbDestination->rootGroup()->findEntryByPath("entry1")->password(), QString("source"));
+}
+
+/**
+ * Deciding the entry merges on the thread pool gives the same result as
+ * merging one entry after the other.
+ */
+void TestMerge::testParallelMerge()
+{
+    QScopedPointer<Database> dbDestination(createTestDatabase());
+    auto* group = dbDestination->rootGroup()->findChildByName("group1");
+    for (int i = 0; i < 600; ++i) {
+        auto* entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setTitle(QString("entry %1").arg(i));
+        entry->setGroup(group);
+    }
+    QScopedPointer<Database> dbSource(
+        createTestDatabaseStructureClone(dbDestination.data(), Entry::CloneIncludeHistory, Group::CloneIncludeEntries));
+
+    m_clock->advanceSecond(1);
+
+    // Change entries on both sides, the newer change is on top of the other one
+    const auto sourceEntries = dbSource->rootGroup()->entriesRecursive();
+    for (int i = 0; i < sourceEntries.size(); i += 3) {
+        sourceEntries[i]->beginUpdate();
+        sourceEntries[i]->setPassword("source");
+        sourceEntries[i]->endUpdate();
+    }
+
+    m_clock->advanceSecond(1);
+
+    const auto destinationEntries = dbDestination->rootGroup()->entriesRecursive();
+    for (int i = 0; i < destinationEntries.size(); i += 5) {
+        destinationEntries[i]->beginUpdate();
+        destinationEntries[i]->setUsername("destination");
+        destinationEntries[i]->endUpdate();
+    }
+
+    m_clock->advanceSecond(1);
+
+    QScopedPointer<Database> dbSerial(
+        createTestDatabaseStructureClone(dbDestination.data(), Entry::CloneIncludeHistory, Group::CloneIncludeEntries));
+
+    Merger serialMerger(dbSource.data(), dbSerial.data());
+    const auto serialChanges = serialMerger.merge();
+
+    Merger parallelMerger(dbSource.data(), dbDestination.data());
+    parallelMerger.setParallel(true);
+    const auto parallelChanges = parallelMerger.merge();
+
+    QCOMPARE(parallelChanges.size(), serialChanges.size());
+    const auto serialEntries = dbSerial->rootGroup()->entriesRecursive();
+    const auto parallelEntries = dbDestination->rootGroup()->entriesRecursive();
+    QCOMPARE(parallelEntries.size(), serialEntries.size());
+    for (int i = 0; i < serialEntries.size(); ++i) {
+        QVERIFY(parallelEntries[i]->equals(serialEntries[i], CompareItemIgnoreLocation));
+    }
+}
+
 /**
  * If the group is updated in the source database, and the
  * destination database after, the group should remain the
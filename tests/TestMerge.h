@@ -55,6 +55,9 @@ private slots:
     void testDeletedGroup();
     void testDeletedRevertedEntry();
     void testDeletedRevertedGroup();
+    void testIncrementalMerge();
+    void testIncrementalMergeThreeDatabases();
+    void testParallelMerge();
 
 private:
     Database* createTestDatabase();
@@ -16,10 +16,15 @@
  */
 
 #include "TestOpenSSHKey.h"
+#include "core/Database.h"
+#include "core/Group.h"
 #include "crypto/Crypto.h"
 #include "sshagent/BinaryStream.h"
+#include "sshagent/KeeAgentSettings.h"
 #include "sshagent/OpenSSHKey.h"
+#include "sshagent/OpenSSHKeyGen.h"
 
+#include <QSet>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestOpenSSHKey)
@@ -564,3 +569,40 @@ void TestOpenSSHKey::testParseED25519SecurityKey()
     QCOMPARE(key.fingerprint(), QString("SHA256:PGtS5WvbnYmNqFIeRbzO6cVP9GLh8eEzENgkHp02XIA"));
     QCOMPARE(keyString, key.privateKey());
 }
+
+void TestOpenSSHKey::testGenerateForEntries()
+{
+    Database db;
+    QList<Entry*> entries;
+    for (int i = 0; i < 3; ++i) {
+        auto* entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setGroup(db.rootGroup());
+        entries << entry;
+    }
+    // Existing attachments are kept
+    entries.last()->attachments()->set("id_ed25519", "existing");
+
+    QCOMPARE(OpenSSHKeyGen::generateForEntries(entries, "Ed25519", 0, "batch@keepassxc"), 3);
+
+    QSet<QString> fingerprints;
+    for (auto* entry : entries) {
+        KeeAgentSettings settings;
+        QVERIFY(settings.fromEntry(entry));
+        QCOMPARE(settings.selectedType(), QString("attachment"));
+
+        const auto name = settings.attachmentName();
+        QCOMPARE(name, QString(entry == entries.last() ? "id_ed25519.1" : "id_ed25519"));
+
+        OpenSSHKey key;
+        QVERIFY(key.parsePKCS1PEM(entry->attachments()->value(name)));
+        QVERIFY(key.openKey());
+        QCOMPARE(key.type(), QString("ssh-ed25519"));
+        QCOMPARE(key.comment(), QString("batch@keepassxc"));
+        fingerprints.insert(key.fingerprint());
+    }
+    QCOMPARE(entries.last()->attachments()->value("id_ed25519"), QByteArray("existing"));
+    QCOMPARE(fingerprints.size(), 3);
+
+    QCOMPARE(OpenSSHKeyGen::generateForEntries(entries, "DSA", 1024, {}), 0);
+}
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestParallelGzipStream.h"
+
+#include <QBuffer>
+#include <QTest>
+
+#include "streams/ParallelGzipStream.h"
+#include "streams/qtiocompressor.h"
+
+QTEST_GUILESS_MAIN(TestParallelGzipStream)
+
+void TestParallelGzipStream::testRoundTrip_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("level");
+
+    QTest::newRow("empty") << 0 << 6;
+    QTest::newRow("small") << 1000 << 6;
+    QTest::newRow("one chunk") << 128 * 1024 << 6;
+    QTest::newRow("many chunks") << 3 * 1024 * 1024 + 17 << 6;
+    QTest::newRow("stored") << 300 * 1024 << 0;
+    QTest::newRow("best") << 300 * 1024 << 9;
+}
+
+void TestParallelGzipStream::testRoundTrip()
+{
+    QFETCH(int, size);
+    QFETCH(int, level);
+
+    QByteArray data;
+    data.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        // compressible, but not trivially so
+        data.append(static_cast<char>((static_cast<qint64>(i) * i / 7 + i / 1000) % 61 + 'A'));
+    }
+
+    QBuffer compressed;
+    QVERIFY(compressed.open(QIODevice::WriteOnly));
+    ParallelGzipStream writer(&compressed, level);
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+    // odd write sizes so chunks never line up with the writes
+    for (int offset = 0; offset < data.size(); offset += 10007) {
+        QByteArray part = data.mid(offset, 10007);
+        QCOMPARE(writer.write(part), qint64(part.size()));
+    }
+    writer.close();
+    compressed.close();
+
+    const QByteArray gzip = compressed.data();
+    QVERIFY(gzip.startsWith("\x1f\x8b\x08"));
+    if (level > 0 && size > 0) {
+        QVERIFY(gzip.size() < data.size());
+    }
+
+    QBuffer input;
+    input.setData(gzip);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+    QtIOCompressor reader(&input);
+    reader.setStreamFormat(QtIOCompressor::GzipFormat);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QCOMPARE(reader.readAll(), data);
+}
+
+void TestParallelGzipStream::testIncompressibleChunks()
+{
+    QByteArray text;
+    for (int i = 0; text.size() < 200 * 1024; ++i) {
+        text.append(QString("<String><Key>Title</Key><Value>Entry %1</Value></String>").arg(i).toLatin1());
+    }
+    // Stands in for an already compressed attachment
+    QByteArray random(300 * 1024, Qt::Uninitialized);
+    quint32 state = 2463534242u;
+    for (char& byte : random) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        byte = static_cast<char>(state);
+    }
+
+    QBuffer compressed;
+    QVERIFY(compressed.open(QIODevice::WriteOnly));
+    ParallelGzipStream writer(&compressed, 6);
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+    QCOMPARE(writer.write(text.left(1000)), qint64(1000));
+    QVERIFY(writer.endChunk());
+    QCOMPARE(writer.write(random), qint64(random.size()));
+    QVERIFY(writer.endChunk());
+    QCOMPARE(writer.write(text), qint64(text.size()));
+    writer.close();
+    compressed.close();
+
+    // The random data is stored, the text is still compressed
+    QCOMPARE(writer.storedChunks(), 3);
+    const QByteArray gzip = compressed.data();
+    QVERIFY(gzip.size() > random.size());
+    QVERIFY(gzip.size() < random.size() + text.size() / 4);
+
+    QBuffer input;
+    input.setData(gzip);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+    QtIOCompressor reader(&input);
+    reader.setStreamFormat(QtIOCompressor::GzipFormat);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QCOMPARE(reader.readAll(), text.left(1000) + random + text);
+}
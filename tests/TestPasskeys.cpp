@@ -18,6 +18,7 @@
 #include "TestPasskeys.h"
 #include "browser/BrowserCbor.h"
 #include "browser/BrowserMessageBuilder.h"
+#include "browser/BrowserPasskeys.h"
 #include "browser/BrowserPasskeysClient.h"
 #include "browser/BrowserService.h"
 #include "browser/PasskeyUtils.h"
@@ -539,6 +540,55 @@ void TestPasskeys::testEntry()
     QVERIFY(entry->hasPasskey());
 }
 
+void TestPasskeys::testPasskeyIndex()
+{
+    auto db = QSharedPointer<Database>::create();
+    auto* root = db->rootGroup();
+
+    auto* entry1 = new Entry();
+    entry1->setGroup(root);
+    browserService()->addPasskeyToEntry(
+        entry1, "example.com", "example.com", "user1", "credential1", "userHandle1", "privateKey");
+    auto* entry2 = new Entry();
+    entry2->setGroup(root);
+    browserService()->addPasskeyToEntry(
+        entry2, "example.com", "example.com", "user2", "credential2", "userHandle2", "privateKey");
+    auto* entry3 = new Entry();
+    entry3->setGroup(root);
+    entry3->setUrl("https://example.com");
+
+    QCOMPARE(db->passkeyIndex().entriesForRelyingParty("example.com").size(), 2);
+    QVERIFY(db->passkeyIndex().entriesForRelyingParty("example.org").isEmpty());
+    QVERIFY(db->passkeyIndex().entriesForCredential("credential1").contains(entry1));
+    QVERIFY(db->passkeyIndex().entriesForCredential("credential3").isEmpty());
+
+    auto result = browserService()->searchEntries(db, "example.com", "", {}, true);
+    QCOMPARE(result.size(), 2);
+    QVERIFY(browserService()->searchEntries(db, "example.org", "", {}, true).isEmpty());
+
+    // The index follows changes after it has been built
+    entry2->attributes()->set(BrowserPasskeys::KPEX_PASSKEY_RELYING_PARTY, "example.org");
+    QCOMPARE(db->passkeyIndex().entriesForRelyingParty("example.com").size(), 1);
+    QVERIFY(db->passkeyIndex().entriesForRelyingParty("example.org").contains(entry2));
+    result = browserService()->searchEntries(db, "example.org", "", {}, true);
+    QCOMPARE(result.size(), 1);
+    QCOMPARE(result[0], entry2);
+
+    // A generated user ID takes precedence over the credential ID
+    entry1->attributes()->set(BrowserPasskeys::KPEX_PASSKEY_GENERATED_USER_ID, "generated1");
+    QVERIFY(db->passkeyIndex().entriesForCredential("credential1").isEmpty());
+    QVERIFY(db->passkeyIndex().entriesForCredential("generated1").contains(entry1));
+
+    entry3->attributes()->set(BrowserPasskeys::KPEX_PASSKEY_RELYING_PARTY, "example.com");
+    QCOMPARE(db->passkeyIndex().entriesForRelyingParty("example.com").size(), 2);
+    entry3->attributes()->remove(BrowserPasskeys::KPEX_PASSKEY_RELYING_PARTY);
+    QCOMPARE(db->passkeyIndex().entriesForRelyingParty("example.com").size(), 1);
+
+    delete entry1;
+    QVERIFY(db->passkeyIndex().entriesForRelyingParty("example.com").isEmpty());
+    QVERIFY(db->passkeyIndex().entriesForCredential("generated1").isEmpty());
+}
+
 void TestPasskeys::testIsDomain()
 {
     QVERIFY(passkeyUtils()->isDomain("test.example.com"));
@@ -45,6 +45,7 @@ private slots:
     void testSetFlags();
 
     void testEntry();
+    void testPasskeyIndex();
     void testIsDomain();
     void testRegistrableDomainSuffix();
     void testRpIdValidation();
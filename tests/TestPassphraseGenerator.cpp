@@ -17,9 +17,11 @@
 
 #include "TestPassphraseGenerator.h"
 #include "core/PassphraseGenerator.h"
+#include "core/PassphraseWordlist.h"
 #include "crypto/Crypto.h"
 
 #include <QRegularExpression>
+#include <QTemporaryFile>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestPassphraseGenerator)
@@ -52,3 +54,58 @@ void TestPassphraseGenerator::testWordCase()
     QRegularExpression regex("^([A-Z][a-z]* ?)+$");
     QVERIFY(regex.match(passphrase).hasMatch());
 }
+
+void TestPassphraseGenerator::testGeneratePassphrases()
+{
+    PassphraseGenerator generator;
+    generator.setWordCount(4);
+    generator.setWordSeparator(".");
+    generator.setWordCase(PassphraseGenerator::TITLECASE);
+    QVERIFY(generator.isValid());
+
+    QVERIFY(generator.generatePassphrases(0).isEmpty());
+
+    // Large enough to be generated in parallel
+    const int count = PassphraseGenerator::ParallelShardSize * 8;
+    const QStringList passphrases = generator.generatePassphrases(count);
+    QCOMPARE(passphrases.size(), count);
+
+    QRegularExpression regex("^[A-Z][^.]*(\\.[A-Z][^.]*){3}$");
+    for (const auto& passphrase : passphrases) {
+        QVERIFY2(regex.match(passphrase).hasMatch(), qPrintable(passphrase));
+    }
+}
+
+void TestPassphraseGenerator::testWordlist()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("-----BEGIN PGP SIGNED MESSAGE-----\n"
+               "Hash: SHA256\n"
+               "\n"
+               "11111\tabacus\r\n"
+               "1-1-1-1-2 caf\xc3\xa9\n"
+               "- -dash\n"
+               "  plain  \n"
+               "\n"
+               "-----BEGIN PGP SIGNATURE-----\n"
+               "signature\n");
+    file.close();
+
+    auto wordlist = PassphraseWordlist::load(file.fileName());
+    QVERIFY(wordlist);
+    QCOMPARE(wordlist->size(), 4);
+    QCOMPARE(wordlist->word(0), QString("abacus"));
+    QCOMPARE(wordlist->word(1), QString("caf\u00e9"));
+    QCOMPARE(wordlist->word(2), QString("-dash"));
+    QCOMPARE(wordlist->word(3), QString("plain"));
+
+    // Loaded once per process
+    QCOMPARE(PassphraseWordlist::load(file.fileName()), wordlist);
+
+    QVERIFY(!PassphraseWordlist::load(file.fileName() + ".missing"));
+
+    // The file is not kept open
+    QVERIFY(file.remove());
+    QCOMPARE(wordlist->word(3), QString("plain"));
+}
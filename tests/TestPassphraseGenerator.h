@@ -27,6 +27,8 @@ class TestPassphraseGenerator : public QObject
 private slots:
     void initTestCase();
     void testWordCase();
+    void testGeneratePassphrases();
+    void testWordlist();
 };
 
 #endif // KEEPASSXC_TESTPASSPHRASEGENERATOR_H
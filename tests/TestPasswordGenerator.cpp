@@ -19,6 +19,7 @@
 #include "crypto/Crypto.h"
 
 #include <QRegularExpression>
+#include <QSet>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestPasswordGenerator)
@@ -281,3 +282,27 @@ void TestPasswordGenerator::testReset()
     QCOMPARE(m_generator.getExcludedCharacterSet(), default_generator.getExcludedCharacterSet());
     QCOMPARE(m_generator.getLength(), default_generator.getLength());
 }
+
+void TestPasswordGenerator::testGeneratePasswords()
+{
+    m_generator.setCharClasses(PasswordGenerator::CharClass::LowerLetters | PasswordGenerator::CharClass::Numbers);
+    m_generator.setFlags(PasswordGenerator::GeneratorFlag::CharFromEveryGroup);
+    m_generator.setExcludedCharacterSet("ab01");
+    m_generator.setLength(10);
+    QVERIFY(m_generator.isValid());
+
+    QVERIFY(m_generator.generatePasswords(0).isEmpty());
+
+    // Large enough to be generated in parallel
+    const int count = PasswordGenerator::ParallelShardSize * 8;
+    const QStringList passwords = m_generator.generatePasswords(count);
+    QCOMPARE(passwords.size(), count);
+
+    QRegularExpression regex("^(?=.*[c-z])(?=.*[2-9])[c-z2-9]{10}$");
+    QSet<QString> distinct;
+    for (const auto& password : passwords) {
+        QVERIFY2(regex.match(password).hasMatch(), qPrintable(password));
+        distinct.insert(password);
+    }
+    QCOMPARE(distinct.size(), count);
+}
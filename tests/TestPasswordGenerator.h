@@ -43,6 +43,7 @@ private slots:
     void testValidity_data();
     void testValidity();
     void testReset();
+    void testGeneratePasswords();
 };
 
 #endif // KEEPASSXC_TESTPASSWORDGENERATOR_H
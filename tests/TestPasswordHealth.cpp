@@ -17,14 +17,23 @@
 
 #include "TestPasswordHealth.h"
 
+#include "core/Group.h"
+#include "core/Metadata.h"
 #include "core/PasswordHealth.h"
+#include "core/PasswordStrengthEstimator.h"
+#include "crypto/Crypto.h"
 
+#include <QSignalSpy>
 #include <QTest>
+#include <QUuid>
+
+#include <cmath>
 
 QTEST_GUILESS_MAIN(TestPasswordHealth)
 
 void TestPasswordHealth::initTestCase()
 {
+    QVERIFY(Crypto::init());
 }
 
 void TestPasswordHealth::testNoDb()
@@ -64,3 +73,139 @@ void TestPasswordHealth::testNoDb()
     QVERIFY(excellent.scoreReason().isEmpty());
     QVERIFY(excellent.scoreDetails().isEmpty());
 }
+
+void TestPasswordHealth::testHealthChecker()
+{
+    auto db = QSharedPointer<Database>::create();
+
+    auto reused1 = new Entry();
+    reused1->setPassword("MIhIN9UKrgtPL2hp");
+    reused1->setGroup(db->rootGroup());
+    auto reused2 = new Entry();
+    reused2->setPassword("MIhIN9UKrgtPL2hp");
+    reused2->setGroup(db->rootGroup());
+    auto expired = new Entry();
+    expired->setPassword("prompter-ream-oversleep-step-extortion-quarrel-reflected-prefix");
+    expired->setExpires(true);
+    expired->setExpiryTime(QDateTime::currentDateTimeUtc().addDays(-1));
+    expired->setGroup(db->rootGroup());
+
+    HealthChecker checker(db);
+
+    auto health = checker.evaluate(reused1);
+    QCOMPARE(health->score(), 63);
+    QCOMPARE(health->quality(), PasswordHealth::Quality::Weak);
+    QVERIFY(health->scoreReason().contains("2"));
+
+    health = checker.evaluate(expired);
+    QCOMPARE(health->score(), 0);
+    QCOMPARE(health->quality(), PasswordHealth::Quality::Bad);
+
+    // Analysing the password separately gives the same result
+    for (const auto* entry : {reused1, reused2, expired}) {
+        const auto direct = checker.evaluate(entry);
+        const auto split = checker.evaluate(entry, PasswordHealth(entry->password()));
+        QCOMPARE(split->score(), direct->score());
+        QCOMPARE(split->scoreReason(), direct->scoreReason());
+        QCOMPARE(split->scoreDetails(), direct->scoreDetails());
+    }
+}
+
+void TestPasswordHealth::testCache()
+{
+    auto cache = PasswordHealthCache::instance();
+    cache->clear();
+
+    QVERIFY(!cache->contains("Yohb2ChR4"));
+    QCOMPARE(int(PasswordHealth("Yohb2ChR4").entropy()), 47);
+    QVERIFY(cache->contains("Yohb2ChR4"));
+    QCOMPARE(int(cache->entropy("Yohb2ChR4")), 47);
+
+    auto db = QSharedPointer<Database>::create();
+    auto entry = new Entry();
+    entry->setPassword("MIhIN9UKrgtPL2hp");
+    entry->setGroup(db->rootGroup());
+    auto unanalysed = new Entry();
+    unanalysed->setPassword("secret");
+    unanalysed->setGroup(db->rootGroup());
+    const int score = entry->passwordHealth()->score();
+    db->markAsClean();
+
+    // Only a keyed hash of analysed passwords is stored, and the database stays clean
+    cache->store(db.data());
+    const auto stored = db->metadata()->customData()->value(PasswordHealthCache::CustomDataKey);
+    QVERIFY(!stored.isEmpty());
+    QVERIFY(!stored.contains("MIhIN9UKrgtPL2hp"));
+    QVERIFY(!db->isModified());
+
+    cache->clear();
+    cache->load(db.data());
+    QVERIFY(cache->contains("MIhIN9UKrgtPL2hp"));
+    QVERIFY(!cache->contains("secret"));
+    QVERIFY(!cache->contains("Yohb2ChR4"));
+    QCOMPARE(PasswordHealth("MIhIN9UKrgtPL2hp").score(), score);
+
+    // A new key is used every time
+    cache->store(db.data());
+    QVERIFY(db->metadata()->customData()->value(PasswordHealthCache::CustomDataKey) != stored);
+
+    PasswordHealthCache::remove(db.data());
+    QVERIFY(!db->metadata()->customData()->contains(PasswordHealthCache::CustomDataKey));
+    QVERIFY(!db->isModified());
+}
+
+void TestPasswordHealth::testStrengthEstimator()
+{
+    QCOMPARE(PasswordStrengthEstimator::charsetEntropy(""), 0.0);
+    QCOMPARE(PasswordStrengthEstimator::charsetEntropy("abc"), 3 * std::log2(26));
+    QCOMPARE(PasswordStrengthEstimator::charsetEntropy("aB3!"), 4 * std::log2(95));
+
+    PasswordStrengthEstimator estimator;
+    estimator.setDelay(0);
+    QSignalSpy spy(&estimator, SIGNAL(estimated(double, bool)));
+
+    // Short passwords are estimated right away
+    estimator.estimate("hello");
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toDouble(), PasswordHealth("hello").entropy());
+    QVERIFY(!spy.at(0).at(1).toBool());
+
+    // Long passwords are estimated from their character classes until they are analysed
+    // (passwords the session has not seen before, or they would be known right away)
+    const auto password = QUuid::createUuid().toString();
+    spy.clear();
+    estimator.estimate(password);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toDouble(), PasswordStrengthEstimator::charsetEntropy(password));
+    QVERIFY(spy.at(0).at(1).toBool());
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).toDouble(), PasswordHealth(password).entropy());
+    QVERIFY(!spy.at(1).at(1).toBool());
+
+    // Now known, so estimated right away
+    spy.clear();
+    estimator.estimate(password);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(!spy.at(0).at(1).toBool());
+
+    // Only the latest password is analysed
+    const auto older = QUuid::createUuid().toString();
+    const auto latest = QUuid::createUuid().toString();
+    spy.clear();
+    estimator.estimate(older);
+    estimator.estimate(latest);
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(2).at(0).toDouble(), PasswordHealth(latest).entropy());
+    QVERIFY(!spy.at(2).at(1).toBool());
+    QVERIFY(!PasswordHealthCache::instance()->contains(older));
+
+    // Nothing is reported for a cancelled password
+    const auto cancelled = QUuid::createUuid().toString();
+    spy.clear();
+    estimator.estimate(cancelled);
+    estimator.cancel();
+    QVERIFY(!spy.wait(100));
+    QCOMPARE(spy.count(), 1);
+}
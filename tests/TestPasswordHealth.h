@@ -27,6 +27,9 @@ class TestPasswordHealth : public QObject
 private slots:
     void initTestCase();
     void testNoDb();
+    void testHealthChecker();
+    void testCache();
+    void testStrengthEstimator();
 };
 
 #endif // KEEPASSX_TESTPASSWORDHEALTH_H
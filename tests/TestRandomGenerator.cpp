@@ -20,8 +20,12 @@
 #include "core/Global.h"
 #include "crypto/Random.h"
 
+#include <QSet>
 #include <QTest>
 
+#include <thread>
+#include <vector>
+
 QTEST_GUILESS_MAIN(TestRandomGenerator)
 
 void TestRandomGenerator::testArray()
@@ -58,3 +62,33 @@ void TestRandomGenerator::testUIntRange()
         QVERIFY(rand < 200);
     }
 }
+
+void TestRandomGenerator::testBufferedThreads()
+{
+    // Request sizes crossing the buffered/unbuffered boundary and the buffer refills
+    const int ThreadCount = 4;
+    const int Requests = 2000;
+    std::vector<QVector<QByteArray>> results(ThreadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < ThreadCount; ++t) {
+        threads.emplace_back([&results, t] {
+            for (int i = 0; i < Requests; ++i) {
+                results[t].append(randomGen()->randomArray(16 + (i % 300)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // No two threads or requests may observe the same bytes
+    QSet<QByteArray> seen;
+    for (const auto& threadResults : results) {
+        QCOMPARE(threadResults.size(), Requests);
+        for (int i = 0; i < threadResults.size(); ++i) {
+            QCOMPARE(threadResults[i].size(), 16 + (i % 300));
+            QVERIFY(!seen.contains(threadResults[i].left(16)));
+            seen.insert(threadResults[i].left(16));
+        }
+    }
+}
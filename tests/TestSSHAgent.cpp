@@ -18,11 +18,13 @@
 #include "TestSSHAgent.h"
 #include "config-keepassx-tests.h"
 #include "core/Config.h"
+#include "core/Group.h"
 #include "crypto/Crypto.h"
 #include "sshagent/KeeAgentSettings.h"
 #include "sshagent/OpenSSHKeyGen.h"
 #include "sshagent/SSHAgent.h"
 
+#include <QSignalSpy>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestSSHAgent)
@@ -213,6 +215,58 @@ void TestSSHAgent::testConfirmConstraint()
     QVERIFY(agent.checkIdentity(m_key, keyInAgent) && !keyInAgent);
 }
 
+void TestSSHAgent::testDatabaseUnlocked()
+{
+    SSHAgent agent;
+    agent.setEnabled(true);
+    agent.setAuthSockOverride(m_agentSocketFileName);
+
+    QVERIFY(agent.isAgentRunning());
+
+    auto db = QSharedPointer<Database>::create();
+    QList<OpenSSHKey> keys;
+    for (int i = 0; i < 3; ++i) {
+        OpenSSHKey key;
+        QVERIFY(OpenSSHKeyGen::generateEd25519(key));
+
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setGroup(db->rootGroup());
+        entry->attachments()->set("id_ed25519", key.privateKey().toLatin1());
+
+        KeeAgentSettings settings;
+        settings.setSelectedType("attachment");
+        settings.setAttachmentName("id_ed25519");
+        settings.setAllowUseOfSshKey(true);
+        settings.setAddAtDatabaseOpen(true);
+        settings.setRemoveAtDatabaseClose(true);
+        settings.toEntry(entry);
+
+        keys << key;
+    }
+
+    QSignalSpy errorSpy(&agent, &SSHAgent::error);
+    bool keyInAgent;
+
+    // all keys are added in one go
+    agent.databaseUnlocked(db);
+    QCOMPARE(errorSpy.size(), 0);
+    for (const auto& key : keys) {
+        QVERIFY(agent.checkIdentity(key, keyInAgent) && keyInAgent);
+    }
+
+    // keys already in the agent are not added again
+    agent.databaseUnlocked(db);
+    QCOMPARE(errorSpy.size(), 0);
+
+    // and still removed on lock
+    agent.databaseLocked(db);
+    QCOMPARE(errorSpy.size(), 0);
+    for (const auto& key : keys) {
+        QVERIFY(agent.checkIdentity(key, keyInAgent) && !keyInAgent);
+    }
+}
+
 void TestSSHAgent::testToOpenSSHKey()
 {
     KeeAgentSettings settings;
@@ -20,9 +20,12 @@
 #include <QTest>
 #include <QXmlStreamReader>
 
+#include "core/Group.h"
 #include "crypto/Crypto.h"
 #include "crypto/Random.h"
 #include "keeshare/KeeShareSettings.h"
+#include "keeshare/ShareExport.h"
+#include "mock/MockClock.h"
 
 #include <botan/rsa.h>
 
@@ -187,3 +190,47 @@ const QSharedPointer<Botan::RSA_PrivateKey> TestSharing::stubkey(int index)
     }
     return keys[index];
 }
+
+void TestSharing::testExportFingerprint()
+{
+    auto clock = new MockClock(2010, 5, 5, 10, 30, 10);
+    MockClock::setup(clock);
+
+    Database db;
+    auto* shared = new Group();
+    shared->setParent(db.rootGroup());
+    auto* other = new Group();
+    other->setParent(db.rootGroup());
+    auto* entry = new Entry();
+    entry->setGroup(shared);
+    auto* outside = new Entry();
+    outside->setGroup(other);
+
+    KeeShareSettings::Reference reference;
+    reference.type = KeeShareSettings::ExportTo;
+    reference.path = "/some/path.kdbx";
+
+    const auto original = ShareExport::fingerprint(reference, shared);
+    QCOMPARE(ShareExport::fingerprint(reference, shared), original);
+
+    // Changes outside of the share do not affect it
+    clock->advanceSecond(1);
+    outside->setTitle("Outside");
+    QCOMPARE(ShareExport::fingerprint(reference, shared), original);
+
+    clock->advanceSecond(1);
+    entry->setTitle("Shared");
+    const auto modified = ShareExport::fingerprint(reference, shared);
+    QVERIFY(modified != original);
+
+    reference.password = "Password";
+    QVERIFY(ShareExport::fingerprint(reference, shared) != modified);
+    reference.password.clear();
+
+    // Deletions are exported from the whole database
+    clock->advanceSecond(1);
+    delete outside;
+    QVERIFY(ShareExport::fingerprint(reference, shared) != modified);
+
+    MockClock::teardown();
+}
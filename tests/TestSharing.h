@@ -36,6 +36,7 @@ private slots:
     void testReferenceSerialization_data();
     void testSettingsSerialization();
     void testSettingsSerialization_data();
+    void testExportFingerprint();
 
 private:
     const QSharedPointer<Botan::RSA_PrivateKey> stubkey(int index = 0);
@@ -455,3 +455,201 @@ void TestSymmetricCipher::testStreamReset()
     writer.close();
     QCOMPARE(buffer.buffer().size(), 16);
 }
+
+void TestSymmetricCipher::testStreamLargeData()
+{
+    QByteArray key = QByteArray::fromHex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+    QByteArray iv = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+
+    QByteArray plainText;
+    for (int i = 0; i < 200003; ++i) {
+        plainText.append(static_cast<char>(i % 253));
+    }
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    SymmetricCipherStream writer(&buffer);
+    QVERIFY(writer.init(SymmetricCipher::Aes256_CBC, SymmetricCipher::Encrypt, key, iv));
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+    QCOMPARE(writer.write(plainText), qint64(plainText.size()));
+    QVERIFY(writer.reset());
+    QCOMPARE(buffer.buffer().size(), (plainText.size() / 16 + 1) * 16);
+    buffer.close();
+
+    // whole chunks handed over by the stream
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    SymmetricCipherStream chunkReader(&buffer);
+    QVERIFY(chunkReader.init(SymmetricCipher::Aes256_CBC, SymmetricCipher::Decrypt, key, iv));
+    QVERIFY(chunkReader.open(QIODevice::ReadOnly));
+    QByteArray decrypted;
+    QByteArray chunk;
+    do {
+        QVERIFY(chunkReader.readChunk(chunk));
+        decrypted.append(chunk);
+    } while (!chunk.isEmpty());
+    QCOMPARE(decrypted, plainText);
+    buffer.close();
+
+    // reads that do not line up with the cipher block size
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    SymmetricCipherStream reader(&buffer);
+    QVERIFY(reader.init(SymmetricCipher::Aes256_CBC, SymmetricCipher::Decrypt, key, iv));
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    decrypted.clear();
+    while (decrypted.size() < plainText.size()) {
+        QByteArray part = reader.read(1001);
+        QVERIFY(!part.isEmpty());
+        decrypted.append(part);
+    }
+    QCOMPARE(decrypted, plainText);
+    QCOMPARE(reader.read(1).size(), 0);
+}
+
+void TestSymmetricCipher::testCbcParallelDecryption_data()
+{
+    QTest::addColumn<SymmetricCipher::Mode>("mode");
+    QTest::addColumn<int>("keySize");
+    QTest::newRow("AES-256") << SymmetricCipher::Aes256_CBC << 32;
+    QTest::newRow("Twofish") << SymmetricCipher::Twofish_CBC << 32;
+}
+
+void TestSymmetricCipher::testCbcParallelDecryption()
+{
+    QFETCH(SymmetricCipher::Mode, mode);
+    QFETCH(int, keySize);
+
+    const QByteArray key(keySize, '\x5a');
+    const QByteArray iv = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+
+    QByteArray plainText;
+    for (int i = 0; i < 1000003; ++i) {
+        plainText.append(static_cast<char>(i % 251));
+    }
+
+    SymmetricCipher encrypt;
+    QVERIFY(encrypt.init(mode, SymmetricCipher::Encrypt, key, iv));
+    QByteArray cipherText = plainText;
+    QVERIFY(encrypt.finish(cipherText));
+
+    // Large calls are split across threads, they must chain on like a single thread does
+    SymmetricCipher decrypt;
+    QVERIFY(decrypt.init(mode, SymmetricCipher::Decrypt, key, iv));
+    const int bulkSize = 600000 - 600000 % 16;
+    QByteArray first = cipherText.left(bulkSize);
+    QVERIFY(decrypt.process(first));
+    QByteArray second = cipherText.mid(bulkSize, 320000);
+    QVERIFY(decrypt.process(second));
+    QByteArray rest = cipherText.mid(bulkSize + second.size());
+    QVERIFY(decrypt.finish(rest));
+    QCOMPARE(first + second + rest, plainText);
+
+    // Reinitializing with the same key starts over
+    QVERIFY(decrypt.init(mode, SymmetricCipher::Decrypt, key, iv));
+    QByteArray all = cipherText.left(cipherText.size() - 16);
+    QVERIFY(decrypt.process(all));
+    QByteArray last = cipherText.right(16);
+    QVERIFY(decrypt.finish(last));
+    QCOMPARE(all + last, plainText);
+
+    // Reinitializing with another key rekeys the worker ciphers as well
+    const QByteArray otherKey(keySize, '\x33');
+    QVERIFY(encrypt.init(mode, SymmetricCipher::Encrypt, otherKey, iv));
+    cipherText = plainText;
+    QVERIFY(encrypt.finish(cipherText));
+    QVERIFY(decrypt.init(mode, SymmetricCipher::Decrypt, otherKey, iv));
+    all = cipherText.left(cipherText.size() - 16);
+    QVERIFY(decrypt.process(all));
+    last = cipherText.right(16);
+    QVERIFY(decrypt.finish(last));
+    QCOMPARE(all + last, plainText);
+}
+
+void TestSymmetricCipher::testChaCha20Parallel()
+{
+    const QByteArray key(32, '\x3c');
+    const QByteArray iv = QByteArray::fromHex("000000000000004a00000000");
+
+    QByteArray plainText;
+    for (int i = 0; i < 1500007; ++i) {
+        plainText.append(static_cast<char>(i % 253));
+    }
+
+    // Small calls stay on the calling thread
+    SymmetricCipher reference;
+    QVERIFY(reference.init(SymmetricCipher::ChaCha20, SymmetricCipher::Encrypt, key, iv));
+    QByteArray expected;
+    for (int offset = 0; offset < plainText.size(); offset += 1000) {
+        QByteArray part = plainText.mid(offset, 1000);
+        QVERIFY(reference.process(part));
+        expected.append(part);
+    }
+
+    // Large calls at odd stream positions are split across threads
+    SymmetricCipher encrypt;
+    QVERIFY(encrypt.init(SymmetricCipher::ChaCha20, SymmetricCipher::Encrypt, key, iv));
+    QByteArray first = plainText.left(77);
+    QVERIFY(encrypt.process(first));
+    QByteArray second = plainText.mid(77, 700001);
+    QVERIFY(encrypt.process(second));
+    QByteArray third = plainText.mid(77 + 700001, 30);
+    QVERIFY(encrypt.process(third));
+    QByteArray rest = plainText.mid(77 + 700001 + 30);
+    QVERIFY(encrypt.finish(rest));
+    QCOMPARE(first + second + third + rest, expected);
+
+    SymmetricCipher decrypt;
+    QVERIFY(decrypt.init(SymmetricCipher::ChaCha20, SymmetricCipher::Decrypt, key, iv));
+    QByteArray decrypted = expected;
+    QVERIFY(decrypt.process(decrypted));
+    QCOMPARE(decrypted, plainText);
+
+    // Reinitializing with the same key starts over
+    QVERIFY(decrypt.init(SymmetricCipher::ChaCha20, SymmetricCipher::Decrypt, key, iv));
+    decrypted = expected;
+    QVERIFY(decrypt.finish(decrypted));
+    QCOMPARE(decrypted, plainText);
+
+    // Reinitializing with another key rekeys the worker keystreams as well
+    const QByteArray otherKey(32, '\x17');
+    QVERIFY(reference.init(SymmetricCipher::ChaCha20, SymmetricCipher::Encrypt, otherKey, iv));
+    expected.clear();
+    for (int offset = 0; offset < plainText.size(); offset += 1000) {
+        QByteArray part = plainText.mid(offset, 1000);
+        QVERIFY(reference.process(part));
+        expected.append(part);
+    }
+    QVERIFY(decrypt.init(SymmetricCipher::ChaCha20, SymmetricCipher::Decrypt, otherKey, iv));
+    decrypted = expected;
+    QVERIFY(decrypt.process(decrypted));
+    QCOMPARE(decrypted, plainText);
+}
+
+void TestSymmetricCipher::testReinit()
+{
+    QByteArray key1 = QByteArray::fromHex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+    QByteArray key2 = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+    QByteArray iv = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+    QByteArray plainText("re-initialized ciphers must not carry state over");
+
+    SymmetricCipher cipher;
+    QByteArray first = plainText;
+    QVERIFY(cipher.init(SymmetricCipher::Aes256_CBC, SymmetricCipher::Encrypt, key1, iv));
+    QVERIFY(cipher.finish(first));
+
+    // Same mode and direction, new key
+    QByteArray second = plainText;
+    QVERIFY(cipher.init(SymmetricCipher::Aes256_CBC, SymmetricCipher::Encrypt, key2, iv));
+    QVERIFY(cipher.finish(second));
+
+    SymmetricCipher fresh;
+    QByteArray expected = plainText;
+    QVERIFY(fresh.init(SymmetricCipher::Aes256_CBC, SymmetricCipher::Encrypt, key2, iv));
+    QVERIFY(fresh.finish(expected));
+    QCOMPARE(second, expected);
+    QVERIFY(first != second);
+
+    // Switching direction still works on the same object
+    QVERIFY(cipher.init(SymmetricCipher::Aes256_CBC, SymmetricCipher::Decrypt, key1, iv));
+    QVERIFY(cipher.finish(first));
+    QCOMPARE(first, plainText);
+}
@@ -39,6 +39,11 @@ private slots:
     void testChaCha20();
     void testPadding();
     void testStreamReset();
+    void testStreamLargeData();
+    void testCbcParallelDecryption_data();
+    void testCbcParallelDecryption();
+    void testChaCha20Parallel();
+    void testReinit();
 };
 
 #endif // KEEPASSX_TESTSYMMETRICCIPHER_H
@@ -0,0 +1,86 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestThreadedReadStream.h"
+
+#include <QBuffer>
+#include <QTest>
+
+#include "FailDevice.h"
+#include "streams/ThreadedReadStream.h"
+
+QTEST_GUILESS_MAIN(TestThreadedReadStream)
+
+void TestThreadedReadStream::testRead()
+{
+    QByteArray data;
+    for (int i = 0; i < 100000; ++i) {
+        data.append(static_cast<char>(i % 251));
+    }
+
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    ThreadedReadStream reader(&buffer, 1000, 2);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+
+    // read sizes that do not line up with the chunk size
+    QByteArray result;
+    int readSize = 1;
+    while (result.size() < data.size()) {
+        QByteArray part = reader.read(readSize);
+        QVERIFY(!part.isEmpty());
+        result.append(part);
+        readSize = (readSize * 7) % 3001 + 1;
+    }
+
+    QCOMPARE(result, data);
+    QCOMPARE(reader.read(1).size(), 0);
+    QVERIFY(reader.atEnd());
+}
+
+void TestThreadedReadStream::testReadFailure()
+{
+    FailDevice failDevice(1000);
+    failDevice.setData(QByteArray(2000, 'Z'));
+    QVERIFY(failDevice.open(QIODevice::ReadOnly));
+
+    ThreadedReadStream reader(&failDevice, 300);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+
+    // everything read before the failure is still delivered
+    QCOMPARE(reader.read(2000), QByteArray(1200, 'Z'));
+
+    char c;
+    QCOMPARE(reader.read(&c, 1), qint64(-1));
+    QCOMPARE(reader.errorString(), QString("FAILDEVICE"));
+}
+
+void TestThreadedReadStream::testCloseWhileQueueFull()
+{
+    QByteArray data(100000, 'Z');
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    ThreadedReadStream reader(&buffer, 100, 1);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QCOMPARE(reader.read(50), QByteArray(50, 'Z'));
+
+    // must not block on the stalled worker thread
+    reader.close();
+    QVERIFY(!reader.isOpen());
+}
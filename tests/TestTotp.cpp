@@ -21,6 +21,7 @@
 #include "core/Entry.h"
 #include "core/Totp.h"
 #include "crypto/Crypto.h"
+#include "mock/MockClock.h"
 
 #include <QTest>
 
@@ -177,3 +178,30 @@ void TestTotp::testEntryHistory()
     QVERIFY(!entry.hasTotp());
     QCOMPARE(entry.historyItems().size(), 3);
 }
+
+void TestTotp::testEntryTotpCache()
+{
+    auto* clock = new MockClock(2020, 1, 1, 0, 0, 0);
+    MockClock::setup(clock);
+
+    Entry entry;
+    entry.setTotp(Totp::createSettings("GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ", 6, 30));
+    const quint64 time = Clock::currentSecondsSinceEpoch();
+    QCOMPARE(entry.totp(), Totp::generateTotp(entry.totpSettings(), time));
+
+    // The code changes with the time step
+    clock->advanceSecond(29);
+    QCOMPARE(entry.totp(), Totp::generateTotp(entry.totpSettings(), time));
+    clock->advanceSecond(1);
+    QCOMPARE(entry.totp(), Totp::generateTotp(entry.totpSettings(), time + 30));
+
+    // and with the settings within the same time step
+    entry.setTotp(Totp::createSettings("JBSWY3DPEHPK3PXP", 8, 30));
+    QCOMPARE(entry.totp().size(), 8);
+    QCOMPARE(entry.totp(), Totp::generateTotp(entry.totpSettings(), time + 30));
+
+    entry.setTotp(nullptr);
+    QCOMPARE(entry.totp(), QString());
+
+    MockClock::teardown();
+}
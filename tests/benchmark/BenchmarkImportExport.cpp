@@ -0,0 +1,423 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkImportExport.h"
+#include "BenchmarkUtil.h"
+
+#include "core/Database.h"
+#include "core/Group.h"
+#include "crypto/Crypto.h"
+#include "crypto/Random.h"
+#include "format/BitwardenReader.h"
+#include "format/CsvExporter.h"
+#include "format/CsvParser.h"
+#include "format/OPUXReader.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTest>
+#include <minizip/zip.h>
+
+// Compatibility with minizip-ng
+#ifdef MZ_VERSION_BUILD
+#define zipOpenNewFileInZip64 zipOpenNewFileInZip_64
+#endif
+
+QTEST_GUILESS_MAIN(BenchmarkImportExport)
+
+namespace
+{
+    const int ItemsPerGroup = 100;
+    // Every tenth item carries an attachment, where the format has them
+    const int AttachmentInterval = 10;
+    const int AttachmentSize = 1024;
+    const int WriteChunkSize = 1024 * 1024;
+
+    void report(const QString& name, qint64 bytes, qint64 msecs)
+    {
+        const double mib = bytes / (1024.0 * 1024.0);
+        const double throughput = msecs > 0 ? mib * 1000.0 / msecs : 0.0;
+        qInfo("%s: %.1f MiB in %lld ms (%.1f MiB/s), peak RSS %lld MiB",
+              qPrintable(name),
+              mib,
+              msecs,
+              throughput,
+              BenchmarkUtil::peakRss() / (1024 * 1024));
+    }
+
+    QByteArray attachmentData()
+    {
+        static const QByteArray data = randomGen()->randomArray(AttachmentSize);
+        return data;
+    }
+
+    /**
+     * Write the output in large chunks, generated inputs can be hundreds of megabytes.
+     */
+    class ChunkedWriter
+    {
+    public:
+        explicit ChunkedWriter(QIODevice* device)
+            : m_device(device)
+        {
+            m_buffer.reserve(WriteChunkSize);
+        }
+
+        ~ChunkedWriter()
+        {
+            flush();
+        }
+
+        ChunkedWriter& operator<<(const QByteArray& data)
+        {
+            m_buffer.append(data);
+            if (m_buffer.size() >= WriteChunkSize) {
+                flush();
+            }
+            return *this;
+        }
+
+        void flush()
+        {
+            m_device->write(m_buffer);
+            m_buffer.clear();
+        }
+
+    private:
+        QIODevice* m_device;
+        QByteArray m_buffer;
+    };
+
+    bool writeCsv(const QString& path, int itemCount)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+
+        ChunkedWriter out(&file);
+        out << "\"Group\",\"Title\",\"Username\",\"Password\",\"URL\",\"Notes\"\n";
+        for (int i = 0; i < itemCount; ++i) {
+            out << QString("\"Root/Group %1\",\"Entry %2\",\"user%2\",\"password%2\",\"https://example%2.com/login\","
+                           "\"Notes of entry %2\nsecond line\"\n")
+                       .arg(i / ItemsPerGroup)
+                       .arg(i)
+                       .toUtf8();
+        }
+        return true;
+    }
+
+    bool writeBitwarden(const QString& path, int itemCount)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+
+        const int folderCount = itemCount / ItemsPerGroup + 1;
+        ChunkedWriter out(&file);
+        out << "{\"encrypted\": false, \"folders\": [";
+        for (int i = 0; i < folderCount; ++i) {
+            out << QString("%1{\"id\": \"folder-%2\", \"name\": \"Folder %2\"}").arg(i > 0 ? "," : "").arg(i).toUtf8();
+        }
+        out << "], \"items\": [";
+        for (int i = 0; i < itemCount; ++i) {
+            out << QString("%1{\"id\": \"item-%2\", \"organizationId\": null, \"folderId\": \"folder-%3\", "
+                           "\"type\": 1, \"name\": \"Entry %2\", \"notes\": \"Notes of entry %2\", "
+                           "\"favorite\": false, \"fields\": [{\"name\": \"PIN\", \"value\": \"%2\", \"type\": 1}], "
+                           "\"login\": {\"uris\": [{\"match\": null, \"uri\": \"https://example%2.com/login\"}], "
+                           "\"username\": \"user%2\", \"password\": \"password%2\", \"totp\": null}, "
+                           "\"collectionIds\": null}")
+                       .arg(i > 0 ? "," : "")
+                       .arg(i)
+                       .arg(i / ItemsPerGroup)
+                       .toUtf8();
+        }
+        out << "]}";
+        return true;
+    }
+
+    bool writeZipFile(zipFile zf, const QString& fileName, const QByteArray& data)
+    {
+        if (zipOpenNewFileInZip64(
+                zf, fileName.toLatin1().data(), nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, 1, 1)
+            != ZIP_OK) {
+            return false;
+        }
+        const bool ok = zipWriteInFileInZip(zf, data.constData(), data.size()) == ZIP_OK;
+        return zipCloseFileInZip(zf) == ZIP_OK && ok;
+    }
+
+    bool writeOPUX(const QString& path, int itemCount)
+    {
+        auto zf = zipOpen64(path.toLocal8Bit().constData(), 0);
+        if (!zf) {
+            return false;
+        }
+
+        bool ok = writeZipFile(zf,
+                               "export.attributes",
+                               "{\"version\": 3, \"description\": \"1Password Unencrypted Export\", "
+                               "\"timestamp\": 1670261487}");
+
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        {
+            ChunkedWriter out(&buffer);
+            out << "{\"accounts\": [{\"attrs\": {\"accountName\": \"Benchmark\", \"name\": \"Benchmark\"}, "
+                   "\"vaults\": [{\"attrs\": {\"uuid\": \"vault\", \"name\": \"Personal\", \"type\": \"P\"}, "
+                   "\"items\": [";
+            for (int i = 0; i < itemCount && ok; ++i) {
+                const auto separator = i > 0 ? "," : "";
+                if (i % AttachmentInterval == 0) {
+                    const auto documentId = QString("document%1").arg(i);
+                    const auto fileName = QString("file%1.bin").arg(i);
+                    out << QString("%1{\"uuid\": \"item%2\", \"createdAt\": 1663642010, \"updatedAt\": 1668287305, "
+                                   "\"state\": \"active\", \"categoryUuid\": \"006\", \"details\": "
+                                   "{\"loginFields\": [], \"notesPlain\": \"\", \"sections\": [], "
+                                   "\"passwordHistory\": [], \"documentAttributes\": {\"fileName\": \"%3\", "
+                                   "\"documentId\": \"%4\", \"decryptedSize\": %5}}, "
+                                   "\"overview\": {\"title\": \"Document %2\", \"url\": \"\"}}")
+                               .arg(separator)
+                               .arg(i)
+                               .arg(fileName, documentId)
+                               .arg(AttachmentSize)
+                               .toUtf8();
+                    ok = writeZipFile(zf, QString("files/%1__%2").arg(documentId, fileName), attachmentData());
+                } else {
+                    out << QString("%1{\"uuid\": \"item%2\", \"createdAt\": 1663642010, \"updatedAt\": 1668287305, "
+                                   "\"state\": \"active\", \"categoryUuid\": \"001\", \"details\": {\"loginFields\": ["
+                                   "{\"value\": \"password%2\", \"name\": \"password\", \"fieldType\": \"P\", "
+                                   "\"designation\": \"password\"}, {\"value\": \"user%2\", \"name\": \"username\", "
+                                   "\"fieldType\": \"T\", \"designation\": \"username\"}], "
+                                   "\"notesPlain\": \"Notes of entry %2\", \"sections\": [], \"passwordHistory\": []}, "
+                                   "\"overview\": {\"title\": \"Entry %2\", \"url\": \"https://example%2.com/login\", "
+                                   "\"tags\": [\"benchmark\"]}}")
+                               .arg(separator)
+                               .arg(i)
+                               .toUtf8();
+                }
+            }
+            out << "]}]}]}";
+        }
+
+        ok = ok && writeZipFile(zf, "export.data", data);
+        return zipClose(zf, nullptr) == ZIP_OK && ok;
+    }
+
+    /**
+     * Exported databases carry attachments at the same rate as the generated imports.
+     */
+    BenchmarkUtil::DatabaseOptions databaseOptions()
+    {
+        BenchmarkUtil::DatabaseOptions options;
+        options.entriesPerGroup = ItemsPerGroup;
+        options.attachmentInterval = AttachmentInterval;
+        options.attachmentSize = AttachmentSize;
+        return options;
+    }
+} // namespace
+
+void BenchmarkImportExport::initTestCase()
+{
+    BENCHMARK_SKIP_UNLESS_ENABLED();
+
+    QVERIFY(Crypto::init());
+    QVERIFY(m_dir.isValid());
+}
+
+void BenchmarkImportExport::addItemCounts()
+{
+    QTest::addColumn<int>("itemCount");
+
+    for (int itemCount : {10000, 100000, 500000}) {
+        QTest::newRow(qPrintable(QString("%1 items").arg(itemCount))) << itemCount;
+    }
+}
+
+QString BenchmarkImportExport::filePath(const QString& name) const
+{
+    return m_dir.filePath(name);
+}
+
+void BenchmarkImportExport::benchmarkCsvParser_data()
+{
+    addItemCounts();
+}
+
+void BenchmarkImportExport::benchmarkCsvParser()
+{
+    QFETCH(int, itemCount);
+
+    const auto path = filePath(QString("import-%1.csv").arg(itemCount));
+    QVERIFY(writeCsv(path, itemCount));
+
+    // Parse a preview first and then stream all rows, like the CSV import does
+    int rows = 0;
+    QElapsedTimer timer;
+    BenchmarkUtil::resetPeakRss();
+    timer.start();
+    QBENCHMARK_ONCE
+    {
+        CsvParser parser;
+        parser.setMaxTableRows(100);
+        parser.setStopWhenTableFull(true);
+        QFile file(path);
+        QVERIFY(parser.parse(&file));
+        QVERIFY(parser.forEachRow([&rows](const CsvRow&) {
+            ++rows;
+            return true;
+        }));
+    }
+    report("CSV parser", QFileInfo(path).size(), timer.elapsed());
+    QCOMPARE(rows, itemCount + 1);
+}
+
+void BenchmarkImportExport::benchmarkBitwardenReader_data()
+{
+    addItemCounts();
+}
+
+void BenchmarkImportExport::benchmarkBitwardenReader()
+{
+    QFETCH(int, itemCount);
+
+    const auto path = filePath(QString("import-%1.json").arg(itemCount));
+    QVERIFY(writeBitwarden(path, itemCount));
+
+    QSharedPointer<Database> db;
+    QElapsedTimer timer;
+    BenchmarkUtil::resetPeakRss();
+    timer.start();
+    QBENCHMARK_ONCE
+    {
+        BitwardenReader reader;
+        db = reader.convert(path);
+        QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    }
+    report("Bitwarden reader", QFileInfo(path).size(), timer.elapsed());
+    QVERIFY(db);
+    QCOMPARE(db->rootGroup()->entriesRecursive().size(), itemCount);
+}
+
+void BenchmarkImportExport::benchmarkOPUXReader_data()
+{
+    addItemCounts();
+}
+
+void BenchmarkImportExport::benchmarkOPUXReader()
+{
+    QFETCH(int, itemCount);
+
+    const auto path = filePath(QString("import-%1.1pux").arg(itemCount));
+    QVERIFY(writeOPUX(path, itemCount));
+
+    QSharedPointer<Database> db;
+    QElapsedTimer timer;
+    BenchmarkUtil::resetPeakRss();
+    timer.start();
+    QBENCHMARK_ONCE
+    {
+        OPUXReader reader;
+        db = reader.convert(path);
+        QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    }
+    report("1PUX reader", QFileInfo(path).size(), timer.elapsed());
+    QVERIFY(db);
+    QCOMPARE(db->rootGroup()->entriesRecursive().size(), itemCount);
+}
+
+void BenchmarkImportExport::benchmarkXmlImport_data()
+{
+    addItemCounts();
+}
+
+void BenchmarkImportExport::benchmarkXmlImport()
+{
+    QFETCH(int, itemCount);
+
+    const auto path = filePath(QString("import-%1.xml").arg(itemCount));
+    {
+        auto source = BenchmarkUtil::generateDatabase(itemCount, databaseOptions());
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(source->extract(&file));
+    }
+
+    QScopedPointer<Database> db(new Database());
+    QElapsedTimer timer;
+    BenchmarkUtil::resetPeakRss();
+    timer.start();
+    QBENCHMARK_ONCE
+    {
+        QString error;
+        QVERIFY2(db->import(path, &error), qPrintable(error));
+    }
+    report("KeePass XML import", QFileInfo(path).size(), timer.elapsed());
+    QCOMPARE(db->rootGroup()->entriesRecursive().size(), itemCount);
+}
+
+void BenchmarkImportExport::benchmarkCsvExporter_data()
+{
+    addItemCounts();
+}
+
+void BenchmarkImportExport::benchmarkCsvExporter()
+{
+    QFETCH(int, itemCount);
+
+    const auto db = BenchmarkUtil::generateDatabase(itemCount, databaseOptions());
+    const auto path = filePath(QString("export-%1.csv").arg(itemCount));
+
+    QElapsedTimer timer;
+    BenchmarkUtil::resetPeakRss();
+    timer.start();
+    QBENCHMARK_ONCE
+    {
+        CsvExporter exporter;
+        QVERIFY2(exporter.exportDatabase(path, db), qPrintable(exporter.errorString()));
+    }
+    report("CSV exporter", QFileInfo(path).size(), timer.elapsed());
+}
+
+void BenchmarkImportExport::benchmarkXmlExporter_data()
+{
+    addItemCounts();
+}
+
+void BenchmarkImportExport::benchmarkXmlExporter()
+{
+    QFETCH(int, itemCount);
+
+    const auto db = BenchmarkUtil::generateDatabase(itemCount, databaseOptions());
+    const auto path = filePath(QString("export-%1.xml").arg(itemCount));
+
+    QElapsedTimer timer;
+    BenchmarkUtil::resetPeakRss();
+    timer.start();
+    QBENCHMARK_ONCE
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QString error;
+        QVERIFY2(db->extract(&file, &error), qPrintable(error));
+    }
+    report("KeePass XML exporter", QFileInfo(path).size(), timer.elapsed());
+}
@@ -0,0 +1,202 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkKdbx.h"
+#include "BenchmarkUtil.h"
+
+#include "core/Database.h"
+#include "core/Group.h"
+#include "crypto/Crypto.h"
+#include "crypto/kdf/AesKdf.h"
+#include "format/KeePass2.h"
+#include "keys/PasswordKey.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkKdbx)
+
+namespace
+{
+    const int EntriesPerGroup = 100;
+    // Every tenth entry carries an attachment
+    const int AttachmentInterval = 10;
+    const int DefaultHistoryDepth = 3;
+    const int DefaultAttachmentSize = 1024;
+
+    void report(const QString& name, qint64 bytes, qint64 msecs, const StageTimings& timings)
+    {
+        const double mib = bytes / (1024.0 * 1024.0);
+        const double throughput = msecs > 0 ? mib * 1000.0 / msecs : 0.0;
+        qInfo("%s: %.1f MiB in %lld ms (%.1f MiB/s), peak RSS %lld MiB",
+              qPrintable(name),
+              mib,
+              msecs,
+              throughput,
+              BenchmarkUtil::peakRss() / (1024 * 1024));
+        qInfo("  %s", qPrintable(timings.toString()));
+    }
+
+    QSharedPointer<CompositeKey> databaseKey()
+    {
+        auto key = QSharedPointer<CompositeKey>::create();
+        key->addKey(QSharedPointer<PasswordKey>::create("benchmark"));
+        return key;
+    }
+
+    /**
+     * Generated database with the given format settings. The format version
+     * follows from the KDF, which runs a single round so the key derivation
+     * does not distort the numbers.
+     */
+    QSharedPointer<Database> generateKdbxDatabase(quint32 version,
+                                                  const QUuid& cipher,
+                                                  bool compress,
+                                                  int entryCount,
+                                                  int historyDepth,
+                                                  int attachmentSize)
+    {
+        BenchmarkUtil::DatabaseOptions options;
+        options.entriesPerGroup = EntriesPerGroup;
+        options.historyDepth = historyDepth;
+        options.attachmentInterval = attachmentSize > 0 ? AttachmentInterval : 0;
+        options.attachmentSize = attachmentSize;
+        auto db = BenchmarkUtil::generateDatabase(entryCount, options);
+
+        auto kdf = QSharedPointer<AesKdf>::create(version < KeePass2::FILE_VERSION_4);
+        kdf->setRounds(1);
+        db->changeKdf(kdf);
+        db->setCipher(cipher);
+        db->setCompressionAlgorithm(compress ? Database::CompressionGZip : Database::CompressionNone);
+        db->setKey(databaseKey());
+        return db;
+    }
+} // namespace
+
+void BenchmarkKdbx::initTestCase()
+{
+    BENCHMARK_SKIP_UNLESS_ENABLED();
+
+    QVERIFY(Crypto::init());
+    QVERIFY(m_dir.isValid());
+}
+
+/**
+ * Both formats at every size with the default settings, and each setting
+ * changed on its own for ten thousand entries in KDBX 4.
+ */
+void BenchmarkKdbx::addDatabaseRows()
+{
+    QTest::addColumn<quint32>("version");
+    QTest::addColumn<QUuid>("cipher");
+    QTest::addColumn<bool>("compress");
+    QTest::addColumn<int>("entryCount");
+    QTest::addColumn<int>("historyDepth");
+    QTest::addColumn<int>("attachmentSize");
+
+    const QUuid aes = KeePass2::CIPHER_AES256;
+    for (quint32 version : {KeePass2::FILE_VERSION_3_1, KeePass2::FILE_VERSION_4}) {
+        const QString format = version == KeePass2::FILE_VERSION_4 ? "KDBX 4" : "KDBX 3.1";
+        for (int entryCount : {1000, 10000, 50000, 200000}) {
+            QTest::newRow(qPrintable(QString("%1, %2 entries").arg(format).arg(entryCount)))
+                << version << aes << true << entryCount << DefaultHistoryDepth << DefaultAttachmentSize;
+        }
+    }
+
+    const quint32 version = KeePass2::FILE_VERSION_4;
+    const int entryCount = 10000;
+    QTest::newRow("KDBX 4, ChaCha20") << version << KeePass2::CIPHER_CHACHA20 << true << entryCount
+                                      << DefaultHistoryDepth << DefaultAttachmentSize;
+    QTest::newRow("KDBX 4, Twofish") << version << KeePass2::CIPHER_TWOFISH << true << entryCount
+                                     << DefaultHistoryDepth << DefaultAttachmentSize;
+    QTest::newRow("KDBX 4, uncompressed")
+        << version << aes << false << entryCount << DefaultHistoryDepth << DefaultAttachmentSize;
+    QTest::newRow("KDBX 4, no history") << version << aes << true << entryCount << 0 << DefaultAttachmentSize;
+    QTest::newRow("KDBX 4, 10 history items") << version << aes << true << entryCount << 10 << DefaultAttachmentSize;
+    QTest::newRow("KDBX 4, no attachments") << version << aes << true << entryCount << DefaultHistoryDepth << 0;
+    QTest::newRow("KDBX 4, 64 KiB attachments")
+        << version << aes << true << entryCount << DefaultHistoryDepth << 64 * 1024;
+}
+
+QString BenchmarkKdbx::filePath(const QString& name) const
+{
+    return m_dir.filePath(name);
+}
+
+void BenchmarkKdbx::benchmarkSave_data()
+{
+    addDatabaseRows();
+}
+
+void BenchmarkKdbx::benchmarkSave()
+{
+    QFETCH(quint32, version);
+    QFETCH(QUuid, cipher);
+    QFETCH(bool, compress);
+    QFETCH(int, entryCount);
+    QFETCH(int, historyDepth);
+    QFETCH(int, attachmentSize);
+
+    auto db = generateKdbxDatabase(version, cipher, compress, entryCount, historyDepth, attachmentSize);
+    const auto path = filePath("save.kdbx");
+
+    QElapsedTimer timer;
+    BenchmarkUtil::resetPeakRss();
+    timer.start();
+    QBENCHMARK_ONCE
+    {
+        QString error;
+        QVERIFY2(db->saveAs(path, Database::Atomic, {}, &error), qPrintable(error));
+    }
+    report(QTest::currentDataTag(), QFileInfo(path).size(), timer.elapsed(), db->saveTimings());
+}
+
+void BenchmarkKdbx::benchmarkOpen_data()
+{
+    addDatabaseRows();
+}
+
+void BenchmarkKdbx::benchmarkOpen()
+{
+    QFETCH(quint32, version);
+    QFETCH(QUuid, cipher);
+    QFETCH(bool, compress);
+    QFETCH(int, entryCount);
+    QFETCH(int, historyDepth);
+    QFETCH(int, attachmentSize);
+
+    const auto path = filePath("open.kdbx");
+    {
+        auto source = generateKdbxDatabase(version, cipher, compress, entryCount, historyDepth, attachmentSize);
+        QString error;
+        QVERIFY2(source->saveAs(path, Database::Atomic, {}, &error), qPrintable(error));
+    }
+
+    auto db = QSharedPointer<Database>::create();
+    QElapsedTimer timer;
+    BenchmarkUtil::resetPeakRss();
+    timer.start();
+    QBENCHMARK_ONCE
+    {
+        QString error;
+        QVERIFY2(db->open(path, databaseKey(), &error), qPrintable(error));
+    }
+    report(QTest::currentDataTag(), QFileInfo(path).size(), timer.elapsed(), db->loadTimings());
+    QCOMPARE(db->formatVersion(), version);
+    QCOMPARE(db->rootGroup()->entriesRecursive().size(), entryCount);
+}
@@ -0,0 +1,165 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkKeePass1Reader.h"
+#include "BenchmarkUtil.h"
+
+#include "core/Endian.h"
+#include "core/Group.h"
+#include "crypto/Crypto.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
+#include "crypto/SymmetricCipher.h"
+#include "crypto/kdf/AesKdf.h"
+#include "format/KeePass1.h"
+#include "format/KeePass1Reader.h"
+
+#include <QBuffer>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkKeePass1Reader)
+
+namespace
+{
+    const QString Password = QStringLiteral("masterpw");
+
+    template <typename SizedQInt> QByteArray toBytes(SizedQInt num)
+    {
+        return Endian::sizedIntToBytes<SizedQInt>(num, KeePass1::BYTEORDER);
+    }
+
+    QByteArray toCString(const QString& str)
+    {
+        return str.toUtf8().append('\0');
+    }
+
+    void appendField(QByteArray& content, quint16 type, const QByteArray& data)
+    {
+        content.append(toBytes<quint16>(type));
+        content.append(toBytes<quint32>(static_cast<quint32>(data.size())));
+        content.append(data);
+    }
+
+    /**
+     * Encrypted KeePass 1 file shaped like the basic.kdb fixture. It is laid
+     * out like BenchmarkUtil::generateDatabase(), which only builds KDBX
+     * databases in memory.
+     */
+    QByteArray generateKdbFile(int entryCount)
+    {
+        const int groupCount = entryCount / 100 + 1;
+
+        QByteArray content;
+        for (int i = 0; i < groupCount; ++i) {
+            appendField(content, 0x0001, toBytes<quint32>(i + 1));
+            appendField(content, 0x0002, toCString(QString("Group %1").arg(i)));
+            appendField(content, 0x0007, toBytes<quint32>(1));
+            appendField(content, 0x0008, toBytes<quint16>(0));
+            appendField(content, 0xFFFF, {});
+        }
+        for (int i = 0; i < entryCount; ++i) {
+            appendField(content, 0x0001, QUuid::createUuid().toRfc4122());
+            appendField(content, 0x0002, toBytes<quint32>(i / 100 + 1));
+            appendField(content, 0x0003, toBytes<quint32>(0));
+            appendField(content, 0x0004, toCString(QString("Entry %1").arg(i)));
+            appendField(content, 0x0005, toCString(QString("https://example%1.com/login").arg(i)));
+            appendField(content, 0x0006, toCString(QString("user%1").arg(i)));
+            appendField(content, 0x0007, toCString(QString("password%1").arg(i)));
+            appendField(content,
+                        0x0008,
+                        toCString(QString("Notes of entry %1\nAuto-Type: {USERNAME}{TAB}{PASSWORD}").arg(i)));
+            appendField(content, 0x000D, toCString({}));
+            appendField(content, 0x000E, {});
+            appendField(content, 0xFFFF, {});
+        }
+
+        const QByteArray masterSeed = randomGen()->randomArray(16);
+        const QByteArray iv = randomGen()->randomArray(16);
+        const QByteArray transformSeed = randomGen()->randomArray(32);
+        const quint32 rounds = 1000;
+
+        AesKdf kdf(true);
+        kdf.setRounds(rounds);
+        kdf.setSeed(transformSeed);
+        QByteArray transformedKey;
+        if (!kdf.transform(CryptoHash::hash(Password.toLatin1(), CryptoHash::Sha256), transformedKey)) {
+            return {};
+        }
+
+        CryptoHash finalKey(CryptoHash::Sha256);
+        finalKey.addData(masterSeed);
+        finalKey.addData(transformedKey);
+
+        QByteArray encrypted = content;
+        SymmetricCipher cipher;
+        if (!cipher.init(SymmetricCipher::Aes256_CBC, SymmetricCipher::Encrypt, finalKey.result(), iv)
+            || !cipher.finish(encrypted)) {
+            return {};
+        }
+
+        QByteArray data;
+        data.append(toBytes<quint32>(KeePass1::SIGNATURE_1));
+        data.append(toBytes<quint32>(KeePass1::SIGNATURE_2));
+        data.append(toBytes<quint32>(KeePass1::Rijndael));
+        data.append(toBytes<quint32>(KeePass1::FILE_VERSION));
+        data.append(masterSeed);
+        data.append(iv);
+        data.append(toBytes<quint32>(static_cast<quint32>(groupCount)));
+        data.append(toBytes<quint32>(static_cast<quint32>(entryCount)));
+        data.append(CryptoHash::hash(content, CryptoHash::Sha256));
+        data.append(transformSeed);
+        data.append(toBytes<quint32>(rounds));
+        data.append(encrypted);
+        return data;
+    }
+} // namespace
+
+void BenchmarkKeePass1Reader::initTestCase()
+{
+    BENCHMARK_SKIP_UNLESS_ENABLED();
+
+    QVERIFY(Crypto::init());
+}
+
+void BenchmarkKeePass1Reader::benchmarkRead_data()
+{
+    QTest::addColumn<int>("entryCount");
+
+    for (int entryCount : {1000, 10000, 50000}) {
+        QTest::newRow(qPrintable(QString("%1 entries").arg(entryCount))) << entryCount;
+    }
+}
+
+void BenchmarkKeePass1Reader::benchmarkRead()
+{
+    QFETCH(int, entryCount);
+
+    QByteArray data = generateKdbFile(entryCount);
+    QVERIFY(!data.isEmpty());
+
+    QSharedPointer<Database> db;
+    QBENCHMARK_ONCE
+    {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        KeePass1Reader reader;
+        db = reader.readDatabase(&buffer, Password, QString());
+        QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    }
+    QVERIFY(db);
+    QCOMPARE(db->rootGroup()->entriesRecursive().size(), entryCount);
+}
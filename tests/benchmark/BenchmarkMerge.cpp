@@ -0,0 +1,101 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkMerge.h"
+#include "BenchmarkUtil.h"
+
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/Merger.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkMerge)
+
+namespace
+{
+    QSharedPointer<Database> copyDatabase(const QSharedPointer<Database>& db)
+    {
+        auto copy = QSharedPointer<Database>::create();
+        const auto newRoot = db->rootGroup()->clone(Entry::CloneIncludeHistory, Group::CloneIncludeEntries);
+        delete copy->setRootGroup(newRoot);
+        copy->setDeletedObjects(db->deletedObjects());
+        return copy;
+    }
+
+    void touch(Entry* entry, int seconds)
+    {
+        auto timeInfo = entry->timeInfo();
+        timeInfo.setLastModificationTime(timeInfo.lastModificationTime().addSecs(seconds));
+        entry->setUpdateTimeinfo(false);
+        entry->setTimeInfo(timeInfo);
+        entry->setUpdateTimeinfo(true);
+    }
+} // namespace
+
+void BenchmarkMerge::initTestCase()
+{
+    BENCHMARK_SKIP_UNLESS_ENABLED();
+}
+
+void BenchmarkMerge::benchmarkMerge_data()
+{
+    QTest::addColumn<int>("entryCount");
+    QTest::addColumn<bool>("synchronize");
+
+    for (int entryCount : {1000, 10000, 40000}) {
+        QTest::newRow(qPrintable(QString("%1 entries").arg(entryCount))) << entryCount << false;
+        QTest::newRow(qPrintable(QString("%1 entries, synchronize").arg(entryCount))) << entryCount << true;
+    }
+}
+
+/**
+ * Merge of a modified copy as done when reloading a database changed on disk:
+ * a tenth of the entries were modified in either database, and a hundredth
+ * were deleted from the source.
+ */
+void BenchmarkMerge::benchmarkMerge()
+{
+    QFETCH(int, entryCount);
+    QFETCH(bool, synchronize);
+
+    auto source = BenchmarkUtil::generateDatabase(entryCount);
+    auto target = copyDatabase(source);
+
+    const auto sourceEntries = source->rootGroup()->entriesRecursive();
+    for (int i = 0; i < sourceEntries.size(); i += 10) {
+        touch(sourceEntries[i], 60);
+        touch(target->rootGroup()->findEntryByUuid(sourceEntries[i + 5]->uuid()), 60);
+    }
+    for (int i = 0; i < sourceEntries.size(); i += 100) {
+        delete sourceEntries[i + 1];
+    }
+
+    QStringList changes;
+    QBENCHMARK_ONCE
+    {
+        Merger merger(source.data(), target.data());
+        if (synchronize) {
+            merger.setForcedMergeMode(Group::Synchronize);
+        }
+        changes = merger.merge();
+    }
+    QVERIFY(!changes.isEmpty());
+    if (synchronize) {
+        QCOMPARE(target->rootGroup()->entriesRecursive().size(), entryCount - entryCount / 100);
+    }
+}
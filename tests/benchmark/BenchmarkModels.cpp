@@ -0,0 +1,384 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkModels.h"
+#include "BenchmarkUtil.h"
+
+#include "core/Config.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Global.h"
+#include "core/Group.h"
+#include "crypto/Crypto.h"
+#include "gui/SortFilterHideProxyModel.h"
+#include "gui/entry/EntryModel.h"
+#include "gui/group/GroupModel.h"
+#include "gui/tag/TagModel.h"
+
+#include <QCoreApplication>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkModels)
+
+namespace
+{
+    const QStringList Services = {"GitHub", "Amazon", "PayPal", "Google", "Dropbox", "Netflix", "Steam", "Bank"};
+    const QStringList Tags = {"work", "personal", "finance", "social", "shopping", "infra"};
+    // Every tenth entry refers to the previous one and uses placeholders in its URL
+    const int PlaceholderInterval = 10;
+    const int EntriesPerGroup = 100;
+
+    /**
+     * Generated database with all entries in a single group, as shown by the
+     * entry view, and a tree of empty groups with one group for each hundred
+     * entries for the group view.
+     */
+    QSharedPointer<Database> generateModelDatabase(int entryCount)
+    {
+        BenchmarkUtil::DatabaseOptions options;
+        options.entriesPerGroup = qMax(1, entryCount);
+        auto db = BenchmarkUtil::generateDatabase(entryCount, options);
+        Database::BatchUpdate batch(db.data());
+
+        const auto entries = db->rootGroup()->children().first()->entries();
+        for (int i = 0; i < entries.size(); ++i) {
+            auto entry = entries.at(i);
+            entry->setUpdateTimeinfo(false);
+            if (i > 0 && i % PlaceholderInterval == 0) {
+                entry->setUsername(QString("{REF:U@I:%1}").arg(entries.at(i - 1)->uuidToHex()));
+                entry->setUrl(QString("https://{TITLE}.example.com/{USERNAME}"));
+            }
+            if (i % 3 == 0) {
+                entry->addTag(Tags.at(i % Tags.size()));
+            }
+        }
+
+        const int groupCount = entryCount / EntriesPerGroup;
+        Group* parent = db->rootGroup();
+        for (int i = 0; i < groupCount; ++i) {
+            auto group = new Group();
+            group->setUuid(QUuid::createUuid());
+            group->setName(QString("%1 %2").arg(Services.at(i % Services.size())).arg(i));
+            // Ten subgroups below each top-level group
+            if (i % 10 == 0) {
+                group->setParent(db->rootGroup());
+                parent = group;
+            } else {
+                group->setParent(parent);
+            }
+        }
+        return db;
+    }
+
+    Group* entryGroup(const QSharedPointer<Database>& db)
+    {
+        return db->rootGroup()->children().first();
+    }
+
+    /**
+     * Let the model add the rows it populates in batches.
+     */
+    void populate(EntryModel& model, int rowCount)
+    {
+        while (model.rowCount() < rowCount) {
+            QCoreApplication::processEvents();
+        }
+    }
+} // namespace
+
+void BenchmarkModels::initTestCase()
+{
+    BENCHMARK_SKIP_UNLESS_ENABLED();
+
+    QVERIFY(Crypto::init());
+    Config::createTempFileInstance();
+}
+
+void BenchmarkModels::addSizeRows()
+{
+    QTest::addColumn<int>("entryCount");
+    for (int entryCount : {10000, 50000, 100000}) {
+        QTest::newRow(qPrintable(QString("%1 entries").arg(entryCount))) << entryCount;
+    }
+}
+
+QSharedPointer<Database> BenchmarkModels::database(int entryCount)
+{
+    if (!m_databases.contains(entryCount)) {
+        m_databases.insert(entryCount, generateModelDatabase(entryCount));
+    }
+    return m_databases.value(entryCount);
+}
+
+void BenchmarkModels::benchmarkSetGroup_data()
+{
+    addSizeRows();
+}
+
+void BenchmarkModels::benchmarkSetGroup()
+{
+    QFETCH(int, entryCount);
+    auto db = database(entryCount);
+    auto group = entryGroup(db);
+
+    EntryModel model;
+    QBENCHMARK
+    {
+        // The root group has no entries, switching to it only resets the model
+        model.setGroup(group);
+        model.setGroup(db->rootGroup());
+    }
+    model.setGroup(group);
+    QCOMPARE(model.rowCount(), entryCount);
+}
+
+void BenchmarkModels::benchmarkSetEntries_data()
+{
+    addSizeRows();
+}
+
+void BenchmarkModels::benchmarkSetEntries()
+{
+    QFETCH(int, entryCount);
+    const auto entries = entryGroup(database(entryCount))->entries();
+
+    EntryModel model;
+    QBENCHMARK
+    {
+        // Until all rows are shown, not only the first batch
+        model.setEntries(entries);
+        populate(model, entries.size());
+    }
+    QCOMPARE(model.rowCount(), entryCount);
+}
+
+void BenchmarkModels::benchmarkSort_data()
+{
+    QTest::addColumn<int>("entryCount");
+    QTest::addColumn<int>("column");
+
+    const QList<QPair<QString, int>> columns = {{"title", EntryModel::Title},
+                                                {"username", EntryModel::Username},
+                                                {"url", EntryModel::Url},
+                                                {"modified", EntryModel::Modified}};
+    for (int entryCount : {10000, 50000, 100000}) {
+        for (const auto& column : columns) {
+            QTest::newRow(qPrintable(QString("%1 entries, %2").arg(entryCount).arg(column.first)))
+                << entryCount << column.second;
+        }
+    }
+}
+
+void BenchmarkModels::benchmarkSort()
+{
+    QFETCH(int, entryCount);
+    QFETCH(int, column);
+
+    EntryModel model;
+    model.setGroup(entryGroup(database(entryCount)));
+
+    QBENCHMARK
+    {
+        // A new proxy every time, so the collation keys are built again
+        SortFilterHideProxyModel proxy;
+        proxy.setSourceModel(&model);
+        proxy.sort(column, Qt::AscendingOrder);
+        proxy.sort(column, Qt::DescendingOrder);
+    }
+}
+
+void BenchmarkModels::benchmarkData_data()
+{
+    QTest::addColumn<int>("entryCount");
+    QTest::addColumn<bool>("resolvedColumnsOnly");
+
+    for (int entryCount : {10000, 50000, 100000}) {
+        QTest::newRow(qPrintable(QString("%1 entries, all columns").arg(entryCount))) << entryCount << false;
+        QTest::newRow(qPrintable(QString("%1 entries, placeholder columns").arg(entryCount))) << entryCount << true;
+    }
+}
+
+/**
+ * Display data of every row, as needed when the view is scrolled through
+ * or sorted. The title, username, password and url are resolved for
+ * placeholders and references.
+ */
+void BenchmarkModels::benchmarkData()
+{
+    QFETCH(int, entryCount);
+    QFETCH(bool, resolvedColumnsOnly);
+
+    EntryModel model;
+    model.setGroup(entryGroup(database(entryCount)));
+
+    QList<int> columns;
+    if (resolvedColumnsOnly) {
+        columns = {EntryModel::Title, EntryModel::Username, EntryModel::Password, EntryModel::Url};
+    } else {
+        for (int column = 0; column < model.columnCount(); ++column) {
+            columns << column;
+        }
+    }
+
+    int nonEmpty = 0;
+    QBENCHMARK
+    {
+        nonEmpty = 0;
+        for (int row = 0; row < model.rowCount(); ++row) {
+            for (int column : asConst(columns)) {
+                if (!model.data(model.index(row, column), Qt::DisplayRole).toString().isEmpty()) {
+                    ++nonEmpty;
+                }
+            }
+        }
+    }
+    QVERIFY(nonEmpty >= entryCount);
+}
+
+void BenchmarkModels::benchmarkMoveEntries_data()
+{
+    QTest::addColumn<int>("entryCount");
+    QTest::addColumn<bool>("batch");
+
+    for (int entryCount : {10000, 50000, 100000}) {
+        QTest::newRow(qPrintable(QString("%1 entries").arg(entryCount))) << entryCount << false;
+        QTest::newRow(qPrintable(QString("%1 entries, batch update").arg(entryCount))) << entryCount << true;
+    }
+}
+
+/**
+ * Move half of the entries of the shown group to another group, with a
+ * sorted view on the group as the receiver of the model signals.
+ */
+void BenchmarkModels::benchmarkMoveEntries()
+{
+    QFETCH(int, entryCount);
+    QFETCH(bool, batch);
+
+    // The database is changed, so it is not shared with the other benchmarks
+    auto db = generateModelDatabase(entryCount);
+    auto source = entryGroup(db);
+    auto target = new Group();
+    target->setUuid(QUuid::createUuid());
+    target->setParent(db->rootGroup());
+
+    EntryModel model;
+    model.setGroup(source);
+    SortFilterHideProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.sort(EntryModel::Title);
+
+    const auto entries = source->entries().mid(0, entryCount / 2);
+    QBENCHMARK_ONCE
+    {
+        QScopedPointer<Database::BatchUpdate> update(batch ? new Database::BatchUpdate(db.data()) : nullptr);
+        for (auto entry : entries) {
+            entry->setGroup(target);
+        }
+    }
+    QCOMPARE(model.rowCount(), entryCount - entries.size());
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+}
+
+void BenchmarkModels::benchmarkDeleteEntries_data()
+{
+    benchmarkMoveEntries_data();
+}
+
+/**
+ * Delete half of the entries of the shown group, with a sorted view on the
+ * group as the receiver of the model signals.
+ */
+void BenchmarkModels::benchmarkDeleteEntries()
+{
+    QFETCH(int, entryCount);
+    QFETCH(bool, batch);
+
+    auto db = generateModelDatabase(entryCount);
+    auto source = entryGroup(db);
+
+    EntryModel model;
+    model.setGroup(source);
+    SortFilterHideProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.sort(EntryModel::Title);
+
+    const auto entries = source->entries().mid(0, entryCount / 2);
+    QBENCHMARK_ONCE
+    {
+        QScopedPointer<Database::BatchUpdate> update(batch ? new Database::BatchUpdate(db.data()) : nullptr);
+        qDeleteAll(entries);
+    }
+    QCOMPARE(model.rowCount(), entryCount - entries.size());
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+}
+
+void BenchmarkModels::benchmarkGroupModel_data()
+{
+    addSizeRows();
+}
+
+/**
+ * Build the group model and read the name of every group, as the group
+ * view does when all groups are expanded.
+ */
+void BenchmarkModels::benchmarkGroupModel()
+{
+    QFETCH(int, entryCount);
+    auto db = database(entryCount);
+
+    int groupCount = 0;
+    QBENCHMARK
+    {
+        GroupModel model(db.data());
+        groupCount = 0;
+        QList<QModelIndex> pending = {model.index(0, 0)};
+        while (!pending.isEmpty()) {
+            const auto index = pending.takeLast();
+            model.data(index, Qt::DisplayRole);
+            ++groupCount;
+            for (int row = 0; row < model.rowCount(index); ++row) {
+                pending.append(model.index(row, 0, index));
+            }
+        }
+    }
+    // The root group and the group holding the entries come on top
+    QCOMPARE(groupCount, entryCount / EntriesPerGroup + 2);
+}
+
+void BenchmarkModels::benchmarkTagModel_data()
+{
+    addSizeRows();
+}
+
+/**
+ * Collect the tags of all entries and read every row of the tag model.
+ */
+void BenchmarkModels::benchmarkTagModel()
+{
+    QFETCH(int, entryCount);
+    auto db = database(entryCount);
+
+    QBENCHMARK
+    {
+        TagModel model;
+        model.setDatabase(db);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            model.data(model.index(row, 0), Qt::DisplayRole);
+        }
+    }
+}
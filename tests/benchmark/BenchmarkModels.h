@@ -0,0 +1,57 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BENCHMARKMODELS_H
+#define KEEPASSXC_BENCHMARKMODELS_H
+
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+
+class Database;
+
+class BenchmarkModels : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void benchmarkSetGroup_data();
+    void benchmarkSetGroup();
+    void benchmarkSetEntries_data();
+    void benchmarkSetEntries();
+    void benchmarkSort_data();
+    void benchmarkSort();
+    void benchmarkData_data();
+    void benchmarkData();
+    void benchmarkMoveEntries_data();
+    void benchmarkMoveEntries();
+    void benchmarkDeleteEntries_data();
+    void benchmarkDeleteEntries();
+    void benchmarkGroupModel_data();
+    void benchmarkGroupModel();
+    void benchmarkTagModel_data();
+    void benchmarkTagModel();
+
+private:
+    void addSizeRows();
+    QSharedPointer<Database> database(int entryCount);
+
+    QHash<int, QSharedPointer<Database>> m_databases;
+};
+
+#endif // KEEPASSXC_BENCHMARKMODELS_H
@@ -0,0 +1,228 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkSearch.h"
+#include "BenchmarkUtil.h"
+
+#include "core/Database.h"
+#include "core/EntrySearcher.h"
+#include "core/Group.h"
+
+#include <QTest>
+
+#include <random>
+
+QTEST_GUILESS_MAIN(BenchmarkSearch)
+
+namespace
+{
+    const QStringList Services = {
+        "GitHub",  "GitLab",   "Amazon",    "eBay",     "PayPal",     "Google",    "Microsoft", "Apple",
+        "Dropbox", "Netflix",  "Spotify",   "Steam",    "Twitter",    "Facebook",  "LinkedIn",  "Reddit",
+        "Slack",   "Discord",  "Zoom",      "Adobe",    "Nextcloud",  "Proton",    "Fastmail",  "Mozilla",
+        "Bank",    "Insurance", "Utilities", "Router",  "NAS",        "Printer",   "VPN",       "Hosting"};
+    const QStringList Qualifiers = {"", "", "", "Work", "Personal", "Old", "Admin", "Test"};
+    const QStringList FirstNames = {"john", "jane", "alex", "maria", "chen", "fatima", "olga", "pedro"};
+    const QStringList Domains = {"example.com", "mail.example.org", "company.test", "home.lan"};
+    const QStringList Tags = {"work", "personal", "finance", "social", "shopping", "infra"};
+    const QStringList Words = {"login", "recovery", "account", "shared", "family", "backup",
+                               "codes", "security", "question", "pin", "expires", "renew"};
+
+    class Generator
+    {
+    public:
+        explicit Generator(quint32 seed)
+            : m_random(seed)
+        {
+        }
+
+        int number(int max)
+        {
+            return std::uniform_int_distribution<int>(0, max - 1)(m_random);
+        }
+
+        bool chance(int percent)
+        {
+            return number(100) < percent;
+        }
+
+        const QString& pick(const QStringList& list)
+        {
+            return list.at(number(list.size()));
+        }
+
+        QString sentence(int words)
+        {
+            QStringList result;
+            for (int i = 0; i < words; ++i) {
+                result << pick(Words);
+            }
+            return result.join(' ');
+        }
+
+        QString password()
+        {
+            static const QString chars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!#$%&*+-";
+            QString result;
+            for (int i = 0; i < 16; ++i) {
+                result += chars.at(number(chars.size()));
+            }
+            return result;
+        }
+
+    private:
+        std::mt19937 m_random;
+    };
+
+    void fillEntry(Entry* entry, Generator& gen, int index)
+    {
+        const auto& service = gen.pick(Services);
+        const auto& qualifier = gen.pick(Qualifiers);
+        entry->setTitle(qualifier.isEmpty() ? service : QString("%1 %2").arg(service, qualifier));
+        if (gen.chance(60)) {
+            entry->setUsername(QString("%1.%2@%3").arg(gen.pick(FirstNames)).arg(index).arg(gen.pick(Domains)));
+        } else if (gen.chance(80)) {
+            entry->setUsername(QString("%1%2").arg(gen.pick(FirstNames)).arg(index % 100));
+        }
+        entry->setPassword(gen.password());
+        if (gen.chance(70)) {
+            entry->setUrl(QString("https://www.%1.com/%2").arg(service.toLower(), gen.pick(Words)));
+        }
+        if (gen.chance(20)) {
+            entry->setNotes(gen.sentence(5 + gen.number(40)));
+        }
+        if (gen.chance(30)) {
+            entry->addTag(gen.pick(Tags));
+            if (gen.chance(30)) {
+                entry->addTag(gen.pick(Tags));
+            }
+        }
+        if (gen.chance(10)) {
+            entry->attributes()->set("Recovery Codes", gen.sentence(8), true);
+        }
+        if (gen.chance(5)) {
+            entry->attributes()->set("Account Number", QString::number(100000 + index));
+        }
+    }
+
+    /**
+     * Unlike BenchmarkUtil::generateDatabase(), entries get varied, partly
+     * overlapping contents so that terms match realistic subsets. They are
+     * spread over two levels of groups, a fifth of them with a few history
+     * items, and only depend on the number of entries.
+     */
+    QSharedPointer<Database> generateSearchDatabase(int entryCount)
+    {
+        Generator gen(entryCount);
+        auto db = QSharedPointer<Database>::create();
+        Database::BatchUpdate batch(db.data());
+
+        QList<Group*> groups = {db->rootGroup()};
+        const int topGroups = qMax(1, entryCount / 1000);
+        for (int i = 0; i < topGroups; ++i) {
+            auto group = new Group();
+            group->setUuid(QUuid::createUuid());
+            group->setName(QString("%1 %2").arg(Tags.at(i % Tags.size())).arg(i));
+            group->setParent(db->rootGroup());
+            groups << group;
+            for (int j = 0; j < 5; ++j) {
+                auto subgroup = new Group();
+                subgroup->setUuid(QUuid::createUuid());
+                subgroup->setName(Services.at((i * 5 + j) % Services.size()));
+                subgroup->setParent(group);
+                groups << subgroup;
+            }
+        }
+
+        for (int i = 0; i < entryCount; ++i) {
+            auto entry = new Entry();
+            entry->setUuid(QUuid::createUuid());
+            entry->setUpdateTimeinfo(false);
+            fillEntry(entry, gen, i);
+            if (gen.chance(20)) {
+                for (int item = 1 + gen.number(3); item > 0; --item) {
+                    entry->addHistoryItem(entry->clone(Entry::CloneNoFlags));
+                    entry->setPassword(gen.password());
+                }
+            }
+            entry->setGroup(gen.pick(groups));
+        }
+        return db;
+    }
+} // namespace
+
+void BenchmarkSearch::initTestCase()
+{
+    BENCHMARK_SKIP_UNLESS_ENABLED();
+}
+
+QSharedPointer<Database> BenchmarkSearch::database(int entryCount)
+{
+    if (!m_databases.contains(entryCount)) {
+        m_databases.insert(entryCount, generateSearchDatabase(entryCount));
+    }
+    return m_databases.value(entryCount);
+}
+
+void BenchmarkSearch::benchmarkSearch_data()
+{
+    QTest::addColumn<int>("entryCount");
+    QTest::addColumn<QString>("searchString");
+    QTest::addColumn<bool>("hasResults");
+
+    const QList<QPair<QString, QPair<QString, bool>>> queries = {
+        {"plain", {"github", true}},
+        {"plain multiple words", {"amazon work", true}},
+        {"no results", {"doesnotexist", false}},
+        {"wildcard", {"pay*al", true}},
+        {"regex", {"*title:^(git|dropbox)", true}},
+        {"field qualified", {"user:john url:github", true}},
+        {"exact", {"+title:\"Steam Admin\"", true}},
+        {"exclusion", {"github -tag:work", true}},
+        {"only exclusions", {"-url:login -title:bank", true}},
+        {"notes", {"notes:recovery", true}},
+        {"group", {"group:amazon", true}},
+    };
+
+    for (int entryCount : {1000, 10000, 100000}) {
+        for (const auto& query : queries) {
+            QTest::newRow(qPrintable(QString("%1 entries, %2").arg(entryCount).arg(query.first)))
+                << entryCount << query.second.first << query.second.second;
+        }
+    }
+}
+
+void BenchmarkSearch::benchmarkSearch()
+{
+    QFETCH(int, entryCount);
+    QFETCH(QString, searchString);
+    QFETCH(bool, hasResults);
+
+    auto db = database(entryCount);
+
+    // Build the search index outside of the measurement
+    QList<Entry*> results = EntrySearcher().search(searchString, db->rootGroup());
+    QCOMPARE(!results.isEmpty(), hasResults);
+
+    QBENCHMARK
+    {
+        // A new searcher every time, repeated searches would only refine the previous results
+        EntrySearcher searcher;
+        results = searcher.search(searchString, db->rootGroup());
+    }
+    QCOMPARE(!results.isEmpty(), hasResults);
+}
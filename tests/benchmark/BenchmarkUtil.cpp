@@ -0,0 +1,102 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtil.h"
+
+#include "core/Database.h"
+#include "core/Group.h"
+#include "crypto/Random.h"
+
+#include <QFile>
+
+namespace BenchmarkUtil
+{
+    /**
+     * Benchmarks take long, they only run if the BENCHMARK environment variable is set.
+     */
+    bool isEnabled()
+    {
+        const QByteArray env = qgetenv("BENCHMARK");
+        return !env.isEmpty() && env != "0" && env != "no";
+    }
+
+    /**
+     * Database with the given number of entries in consecutive groups below
+     * the root group. Apart from the UUIDs and attachments the contents only
+     * depend on the entry count and options.
+     */
+    QSharedPointer<Database> generateDatabase(int entryCount, const DatabaseOptions& options)
+    {
+        auto db = QSharedPointer<Database>::create();
+        Database::BatchUpdate batch(db.data());
+
+        Group* group = nullptr;
+        for (int i = 0; i < entryCount; ++i) {
+            if (i % options.entriesPerGroup == 0) {
+                group = new Group();
+                group->setUuid(QUuid::createUuid());
+                group->setName(QString("Group %1").arg(i / options.entriesPerGroup));
+                group->setParent(db->rootGroup());
+            }
+            auto entry = new Entry();
+            entry->setUuid(QUuid::createUuid());
+            entry->setTitle(QString("Entry %1").arg(i));
+            entry->setUsername(QString("user%1").arg(i));
+            entry->setUrl(QString("https://example%1.com/login").arg(i));
+            entry->setNotes(QString("Notes of entry %1\nsecond line").arg(i));
+            if (options.attachmentInterval > 0 && i % options.attachmentInterval == 0) {
+                entry->attachments()->set(QString("file%1.bin").arg(i),
+                                          randomGen()->randomArray(options.attachmentSize));
+            }
+            for (int j = 0; j < options.historyDepth; ++j) {
+                entry->setPassword(QString("password%1-%2").arg(i).arg(j));
+                entry->addHistoryItem(entry->clone(Entry::CloneNoFlags));
+            }
+            entry->setPassword(QString("password%1").arg(i));
+            entry->setGroup(group);
+        }
+        return db;
+    }
+
+    /**
+     * Peak resident set size of the process in bytes, or -1 if unknown.
+     */
+    qint64 peakRss()
+    {
+#ifdef Q_OS_LINUX
+        QFile status("/proc/self/status");
+        if (status.open(QIODevice::ReadOnly)) {
+            for (const auto& line : status.readAll().split('\n')) {
+                if (line.startsWith("VmHWM:")) {
+                    return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+                }
+            }
+        }
+#endif
+        return -1;
+    }
+
+    void resetPeakRss()
+    {
+#ifdef Q_OS_LINUX
+        QFile clearRefs("/proc/self/clear_refs");
+        if (clearRefs.open(QIODevice::WriteOnly)) {
+            clearRefs.write("5");
+        }
+#endif
+    }
+} // namespace BenchmarkUtil
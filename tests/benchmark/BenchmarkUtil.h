@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BENCHMARKUTIL_H
+#define KEEPASSXC_BENCHMARKUTIL_H
+
+#include <QSharedPointer>
+#include <QTest>
+
+class Database;
+
+/**
+ * Skip the calling test unless benchmarks are enabled, see BenchmarkUtil::isEnabled().
+ */
+#define BENCHMARK_SKIP_UNLESS_ENABLED()                                                                                \
+    do {                                                                                                               \
+        if (!BenchmarkUtil::isEnabled()) {                                                                             \
+            QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");                                       \
+        }                                                                                                              \
+    } while (false)
+
+namespace BenchmarkUtil
+{
+    struct DatabaseOptions
+    {
+        int entriesPerGroup = 100;
+        // Number of history items, each differing from the next one in its password only
+        int historyDepth = 0;
+        // Every n-th entry carries an attachment of attachmentSize random bytes, 0 for none
+        int attachmentInterval = 0;
+        int attachmentSize = 1024;
+    };
+
+    bool isEnabled();
+    QSharedPointer<Database> generateDatabase(int entryCount, const DatabaseOptions& options = {});
+
+    qint64 peakRss();
+    void resetPeakRss();
+} // namespace BenchmarkUtil
+
+#endif // KEEPASSXC_BENCHMARKUTIL_H
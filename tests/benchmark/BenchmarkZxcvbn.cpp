@@ -0,0 +1,116 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkZxcvbn.h"
+#include "BenchmarkUtil.h"
+
+#include "zxcvbn/zxcvbn.h"
+
+#include <QTest>
+
+#include <random>
+
+QTEST_GUILESS_MAIN(BenchmarkZxcvbn)
+
+namespace
+{
+    const QStringList Words = {"password", "dragon",   "monkey",  "letmein", "sunshine", "princess", "football",
+                               "correct",  "horse",    "battery", "staple",  "shadow",   "master",   "welcome",
+                               "summer",   "computer", "flower",  "secret",  "charlie",  "internet"};
+    const QString Leet = "a4e3i1o0s5t7g9b8";
+    const QString Chars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!#$%&*+-";
+
+    /**
+     * The same passwords of the given kind every time, so results can be
+     * compared between revisions.
+     */
+    QList<QByteArray> generatePasswords(const QString& kind, int count)
+    {
+        std::mt19937 random(count);
+        auto number = [&random](int max) { return std::uniform_int_distribution<int>(0, max - 1)(random); };
+
+        QList<QByteArray> passwords;
+        for (int i = 0; i < count; ++i) {
+            QString password;
+            if (kind == "random") {
+                for (int c = 0; c < 16; ++c) {
+                    password += Chars.at(number(Chars.size()));
+                }
+            } else if (kind == "long random") {
+                for (int c = 0; c < 64; ++c) {
+                    password += Chars.at(number(Chars.size()));
+                }
+            } else if (kind == "passphrase") {
+                QStringList words;
+                for (int w = 0; w < 5; ++w) {
+                    words << Words.at(number(Words.size()));
+                }
+                password = words.join('-');
+            } else if (kind == "leet") {
+                password = Words.at(number(Words.size())) + Words.at(number(Words.size()));
+                for (int l = 0; l < Leet.size(); l += 2) {
+                    if (number(2)) {
+                        password.replace(Leet.at(l), Leet.at(l + 1));
+                    }
+                }
+                password += QString::number(1950 + number(80));
+            } else {
+                password = QString("qwerty%1%2!").arg(number(1000)).arg(Words.at(number(Words.size())));
+            }
+            passwords << password.toUtf8();
+        }
+        return passwords;
+    }
+} // namespace
+
+void BenchmarkZxcvbn::initTestCase()
+{
+    BENCHMARK_SKIP_UNLESS_ENABLED();
+}
+
+void BenchmarkZxcvbn::benchmarkMatch_data()
+{
+    QTest::addColumn<QString>("kind");
+    QTest::addColumn<bool>("withInfo");
+
+    for (const QString kind : {"random", "long random", "passphrase", "leet", "keyboard"}) {
+        QTest::newRow(qPrintable(kind)) << kind << false;
+        QTest::newRow(qPrintable(kind + ", with info")) << kind << true;
+    }
+}
+
+void BenchmarkZxcvbn::benchmarkMatch()
+{
+    QFETCH(QString, kind);
+    QFETCH(bool, withInfo);
+
+    const auto passwords = generatePasswords(kind, 200);
+
+    double total = 0;
+    QBENCHMARK
+    {
+        total = 0;
+        for (const auto& password : passwords) {
+            ZxcMatch_t* info = nullptr;
+            total += ZxcvbnMatch(password.constData(), nullptr, withInfo ? &info : nullptr);
+            ZxcvbnFreeInfo(info);
+        }
+    }
+    QVERIFY(total > 0);
+    // Print the sum of the estimates, it must not change with the speed of the matcher
+    qInfo("Total entropy of the %s passwords: %.4f bits", qPrintable(kind), total);
+}
@@ -27,6 +27,7 @@
 #include <QRadioButton>
 #include <QSignalSpy>
 #include <QSpinBox>
+#include <QTemporaryDir>
 #include <QTest>
 #include <QToolBar>
 
@@ -58,6 +59,8 @@
 #include "gui/group/GroupView.h"
 #include "gui/tag/TagsEdit.h"
 #include "gui/wizard/NewDatabaseWizard.h"
+#include "keeshare/KeeShare.h"
+#include "keeshare/KeeShareSettings.h"
 #include "keys/FileKey.h"
 
 #define TEST_MODAL_NO_WAIT(TEST_CODE)                                                                                  \
@@ -1409,6 +1412,131 @@ void TestGui::testSave()
     checkSaveDatabase();
 }
 
+void TestGui::testSaveWithPendingAutosave()
+{
+    config()->set(Config::AutoSaveAfterEveryChange, true);
+
+    // Start a background save and queue another one behind it
+    m_db->metadata()->setName("testSaveWithPendingAutosave 1");
+    Tools::wait(150); // due to modify timer
+    m_dbWidget->triggerAutosaveTimer();
+    QVERIFY(m_db->isSaving());
+    m_db->metadata()->setName("testSaveWithPendingAutosave 2");
+    Tools::wait(150); // due to modify timer
+    m_dbWidget->triggerAutosaveTimer();
+
+    // The synchronous save supersedes both without overlapping them
+    QVERIFY(m_dbWidget->save());
+    QVERIFY(!m_db->isSaving());
+    QVERIFY(!m_db->isModified());
+
+    // No autosave is left to run once the background save has reported
+    QApplication::processEvents();
+    QVERIFY(!m_db->isSaving());
+    checkDatabase();
+
+    config()->set(Config::AutoSaveAfterEveryChange, false);
+}
+
+void TestGui::testKeeShareExportAction()
+{
+#ifndef WITH_XC_KEESHARE
+    QSKIP("KeeShare is not enabled");
+#else
+    KeeShareSettings::Active active;
+    active.out = true;
+    KeeShare::setActive(active);
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString containerPath = tempDir.filePath("share.kdbx");
+
+    auto* group = new Group();
+    group->setUuid(QUuid::createUuid());
+    group->setName("Shared");
+    group->setParent(m_db->rootGroup());
+    auto* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("Shared Entry");
+    entry->setGroup(group);
+
+    KeeShareSettings::Reference reference;
+    reference.type = KeeShareSettings::ExportTo;
+    reference.uuid = QUuid::createUuid();
+    reference.path = containerPath;
+    reference.password = "a";
+    KeeShare::setReferenceTo(group, reference);
+    KeeShare::instance()->connectDatabase(m_db, {});
+
+    // Saving exports the new share
+    QSignalSpy messages(KeeShare::instance(), SIGNAL(sharingMessage(QString, MessageWidget::MessageType)));
+    QVERIFY(m_dbWidget->save());
+    QTRY_COMPARE(messages.count(), 1);
+    QVERIFY(messages.takeFirst().first().toString().contains(containerPath));
+    QVERIFY(QFile::exists(containerPath));
+
+    // Saving again skips the unchanged share
+    m_db->metadata()->setName("testKeeShareExportAction");
+    QVERIFY(m_dbWidget->save());
+    Tools::wait(500);
+    QCOMPARE(messages.count(), 0);
+
+    // The export action writes it anyway
+    triggerAction("actionExportKeeShare");
+    QTRY_COMPARE(messages.count(), 1);
+    QVERIFY(messages.takeFirst().first().toString().contains(containerPath));
+
+    KeeShare::setActive(KeeShareSettings::Active());
+    QVERIFY(!m_mainWindow->findChild<QAction*>("actionExportKeeShare")->isEnabled());
+#endif
+}
+
+void TestGui::testUnlockDatabasesWithKey()
+{
+    // Two databases share the password "a", the third one uses "t"
+    TemporaryFile sameKeyFile1;
+    TemporaryFile sameKeyFile2;
+    TemporaryFile otherKeyFile;
+    QVERIFY(sameKeyFile1.copyFromFile(QString(KEEPASSX_TEST_DATA_DIR).append("/NewDatabase.kdbx")));
+    QVERIFY(sameKeyFile2.copyFromFile(QString(KEEPASSX_TEST_DATA_DIR).append("/NewDatabase2.kdbx")));
+    QVERIFY(otherKeyFile.copyFromFile(QString(KEEPASSX_TEST_DATA_DIR).append("/Format400.kdbx")));
+
+    const int firstIndex = m_tabWidget->count();
+    m_tabWidget->addDatabaseTab(sameKeyFile1.fileName(), true);
+    m_tabWidget->addDatabaseTab(sameKeyFile2.fileName(), true);
+    m_tabWidget->addDatabaseTab(otherKeyFile.fileName(), true);
+    QCOMPARE(m_tabWidget->count(), firstIndex + 3);
+
+    QPointer<DatabaseWidget> sameKeyWidget1 = m_tabWidget->databaseWidgetFromIndex(firstIndex);
+    QPointer<DatabaseWidget> sameKeyWidget2 = m_tabWidget->databaseWidgetFromIndex(firstIndex + 1);
+    QPointer<DatabaseWidget> otherKeyWidget = m_tabWidget->databaseWidgetFromIndex(firstIndex + 2);
+    QVERIFY(sameKeyWidget1->isLocked());
+    QVERIFY(sameKeyWidget2->isLocked());
+    QVERIFY(otherKeyWidget->isLocked());
+
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+    m_tabWidget->unlockDatabasesWithKey(key);
+
+    // The databases are unlocked as their transformations finish, the other one stays locked
+    QTRY_VERIFY(!sameKeyWidget1->isLocked());
+    QTRY_VERIFY(!sameKeyWidget2->isLocked());
+    Tools::wait(500);
+    QVERIFY(otherKeyWidget->isLocked());
+    QVERIFY(!m_dbWidget->isLocked());
+
+    // Unlocking again with the same key leaves nothing behind to unlock
+    m_tabWidget->unlockDatabasesWithKey(key);
+    Tools::wait(500);
+    QVERIFY(otherKeyWidget->isLocked());
+
+    for (const auto& dbWidget : {sameKeyWidget1, sameKeyWidget2, otherKeyWidget}) {
+        dbWidget->database()->markAsClean();
+        QVERIFY(m_tabWidget->closeDatabaseTab(dbWidget));
+    }
+    m_tabWidget->setCurrentWidget(m_dbWidget);
+}
+
 void TestGui::testSaveBackupPath_data()
 {
     QTest::addColumn<QString>("backupFilePathPattern");
@@ -1984,11 +2112,11 @@ void TestGui::testAutoType()
     entryView->selectionModel()->select(entryIndex, QItemSelectionModel::Rows | QItemSelectionModel::Select);
 
     auto* entryPreviewWidget = m_dbWidget->findChild<EntryPreviewWidget*>("previewWidget");
-    QVERIFY(entryPreviewWidget->isVisible());
+    QTRY_VERIFY(entryPreviewWidget->isVisible());
 
     // Check that the Autotype tab in entry preview pane is disabled for entry with disabled Auto-Type
     auto* entryAutotypeTab = entryPreviewWidget->findChild<QWidget*>("entryAutotypeTab");
-    QVERIFY(!entryAutotypeTab->isEnabled());
+    QTRY_VERIFY(!entryAutotypeTab->isEnabled());
 
     // Check that Auto-Type is disabled in the actual entry model as well
     Entry* entry = entryView->entryFromIndex(entryIndex);
@@ -1998,10 +2126,10 @@ void TestGui::testAutoType()
     entryView->selectionModel()->clearSelection();
     entryIndex = entryView->model()->index(1, 0);
     entryView->selectionModel()->select(entryIndex, QItemSelectionModel::Rows | QItemSelectionModel::Select);
-    QVERIFY(entryPreviewWidget->isVisible());
+    QTRY_VERIFY(entryPreviewWidget->isVisible());
 
     // Check that the Autotype tab in entry preview pane is enabled for entry with default Auto-Type sequence;
-    QVERIFY(entryAutotypeTab->isEnabled());
+    QTRY_VERIFY(entryAutotypeTab->isEnabled());
 
     // Check that Auto-Type is enabled in the actual entry model as well
     entry = entryView->entryFromIndex(entryIndex);
@@ -2011,10 +2139,10 @@ void TestGui::testAutoType()
     entryView->selectionModel()->clearSelection();
     entryIndex = entryView->model()->index(2, 0);
     entryView->selectionModel()->select(entryIndex, QItemSelectionModel::Rows | QItemSelectionModel::Select);
-    QVERIFY(entryPreviewWidget->isVisible());
+    QTRY_VERIFY(entryPreviewWidget->isVisible());
 
     // Check that the Autotype tab in entry preview pane is enabled for entry with custom Auto-Type sequence
-    QVERIFY(entryAutotypeTab->isEnabled());
+    QTRY_VERIFY(entryAutotypeTab->isEnabled());
 
     // Check that Auto-Type is enabled in the actual entry model as well
     entry = entryView->entryFromIndex(entryIndex);
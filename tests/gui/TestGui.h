@@ -58,6 +58,9 @@ private slots:
     void testSaveAs();
     void testSaveBackup();
     void testSave();
+    void testSaveWithPendingAutosave();
+    void testKeeShareExportAction();
+    void testUnlockDatabasesWithKey();
     void testSaveBackupPath();
     void testSaveBackupPath_data();
     void testDatabaseSettings();
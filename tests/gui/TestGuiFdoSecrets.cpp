@@ -353,6 +353,37 @@ void TestGuiFdoSecrets::testServiceSearch()
         COMPARE(locked, {});
         COMPARE(unlocked, {});
     }
+
+    // all attributes must match
+    {
+        DBUS_GET2(unlocked, locked, service->SearchItems({{"fdosecrets-test", "1"}, {crazyKey, crazyValue}}));
+        COMPARE(locked, {});
+        COMPARE(unlocked, {QDBusObjectPath(item->path())});
+    }
+    {
+        DBUS_GET2(unlocked, locked, service->SearchItems({{"fdosecrets-test", "1"}, {crazyKey, "other"}}));
+        COMPARE(locked, {});
+        COMPARE(unlocked, {});
+    }
+
+    // changed and removed attributes are found by their current value only
+    entry->attributes()->set("fdosecrets-test", "3");
+    {
+        DBUS_GET2(unlocked, locked, service->SearchItems({{"fdosecrets-test", "1"}}));
+        COMPARE(locked, {});
+        COMPARE(unlocked, {});
+    }
+    {
+        DBUS_GET2(unlocked, locked, service->SearchItems({{"fdosecrets-test", "3"}}));
+        COMPARE(locked, {});
+        COMPARE(unlocked, {QDBusObjectPath(item->path())});
+    }
+    entry->attributes()->remove("fdosecrets-test");
+    {
+        DBUS_GET2(unlocked, locked, service->SearchItems({{"fdosecrets-test", "3"}}));
+        COMPARE(locked, {});
+        COMPARE(unlocked, {});
+    }
 }
 
 void TestGuiFdoSecrets::testServiceSearchBlockingUnlock()
@@ -1054,6 +1085,35 @@ void TestGuiFdoSecrets::testCollectionChange()
     }
 }
 
+void TestGuiFdoSecrets::testCollectionItemsOnDemand()
+{
+    auto service = enableService();
+    VERIFY(service);
+    auto coll = getDefaultCollection(service);
+    VERIFY(coll);
+    auto collObj = m_plugin->dbus()->pathToObject<Collection>(QDBusObjectPath(coll->path()));
+    VERIFY(collObj);
+
+    // listing items does not create them
+    DBUS_GET(itemPaths, coll->items());
+    VERIFY(itemPaths.size() > 1);
+    COMPARE(collObj->findChildren<Item*>().size(), 0);
+
+    // the first access through an item path does
+    auto item = getProxy<ItemProxy>(itemPaths.first());
+    VERIFY(item);
+    DBUS_GET(label, item->label());
+    COMPARE(collObj->findChildren<Item*>().size(), 1);
+    auto itemObj = m_plugin->dbus()->pathToObject<Item>(itemPaths.first());
+    VERIFY(itemObj);
+    COMPARE(itemObj->backend()->title(), label);
+
+    // unknown ids do not resolve
+    auto unknownPath = QStringLiteral("%1/%2").arg(coll->path(), Tools::uuidToHex(QUuid::createUuid()));
+    VERIFY(!m_plugin->dbus()->pathToObject<Item>(QDBusObjectPath(unknownPath)));
+    COMPARE(collObj->findChildren<Item*>().size(), 1);
+}
+
 void TestGuiFdoSecrets::testHiddenFilename()
 {
     // when file name contains leading dot, all parts excepting the last should be used
@@ -1217,6 +1277,27 @@ void TestGuiFdoSecrets::testItemChange()
         COMPARE(args.size(), 1);
         COMPARE(args.at(0).value<QDBusObjectPath>().path(), item->path());
     }
+
+    // a burst of changes is sent as a single signal
+    spyItemChanged.clear();
+    for (int i = 0; i != 10; ++i) {
+        entry->setNotes(QString::number(i));
+    }
+    QTRY_COMPARE(spyItemChanged.size(), 1);
+    processEvents();
+    COMPARE(spyItemChanged.size(), 1);
+
+    // changes in a batch update are only reported when it finishes
+    spyItemChanged.clear();
+    {
+        Database::BatchUpdate batch(m_db.data());
+        entry->setNotes("batch");
+        entry->setUsername("batch");
+        processEvents();
+        COMPARE(spyItemChanged.size(), 0);
+    }
+    QTRY_COMPARE(spyItemChanged.size(), 1);
+    COMPARE(spyItemChanged.first().at(0).value<QDBusObjectPath>().path(), item->path());
 }
 
 void TestGuiFdoSecrets::testItemReplace()
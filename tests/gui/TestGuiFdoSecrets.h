@@ -83,6 +83,7 @@ private slots:
     void testCollectionDelete();
     void testCollectionDeleteConcurrent();
     void testCollectionChange();
+    void testCollectionItemsOnDemand();
 
     void testItemCreate();
     void testItemCreateUnlock();
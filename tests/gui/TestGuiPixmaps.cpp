@@ -81,4 +81,51 @@ void TestGuiPixmaps::testGroupIcons()
     QVERIFY(Icons::groupIconPixmap(group).toImage() == Icons::customIconPixmap(db.data(), iconUuid).toImage());
 }
 
+void TestGuiPixmaps::testPixmapCache()
+{
+    QScopedPointer<Database> db(new Database());
+    auto entry = new Entry();
+    entry->setGroup(db->rootGroup());
+
+    // Repeated lookups return the same pixmap
+    QCOMPARE(databaseIcons()->icon(10).cacheKey(), databaseIcons()->icon(10).cacheKey());
+    QVERIFY(databaseIcons()->icon(10).cacheKey() != databaseIcons()->icon(10, IconSize::Large).cacheKey());
+
+    entry->setIcon(10);
+    entry->setExpires(true);
+    entry->setExpiryTime(QDateTime::currentDateTimeUtc().addDays(-1));
+    QCOMPARE(Icons::entryIconPixmap(entry).cacheKey(), Icons::entryIconPixmap(entry).cacheKey());
+
+    QUuid iconUuid = QUuid::createUuid();
+    QImage icon(2, 1, QImage::Format_RGB32);
+    icon.fill(qRgb(0, 0, 0));
+    db->metadata()->addCustomIcon(iconUuid, Icons::saveToBytes(icon));
+    const auto pixmap = Icons::customIconPixmap(db.data(), iconUuid);
+    QCOMPARE(Icons::customIconPixmap(db.data(), iconUuid).cacheKey(), pixmap.cacheKey());
+
+    // Replacing the image of an icon is not hidden by the cache
+    db->metadata()->removeCustomIcon(iconUuid);
+    icon.fill(qRgb(0, 0, 255));
+    db->metadata()->addCustomIcon(iconUuid, Icons::saveToBytes(icon));
+    QVERIFY(Icons::customIconPixmap(db.data(), iconUuid).toImage() != pixmap.toImage());
+}
+
+void TestGuiPixmaps::testIconCache()
+{
+    const int id = icons()->iconId("document-open");
+    QCOMPARE(icons()->iconId("document-open"), id);
+    QVERIFY(icons()->iconId("document-save") != id);
+    QVERIFY(icons()->icon(-1).isNull());
+
+    // Lookups by name and by id share the cached icon
+    QCOMPARE(icons()->icon("document-open").cacheKey(), icons()->icon(id).cacheKey());
+    QVERIFY(icons()->icon(id).cacheKey() != icons()->icon(id, false).cacheKey());
+
+    // Recolored variants are cached for each override color
+    const auto red = icons()->icon(id, true, Qt::red);
+    QCOMPARE(icons()->icon(id, true, Qt::red).cacheKey(), red.cacheKey());
+    QVERIFY(icons()->icon(id, true, Qt::blue).cacheKey() != red.cacheKey());
+    QVERIFY(icons()->icon(id).cacheKey() != red.cacheKey());
+}
+
 QTEST_MAIN(TestGuiPixmaps)
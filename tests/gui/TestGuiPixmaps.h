@@ -29,6 +29,8 @@ private slots:
     void testDatabaseIcons();
     void testEntryIcons();
     void testGroupIcons();
+    void testPixmapCache();
+    void testIconCache();
 };
 
 #endif // KEEPASSX_TESTGUIPIXMAPS_H